@@ -0,0 +1,265 @@
+/*
+** Copyright 2022, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#define LOG_TAG "artd"
+
+#include "dexopt_batch_scheduler.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "exec_utils.h"
+
+namespace android {
+namespace artd {
+
+namespace {
+
+// How long the dispatcher sleeps between probe evaluations while all
+// concurrency slots are occupied.
+constexpr std::chrono::milliseconds kDispatchInterval(500);
+
+constexpr const char* kMemoryPressurePath = "/proc/pressure/memory";
+constexpr size_t kMaxThermalZones = 32;
+
+// ioprio_set(2) has no libc wrapper. The priority value packs the class in
+// the top bits and the level in the bottom ones.
+constexpr int kIoprioClassShift = 13;
+constexpr int kIoprioWhoProcess = 1;  // Current thread; inherited by fork.
+
+int IoprioValue(int ioprio_class, int level) {
+  return (ioprio_class << kIoprioClassShift) | level;
+}
+
+int IoprioSetThread(int value) {
+  return syscall(__NR_ioprio_set, kIoprioWhoProcess, 0, value);
+}
+
+int IoprioGetThread() {
+  return syscall(__NR_ioprio_get, kIoprioWhoProcess, 0);
+}
+
+// Returns the PSI "some avg10" percentage, or 0.0 if unavailable (old
+// kernels without CONFIG_PSI).
+double ReadMemoryPressure() {
+  std::ifstream in(kMemoryPressurePath);
+  std::string line;
+  while (std::getline(in, line)) {
+    double avg10 = 0.0;
+    if (sscanf(line.c_str(), "some avg10=%lf", &avg10) == 1) {
+      return avg10;
+    }
+  }
+  return 0.0;
+}
+
+// Returns the maximum thermal zone temperature in milli-degrees C, or 0 if
+// no zone could be read.
+int ReadMaxTemperature() {
+  int max_temp = 0;
+  for (size_t zone = 0; zone < kMaxThermalZones; zone++) {
+    std::string path =
+        "/sys/class/thermal/thermal_zone" + std::to_string(zone) + "/temp";
+    std::ifstream in(path);
+    if (!in.is_open()) {
+      break;  // Zones are numbered contiguously.
+    }
+    int temp = 0;
+    if (in >> temp) {
+      max_temp = std::max(max_temp, temp);
+    }
+  }
+  return max_temp;
+}
+
+}  // namespace
+
+DexoptBatchScheduler::DexoptBatchScheduler(const Config& config)
+    : config_(config),
+      memory_pressure_probe_(ReadMemoryPressure),
+      max_temperature_probe_(ReadMaxTemperature),
+      current_concurrency_(std::max<size_t>(config.max_concurrency, 1u)) {
+  exec_ = [this](std::vector<std::string>& args, std::string* error_msg) {
+    if (config_.job_timeout_secs > 0) {
+      bool timed_out = false;
+      int code = art::ExecAndReturnCode(args, config_.job_timeout_secs, &timed_out, error_msg);
+      if (timed_out && error_msg != nullptr) {
+        *error_msg += " (timed out)";
+      }
+      return code;
+    }
+    return art::ExecAndReturnCode(args, error_msg);
+  };
+}
+
+size_t DexoptBatchScheduler::GetCurrentConcurrencyForTesting() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return current_concurrency_;
+}
+
+void DexoptBatchScheduler::SetDeviceLoadProbesForTesting(
+    std::function<double()> memory_pressure, std::function<int()> max_temperature) {
+  memory_pressure_probe_ = std::move(memory_pressure);
+  max_temperature_probe_ = std::move(max_temperature);
+}
+
+void DexoptBatchScheduler::SetExecFunctionForTesting(
+    std::function<int(std::vector<std::string>&, std::string*)> exec) {
+  exec_ = std::move(exec);
+}
+
+void DexoptBatchScheduler::UpdateConcurrencyTarget() {
+  const double pressure = memory_pressure_probe_();
+  const int temperature = max_temperature_probe_();
+  const bool thermal_enabled = config_.thermal_limit_milli_c > 0;
+
+  const bool overloaded = pressure > config_.memory_pressure_high ||
+                          (thermal_enabled && temperature > config_.thermal_limit_milli_c);
+  const bool calm = pressure < config_.memory_pressure_low &&
+                    (!thermal_enabled || temperature < config_.thermal_limit_milli_c);
+
+  if (overloaded && current_concurrency_ > 1) {
+    current_concurrency_--;
+    LOG(INFO) << "Reducing dexopt concurrency to " << current_concurrency_
+              << " (memory pressure " << pressure << ", max temp " << temperature << ")";
+  } else if (calm && current_concurrency_ < config_.max_concurrency) {
+    current_concurrency_++;
+  }
+}
+
+bool DexoptBatchScheduler::IsJournaled(const std::string& key) const {
+  return std::find(journaled_keys_.begin(), journaled_keys_.end(), key) != journaled_keys_.end();
+}
+
+void DexoptBatchScheduler::AppendJournal(const std::string& key, bool success) {
+  if (journal_fd_ < 0 || key.empty()) {
+    return;
+  }
+  std::string line = (success ? "ok " : "fail ") + key + "\n";
+  if (TEMP_FAILURE_RETRY(write(journal_fd_, line.data(), line.size())) !=
+      static_cast<ssize_t>(line.size())) {
+    PLOG(WARNING) << "Failed to append dexopt journal entry for " << key;
+    return;
+  }
+  // Sync each entry so an interrupted batch does not redo finished work.
+  if (fdatasync(journal_fd_) != 0) {
+    PLOG(WARNING) << "Failed to sync dexopt journal";
+  }
+}
+
+bool DexoptBatchScheduler::RunJob(const DexoptBatchJob& job) {
+  // Priorities are applied to this thread and inherited across fork+exec.
+  const int old_nice = getpriority(PRIO_PROCESS, 0);
+  const int old_ioprio = IoprioGetThread();
+  if (setpriority(PRIO_PROCESS, 0, job.nice_level) != 0) {
+    PLOG(WARNING) << "Failed to set nice " << job.nice_level << " for " << job.journal_key;
+  }
+  if (IoprioSetThread(IoprioValue(job.ioprio_class, job.ioprio_level)) != 0) {
+    PLOG(WARNING) << "Failed to set ioprio class " << job.ioprio_class
+                  << " for " << job.journal_key;
+  }
+
+  std::vector<std::string> args = job.args;
+  std::string error_msg;
+  const int code = exec_(args, &error_msg);
+  if (code != 0) {
+    LOG(WARNING) << "Dexopt job " << job.journal_key << " failed with exit code "
+                 << code << ": " << error_msg;
+  }
+
+  setpriority(PRIO_PROCESS, 0, old_nice);
+  if (old_ioprio >= 0) {
+    IoprioSetThread(old_ioprio);
+  }
+  return code == 0;
+}
+
+DexoptBatchResult DexoptBatchScheduler::Run(const std::vector<DexoptBatchJob>& jobs) {
+  DexoptBatchResult result;
+
+  // Load the journal from a previous interrupted run; completed jobs are
+  // skipped, failed ones retried.
+  journaled_keys_.clear();
+  if (!config_.journal_path.empty()) {
+    std::ifstream in(config_.journal_path);
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.rfind("ok ", 0) == 0) {
+        journaled_keys_.push_back(line.substr(3));
+      }
+    }
+    journal_fd_ = TEMP_FAILURE_RETRY(
+        open(config_.journal_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600));
+    if (journal_fd_ < 0) {
+      PLOG(WARNING) << "Failed to open dexopt journal " << config_.journal_path;
+    }
+  }
+
+  std::vector<std::thread> workers;
+  workers.reserve(jobs.size());
+  for (const DexoptBatchJob& job : jobs) {
+    if (!job.journal_key.empty() && IsJournaled(job.journal_key)) {
+      result.skipped++;
+      continue;
+    }
+
+    // Wait for a free slot, re-evaluating the device load while we do.
+    std::unique_lock<std::mutex> lock(mutex_);
+    UpdateConcurrencyTarget();
+    while (running_ >= current_concurrency_) {
+      job_finished_.wait_for(lock, kDispatchInterval);
+      UpdateConcurrencyTarget();
+    }
+    running_++;
+    lock.unlock();
+
+    workers.emplace_back([this, &job, &result]() {
+      const bool ok = RunJob(job);
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (ok) {
+        result.completed++;
+      } else {
+        result.failed++;
+      }
+      AppendJournal(job.journal_key, ok);
+      running_--;
+      job_finished_.notify_all();
+    });
+  }
+
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  if (journal_fd_ >= 0) {
+    close(journal_fd_);
+    journal_fd_ = -1;
+  }
+  return result;
+}
+
+}  // namespace artd
+}  // namespace android
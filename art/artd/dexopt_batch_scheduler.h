@@ -0,0 +1,150 @@
+/*
+** Copyright 2022, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef ART_ARTD_DEXOPT_BATCH_SCHEDULER_H_
+#define ART_ARTD_DEXOPT_BATCH_SCHEDULER_H_
+
+#include <time.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace android {
+namespace artd {
+
+// A single dex2oat invocation within a batch.
+struct DexoptBatchJob {
+  // Full command line, argv[0] included.
+  std::vector<std::string> args;
+
+  // Stable identifier used for journaling (e.g. "<dex location>:<isa>").
+  // Jobs recorded as completed in the journal are skipped on resume.
+  std::string journal_key;
+
+  // CPU nice level for the spawned process. Background maintenance batches
+  // should run at a positive nice so interactive work is not starved.
+  int nice_level = 10;
+
+  // I/O priority class and level (see ioprio_set(2)): 1 = realtime,
+  // 2 = best-effort, 3 = idle. The level is only meaningful for classes 1/2.
+  int ioprio_class = 3;
+  int ioprio_level = 0;
+};
+
+struct DexoptBatchResult {
+  size_t completed = 0;  // Exited with status 0.
+  size_t failed = 0;     // Exited non-zero, timed out, or failed to spawn.
+  size_t skipped = 0;    // Already recorded as completed in the journal.
+};
+
+// Runs a batch of dex2oat jobs with bounded parallelism under a device-load
+// feedback controller.
+//
+// The controller starts at the configured concurrency and adjusts it between
+// job dispatches: when memory pressure (PSI "some avg10" from
+// /proc/pressure/memory) or the thermal probe reports an overloaded device,
+// the target is stepped down towards one job; once the device has been calm
+// for a dispatch interval, it is stepped back up. This keeps overnight
+// maintenance from fighting userspace lowmemorykiller or pushing the device
+// into thermal throttling, which costs more time than it saves.
+//
+// Per-job nice/ioprio classes are applied to the dispatching thread before
+// the fork and inherited by the child. This requires direct fork+exec; stop
+// the exec helper pool (art::StopExecHelperPool) before running a batch if
+// one was started, since helpers do not inherit the caller's priorities.
+//
+// If a journal path is configured, every finished job is appended to the
+// journal and synced. Re-running a batch with the same journal resumes where
+// the previous run was interrupted (completed jobs are skipped; failed jobs
+// are retried).
+//
+// Instances are not thread-safe; run one batch at a time.
+class DexoptBatchScheduler {
+ public:
+  struct Config {
+    // Upper bound on concurrently running jobs.
+    size_t max_concurrency = 4;
+
+    // Per-job timeout handed to ExecAndReturnCode. <= 0 means no timeout.
+    time_t job_timeout_secs = 0;
+
+    // Path of the resume journal. Empty disables journaling.
+    std::string journal_path;
+
+    // Memory pressure ("some avg10" percentage) above which concurrency is
+    // reduced, and below which it may grow again.
+    double memory_pressure_high = 15.0;
+    double memory_pressure_low = 5.0;
+
+    // Maximum thermal zone temperature (milli-degrees C) above which
+    // concurrency is reduced. 0 disables the thermal check, for devices
+    // whose sysfs thermal layout needs a custom probe instead.
+    int thermal_limit_milli_c = 0;
+  };
+
+  explicit DexoptBatchScheduler(const Config& config);
+
+  // Runs all jobs; returns once every job has completed, failed, or been
+  // skipped. Interrupted batches can be resumed through the journal.
+  DexoptBatchResult Run(const std::vector<DexoptBatchJob>& jobs);
+
+  // Current concurrency target, as set by the feedback controller.
+  size_t GetCurrentConcurrencyForTesting() const;
+
+  // Overrides the device-load probes. The memory probe returns the PSI
+  // "some avg10" percentage; the thermal probe returns the maximum zone
+  // temperature in milli-degrees C (or 0 if unavailable).
+  void SetDeviceLoadProbesForTesting(std::function<double()> memory_pressure,
+                                     std::function<int()> max_temperature);
+
+  // Overrides the job launcher (default: art::ExecAndReturnCode).
+  void SetExecFunctionForTesting(
+      std::function<int(std::vector<std::string>&, std::string*)> exec);
+
+ private:
+  // Reads the probes and steps the concurrency target up or down.
+  void UpdateConcurrencyTarget();
+
+  // Returns true if the job is already recorded as completed.
+  bool IsJournaled(const std::string& key) const;
+
+  // Appends the job outcome to the journal and syncs it to disk.
+  void AppendJournal(const std::string& key, bool success);
+
+  // Runs a single job on the calling thread, applying its priorities.
+  bool RunJob(const DexoptBatchJob& job);
+
+  Config config_;
+
+  std::function<double()> memory_pressure_probe_;
+  std::function<int()> max_temperature_probe_;
+  std::function<int(std::vector<std::string>&, std::string*)> exec_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable job_finished_;
+  size_t current_concurrency_;
+  size_t running_ = 0;
+  std::vector<std::string> journaled_keys_;
+  int journal_fd_ = -1;
+};
+
+}  // namespace artd
+}  // namespace android
+
+#endif  // ART_ARTD_DEXOPT_BATCH_SCHEDULER_H_
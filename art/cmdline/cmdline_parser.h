@@ -544,6 +544,10 @@ struct CmdlineParser {
 
   void DumpHelp(VariableIndentationOutputStream& vios);
 
+  // Parse the arguments; storing results into the arguments map. Returns success value.
+  // A parser may be reused for any number of (serial) parses; each parse clears
+  // the results of the previous one, so building the argument table once per
+  // process and reusing the parser avoids repeated construction cost.
   CmdlineResult Parse(const std::string& argv) {
     std::vector<std::string> tokenized;
     Split(argv, ' ', &tokenized);
@@ -20,8 +20,10 @@
 #include <stdlib.h>
 #include <sys/stat.h>
 
+#include <atomic>
 #include <forward_list>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <memory>
@@ -46,6 +48,7 @@
 #include "aot_class_linker.h"
 #include "arch/instruction_set_features.h"
 #include "art_method-inl.h"
+#include "base/arena_allocator.h"
 #include "base/callee_save_type.h"
 #include "base/dumpable.h"
 #include "base/fast_exit.h"
@@ -106,6 +109,7 @@
 #include "scoped_thread_state_change-inl.h"
 #include "stream/buffered_output_stream.h"
 #include "stream/file_output_stream.h"
+#include "thread_pool.h"
 #include "vdex_file.h"
 #include "verifier/verifier_deps.h"
 #include "well_known_classes.h"
@@ -1249,6 +1253,17 @@ class Dex2Oat final {
         }
         oat_files_.push_back(std::move(oat_file));
         DCHECK_EQ(input_vdex_fd_, -1);
+        // Reusing an input vdex is as incremental as dex2oat gets: it skips
+        // re-verification (and dex-to-dex quickening) for dex files whose
+        // checksums still match. We deliberately do not reuse compiled code
+        // from a previous oat file at method granularity: the generated code
+        // is not relocatable per method (relative calls into other methods
+        // and thunks, .bss slot and boot image offsets assigned during
+        // layout, and deduplicated code units shared between methods), so
+        // splicing old code ranges into a new layout would require a full
+        // relink which is what compilation already does. Method-diff based
+        // recompilation would have to live in the compiler driver, keyed on
+        // code item checksums, and still redo oat layout from scratch.
         if (!input_vdex_.empty()) {
           std::string error_msg;
           input_vdex_file_ = VdexFile::Open(input_vdex_,
@@ -2031,6 +2046,35 @@ class Dex2Oat final {
   // Steps 1.-3. are done by the CreateOatFile() above, steps 4.-5.
   // are done by the CreateImageFile() below.
 
+  // Runs `task` for indices [0, count) on a temporary thread pool if dex2oat was
+  // configured with multiple threads and there is more than one independent piece
+  // of work; otherwise runs the tasks serially on the current thread. The tasks
+  // log their own errors. Returns true if all tasks succeeded.
+  bool RunOutputTasks(const char* pool_name, size_t count, std::function<bool(size_t)> task) {
+    size_t num_threads = std::min(count, thread_count_);
+    if (num_threads <= 1u) {
+      for (size_t i = 0; i != count; ++i) {
+        if (!task(i)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    Thread* self = Thread::Current();
+    std::atomic<bool> success(true);
+    std::unique_ptr<ThreadPool> pool(new ThreadPool(pool_name, num_threads));
+    for (size_t i = 0; i != count; ++i) {
+      pool->AddTask(self, new FunctionTask([&task, &success, i](Thread*) {
+        if (!task(i)) {
+          success.store(false, std::memory_order_relaxed);
+        }
+      }));
+    }
+    pool->StartWorkers(self);
+    pool->Wait(self, /* do_work= */ true, /* may_hold_locks= */ false);
+    return success.load(std::memory_order_relaxed);
+  }
+
   // Write out the generated code part. Calls the OatWriter and ElfBuilder. Also prepares the
   // ImageWriter, if necessary.
   // Note: Flushing (and closing) the file is the caller's responsibility, except for the failure
@@ -2038,12 +2082,20 @@ class Dex2Oat final {
   bool WriteOutputFiles(jobject class_loader) {
     TimingLogger::ScopedTiming t("dex2oat Oat", timings_);
 
-    // Sync the data to the file, in case we did dex2dex transformations.
-    for (MemMap& map : opened_dex_files_maps_) {
-      if (!map.Sync()) {
-        PLOG(ERROR) << "Failed to Sync() dex2dex output. Map: " << map.GetName();
-        return false;
-      }
+    // Sync the data to the file, in case we did dex2dex transformations. The maps
+    // are independent, so let msync() calls for different dex files overlap.
+    if (!RunOutputTasks("Dex file sync thread pool",
+                        opened_dex_files_maps_.size(),
+                        [this](size_t i) {
+                          MemMap& map = opened_dex_files_maps_[i];
+                          if (!map.Sync()) {
+                            PLOG(ERROR) << "Failed to Sync() dex2dex output. Map: "
+                                        << map.GetName();
+                            return false;
+                          }
+                          return true;
+                        })) {
+      return false;
     }
 
     if (IsImage()) {
@@ -2082,12 +2134,20 @@ class Dex2Oat final {
       TimingLogger::ScopedTiming t2("dex2oat Write VDEX", timings_);
       DCHECK(IsBootImage() || IsBootImageExtension() || oat_files_.size() == 1u);
       verifier::VerifierDeps* verifier_deps = callbacks_->GetVerifierDeps();
-      for (size_t i = 0, size = oat_files_.size(); i != size; ++i) {
-        File* vdex_file = vdex_files_[i].get();
-        if (!oat_writers_[i]->FinishVdexFile(vdex_file, verifier_deps)) {
-          LOG(ERROR) << "Failed to finish VDEX file " << vdex_file->GetPath();
-          return false;
-        }
+      // Each vdex is laid out and written to its own file and the verifier deps are
+      // only read here, so finish the vdex files for different oat files concurrently.
+      if (!RunOutputTasks("Vdex write thread pool",
+                          oat_files_.size(),
+                          [this, verifier_deps](size_t i) {
+                            File* vdex_file = vdex_files_[i].get();
+                            if (!oat_writers_[i]->FinishVdexFile(vdex_file, verifier_deps)) {
+                              LOG(ERROR) << "Failed to finish VDEX file "
+                                         << vdex_file->GetPath();
+                              return false;
+                            }
+                            return true;
+                          })) {
+        return false;
       }
     }
 
@@ -2119,6 +2179,11 @@ class Dex2Oat final {
         }
       }
 
+      // The ELF writing below stays on one thread: the oat files share `patcher`
+      // and thunks are emitted while the code is written, so the per-file output
+      // depends on the layout order established above. Parallelism within a file
+      // comes from ElfWriter::PrepareDebugInfo() which compresses the debug info
+      // on a background thread while the sections are written.
       for (size_t i = 0, size = oat_files_.size(); i != size; ++i) {
         std::unique_ptr<File>& oat_file = oat_files_[i];
         std::unique_ptr<linker::ElfWriter>& elf_writer = elf_writers_[i];
@@ -2289,6 +2354,11 @@ class Dex2Oat final {
     if (compiler_options_->GetDumpTimings() ||
         (kIsDebugBuild && timings_->GetTotalNs() > MsToNs(1000))) {
       LOG(INFO) << Dumpable<TimingLogger>(*timings_);
+      // Append the always-on arena accounting so compiler memory can be
+      // compared across releases without a debug build.
+      std::ostringstream arena_stats;
+      ArenaAllocatorAccounting::Dump(arena_stats);
+      LOG(INFO) << arena_stats.str();
     }
   }
 
@@ -17,6 +17,7 @@
 #include "dex2oat_options.h"
 
 #include <memory>
+#include <mutex>
 
 #include "cmdline_parser.h"
 #include "driver/compiler_options_map-inl.h"
@@ -460,7 +461,16 @@ Parser CreateDex2oatArgumentParser() {
 std::unique_ptr<Dex2oatArgumentMap> Dex2oatArgumentMap::Parse(int argc,
                                                               const char** argv,
                                                               std::string* error_msg) {
-  Parser parser = CreateDex2oatArgumentParser();
+  // Building the argument table allocates several hundred definitions and
+  // closures, which is pure overhead when a process parses more than once
+  // (tests, services driving compilation in-process). Build the parser once
+  // and reuse it: Parse() clears previously parsed state, and releasing the
+  // arguments map leaves the parser ready for the next parse. The lock
+  // serializes callers since the parser stores parse results internally.
+  static std::mutex parser_mutex;
+  static Parser parser = CreateDex2oatArgumentParser();
+  std::lock_guard<std::mutex> lock(parser_mutex);
+
   CmdlineResult parse_result = parser.Parse(argv, argc);
   if (!parse_result.IsSuccess()) {
     *error_msg = parse_result.GetMessage();
@@ -56,6 +56,11 @@
 
 namespace dt_fd_forward {
 
+// Every JDWP packet starts with len(4), id(4), flags(1) followed by either
+// errorCode(2) for replies or cmdSet(1), cmd(1) for commands: 11 bytes
+// either way.
+static constexpr size_t kPacketHeaderLen = 11;
+
 // Helper that puts line-number in error message.
 #define DT_IO_ERROR(f) \
     SetLastError(::android::base::StringPrintf("%s:%d - %s: %s", \
@@ -285,6 +290,39 @@ IOResult FdForwardTransport::WriteFully(const void* data, size_t ndata) {
   return WriteFullyWithoutChecks(data, ndata);
 }
 
+IOResult FdForwardTransport::WritevFullyWithoutChecks(struct iovec* iov, int iovcnt) {
+  ScopedEventFdLock sefdl(write_lock_fd_);
+  while (iovcnt > 0) {
+    ssize_t res = TEMP_FAILURE_RETRY(writev(write_fd_, iov, iovcnt));
+    if (res < 0) {
+      DT_IO_ERROR("Failed writev()");
+      return IOResult::kError;
+    } else if (res == 0) {
+      return IOResult::kEOF;
+    }
+    // Skip past fully written iovecs and advance into a partially written one.
+    size_t written = static_cast<size_t>(res);
+    while (iovcnt > 0 && written >= iov[0].iov_len) {
+      written -= iov[0].iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov[0].iov_base = reinterpret_cast<uint8_t*>(iov[0].iov_base) + written;
+      iov[0].iov_len -= written;
+    }
+  }
+  return IOResult::kOk;
+}
+
+IOResult FdForwardTransport::WritevFully(struct iovec* iov, int iovcnt) {
+  std::lock_guard<std::mutex> lk(state_mutex_);
+  if (state_ != TransportState::kOpen) {
+    return IOResult::kInterrupt;
+  }
+  return WritevFullyWithoutChecks(iov, iovcnt);
+}
+
 static void SendAcceptMessage(int fd) {
   TEMP_FAILURE_RETRY(send(fd, kAcceptMessage, sizeof(kAcceptMessage), MSG_EOR));
 }
@@ -470,40 +508,46 @@ class PacketReader {
   bool ReadFully() {
     // Zero out.
     memset(pkt_, 0, sizeof(jdwpPacket));
-    int32_t len = ReadInt32();         // read len
+    // The header is always kPacketHeaderLen bytes regardless of packet kind,
+    // so pull it in with a single read instead of one syscall per field.
+    uint8_t header[kPacketHeaderLen];
+    IOResult res = transport_->ReadFully(header, sizeof(header));
+    HandleResult(res, /*fail*/0, [] { return 0; });
     if (is_err_) {
       return false;
     } else if (is_eof_) {
       return true;
-    } else if (len < 11) {
+    }
+    int32_t len = ParseInt32(&header[0]);
+    if (len < 11) {
       transport_->DT_IO_ERROR("Packet with len < 11 received!");
       return false;
     }
     pkt_->type.cmd.len = len;
-    pkt_->type.cmd.id = ReadInt32();
-    pkt_->type.cmd.flags = ReadByte();
-    if (is_err_) {
-      return false;
-    } else if (is_eof_) {
-      return true;
-    } else if ((pkt_->type.reply.flags & JDWPTRANSPORT_FLAGS_REPLY) == JDWPTRANSPORT_FLAGS_REPLY) {
-      ReadReplyPacket();
+    pkt_->type.cmd.id = ParseInt32(&header[4]);
+    pkt_->type.cmd.flags = header[8];
+    if ((pkt_->type.reply.flags & JDWPTRANSPORT_FLAGS_REPLY) == JDWPTRANSPORT_FLAGS_REPLY) {
+      pkt_->type.reply.errorCode = ParseInt16(&header[9]);
+      pkt_->type.reply.data = ReadRemaining();
     } else {
-      ReadCmdPacket();
+      pkt_->type.cmd.cmdSet = header[9];
+      pkt_->type.cmd.cmd = header[10];
+      pkt_->type.cmd.data = ReadRemaining();
     }
     return !is_err_;
   }
 
  private:
-  void ReadReplyPacket() {
-    pkt_->type.reply.errorCode = ReadInt16();
-    pkt_->type.reply.data = ReadRemaining();
+  static jint ParseInt32(const uint8_t* p) {
+    jint out;
+    memcpy(&out, p, sizeof(out));
+    return NetworkToHost(out);
   }
 
-  void ReadCmdPacket() {
-    pkt_->type.cmd.cmdSet = ReadByte();
-    pkt_->type.cmd.cmd = ReadByte();
-    pkt_->type.cmd.data = ReadRemaining();
+  static jshort ParseInt16(const uint8_t* p) {
+    jshort out;
+    memcpy(&out, p, sizeof(out));
+    return NetworkToHost(out);
   }
 
   // `produceVal` is a function which produces the success value. It'd be a bit
@@ -555,33 +599,6 @@ class PacketReader {
     }
   }
 
-  jbyte ReadByte() {
-    if (is_eof_ || is_err_) {
-      return -1;
-    }
-    jbyte out;
-    IOResult res = transport_->ReadFully(&out, sizeof(out));
-    return HandleResult(res, static_cast<jbyte>(-1), [&] { return NetworkToHost(out); });
-  }
-
-  jshort ReadInt16() {
-    if (is_eof_ || is_err_) {
-      return -1;
-    }
-    jshort out;
-    IOResult res = transport_->ReadFully(&out, sizeof(out));
-    return HandleResult(res, static_cast<jshort>(-1), [&] { return NetworkToHost(out); });
-  }
-
-  jint ReadInt32() {
-    if (is_eof_ || is_err_) {
-      return -1;
-    }
-    jint out;
-    IOResult res = transport_->ReadFully(&out, sizeof(out));
-    return HandleResult(res, -1, [&] { return NetworkToHost(out); });
-  }
-
   FdForwardTransport* transport_;
   jdwpPacket* pkt_;
   bool is_eof_;
@@ -600,49 +617,56 @@ jdwpTransportError FdForwardTransport::ReadPacket(jdwpPacket* pkt) {
   }
 }
 
-// A class that writes a packet to the transport.
+// A class that writes a packet to the transport. The header is assembled on
+// the stack and sent together with the caller's payload in one gathering
+// write, so the payload - megabytes for a heap dump reply - is never copied
+// into a staging buffer first.
 class PacketWriter {
  public:
   PacketWriter(FdForwardTransport* transport, const jdwpPacket* pkt)
-      : transport_(transport), pkt_(pkt), data_() {}
+      : transport_(transport), pkt_(pkt) {}
 
   bool WriteFully() {
-    PushInt32(pkt_->type.cmd.len);
-    PushInt32(pkt_->type.cmd.id);
-    PushByte(pkt_->type.cmd.flags);
+    if (pkt_->type.cmd.len < 11) {
+      transport_->DT_IO_ERROR("Packet with len < 11 written!");
+      return false;
+    }
+    uint8_t header[kPacketHeaderLen];
+    StoreInt32(&header[0], pkt_->type.cmd.len);
+    StoreInt32(&header[4], pkt_->type.cmd.id);
+    header[8] = pkt_->type.cmd.flags;
+    void* data;
+    size_t data_len;
     if ((pkt_->type.reply.flags & JDWPTRANSPORT_FLAGS_REPLY) == JDWPTRANSPORT_FLAGS_REPLY) {
-      PushInt16(pkt_->type.reply.errorCode);
-      PushData(pkt_->type.reply.data, pkt_->type.reply.len - 11);
+      StoreInt16(&header[9], pkt_->type.reply.errorCode);
+      data = pkt_->type.reply.data;
+      data_len = pkt_->type.reply.len - 11;
     } else {
-      PushByte(pkt_->type.cmd.cmdSet);
-      PushByte(pkt_->type.cmd.cmd);
-      PushData(pkt_->type.cmd.data, pkt_->type.cmd.len - 11);
+      header[9] = pkt_->type.cmd.cmdSet;
+      header[10] = pkt_->type.cmd.cmd;
+      data = pkt_->type.cmd.data;
+      data_len = pkt_->type.cmd.len - 11;
     }
-    IOResult res = transport_->WriteFully(data_.data(), data_.size());
+    struct iovec iov[2] = {
+      { header, sizeof(header) },
+      { data, data_len },
+    };
+    IOResult res = transport_->WritevFully(iov, data_len > 0 ? 2 : 1);
     return res == IOResult::kOk;
   }
 
  private:
-  void PushInt32(int32_t data) {
+  static void StoreInt32(uint8_t* p, int32_t data) {
     data = HostToNetwork(data);
-    PushData(&data, sizeof(data));
+    memcpy(p, &data, sizeof(data));
   }
-  void PushInt16(int16_t data) {
+  static void StoreInt16(uint8_t* p, int16_t data) {
     data = HostToNetwork(data);
-    PushData(&data, sizeof(data));
-  }
-  void PushByte(jbyte data) {
-    data_.push_back(HostToNetwork(data));
-  }
-
-  void PushData(void* d, size_t size) {
-    uint8_t* bytes = reinterpret_cast<uint8_t*>(d);
-    data_.insert(data_.end(), bytes, bytes + size);
+    memcpy(p, &data, sizeof(data));
   }
 
   FdForwardTransport* transport_;
   const jdwpPacket* pkt_;
-  std::vector<uint8_t> data_;
 };
 
 jdwpTransportError FdForwardTransport::WritePacket(const jdwpPacket* pkt) {
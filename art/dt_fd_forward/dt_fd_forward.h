@@ -43,6 +43,7 @@
 
 #include <arpa/inet.h>
 #include <sys/eventfd.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <poll.h>
 
@@ -111,6 +112,11 @@ class FdForwardTransport : public jdwpTransportEnv {
 
   IOResult WriteFully(const void* data, size_t ndata);  // REQUIRES(!state_mutex_);
   IOResult WriteFullyWithoutChecks(const void* data, size_t ndata);  // REQUIRES(state_mutex_);
+  // Gathering write of all the iovecs in one writev() per wakeup, so the
+  // packet header and payload go out without being copied into a contiguous
+  // buffer first. The iovec array is consumed (modified in place).
+  IOResult WritevFully(struct iovec* iov, int iovcnt);  // REQUIRES(!state_mutex_);
+  IOResult WritevFullyWithoutChecks(struct iovec* iov, int iovcnt);  // REQUIRES(state_mutex_);
   IOResult ReadFully(void* data, size_t ndata);  // REQUIRES(!state_mutex_);
   IOResult ReadUpToMax(void* data, size_t ndata, /*out*/size_t* amount_read);
       // REQUIRES(state_mutex_);
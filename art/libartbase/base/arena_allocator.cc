@@ -175,6 +175,38 @@ void ArenaAllocatorStatsImpl<kCount>::Dump(std::ostream& os, const Arena* first,
 template class ArenaAllocatorStatsImpl<kArenaAllocatorCountAllocations || kIsDebugBuild>;
 #pragma GCC diagnostic pop
 
+std::atomic<uint64_t> ArenaAllocatorAccounting::num_allocators_(0u);
+std::atomic<uint64_t> ArenaAllocatorAccounting::total_peak_bytes_(0u);
+std::atomic<uint64_t> ArenaAllocatorAccounting::max_peak_bytes_(0u);
+std::atomic<uint64_t> ArenaAllocatorAccounting::total_arenas_(0u);
+std::atomic<uint64_t> ArenaAllocatorAccounting::total_realloc_copy_bytes_(0u);
+
+void ArenaAllocatorAccounting::RecordAllocatorDestroyed(size_t peak_bytes,
+                                                        size_t num_arenas,
+                                                        size_t realloc_copy_bytes) {
+  if (num_arenas == 0u) {
+    return;
+  }
+  num_allocators_.fetch_add(1u, std::memory_order_relaxed);
+  total_peak_bytes_.fetch_add(peak_bytes, std::memory_order_relaxed);
+  total_arenas_.fetch_add(num_arenas, std::memory_order_relaxed);
+  total_realloc_copy_bytes_.fetch_add(realloc_copy_bytes, std::memory_order_relaxed);
+  uint64_t max = max_peak_bytes_.load(std::memory_order_relaxed);
+  while (max < peak_bytes &&
+         !max_peak_bytes_.compare_exchange_weak(max, peak_bytes, std::memory_order_relaxed)) {
+  }
+}
+
+void ArenaAllocatorAccounting::Dump(std::ostream& os) {
+  uint64_t num_allocators = num_allocators_.load(std::memory_order_relaxed);
+  os << "Arena accounting: allocators: " << num_allocators
+     << ", total peak: " << total_peak_bytes_.load(std::memory_order_relaxed)
+     << ", max peak: " << max_peak_bytes_.load(std::memory_order_relaxed)
+     << ", arenas: " << total_arenas_.load(std::memory_order_relaxed)
+     << ", realloc copy bytes: " << total_realloc_copy_bytes_.load(std::memory_order_relaxed)
+     << "\n";
+}
+
 void ArenaAllocatorMemoryTool::DoMakeDefined(void* ptr, size_t size) {
   MEMORY_TOOL_MAKE_DEFINED(ptr, size);
 }
@@ -210,7 +242,9 @@ ArenaAllocator::ArenaAllocator(ArenaPool* pool)
     begin_(nullptr),
     end_(nullptr),
     ptr_(nullptr),
-    arena_head_(nullptr) {
+    arena_head_(nullptr),
+    num_arenas_(0u),
+    realloc_copy_bytes_(0u) {
 }
 
 void ArenaAllocator::UpdateBytesAllocated() {
@@ -267,6 +301,7 @@ void* ArenaAllocator::AllocWithMemoryToolAlign16(size_t bytes, ArenaAllocKind ki
 ArenaAllocator::~ArenaAllocator() {
   // Reclaim all the arenas by giving them back to the thread pool.
   UpdateBytesAllocated();
+  ArenaAllocatorAccounting::RecordAllocatorDestroyed(BytesUsed(), num_arenas_, realloc_copy_bytes_);
   pool_->FreeArenaChain(arena_head_);
 }
 
@@ -274,6 +309,7 @@ uint8_t* ArenaAllocator::AllocFromNewArena(size_t bytes) {
   Arena* new_arena = pool_->AllocArena(std::max(arena_allocator::kArenaDefaultSize, bytes));
   DCHECK(new_arena != nullptr);
   DCHECK_LE(bytes, new_arena->Size());
+  ++num_arenas_;
   if (static_cast<size_t>(end_ - ptr_) > new_arena->Size() - bytes) {
     // The old arena has more space remaining than the new one, so keep using it.
     // This can happen when the requested size is over half of the default size.
@@ -20,6 +20,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <atomic>
+
 #include "bit_utils.h"
 #include "debug_stack.h"
 #include "dchecked_vector.h"
@@ -150,6 +152,33 @@ class ArenaAllocatorStatsImpl {
 
 using ArenaAllocatorStats = ArenaAllocatorStatsImpl<kArenaAllocatorCountAllocations>;
 
+// Always-on, production-safe accounting of arena memory across all
+// ArenaAllocators of the process. Unlike ArenaAllocatorStatsImpl<true>,
+// which is normally compiled only into debug builds and tracks every
+// allocation by kind, this maintains a handful of counters cheap enough for
+// release builds: each ArenaAllocator tracks its own totals in plain fields
+// (the allocator is single-threaded) and folds them into the process-wide
+// relaxed atomic counters once, when it is destroyed.
+class ArenaAllocatorAccounting {
+ public:
+  // Folds the totals of a destroyed allocator into the process-wide counters.
+  // Allocators that never allocated are not counted.
+  static void RecordAllocatorDestroyed(size_t peak_bytes,
+                                       size_t num_arenas,
+                                       size_t realloc_copy_bytes);
+
+  // Writes a single-line summary of the process-wide counters, suitable for
+  // appending to the dex2oat timing logger dump.
+  static void Dump(std::ostream& os);
+
+ private:
+  static std::atomic<uint64_t> num_allocators_;
+  static std::atomic<uint64_t> total_peak_bytes_;
+  static std::atomic<uint64_t> max_peak_bytes_;
+  static std::atomic<uint64_t> total_arenas_;
+  static std::atomic<uint64_t> total_realloc_copy_bytes_;
+};
+
 class ArenaAllocatorMemoryTool {
  public:
   bool IsRunningOnMemoryTool() { return kMemoryToolIsAvailable; }
@@ -329,6 +358,7 @@ class ArenaAllocator
     }
     auto* new_ptr = Alloc(new_size, kind);  // Note: Alloc will take care of aligning new_size.
     memcpy(new_ptr, ptr, ptr_size);
+    realloc_copy_bytes_ += ptr_size;
     // TODO: Call free on ptr if linear alloc supports free.
     return new_ptr;
   }
@@ -377,6 +407,12 @@ class ArenaAllocator
   uint8_t* ptr_;
   Arena* arena_head_;
 
+  // Always-on accounting folded into ArenaAllocatorAccounting on destruction.
+  // Arenas are only released when the allocator dies, so the final BytesUsed()
+  // is also the allocator's high-water mark.
+  size_t num_arenas_;
+  size_t realloc_copy_bytes_;
+
   template <typename U>
   friend class ArenaAllocatorAdapter;
 
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <sstream>
+
 #include "arena_allocator-inl.h"
 #include "arena_bit_vector.h"
 #include "base/common_art_test.h"
@@ -349,5 +351,24 @@ TEST_F(ArenaAllocatorTest, ReallocAlignment) {
   }
 }
 
+TEST_F(ArenaAllocatorTest, Accounting) {
+  // The process-wide counters are shared with other tests, so compare dumps
+  // rather than asserting absolute values.
+  auto dump = []() {
+    std::ostringstream oss;
+    ArenaAllocatorAccounting::Dump(oss);
+    return oss.str();
+  };
+  const std::string before = dump();
+  EXPECT_NE(before.find("Arena accounting:"), std::string::npos);
+  {
+    MallocArenaPool pool;
+    ArenaAllocator allocator(&pool);
+    allocator.Alloc(ArenaAllocator::kAlignment);
+    // Counters are only folded in when the allocator is destroyed.
+    EXPECT_EQ(before, dump());
+  }
+  EXPECT_NE(before, dump());
+}
 
 }  // namespace art
@@ -162,15 +162,17 @@ bool BitVector::Union(const BitVector* src) {
     DCHECK_LT(static_cast<uint32_t> (highest_bit), storage_size_ * kWordBits);
   }
 
+  // Accumulate the change mask instead of branching per word; the unconditional store
+  // keeps the loop branch-free so that the compiler can vectorize it with the baseline
+  // SIMD instruction set (NEON/SSE2), like BaseBitVectorArray::UnionRows().
+  uint32_t changed_bits = 0u;
   for (uint32_t idx = 0; idx < src_size; idx++) {
     uint32_t existing = storage_[idx];
     uint32_t update = existing | src->GetRawStorageWord(idx);
-    if (existing != update) {
-      changed = true;
-      storage_[idx] = update;
-    }
+    changed_bits |= existing ^ update;
+    storage_[idx] = update;
   }
-  return changed;
+  return changed || (changed_bits != 0u);
 }
 
 bool BitVector::UnionIfNotIn(const BitVector* union_with, const BitVector* not_in) {
@@ -196,26 +198,24 @@ bool BitVector::UnionIfNotIn(const BitVector* union_with, const BitVector* not_i
 
   uint32_t not_in_size = not_in->GetStorageSize();
 
+  // As in Union(), keep the loops branch-free so that they can be vectorized.
+  uint32_t changed_bits = 0u;
   uint32_t idx = 0;
   for (; idx < std::min(not_in_size, union_with_size); idx++) {
     uint32_t existing = storage_[idx];
     uint32_t update = existing |
         (union_with->GetRawStorageWord(idx) & ~not_in->GetRawStorageWord(idx));
-    if (existing != update) {
-      changed = true;
-      storage_[idx] = update;
-    }
+    changed_bits |= existing ^ update;
+    storage_[idx] = update;
   }
 
   for (; idx < union_with_size; idx++) {
     uint32_t existing = storage_[idx];
     uint32_t update = existing | union_with->GetRawStorageWord(idx);
-    if (existing != update) {
-      changed = true;
-      storage_[idx] = update;
-    }
+    changed_bits |= existing ^ update;
+    storage_[idx] = update;
   }
-  return changed;
+  return changed || (changed_bits != 0u);
 }
 
 void BitVector::Subtract(const BitVector *src) {
@@ -24,6 +24,7 @@
 
 #include <android-base/logging.h>
 #include "arena_allocator-inl.h"
+#include "bit_utils.h"
 #include "mman.h"
 
 namespace art {
@@ -82,34 +83,84 @@ void Arena::Reset() {
   }
 }
 
-MallocArenaPool::MallocArenaPool() : free_arenas_(nullptr) {
+MallocArenaPool::MallocArenaPool() : free_list_bytes_(0u) {
+  for (std::atomic<Arena*>& free_list : free_lists_) {
+    free_list.store(nullptr, std::memory_order_relaxed);
+  }
 }
 
 MallocArenaPool::~MallocArenaPool() {
   ReclaimMemory();
 }
 
+size_t MallocArenaPool::FreeListIndex(size_t size) {
+  if (size < 2u * arena_allocator::kArenaDefaultSize) {
+    return 0u;
+  }
+  size_t index = static_cast<size_t>(MostSignificantBit(size / arena_allocator::kArenaDefaultSize));
+  return std::min(index, kNumFreeListClasses - 1u);
+}
+
+Arena* MallocArenaPool::TryPopFreeArena(size_t index) {
+  // Detach the entire list with an unconditional exchange; unlike a CAS-based pop of just
+  // the head node, this cannot suffer from ABA. A concurrent caller that observes the list
+  // as empty while we hold it simply allocates a fresh arena.
+  Arena* list = free_lists_[index].exchange(nullptr, std::memory_order_acquire);
+  if (list == nullptr) {
+    return nullptr;
+  }
+  Arena* ret = list;
+  if (list->next_ != nullptr) {
+    // Return the remainder of the chain; it is privately owned here, so walking it to
+    // find the tail is safe.
+    Arena* rest = list->next_;
+    Arena* last = rest;
+    while (last->next_ != nullptr) {
+      last = last->next_;
+    }
+    PushFreeArenaChain(index, rest, last);
+  }
+  ret->next_ = nullptr;
+  free_list_bytes_.fetch_sub(ret->GetBytesAllocated(), std::memory_order_relaxed);
+  return ret;
+}
+
+void MallocArenaPool::PushFreeArenaChain(size_t index, Arena* first, Arena* last) {
+  // Pushing with a CAS on the head is ABA-safe: the only value read from the list is the
+  // head pointer itself, which is re-read on every retry.
+  Arena* head = free_lists_[index].load(std::memory_order_relaxed);
+  do {
+    last->next_ = head;
+  } while (!free_lists_[index].compare_exchange_weak(
+      head, first, std::memory_order_release, std::memory_order_relaxed));
+}
+
 void MallocArenaPool::ReclaimMemory() {
-  while (free_arenas_ != nullptr) {
-    Arena* arena = free_arenas_;
-    free_arenas_ = free_arenas_->next_;
-    delete arena;
+  for (std::atomic<Arena*>& free_list : free_lists_) {
+    Arena* arena = free_list.exchange(nullptr, std::memory_order_acquire);
+    while (arena != nullptr) {
+      Arena* next = arena->next_;
+      free_list_bytes_.fetch_sub(arena->GetBytesAllocated(), std::memory_order_relaxed);
+      delete arena;
+      arena = next;
+    }
   }
 }
 
 void MallocArenaPool::LockReclaimMemory() {
-  std::lock_guard<std::mutex> lock(lock_);
+  // The free lists are detached atomically, so there is nothing further to lock.
   ReclaimMemory();
 }
 
 Arena* MallocArenaPool::AllocArena(size_t size) {
-  Arena* ret = nullptr;
-  {
-    std::lock_guard<std::mutex> lock(lock_);
-    if (free_arenas_ != nullptr && LIKELY(free_arenas_->Size() >= size)) {
-      ret = free_arenas_;
-      free_arenas_ = free_arenas_->next_;
-    }
+  size_t index = FreeListIndex(size);
+  Arena* ret = TryPopFreeArena(index);
+  if (ret != nullptr && UNLIKELY(ret->Size() < size)) {
+    // Possible in the first class (which also holds arenas smaller than the default size)
+    // and in the last one (which has no upper bound); leave it for a smaller request.
+    free_list_bytes_.fetch_add(ret->GetBytesAllocated(), std::memory_order_relaxed);
+    PushFreeArenaChain(index, ret, ret);
+    ret = nullptr;
   }
   if (ret == nullptr) {
     ret = new MallocArena(size);
@@ -123,12 +174,7 @@ void MallocArenaPool::TrimMaps() {
 }
 
 size_t MallocArenaPool::GetBytesAllocated() const {
-  size_t total = 0;
-  std::lock_guard<std::mutex> lock(lock_);
-  for (Arena* arena = free_arenas_; arena != nullptr; arena = arena->next_) {
-    total += arena->GetBytesAllocated();
-  }
-  return total;
+  return free_list_bytes_.load(std::memory_order_relaxed);
 }
 
 void MallocArenaPool::FreeArenaChain(Arena* first) {
@@ -148,14 +194,26 @@ void MallocArenaPool::FreeArenaChain(Arena* first) {
     return;
   }
 
-  if (first != nullptr) {
-    Arena* last = first;
-    while (last->next_ != nullptr) {
-      last = last->next_;
+  // Bucket the chain by size class, then publish each bucket with a single push.
+  Arena* firsts[kNumFreeListClasses] = {};
+  Arena* lasts[kNumFreeListClasses] = {};
+  size_t freed_bytes = 0u;
+  while (first != nullptr) {
+    Arena* next = first->next_;
+    size_t index = FreeListIndex(first->Size());
+    first->next_ = firsts[index];
+    firsts[index] = first;
+    if (lasts[index] == nullptr) {
+      lasts[index] = first;
+    }
+    freed_bytes += first->GetBytesAllocated();
+    first = next;
+  }
+  free_list_bytes_.fetch_add(freed_bytes, std::memory_order_relaxed);
+  for (size_t i = 0; i != kNumFreeListClasses; ++i) {
+    if (firsts[i] != nullptr) {
+      PushFreeArenaChain(i, firsts[i], lasts[i]);
     }
-    std::lock_guard<std::mutex> lock(lock_);
-    last->next_ = free_arenas_;
-    free_arenas_ = first;
   }
 }
 
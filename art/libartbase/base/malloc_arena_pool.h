@@ -17,7 +17,7 @@
 #ifndef ART_LIBARTBASE_BASE_MALLOC_ARENA_POOL_H_
 #define ART_LIBARTBASE_BASE_MALLOC_ARENA_POOL_H_
 
-#include <mutex>
+#include <atomic>
 
 #include "arena_allocator.h"
 
@@ -36,9 +36,26 @@ class MallocArenaPool final : public ArenaPool {
   void TrimMaps() override;
 
  private:
-  Arena* free_arenas_;
-  // Use a std::mutex here as Arenas are at the bottom of the lock hierarchy when malloc is used.
-  mutable std::mutex lock_;
+  // Freed arenas are kept in lock-free stacks stratified by size so that parallel
+  // compilation threads recycle arenas without serializing on a pool-wide lock.
+  // Class `i` holds arenas of sizes [kArenaDefaultSize << i, kArenaDefaultSize << (i + 1)),
+  // except that the first class also holds anything smaller and the last class also holds
+  // anything larger.
+  static constexpr size_t kNumFreeListClasses = 8u;
+
+  // Index of the free list to which an arena of size `size` belongs; also the index of
+  // the free list from which a request for `size` bytes is served.
+  static size_t FreeListIndex(size_t size);
+
+  // Take one arena from free list `index`, or return null if it is (momentarily) empty;
+  // the caller then falls back to allocating a fresh arena.
+  Arena* TryPopFreeArena(size_t index);
+  // Push the chain `first`..`last` (linked through Arena::next_) onto free list `index`.
+  void PushFreeArenaChain(size_t index, Arena* first, Arena* last);
+
+  std::atomic<Arena*> free_lists_[kNumFreeListClasses];
+  // Sum of Arena::GetBytesAllocated() over all pooled arenas, for GetBytesAllocated().
+  std::atomic<size_t> free_list_bytes_;
 
   DISALLOW_COPY_AND_ASSIGN(MallocArenaPool);
 };
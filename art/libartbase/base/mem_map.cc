@@ -62,6 +62,23 @@ static Maps* gMaps GUARDED_BY(MemMap::GetMemMapsLock()) = nullptr;
 // A map containing unique strings used for indentifying anonymous mappings
 static std::map<std::string, int> debugStrMap GUARDED_BY(MemMap::GetMemMapsLock());
 
+// Cache of recently released anonymous mappings, keyed by page-aligned size. Allocators
+// such as the arena pools repeatedly create and destroy maps of the same few sizes;
+// retaining the released ranges as PROT_NONE reservations lets MapAnonymous() satisfy
+// such requests without going back to the kernel. Entries hold no committed pages (they
+// are replaced with fresh anonymous mappings on insertion), only address space.
+using ReservationCache = std::multimap<size_t, void*>;
+static ReservationCache* gCachedReservations GUARDED_BY(MemMap::GetMemMapsLock()) = nullptr;
+static size_t gCachedReservationBytes GUARDED_BY(MemMap::GetMemMapsLock()) = 0u;
+
+// Do not cache unusually large maps such as heap spaces; the cache targets the small,
+// frequently recycled mappings.
+static constexpr size_t kReservationCacheMaxEntrySize = 4 * MB;
+// Once insertions push the cache above the high watermark, trim it back down to the low
+// watermark, unmapping the largest entries first.
+static constexpr size_t kReservationCacheHighWatermark = 16 * MB;
+static constexpr size_t kReservationCacheLowWatermark = 8 * MB;
+
 // Retrieve iterator to a `gMaps` entry that is known to exist.
 Maps::iterator GetGMapsEntry(const MemMap& map) REQUIRES(MemMap::GetMemMapsLock()) {
   DCHECK(map.IsValid());
@@ -301,6 +318,106 @@ void MemMap::SetDebugName(void* map_ptr, const char* name, size_t size) {
 #endif
 }
 
+void MemMap::TrimReservationCacheLocked(size_t target_bytes) {
+  DCHECK(gCachedReservations != nullptr);
+  while (gCachedReservationBytes > target_bytes) {
+    DCHECK(!gCachedReservations->empty());
+    auto it = gCachedReservations->end();
+    --it;
+    if (TargetMUnmap(it->second, it->first) == -1) {
+      PLOG(FATAL) << "munmap failed";
+    }
+    gCachedReservationBytes -= it->first;
+    gCachedReservations->erase(it);
+  }
+}
+
+bool MemMap::TryCacheReleasedReservation(void* base_begin, size_t base_size) {
+#ifdef _WIN32
+  UNUSED(base_begin, base_size);
+  return false;
+#else
+  if (kRunningOnMemoryTool) {
+    // Memory tools rely on fresh mappings to (re)establish red zones and poisoning.
+    return false;
+  }
+  if (base_size > kReservationCacheMaxEntrySize) {
+    return false;
+  }
+  DCHECK_ALIGNED(base_begin, kPageSize);
+  DCHECK_ALIGNED(base_size, kPageSize);
+  // Replace the range with a fresh anonymous PROT_NONE mapping instead of reprotecting
+  // in place: this releases the committed pages (the equivalent of madvise(MADV_DONTNEED),
+  // and also correct when the released map was file-backed) and guarantees that a later
+  // reuse observes zero-filled pages, matching normal MapAnonymous() behavior.
+  void* actual = TargetMMap(base_begin,
+                            base_size,
+                            PROT_NONE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+                            -1,
+                            0);
+  if (actual == MAP_FAILED) {
+    return false;
+  }
+  CHECK_EQ(actual, base_begin);
+  std::lock_guard<std::mutex> mu(*mem_maps_lock_);
+  DCHECK(gCachedReservations != nullptr);
+  gCachedReservations->emplace(base_size, base_begin);
+  gCachedReservationBytes += base_size;
+  if (gCachedReservationBytes > kReservationCacheHighWatermark) {
+    TrimReservationCacheLocked(kReservationCacheLowWatermark);
+  }
+  return true;
+#endif
+}
+
+void* MemMap::TryDequeueCachedReservation(size_t byte_count, int prot, bool low_4gb) {
+#ifdef _WIN32
+  UNUSED(byte_count, prot, low_4gb);
+  return nullptr;
+#else
+  if (kRunningOnMemoryTool) {
+    return nullptr;
+  }
+#ifndef __LP64__
+  UNUSED(low_4gb);
+#endif
+  DCHECK_ALIGNED(byte_count, kPageSize);
+  void* base_begin = nullptr;
+  {
+    std::lock_guard<std::mutex> mu(*mem_maps_lock_);
+    if (gCachedReservations == nullptr) {
+      return nullptr;
+    }
+    auto range = gCachedReservations->equal_range(byte_count);
+    for (auto it = range.first; it != range.second; ++it) {
+#ifdef __LP64__
+      if (low_4gb && reinterpret_cast<uintptr_t>(it->second) + byte_count > 4 * GB) {
+        continue;
+      }
+#endif
+      base_begin = it->second;
+      gCachedReservationBytes -= byte_count;
+      gCachedReservations->erase(it);
+      break;
+    }
+  }
+  if (base_begin == nullptr) {
+    return nullptr;
+  }
+  // The cached range is a PROT_NONE reservation; reprotect it as requested. This is the
+  // only syscall on a cache hit, and there is none at all for PROT_NONE reservations.
+  if (prot != PROT_NONE && mprotect(base_begin, byte_count, prot) != 0) {
+    // Extremely unlikely; fall back to a fresh mapping rather than failing the request.
+    if (TargetMUnmap(base_begin, byte_count) == -1) {
+      PLOG(FATAL) << "munmap failed";
+    }
+    return nullptr;
+  }
+  return base_begin;
+#endif
+}
+
 MemMap MemMap::MapAnonymous(const char* name,
                             uint8_t* addr,
                             size_t byte_count,
@@ -336,6 +453,23 @@ MemMap MemMap::MapAnonymous(const char* name,
     flags |= MAP_FIXED;
   }
 
+  if (addr == nullptr && !reuse && reservation == nullptr) {
+    // A request with no placement constraints may be satisfied from the reservation cache.
+    void* cached = TryDequeueCachedReservation(page_aligned_byte_count, prot, low_4gb);
+    if (cached != nullptr) {
+      if (use_debug_name) {
+        SetDebugName(cached, name, page_aligned_byte_count);
+      }
+      return MemMap(name,
+                    reinterpret_cast<uint8_t*>(cached),
+                    byte_count,
+                    cached,
+                    page_aligned_byte_count,
+                    prot,
+                    reuse);
+    }
+  }
+
   unique_fd fd;
 
   // We need to store and potentially set an error number for pretty printing of errors
@@ -610,7 +744,8 @@ void MemMap::DoReset() {
 
   if (!reuse_) {
     MEMORY_TOOL_MAKE_UNDEFINED(base_begin_, base_size_);
-    if (!already_unmapped_) {
+    if (!already_unmapped_ &&
+        (redzone_size_ != 0 || !TryCacheReleasedReservation(base_begin_, base_size_))) {
       int result = TargetMUnmap(base_begin_, real_base_size);
       if (result == -1) {
         PLOG(FATAL) << "munmap failed";
@@ -994,6 +1129,9 @@ void MemMap::Init() {
   std::lock_guard<std::mutex> mu(*mem_maps_lock_);
   DCHECK(gMaps == nullptr);
   gMaps = new Maps;
+  DCHECK(gCachedReservations == nullptr);
+  gCachedReservations = new ReservationCache;
+  DCHECK_EQ(gCachedReservationBytes, 0u);
 
   TargetMMapInit();
 }
@@ -1009,6 +1147,10 @@ void MemMap::Shutdown() {
     DCHECK(gMaps != nullptr);
     delete gMaps;
     gMaps = nullptr;
+    DCHECK(gCachedReservations != nullptr);
+    TrimReservationCacheLocked(0u);
+    delete gCachedReservations;
+    gCachedReservations = nullptr;
   }
   delete mem_maps_lock_;
   mem_maps_lock_ = nullptr;
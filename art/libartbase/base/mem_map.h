@@ -360,6 +360,15 @@ class MemMap {
                                              off_t offset)
       REQUIRES(!MemMap::mem_maps_lock_);
 
+  // Cache of recently released anonymous reservations, used to satisfy `MapAnonymous()`
+  // requests of a matching size without new mmap()/munmap() syscalls. See `MapAnonymous()`.
+  static void* TryDequeueCachedReservation(size_t byte_count, int prot, bool low_4gb)
+      REQUIRES(!MemMap::mem_maps_lock_);
+  static bool TryCacheReleasedReservation(void* base_begin, size_t base_size)
+      REQUIRES(!MemMap::mem_maps_lock_);
+  static void TrimReservationCacheLocked(size_t target_bytes)
+      REQUIRES(MemMap::mem_maps_lock_);
+
   // Release memory owned by a reservation mapping.
   void ReleaseReservedMemory(size_t byte_count);
 
@@ -17,6 +17,9 @@
 #ifndef ART_LIBELFFILE_ELF_ELF_BUILDER_H_
 #define ART_LIBELFFILE_ELF_ELF_BUILDER_H_
 
+#include <string.h>
+
+#include <array>
 #include <vector>
 #include <deque>
 
@@ -574,8 +577,8 @@ class ElfBuilder final {
     // and partially written data if we suddenly lose power, for example.
     stream_.Flush();
 
-    // The main ELF header.
-    Elf_Ehdr elf_header = MakeElfHeader(isa_);
+    // The main ELF header, patched from the per-ISA template.
+    Elf_Ehdr elf_header = ElfHeaderTemplate(isa_);
     elf_header.e_shoff = section_headers_offset;
     elf_header.e_shnum = shdrs.size();
     elf_header.e_shstrndx = shstrtab_.GetSectionIndex();
@@ -589,9 +592,16 @@ class ElfBuilder final {
       elf_header.e_phnum = phdrs.size();
     }
 
+    // Gather the ELF header and the program headers into a single write.
+    // The underlying stream is typically an unbuffered file, so this is
+    // one syscall instead of two for every file we produce.
+    uint8_t headers[sizeof(Elf_Ehdr) + sizeof(Elf_Phdr) * kMaxProgramHeaders];
+    memcpy(headers, &elf_header, sizeof(elf_header));
+    if (!phdrs.empty()) {
+      memcpy(headers + sizeof(elf_header), phdrs.data(), phdrs.size() * sizeof(phdrs[0]));
+    }
     stream_.Seek(0, kSeekSet);
-    stream_.WriteFully(&elf_header, sizeof(elf_header));
-    stream_.WriteFully(phdrs.data(), phdrs.size() * sizeof(phdrs[0]));
+    stream_.WriteFully(headers, sizeof(elf_header) + phdrs.size() * sizeof(phdrs[0]));
     stream_.Flush();
 
     return file_size;
@@ -824,6 +834,38 @@ class ElfBuilder final {
   }
 
  private:
+  // Everything in the ELF header except the section and program header
+  // counts/offsets depends only on the ISA, so build the skeleton once per
+  // ISA and reuse it for every file written in this process (dex2oat can
+  // produce many files per invocation). End() patches the per-file fields.
+  static const Elf_Ehdr& ElfHeaderTemplate(InstructionSet isa) {
+    switch (isa) {
+      case InstructionSet::kArm:
+        // Fall through.
+      case InstructionSet::kThumb2: {
+        static const Elf_Ehdr header = MakeElfHeader(InstructionSet::kThumb2);
+        return header;
+      }
+      case InstructionSet::kArm64: {
+        static const Elf_Ehdr header = MakeElfHeader(InstructionSet::kArm64);
+        return header;
+      }
+      case InstructionSet::kX86: {
+        static const Elf_Ehdr header = MakeElfHeader(InstructionSet::kX86);
+        return header;
+      }
+      case InstructionSet::kX86_64: {
+        static const Elf_Ehdr header = MakeElfHeader(InstructionSet::kX86_64);
+        return header;
+      }
+      default: {
+        // MakeElfHeader() aborts for unsupported ISAs.
+        static const Elf_Ehdr header = MakeElfHeader(isa);
+        return header;
+      }
+    }
+  }
+
   static Elf_Ehdr MakeElfHeader(InstructionSet isa) {
     Elf_Ehdr elf_header = Elf_Ehdr();
     switch (isa) {
@@ -882,8 +924,9 @@ class ElfBuilder final {
   // Create program headers based on written sections.
   std::vector<Elf_Phdr> MakeProgramHeaders() {
     CHECK(!sections_.empty());
-    std::vector<Elf_Phdr> phdrs;
-    {
+    // The fixed prefix does not depend on the sections, so compute it once.
+    static const std::array<Elf_Phdr, 2> prefix = []() {
+      std::array<Elf_Phdr, 2> entries;
       // The program headers must start with PT_PHDR which is used in
       // loaded process to determine the number of program headers.
       Elf_Phdr phdr = Elf_Phdr();
@@ -892,7 +935,7 @@ class ElfBuilder final {
       phdr.p_offset  = phdr.p_vaddr = phdr.p_paddr = sizeof(Elf_Ehdr);
       phdr.p_filesz  = phdr.p_memsz = 0;  // We need to fill this later.
       phdr.p_align   = sizeof(Elf_Off);
-      phdrs.push_back(phdr);
+      entries[0] = phdr;
       // Tell the linker to mmap the start of file to memory.
       Elf_Phdr load = Elf_Phdr();
       load.p_type    = PT_LOAD;
@@ -900,8 +943,10 @@ class ElfBuilder final {
       load.p_offset  = load.p_vaddr = load.p_paddr = 0;
       load.p_filesz  = load.p_memsz = sizeof(Elf_Ehdr) + sizeof(Elf_Phdr) * kMaxProgramHeaders;
       load.p_align   = kPageSize;
-      phdrs.push_back(load);
-    }
+      entries[1] = load;
+      return entries;
+    }();
+    std::vector<Elf_Phdr> phdrs(prefix.begin(), prefix.end());
     // Create program headers for sections.
     for (auto* section : sections_) {
       const Elf_Shdr& shdr = section->header_;
@@ -21,8 +21,11 @@
 #include "native_loader_namespace.h"
 
 #include <dlfcn.h>
+#include <sys/stat.h>
 
+#include <atomic>
 #include <functional>
+#include <vector>
 
 #include <android-base/strings.h>
 #include <log/log.h>
@@ -47,8 +50,45 @@ std::string GetLinkerError(bool is_bridged) {
   return std::string(msg);
 }
 
+// Bumped whenever a namespace is created or linked; negative dlopen caches
+// populated under an older generation are stale.
+std::atomic<uint32_t> g_config_generation(1);
+
+bool (*g_path_exists_for_testing)(const char* path) = nullptr;
+
+bool PathExists(const std::string& path) {
+  if (g_path_exists_for_testing != nullptr) {
+    return g_path_exists_for_testing(path.c_str());
+  }
+  struct stat st;
+  return stat(path.c_str(), &st) == 0;
+}
+
+// Drops search path entries that do not exist at namespace setup time. Each
+// missing directory would otherwise be re-probed by the linker with an ENOENT
+// open for every library resolved in this namespace; one stat() per directory
+// here replaces those.
+std::string FilterExistingPaths(const std::string& search_paths) {
+  if (search_paths.empty()) {
+    return search_paths;
+  }
+  std::vector<std::string> existing;
+  for (const std::string& path : base::Split(search_paths, ":")) {
+    if (path.empty() || PathExists(path)) {
+      existing.push_back(path);
+    } else {
+      ALOGV("dropping nonexistent search path %s", path.c_str());
+    }
+  }
+  return base::Join(existing, ':');
+}
+
 }  // namespace
 
+void NativeLoaderNamespace::SetPathExistsFunctionForTesting(bool (*path_exists)(const char* path)) {
+  g_path_exists_for_testing = path_exists;
+}
+
 Result<NativeLoaderNamespace> NativeLoaderNamespace::GetExportedNamespace(const std::string& name,
                                                                           bool is_bridged) {
   if (!is_bridged) {
@@ -120,18 +160,25 @@ Result<NativeLoaderNamespace> NativeLoaderNamespace::Create(
     type |= ANDROID_NAMESPACE_TYPE_EXEMPT_LIST_ENABLED;
   }
 
+  // Probe the candidate directories once here rather than letting the linker
+  // rediscover missing ones on every load. permitted_paths are left alone:
+  // they grant access, they are not probed.
+  const std::string existing_search_paths = FilterExistingPaths(search_paths);
+
   if (!is_bridged) {
-    android_namespace_t* raw =
-        android_create_namespace(name.c_str(), nullptr, search_paths.c_str(), type,
-                                 permitted_paths.c_str(), effective_parent.ToRawAndroidNamespace());
+    android_namespace_t* raw = android_create_namespace(
+        name.c_str(), nullptr, existing_search_paths.c_str(), type, permitted_paths.c_str(),
+        effective_parent.ToRawAndroidNamespace());
     if (raw != nullptr) {
+      g_config_generation.fetch_add(1, std::memory_order_relaxed);
       return NativeLoaderNamespace(name, raw);
     }
   } else {
     native_bridge_namespace_t* raw = NativeBridgeCreateNamespace(
-        name.c_str(), nullptr, search_paths.c_str(), type, permitted_paths.c_str(),
+        name.c_str(), nullptr, existing_search_paths.c_str(), type, permitted_paths.c_str(),
         effective_parent.ToRawNativeBridgeNamespace());
     if (raw != nullptr) {
+      g_config_generation.fetch_add(1, std::memory_order_relaxed);
       return NativeLoaderNamespace(name, raw);
     }
   }
@@ -147,12 +194,14 @@ Result<void> NativeLoaderNamespace::Link(const NativeLoaderNamespace* target,
     if (android_link_namespaces(this->ToRawAndroidNamespace(),
                                 target == nullptr ? nullptr : target->ToRawAndroidNamespace(),
                                 shared_libs.c_str())) {
+      g_config_generation.fetch_add(1, std::memory_order_relaxed);
       return {};
     }
   } else {
     if (NativeBridgeLinkNamespaces(this->ToRawNativeBridgeNamespace(),
                                    target == nullptr ? nullptr : target->ToRawNativeBridgeNamespace(),
                                    shared_libs.c_str())) {
+      g_config_generation.fetch_add(1, std::memory_order_relaxed);
       return {};
     }
   }
@@ -160,6 +209,20 @@ Result<void> NativeLoaderNamespace::Link(const NativeLoaderNamespace* target,
 }
 
 Result<void*> NativeLoaderNamespace::Load(const char* lib_name) const {
+  {
+    std::lock_guard<std::mutex> guard(negative_cache_->mutex);
+    const uint32_t generation = g_config_generation.load(std::memory_order_relaxed);
+    if (negative_cache_->generation != generation) {
+      negative_cache_->failed_libs.clear();
+      negative_cache_->generation = generation;
+    } else {
+      auto it = negative_cache_->failed_libs.find(lib_name);
+      if (it != negative_cache_->failed_libs.end()) {
+        return Error() << it->second << " (cached)";
+      }
+    }
+  }
+
   if (!IsBridged()) {
     android_dlextinfo extinfo;
     extinfo.flags = ANDROID_DLEXT_USE_NAMESPACE;
@@ -175,7 +238,18 @@ Result<void*> NativeLoaderNamespace::Load(const char* lib_name) const {
       return handle;
     }
   }
-  return Error() << GetLinkerError(IsBridged());
+
+  const std::string err = GetLinkerError(IsBridged());
+  // Only remember clean "not found" failures. Anything else (bad ELF, missing
+  // symbol, failed constructor) may not repeat, and its error message is more
+  // useful fresh.
+  if (err.find("not found") != std::string::npos) {
+    std::lock_guard<std::mutex> guard(negative_cache_->mutex);
+    if (negative_cache_->generation == g_config_generation.load(std::memory_order_relaxed)) {
+      negative_cache_->failed_libs.emplace(lib_name, err);
+    }
+  }
+  return Error() << err;
 }
 
 }  // namespace android
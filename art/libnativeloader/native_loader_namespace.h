@@ -19,7 +19,10 @@
 
 #if defined(ART_TARGET_ANDROID)
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -66,14 +69,33 @@ struct NativeLoaderNamespace {
                                                             bool is_bridged);
   static Result<NativeLoaderNamespace> GetSystemNamespace(bool is_bridged);
 
+  // Overrides the filesystem probe used to drop nonexistent search path
+  // entries in Create(). Tests run with search paths that do not exist on the
+  // test device; pass nullptr to restore the stat() based default.
+  static void SetPathExistsFunctionForTesting(bool (*path_exists)(const char* path));
+
  private:
+  // Failed loads in this namespace, keyed by library name and holding the
+  // linker error. Only "not found" failures are recorded: the linker probes
+  // every search path before reporting those, and callers tend to retry the
+  // same missing sonames. The cache is shared between copies of this object
+  // (they alias one linker namespace) and is dropped whenever the namespace
+  // configuration generation changes, since a new namespace or link can make
+  // a previously missing library loadable.
+  struct NegativeCache {
+    std::mutex mutex;
+    uint32_t generation = 0;
+    std::unordered_map<std::string, std::string> failed_libs;
+  };
+
   explicit NativeLoaderNamespace(const std::string& name, android_namespace_t* ns)
-      : name_(name), raw_(ns) {}
+      : name_(name), raw_(ns), negative_cache_(std::make_shared<NegativeCache>()) {}
   explicit NativeLoaderNamespace(const std::string& name, native_bridge_namespace_t* ns)
-      : name_(name), raw_(ns) {}
+      : name_(name), raw_(ns), negative_cache_(std::make_shared<NegativeCache>()) {}
 
   std::string name_;
   std::variant<android_namespace_t*, native_bridge_namespace_t*> raw_;
+  std::shared_ptr<NegativeCache> negative_cache_;
 };
 
 }  // namespace android
@@ -61,6 +61,10 @@ class NativeLoaderTest : public ::testing::TestWithParam<bool> {
   void SetUp() override {
     mock = std::make_unique<testing::NiceMock<MockPlatform>>(IsBridged());
 
+    // The search paths used in these tests do not exist on the test device;
+    // pretend they all do so namespace creation sees them unfiltered.
+    NativeLoaderNamespace::SetPathExistsFunctionForTesting([](const char*) { return true; });
+
     env = std::make_unique<JNIEnv>();
     env->functions = CreateJNINativeInterface();
   }
@@ -79,6 +83,7 @@ class NativeLoaderTest : public ::testing::TestWithParam<bool> {
 
   void TearDown() override {
     ResetNativeLoader();
+    NativeLoaderNamespace::SetPathExistsFunctionForTesting(nullptr);
     delete env->functions;
     mock.reset();
   }
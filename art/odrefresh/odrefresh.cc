@@ -23,11 +23,13 @@
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/sysinfo.h>
 #include <sysexits.h>
 #include <time.h>
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
@@ -40,6 +42,7 @@
 #include <iostream>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <ostream>
 #include <set>
@@ -47,6 +50,7 @@
 #include <string>
 #include <string_view>
 #include <system_error>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
@@ -397,6 +401,26 @@ bool AddDex2OatConcurrencyArguments(/*inout*/ std::vector<std::string>& args) {
   return true;
 }
 
+// Returns how many dex2oat subprocesses to run at once for `job_count` independent
+// compilations. Each invocation is already multi-threaded (see
+// AddDex2OatConcurrencyArguments), so this mostly overlaps per-process setup, I/O
+// and the single-threaded phases. The count is capped by a per-job memory budget
+// derived from the total RAM so that low-RAM devices keep compiling one jar at a
+// time instead of thrashing.
+size_t CompilationJobConcurrency(size_t job_count) {
+  static constexpr size_t kMaxConcurrentJobs = 4u;
+  // Rough peak RSS of a system server dex2oat invocation, with headroom for the
+  // rest of the system during boot.
+  static constexpr uint64_t kMemoryBudgetPerJobBytes = UINT64_C(1024) * 1024 * 1024;
+  struct sysinfo info;
+  if (sysinfo(&info) != 0) {
+    return 1u;
+  }
+  uint64_t total_bytes = static_cast<uint64_t>(info.totalram) * info.mem_unit;
+  size_t by_memory = std::max<size_t>(total_bytes / kMemoryBudgetPerJobBytes, 1u);
+  return std::min({job_count, by_memory, kMaxConcurrentJobs});
+}
+
 void AddDex2OatDebugInfo(/*inout*/ std::vector<std::string>& args) {
   args.emplace_back("--generate-mini-debug-info");
   args.emplace_back("--strip");
@@ -1572,21 +1596,35 @@ WARN_UNUSED bool OnDeviceRefresh::CompileSystemServerArtifacts(
     const std::function<void()>& on_dex2oat_success,
     std::string* error_msg) const {
   ScopedOdrCompilationTimer compilation_timer(metrics);
+
+  // Each jar is compiled against the boot image and the dex files of its
+  // classloader context, not against the compiled artifacts of the preceding
+  // jars, so the compilations are independent of each other. Collect the
+  // per-jar contexts first - the order of `all_systemserver_jars_` determines
+  // them - and then hand the jobs to a bounded set of workers.
+  struct SystemServerJob {
+    std::string jar;
+    std::vector<std::string> classloader_context;
+  };
+  std::vector<SystemServerJob> jobs;
   std::vector<std::string> classloader_context;
+  for (const std::string& jar : all_systemserver_jars_) {
+    if (ContainsElement(system_server_jars_to_compile, jar)) {
+      jobs.push_back(SystemServerJob{jar, classloader_context});
+    }
+    if (ContainsElement(systemserver_classpath_jars_, jar)) {
+      classloader_context.emplace_back(jar);
+    }
+  }
 
   const std::string dex2oat = config_.GetDex2Oat();
   const InstructionSet isa = config_.GetSystemServerIsa();
-  for (const std::string& jar : all_systemserver_jars_) {
-    auto scope_guard = android::base::make_scope_guard([&]() {
-      if (ContainsElement(systemserver_classpath_jars_, jar)) {
-        classloader_context.emplace_back(jar);
-      }
-    });
-
-    if (!ContainsElement(system_server_jars_to_compile, jar)) {
-      continue;
-    }
+  // Guards `metrics`, `error_msg` and the `on_dex2oat_success` callback when
+  // jobs run concurrently.
+  std::mutex result_mutex;
 
+  auto compile_jar = [&](const SystemServerJob& job) -> bool {
+    const std::string& jar = job.jar;
     std::vector<std::unique_ptr<File>> readonly_files_raii;
     std::vector<std::string> args;
     args.emplace_back(dex2oat);
@@ -1616,6 +1654,7 @@ WARN_UNUSED bool OnDeviceRefresh::CompileSystemServerArtifacts(
     const std::string image_location = GetSystemServerImagePath(/*on_system=*/false, jar);
     const std::string install_location = android::base::Dirname(image_location);
     if (!EnsureDirectoryExists(install_location)) {
+      std::lock_guard<std::mutex> lock(result_mutex);
       metrics.SetStatus(OdrMetrics::Status::kIoError);
       return false;
     }
@@ -1635,6 +1674,7 @@ WARN_UNUSED bool OnDeviceRefresh::CompileSystemServerArtifacts(
       std::unique_ptr<File> staging_file(OS::CreateEmptyFile(staging_location.c_str()));
       if (staging_file == nullptr) {
         PLOG(ERROR) << "Failed to create " << kind << " file: " << staging_location;
+        std::lock_guard<std::mutex> lock(result_mutex);
         metrics.SetStatus(OdrMetrics::Status::kIoError);
         EraseFiles(staging_files);
         return false;
@@ -1668,19 +1708,20 @@ WARN_UNUSED bool OnDeviceRefresh::CompileSystemServerArtifacts(
                                                 ":" + GetSystemBootImageExtension() :
                                             GetBootImage(/*on_system=*/false, /*minimal=*/false)}));
 
-    const std::string context_path = android::base::Join(classloader_context, ':');
+    const std::string context_path = android::base::Join(job.classloader_context, ':');
     if (art::ContainsElement(systemserver_classpath_jars_, jar)) {
       args.emplace_back("--class-loader-context=PCL[" + context_path + "]");
     } else {
       args.emplace_back("--class-loader-context=PCL[];PCL[" + context_path + "]");
     }
-    if (!classloader_context.empty()) {
+    if (!job.classloader_context.empty()) {
       std::vector<int> fds;
-      for (const std::string& path : classloader_context) {
+      for (const std::string& path : job.classloader_context) {
         std::string actual_path = AndroidRootRewrite(path);
         std::unique_ptr<File> file(OS::OpenFileForReading(actual_path.c_str()));
         if (!file->IsValid()) {
           PLOG(ERROR) << "Failed to open classloader context " << actual_path;
+          std::lock_guard<std::mutex> lock(result_mutex);
           metrics.SetStatus(OdrMetrics::Status::kIoError);
           return false;
         }
@@ -1700,27 +1741,72 @@ WARN_UNUSED bool OnDeviceRefresh::CompileSystemServerArtifacts(
     }
 
     bool timed_out = false;
-    int dex2oat_exit_code = exec_utils_->ExecAndReturnCode(args, timeout, &timed_out, error_msg);
+    std::string job_error_msg;
+    int dex2oat_exit_code =
+        exec_utils_->ExecAndReturnCode(args, timeout, &timed_out, &job_error_msg);
 
     if (dex2oat_exit_code != 0) {
+      std::lock_guard<std::mutex> lock(result_mutex);
       if (timed_out) {
         metrics.SetStatus(OdrMetrics::Status::kTimeLimitExceeded);
       } else {
         metrics.SetStatus(OdrMetrics::Status::kDex2OatError);
       }
+      if (error_msg->empty()) {
+        *error_msg = job_error_msg;
+      }
       EraseFiles(staging_files);
       return false;
     }
 
     if (!MoveOrEraseFiles(staging_files, install_location)) {
+      std::lock_guard<std::mutex> lock(result_mutex);
       metrics.SetStatus(OdrMetrics::Status::kInstallFailed);
       return false;
     }
 
-    on_dex2oat_success();
+    {
+      std::lock_guard<std::mutex> lock(result_mutex);
+      on_dex2oat_success();
+    }
+    return true;
+  };
+
+  size_t concurrency = CompilationJobConcurrency(jobs.size());
+  if (concurrency <= 1u) {
+    for (const SystemServerJob& job : jobs) {
+      if (!compile_jar(job)) {
+        return false;
+      }
+    }
+    return true;
   }
 
-  return true;
+  LOG(INFO) << "Compiling " << jobs.size() << " system server jars with " << concurrency
+            << " concurrent dex2oat invocations";
+  std::atomic<size_t> next_job(0u);
+  std::atomic<bool> failed(false);
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i != concurrency; ++i) {
+    workers.emplace_back([&]() {
+      while (!failed.load(std::memory_order_relaxed)) {
+        size_t index = next_job.fetch_add(1u, std::memory_order_relaxed);
+        if (index >= jobs.size()) {
+          return;
+        }
+        if (!compile_jar(jobs[index])) {
+          // Stop handing out new jobs; already running ones clean up after
+          // themselves when they finish.
+          failed.store(true, std::memory_order_relaxed);
+          return;
+        }
+      }
+    });
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  return !failed.load(std::memory_order_relaxed);
 }
 
 WARN_UNUSED ExitCode OnDeviceRefresh::Compile(OdrMetrics& metrics,
@@ -32,9 +32,11 @@
 #include <thread>
 #include <time.h>
 
+#include <algorithm>
 #include <limits>
 #include <optional>
 #include <type_traits>
+#include <vector>
 
 #include "gc/heap-visit-objects-inl.h"
 #include "gc/heap.h"
@@ -74,6 +76,15 @@ constexpr time_t kWatchdogTimeoutSec = 120;
 // DropBox has a 500k chunk limit, and each chunk needs to parse as a proto.
 constexpr uint32_t kPacketSizeThreshold = 400000;
 constexpr char kByte[1] = {'x'};
+// The heap graph is serialized by a single thread, but the expensive
+// per-object work (walking reference fields, pretty-printing field names) is
+// precomputed by up to kMaxDumpWorkers threads, one window of objects ahead
+// of the serializer. The window size bounds the memory held for precomputed
+// references in the forked child; kPrecomputeBatchSize is the granularity at
+// which a window is interleaved across the workers.
+constexpr size_t kMaxDumpWorkers = 4;
+constexpr size_t kObjectsPerDumpWindow = 131072;
+constexpr size_t kPrecomputeBatchSize = 1024;
 static art::Mutex& GetStateMutex() {
   static art::Mutex state_mutex("perfetto_hprof_state_mutex", art::LockLevel::kGenericBottomLock);
   return state_mutex;
@@ -576,6 +587,13 @@ class HeapGraphDumper {
   }
 
  private:
+  // The references of one object, precomputed on a worker thread so that the
+  // serializing thread does not have to walk the object's fields itself.
+  struct PrecomputedReferences {
+    std::vector<std::pair<std::string, art::mirror::Object*>> referred_objects;
+    uint64_t base_obj_id = 0;
+  };
+
   // Dumps the root objects from `*runtime` to `writer`.
   void DumpRootObjects(art::Runtime* runtime, Writer& writer)
       REQUIRES_SHARED(art::Locks::mutator_lock_) {
@@ -603,10 +621,97 @@ class HeapGraphDumper {
   }
 
   // Dumps all the objects from `*runtime` to `writer`.
+  //
+  // After the fork there are no concurrent GC or mutator threads, so the only
+  // cost here is CPU time. The expensive part of dumping an object - walking
+  // its reference fields and pretty-printing their names - does not touch the
+  // proto stream, so worker threads precompute it one window of objects ahead
+  // while this thread serializes the previous window. Serialization stays
+  // single-threaded and in visit order, which the delta encoding of object
+  // ids relies on.
   void DumpObjects(art::Runtime* runtime, Writer& writer) REQUIRES(art::Locks::mutator_lock_) {
+    std::vector<art::mirror::Object*> objects;
     runtime->GetHeap()->VisitObjectsPaused(
-        [this, &writer](art::mirror::Object* obj)
-            REQUIRES_SHARED(art::Locks::mutator_lock_) { WriteOneObject(obj, writer); });
+        [&objects](art::mirror::Object* obj)
+            REQUIRES_SHARED(art::Locks::mutator_lock_) { objects.emplace_back(obj); });
+
+    const size_t num_workers =
+        std::min<size_t>(kMaxDumpWorkers, std::thread::hardware_concurrency());
+    if (num_workers <= 1 || objects.size() < kObjectsPerDumpWindow) {
+      for (art::mirror::Object* obj : objects) {
+        WriteOneObject(obj, /*precomputed=*/nullptr, writer);
+      }
+      return;
+    }
+
+    size_t window_begin = 0;
+    size_t window_end = std::min(objects.size(), kObjectsPerDumpWindow);
+    std::vector<PrecomputedReferences> window_refs(window_end - window_begin);
+    for (std::thread& t :
+         StartPrecomputeWorkers(objects, window_begin, window_end, num_workers, &window_refs)) {
+      t.join();
+    }
+    while (window_begin < objects.size()) {
+      const size_t next_begin = window_end;
+      const size_t next_end = std::min(objects.size(), next_begin + kObjectsPerDumpWindow);
+      std::vector<PrecomputedReferences> next_refs(next_end - next_begin);
+      std::vector<std::thread> workers =
+          StartPrecomputeWorkers(objects, next_begin, next_end, num_workers, &next_refs);
+      for (size_t i = window_begin; i < window_end; ++i) {
+        WriteOneObject(objects[i], &window_refs[i - window_begin], writer);
+      }
+      for (std::thread& t : workers) {
+        t.join();
+      }
+      window_refs = std::move(next_refs);
+      window_begin = next_begin;
+      window_end = next_end;
+    }
+  }
+
+  // Starts workers that fill `*out` with the references of
+  // `objects[begin..end)`. The caller must join the returned threads before
+  // reading `*out`.
+  std::vector<std::thread> StartPrecomputeWorkers(
+      const std::vector<art::mirror::Object*>& objects,
+      size_t begin,
+      size_t end,
+      size_t num_workers,
+      std::vector<PrecomputedReferences>* out) {
+    std::vector<std::thread> workers;
+    if (begin == end) {
+      return workers;
+    }
+    for (size_t w = 0; w < num_workers; ++w) {
+      workers.emplace_back([this, &objects, begin, end, num_workers, w, out]()
+                               NO_THREAD_SAFETY_ANALYSIS {
+        // Batches are statically interleaved across the workers. There are no
+        // concurrent GC threads after the fork, so visiting objects from an
+        // unattached thread is safe; only the heap and the (const after
+        // construction) ignored type list are read, never the interning maps
+        // or the proto stream.
+        for (size_t batch = begin + w * kPrecomputeBatchSize; batch < end;
+             batch += num_workers * kPrecomputeBatchSize) {
+          const size_t batch_end = std::min(end, batch + kPrecomputeBatchSize);
+          for (size_t i = batch; i < batch_end; ++i) {
+            ComputeReferences(objects[i], &(*out)[i - begin]);
+          }
+        }
+      });
+    }
+    return workers;
+  }
+
+  // Precomputes the references of `*obj`. Ignored objects are skipped
+  // entirely; the serializer never reads their entry.
+  void ComputeReferences(art::mirror::Object* obj, PrecomputedReferences* out) const
+      REQUIRES_SHARED(art::Locks::mutator_lock_) {
+    if (IsIgnored(obj)) {
+      return;
+    }
+    out->referred_objects = GetReferences(obj, obj->GetClass());
+    art::mirror::Object* min_nonnull_ptr = FilterIgnoredReferencesAndFindMin(out->referred_objects);
+    out->base_obj_id = EncodeBaseObjId(out->referred_objects, min_nonnull_ptr);
   }
 
   // Writes all the previously accumulated (while dumping objects and roots) interned data to
@@ -632,8 +737,11 @@ class HeapGraphDumper {
     }
   }
 
-  // Writes `*obj` into `writer`.
-  void WriteOneObject(art::mirror::Object* obj, Writer& writer)
+  // Writes `*obj` into `writer`. `precomputed` holds the object's references
+  // if a worker thread already walked them, and is null in the serial path.
+  void WriteOneObject(art::mirror::Object* obj,
+                      const PrecomputedReferences* precomputed,
+                      Writer& writer)
       REQUIRES_SHARED(art::Locks::mutator_lock_) {
     if (obj->IsClass()) {
       WriteClass(obj->AsClass().Ptr(), writer);
@@ -669,7 +777,7 @@ class HeapGraphDumper {
       object_proto->set_self_size(obj->SizeOf());
     }
 
-    FillReferences(obj, klass, object_proto);
+    FillReferences(obj, klass, precomputed, object_proto);
 
     FillFieldValues(obj, klass, object_proto);
   }
@@ -716,14 +824,17 @@ class HeapGraphDumper {
   // Fills `*object_proto` with all the references held by `*obj` (an object of type `*klass`).
   void FillReferences(art::mirror::Object* obj,
                       art::mirror::Class* klass,
+                      const PrecomputedReferences* precomputed,
                       perfetto::protos::pbzero::HeapGraphObject* object_proto)
       REQUIRES_SHARED(art::Locks::mutator_lock_) {
-    std::vector<std::pair<std::string, art::mirror::Object*>> referred_objects =
-        GetReferences(obj, klass);
-
-    art::mirror::Object* min_nonnull_ptr = FilterIgnoredReferencesAndFindMin(referred_objects);
-
-    uint64_t base_obj_id = EncodeBaseObjId(referred_objects, min_nonnull_ptr);
+    PrecomputedReferences local;
+    if (precomputed == nullptr) {
+      ComputeReferences(obj, &local);
+      precomputed = &local;
+    }
+    const std::vector<std::pair<std::string, art::mirror::Object*>>& referred_objects =
+        precomputed->referred_objects;
+    const uint64_t base_obj_id = precomputed->base_obj_id;
 
     const bool emit_field_ids = klass->GetClassFlags() != art::mirror::kClassFlagObjectArray &&
                                 klass->GetClassFlags() != art::mirror::kClassFlagNormal &&
@@ -16,21 +16,199 @@
 
 #include "aot_class_linker.h"
 
+#include <unordered_map>
+#include <vector>
+
 #include "class_status.h"
 #include "compiler_callbacks.h"
 #include "dex/class_reference.h"
+#include "dex/dex_file-inl.h"
 #include "gc/heap.h"
 #include "handle_scope-inl.h"
+#include "jni/java_vm_ext.h"
 #include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
 #include "runtime.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-current-inl.h"
+#include "thread_pool.h"
 #include "verifier/verifier_enums.h"
 
 namespace art {
 
+namespace {
+
+// Verifies the classes of one dex file ahead of the compiler driver's demand. Modeled on
+// `BackgroundVerificationTask` in oat_file_manager.cc, but walks the class_defs in
+// superclass-dependency order so that verifying a class never waits on an unverified
+// superclass or interface defined in the same dex file.
+class VerificationPrefetchTask final : public Task {
+ public:
+  VerificationPrefetchTask(const DexFile* dex_file,
+                           jobject class_loader,
+                           verifier::VerifierDeps* verifier_deps)
+      : dex_file_(dex_file),
+        verifier_deps_(verifier_deps) {
+    Thread* const self = Thread::Current();
+    ScopedObjectAccess soa(self);
+    // Create a global ref for `class_loader` because it will be accessed from a different thread.
+    class_loader_ = soa.Vm()->AddGlobalRef(self, soa.Decode<mirror::ClassLoader>(class_loader));
+    CHECK(class_loader_ != nullptr);
+  }
+
+  ~VerificationPrefetchTask() {
+    Thread* const self = Thread::Current();
+    ScopedObjectAccess soa(self);
+    soa.Vm()->DeleteGlobalRef(self, class_loader_);
+  }
+
+  void Run(Thread* self) override {
+    ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
+    for (uint32_t cdef_idx : SuperclassDependencyOrder()) {
+      const dex::ClassDef& class_def = dex_file_->GetClassDef(cdef_idx);
+
+      // Take handles inside the loop so that no references are held across the
+      // whole dex file.
+      ScopedObjectAccess soa(self);
+      StackHandleScope<2> hs(self);
+      Handle<mirror::ClassLoader> h_loader(hs.NewHandle(
+          soa.Decode<mirror::ClassLoader>(class_loader_)));
+      Handle<mirror::Class> h_class(hs.NewHandle<mirror::Class>(class_linker->FindClass(
+          self,
+          dex_file_->GetClassDescriptor(class_def),
+          h_loader)));
+
+      if (h_class == nullptr) {
+        CHECK(self->IsExceptionPending());
+        self->ClearException();
+        continue;
+      }
+
+      if (&h_class->GetDexFile() != dex_file_) {
+        // There is a different class in the class path or a parent class loader
+        // with the same descriptor. This `h_class` is not resolvable, skip it.
+        continue;
+      }
+
+      class_linker->VerifyClass(self, verifier_deps_, h_class);
+      if (h_class->IsErroneous()) {
+        // `ClassLinker::VerifyClass()` throws, which is not useful here; the compiler
+        // thread demanding this class recreates the failure from the class status.
+        CHECK(self->IsExceptionPending());
+        self->ClearException();
+      }
+    }
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  // Returns the class_def indexes of `dex_file_` ordered so that a class_def comes after
+  // its superclass and interfaces when those are defined in the same dex file.
+  std::vector<uint32_t> SuperclassDependencyOrder() const {
+    const uint32_t num_class_defs = dex_file_->NumClassDefs();
+    // Map type indexes to class_def indexes for classes defined in this dex file.
+    std::unordered_map<uint32_t, uint32_t> local_defs;
+    local_defs.reserve(num_class_defs);
+    for (uint32_t i = 0; i != num_class_defs; ++i) {
+      local_defs.emplace(dex_file_->GetClassDef(i).class_idx_.index_, i);
+    }
+    enum class State : uint8_t { kUnvisited, kVisiting, kVisited };
+    std::vector<State> states(num_class_defs, State::kUnvisited);
+    std::vector<uint32_t> order;
+    order.reserve(num_class_defs);
+    std::vector<uint32_t> stack;
+    for (uint32_t root = 0; root != num_class_defs; ++root) {
+      if (states[root] != State::kUnvisited) {
+        continue;
+      }
+      stack.push_back(root);
+      while (!stack.empty()) {
+        const uint32_t idx = stack.back();
+        if (states[idx] == State::kVisited) {
+          // Already emitted through another dependency chain.
+          stack.pop_back();
+          continue;
+        }
+        if (states[idx] == State::kVisiting) {
+          // All dependencies have been emitted.
+          states[idx] = State::kVisited;
+          order.push_back(idx);
+          stack.pop_back();
+          continue;
+        }
+        states[idx] = State::kVisiting;
+        const dex::ClassDef& class_def = dex_file_->GetClassDef(idx);
+        auto push_dependency = [&](dex::TypeIndex type_idx) {
+          auto it = local_defs.find(type_idx.index_);
+          // A dependency in the `kVisiting` state higher up the stack would indicate a
+          // superclass cycle; the verifier rejects those, so no need to order them here.
+          if (it != local_defs.end() && states[it->second] == State::kUnvisited) {
+            stack.push_back(it->second);
+          }
+        };
+        if (class_def.superclass_idx_.IsValid()) {
+          push_dependency(class_def.superclass_idx_);
+        }
+        const dex::TypeList* interfaces = dex_file_->GetInterfacesList(class_def);
+        if (interfaces != nullptr) {
+          for (size_t i = 0; i != interfaces->Size(); ++i) {
+            push_dependency(interfaces->GetTypeItem(i).type_idx_);
+          }
+        }
+      }
+    }
+    DCHECK_EQ(order.size(), num_class_defs);
+    return order;
+  }
+
+  const DexFile* const dex_file_;
+  jobject class_loader_;
+  verifier::VerifierDeps* const verifier_deps_;
+
+  DISALLOW_COPY_AND_ASSIGN(VerificationPrefetchTask);
+};
+
+}  // namespace
+
 AotClassLinker::AotClassLinker(InternTable* intern_table)
     : ClassLinker(intern_table, /*fast_class_not_found_exceptions=*/ false) {}
 
-AotClassLinker::~AotClassLinker() {}
+AotClassLinker::~AotClassLinker() {
+  WaitForVerificationPrefetchTasks();
+}
+
+void AotClassLinker::StartVerificationPrefetch(Thread* self,
+                                               jobject class_loader,
+                                               const std::vector<const DexFile*>& dex_files,
+                                               verifier::VerifierDeps* verifier_deps,
+                                               size_t num_threads) {
+  DCHECK(Runtime::Current()->IsAotCompiler());
+  DCHECK(!Runtime::Current()->IsShuttingDown(self))
+      << "Cannot create new threads during runtime shutdown";
+  if (dex_files.empty() || num_threads == 0u) {
+    return;
+  }
+  if (verification_prefetch_pool_ == nullptr) {
+    verification_prefetch_pool_.reset(
+        new ThreadPool("Verification prefetch thread pool", num_threads));
+    verification_prefetch_pool_->StartWorkers(self);
+  }
+  for (const DexFile* dex_file : dex_files) {
+    verification_prefetch_pool_->AddTask(
+        self, new VerificationPrefetchTask(dex_file, class_loader, verifier_deps));
+  }
+}
+
+void AotClassLinker::WaitForVerificationPrefetchTasks() {
+  if (verification_prefetch_pool_ != nullptr) {
+    Thread* const self = Thread::Current();
+    verification_prefetch_pool_->WaitForWorkersToBeCreated();
+    verification_prefetch_pool_->Wait(self, /*do_work=*/ false, /*may_hold_locks=*/ false);
+  }
+}
 
 bool AotClassLinker::CanAllocClass() {
   // AllocClass doesn't work under transaction, so we abort.
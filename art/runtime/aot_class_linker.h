@@ -22,6 +22,8 @@
 
 namespace art {
 
+class ThreadPool;
+
 namespace gc {
 class Heap;
 }  // namespace gc
@@ -46,6 +48,25 @@ static bool CanReferenceInBootImageExtension(ObjPtr<mirror::Class> klass, gc::He
   bool DenyAccessBasedOnPublicSdk(const char* type_descriptor ATTRIBUTE_UNUSED) const override;
   void SetEnablePublicSdkChecks(bool enabled) override;
 
+  // Start verifying classes of `dex_files` on `num_threads` prefetch threads, ahead of the
+  // compiler driver's demand. Each dex file's class_defs are visited in superclass-dependency
+  // order, so by the time a class is verified its superclass and interfaces defined in the
+  // same dex file have already been through verification. Results are published through the
+  // usual `ClassStatus` transitions under the class object lock, so compiler threads racing
+  // with the prefetch either wait for the in-flight class or take the early `IsVerified()`
+  // exit in `ClassLinker::VerifyClass()` instead of re-verifying. `verifier_deps` is shared
+  // with the compiler threads; `VerifierDeps` serializes its own updates.
+  // Must not be called during runtime shutdown.
+  void StartVerificationPrefetch(Thread* self,
+                                 jobject class_loader,
+                                 const std::vector<const DexFile*>& dex_files,
+                                 verifier::VerifierDeps* verifier_deps,
+                                 size_t num_threads)
+      REQUIRES(!Locks::mutator_lock_);
+
+  // Wait for all outstanding verification prefetch tasks to complete.
+  void WaitForVerificationPrefetchTasks();
+
  protected:
   // Overridden version of PerformClassVerification allows skipping verification if the class was
   // previously verified but unloaded.
@@ -74,6 +95,10 @@ static bool CanReferenceInBootImageExtension(ObjPtr<mirror::Class> klass, gc::He
 
  private:
   std::unique_ptr<SdkChecker> sdk_checker_;
+
+  // Thread pool used by `StartVerificationPrefetch()`, created lazily. Only created and
+  // deleted on the single setup thread of the AOT compiler.
+  std::unique_ptr<ThreadPool> verification_prefetch_pool_;
 };
 
 }  // namespace art
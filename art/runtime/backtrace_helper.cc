@@ -68,6 +68,34 @@ struct UnwindHelper : public TLSData {
   // Reparse process mmaps to detect newly loaded libraries.
   bool Reparse(bool* any_changed) { return maps_.Reparse(any_changed); }
 
+  // Returns the cached frames of a previous unwind with the same leaf pc/sp
+  // whose stack segment is unchanged, or nullptr. Unwinding is a function of
+  // the leaf registers plus the stack bytes between the leaf and the
+  // outermost frame, so an identical segment yields an identical walk; this
+  // makes repeated samples of a blocked or looping thread (watchdogs, hot
+  // allocation sites under gcstress) skip the unwinder entirely.
+  const std::vector<uint64_t>* LookupCachedFrames(uint64_t pc, uint64_t sp) {
+    for (CachedUnwind& entry : unwind_cache_) {
+      if (entry.leaf_pc == pc && entry.leaf_sp == sp && !entry.pcs.empty() &&
+          HashStackSegment(sp, entry.outer_sp) == entry.stack_hash) {
+        return &entry.pcs;
+      }
+    }
+    return nullptr;
+  }
+
+  void StoreCachedFrames(uint64_t pc, uint64_t sp, uint64_t outer_sp, std::vector<uint64_t>&& pcs) {
+    if (outer_sp <= sp) {
+      return;  // Nothing to validate against; do not cache.
+    }
+    CachedUnwind& entry = unwind_cache_[next_cache_entry_++ % kUnwindCacheEntries];
+    entry.leaf_pc = pc;
+    entry.leaf_sp = sp;
+    entry.outer_sp = outer_sp;
+    entry.stack_hash = HashStackSegment(sp, outer_sp);
+    entry.pcs = std::move(pcs);
+  }
+
   static UnwindHelper* Get(Thread* self, size_t max_depth) {
     UnwindHelper* tls = reinterpret_cast<UnwindHelper*>(self->GetCustomTLS(kTlsKey));
     if (tls == nullptr) {
@@ -80,6 +108,32 @@ struct UnwindHelper : public TLSData {
   unwindstack::Unwinder* Unwinder() { return &unwinder_; }
 
  private:
+  static constexpr size_t kUnwindCacheEntries = 4;
+
+  struct CachedUnwind {
+    uint64_t leaf_pc = 0;
+    uint64_t leaf_sp = 0;
+    uint64_t outer_sp = 0;    // SP of the outermost unwound frame.
+    uint64_t stack_hash = 0;  // Hash of the stack bytes in [leaf_sp, outer_sp).
+    std::vector<uint64_t> pcs;
+  };
+
+  // The segment is the current thread's own live stack, so it is always
+  // readable; return addresses of every unwound frame live below outer_sp.
+  static uint64_t HashStackSegment(uint64_t begin, uint64_t end) {
+    uint64_t hash = 9314237;
+    for (const uintptr_t* p = reinterpret_cast<const uintptr_t*>(begin);
+         p < reinterpret_cast<const uintptr_t*>(end);
+         ++p) {
+      hash = hash * 2654435761 + *p;
+      hash += (hash >> 13) ^ (hash << 6);
+    }
+    return hash;
+  }
+
+  CachedUnwind unwind_cache_[kUnwindCacheEntries];
+  size_t next_cache_entry_ = 0;
+
   unwindstack::LocalUpdatableMaps maps_;
   unwindstack::ArchEnum arch_;
   std::shared_ptr<unwindstack::Memory> memory_;
@@ -119,9 +173,38 @@ void BacktraceCollector::Collect() {
   }
 }
 
+// Store the raw frames of a successful walk for reuse by later collections.
+static void CacheUnwind(UnwindHelper* helper,
+                        unwindstack::Unwinder* unwinder,
+                        unwindstack::Regs* regs) {
+  if (kStrictUnwindChecks || unwinder->frames().empty()) {
+    return;
+  }
+  std::vector<uint64_t> pcs;
+  pcs.reserve(unwinder->NumFrames());
+  for (const unwindstack::FrameData& frame : unwinder->frames()) {
+    pcs.push_back(frame.pc);
+  }
+  helper->StoreCachedFrames(regs->pc(), regs->sp(), unwinder->frames().back().sp, std::move(pcs));
+}
+
 bool BacktraceCollector::CollectImpl(unwindstack::Unwinder* unwinder) {
   std::unique_ptr<unwindstack::Regs> regs(unwindstack::Regs::CreateFromLocal());
   RegsGetLocal(regs.get());
+
+  // Reuse the previous walk if the stack segment it covered is unchanged.
+  // The cache keeps raw unwinder output, so skip/early-exit handling below
+  // applies identically to cached and fresh frames. Disabled under strict
+  // checks, which need the per-frame function names.
+  UnwindHelper* helper = UnwindHelper::Get(Thread::Current(), max_depth_);
+  if (!kStrictUnwindChecks) {
+    const std::vector<uint64_t>* cached = helper->LookupCachedFrames(regs->pc(), regs->sp());
+    if (cached != nullptr) {
+      FillOutFrames(cached->data(), cached->size());
+      return true;
+    }
+  }
+
   unwinder->SetRegs(regs.get());
   unwinder->Unwind();
 
@@ -136,6 +219,7 @@ bool BacktraceCollector::CollectImpl(unwindstack::Unwinder* unwinder) {
       // but rather it tries to guess the address of the preceding call instruction.
       size_t exit_pc = reinterpret_cast<size_t>(GetQuickInstrumentationExitPc());
       if (exit_pc - 4 <= it->pc && it->pc <= exit_pc) {
+        CacheUnwind(helper, unwinder, regs.get());
         return true;
       }
 
@@ -153,7 +237,24 @@ bool BacktraceCollector::CollectImpl(unwindstack::Unwinder* unwinder) {
   }
 
   unwindstack::ErrorCode error = unwinder->LastErrorCode();
-  return error == unwindstack::ERROR_NONE || error == unwindstack::ERROR_MAX_FRAMES_EXCEEDED;
+  bool success = error == unwindstack::ERROR_NONE || error == unwindstack::ERROR_MAX_FRAMES_EXCEEDED;
+  if (success) {
+    CacheUnwind(helper, unwinder, regs.get());
+  }
+  return success;
+}
+
+bool BacktraceCollector::FillOutFrames(const uint64_t* pcs, size_t count) {
+  num_frames_ = 0;
+  size_t exit_pc = reinterpret_cast<size_t>(GetQuickInstrumentationExitPc());
+  for (size_t i = skip_count_; i < count; ++i) {
+    CHECK_LT(num_frames_, max_depth_);
+    out_frames_[num_frames_++] = static_cast<uintptr_t>(pcs[i]);
+    if (exit_pc - 4 <= pcs[i] && pcs[i] <= exit_pc) {
+      return true;
+    }
+  }
+  return false;
 }
 
 #else
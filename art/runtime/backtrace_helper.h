@@ -44,6 +44,10 @@ class BacktraceCollector {
   // It is used to retry backtrace on temporary failure.
   bool CollectImpl(unwindstack::Unwinder* unwinder);
 
+  // Copy unwound pcs into out_frames_, honoring skip_count_. Returns true if
+  // the instrumentation exit trampoline ended the walk early (expected).
+  bool FillOutFrames(const uint64_t* pcs, size_t count);
+
   uintptr_t* const out_frames_ = nullptr;
   size_t num_frames_ = 0u;
   const size_t max_depth_ = 0u;
@@ -17,6 +17,8 @@
 #include "cha.h"
 
 #include "art_method-inl.h"
+#include "base/bit_utils.h"
+#include "base/casts.h"
 #include "base/logging.h"  // For VLOG
 #include "base/mutex.h"
 #include "jit/jit.h"
@@ -32,27 +34,149 @@
 
 namespace art {
 
+// Pointer deltas need 64-bit payloads; base/leb128.h only covers uint32_t.
+static constexpr size_t kMaxLeb128Bytes64 = 10u;
+
+static inline uint8_t* EncodeUnsignedLeb128_64(uint8_t* dest, uint64_t value) {
+  uint8_t out = value & 0x7f;
+  value >>= 7;
+  while (value != 0u) {
+    *dest++ = out | 0x80;
+    out = value & 0x7f;
+    value >>= 7;
+  }
+  *dest++ = out;
+  return dest;
+}
+
+static inline uint64_t DecodeUnsignedLeb128_64(const uint8_t** data) {
+  const uint8_t* ptr = *data;
+  uint64_t result = 0u;
+  size_t shift = 0u;
+  uint8_t cur;
+  do {
+    cur = *ptr++;
+    result |= static_cast<uint64_t>(cur & 0x7f) << shift;
+    shift += 7u;
+  } while ((cur & 0x80) != 0u);
+  *data = ptr;
+  return result;
+}
+
+static inline uint64_t ZigZagEncode64(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static inline int64_t ZigZagDecode64(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1u);
+}
+
+ClassHierarchyAnalysis::ClassHierarchyAnalysis()
+    : allocator_(Runtime::Current()->GetArenaPool()) {
+  std::fill_n(buffer_free_lists_, kNumBufferBuckets, nullptr);
+}
+
+uint8_t* ClassHierarchyAnalysis::AllocateBuffer(uint32_t capacity) {
+  DCHECK(IsPowerOfTwo(capacity));
+  DCHECK_GE(capacity, kMinBufferCapacity);
+  size_t bucket = CTZ(capacity) - CTZ(kMinBufferCapacity);
+  DCHECK_LT(bucket, kNumBufferBuckets);
+  uint8_t* data = buffer_free_lists_[bucket];
+  if (data != nullptr) {
+    buffer_free_lists_[bucket] = *reinterpret_cast<uint8_t**>(data);
+    return data;
+  }
+  return allocator_.AllocArray<uint8_t>(capacity, kArenaAllocCHA);
+}
+
+void ClassHierarchyAnalysis::RecycleBuffer(uint8_t* data, uint32_t capacity) {
+  DCHECK(IsPowerOfTwo(capacity));
+  size_t bucket = CTZ(capacity) - CTZ(kMinBufferCapacity);
+  DCHECK_LT(bucket, kNumBufferBuckets);
+  *reinterpret_cast<uint8_t**>(data) = buffer_free_lists_[bucket];
+  buffer_free_lists_[bucket] = data;
+}
+
+void ClassHierarchyAnalysis::RecycleList(EncodedDependencyList* list) {
+  if (list->data != nullptr) {
+    RecycleBuffer(list->data, list->data_capacity);
+    list->data = nullptr;
+    list->data_capacity = 0u;
+  }
+  list->num_pairs = 0u;
+  list->data_size = 0u;
+  list->last_method = 0u;
+  list->last_header = 0u;
+}
+
+void ClassHierarchyAnalysis::AppendDependency(EncodedDependencyList* list,
+                                              const MethodAndMethodHeaderPair& pair) {
+  uint8_t encoded[2u * kMaxLeb128Bytes64];
+  const uintptr_t method = reinterpret_cast<uintptr_t>(pair.first);
+  const uintptr_t header = reinterpret_cast<uintptr_t>(pair.second);
+  uint8_t* end = EncodeUnsignedLeb128_64(
+      encoded, ZigZagEncode64(static_cast<int64_t>(method - list->last_method)));
+  end = EncodeUnsignedLeb128_64(
+      end, ZigZagEncode64(static_cast<int64_t>(header - list->last_header)));
+  const uint32_t pair_size = dchecked_integral_cast<uint32_t>(end - encoded);
+  if (list->data_size + pair_size > list->data_capacity) {
+    uint32_t new_capacity = std::max(list->data_capacity * 2u, kMinBufferCapacity);
+    while (new_capacity < list->data_size + pair_size) {
+      new_capacity *= 2u;
+    }
+    uint8_t* new_data = AllocateBuffer(new_capacity);
+    if (list->data != nullptr) {
+      memcpy(new_data, list->data, list->data_size);
+      RecycleBuffer(list->data, list->data_capacity);
+    }
+    list->data = new_data;
+    list->data_capacity = new_capacity;
+  }
+  memcpy(list->data + list->data_size, encoded, pair_size);
+  list->data_size += pair_size;
+  ++list->num_pairs;
+  list->last_method = method;
+  list->last_header = header;
+}
+
+ClassHierarchyAnalysis::ListOfDependentPairs ClassHierarchyAnalysis::DecodeDependencies(
+    const EncodedDependencyList& list) {
+  ListOfDependentPairs dependents;
+  dependents.reserve(list.num_pairs);
+  const uint8_t* cursor = list.data;
+  uintptr_t method = 0u;
+  uintptr_t header = 0u;
+  for (uint32_t i = 0u; i != list.num_pairs; ++i) {
+    method += static_cast<uintptr_t>(ZigZagDecode64(DecodeUnsignedLeb128_64(&cursor)));
+    header += static_cast<uintptr_t>(ZigZagDecode64(DecodeUnsignedLeb128_64(&cursor)));
+    dependents.push_back({reinterpret_cast<ArtMethod*>(method),
+                          reinterpret_cast<OatQuickMethodHeader*>(header)});
+  }
+  DCHECK_EQ(static_cast<uint32_t>(cursor - list.data), list.data_size);
+  return dependents;
+}
+
 void ClassHierarchyAnalysis::AddDependency(ArtMethod* method,
                                            ArtMethod* dependent_method,
                                            OatQuickMethodHeader* dependent_header) {
-  const auto it = cha_dependency_map_.insert(
-      decltype(cha_dependency_map_)::value_type(method, ListOfDependentPairs())).first;
-  it->second.push_back({dependent_method, dependent_header});
+  AppendDependency(&cha_dependency_map_[method], {dependent_method, dependent_header});
 }
 
-static const ClassHierarchyAnalysis::ListOfDependentPairs s_empty_vector;
-
-const ClassHierarchyAnalysis::ListOfDependentPairs& ClassHierarchyAnalysis::GetDependents(
+ClassHierarchyAnalysis::ListOfDependentPairs ClassHierarchyAnalysis::GetDependents(
     ArtMethod* method) {
   auto it = cha_dependency_map_.find(method);
   if (it != cha_dependency_map_.end()) {
-    return it->second;
+    return DecodeDependencies(it->second);
   }
-  return s_empty_vector;
+  return ListOfDependentPairs();
 }
 
 void ClassHierarchyAnalysis::RemoveAllDependenciesFor(ArtMethod* method) {
-  cha_dependency_map_.erase(method);
+  auto it = cha_dependency_map_.find(method);
+  if (it != cha_dependency_map_.end()) {
+    RecycleList(&it->second);
+    cha_dependency_map_.erase(it);
+  }
 }
 
 void ClassHierarchyAnalysis::RemoveDependentsWithMethodHeaders(
@@ -60,20 +184,35 @@ void ClassHierarchyAnalysis::RemoveDependentsWithMethodHeaders(
   // Iterate through all entries in the dependency map and remove any entry that
   // contains one of those in method_headers.
   for (auto map_it = cha_dependency_map_.begin(); map_it != cha_dependency_map_.end(); ) {
-    ListOfDependentPairs& dependents = map_it->second;
+    EncodedDependencyList& list = map_it->second;
+    ListOfDependentPairs dependents = DecodeDependencies(list);
+    size_t num_removed = 0u;
     dependents.erase(
         std::remove_if(
             dependents.begin(),
             dependents.end(),
-            [&method_headers](MethodAndMethodHeaderPair& dependent) {
-              return method_headers.find(dependent.second) != method_headers.end();
+            [&method_headers, &num_removed](MethodAndMethodHeaderPair& dependent) {
+              bool remove = method_headers.find(dependent.second) != method_headers.end();
+              num_removed += remove ? 1u : 0u;
+              return remove;
             }),
         dependents.end());
 
-    // Remove the map entry if there are no more dependents.
     if (dependents.empty()) {
+      // Remove the map entry if there are no more dependents.
+      RecycleList(&list);
       map_it = cha_dependency_map_.erase(map_it);
     } else {
+      if (num_removed != 0u) {
+        // Re-encode the survivors in place; the stream only shrinks.
+        list.num_pairs = 0u;
+        list.data_size = 0u;
+        list.last_method = 0u;
+        list.last_header = 0u;
+        for (const MethodAndMethodHeaderPair& dependent : dependents) {
+          AppendDependency(&list, dependent);
+        }
+      }
       map_it++;
     }
   }
@@ -698,6 +837,7 @@ void ClassHierarchyAnalysis::RemoveDependenciesForLinearAlloc(const LinearAlloc*
     // Use unsafe to avoid locking since the allocator is going to be deleted.
     if (linear_alloc->ContainsUnsafe(it->first)) {
       // About to delete the ArtMethod, erase the entry from the map.
+      RecycleList(&it->second);
       it = cha_dependency_map_.erase(it);
     } else {
       ++it;
@@ -20,6 +20,7 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "base/arena_allocator.h"
 #include "base/enums.h"
 #include "base/locks.h"
 #include "handle.h"
@@ -88,7 +89,7 @@ class ClassHierarchyAnalysis {
   using MethodAndMethodHeaderPair = std::pair<ArtMethod*, OatQuickMethodHeader*>;
   using ListOfDependentPairs = std::vector<MethodAndMethodHeaderPair>;
 
-  ClassHierarchyAnalysis() {}
+  ClassHierarchyAnalysis();
 
   // Add a dependency that compiled code with `dependent_header` for `dependent_method`
   // assumes that virtual `method` has single-implementation.
@@ -96,8 +97,9 @@ class ClassHierarchyAnalysis {
                      ArtMethod* dependent_method,
                      OatQuickMethodHeader* dependent_header) REQUIRES(Locks::cha_lock_);
 
-  // Return compiled code that assumes that `method` has single-implementation.
-  const ListOfDependentPairs& GetDependents(ArtMethod* method) REQUIRES(Locks::cha_lock_);
+  // Return compiled code that assumes that `method` has single-implementation,
+  // decoded from the compressed dependency store.
+  ListOfDependentPairs GetDependents(ArtMethod* method) REQUIRES(Locks::cha_lock_);
 
   // Remove dependency tracking for compiled code that assumes that
   // `method` has single-implementation.
@@ -166,9 +168,55 @@ class ClassHierarchyAnalysis {
       std::unordered_set<ArtMethod*>& invalidated_single_impl_methods)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // A map that maps a method to a set of compiled code that assumes that method has a
+  // Dependents of a single method, stored as a LEB128-encoded stream of
+  // zig-zag pointer deltas: each pair is the delta of the dependent method
+  // from the previous dependent method and the delta of the dependent header
+  // from the previous dependent header. Dependent methods cluster in the
+  // class loader's LinearAlloc and headers in the JIT code cache, so most
+  // pairs encode in a few bytes instead of two pointers. The streams are
+  // arena-backed and append-only, so on a large map their pages stay clean
+  // after a zygote fork and remain shared copy-on-write across children,
+  // unlike per-entry std::vector heap blocks.
+  struct EncodedDependencyList {
+    uint32_t num_pairs = 0u;
+    uint32_t data_size = 0u;      // Used bytes in `data`.
+    uint32_t data_capacity = 0u;  // Allocated bytes in `data`.
+    uintptr_t last_method = 0u;   // Delta bases for the next append.
+    uintptr_t last_header = 0u;
+    uint8_t* data = nullptr;
+  };
+
+  // Appends one pair to `list`, growing its stream geometrically from the
+  // arena.
+  void AppendDependency(EncodedDependencyList* list, const MethodAndMethodHeaderPair& pair)
+      REQUIRES(Locks::cha_lock_);
+
+  static ListOfDependentPairs DecodeDependencies(const EncodedDependencyList& list);
+
+  // The arena never frees individual allocations, so retired streams are
+  // recycled through per-capacity free lists to keep the JIT's
+  // register/invalidate churn from growing the arena without bound.
+  uint8_t* AllocateBuffer(uint32_t capacity) REQUIRES(Locks::cha_lock_);
+  void RecycleBuffer(uint8_t* data, uint32_t capacity) REQUIRES(Locks::cha_lock_);
+  void RecycleList(EncodedDependencyList* list) REQUIRES(Locks::cha_lock_);
+
+  // Stream capacities are powers of two in
+  // [kMinBufferCapacity, kMinBufferCapacity << (kNumBufferBuckets - 1)].
+  static constexpr uint32_t kMinBufferCapacity = 16u;
+  static constexpr size_t kNumBufferBuckets = 27u;
+
+  ArenaAllocator allocator_ GUARDED_BY(Locks::cha_lock_);
+
+  // Heads of singly linked free lists of retired streams, bucketed by
+  // log2(capacity); the next pointer is stored in the stream's first bytes.
+  uint8_t* buffer_free_lists_[kNumBufferBuckets] GUARDED_BY(Locks::cha_lock_);
+
+  // A map that maps a method to compiled code that assumes that method has a
   // single implementation, which is used to do CHA-based devirtualization.
-  std::unordered_map<ArtMethod*, ListOfDependentPairs> cha_dependency_map_
+  // The map index stays a malloc-backed unordered_map so that erased nodes
+  // are returned to the heap; the bulk of the footprint is in the encoded
+  // streams hanging off the values.
+  std::unordered_map<ArtMethod*, EncodedDependencyList> cha_dependency_map_
     GUARDED_BY(Locks::cha_lock_);
 
   DISALLOW_COPY_AND_ASSIGN(ClassHierarchyAnalysis);
@@ -19,6 +19,7 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <forward_list>
 #include <iostream>
@@ -37,6 +38,7 @@
 #include "art_method-inl.h"
 #include "barrier.h"
 #include "base/arena_allocator.h"
+#include "base/array_ref.h"
 #include "base/casts.h"
 #include "base/file_utils.h"
 #include "base/hash_map.h"
@@ -144,6 +146,7 @@
 #include "thread-inl.h"
 #include "thread.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "trace.h"
 #include "transaction.h"
 #include "vdex_file.h"
@@ -218,6 +221,10 @@ static void UpdateClassAfterVerification(Handle<mirror::Class> klass,
       if (class_linker->IsQuickToInterpreterBridge(m.GetEntryPointFromQuickCompiledCode())) {
         runtime->GetInstrumentation()->InitializeMethodsCode(&m, /*aot_code=*/nullptr);
       }
+      // Replay offline-recorded dispatch targets into the dex cache so the
+      // interpreter does not pay the resolution slow path for them again.
+      // Cheap no-op when the oat file has no nterp hint cache.
+      NterpPreSeedInlineCaches(&m);
     }
   }
 }
@@ -584,7 +591,8 @@ ClassLinker::ClassLinker(InternTable* intern_table, bool fast_class_not_found_ex
       visibly_initialized_callback_(nullptr),
       critical_native_code_with_clinit_check_lock_("critical native code with clinit check lock"),
       critical_native_code_with_clinit_check_(),
-      cha_(Runtime::Current()->IsAotCompiler() ? nullptr : new ClassHierarchyAnalysis()) {
+      cha_(Runtime::Current()->IsAotCompiler() ? nullptr : new ClassHierarchyAnalysis()),
+      async_class_load_lock_("async class load lock") {
   // For CHA disabled during Aot, see b/34193647.
 
   CHECK(intern_table_ != nullptr);
@@ -2139,11 +2147,11 @@ void ClassLinker::VisitClassRoots(RootVisitor* visitor, VisitRootFlags flags) {
     // Need to make sure to not copy ArtMethods without doing read barriers since the roots are
     // marked concurrently and we don't hold the classlinker_classes_lock_ when we do the copy.
     //
-    // Use an unbuffered visitor since the class table uses a temporary GcRoot for holding decoded
-    // ClassTable::TableSlot. The buffered root visiting would access a stale stack location for
-    // these objects.
-    UnbufferedRootVisitor root_visitor(visitor, RootInfo(kRootStickyClass));
-    boot_class_table_->VisitRoots(root_visitor);
+    // Use the batched overload: it keeps the decoded ClassTable::TableSlot
+    // roots alive across each bulk visit, amortizing the virtual dispatch
+    // without the stale-stack-location problem that rules out routing a
+    // BufferedRootVisitor through the templated VisitRoots().
+    boot_class_table_->VisitRoots(visitor, RootInfo(kRootStickyClass));
     // If tracing is enabled, then mark all the class loaders to prevent unloading.
     if ((flags & kVisitRootFlagClassLoader) != 0 || tracing_enabled) {
       for (const ClassLoaderData& data : class_loaders_) {
@@ -2338,6 +2346,43 @@ void ClassLinker::VisitClassesWithoutClassesLock(ClassVisitor* visitor) {
   }
 }
 
+// Fixed-size buffer for the startup class-load trace. Writers claim a slot with
+// a single fetch-add and publish it with a release store once the descriptor is
+// written, so DefineClass() never takes a lock to record. The buffer does not
+// wrap: a trace that overflows is better truncated than missing its head, since
+// the earliest classes are the ones worth preloading.
+struct ClassLinker::StartupClassLoadTrace {
+  static constexpr size_t kCapacity = 4096u;
+
+  struct Entry {
+    uint64_t timestamp_ns = 0u;
+    std::string descriptor;
+    std::atomic<bool> published{false};
+  };
+
+  void Record(const char* descriptor) {
+    size_t slot = next_slot.fetch_add(1u, std::memory_order_relaxed);
+    if (slot >= kCapacity) {
+      return;
+    }
+    entries[slot].timestamp_ns = NanoTime();
+    entries[slot].descriptor = descriptor;
+    entries[slot].published.store(true, std::memory_order_release);
+  }
+
+  void Reset() {
+    size_t used = std::min(next_slot.load(std::memory_order_relaxed), kCapacity);
+    for (size_t i = 0; i != used; ++i) {
+      entries[i].descriptor.clear();
+      entries[i].published.store(false, std::memory_order_relaxed);
+    }
+    next_slot.store(0u, std::memory_order_relaxed);
+  }
+
+  std::atomic<size_t> next_slot{0u};
+  Entry entries[kCapacity];
+};
+
 ClassLinker::~ClassLinker() {
   Thread* const self = Thread::Current();
   for (const ClassLoaderData& data : class_loaders_) {
@@ -2385,6 +2430,10 @@ void ClassLinker::DeleteClassLoader(Thread* self, const ClassLoaderData& data, b
     }
   }
 
+  // Member pointers from this allocator may be reused for later loads; drop
+  // memoized hidden API allow decisions so a new member cannot inherit one.
+  hiddenapi::FlushAllowedAccessCache();
+
   delete data.allocator;
   delete data.class_table;
 }
@@ -3295,6 +3344,10 @@ ObjPtr<mirror::Class> ClassLinker::DefineClass(Thread* self,
   // Notify native debugger of the new class and its layout.
   jit::Jit::NewTypeLoadedIfUsingJit(h_new_class.Get());
 
+  if (UNLIKELY(recording_startup_classes_.load(std::memory_order_acquire))) {
+    RecordStartupClass(descriptor);
+  }
+
   return sdc.Finish(h_new_class);
 }
 
@@ -3481,6 +3534,11 @@ LengthPrefixedArray<ArtField>* ClassLinker::AllocArtFieldArray(Thread* self,
   static_assert(alignof(ArtField) == 4, "ArtField alignment is expected to be 4.");
   size_t storage_size = LengthPrefixedArray<ArtField>::ComputeSize(length);
   void* array_storage = allocator->Alloc(self, storage_size);
+  return InitArtFieldArray(array_storage, length);
+}
+
+LengthPrefixedArray<ArtField>* ClassLinker::InitArtFieldArray(void* array_storage, size_t length) {
+  DCHECK_NE(length, 0u);
   auto* ret = new(array_storage) LengthPrefixedArray<ArtField>(length);
   CHECK(ret != nullptr);
   std::uninitialized_fill_n(&ret->At(0), length, ArtField());
@@ -3498,6 +3556,14 @@ LengthPrefixedArray<ArtMethod>* ClassLinker::AllocArtMethodArray(Thread* self,
   const size_t storage_size =
       LengthPrefixedArray<ArtMethod>::ComputeSize(length, method_size, method_alignment);
   void* array_storage = allocator->Alloc(self, storage_size);
+  return InitArtMethodArray(array_storage, length);
+}
+
+LengthPrefixedArray<ArtMethod>* ClassLinker::InitArtMethodArray(void* array_storage,
+                                                                size_t length) {
+  DCHECK_NE(length, 0u);
+  const size_t method_alignment = ArtMethod::Alignment(image_pointer_size_);
+  const size_t method_size = ArtMethod::Size(image_pointer_size_);
   auto* ret = new (array_storage) LengthPrefixedArray<ArtMethod>(length);
   CHECK(ret != nullptr);
   for (size_t i = 0; i < length; ++i) {
@@ -3548,12 +3614,30 @@ void ClassLinker::LoadClass(Thread* self,
     // We allow duplicate definitions of the same field in a class_data_item
     // but ignore the repeated indexes here, b/21868015.
     LinearAlloc* const allocator = GetAllocatorForClassLoader(klass->GetClassLoader());
-    LengthPrefixedArray<ArtField>* sfields = AllocArtFieldArray(self,
-                                                                allocator,
-                                                                accessor.NumStaticFields());
-    LengthPrefixedArray<ArtField>* ifields = AllocArtFieldArray(self,
-                                                                allocator,
-                                                                accessor.NumInstanceFields());
+    // Allocate the storage for the field and method arrays together, so that the
+    // allocator lock is taken at most once for the class. Empty arrays stay null.
+    const size_t method_alignment = ArtMethod::Alignment(image_pointer_size_);
+    const size_t method_size = ArtMethod::Size(image_pointer_size_);
+    const size_t array_storage_sizes[] = {
+        accessor.NumStaticFields() != 0u
+            ? LengthPrefixedArray<ArtField>::ComputeSize(accessor.NumStaticFields())
+            : 0u,
+        accessor.NumInstanceFields() != 0u
+            ? LengthPrefixedArray<ArtField>::ComputeSize(accessor.NumInstanceFields())
+            : 0u,
+        accessor.NumMethods() != 0u
+            ? LengthPrefixedArray<ArtMethod>::ComputeSize(
+                  accessor.NumMethods(), method_size, method_alignment)
+            : 0u,
+    };
+    void* array_storages[arraysize(array_storage_sizes)];
+    allocator->AllocBatch(self, ArrayRef<const size_t>(array_storage_sizes), array_storages);
+    LengthPrefixedArray<ArtField>* sfields = accessor.NumStaticFields() != 0u
+        ? InitArtFieldArray(array_storages[0], accessor.NumStaticFields())
+        : nullptr;
+    LengthPrefixedArray<ArtField>* ifields = accessor.NumInstanceFields() != 0u
+        ? InitArtFieldArray(array_storages[1], accessor.NumInstanceFields())
+        : nullptr;
     size_t num_sfields = 0u;
     size_t num_ifields = 0u;
     uint32_t last_static_field_idx = 0u;
@@ -3566,7 +3650,9 @@ void ClassLinker::LoadClass(Thread* self,
         : OatFile::OatClass::Invalid();
     const OatFile::OatClass* oat_class_ptr = has_oat_class ? &oat_class : nullptr;
     klass->SetMethodsPtr(
-        AllocArtMethodArray(self, allocator, accessor.NumMethods()),
+        accessor.NumMethods() != 0u
+            ? InitArtMethodArray(array_storages[2], accessor.NumMethods())
+            : nullptr,
         accessor.NumDirectMethods(),
         accessor.NumVirtualMethods());
     size_t class_def_method_index = 0;
@@ -3643,6 +3729,235 @@ void ClassLinker::LoadClass(Thread* self,
   self->AllowThreadSuspension();
 }
 
+namespace {
+
+// Shared worklist for PreloadClassesConcurrently. Workers claim descriptors with a single
+// fetch-add, so a worker that finishes a cheap class immediately picks up the next one
+// instead of idling behind a static partition.
+struct PreloadClassesWorkList {
+  explicit PreloadClassesWorkList(std::vector<std::string>&& descriptors)
+      : descriptors(std::move(descriptors)), next_index(0u) {}
+
+  const std::vector<std::string> descriptors;
+  std::atomic<size_t> next_index;
+};
+
+class PreloadClassesTask final : public SelfDeletingTask {
+ public:
+  PreloadClassesTask(std::shared_ptr<PreloadClassesWorkList> work_list, jobject class_loader)
+      : work_list_(std::move(work_list)), class_loader_(class_loader) {}
+
+  void Run(Thread* self) override {
+    ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
+    for (size_t i = work_list_->next_index.fetch_add(1u, std::memory_order_relaxed);
+         i < work_list_->descriptors.size();
+         i = work_list_->next_index.fetch_add(1u, std::memory_order_relaxed)) {
+      // Take the handles per class so that a long resolution does not block
+      // suspend requests for the whole worklist.
+      ScopedObjectAccess soa(self);
+      StackHandleScope<1> hs(self);
+      Handle<mirror::ClassLoader> h_loader(
+          hs.NewHandle(soa.Decode<mirror::ClassLoader>(class_loader_)));
+      ObjPtr<mirror::Class> klass =
+          class_linker->FindClass(self, work_list_->descriptors[i].c_str(), h_loader);
+      if (klass == nullptr) {
+        // Preloading is best effort; a missing or malformed class is reported
+        // again (with a proper context) when the app actually resolves it.
+        DCHECK(self->IsExceptionPending());
+        self->ClearException();
+      }
+    }
+  }
+
+ private:
+  const std::shared_ptr<PreloadClassesWorkList> work_list_;
+  const jobject class_loader_;
+};
+
+}  // namespace
+
+void ClassLinker::PreloadClassesConcurrently(Thread* self,
+                                             jobject class_loader,
+                                             std::vector<std::string>&& descriptors,
+                                             size_t thread_count) {
+  DCHECK(!Runtime::Current()->IsShuttingDown(self));
+  if (descriptors.empty()) {
+    return;
+  }
+  auto work_list = std::make_shared<PreloadClassesWorkList>(std::move(descriptors));
+  // Publication of concurrently defined classes is safe: ClassTable::InsertClass takes the
+  // table's own lock and DefineClass resolves races by adopting the winning class, so
+  // workers only pay for contention when they actually collide on a descriptor.
+  std::unique_ptr<ThreadPool> pool(new ThreadPool("Class preload thread pool", thread_count));
+  for (size_t i = 0; i < std::max(thread_count, size_t{1}); ++i) {
+    pool->AddTask(self, new PreloadClassesTask(work_list, class_loader));
+  }
+  pool->StartWorkers(self);
+  pool->Wait(self, /* do_work= */ true, /* may_hold_locks= */ false);
+}
+
+void ClassLinker::PreloadClassesInBackground(Thread* self,
+                                             jobject class_loader,
+                                             std::vector<std::string>&& descriptors,
+                                             size_t thread_count) {
+  DCHECK(!Runtime::Current()->IsShuttingDown(self));
+  DCHECK(startup_class_preload_pool_ == nullptr) << "Background preload already in flight";
+  if (descriptors.empty()) {
+    return;
+  }
+  // The tasks share ownership of the worklist, so the pool can outlive this
+  // frame and drain while the caller continues with app init.
+  auto work_list = std::make_shared<PreloadClassesWorkList>(std::move(descriptors));
+  startup_class_preload_pool_.reset(
+      new ThreadPool("Startup class preload thread pool", thread_count));
+  for (size_t i = 0; i < std::max(thread_count, size_t{1}); ++i) {
+    startup_class_preload_pool_->AddTask(self, new PreloadClassesTask(work_list, class_loader));
+  }
+  startup_class_preload_pool_->StartWorkers(self);
+}
+
+void ClassLinker::WaitForBackgroundClassPreload(Thread* self) {
+  if (startup_class_preload_pool_ != nullptr) {
+    startup_class_preload_pool_->Wait(self, /* do_work= */ false, /* may_hold_locks= */ false);
+    startup_class_preload_pool_.reset();
+  }
+}
+
+ClassLinker::AsyncClassLoadToken::AsyncClassLoadToken(const char* descriptor,
+                                                      jobject class_loader)
+    : descriptor_(descriptor),
+      class_loader_(class_loader),
+      lock_("async class load token lock"),
+      cond_("async class load token condition variable", lock_),
+      completed_(false),
+      result_(nullptr) {}
+
+ClassLinker::AsyncClassLoadToken::~AsyncClassLoadToken() {
+  Thread* const self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  soa.Vm()->DeleteGlobalRef(self, class_loader_);
+  MutexLock mu(self, lock_);
+  if (result_ != nullptr) {
+    soa.Vm()->DeleteGlobalRef(self, result_);
+  }
+}
+
+bool ClassLinker::AsyncClassLoadToken::IsCompleted() {
+  MutexLock mu(Thread::Current(), lock_);
+  return completed_;
+}
+
+ObjPtr<mirror::Class> ClassLinker::AsyncClassLoadToken::WaitAndGet(Thread* self) {
+  jobject result = nullptr;
+  {
+    // Block in kWaiting so a pending GC or suspend request is not held up by
+    // the in-flight load.
+    ScopedThreadSuspension sts(self, ThreadState::kWaiting);
+    MutexLock mu(self, lock_);
+    while (!completed_) {
+      cond_.Wait(self);
+    }
+    result = result_;
+  }
+  return result != nullptr ? ObjPtr<mirror::Class>::DownCast(self->DecodeJObject(result))
+                           : nullptr;
+}
+
+void ClassLinker::AsyncClassLoadToken::Complete(Thread* self, jobject result) {
+  MutexLock mu(self, lock_);
+  DCHECK(!completed_);
+  result_ = result;
+  completed_ = true;
+  cond_.Broadcast(self);
+}
+
+std::shared_ptr<ClassLinker::AsyncClassLoadToken> ClassLinker::FindClassAsync(
+    Thread* self, const char* descriptor, Handle<mirror::ClassLoader> class_loader) {
+  DCHECK(!Runtime::Current()->IsShuttingDown(self));
+  JavaVMExt* const vm = Runtime::Current()->GetJavaVM();
+  std::shared_ptr<AsyncClassLoadToken> token(
+      new AsyncClassLoadToken(descriptor, vm->AddGlobalRef(self, class_loader.Get())));
+  MutexLock mu(self, async_class_load_lock_);
+  if (async_class_load_pool_ == nullptr) {
+    // A single loader thread keeps queued loads in request order; FindClass()
+    // itself already interleaves safely with concurrent demand loads.
+    async_class_load_pool_.reset(new ThreadPool("Async class load thread pool", 1u));
+    async_class_load_pool_->StartWorkers(self);
+  }
+  async_class_load_pool_->AddTask(self, new FunctionTask([token](Thread* worker_self) {
+    ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
+    jobject result = nullptr;
+    {
+      ScopedObjectAccess soa(worker_self);
+      StackHandleScope<1> hs(worker_self);
+      Handle<mirror::ClassLoader> h_loader(
+          hs.NewHandle(soa.Decode<mirror::ClassLoader>(token->class_loader_)));
+      ObjPtr<mirror::Class> klass =
+          class_linker->FindClass(worker_self, token->descriptor_.c_str(), h_loader);
+      if (klass != nullptr) {
+        result = soa.Vm()->AddGlobalRef(worker_self, klass);
+      } else {
+        // As for class preloading, the failure is reported again with a proper
+        // context when the caller resolves the class on demand.
+        DCHECK(worker_self->IsExceptionPending());
+        worker_self->ClearException();
+      }
+    }
+    token->Complete(worker_self, result);
+  }));
+  return token;
+}
+
+void ClassLinker::WaitForAsyncClassLoads(Thread* self) {
+  std::unique_ptr<ThreadPool> pool;
+  {
+    MutexLock mu(self, async_class_load_lock_);
+    pool = std::move(async_class_load_pool_);
+  }
+  if (pool != nullptr) {
+    pool->Wait(self, /* do_work= */ false, /* may_hold_locks= */ false);
+  }
+}
+
+void ClassLinker::StartRecordingStartupClasses() {
+  if (recording_startup_classes_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  if (startup_class_load_trace_ == nullptr) {
+    startup_class_load_trace_.reset(new StartupClassLoadTrace());
+  } else {
+    startup_class_load_trace_->Reset();
+  }
+  recording_startup_classes_.store(true, std::memory_order_release);
+}
+
+std::vector<ClassLinker::StartupClassLoadEvent> ClassLinker::StopRecordingStartupClasses() {
+  recording_startup_classes_.store(false, std::memory_order_release);
+  std::vector<StartupClassLoadEvent> events;
+  StartupClassLoadTrace* trace = startup_class_load_trace_.get();
+  if (trace == nullptr) {
+    return events;
+  }
+  size_t used = std::min(trace->next_slot.load(std::memory_order_relaxed),
+                         StartupClassLoadTrace::kCapacity);
+  events.reserve(used);
+  for (size_t i = 0; i != used; ++i) {
+    // Skip slots claimed but not yet published by a recorder that raced with the stop.
+    if (trace->entries[i].published.load(std::memory_order_acquire)) {
+      events.push_back(StartupClassLoadEvent{trace->entries[i].timestamp_ns,
+                                             trace->entries[i].descriptor});
+    }
+  }
+  return events;
+}
+
+void ClassLinker::RecordStartupClass(const char* descriptor) {
+  StartupClassLoadTrace* trace = startup_class_load_trace_.get();
+  if (trace != nullptr) {
+    trace->Record(descriptor);
+  }
+}
+
 void ClassLinker::LoadField(const ClassAccessor::Field& field,
                             Handle<mirror::Class> klass,
                             ArtField* dst) {
@@ -6408,9 +6723,7 @@ void ClassLinker::FillIMTFromIfTable(ObjPtr<mirror::IfTable> if_table,
           continue;
         }
         ImtConflictTable* table = imt[imt_index]->GetImtConflictTable(image_pointer_size_);
-        const size_t num_entries = table->NumEntries(image_pointer_size_);
-        table->SetInterfaceMethod(num_entries, image_pointer_size_, interface_method);
-        table->SetImplementationMethod(num_entries, image_pointer_size_, implementation_method);
+        table->AddEntrySorted(interface_method, implementation_method, image_pointer_size_);
       }
     }
   }
@@ -9227,6 +9540,63 @@ ObjPtr<mirror::Class> ClassLinker::DoResolveType(dex::TypeIndex type_idx,
   return resolved;
 }
 
+size_t ClassLinker::ResolveTypesBulk(Thread* self,
+                                     dex::TypeIndex start_idx,
+                                     size_t count,
+                                     Handle<mirror::DexCache> dex_cache,
+                                     Handle<mirror::ClassLoader> class_loader) {
+  DCHECK(dex_cache->GetClassLoader() == class_loader.Get());
+  DCHECK_LE(start_idx.index_ + count, dex_cache->GetDexFile()->NumTypeIds());
+  size_t resolved_count = 0u;
+  for (size_t i = 0u; i != count; ++i) {
+    dex::TypeIndex type_idx(dchecked_integral_cast<uint16_t>(start_idx.index_ + i));
+    // Leave entries that are already resolved alone - rewriting them would
+    // only invalidate the owning cache lines on other cores.
+    if (dex_cache->GetResolvedType(type_idx) != nullptr) {
+      ++resolved_count;
+      continue;
+    }
+    if (DoResolveType(type_idx, dex_cache, class_loader) != nullptr) {
+      ++resolved_count;
+    } else {
+      // Bulk resolution is best effort, as for class preloading; the error
+      // resurfaces with proper context when the entry is resolved on demand.
+      DCHECK(self->IsExceptionPending());
+      self->ClearException();
+    }
+  }
+  // Publish the run as a batch. Preload threads that hand the warmed range to
+  // consumers through an acquire-read flag make the whole run visible with
+  // this one fence instead of relying on the per-entry release stores.
+  std::atomic_thread_fence(std::memory_order_release);
+  return resolved_count;
+}
+
+size_t ClassLinker::ResolveMethodTypesBulk(Thread* self,
+                                           dex::ProtoIndex start_idx,
+                                           size_t count,
+                                           Handle<mirror::DexCache> dex_cache,
+                                           Handle<mirror::ClassLoader> class_loader) {
+  DCHECK(dex_cache->GetClassLoader() == class_loader.Get());
+  DCHECK_LE(start_idx.index_ + count, dex_cache->GetDexFile()->NumProtoIds());
+  size_t resolved_count = 0u;
+  for (size_t i = 0u; i != count; ++i) {
+    dex::ProtoIndex proto_idx(dchecked_integral_cast<uint16_t>(start_idx.index_ + i));
+    if (dex_cache->GetResolvedMethodType(proto_idx) != nullptr) {
+      ++resolved_count;
+      continue;
+    }
+    if (ResolveMethodType(self, proto_idx, dex_cache, class_loader) != nullptr) {
+      ++resolved_count;
+    } else {
+      DCHECK(self->IsExceptionPending());
+      self->ClearException();
+    }
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  return resolved_count;
+}
+
 ArtMethod* ClassLinker::FindResolvedMethod(ObjPtr<mirror::Class> klass,
                                            ObjPtr<mirror::DexCache> dex_cache,
                                            ObjPtr<mirror::ClassLoader> class_loader,
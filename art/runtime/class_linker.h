@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_CLASS_LINKER_H_
 #define ART_RUNTIME_CLASS_LINKER_H_
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <set>
@@ -63,6 +64,7 @@ class ScopedObjectAccessAlreadyRunnable;
 class SdkChecker;
 template<size_t kNumReferences> class PACKED(4) StackHandleScope;
 class Thread;
+class ThreadPool;
 
 enum VisitRootFlags : uint8_t;
 
@@ -206,6 +208,102 @@ class ClassLinker {
     return FindClass(self, descriptor, ScopedNullHandle<mirror::ClassLoader>());
   }
 
+  // Resolves `descriptors` in `class_loader` on a temporary pool of `thread_count` workers
+  // sharing a single worklist, so that loading of independent classes proceeds in parallel
+  // during startup. Resolution failures are swallowed - preloading is best effort and any
+  // real error resurfaces when the class is resolved on demand. The caller must not hold
+  // the mutator lock; workers attach per class.
+  void PreloadClassesConcurrently(Thread* self,
+                                  jobject class_loader,
+                                  std::vector<std::string>&& descriptors,
+                                  size_t thread_count)
+      REQUIRES(!Locks::dex_lock_);
+
+  // Starts recording the startup class-load trace: DefineClass() appends the
+  // descriptor and a timestamp for every class it resolves to a fixed-size
+  // lock-free buffer. Classes defined beyond the buffer capacity are dropped,
+  // keeping the head of the trace. No-op if recording is already active.
+  void StartRecordingStartupClasses();
+
+  struct StartupClassLoadEvent {
+    uint64_t timestamp_ns;
+    std::string descriptor;
+  };
+
+  // Stops recording and returns the recorded events in definition order. A
+  // later launch can feed the descriptors to PreloadClassesInBackground() to
+  // resolve them ahead of the main thread's demand.
+  std::vector<StartupClassLoadEvent> StopRecordingStartupClasses();
+
+  // Starts resolving `descriptors` on background workers and returns without
+  // waiting, so that replaying a recorded startup trace overlaps with early app
+  // init on the main thread. Preloading is best effort, as for
+  // PreloadClassesConcurrently(). `class_loader` must stay valid until
+  // WaitForBackgroundClassPreload() returns; only one background preload may be
+  // in flight at a time.
+  void PreloadClassesInBackground(Thread* self,
+                                  jobject class_loader,
+                                  std::vector<std::string>&& descriptors,
+                                  size_t thread_count)
+      REQUIRES(!Locks::dex_lock_);
+
+  // Waits for a background preload (if any) to drain and releases its workers.
+  void WaitForBackgroundClassPreload(Thread* self);
+
+  // Completion token for FindClassAsync(). The requesting thread keeps the
+  // token and either polls IsCompleted() or blocks in WaitAndGet(); the loader
+  // task completes it exactly once. The result is held as a global reference
+  // so the token may outlive any particular mutator-lock region of the caller.
+  class AsyncClassLoadToken {
+   public:
+    ~AsyncClassLoadToken();
+
+    // Returns true once the loader task has published a result (possibly null).
+    bool IsCompleted() REQUIRES(!lock_);
+
+    // Blocks until the load completes and returns the loaded class, or null if
+    // the load failed; as for class preloading, a failure resurfaces with a
+    // proper context when the caller resolves the class on demand. The calling
+    // thread suspends to kWaiting while blocked.
+    ObjPtr<mirror::Class> WaitAndGet(Thread* self)
+        REQUIRES(!lock_)
+        REQUIRES_SHARED(Locks::mutator_lock_);
+
+   private:
+    AsyncClassLoadToken(const char* descriptor, jobject class_loader);
+
+    // Called exactly once by the loader task with a global reference (or null).
+    void Complete(Thread* self, jobject result) REQUIRES(!lock_);
+
+    const std::string descriptor_;
+    const jobject class_loader_;  // Global reference, owned.
+    Mutex lock_;
+    ConditionVariable cond_ GUARDED_BY(lock_);
+    bool completed_ GUARDED_BY(lock_);
+    jobject result_ GUARDED_BY(lock_);  // Global reference, owned; null until completed.
+
+    friend class ClassLinker;
+    DISALLOW_COPY_AND_ASSIGN(AsyncClassLoadToken);
+  };
+
+  // Starts loading `descriptor` in `class_loader` on a dedicated loader thread
+  // and returns a completion token without waiting, so that threads with
+  // latency budgets (e.g. binder threads) can kick off dex I/O, loading and
+  // verification ahead of the first use without stalling on them. The worker
+  // goes through FindClass(), so it serializes with concurrent demand loads
+  // via the usual ClassStatus protocol and a racing demand load simply adopts
+  // the same class. The tasks share ownership of the token, so the caller is
+  // free to drop it before the load finishes.
+  std::shared_ptr<AsyncClassLoadToken> FindClassAsync(Thread* self,
+                                                      const char* descriptor,
+                                                      Handle<mirror::ClassLoader> class_loader)
+      REQUIRES(!Locks::dex_lock_, !async_class_load_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Waits for queued asynchronous class loads to drain and releases the loader
+  // thread. Called during runtime shutdown.
+  void WaitForAsyncClassLoads(Thread* self) REQUIRES(!async_class_load_lock_);
+
   // Finds the array class given for the element class.
   ObjPtr<mirror::Class> FindArrayClass(Thread* self, ObjPtr<mirror::Class> element_class)
       REQUIRES_SHARED(Locks::mutator_lock_)
@@ -292,6 +390,23 @@ class ClassLinker {
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::dex_lock_, !Roles::uninterruptible_);
 
+  // Resolves the contiguous run of `count` type indices starting at `start_idx`
+  // into `dex_cache` and returns the number of resolved entries. Used by
+  // AOT-informed startup preloading to warm whole DexCache runs from one
+  // thread instead of having many threads fault entries in one at a time and
+  // ping-pong the owning cache lines. Entries that are already resolved are
+  // left untouched; per-entry resolution failures are swallowed and resurface
+  // with proper context on demand resolution. A single release fence after the
+  // run publishes the batch to readers that learn of it through a subsequent
+  // acquire operation, e.g. a "preload done" flag.
+  size_t ResolveTypesBulk(Thread* self,
+                          dex::TypeIndex start_idx,
+                          size_t count,
+                          Handle<mirror::DexCache> dex_cache,
+                          Handle<mirror::ClassLoader> class_loader)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!Locks::dex_lock_, !Roles::uninterruptible_);
+
   // Look up a resolved type with the given index from the DexFile associated with the given
   // `referrer`, storing the result in the DexCache. The `referrer` is used to identify the
   // target DexCache and ClassLoader to use for lookup.
@@ -434,6 +549,18 @@ class ClassLinker {
                                                ArtMethod* referrer)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Resolves the contiguous run of `count` proto indices starting at
+  // `start_idx` into `dex_cache` and returns the number of resolved entries.
+  // Batch counterpart of ResolveMethodType() with the same semantics as
+  // ResolveTypesBulk().
+  size_t ResolveMethodTypesBulk(Thread* self,
+                                dex::ProtoIndex start_idx,
+                                size_t count,
+                                Handle<mirror::DexCache> dex_cache,
+                                Handle<mirror::ClassLoader> class_loader)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!Locks::dex_lock_, !Roles::uninterruptible_);
+
   // Resolve a method handle with a given ID from the DexFile. The
   // result is not cached in the DexCache as the instance will only be
   // used once in most circumstances.
@@ -516,6 +643,11 @@ class ClassLinker {
                                                       LinearAlloc* allocator,
                                                       size_t length);
 
+  // Initialize a field/method array in storage obtained from a `LinearAlloc`, typically
+  // through `LinearAlloc::AllocBatch`. `length` must be non-zero.
+  static LengthPrefixedArray<ArtField>* InitArtFieldArray(void* array_storage, size_t length);
+  LengthPrefixedArray<ArtMethod>* InitArtMethodArray(void* array_storage, size_t length);
+
   // Convenience AllocClass() overload that uses mirror::Class::InitializeClassVisitor
   // for the class initialization and uses the `java_lang_Class` from class roots
   // instead of an explicit argument.
@@ -1351,6 +1483,25 @@ class ClassLinker {
 
   std::unique_ptr<ClassHierarchyAnalysis> cha_;
 
+  // Appends `descriptor` to the startup class-load trace; called by
+  // DefineClass() when `recording_startup_classes_` is set.
+  void RecordStartupClass(const char* descriptor);
+
+  // Lock-free buffer for the startup class-load trace, allocated on the first
+  // StartRecordingStartupClasses() and kept for the runtime's lifetime so that
+  // racing recorders never observe it being freed.
+  struct StartupClassLoadTrace;
+  std::atomic<bool> recording_startup_classes_{false};
+  std::unique_ptr<StartupClassLoadTrace> startup_class_load_trace_;
+
+  // Workers of an in-flight background class preload, see
+  // PreloadClassesInBackground().
+  std::unique_ptr<ThreadPool> startup_class_preload_pool_;
+
+  // Guards the lazy creation of `async_class_load_pool_`, see FindClassAsync().
+  Mutex async_class_load_lock_;
+  std::unique_ptr<ThreadPool> async_class_load_pool_ GUARDED_BY(async_class_load_lock_);
+
   class FindVirtualMethodHolderVisitor;
 
   friend class AppImageLoadingHelper;
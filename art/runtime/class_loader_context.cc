@@ -1317,6 +1317,33 @@ ClassLoaderContext::VerificationResult ClassLoaderContext::VerifyClassLoaderCont
         << "dex_files_state_=" << dex_files_state_;
   }
 
+  // Cache per flag combination: the flags relax the comparison, so a spec can mismatch
+  // under full verification and still match with names or checksums ignored.
+  std::string key;
+  key.reserve(context_spec.size() + 2u);
+  key.push_back(verify_names ? 'n' : '-');
+  key.push_back(verify_checksums ? 'c' : '-');
+  key += context_spec;
+  {
+    std::lock_guard<std::mutex> lock(verification_results_lock_);
+    auto it = verification_results_.find(key);
+    if (it != verification_results_.end()) {
+      return it->second;
+    }
+  }
+
+  VerificationResult result =
+      VerifyClassLoaderContextMatchImpl(context_spec, verify_names, verify_checksums);
+
+  std::lock_guard<std::mutex> lock(verification_results_lock_);
+  verification_results_.emplace(std::move(key), result);
+  return result;
+}
+
+ClassLoaderContext::VerificationResult ClassLoaderContext::VerifyClassLoaderContextMatchImpl(
+    const std::string& context_spec,
+    bool verify_names,
+    bool verify_checksums) const {
   ClassLoaderContext expected_context;
   if (!expected_context.Parse(context_spec, verify_checksums)) {
     LOG(WARNING) << "Invalid class loader context: " << context_spec;
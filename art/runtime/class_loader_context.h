@@ -17,6 +17,8 @@
 #ifndef ART_RUNTIME_CLASS_LOADER_CONTEXT_H_
 #define ART_RUNTIME_CLASS_LOADER_CONTEXT_H_
 
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <set>
@@ -364,9 +366,23 @@ class ClassLoaderContext {
     kDexFilesOpenFailed = 4
   };
 
+  // Uncached implementation of VerifyClassLoaderContextMatch().
+  VerificationResult VerifyClassLoaderContextMatchImpl(const std::string& context_spec,
+                                                       bool verify_names,
+                                                       bool verify_checksums) const;
+
   // The class loader chain.
   std::unique_ptr<ClassLoaderInfo> class_loader_chain_;
 
+  // Memoized results of VerifyClassLoaderContextMatch(), keyed by the stored context spec
+  // and the verification flags. Once the dex checksums are read the context is immutable,
+  // so a given spec either matches or it does not; apps with several oat files compiled
+  // against the same context (e.g. splits) then pay for the parse-and-compare only once
+  // and subsequent verifications are a single hash lookup.
+  mutable std::mutex verification_results_lock_;
+  mutable std::map<std::string, VerificationResult> verification_results_
+      GUARDED_BY(verification_results_lock_);
+
   // The opening state of the dex files.
   ContextDexFilesState dex_files_state_;
 
@@ -71,8 +71,8 @@ inline bool ClassTable::ClassDescriptorEquals::operator()(const TableSlot& a,
 template<class Visitor>
 void ClassTable::VisitRoots(Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (TableSlot& table_slot : class_set) {
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (TableSlot& table_slot : *class_set) {
       table_slot.VisitRoot(visitor);
     }
   }
@@ -89,8 +89,8 @@ void ClassTable::VisitRoots(Visitor& visitor) {
 template<class Visitor>
 void ClassTable::VisitRoots(const Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (TableSlot& table_slot : class_set) {
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (TableSlot& table_slot : *class_set) {
       table_slot.VisitRoot(visitor);
     }
   }
@@ -107,8 +107,8 @@ void ClassTable::VisitRoots(const Visitor& visitor) {
 template <ReadBarrierOption kReadBarrierOption, typename Visitor>
 bool ClassTable::Visit(Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (TableSlot& table_slot : class_set) {
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (TableSlot& table_slot : *class_set) {
       if (!visitor(table_slot.Read<kReadBarrierOption>())) {
         return false;
       }
@@ -120,8 +120,8 @@ bool ClassTable::Visit(Visitor& visitor) {
 template <ReadBarrierOption kReadBarrierOption, typename Visitor>
 bool ClassTable::Visit(const Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (TableSlot& table_slot : class_set) {
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (TableSlot& table_slot : *class_set) {
       if (!visitor(table_slot.Read<kReadBarrierOption>())) {
         return false;
       }
@@ -162,6 +162,22 @@ inline void ClassTable::TableSlot::VisitRoot(const Visitor& visitor) const {
   }
 }
 
+inline uint32_t ClassTable::TableSlot::CopyForBulkVisit(GcRoot<mirror::Class>* root) const {
+  const uint32_t before = data_.load(std::memory_order_relaxed);
+  *root = GcRoot<mirror::Class>(ExtractPtr(before));
+  return before;
+}
+
+inline void ClassTable::TableSlot::WriteBackAfterBulkVisit(uint32_t before,
+                                                           ObjPtr<mirror::Class> after) const {
+  ObjPtr<mirror::Class> before_ptr(ExtractPtr(before));
+  if (before_ptr != after) {
+    // If another thread raced and updated the reference, do not store the read barrier updated
+    // one.
+    data_.CompareAndSetStrongRelease(before, Encode(after, MaskHash(before)));
+  }
+}
+
 inline ObjPtr<mirror::Class> ClassTable::TableSlot::ExtractPtr(uint32_t data) {
   return reinterpret_cast<mirror::Class*>(data & ~kHashMask);
 }
@@ -25,17 +25,30 @@ namespace art {
 
 ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock) {
   Runtime* const runtime = Runtime::Current();
-  classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
-                              runtime->GetHashTableMaxLoadFactor()));
+  classes_.push_back(std::make_unique<ClassSet>(runtime->GetHashTableMinLoadFactor(),
+                                                runtime->GetHashTableMaxLoadFactor()));
+}
+
+void ClassTable::PublishFrozenSetsViewLocked() {
+  std::unique_ptr<FrozenSetsView> view(new FrozenSetsView);
+  view->sets.reserve(classes_.size() - 1);
+  for (size_t i = 0; i < classes_.size() - 1; ++i) {
+    view->sets.push_back(classes_[i].get());
+  }
+  // Release so that readers doing an acquire load see fully constructed sets.
+  frozen_sets_view_.store(view.get(), std::memory_order_release);
+  frozen_sets_views_.push_back(std::move(view));
 }
 
 void ClassTable::FreezeSnapshot() {
   WriterMutexLock mu(Thread::Current(), lock_);
   // Propagate the min/max load factor from the old active set.
   DCHECK(!classes_.empty());
-  const ClassSet& last_set = classes_.back();
-  ClassSet new_set(last_set.GetMinLoadFactor(), last_set.GetMaxLoadFactor());
-  classes_.push_back(std::move(new_set));
+  const ClassSet& last_set = *classes_.back();
+  classes_.push_back(
+      std::make_unique<ClassSet>(last_set.GetMinLoadFactor(), last_set.GetMaxLoadFactor()));
+  // The previous active set is now frozen and becomes visible to lock-free readers.
+  PublishFrozenSetsViewLocked();
 }
 
 ObjPtr<mirror::Class> ClassTable::UpdateClass(const char* descriptor,
@@ -44,10 +57,10 @@ ObjPtr<mirror::Class> ClassTable::UpdateClass(const char* descriptor,
   WriterMutexLock mu(Thread::Current(), lock_);
   // Should only be updating latest table.
   DescriptorHashPair pair(descriptor, hash);
-  auto existing_it = classes_.back().FindWithHash(pair, hash);
-  if (existing_it == classes_.back().end()) {
-    for (const ClassSet& class_set : classes_) {
-      if (class_set.FindWithHash(pair, hash) != class_set.end()) {
+  auto existing_it = classes_.back()->FindWithHash(pair, hash);
+  if (existing_it == classes_.back()->end()) {
+    for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+      if (class_set->FindWithHash(pair, hash) != class_set->end()) {
         LOG(FATAL) << "Updating class found in frozen table " << descriptor;
       }
     }
@@ -80,44 +93,56 @@ size_t ClassTable::NumZygoteClasses(ObjPtr<mirror::ClassLoader> defining_loader)
   ReaderMutexLock mu(Thread::Current(), lock_);
   size_t sum = 0;
   for (size_t i = 0; i < classes_.size() - 1; ++i) {
-    sum += CountDefiningLoaderClasses(defining_loader, classes_[i]);
+    sum += CountDefiningLoaderClasses(defining_loader, *classes_[i]);
   }
   return sum;
 }
 
 size_t ClassTable::NumNonZygoteClasses(ObjPtr<mirror::ClassLoader> defining_loader) const {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  return CountDefiningLoaderClasses(defining_loader, classes_.back());
+  return CountDefiningLoaderClasses(defining_loader, *classes_.back());
 }
 
 size_t ClassTable::NumReferencedZygoteClasses() const {
   ReaderMutexLock mu(Thread::Current(), lock_);
   size_t sum = 0;
   for (size_t i = 0; i < classes_.size() - 1; ++i) {
-    sum += classes_[i].size();
+    sum += classes_[i]->size();
   }
   return sum;
 }
 
 size_t ClassTable::NumReferencedNonZygoteClasses() const {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  return classes_.back().size();
+  return classes_.back()->size();
 }
 
 ObjPtr<mirror::Class> ClassTable::Lookup(const char* descriptor, size_t hash) {
   DescriptorHashPair pair(descriptor, hash);
-  ReaderMutexLock mu(Thread::Current(), lock_);
-  // Search from the last table, assuming that apps shall search for their own classes
-  // more often than for boot image classes. For prebuilt boot images, this also helps
-  // by searching the large table from the framework boot image extension compiled as
-  // single-image before the individual small tables from the primary boot image
-  // compiled as multi-image.
-  for (ClassSet& class_set : ReverseRange(classes_)) {
-    auto it = class_set.FindWithHash(pair, hash);
-    if (it != class_set.end()) {
-      return it->Read();
+  // Probe the frozen sets without taking `lock_`. They are immutable after
+  // `FreezeSnapshot` and the published view keeps them alive, so readers never
+  // contend with concurrent inserts into the active set. A descriptor is present
+  // in at most one set of a table, so searching the frozen sets first does not
+  // change the result. Search from the last table, assuming that apps shall
+  // search for their own classes more often than for boot image classes. For
+  // prebuilt boot images, this also helps by searching the large table from the
+  // framework boot image extension compiled as single-image before the
+  // individual small tables from the primary boot image compiled as multi-image.
+  const FrozenSetsView* frozen = frozen_sets_view_.load(std::memory_order_acquire);
+  if (frozen != nullptr) {
+    for (const ClassSet* class_set : ReverseRange(frozen->sets)) {
+      auto it = class_set->FindWithHash(pair, hash);
+      if (it != class_set->end()) {
+        return it->Read();
+      }
     }
   }
+  // Only the mutable active set still needs the lock.
+  ReaderMutexLock mu(Thread::Current(), lock_);
+  auto it = classes_.back()->FindWithHash(pair, hash);
+  if (it != classes_.back()->end()) {
+    return it->Read();
+  }
   return nullptr;
 }
 
@@ -127,7 +152,53 @@ void ClassTable::Insert(ObjPtr<mirror::Class> klass) {
 
 void ClassTable::InsertWithHash(ObjPtr<mirror::Class> klass, size_t hash) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.back().InsertWithHash(TableSlot(klass, hash), hash);
+  classes_.back()->InsertWithHash(TableSlot(klass, hash), hash);
+}
+
+void ClassTable::VisitRoots(RootVisitor* visitor, const RootInfo& info) {
+  ReaderMutexLock mu(Thread::Current(), lock_);
+  // Decode slots into a local batch so that a single virtual VisitRoots() call
+  // covers up to `kBatchSize` roots. The batch entries stay alive across the
+  // visit, unlike the temporary in TableSlot::VisitRoot(), which is why the
+  // templated VisitRoots() must not be used with a BufferedRootVisitor.
+  // Updated references are written back (with a CAS to not clobber racing
+  // updates) once the batch has been visited.
+  static constexpr size_t kBatchSize = kDefaultBufferedRootCount;
+  const TableSlot* slots[kBatchSize];
+  uint32_t before[kBatchSize];
+  GcRoot<mirror::Class> batch[kBatchSize];
+  mirror::CompressedReference<mirror::Object>* roots[kBatchSize];
+  size_t count = 0;
+  auto flush_batch = [&]() REQUIRES_SHARED(Locks::mutator_lock_) {
+    visitor->VisitRoots(roots, count, info);
+    for (size_t i = 0; i != count; ++i) {
+      slots[i]->WriteBackAfterBulkVisit(before[i], batch[i].Read<kWithoutReadBarrier>());
+    }
+    count = 0;
+  };
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (const TableSlot& table_slot : *class_set) {
+      if (count == kBatchSize) {
+        flush_batch();
+      }
+      before[count] = table_slot.CopyForBulkVisit(&batch[count]);
+      slots[count] = &table_slot;
+      roots[count] = batch[count].AddressWithoutBarrier();
+      ++count;
+    }
+  }
+  if (count != 0u) {
+    flush_batch();
+  }
+  BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(visitor, info);
+  for (GcRoot<mirror::Object>& root : strong_roots_) {
+    buffered_visitor.VisitRoot(root);
+  }
+  for (const OatFile* oat_file : oat_files_) {
+    for (GcRoot<mirror::Object>& root : oat_file->GetBssGcRoots()) {
+      buffered_visitor.VisitRootIfNonNull(root.AddressWithoutBarrier());
+    }
+  }
 }
 
 bool ClassTable::InsertStrongRoot(ObjPtr<mirror::Object> obj) {
@@ -178,7 +249,8 @@ void ClassTable::AddClassSet(ClassSet&& set) {
   // the number of searched frozen tables and not search them again.
   // TODO: Make use of this in `ClassLinker::FindClass()`.
   DCHECK(!classes_.empty());
-  classes_.insert(classes_.end() - 1, std::move(set));
+  classes_.insert(classes_.end() - 1, std::make_unique<ClassSet>(std::move(set)));
+  PublishFrozenSetsViewLocked();
 }
 
 void ClassTable::ClearStrongRoots() {
@@ -17,6 +17,8 @@
 #ifndef ART_RUNTIME_CLASS_TABLE_H_
 #define ART_RUNTIME_CLASS_TABLE_H_
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -85,6 +87,17 @@ class ClassTable {
     template<typename Visitor>
     void VisitRoot(const Visitor& visitor) const NO_THREAD_SAFETY_ANALYSIS;
 
+    // Bulk root visiting support: copy the reference into `*root`, which the
+    // caller keeps alive across a batched RootVisitor::VisitRoots() call, and
+    // return the data word the copy was made from.
+    uint32_t CopyForBulkVisit(GcRoot<mirror::Class>* root) const
+        REQUIRES_SHARED(Locks::mutator_lock_);
+
+    // Store a possibly updated reference back after a bulk visit. `before`
+    // must be the value returned by the matching CopyForBulkVisit() call.
+    void WriteBackAfterBulkVisit(uint32_t before, ObjPtr<mirror::Class> after) const
+        REQUIRES_SHARED(Locks::mutator_lock_);
+
    private:
     // Extract a raw pointer from an address.
     static ObjPtr<mirror::Class> ExtractPtr(uint32_t data)
@@ -185,6 +198,16 @@ class ClassTable {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Batched version for GC root visiting: decodes class set slots in chunks
+  // and issues a single virtual VisitRoots() per chunk instead of one per
+  // root, writing updated references back afterwards. Safe with concurrent
+  // moving collectors, unlike routing a BufferedRootVisitor through the
+  // templated versions above (see TableSlot::VisitRoot()).
+  void VisitRoots(RootVisitor* visitor, const RootInfo& info)
+      NO_THREAD_SAFETY_ANALYSIS
+      REQUIRES(!lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Stops visit if the visitor returns false.
   template <ReadBarrierOption kReadBarrierOption = kWithReadBarrier, typename Visitor>
   bool Visit(Visitor& visitor)
@@ -250,11 +273,24 @@ class ClassTable {
   }
 
  private:
+  // Immutable view of the frozen (non-back) class sets, published atomically so that
+  // `Lookup` can probe them without taking `lock_`. Frozen sets are never modified
+  // (see `FreezeSnapshot`), so concurrent probing is safe; the slots themselves are
+  // word-sized atomics, so read barrier self-healing in `TableSlot::Read` remains safe
+  // as well. Retired views are kept alive until the table is destroyed since readers
+  // may still hold a pointer to them; freezes are rare, so this is bounded.
+  struct FrozenSetsView {
+    std::vector<const ClassSet*> sets;
+  };
+
   size_t CountDefiningLoaderClasses(ObjPtr<mirror::ClassLoader> defining_loader,
                                     const ClassSet& set) const
       REQUIRES(lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Rebuild and publish the frozen sets view after `classes_` changed shape.
+  void PublishFrozenSetsViewLocked() REQUIRES(lock_);
+
   // Return true if we inserted the oat file, false if it already exists.
   bool InsertOatFileLocked(const OatFile* oat_file)
       REQUIRES(lock_)
@@ -263,7 +299,14 @@ class ClassTable {
   // Lock to guard inserting and removing.
   mutable ReaderWriterMutex lock_;
   // We have a vector to help prevent dirty pages after the zygote forks by calling FreezeSnapshot.
-  std::vector<ClassSet> classes_ GUARDED_BY(lock_);
+  // The sets are held by unique_ptr so that they have stable addresses and frozen sets can be
+  // probed through `frozen_sets_view_` without holding `lock_`.
+  std::vector<std::unique_ptr<ClassSet>> classes_ GUARDED_BY(lock_);
+  // Current lock-free view of the frozen sets, in `classes_` order. Owned by
+  // `frozen_sets_views_`.
+  std::atomic<const FrozenSetsView*> frozen_sets_view_{nullptr};
+  // All views ever published, including the current one; see `FrozenSetsView`.
+  std::vector<std::unique_ptr<const FrozenSetsView>> frozen_sets_views_ GUARDED_BY(lock_);
   // Extra strong roots that can be either dex files or dex caches. Dex files used by the class
   // loader which may not be owned by the class loader must be held strongly live. Also dex caches
   // are held live to prevent them being unloading once they have classes in them.
@@ -65,6 +65,14 @@ class CollectRootVisitor {
   mutable std::set<mirror::Object*> roots_;
 };
 
+class CollectSingleRootVisitor : public SingleRootVisitor {
+ public:
+  void VisitRoot(mirror::Object* root, const RootInfo& info ATTRIBUTE_UNUSED) override {
+    roots_.insert(root);
+  }
+
+  std::set<mirror::Object*> roots_;
+};
 
 class ClassTableTest : public CommonRuntimeTest {};
 
@@ -120,6 +128,11 @@ TEST_F(ClassTableTest, ClassTable) {
   EXPECT_TRUE(roots.roots_.find(h_Y.Get()) != roots.roots_.end());
   EXPECT_TRUE(roots.roots_.find(obj_X.Get()) != roots.roots_.end());
 
+  // The batched RootVisitor overload must report the same set of roots.
+  CollectSingleRootVisitor batched_roots;
+  table.VisitRoots(&batched_roots, RootInfo(kRootVMInternal));
+  EXPECT_EQ(batched_roots.roots_, roots.roots_);
+
   // Checks that vising only classes works.
   std::set<mirror::Class*> classes;
   table.Visit([&classes](ObjPtr<mirror::Class> klass) REQUIRES_SHARED(Locks::mutator_lock_) {
@@ -33,8 +33,9 @@
 #include "interpreter/unstarted_runtime.h"
 #include "jvalue-inl.h"
 #include "mirror/class.h"
-#include "mirror/object.h"
+#include "mirror/object-inl.h"
 #include "obj_ptr-inl.h"
+#include "offsets.h"
 #include "reflective_handle.h"
 #include "reflective_handle_scope.h"
 #include "runtime.h"
@@ -89,6 +90,113 @@ inline void DCheckStaticState(Thread* self, T* entity) REQUIRES_SHARED(Locks::mu
   }
 }
 
+// Compile-time specialized field load for interpreter fast paths. Both the
+// primitive type and the volatility are template parameters, so the access
+// below compiles down to a single load instead of re-testing
+// ArtField::IsVolatile() on every executed iget/sget. Callers dispatch once
+// per resolved field; the object and offset must come from that field.
+template<Primitive::Type field_type, bool kIsVolatile>
+ALWAYS_INLINE void DoFieldGetAtOffset(ObjPtr<mirror::Object> obj,
+                                      MemberOffset offset,
+                                      JValue* result)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  switch (field_type) {
+    case Primitive::kPrimBoolean:
+      result->SetZ(kIsVolatile ? obj->GetFieldBooleanVolatile(offset)
+                               : obj->GetFieldBoolean(offset));
+      break;
+    case Primitive::kPrimByte:
+      result->SetB(kIsVolatile ? obj->GetFieldByteVolatile(offset)
+                               : obj->GetFieldByte(offset));
+      break;
+    case Primitive::kPrimChar:
+      result->SetC(kIsVolatile ? obj->GetFieldCharVolatile(offset)
+                               : obj->GetFieldChar(offset));
+      break;
+    case Primitive::kPrimShort:
+      result->SetS(kIsVolatile ? obj->GetFieldShortVolatile(offset)
+                               : obj->GetFieldShort(offset));
+      break;
+    case Primitive::kPrimInt:
+      result->SetI(kIsVolatile ? obj->GetField32Volatile(offset) : obj->GetField32(offset));
+      break;
+    case Primitive::kPrimLong:
+      result->SetJ(kIsVolatile ? obj->GetField64Volatile(offset) : obj->GetField64(offset));
+      break;
+    case Primitive::kPrimNot:
+      result->SetL(kIsVolatile ? obj->GetFieldObjectVolatile<mirror::Object>(offset)
+                               : obj->GetFieldObject<mirror::Object>(offset));
+      break;
+    case Primitive::kPrimVoid:
+      LOG(FATAL) << "Unreachable " << field_type;
+      break;
+  }
+}
+
+// Compile-time specialized counterpart of DoFieldGetAtOffset() for iput/sput.
+// Reference stores go through the specialization directly only when no
+// assignability check is needed; DoFieldPutCommon() below handles that case.
+template<Primitive::Type field_type, bool kIsVolatile, bool kTransactionActive>
+ALWAYS_INLINE void DoFieldPutAtOffset(ObjPtr<mirror::Object> obj,
+                                      MemberOffset offset,
+                                      const JValue& value)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  switch (field_type) {
+    case Primitive::kPrimBoolean:
+      if (kIsVolatile) {
+        obj->SetFieldBooleanVolatile<kTransactionActive>(offset, value.GetZ());
+      } else {
+        obj->SetFieldBoolean<kTransactionActive>(offset, value.GetZ());
+      }
+      break;
+    case Primitive::kPrimByte:
+      if (kIsVolatile) {
+        obj->SetFieldByteVolatile<kTransactionActive>(offset, value.GetB());
+      } else {
+        obj->SetFieldByte<kTransactionActive>(offset, value.GetB());
+      }
+      break;
+    case Primitive::kPrimChar:
+      if (kIsVolatile) {
+        obj->SetFieldCharVolatile<kTransactionActive>(offset, value.GetC());
+      } else {
+        obj->SetFieldChar<kTransactionActive>(offset, value.GetC());
+      }
+      break;
+    case Primitive::kPrimShort:
+      if (kIsVolatile) {
+        obj->SetFieldShortVolatile<kTransactionActive>(offset, value.GetS());
+      } else {
+        obj->SetFieldShort<kTransactionActive>(offset, value.GetS());
+      }
+      break;
+    case Primitive::kPrimInt:
+      if (kIsVolatile) {
+        obj->SetField32Volatile<kTransactionActive>(offset, value.GetI());
+      } else {
+        obj->SetField32<kTransactionActive>(offset, value.GetI());
+      }
+      break;
+    case Primitive::kPrimLong:
+      if (kIsVolatile) {
+        obj->SetField64Volatile<kTransactionActive>(offset, value.GetJ());
+      } else {
+        obj->SetField64<kTransactionActive>(offset, value.GetJ());
+      }
+      break;
+    case Primitive::kPrimNot:
+      if (kIsVolatile) {
+        obj->SetFieldObjectVolatile<kTransactionActive>(offset, value.GetL());
+      } else {
+        obj->SetFieldObject<kTransactionActive>(offset, value.GetL());
+      }
+      break;
+    case Primitive::kPrimVoid:
+      LOG(FATAL) << "Unreachable " << field_type;
+      break;
+  }
+}
+
 template<Primitive::Type field_type>
 static ALWAYS_INLINE bool DoFieldGetCommon(Thread* self,
                                            const ShadowFrame& shadow_frame,
@@ -120,31 +228,12 @@ static ALWAYS_INLINE bool DoFieldGetCommon(Thread* self,
     }
   }
 
-  switch (field_type) {
-    case Primitive::kPrimBoolean:
-      result->SetZ(field->GetBoolean(obj));
-      break;
-    case Primitive::kPrimByte:
-      result->SetB(field->GetByte(obj));
-      break;
-    case Primitive::kPrimChar:
-      result->SetC(field->GetChar(obj));
-      break;
-    case Primitive::kPrimShort:
-      result->SetS(field->GetShort(obj));
-      break;
-    case Primitive::kPrimInt:
-      result->SetI(field->GetInt(obj));
-      break;
-    case Primitive::kPrimLong:
-      result->SetJ(field->GetLong(obj));
-      break;
-    case Primitive::kPrimNot:
-      result->SetL(field->GetObject(obj));
-      break;
-    case Primitive::kPrimVoid:
-      LOG(FATAL) << "Unreachable " << field_type;
-      break;
+  // Dispatch once on volatility so the load itself is fully specialized.
+  const MemberOffset offset = field->GetOffset();
+  if (UNLIKELY(field->IsVolatile())) {
+    DoFieldGetAtOffset<field_type, /*kIsVolatile=*/ true>(obj, offset, result);
+  } else {
+    DoFieldGetAtOffset<field_type, /*kIsVolatile=*/ false>(obj, offset, result);
   }
   return true;
 }
@@ -189,61 +278,47 @@ ALWAYS_INLINE bool DoFieldPutCommon(Thread* self,
     }
   }
 
-  switch (field_type) {
-    case Primitive::kPrimBoolean:
-      field->SetBoolean<transaction_active>(obj, value.GetZ());
-      break;
-    case Primitive::kPrimByte:
-      field->SetByte<transaction_active>(obj, value.GetB());
-      break;
-    case Primitive::kPrimChar:
-      field->SetChar<transaction_active>(obj, value.GetC());
-      break;
-    case Primitive::kPrimShort:
-      field->SetShort<transaction_active>(obj, value.GetS());
-      break;
-    case Primitive::kPrimInt:
-      field->SetInt<transaction_active>(obj, value.GetI());
-      break;
-    case Primitive::kPrimLong:
-      field->SetLong<transaction_active>(obj, value.GetJ());
-      break;
-    case Primitive::kPrimNot: {
-      ObjPtr<mirror::Object> reg = value.GetL();
-      if (do_assignability_check && reg != nullptr) {
-        // FieldHelper::GetType can resolve classes, use a handle wrapper which will restore the
-        // object in the destructor.
-        ObjPtr<mirror::Class> field_class;
-        {
-          StackHandleScope<2> hs(self);
-          StackArtFieldHandleScope<1> rhs(self);
-          HandleWrapperObjPtr<mirror::Object> h_reg(hs.NewHandleWrapper(&reg));
-          HandleWrapperObjPtr<mirror::Object> h_obj(hs.NewHandleWrapper(&obj));
-          ReflectiveHandleWrapper<ArtField> fh(rhs.NewReflectiveHandleWrapper(&field));
-          field_class = field->ResolveType();
-        }
-        // ArtField::ResolveType() may fail as evidenced with a dexing bug (b/78788577).
-        if (UNLIKELY(field_class.IsNull())) {
-          Thread::Current()->AssertPendingException();
-          return false;
-        }
-        if (UNLIKELY(!reg->VerifierInstanceOf(field_class))) {
-          // This should never happen.
-          std::string temp1, temp2, temp3;
-          self->ThrowNewExceptionF("Ljava/lang/InternalError;",
-                                   "Put '%s' that is not instance of field '%s' in '%s'",
-                                   reg->GetClass()->GetDescriptor(&temp1),
-                                   field_class->GetDescriptor(&temp2),
-                                   field->GetDeclaringClass()->GetDescriptor(&temp3));
-          return false;
-        }
+  if (field_type == Primitive::kPrimNot) {
+    ObjPtr<mirror::Object> reg = value.GetL();
+    if (do_assignability_check && reg != nullptr) {
+      // FieldHelper::GetType can resolve classes, use a handle wrapper which will restore the
+      // object in the destructor.
+      ObjPtr<mirror::Class> field_class;
+      {
+        StackHandleScope<2> hs(self);
+        StackArtFieldHandleScope<1> rhs(self);
+        HandleWrapperObjPtr<mirror::Object> h_reg(hs.NewHandleWrapper(&reg));
+        HandleWrapperObjPtr<mirror::Object> h_obj(hs.NewHandleWrapper(&obj));
+        ReflectiveHandleWrapper<ArtField> fh(rhs.NewReflectiveHandleWrapper(&field));
+        field_class = field->ResolveType();
+      }
+      // ArtField::ResolveType() may fail as evidenced with a dexing bug (b/78788577).
+      if (UNLIKELY(field_class.IsNull())) {
+        Thread::Current()->AssertPendingException();
+        return false;
+      }
+      if (UNLIKELY(!reg->VerifierInstanceOf(field_class))) {
+        // This should never happen.
+        std::string temp1, temp2, temp3;
+        self->ThrowNewExceptionF("Ljava/lang/InternalError;",
+                                 "Put '%s' that is not instance of field '%s' in '%s'",
+                                 reg->GetClass()->GetDescriptor(&temp1),
+                                 field_class->GetDescriptor(&temp2),
+                                 field->GetDeclaringClass()->GetDescriptor(&temp3));
+        return false;
       }
-      field->SetObj<transaction_active>(obj, reg);
-      break;
     }
-    case Primitive::kPrimVoid: {
-      LOG(FATAL) << "Unreachable " << field_type;
-      break;
+    // Store `reg` rather than re-reading `value`: the assignability check above
+    // may have suspended and only `reg` was updated by the handle wrapper.
+    field->SetObj<transaction_active>(obj, reg);
+  } else {
+    // Dispatch once on volatility so the store itself is fully specialized.
+    const MemberOffset offset = field->GetOffset();
+    if (UNLIKELY(field->IsVolatile())) {
+      DoFieldPutAtOffset<field_type, /*kIsVolatile=*/ true, transaction_active>(obj, offset, value);
+    } else {
+      DoFieldPutAtOffset<field_type, /*kIsVolatile=*/ false, transaction_active>(
+          obj, offset, value);
     }
   }
   if (transaction_active) {
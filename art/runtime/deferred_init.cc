@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "deferred_init.h"
+
+#include "base/logging.h"
+#include "runtime.h"
+#include "thread-current-inl.h"
+
+namespace art {
+
+DeferredInitRegistry::DeferredInitRegistry()
+    : lock_("deferred init registry lock"),
+      cond_("deferred init registry condition variable", lock_) {}
+
+DeferredInitRegistry::Subsystem* DeferredInitRegistry::Find(const std::string& name) {
+  for (const std::unique_ptr<Subsystem>& subsystem : subsystems_) {
+    if (subsystem->name == name) {
+      return subsystem.get();
+    }
+  }
+  return nullptr;
+}
+
+void DeferredInitRegistry::Register(const char* name,
+                                    Phase latest_phase,
+                                    std::vector<std::string>&& dependencies,
+                                    InitThunk thunk) {
+  MutexLock mu(Thread::Current(), lock_);
+  DCHECK(Find(name) == nullptr) << "Duplicate deferred init registration: " << name;
+  subsystems_.push_back(std::unique_ptr<Subsystem>(new Subsystem{name,
+                                                                 latest_phase,
+                                                                 std::move(dependencies),
+                                                                 std::move(thunk),
+                                                                 State::kPending,
+                                                                 /*collecting=*/ false}));
+}
+
+void DeferredInitRegistry::CollectPending(Subsystem* subsystem,
+                                          std::vector<CollectedEntry>* order) {
+  if (subsystem->state == State::kDone) {
+    return;
+  }
+  if (subsystem->state == State::kRunning) {
+    // Claimed by another thread (or by an earlier root of this collection);
+    // the caller only needs to wait for it.
+    order->push_back(CollectedEntry{subsystem, /*owned=*/ false});
+    return;
+  }
+  CHECK(!subsystem->collecting)
+      << "Cycle in deferred init dependencies involving " << subsystem->name;
+  subsystem->collecting = true;
+  for (const std::string& dependency : subsystem->dependencies) {
+    Subsystem* dep = Find(dependency);
+    CHECK(dep != nullptr) << "Unregistered deferred init dependency " << dependency
+                          << " of " << subsystem->name;
+    CollectPending(dep, order);
+  }
+  subsystem->collecting = false;
+  subsystem->state = State::kRunning;
+  order->push_back(CollectedEntry{subsystem, /*owned=*/ true});
+}
+
+void DeferredInitRegistry::RunCollected(const std::vector<CollectedEntry>& order) {
+  Thread* const self = Thread::Current();
+  Runtime* const runtime = Runtime::Current();
+  for (const CollectedEntry& entry : order) {
+    if (entry.owned) {
+      // `thunk` and `name` are immutable after registration, so they are safe
+      // to use without the lock; only `state` needs it.
+      VLOG(startup) << "Deferred init of " << entry.subsystem->name;
+      entry.subsystem->thunk(runtime);
+      MutexLock mu(self, lock_);
+      entry.subsystem->state = State::kDone;
+      cond_.Broadcast(self);
+    } else {
+      MutexLock mu(self, lock_);
+      while (entry.subsystem->state != State::kDone) {
+        cond_.Wait(self);
+      }
+    }
+  }
+}
+
+void DeferredInitRegistry::EnsureInitialized(const char* name) {
+  std::vector<CollectedEntry> order;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    Subsystem* subsystem = Find(name);
+    if (subsystem == nullptr) {
+      return;
+    }
+    CollectPending(subsystem, &order);
+  }
+  RunCollected(order);
+}
+
+void DeferredInitRegistry::RunUpToPhase(Phase phase) {
+  std::vector<CollectedEntry> order;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    // Iterate by index: a thunk registered by another thread during collection
+    // must not invalidate our references, and `subsystems_` only grows.
+    for (size_t i = 0; i != subsystems_.size(); ++i) {
+      Subsystem* subsystem = subsystems_[i].get();
+      if (static_cast<uint32_t>(subsystem->phase) <= static_cast<uint32_t>(phase)) {
+        CollectPending(subsystem, &order);
+      }
+    }
+  }
+  RunCollected(order);
+}
+
+bool DeferredInitRegistry::IsInitialized(const char* name) {
+  MutexLock mu(Thread::Current(), lock_);
+  Subsystem* subsystem = Find(name);
+  return subsystem != nullptr && subsystem->state == State::kDone;
+}
+
+}  // namespace art
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_DEFERRED_INIT_H_
+#define ART_RUNTIME_DEFERRED_INIT_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+
+class Runtime;
+
+// Registry for deferring the initialization of non-critical runtime
+// subsystems out of Runtime::Init(). Instead of running a subsystem's setup
+// inline during startup, Runtime::Init() registers a thunk for it together
+// with the latest phase by which it must have run. The thunk executes either
+// on the subsystem's first use, via EnsureInitialized(), or in bulk when the
+// runtime crosses the registered phase boundary, via RunUpToPhase() -
+// whichever comes first. Dependencies between subsystems form an explicit
+// DAG: a thunk lists the subsystems it depends on and those are initialized
+// first; a dependency cycle is a registration bug and aborts.
+//
+// All thunks run without the registry lock held, so a thunk may itself call
+// EnsureInitialized() for a subsystem it discovers it needs. Concurrent
+// callers requesting a subsystem that is being initialized block until the
+// running thunk completes.
+class DeferredInitRegistry {
+ public:
+  // Phase boundaries, in the order the runtime crosses them. A subsystem
+  // registered for a phase is initialized at that boundary at the latest.
+  enum class Phase : uint32_t {
+    kRuntimeInitDone = 0,  // End of Runtime::Init().
+    kPostZygoteFork,       // Runtime::InitNonZygoteOrPostFork().
+    kStartupCompleted,     // Runtime::NotifyStartupCompleted().
+  };
+
+  using InitThunk = std::function<void(Runtime*)>;
+
+  DeferredInitRegistry();
+
+  // Registers `thunk` for `name`, to run by `latest_phase` at the latest.
+  // `dependencies` names subsystems that must be initialized before `thunk`
+  // runs; they may be registered later, but must be registered by the time
+  // `thunk` runs. Must not be called for an already registered `name`.
+  void Register(const char* name,
+                Phase latest_phase,
+                std::vector<std::string>&& dependencies,
+                InitThunk thunk)
+      REQUIRES(!lock_);
+
+  // Runs the thunk for `name` (and, first, any uninitialized dependencies)
+  // if it has not run yet; blocks if another thread is running it. No-op for
+  // an unregistered `name`, so call sites may unconditionally mark uses of
+  // subsystems that are only deferred in some configurations.
+  void EnsureInitialized(const char* name) REQUIRES(!lock_);
+
+  // Initializes every registered subsystem whose phase is at or before
+  // `phase`. Called by the runtime when it crosses a phase boundary.
+  void RunUpToPhase(Phase phase) REQUIRES(!lock_);
+
+  bool IsInitialized(const char* name) REQUIRES(!lock_);
+
+ private:
+  enum class State : uint8_t {
+    kPending,
+    kRunning,
+    kDone,
+  };
+
+  struct Subsystem {
+    std::string name;
+    Phase phase;
+    std::vector<std::string> dependencies;
+    InitThunk thunk;
+    State state;
+    // Set while the subsystem is on the current collection's DFS path, to
+    // turn a dependency cycle into a hard registration error.
+    bool collecting;
+  };
+
+  // An entry the caller has to process: either a thunk this thread claimed
+  // (`owned`) and must run, or a subsystem another thread is already
+  // initializing, which must merely be waited for.
+  struct CollectedEntry {
+    Subsystem* subsystem;
+    bool owned;
+  };
+
+  Subsystem* Find(const std::string& name) REQUIRES(lock_);
+
+  // Appends `subsystem` and its uninitialized dependencies to `order` in
+  // dependency-first order, marking claimed entries kRunning so the caller
+  // can invoke the thunks without holding the lock.
+  void CollectPending(Subsystem* subsystem, std::vector<CollectedEntry>* order)
+      REQUIRES(lock_);
+
+  // Processes the collected entries in order: runs claimed thunks and blocks
+  // on entries another thread was already initializing.
+  void RunCollected(const std::vector<CollectedEntry>& order) REQUIRES(!lock_);
+
+  Mutex lock_;
+  ConditionVariable cond_ GUARDED_BY(lock_);
+  // Registration order; iterated for phase boundaries. Elements are stable
+  // because they are heap-allocated.
+  std::vector<std::unique_ptr<Subsystem>> subsystems_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(DeferredInitRegistry);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_DEFERRED_INIT_H_
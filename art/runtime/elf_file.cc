@@ -21,6 +21,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "android-base/stringprintf.h"
 #include "android-base/strings.h"
 
@@ -845,7 +847,9 @@ typename ElfTypes::Sym* ElfFileImpl<ElfTypes>::FindSymbolByName(
   if (*symbol_table != nullptr || build_map) {
     if (*symbol_table == nullptr) {
       DCHECK(build_map);
-      *symbol_table = new SymbolTable;
+      // Build the flat index locally and publish it only on success, so a
+      // failed build is retried instead of serving a partial table.
+      std::unique_ptr<SymbolTable> table(new SymbolTable);
       Elf_Shdr* symbol_section = FindSectionByType(section_type);
       if (symbol_section == nullptr) {
         return nullptr;  // Failure condition.
@@ -854,6 +858,7 @@ typename ElfTypes::Sym* ElfFileImpl<ElfTypes>::FindSymbolByName(
       if (string_section == nullptr) {
         return nullptr;  // Failure condition.
       }
+      table->reserve(GetSymbolNum(*symbol_section));
       for (uint32_t i = 0; i < GetSymbolNum(*symbol_section); i++) {
         Elf_Sym* symbol = GetSymbol(section_type, i);
         if (symbol == nullptr) {
@@ -869,26 +874,40 @@ typename ElfTypes::Sym* ElfFileImpl<ElfTypes>::FindSymbolByName(
         if (name == nullptr) {
           continue;
         }
-        std::pair<typename SymbolTable::iterator, bool> result =
-            (*symbol_table)->insert(std::make_pair(name, symbol));
-        if (!result.second) {
+        table->push_back(SymbolIndexEntry{std::string_view(name), symbol});
+      }
+      std::sort(table->begin(),
+                table->end(),
+                [](const SymbolIndexEntry& lhs, const SymbolIndexEntry& rhs) {
+                  return lhs.name < rhs.name;
+                });
+      for (size_t i = 1; i < table->size(); ++i) {
+        const SymbolIndexEntry& prev = (*table)[i - 1];
+        const SymbolIndexEntry& current = (*table)[i];
+        if (prev.name == current.name) {
           // If a duplicate, make sure it has the same logical value. Seen on x86.
-          if ((symbol->st_value != result.first->second->st_value) ||
-              (symbol->st_size != result.first->second->st_size) ||
-              (symbol->st_info != result.first->second->st_info) ||
-              (symbol->st_other != result.first->second->st_other) ||
-              (symbol->st_shndx != result.first->second->st_shndx)) {
+          if ((current.symbol->st_value != prev.symbol->st_value) ||
+              (current.symbol->st_size != prev.symbol->st_size) ||
+              (current.symbol->st_info != prev.symbol->st_info) ||
+              (current.symbol->st_other != prev.symbol->st_other) ||
+              (current.symbol->st_shndx != prev.symbol->st_shndx)) {
             return nullptr;  // Failure condition.
           }
         }
       }
+      *symbol_table = table.release();
     }
     CHECK(*symbol_table != nullptr);
-    typename SymbolTable::const_iterator it = (*symbol_table)->find(symbol_name);
-    if (it == (*symbol_table)->end()) {
+    auto it = std::lower_bound((*symbol_table)->begin(),
+                               (*symbol_table)->end(),
+                               symbol_name,
+                               [](const SymbolIndexEntry& entry, const std::string& name) {
+                                 return entry.name < name;
+                               });
+    if (it == (*symbol_table)->end() || it->name != symbol_name) {
       return nullptr;
     }
-    return it->second;
+    return it->symbol;
   }
 
   // Fall back to linear search
@@ -19,6 +19,7 @@
 
 #include <map>
 #include <memory>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
@@ -150,7 +151,15 @@ class ElfFileImpl {
   Elf_Word GetHashBucket(size_t i, bool* ok) const;
   Elf_Word GetHashChain(size_t i, bool* ok) const;
 
-  using SymbolTable = std::map<std::string, Elf_Sym*>;
+  // Flat symbol index sorted by name, built once per symbol section on the
+  // first map-building lookup and binary searched afterwards. The names point
+  // into the mapped string table, so building the index performs no per-entry
+  // allocation.
+  struct SymbolIndexEntry {
+    std::string_view name;
+    Elf_Sym* symbol;
+  };
+  using SymbolTable = std::vector<SymbolIndexEntry>;
   SymbolTable** GetSymbolTable(Elf_Word section_type);
 
   bool ValidPointer(const uint8_t* start) const;
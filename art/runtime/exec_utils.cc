@@ -16,11 +16,17 @@
 
 #include "exec_utils.h"
 
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "android-base/file.h"
 #include "android-base/stringprintf.h"
 #include "android-base/strings.h"
 
@@ -73,9 +79,267 @@ pid_t ExecWithoutWait(std::vector<std::string>& arg_vector) {
   }
 }
 
+// ---- Pre-forked exec helper pool ----
+//
+// Each helper is a small single-threaded child connected to the parent by a
+// SOCK_STREAM socketpair. The parent writes one job (argv and optional envp),
+// the helper forks and execs it, reports the grandchild's pid right away and
+// its wait status once it exits. The per-job fork thus duplicates the helper's
+// tiny address space instead of the caller's, which is what makes repeated
+// tool invocations from a large process cheap. A helper runs one job at a
+// time; concurrency comes from the pool.
+
+// Envp count value meaning "no environment snapshot, use execv()".
+constexpr uint32_t kExecHelperNoEnv = 0xffffffffu;
+
+bool SendHelperString(int fd, const char* s) {
+  uint32_t length = strlen(s);
+  return android::base::WriteFully(fd, &length, sizeof(length)) &&
+         android::base::WriteFully(fd, s, length);
+}
+
+bool ReceiveHelperString(int fd, /*out*/ std::string* s) {
+  uint32_t length;
+  if (!android::base::ReadFully(fd, &length, sizeof(length))) {
+    return false;
+  }
+  s->resize(length);
+  return length == 0u || android::base::ReadFully(fd, &(*s)[0], length);
+}
+
+// Runs in the helper child; never returns. Exits cleanly when the parent
+// closes its end of the socket.
+void ExecHelperLoop(int sock) {
+  for (;;) {
+    uint32_t argc;
+    if (!android::base::ReadFully(sock, &argc, sizeof(argc))) {
+      _exit(0);
+    }
+    std::vector<std::string> args(argc);
+    for (uint32_t i = 0; i != argc; ++i) {
+      if (!ReceiveHelperString(sock, &args[i])) {
+        _exit(1);
+      }
+    }
+    uint32_t envc;
+    if (!android::base::ReadFully(sock, &envc, sizeof(envc))) {
+      _exit(1);
+    }
+    bool have_env = (envc != kExecHelperNoEnv);
+    std::vector<std::string> env(have_env ? envc : 0u);
+    for (std::string& entry : env) {
+      if (!ReceiveHelperString(sock, &entry)) {
+        _exit(1);
+      }
+    }
+    std::vector<char*> argv;
+    for (const std::string& arg : args) {
+      argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    std::vector<char*> envp;
+    for (const std::string& entry : env) {
+      envp.push_back(const_cast<char*>(entry.c_str()));
+    }
+    envp.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+      // No allocation allowed between fork and exec. Mirror ExecWithoutWait():
+      // change process groups, so we don't get reaped by ProcessManager.
+      close(sock);
+      setpgid(0, 0);
+      if (have_env) {
+        execve(argv[0], argv.data(), envp.data());
+      } else {
+        execv(argv[0], argv.data());
+      }
+      PLOG(ERROR) << "Failed to execve(" << ToCommandLine(args) << ")";
+      _exit(1);
+    }
+    int32_t pid_msg = pid;
+    if (!android::base::WriteFully(sock, &pid_msg, sizeof(pid_msg))) {
+      _exit(1);
+    }
+    int status = -1;
+    if (pid > 0) {
+      TEMP_FAILURE_RETRY(waitpid(pid, &status, 0));
+    }
+    if (!android::base::WriteFully(sock, &status, sizeof(status))) {
+      _exit(1);
+    }
+  }
+}
+
+struct ExecHelper {
+  pid_t pid;
+  int sock;
+  bool busy;
+};
+
+std::mutex gExecHelperLock;
+// Fixed after StartExecHelperPool(): never reallocated while helpers can be
+// acquired, so acquired pointers stay valid without holding the lock.
+std::vector<ExecHelper> gExecHelpers;
+
+ExecHelper* AcquireExecHelper() {
+  std::lock_guard<std::mutex> lock(gExecHelperLock);
+  for (ExecHelper& helper : gExecHelpers) {
+    if (!helper.busy && helper.sock != -1) {
+      helper.busy = true;
+      return &helper;
+    }
+  }
+  return nullptr;
+}
+
+void ReleaseExecHelper(ExecHelper* helper) {
+  std::lock_guard<std::mutex> lock(gExecHelperLock);
+  helper->busy = false;
+}
+
+// Takes a helper whose protocol stream is no longer in sync out of service.
+void MarkExecHelperBroken(ExecHelper* helper) {
+  std::lock_guard<std::mutex> lock(gExecHelperLock);
+  kill(helper->pid, SIGKILL);
+  TEMP_FAILURE_RETRY(waitpid(helper->pid, nullptr, 0));
+  close(helper->sock);
+  helper->sock = -1;
+}
+
+// Dispatches one job to `helper`. `timeout_secs` <= 0 means no timeout.
+int RunWithExecHelper(ExecHelper* helper,
+                      std::vector<std::string>& arg_vector,
+                      time_t timeout_secs,
+                      /*out*/ bool* timed_out,
+                      /*out*/ std::string* error_msg) {
+  int sock = helper->sock;
+  uint32_t argc = arg_vector.size();
+  bool ok = android::base::WriteFully(sock, &argc, sizeof(argc));
+  for (const std::string& arg : arg_vector) {
+    ok = ok && SendHelperString(sock, arg.c_str());
+  }
+  char** envp = (Runtime::Current() == nullptr) ? nullptr : Runtime::Current()->GetEnvSnapshot();
+  if (envp == nullptr) {
+    uint32_t no_env = kExecHelperNoEnv;
+    ok = ok && android::base::WriteFully(sock, &no_env, sizeof(no_env));
+  } else {
+    uint32_t envc = 0u;
+    for (char** entry = envp; *entry != nullptr; ++entry) {
+      ++envc;
+    }
+    ok = ok && android::base::WriteFully(sock, &envc, sizeof(envc));
+    for (char** entry = envp; ok && *entry != nullptr; ++entry) {
+      ok = SendHelperString(sock, *entry);
+    }
+  }
+  int32_t child_pid = -1;
+  ok = ok && android::base::ReadFully(sock, &child_pid, sizeof(child_pid));
+  if (!ok) {
+    *error_msg = StringPrintf("Lost contact with exec helper for execv(%s): %s",
+                              ToCommandLine(arg_vector).c_str(), strerror(errno));
+    MarkExecHelperBroken(helper);
+    return -1;
+  }
+
+  bool job_timed_out = false;
+  if (timeout_secs > 0) {
+    pollfd poll_fd = {sock, POLLIN, 0};
+    int poll_result = TEMP_FAILURE_RETRY(poll(&poll_fd, 1, timeout_secs * 1000));
+    if (poll_result == 0) {
+      job_timed_out = true;
+      *error_msg = "Timed out.";
+      if (child_pid > 0 && kill(child_pid, SIGKILL) != 0) {
+        PLOG(ERROR) << "Failed to kill() subprocess: ";
+      }
+      // Fall through and collect the status the helper reports after the kill.
+    } else if (poll_result < 0) {
+      *error_msg = StringPrintf("Failed to poll() exec helper: %s", strerror(errno));
+      MarkExecHelperBroken(helper);
+      return -1;
+    }
+  }
+  if (timed_out != nullptr) {
+    *timed_out = job_timed_out;
+  }
+
+  int status = -1;
+  if (!android::base::ReadFully(sock, &status, sizeof(status))) {
+    *error_msg = StringPrintf("Lost contact with exec helper for execv(%s): %s",
+                              ToCommandLine(arg_vector).c_str(), strerror(errno));
+    MarkExecHelperBroken(helper);
+    return -1;
+  }
+  if (job_timed_out) {
+    return -1;
+  }
+  if (child_pid < 0) {
+    *error_msg = StringPrintf("Failed to execv(%s) because fork failed in exec helper",
+                              ToCommandLine(arg_vector).c_str());
+    return -1;
+  }
+  if (WIFEXITED(status)) {
+    return WEXITSTATUS(status);
+  }
+  return -1;
+}
+
 }  // namespace
 
+bool StartExecHelperPool(size_t num_helpers) {
+  std::lock_guard<std::mutex> lock(gExecHelperLock);
+  if (!gExecHelpers.empty()) {
+    return true;
+  }
+  gExecHelpers.reserve(num_helpers);
+  for (size_t i = 0; i != num_helpers; ++i) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+      PLOG(ERROR) << "Failed to create socketpair for exec helper";
+      break;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+      // Drop the parent ends of the previously created helpers so that closing
+      // them in the parent actually delivers EOF.
+      for (const ExecHelper& other : gExecHelpers) {
+        close(other.sock);
+      }
+      close(fds[0]);
+      ExecHelperLoop(fds[1]);  // Never returns.
+    }
+    close(fds[1]);
+    if (pid < 0) {
+      PLOG(ERROR) << "Failed to fork exec helper";
+      close(fds[0]);
+      break;
+    }
+    gExecHelpers.push_back(ExecHelper{pid, fds[0], /*busy=*/ false});
+  }
+  return !gExecHelpers.empty();
+}
+
+void StopExecHelperPool() {
+  std::lock_guard<std::mutex> lock(gExecHelperLock);
+  for (ExecHelper& helper : gExecHelpers) {
+    DCHECK(!helper.busy);
+    if (helper.sock != -1) {
+      close(helper.sock);
+      TEMP_FAILURE_RETRY(waitpid(helper.pid, nullptr, 0));
+    }
+  }
+  gExecHelpers.clear();
+}
+
 int ExecAndReturnCode(std::vector<std::string>& arg_vector, std::string* error_msg) {
+  ExecHelper* helper = AcquireExecHelper();
+  if (helper != nullptr) {
+    int result = RunWithExecHelper(
+        helper, arg_vector, /*timeout_secs=*/ 0, /*timed_out=*/ nullptr, error_msg);
+    ReleaseExecHelper(helper);
+    return result;
+  }
+
   pid_t pid = ExecWithoutWait(arg_vector);
   if (pid == -1) {
     *error_msg = StringPrintf("Failed to execv(%s) because fork failed: %s",
@@ -104,6 +368,13 @@ int ExecAndReturnCode(std::vector<std::string>& arg_vector,
                       std::string* error_msg) {
   *timed_out = false;
 
+  ExecHelper* helper = AcquireExecHelper();
+  if (helper != nullptr) {
+    int result = RunWithExecHelper(helper, arg_vector, timeout_secs, timed_out, error_msg);
+    ReleaseExecHelper(helper);
+    return result;
+  }
+
   // Start subprocess.
   pid_t pid = ExecWithoutWait(arg_vector);
   if (pid == -1) {
@@ -39,6 +39,23 @@ int ExecAndReturnCode(std::vector<std::string>& arg_vector,
                       /*out*/ bool* timed_out,
                       /*out*/ std::string* error_msg);
 
+// Pre-forks a pool of small helper processes that perform fork+exec on behalf
+// of the caller and report the child's pid and exit status back over a
+// socketpair. Once the pool is running, the functions above dispatch each job
+// to an idle helper, so the per-job fork duplicates a tiny single-threaded
+// address space instead of the caller's. This matters for processes that
+// invoke tools like dex2oat hundreds of times per maintenance window from a
+// large runtime. When every helper is busy, jobs fall back to a direct
+// fork+exec. Call this early, while the process is still small; returns false
+// if no helper could be started. The helpers inherit the environment the pool
+// was started with.
+bool StartExecHelperPool(size_t num_helpers);
+
+// Shuts the helper pool down and reaps the helper processes. Must not be
+// called while jobs are in flight. Subsequent invocations use plain fork+exec
+// again.
+void StopExecHelperPool();
+
 // A wrapper class to make the functions above mockable.
 class ExecUtils {
  public:
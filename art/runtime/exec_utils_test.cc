@@ -56,6 +56,21 @@ TEST_F(ExecUtilsTest, ExecError) {
   EXPECT_FALSE(error_msg.empty());
 }
 
+TEST_F(ExecUtilsTest, ExecSuccessWithHelperPool) {
+  ASSERT_TRUE(StartExecHelperPool(2u));
+  std::vector<std::string> command;
+  if (kIsTargetBuild) {
+    std::string android_root(GetAndroidRoot());
+    command.push_back(android_root + "/bin/id");
+  } else {
+    command.push_back("/usr/bin/id");
+  }
+  std::string error_msg;
+  EXPECT_TRUE(Exec(command, &error_msg));
+  EXPECT_EQ(0U, error_msg.size()) << error_msg;
+  StopExecHelperPool();
+}
+
 TEST_F(ExecUtilsTest, EnvSnapshotAdditionsAreNotVisible) {
   static constexpr const char* kModifiedVariable = "EXEC_SHOULD_NOT_EXPORT_THIS";
   static constexpr int kOverwrite = 1;
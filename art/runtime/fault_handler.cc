@@ -30,6 +30,7 @@
 #include "mirror/class.h"
 #include "mirror/object_reference.h"
 #include "oat_file.h"
+#include "oat_page_tracer.h"
 #include "oat_quick_method_header.h"
 #include "sigchain.h"
 #include "thread-current-inl.h"
@@ -221,6 +222,17 @@ bool FaultManager::HandleFault(int sig, siginfo_t* info, void* context) {
   raise(SIGSEGV);
 #endif
 
+  // Give the oat page tracer first chance at the fault. A traced PROT_NONE
+  // oat page must have its protection restored before anything below runs:
+  // IsInGeneratedCode and the handlers dereference oat-backed metadata and
+  // would themselves fault on a traced page. (Such a nested fault re-enters
+  // this function - SIGSEGV is not blocked here - and is healed by the same
+  // check, after which the outer handler resumes.)
+  if (sig == SIGSEGV &&
+      OatPageTracer::HandleTracedPageFault(reinterpret_cast<uintptr_t>(info->si_addr))) {
+    return true;
+  }
+
   if (IsInGeneratedCode(info, context, true)) {
     VLOG(signals) << "in generated code, looking for handler";
     for (const auto& handler : generated_code_handlers_) {
@@ -36,6 +36,7 @@ inline mirror::Object* BumpPointerSpace::Alloc(Thread*, size_t num_bytes, size_t
       *usable_size = num_bytes;
     }
     *bytes_tl_bulk_allocated = num_bytes;
+    GetTelemetry().RecordAllocation(num_bytes);
   }
   return ret;
 }
@@ -210,14 +210,28 @@ void BumpPointerSpace::RevokeThreadLocalBuffersLocked(Thread* thread) {
 }
 
 bool BumpPointerSpace::AllocNewTlab(Thread* self, size_t bytes) {
+  return AllocNewTlabBulk(self, bytes, bytes) != 0u;
+}
+
+size_t BumpPointerSpace::AllocNewTlabBulk(Thread* self, size_t bytes, size_t reserve_bytes) {
+  DCHECK_ALIGNED(bytes, kAlignment);
+  DCHECK_LE(bytes, reserve_bytes);
+  reserve_bytes = RoundUp(reserve_bytes, kAlignment);
+  GetTelemetry().RecordTlabRefill();
+  GetTelemetry().RecordLockAcquisition();
   MutexLock mu(Thread::Current(), block_lock_);
   RevokeThreadLocalBuffersLocked(self);
-  uint8_t* start = AllocBlock(bytes);
+  uint8_t* start = AllocBlock(reserve_bytes);
+  if (start == nullptr && reserve_bytes != bytes) {
+    // The bulk reservation does not fit; fall back to the requested TLAB size.
+    reserve_bytes = bytes;
+    start = AllocBlock(reserve_bytes);
+  }
   if (start == nullptr) {
-    return false;
+    return 0u;
   }
-  self->SetTlab(start, start + bytes, start + bytes);
-  return true;
+  self->SetTlab(start, start + bytes, start + reserve_bytes);
+  return reserve_bytes;
 }
 
 bool BumpPointerSpace::LogFragmentationAllocFailure(std::ostream& os,
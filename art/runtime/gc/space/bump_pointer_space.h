@@ -143,6 +143,14 @@ class BumpPointerSpace final : public ContinuousMemMapAllocSpace {
   // Allocate a new TLAB, returns false if the allocation failed.
   bool AllocNewTlab(Thread* self, size_t bytes) REQUIRES(!block_lock_);
 
+  // Allocate a new TLAB with `bytes` immediately usable bytes, reserving a total of
+  // `reserve_bytes` (>= `bytes`) for the thread in one block. The reserved tail is made
+  // usable later through Thread::ExpandTlab without taking block_lock_, which amortizes
+  // the refill cost for allocation-rate-heavy threads. Returns the number of bytes
+  // actually reserved, or 0 if the allocation failed.
+  size_t AllocNewTlabBulk(Thread* self, size_t bytes, size_t reserve_bytes)
+      REQUIRES(!block_lock_);
+
   BumpPointerSpace* AsBumpPointerSpace() override {
     return this;
   }
@@ -63,6 +63,7 @@
 #include "oat_file.h"
 #include "profile/profile_compilation_info.h"
 #include "runtime.h"
+#include "scoped_thread_state_change-inl.h"
 #include "space-inl.h"
 
 namespace art {
@@ -2808,38 +2809,70 @@ class ImageSpace::BootImageLoader {
       }
     }
 
-    for (const std::unique_ptr<ImageSpace>& space : spaces) {
-      const ImageHeader& image_header = space->GetImageHeader();
-
-      static_assert(IsAligned<kObjectAlignment>(sizeof(ImageHeader)), "Header alignment check");
-      uint32_t objects_end = image_header.GetObjectsSection().Size();
-      DCHECK_ALIGNED(objects_end, kObjectAlignment);
-      for (uint32_t pos = sizeof(ImageHeader); pos != objects_end; ) {
-        mirror::Object* object = reinterpret_cast<mirror::Object*>(space->Begin() + pos);
-        // Note: use Test() rather than Set() as this is the last time we're checking this object.
-        if (!patched_objects->Test(object)) {
-          // This is the last pass over objects, so we do not need to Set().
-          main_patch_object_visitor.VisitObject(object);
-          ObjPtr<mirror::Class> klass = object->GetClass<kVerifyNone, kWithoutReadBarrier>();
-          if (klass == method_class || klass == constructor_class) {
-            // Patch the ArtMethod* in the mirror::Executable subobject.
-            ObjPtr<mirror::Executable> as_executable =
-                ObjPtr<mirror::Executable>::DownCast(object);
-            ArtMethod* unpatched_method = as_executable->GetArtMethod<kVerifyNone>();
-            ArtMethod* patched_method = main_relocate_visitor(unpatched_method);
-            as_executable->SetArtMethod</*kTransactionActive=*/ false,
-                                        /*kCheckTransaction=*/ true,
-                                        kVerifyNone>(patched_method);
-          } else if (klass == field_var_handle_class || klass == static_field_var_handle_class) {
-            // Patch the ArtField* in the mirror::FieldVarHandle subobject.
-            ObjPtr<mirror::FieldVarHandle> as_field_var_handle =
-                ObjPtr<mirror::FieldVarHandle>::DownCast(object);
-            ArtField* unpatched_field = as_field_var_handle->GetArtField<kVerifyNone>();
-            ArtField* patched_field = main_relocate_visitor(unpatched_field);
-            as_field_var_handle->SetArtField<kVerifyNone>(patched_field);
+    // The passes above have already patched all classes and marked them in `patched_objects`,
+    // so the final object pass over one space is independent of the pass over any other space:
+    // `patched_objects` is only tested (never set) below and every object is visited by exactly
+    // one pass. Fan the per-space passes out to the runtime thread pool, if available, to reduce
+    // relocation time on multi-core devices; otherwise patch on the loading thread as before.
+    {
+      Runtime::ScopedThreadPoolUsage stpu;
+      ThreadPool* const pool = stpu.GetThreadPool();
+      Thread* const self = Thread::Current();
+      static constexpr size_t kMinSpaces = 2u;
+      const bool use_parallel = pool != nullptr && spaces.size() >= kMinSpaces;
+      for (const std::unique_ptr<ImageSpace>& space : spaces) {
+        auto function = [&, space = space.get()](Thread* thread) NO_THREAD_SAFETY_ANALYSIS {
+          // Register the worker with the mutator lock for the object accesses below. The GC
+          // cannot see these spaces yet, so there is no interference with collections.
+          ScopedObjectAccess soa(thread);
+          ScopedTrace trace("Relocate image objects");
+          const ImageHeader& image_header = space->GetImageHeader();
+
+          static_assert(IsAligned<kObjectAlignment>(sizeof(ImageHeader)),
+                        "Header alignment check");
+          uint32_t objects_end = image_header.GetObjectsSection().Size();
+          DCHECK_ALIGNED(objects_end, kObjectAlignment);
+          for (uint32_t pos = sizeof(ImageHeader); pos != objects_end; ) {
+            mirror::Object* object = reinterpret_cast<mirror::Object*>(space->Begin() + pos);
+            // Note: use Test() rather than Set() as this is the last time we're checking this
+            // object.
+            if (!patched_objects->Test(object)) {
+              // This is the last pass over objects, so we do not need to Set().
+              main_patch_object_visitor.VisitObject(object);
+              ObjPtr<mirror::Class> klass = object->GetClass<kVerifyNone, kWithoutReadBarrier>();
+              if (klass == method_class || klass == constructor_class) {
+                // Patch the ArtMethod* in the mirror::Executable subobject.
+                ObjPtr<mirror::Executable> as_executable =
+                    ObjPtr<mirror::Executable>::DownCast(object);
+                ArtMethod* unpatched_method = as_executable->GetArtMethod<kVerifyNone>();
+                ArtMethod* patched_method = main_relocate_visitor(unpatched_method);
+                as_executable->SetArtMethod</*kTransactionActive=*/ false,
+                                            /*kCheckTransaction=*/ true,
+                                            kVerifyNone>(patched_method);
+              } else if (klass == field_var_handle_class ||
+                         klass == static_field_var_handle_class) {
+                // Patch the ArtField* in the mirror::FieldVarHandle subobject.
+                ObjPtr<mirror::FieldVarHandle> as_field_var_handle =
+                    ObjPtr<mirror::FieldVarHandle>::DownCast(object);
+                ArtField* unpatched_field = as_field_var_handle->GetArtField<kVerifyNone>();
+                ArtField* patched_field = main_relocate_visitor(unpatched_field);
+                as_field_var_handle->SetArtField<kVerifyNone>(patched_field);
+              }
+            }
+            pos += RoundUp(object->SizeOf<kVerifyNone>(), kObjectAlignment);
           }
+        };
+        if (use_parallel) {
+          pool->AddTask(self, new FunctionTask(std::move(function)));
+        } else {
+          function(self);
         }
-        pos += RoundUp(object->SizeOf<kVerifyNone>(), kObjectAlignment);
+      }
+      if (use_parallel) {
+        ScopedTrace trace("Waiting for workers");
+        // Go to native since we don't want to suspend while holding the mutator lock.
+        ScopedThreadSuspension sts(self, ThreadState::kNative);
+        pool->Wait(self, true, false);
       }
     }
     if (kIsDebugBuild && !kExtension) {
@@ -148,6 +148,8 @@ mirror::Object* LargeObjectMapSpace::Alloc(Thread* self, size_t num_bytes,
   }
   mirror::Object* const obj = reinterpret_cast<mirror::Object*>(mem_map.Begin());
   const size_t allocation_size = mem_map.BaseSize();
+  GetTelemetry().RecordAllocation(allocation_size);
+  GetTelemetry().RecordLockAcquisition();
   MutexLock mu(self, lock_);
   large_objects_.Put(obj, LargeObject {std::move(mem_map), false /* not zygote */});
   DCHECK(bytes_allocated != nullptr);
@@ -189,6 +191,7 @@ void LargeObjectMapSpace::SetAllLargeObjectsAsZygoteObjects(Thread* self, bool s
 }
 
 size_t LargeObjectMapSpace::Free(Thread* self, mirror::Object* ptr) {
+  GetTelemetry().RecordLockAcquisition();
   MutexLock mu(self, lock_);
   auto it = large_objects_.find(ptr);
   if (UNLIKELY(it == large_objects_.end())) {
@@ -202,6 +205,7 @@ size_t LargeObjectMapSpace::Free(Thread* self, mirror::Object* ptr) {
   num_bytes_allocated_ -= allocation_size;
   --num_objects_allocated_;
   large_objects_.erase(it);
+  GetTelemetry().RecordFree(allocation_size);
   return allocation_size;
 }
 
@@ -254,6 +258,18 @@ bool LargeObjectMapSpace::Contains(const mirror::Object* obj) const {
   }
 }
 
+// Lazily reclaim freed large-object pages with MADV_FREE where available. The kernel
+// then only takes the pages back under memory pressure, which suits bitmap/texture
+// heavy workloads that free and reallocate large arrays at a high rate. Unlike
+// MADV_DONTNEED, MADV_FREE does not guarantee that reused pages read back as zero, so
+// allocations carved out of previously used parts of the space are zeroed explicitly
+// (see FreeListSpace::Alloc).
+#ifdef MADV_FREE
+static constexpr bool kLazyReclaimFreedPages = true;
+#else
+static constexpr bool kLazyReclaimFreedPages = false;
+#endif
+
 // Keeps track of allocation sizes + whether or not the previous allocation is free.
 // Used to coalesce free blocks and find the best fit block for an allocation for best fit object
 // allocation. Each allocation has an AllocationInfo which contains the size of the previous free
@@ -375,6 +391,7 @@ FreeListSpace::FreeListSpace(const std::string& name,
                              uint8_t* end)
     : LargeObjectSpace(name, begin, end, "free list space lock"),
       mem_map_(std::move(mem_map)) {
+  untouched_begin_ = reinterpret_cast<uintptr_t>(begin);
   const size_t space_capacity = end - begin;
   free_end_ = space_capacity;
   CHECK_ALIGNED(space_capacity, kAlignment);
@@ -435,12 +452,18 @@ size_t FreeListSpace::Free(Thread* self, mirror::Object* obj) {
   DCHECK_ALIGNED(allocation_size, kAlignment);
 
   // madvise the pages without lock
+#ifdef MADV_FREE
+  madvise(obj, allocation_size, kLazyReclaimFreedPages ? MADV_FREE : MADV_DONTNEED);
+#else
   madvise(obj, allocation_size, MADV_DONTNEED);
+#endif
   if (kIsDebugBuild) {
     // Can't disallow reads since we use them to find next chunks during coalescing.
     CheckedCall(mprotect, __FUNCTION__, obj, allocation_size, PROT_READ);
   }
 
+  GetTelemetry().RecordFree(allocation_size);
+  GetTelemetry().RecordLockAcquisition();
   MutexLock mu(self, lock_);
   info->SetByteSize(allocation_size, true);  // Mark as free.
   // Look at the next chunk.
@@ -499,58 +522,77 @@ size_t FreeListSpace::AllocationSize(mirror::Object* obj, size_t* usable_size) {
 
 mirror::Object* FreeListSpace::Alloc(Thread* self, size_t num_bytes, size_t* bytes_allocated,
                                      size_t* usable_size, size_t* bytes_tl_bulk_allocated) {
-  MutexLock mu(self, lock_);
   const size_t allocation_size = RoundUp(num_bytes, kAlignment);
-  AllocationInfo temp_info;
-  temp_info.SetPrevFreeBytes(allocation_size);
-  temp_info.SetByteSize(0, false);
-  AllocationInfo* new_info;
-  // Find the smallest chunk at least num_bytes in size.
-  auto it = free_blocks_.lower_bound(&temp_info);
-  if (it != free_blocks_.end()) {
-    AllocationInfo* info = *it;
-    free_blocks_.erase(it);
-    // Fit our object in the previous allocation info free space.
-    new_info = info->GetPrevFreeInfo();
-    // Remove the newly allocated block from the info and update the prev_free_.
-    info->SetPrevFreeBytes(info->GetPrevFreeBytes() - allocation_size);
-    if (info->GetPrevFreeBytes() > 0) {
-      AllocationInfo* new_free = info - info->GetPrevFree();
-      new_free->SetPrevFreeBytes(0);
-      new_free->SetByteSize(info->GetPrevFreeBytes(), true);
-      // If there is remaining space, insert back into the free set.
-      free_blocks_.insert(info);
-    }
-  } else {
-    // Try to steal some memory from the free space at the end of the space.
-    if (LIKELY(free_end_ >= allocation_size)) {
-      // Fit our object at the start of the end free block.
-      new_info = GetAllocationInfoForAddress(reinterpret_cast<uintptr_t>(End()) - free_end_);
-      free_end_ -= allocation_size;
+  mirror::Object* obj;
+  bool needs_zeroing = false;
+  GetTelemetry().RecordLockAcquisition();
+  {
+    MutexLock mu(self, lock_);
+    AllocationInfo temp_info;
+    temp_info.SetPrevFreeBytes(allocation_size);
+    temp_info.SetByteSize(0, false);
+    AllocationInfo* new_info;
+    // Find the smallest chunk at least num_bytes in size.
+    auto it = free_blocks_.lower_bound(&temp_info);
+    if (it != free_blocks_.end()) {
+      AllocationInfo* info = *it;
+      free_blocks_.erase(it);
+      // Fit our object in the previous allocation info free space.
+      new_info = info->GetPrevFreeInfo();
+      // Remove the newly allocated block from the info and update the prev_free_.
+      info->SetPrevFreeBytes(info->GetPrevFreeBytes() - allocation_size);
+      if (info->GetPrevFreeBytes() > 0) {
+        AllocationInfo* new_free = info - info->GetPrevFree();
+        new_free->SetPrevFreeBytes(0);
+        new_free->SetByteSize(info->GetPrevFreeBytes(), true);
+        // If there is remaining space, insert back into the free set.
+        free_blocks_.insert(info);
+      }
     } else {
-      return nullptr;
+      // Try to steal some memory from the free space at the end of the space.
+      if (LIKELY(free_end_ >= allocation_size)) {
+        // Fit our object at the start of the end free block.
+        new_info = GetAllocationInfoForAddress(reinterpret_cast<uintptr_t>(End()) - free_end_);
+        free_end_ -= allocation_size;
+      } else {
+        return nullptr;
+      }
+    }
+    DCHECK(bytes_allocated != nullptr);
+    *bytes_allocated = allocation_size;
+    if (usable_size != nullptr) {
+      *usable_size = allocation_size;
+    }
+    DCHECK(bytes_tl_bulk_allocated != nullptr);
+    *bytes_tl_bulk_allocated = allocation_size;
+    // Need to do these inside of the lock.
+    ++num_objects_allocated_;
+    ++total_objects_allocated_;
+    num_bytes_allocated_ += allocation_size;
+    total_bytes_allocated_ += allocation_size;
+    GetTelemetry().RecordAllocation(allocation_size);
+    obj = reinterpret_cast<mirror::Object*>(GetAddressForAllocationInfo(new_info));
+    // We always put our object at the start of the free block, there cannot be another free block
+    // before it.
+    if (kIsDebugBuild) {
+      CheckedCall(mprotect, __FUNCTION__, obj, allocation_size, PROT_READ | PROT_WRITE);
+    }
+    new_info->SetPrevFreeBytes(0);
+    new_info->SetByteSize(allocation_size, false);
+    if (kLazyReclaimFreedPages) {
+      // Allocations entirely above `untouched_begin_` sit on never-used pages, which are
+      // guaranteed to read as zero; anything else may overlap pages freed with MADV_FREE
+      // and must be zeroed explicitly before use.
+      const uintptr_t obj_begin = reinterpret_cast<uintptr_t>(obj);
+      needs_zeroing = obj_begin < untouched_begin_;
+      untouched_begin_ = std::max(untouched_begin_, obj_begin + allocation_size);
     }
   }
-  DCHECK(bytes_allocated != nullptr);
-  *bytes_allocated = allocation_size;
-  if (usable_size != nullptr) {
-    *usable_size = allocation_size;
-  }
-  DCHECK(bytes_tl_bulk_allocated != nullptr);
-  *bytes_tl_bulk_allocated = allocation_size;
-  // Need to do these inside of the lock.
-  ++num_objects_allocated_;
-  ++total_objects_allocated_;
-  num_bytes_allocated_ += allocation_size;
-  total_bytes_allocated_ += allocation_size;
-  mirror::Object* obj = reinterpret_cast<mirror::Object*>(GetAddressForAllocationInfo(new_info));
-  // We always put our object at the start of the free block, there cannot be another free block
-  // before it.
-  if (kIsDebugBuild) {
-    CheckedCall(mprotect, __FUNCTION__, obj, allocation_size, PROT_READ | PROT_WRITE);
+  if (needs_zeroing) {
+    // The address range was claimed above, so no other thread can touch it; zero it
+    // without holding the lock.
+    memset(obj, 0, allocation_size);
   }
-  new_info->SetPrevFreeBytes(0);
-  new_info->SetByteSize(allocation_size, false);
   return obj;
 }
 
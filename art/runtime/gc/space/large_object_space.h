@@ -240,6 +240,10 @@ class FreeListSpace final : public LargeObjectSpace {
   // Free bytes at the end of the space.
   size_t free_end_ GUARDED_BY(lock_);
   FreeBlocks free_blocks_ GUARDED_BY(lock_);
+  // Addresses at or above this have never been handed out and are therefore backed by
+  // zero pages. Used by the MADV_FREE lazy reclaim mode to decide whether an allocation
+  // needs explicit zeroing (see FreeListSpace::Alloc).
+  uintptr_t untouched_begin_ GUARDED_BY(lock_);
 };
 
 }  // namespace space
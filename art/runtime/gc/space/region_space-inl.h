@@ -61,8 +61,10 @@ inline mirror::Object* RegionSpace::AllocNonvirtual(size_t num_bytes,
                                                              usable_size,
                                                              bytes_tl_bulk_allocated);
     if (LIKELY(obj != nullptr)) {
+      GetTelemetry().RecordAllocation(num_bytes);
       return obj;
     }
+    GetTelemetry().RecordLockAcquisition();
     MutexLock mu(Thread::Current(), region_lock_);
     // Retry with current region since another thread may have updated
     // current_region_ or evac_region_.  TODO: fix race.
@@ -71,6 +73,7 @@ inline mirror::Object* RegionSpace::AllocNonvirtual(size_t num_bytes,
                                                              usable_size,
                                                              bytes_tl_bulk_allocated);
     if (LIKELY(obj != nullptr)) {
+      GetTelemetry().RecordAllocation(num_bytes);
       return obj;
     }
     Region* r = AllocateRegion(kForEvac);
@@ -84,12 +87,14 @@ inline mirror::Object* RegionSpace::AllocNonvirtual(size_t num_bytes,
       } else {
         current_region_ = r;
       }
+      GetTelemetry().RecordAllocation(num_bytes);
       return obj;
     }
   } else {
     // Large object.
     obj = AllocLarge<kForEvac>(num_bytes, bytes_allocated, usable_size, bytes_tl_bulk_allocated);
     if (LIKELY(obj != nullptr)) {
+      GetTelemetry().RecordAllocation(num_bytes);
       return obj;
     }
   }
@@ -472,7 +477,7 @@ inline void RegionSpace::FreeLarge(mirror::Object* large_obj, size_t bytes_alloc
     } else {
       DCHECK(reg->IsLargeTail());
     }
-    reg->Clear(/*zero_and_release_pages=*/true);
+    reg->Clear(this, /*zero_and_release_pages=*/true);
     if (kForEvac) {
       --num_evac_regions_;
     } else {
@@ -15,6 +15,8 @@
  */
 #include <deque>
 
+#include "android-base/stringprintf.h"
+
 #include "bump_pointer_space-inl.h"
 #include "bump_pointer_space.h"
 #include "base/dumpable.h"
@@ -28,6 +30,8 @@ namespace art {
 namespace gc {
 namespace space {
 
+using android::base::StringPrintf;
+
 // If a region has live objects whose size is less than this percent
 // value of the region size, evaculate the region.
 static constexpr uint kEvacuateLivePercentThreshold = 75U;
@@ -126,6 +130,15 @@ RegionSpace::RegionSpace(const std::string& name, MemMap&& mem_map, bool use_gen
   for (size_t i = 0; i < num_regions_; ++i, region_addr += kRegionSize) {
     regions_[i].Init(i, region_addr, region_addr + kRegionSize);
   }
+  // All regions start out free. Clear the bits beyond `num_regions_` in the last word so
+  // that bitmap scans never yield an invalid region index.
+  const size_t num_bitmap_words =
+      RoundUp(num_regions_, BitSizeOf<uint64_t>()) / BitSizeOf<uint64_t>();
+  free_region_bitmap_.resize(num_bitmap_words, ~UINT64_C(0));
+  const size_t tail_bits = num_bitmap_words * BitSizeOf<uint64_t>() - num_regions_;
+  if (tail_bits != 0u) {
+    free_region_bitmap_.back() = ~UINT64_C(0) >> tail_bits;
+  }
   mark_bitmap_ =
       accounting::ContinuousSpaceBitmap::Create("region space live bitmap", Begin(), Capacity());
   if (kIsDebugBuild) {
@@ -512,17 +525,17 @@ void RegionSpace::ClearFromSpace(/* out */ uint64_t* cleared_bytes,
       *cleared_bytes += r->BytesAllocated();
       *cleared_objects += r->ObjectsAllocated();
       --num_non_free_regions_;
-      r->Clear(/*zero_and_release_pages=*/false);
+      r->Clear(this, /*zero_and_release_pages=*/false);
     } else if (r->IsInUnevacFromSpace()) {
       if (r->LiveBytes() == 0) {
         DCHECK(!r->IsLargeTail());
         *cleared_bytes += r->BytesAllocated();
         *cleared_objects += r->ObjectsAllocated();
-        r->Clear(/*zero_and_release_pages=*/false);
+        r->Clear(this, /*zero_and_release_pages=*/false);
         size_t free_regions = 1;
         // Also release RAM for large tails.
         while (i + free_regions < num_regions_ && regions_[i + free_regions].IsLargeTail()) {
-          regions_[i + free_regions].Clear(/*zero_and_release_pages=*/false);
+          regions_[i + free_regions].Clear(this, /*zero_and_release_pages=*/false);
           ++free_regions;
         }
         num_non_free_regions_ -= free_regions;
@@ -758,7 +771,7 @@ void RegionSpace::Clear() {
     if (!r->IsFree()) {
       --num_non_free_regions_;
     }
-    r->Clear(/*zero_and_release_pages=*/true);
+    r->Clear(this, /*zero_and_release_pages=*/true);
   }
   SetNonFreeRegionLimit(0);
   DCHECK_EQ(num_non_free_regions_, 0u);
@@ -803,6 +816,27 @@ void RegionSpace::Dump(std::ostream& os) const {
      << reinterpret_cast<void*>(Begin()) << "-" << reinterpret_cast<void*>(Limit());
 }
 
+void RegionSpace::DumpTelemetry(std::ostream& os) {
+  Space::DumpTelemetry(os);
+  // Fragmentation ratio: fraction of the committed region bytes that do not
+  // hold allocated data. Internal fragmentation of partially filled regions
+  // and wasted tails of large-object region sequences both count.
+  const uint64_t allocated_bytes = GetBytesAllocated();
+  uint64_t committed_bytes;
+  {
+    MutexLock mu(Thread::Current(), region_lock_);
+    committed_bytes = static_cast<uint64_t>(num_non_free_regions_) * kRegionSize;
+  }
+  os << " fragmentation-ratio=";
+  if (committed_bytes != 0u && committed_bytes >= allocated_bytes) {
+    os << StringPrintf("%.3f",
+                       static_cast<double>(committed_bytes - allocated_bytes) /
+                           static_cast<double>(committed_bytes));
+  } else {
+    os << "0.000";
+  }
+}
+
 void RegionSpace::DumpRegionForObject(std::ostream& os, mirror::Object* obj) {
   CHECK(HasAddress(obj));
   MutexLock mu(Thread::Current(), region_lock_);
@@ -835,6 +869,8 @@ void RegionSpace::RecordAlloc(mirror::Object* ref) {
 bool RegionSpace::AllocNewTlab(Thread* self,
                                const size_t tlab_size,
                                size_t* bytes_tl_bulk_allocated) {
+  GetTelemetry().RecordTlabRefill();
+  GetTelemetry().RecordLockAcquisition();
   MutexLock mu(self, region_lock_);
   RevokeThreadLocalBuffersLocked(self, /*reuse=*/ gc::Heap::kUsePartialTlabs);
   Region* r = nullptr;
@@ -995,7 +1031,8 @@ size_t RegionSpace::AllocationSizeNonvirtual(mirror::Object* obj, size_t* usable
   return num_bytes;
 }
 
-void RegionSpace::Region::Clear(bool zero_and_release_pages) {
+void RegionSpace::Region::Clear(RegionSpace* region_space, bool zero_and_release_pages) {
+  region_space->SetRegionFreeBit(idx_);
   top_.store(begin_, std::memory_order_relaxed);
   state_ = RegionState::kRegionStateFree;
   type_ = RegionType::kRegionTypeNone;
@@ -1019,42 +1056,66 @@ RegionSpace::Region* RegionSpace::AllocateRegion(bool for_evac) {
   if (!for_evac && (num_non_free_regions_ + 1) * 2 > num_regions_) {
     return nullptr;
   }
-  for (size_t i = 0; i < num_regions_; ++i) {
-    // When using the cyclic region allocation strategy, try to
-    // allocate a region starting from the last cyclic allocated
-    // region marker. Otherwise, try to allocate a region starting
-    // from the beginning of the region space.
-    size_t region_index = kCyclicRegionAllocation
-        ? ((cyclic_alloc_region_index_ + i) % num_regions_)
-        : i;
-    Region* r = &regions_[region_index];
-    if (r->IsFree()) {
-      r->Unfree(this, time_);
-      if (use_generational_cc_) {
-        // TODO: Add an explanation for this assertion.
-        DCHECK_IMPLIES(for_evac, !r->is_newly_allocated_);
-      }
-      if (for_evac) {
-        ++num_evac_regions_;
-        TraceHeapSize();
-        // Evac doesn't count as newly allocated.
-      } else {
-        r->SetNewlyAllocated();
-        ++num_non_free_regions_;
-      }
-      if (kCyclicRegionAllocation) {
-        // Move the cyclic allocation region marker to the region
-        // following the one that was just allocated.
-        cyclic_alloc_region_index_ = (region_index + 1) % num_regions_;
-      }
-      return r;
+  // When using the cyclic region allocation strategy, try to allocate a region starting
+  // from the last cyclic allocated region marker, wrapping around once. Otherwise, try
+  // to allocate a region starting from the beginning of the region space. The
+  // free-region bitmap makes the search scan words instead of probing every region.
+  size_t start = kCyclicRegionAllocation ? cyclic_alloc_region_index_ : 0u;
+  size_t region_index = FindFirstFreeRegion(start);
+  if (region_index == num_regions_ && start != 0u) {
+    // No free region at or after `start`; wrap around. This can only find a region
+    // before `start`.
+    region_index = FindFirstFreeRegion(0u);
+  }
+  if (region_index == num_regions_) {
+    return nullptr;
+  }
+  Region* r = &regions_[region_index];
+  DCHECK(r->IsFree());
+  r->Unfree(this, time_);
+  if (use_generational_cc_) {
+    // TODO: Add an explanation for this assertion.
+    DCHECK_IMPLIES(for_evac, !r->is_newly_allocated_);
+  }
+  if (for_evac) {
+    ++num_evac_regions_;
+    TraceHeapSize();
+    // Evac doesn't count as newly allocated.
+  } else {
+    r->SetNewlyAllocated();
+    ++num_non_free_regions_;
+  }
+  if (kCyclicRegionAllocation) {
+    // Move the cyclic allocation region marker to the region
+    // following the one that was just allocated.
+    cyclic_alloc_region_index_ = (region_index + 1) % num_regions_;
+  }
+  return r;
+}
+
+size_t RegionSpace::FindFirstFreeRegion(size_t start) const {
+  if (start >= num_regions_) {
+    return num_regions_;
+  }
+  size_t word_index = start / BitSizeOf<uint64_t>();
+  // Mask off the bits before `start` in the first word.
+  uint64_t word = free_region_bitmap_[word_index] &
+      (~UINT64_C(0) << (start % BitSizeOf<uint64_t>()));
+  while (word == 0u) {
+    ++word_index;
+    if (word_index == free_region_bitmap_.size()) {
+      return num_regions_;
     }
+    word = free_region_bitmap_[word_index];
   }
-  return nullptr;
+  size_t result = word_index * BitSizeOf<uint64_t>() + CTZ(word);
+  DCHECK_LT(result, num_regions_);
+  return result;
 }
 
 void RegionSpace::Region::MarkAsAllocated(RegionSpace* region_space, uint32_t alloc_time) {
   DCHECK(IsFree());
+  region_space->ClearRegionFreeBit(idx_);
   alloc_time_ = alloc_time;
   region_space->AdjustNonFreeRegionLimit(idx_);
   type_ = RegionType::kRegionTypeToSpace;
@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_GC_SPACE_REGION_SPACE_H_
 #define ART_RUNTIME_GC_SPACE_REGION_SPACE_H_
 
+#include "base/bit_utils.h"
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "space.h"
@@ -138,6 +139,8 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
   void ClampGrowthLimit(size_t new_capacity) REQUIRES(!region_lock_);
 
   void Dump(std::ostream& os) const override;
+  // Appends the fragmentation ratio of the committed regions to the counters.
+  void DumpTelemetry(std::ostream& os) override REQUIRES(!region_lock_);
   void DumpRegions(std::ostream& os) REQUIRES(!region_lock_);
   // Dump region containing object `obj`. Precondition: `obj` is in the region space.
   void DumpRegionForObject(std::ostream& os, mirror::Object* obj) REQUIRES(!region_lock_);
@@ -428,7 +431,8 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
       return type_;
     }
 
-    void Clear(bool zero_and_release_pages);
+    void Clear(RegionSpace* region_space, bool zero_and_release_pages)
+        REQUIRES(region_space->region_lock_);
 
     ALWAYS_INLINE mirror::Object* Alloc(size_t num_bytes,
                                         /* out */ size_t* bytes_allocated,
@@ -712,6 +716,23 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
     }
   }
 
+  // Mark region `idx` as free/non-free in `free_region_bitmap_`. Only called from
+  // Region::Clear and Region::MarkAsAllocated, which own the region state transitions.
+  void SetRegionFreeBit(size_t idx) REQUIRES(region_lock_) {
+    DCHECK_LT(idx, num_regions_);
+    free_region_bitmap_[idx / BitSizeOf<uint64_t>()] |=
+        UINT64_C(1) << (idx % BitSizeOf<uint64_t>());
+  }
+  void ClearRegionFreeBit(size_t idx) REQUIRES(region_lock_) {
+    DCHECK_LT(idx, num_regions_);
+    free_region_bitmap_[idx / BitSizeOf<uint64_t>()] &=
+        ~(UINT64_C(1) << (idx % BitSizeOf<uint64_t>()));
+  }
+
+  // Return the index of the first free region at or after `start`, or `num_regions_` if
+  // there is none.
+  size_t FindFirstFreeRegion(size_t start) const REQUIRES(region_lock_);
+
   Region* AllocateRegion(bool for_evac) REQUIRES(region_lock_);
   void RevokeThreadLocalBuffersLocked(Thread* thread, bool reuse) REQUIRES(region_lock_);
 
@@ -763,6 +784,12 @@ class RegionSpace final : public ContinuousMemMapAllocSpace {
   // The pointer to the region array.
   std::unique_ptr<Region[]> regions_ GUARDED_BY(region_lock_);
 
+  // One bit per region, set while the region is free. Kept in sync with the region
+  // states by Region::MarkAsAllocated and Region::Clear, and scanned word-at-a-time by
+  // AllocateRegion so that finding a free region does not probe every region on large
+  // heaps. Bits beyond `num_regions_` are always clear.
+  std::vector<uint64_t> free_region_bitmap_ GUARDED_BY(region_lock_);
+
   // To hold partially used TLABs which can be reassigned to threads later for
   // utilizing the un-used portion.
   std::multimap<size_t, Region*, std::greater<size_t>> partial_tlabs_ GUARDED_BY(region_lock_);
@@ -16,9 +16,14 @@
 
 #include "space.h"
 
+#include <vector>
+
 #include <android-base/logging.h>
 
 #include "base/macros.h"
+#include "base/mutex.h"
+#include "base/stl_util.h"
+#include "base/utils.h"
 #include "gc/accounting/heap_bitmap.h"
 #include "gc/accounting/space_bitmap-inl.h"
 #include "gc/heap.h"
@@ -29,13 +34,56 @@ namespace art {
 namespace gc {
 namespace space {
 
+// Registry of live spaces for DumpAllTelemetry(). Spaces are created and
+// destroyed rarely, only the registration itself takes the lock.
+static Mutex& TelemetryRegistryLock() {
+  static Mutex lock("Space telemetry registry lock");
+  return lock;
+}
+
+static std::vector<Space*>& TelemetryRegistry() {
+  static std::vector<Space*> registry;
+  return registry;
+}
+
 Space::Space(const std::string& name, GcRetentionPolicy gc_retention_policy)
-    : name_(name), gc_retention_policy_(gc_retention_policy) { }
+    : name_(name), gc_retention_policy_(gc_retention_policy) {
+  MutexLock mu(Thread::Current(), TelemetryRegistryLock());
+  TelemetryRegistry().push_back(this);
+}
+
+Space::~Space() {
+  MutexLock mu(Thread::Current(), TelemetryRegistryLock());
+  RemoveElement(TelemetryRegistry(), this);
+}
 
 void Space::Dump(std::ostream& os) const {
   os << GetName() << ":" << GetGcRetentionPolicy();
 }
 
+void Space::DumpTelemetry(std::ostream& os) {
+  os << GetName() << ": ";
+  telemetry_.Dump(os);
+}
+
+void Space::DumpAllTelemetry(std::ostream& os) {
+  os << "Space telemetry:\n";
+  MutexLock mu(Thread::Current(), TelemetryRegistryLock());
+  for (Space* space : TelemetryRegistry()) {
+    os << "  ";
+    space->DumpTelemetry(os);
+    os << "\n";
+  }
+}
+
+void SpaceTelemetry::Dump(std::ostream& os) const {
+  const Snapshot snapshot = GetSnapshot();
+  os << "alloc=" << PrettySize(snapshot.allocated_bytes) << "/" << snapshot.allocation_count
+     << " freed=" << PrettySize(snapshot.freed_bytes) << "/" << snapshot.free_count
+     << " tlab-refills=" << snapshot.tlab_refills
+     << " lock-acquisitions=" << snapshot.lock_acquisitions;
+}
+
 std::ostream& operator<<(std::ostream& os, const Space& space) {
   space.Dump(os);
   return os;
@@ -26,6 +26,7 @@
 #include "base/mem_map.h"
 #include "gc/accounting/space_bitmap.h"
 #include "gc/collector/object_byte_pair.h"
+#include "gc/space/space_telemetry.h"
 #include "runtime_globals.h"
 
 namespace art {
@@ -98,6 +99,23 @@ class Space {
   // The kind of space this: image, alloc, zygote, large object.
   virtual SpaceType GetType() const = 0;
 
+  // Always-on lock-free allocator telemetry for this space.
+  SpaceTelemetry& GetTelemetry() {
+    return telemetry_;
+  }
+
+  // Polling API: take a copy of the telemetry counters without dumping.
+  SpaceTelemetry::Snapshot GetTelemetrySnapshot() const {
+    return telemetry_.GetSnapshot();
+  }
+
+  // Dump the telemetry counters for this space. Subclasses may append
+  // space-specific metrics such as the fragmentation ratio.
+  virtual void DumpTelemetry(std::ostream& os);
+
+  // Dump telemetry for all live spaces. Used by the SIGQUIT dump.
+  static void DumpAllTelemetry(std::ostream& os);
+
   // Is this an image space, ie one backed by a memory mapped image file.
   bool IsImageSpace() const {
     return GetType() == kSpaceTypeImageSpace;
@@ -167,9 +185,11 @@ class Space {
   // Returns true if objects in the space are movable.
   virtual bool CanMoveObjects() const = 0;
 
-  virtual ~Space() {}
+  // Unregisters the space from the telemetry registry.
+  virtual ~Space();
 
  protected:
+  // Registers the space in the telemetry registry.
   Space(const std::string& name, GcRetentionPolicy gc_retention_policy);
 
   void SetGcRetentionPolicy(GcRetentionPolicy gc_retention_policy) {
@@ -184,6 +204,9 @@ class Space {
   // of Zygote forking.
   GcRetentionPolicy gc_retention_policy_;
 
+  // Lock-free counters recorded by the allocation paths.
+  SpaceTelemetry telemetry_;
+
  private:
   friend class art::gc::Heap;
   DISALLOW_IMPLICIT_CONSTRUCTORS(Space);
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_SPACE_SPACE_TELEMETRY_H_
+#define ART_RUNTIME_GC_SPACE_SPACE_TELEMETRY_H_
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+
+#include "base/macros.h"
+
+namespace art {
+namespace gc {
+namespace space {
+
+// Always-on allocator telemetry for a space. All counters are monotonically
+// increasing and updated with relaxed atomics, so recording is lock-free and
+// cheap enough for allocation fast paths. Readers get no cross-counter
+// consistency guarantees, which is acceptable for monitoring.
+class SpaceTelemetry {
+ public:
+  // Copy of the counters for the polling API.
+  struct Snapshot {
+    uint64_t allocated_bytes = 0u;
+    uint64_t allocation_count = 0u;
+    uint64_t freed_bytes = 0u;
+    uint64_t free_count = 0u;
+    uint64_t tlab_refills = 0u;
+    uint64_t lock_acquisitions = 0u;
+  };
+
+  SpaceTelemetry() {}
+
+  ALWAYS_INLINE void RecordAllocation(size_t bytes) {
+    allocated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    allocation_count_.fetch_add(1u, std::memory_order_relaxed);
+  }
+
+  ALWAYS_INLINE void RecordFree(size_t bytes) {
+    freed_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    free_count_.fetch_add(1u, std::memory_order_relaxed);
+  }
+
+  ALWAYS_INLINE void RecordTlabRefill() {
+    tlab_refills_.fetch_add(1u, std::memory_order_relaxed);
+  }
+
+  ALWAYS_INLINE void RecordLockAcquisition() {
+    lock_acquisitions_.fetch_add(1u, std::memory_order_relaxed);
+  }
+
+  Snapshot GetSnapshot() const {
+    Snapshot snapshot;
+    snapshot.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+    snapshot.allocation_count = allocation_count_.load(std::memory_order_relaxed);
+    snapshot.freed_bytes = freed_bytes_.load(std::memory_order_relaxed);
+    snapshot.free_count = free_count_.load(std::memory_order_relaxed);
+    snapshot.tlab_refills = tlab_refills_.load(std::memory_order_relaxed);
+    snapshot.lock_acquisitions = lock_acquisitions_.load(std::memory_order_relaxed);
+    return snapshot;
+  }
+
+  // Dump the counters on a single line, without a trailing newline.
+  void Dump(std::ostream& os) const;
+
+ private:
+  std::atomic<uint64_t> allocated_bytes_{0u};
+  std::atomic<uint64_t> allocation_count_{0u};
+  std::atomic<uint64_t> freed_bytes_{0u};
+  std::atomic<uint64_t> free_count_{0u};
+  std::atomic<uint64_t> tlab_refills_{0u};
+  std::atomic<uint64_t> lock_acquisitions_{0u};
+
+  DISALLOW_COPY_AND_ASSIGN(SpaceTelemetry);
+};
+
+}  // namespace space
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_SPACE_SPACE_TELEMETRY_H_
@@ -19,6 +19,8 @@
 
 #include "handle_scope.h"
 
+#include <new>
+
 #include "base/mutex.h"
 #include "handle.h"
 #include "handle_wrapper.h"
@@ -207,16 +209,52 @@ inline MutableHandle<T> VariableSizedHandleScope::NewHandle(T* object) {
 template<class MirrorType>
 inline MutableHandle<MirrorType> VariableSizedHandleScope::NewHandle(ObjPtr<MirrorType> ptr) {
   if (current_scope_->RemainingSlots() == 0) {
-    current_scope_ = new LocalScopeType(current_scope_);
+    current_scope_ = new (AcquireLocalScopeStorage()) LocalScopeType(current_scope_);
   }
   return current_scope_->NewHandle(ptr);
 }
 
+inline void* VariableSizedHandleScope::AcquireLocalScopeStorage() {
+  void* storage = spare_storage_;
+  if (storage != nullptr) {
+    spare_storage_ = *reinterpret_cast<void**>(storage);
+    --num_spare_blocks_;
+    return storage;
+  }
+  storage = self_->TryPopHandleScopeStorage();
+  if (storage != nullptr) {
+    return storage;
+  }
+  return ::operator new(kLocalScopeSize);
+}
+
+inline void VariableSizedHandleScope::ReleaseLocalScopeStorage(void* storage) {
+  if (!self_->TryPushHandleScopeStorage(storage)) {
+    ::operator delete(storage);
+  }
+}
+
+inline void VariableSizedHandleScope::Reserve(size_t num_handles) {
+  size_t available = current_scope_->RemainingSlots() + num_spare_blocks_ * kNumReferencesPerScope;
+  while (available < num_handles) {
+    void* storage = self_->TryPopHandleScopeStorage();
+    if (storage == nullptr) {
+      storage = ::operator new(kLocalScopeSize);
+    }
+    *reinterpret_cast<void**>(storage) = spare_storage_;
+    spare_storage_ = storage;
+    ++num_spare_blocks_;
+    available += kNumReferencesPerScope;
+  }
+}
+
 inline VariableSizedHandleScope::VariableSizedHandleScope(Thread* const self)
     : BaseHandleScope(self->GetTopHandleScope()),
       self_(self),
       current_scope_(&first_scope_),
-      first_scope_(/*link=*/ nullptr) {
+      first_scope_(/*link=*/ nullptr),
+      spare_storage_(nullptr),
+      num_spare_blocks_(0u) {
   DCHECK_EQ(self, Thread::Current());
   if (kDebugLocking) {
     Locks::mutator_lock_->AssertSharedHeld(self_);
@@ -230,12 +268,18 @@ inline VariableSizedHandleScope::~VariableSizedHandleScope() {
   }
   BaseHandleScope* top_handle_scope = self_->PopHandleScope();
   DCHECK_EQ(top_handle_scope, this);
-  // Don't delete first_scope_ since it is not heap allocated.
+  // Don't release first_scope_ since it is not heap allocated.
   while (current_scope_ != &first_scope_) {
     LocalScopeType* next = down_cast<LocalScopeType*>(current_scope_->GetLink());
-    delete current_scope_;
+    current_scope_->~LocalScopeType();
+    ReleaseLocalScopeStorage(current_scope_);
     current_scope_ = next;
   }
+  while (spare_storage_ != nullptr) {
+    void* storage = spare_storage_;
+    spare_storage_ = *reinterpret_cast<void**>(storage);
+    ReleaseLocalScopeStorage(storage);
+  }
 }
 
 inline uint32_t VariableSizedHandleScope::NumberOfReferences() const {
@@ -253,6 +253,12 @@ class VariableSizedHandleScope : public BaseHandleScope {
   MutableHandle<MirrorType> NewHandle(ObjPtr<MirrorType> ptr)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Ensure that at least `num_handles` further calls to NewHandle() will not
+  // allocate: acquires enough local scope storage up front, preferring blocks
+  // recycled through the owning thread's cache. Useful for JNI bridge code that
+  // knows the number of references it will handlerize before doing the work.
+  ALWAYS_INLINE void Reserve(size_t num_handles) REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Number of references contained within this handle scope.
   ALWAYS_INLINE uint32_t NumberOfReferences() const;
 
@@ -262,6 +268,13 @@ class VariableSizedHandleScope : public BaseHandleScope {
   void VisitRoots(Visitor& visitor) REQUIRES_SHARED(Locks::mutator_lock_);
 
  private:
+  // Take storage for a new local scope, preferring reserved blocks, then the
+  // thread's recycled-block cache, then the heap.
+  ALWAYS_INLINE void* AcquireLocalScopeStorage();
+
+  // Return a storage block to the thread's cache, freeing it if the cache is full.
+  ALWAYS_INLINE void ReleaseLocalScopeStorage(void* storage);
+
   static constexpr size_t kLocalScopeSize = 64u;
   static constexpr size_t kSizeOfReferencesPerScope =
       kLocalScopeSize
@@ -279,6 +292,11 @@ class VariableSizedHandleScope : public BaseHandleScope {
   LocalScopeType* current_scope_;
   LocalScopeType first_scope_;
 
+  // Chain of raw storage blocks acquired by Reserve() but not yet holding a
+  // constructed scope, linked through their first word. Never visited by GC.
+  void* spare_storage_;
+  size_t num_spare_blocks_;
+
   DISALLOW_COPY_AND_ASSIGN(VariableSizedHandleScope);
 };
 
@@ -120,4 +120,29 @@ TEST_F(HandleScopeTest, VariableSized) {
   }
 }
 
+// Test that reserving capacity up front and recycling local scope storage
+// through the thread keeps variable sized handle scopes working.
+TEST_F(HandleScopeTest, VariableSizedReserve) {
+  ScopedObjectAccess soa(Thread::Current());
+  ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
+  static const size_t kNumHandles = 100;
+  // Run twice so the second scope draws on storage recycled by the first.
+  for (size_t iteration = 0; iteration != 2u; ++iteration) {
+    VariableSizedHandleScope hs(soa.Self());
+    hs.Reserve(kNumHandles);
+    Handle<mirror::Class> c =
+        hs.NewHandle(class_linker->FindSystemClass(soa.Self(), "Ljava/lang/Object;"));
+    std::vector<Handle<mirror::Object>> handles;
+    for (size_t i = 0; i < kNumHandles; ++i) {
+      ObjPtr<mirror::Object> o = c->AllocObject(soa.Self());
+      handles.push_back(hs.NewHandle(o));
+      EXPECT_OBJ_PTR_EQ(o, handles.back().Get());
+      EXPECT_TRUE(hs.Contains(handles.back().GetReference()));
+    }
+    CollectVisitor visitor;
+    hs.VisitRoots(visitor);
+    EXPECT_EQ(visitor.total_visited, hs.NumberOfReferences());
+  }
+}
+
 }  // namespace art
@@ -667,6 +667,73 @@ template bool ShouldDenyAccessToMemberImpl<ArtMethod>(ArtMethod* member,
                                                       AccessMethod access_method);
 }  // namespace detail
 
+// Fixed-size open-addressing cache of members whose access was recently allowed
+// for a given caller domain. ShouldDenyAccessToMember() probes it once the
+// caller context is known, ahead of the expensive tail (exemption list
+// matching, the O(N) dex flag decode and the policy evaluation). Only allowed
+// results are cached, so denials keep their per-access warnings, listener
+// notifications and event logs. Each entry is a single word - the member
+// pointer with the caller domain packed into its alignment bits - so reads are
+// lock-free and a torn entry cannot exist. The staleness rules match the
+// existing kAccPublicApi self-memoization: exemption list updates only ever add
+// allowed members, and the cache is flushed when a class loader is deleted so a
+// reused member pointer cannot inherit an old allow.
+static constexpr size_t kAllowedAccessCacheSize = 1024u;  // Power of two.
+static constexpr size_t kAllowedAccessCacheMaxProbes = 8u;
+static std::atomic<uintptr_t> g_allowed_access_cache[kAllowedAccessCacheSize];
+
+static uintptr_t AllowedAccessKey(void* member, Domain domain) {
+  uintptr_t ptr = reinterpret_cast<uintptr_t>(member);
+  // ArtField and ArtMethod are at least 4-byte aligned, leaving room for the
+  // three domain values in the low bits.
+  DCHECK_ALIGNED(member, 4u);
+  DCHECK_LT(static_cast<uintptr_t>(domain), 4u);
+  return ptr | static_cast<uintptr_t>(domain);
+}
+
+static size_t AllowedAccessIndex(uintptr_t key) {
+  return ((key >> 4) ^ (key >> 14)) & (kAllowedAccessCacheSize - 1u);
+}
+
+static bool IsAccessCachedAsAllowed(void* member, Domain domain) {
+  uintptr_t key = AllowedAccessKey(member, domain);
+  size_t index = AllowedAccessIndex(key);
+  for (size_t i = 0; i != kAllowedAccessCacheMaxProbes; ++i) {
+    uintptr_t entry = g_allowed_access_cache[index].load(std::memory_order_relaxed);
+    if (entry == key) {
+      return true;
+    }
+    if (entry == 0u) {
+      return false;
+    }
+    index = (index + 1u) & (kAllowedAccessCacheSize - 1u);
+  }
+  return false;
+}
+
+static void CacheAccessAsAllowed(void* member, Domain domain) {
+  uintptr_t key = AllowedAccessKey(member, domain);
+  size_t index = AllowedAccessIndex(key);
+  const size_t home = index;
+  for (size_t i = 0; i != kAllowedAccessCacheMaxProbes; ++i) {
+    uintptr_t entry = g_allowed_access_cache[index].load(std::memory_order_relaxed);
+    if (entry == 0u || entry == key) {
+      g_allowed_access_cache[index].store(key, std::memory_order_relaxed);
+      return;
+    }
+    index = (index + 1u) & (kAllowedAccessCacheSize - 1u);
+  }
+  // All probed slots hold other members; evict the home slot. Losing a racing
+  // store is harmless, the evicted member just re-runs the policy evaluation.
+  g_allowed_access_cache[home].store(key, std::memory_order_relaxed);
+}
+
+void FlushAllowedAccessCache() {
+  for (std::atomic<uintptr_t>& entry : g_allowed_access_cache) {
+    entry.store(0u, std::memory_order_relaxed);
+  }
+}
+
 template<typename T>
 bool ShouldDenyAccessToMember(T* member,
                               const std::function<AccessContext()>& fn_get_access_context,
@@ -715,6 +782,16 @@ bool ShouldDenyAccessToMember(T* member,
     return false;
   }
 
+  // Probe the allow cache before entering the expensive evaluation below. The
+  // key is the original member: proxy resolution happens past this point, so
+  // repeat lookups probe with the same pointer. Denials are never cached, so a
+  // hit cannot swallow a warning that a denial would have produced.
+  T* const original_member = member;
+  const Domain caller_domain = caller_context.GetDomain();
+  if (IsAccessCachedAsAllowed(original_member, caller_domain)) {
+    return false;
+  }
+
   // Check if this is platform accessing core platform. We may warn if `member` is
   // not part of core platform API.
   switch (caller_context.GetDomain()) {
@@ -737,7 +814,14 @@ bool ShouldDenyAccessToMember(T* member,
       DCHECK(api_list.IsValid());
 
       // Member is hidden and caller is not exempted. Enter slow path.
-      return detail::ShouldDenyAccessToMemberImpl(member, api_list, access_method);
+      bool deny_access = detail::ShouldDenyAccessToMemberImpl(member, api_list, access_method);
+      if (!deny_access) {
+        // Memoize the allow so repeated reflective access is a single hash
+        // probe. Like the kAccPublicApi update for debuggable apps above, this
+        // makes allowed members warn-once.
+        CacheAccessAsAllowed(original_member, caller_domain);
+      }
+      return deny_access;
     }
 
     case Domain::kPlatform: {
@@ -396,6 +396,11 @@ ALWAYS_INLINE inline uint32_t GetRuntimeFlags(ArtMethod* method)
 // location and class loader.
 void InitializeDexFileDomain(const DexFile& dex_file, ObjPtr<mirror::ClassLoader> class_loader);
 
+// Flushes the allow-result memoization cache used by ShouldDenyAccessToMember().
+// Called when a class loader is deleted so that a member later allocated at the
+// same address cannot inherit a stale allow decision.
+void FlushAllowedAccessCache();
+
 // Returns true if access to `member` should be denied in the given context.
 // The decision is based on whether the caller is in a trusted context or not.
 // Because determining the access context can be expensive, a lambda function
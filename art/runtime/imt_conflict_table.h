@@ -18,6 +18,7 @@
 #define ART_RUNTIME_IMT_CONFLICT_TABLE_H_
 
 #include <cstddef>
+#include <functional>
 
 #include "base/casts.h"
 #include "base/enums.h"
@@ -29,9 +30,16 @@ class ArtMethod;
 
 // Table to resolve IMT conflicts at runtime. The table is attached to
 // the jni entrypoint of IMT conflict ArtMethods.
-// The table contains a list of pairs of { interface_method, implementation_method }
-// with the last entry being null to make an assembly implementation of a lookup
-// faster.
+// The layout is, in { interface_method, implementation_method } sized slots:
+//   [0]        header: { kHeaderMarker, number of entries }
+//   [1..n]     entries sorted by interface method pointer
+//   [n + 1]    terminator: { null, last-hit cache }
+// The assembly stubs scan the table linearly and stop at a null interface
+// method, so they skip the header (the marker is never null and never equal
+// to a real ArtMethod*) and never read the header count, the last-hit slot
+// or any slot past the terminator. The C++ Lookup() uses the header count
+// for a binary search over the sorted entries and consults the last-hit
+// cache first, so large tables are no longer walked linearly.
 class ImtConflictTable {
   enum MethodIndex {
     kMethodInterface,
@@ -47,46 +55,86 @@ class ImtConflictTable {
                    ArtMethod* implementation_method,
                    PointerSize pointer_size) {
     const size_t count = other->NumEntries(pointer_size);
-    for (size_t i = 0; i < count; ++i) {
+    SetHeader(count + 1u, pointer_size);
+    // Keep entries sorted by interface method pointer.
+    size_t insert_pos = 0;
+    while (insert_pos != count &&
+           std::less<ArtMethod*>()(other->GetInterfaceMethod(insert_pos, pointer_size),
+                                   interface_method)) {
+      ++insert_pos;
+    }
+    for (size_t i = 0; i < insert_pos; ++i) {
       SetInterfaceMethod(i, pointer_size, other->GetInterfaceMethod(i, pointer_size));
       SetImplementationMethod(i, pointer_size, other->GetImplementationMethod(i, pointer_size));
     }
-    SetInterfaceMethod(count, pointer_size, interface_method);
-    SetImplementationMethod(count, pointer_size, implementation_method);
-    // Add the null marker.
-    SetInterfaceMethod(count + 1, pointer_size, nullptr);
-    SetImplementationMethod(count + 1, pointer_size, nullptr);
+    SetInterfaceMethod(insert_pos, pointer_size, interface_method);
+    SetImplementationMethod(insert_pos, pointer_size, implementation_method);
+    for (size_t i = insert_pos; i < count; ++i) {
+      SetInterfaceMethod(i + 1u, pointer_size, other->GetInterfaceMethod(i, pointer_size));
+      SetImplementationMethod(i + 1u, pointer_size, other->GetImplementationMethod(i, pointer_size));
+    }
+    // Add the null marker. This also clears the last-hit cache slot.
+    SetInterfaceMethod(count + 1u, pointer_size, nullptr);
+    SetImplementationMethod(count + 1u, pointer_size, nullptr);
   }
 
-  // num_entries excludes the header.
-  ImtConflictTable(size_t num_entries, PointerSize pointer_size) {
-    SetInterfaceMethod(num_entries, pointer_size, nullptr);
-    SetImplementationMethod(num_entries, pointer_size, nullptr);
+  // num_entries excludes the header and terminator. The table starts out empty;
+  // entries are added with `AddEntrySorted()`.
+  ImtConflictTable(size_t num_entries ATTRIBUTE_UNUSED, PointerSize pointer_size) {
+    SetHeader(0u, pointer_size);
+    // Add the null marker.
+    SetInterfaceMethod(0u, pointer_size, nullptr);
+    SetImplementationMethod(0u, pointer_size, nullptr);
   }
 
   // Set an entry at an index.
   void SetInterfaceMethod(size_t index, PointerSize pointer_size, ArtMethod* method) {
-    SetMethod(index * kMethodCount + kMethodInterface, pointer_size, method);
+    SetMethod((index + 1u) * kMethodCount + kMethodInterface, pointer_size, method);
   }
 
   void SetImplementationMethod(size_t index, PointerSize pointer_size, ArtMethod* method) {
-    SetMethod(index * kMethodCount + kMethodImplementation, pointer_size, method);
+    SetMethod((index + 1u) * kMethodCount + kMethodImplementation, pointer_size, method);
   }
 
   ArtMethod* GetInterfaceMethod(size_t index, PointerSize pointer_size) const {
-    return GetMethod(index * kMethodCount + kMethodInterface, pointer_size);
+    return GetMethod((index + 1u) * kMethodCount + kMethodInterface, pointer_size);
   }
 
   ArtMethod* GetImplementationMethod(size_t index, PointerSize pointer_size) const {
-    return GetMethod(index * kMethodCount + kMethodImplementation, pointer_size);
+    return GetMethod((index + 1u) * kMethodCount + kMethodImplementation, pointer_size);
   }
 
   void** AddressOfInterfaceMethod(size_t index, PointerSize pointer_size) {
-    return AddressOfMethod(index * kMethodCount + kMethodInterface, pointer_size);
+    return AddressOfMethod((index + 1u) * kMethodCount + kMethodInterface, pointer_size);
   }
 
   void** AddressOfImplementationMethod(size_t index, PointerSize pointer_size) {
-    return AddressOfMethod(index * kMethodCount + kMethodImplementation, pointer_size);
+    return AddressOfMethod((index + 1u) * kMethodCount + kMethodImplementation, pointer_size);
+  }
+
+  // Add an entry keeping the entries sorted by interface method pointer. Only
+  // valid for tables that are not yet visible to other threads as entries are
+  // shifted in place.
+  void AddEntrySorted(ArtMethod* interface_method,
+                      ArtMethod* implementation_method,
+                      PointerSize pointer_size) {
+    const size_t count = NumEntries(pointer_size);
+    size_t insert_pos = count;
+    while (insert_pos != 0u &&
+           std::less<ArtMethod*>()(interface_method,
+                                   GetInterfaceMethod(insert_pos - 1u, pointer_size))) {
+      SetInterfaceMethod(insert_pos, pointer_size,
+                         GetInterfaceMethod(insert_pos - 1u, pointer_size));
+      SetImplementationMethod(insert_pos, pointer_size,
+                              GetImplementationMethod(insert_pos - 1u, pointer_size));
+      --insert_pos;
+    }
+    SetInterfaceMethod(insert_pos, pointer_size, interface_method);
+    SetImplementationMethod(insert_pos, pointer_size, implementation_method);
+    SetCount(count + 1u, pointer_size);
+    // Rewrite the null marker. This also clears the last-hit cache slot.
+    SetInterfaceMethod(count + 1u, pointer_size, nullptr);
+    SetImplementationMethod(count + 1u, pointer_size, nullptr);
   }
 
   // Return true if two conflict tables are the same.
@@ -110,12 +158,10 @@ class ImtConflictTable {
   // and also returns one. The order is <interface, implementation>.
   template<typename Visitor>
   void Visit(const Visitor& visitor, PointerSize pointer_size) NO_THREAD_SAFETY_ANALYSIS {
-    uint32_t table_index = 0;
-    for (;;) {
+    const size_t count = NumEntries(pointer_size);
+    for (size_t table_index = 0; table_index < count; ++table_index) {
       ArtMethod* interface_method = GetInterfaceMethod(table_index, pointer_size);
-      if (interface_method == nullptr) {
-        break;
-      }
+      DCHECK(interface_method != nullptr);
       ArtMethod* implementation_method = GetImplementationMethod(table_index, pointer_size);
       auto input = std::make_pair(interface_method, implementation_method);
       std::pair<ArtMethod*, ArtMethod*> updated = visitor(input);
@@ -125,39 +171,49 @@ class ImtConflictTable {
       if (input.second != updated.second) {
         SetImplementationMethod(table_index, pointer_size, updated.second);
       }
-      ++table_index;
     }
   }
 
   // Lookup the implementation ArtMethod associated to `interface_method`. Return null
   // if not found.
   ArtMethod* Lookup(ArtMethod* interface_method, PointerSize pointer_size) const {
-    uint32_t table_index = 0;
-    for (;;) {
-      ArtMethod* current_interface_method = GetInterfaceMethod(table_index, pointer_size);
-      if (current_interface_method == nullptr) {
-        break;
+    const size_t count = NumEntries(pointer_size);
+    // Consult the one-entry last-hit cache first. The slot holds a biased index
+    // (0 means empty) and is updated racily; any stale value at most costs one
+    // extra comparison, the bound check makes a torn table size benign.
+    const size_t last_hit = GetLastHitIndex(count, pointer_size);
+    if (last_hit != 0u &&
+        last_hit <= count &&
+        GetInterfaceMethod(last_hit - 1u, pointer_size) == interface_method) {
+      return GetImplementationMethod(last_hit - 1u, pointer_size);
+    }
+    // Entries are sorted by interface method pointer, binary search.
+    size_t lo = 0u;
+    size_t hi = count;
+    while (lo != hi) {
+      const size_t mid = lo + (hi - lo) / 2u;
+      ArtMethod* entry = GetInterfaceMethod(mid, pointer_size);
+      if (entry == interface_method) {
+        SetLastHitIndex(count, pointer_size, mid + 1u);
+        return GetImplementationMethod(mid, pointer_size);
       }
-      if (current_interface_method == interface_method) {
-        return GetImplementationMethod(table_index, pointer_size);
+      if (std::less<ArtMethod*>()(entry, interface_method)) {
+        lo = mid + 1u;
+      } else {
+        hi = mid;
       }
-      ++table_index;
     }
     return nullptr;
   }
 
-  // Compute the number of entries in this table.
+  // Return the number of entries in this table, excluding the header and terminator.
   size_t NumEntries(PointerSize pointer_size) const {
-    uint32_t table_index = 0;
-    while (GetInterfaceMethod(table_index, pointer_size) != nullptr) {
-      ++table_index;
-    }
-    return table_index;
+    return GetRawData(kMethodImplementation, pointer_size);
   }
 
   // Compute the size in bytes taken by this table.
   size_t ComputeSize(PointerSize pointer_size) const {
-    // Add the end marker.
+    // Add the header and the end marker.
     return ComputeSize(NumEntries(pointer_size), pointer_size);
   }
 
@@ -169,7 +225,8 @@ class ImtConflictTable {
 
   // Compute size with a fixed number of entries.
   static size_t ComputeSize(size_t num_entries, PointerSize pointer_size) {
-    return (num_entries + 1) * EntrySize(pointer_size);  // Add one for null terminator.
+    // Add one entry for the header and one for the null terminator.
+    return (num_entries + 2) * EntrySize(pointer_size);
   }
 
   static size_t EntrySize(PointerSize pointer_size) {
@@ -177,6 +234,35 @@ class ImtConflictTable {
   }
 
  private:
+  // Value stored in the interface method slot of the header. Never null, so the
+  // assembly stubs do not stop at the header, and never equal to a real
+  // ArtMethod*, so they never match it either.
+  static constexpr uintptr_t kHeaderMarker = 1u;
+
+  void SetHeader(size_t count, PointerSize pointer_size) {
+    SetRawData(kMethodInterface, pointer_size, kHeaderMarker);
+    SetRawData(kMethodImplementation, pointer_size, count);
+  }
+
+  void SetCount(size_t count, PointerSize pointer_size) {
+    SetRawData(kMethodImplementation, pointer_size, count);
+  }
+
+  // The last-hit cache lives in the unused implementation method slot of the
+  // null terminator, so it needs no extra space and stays invisible to the
+  // assembly stubs and to Visit().
+  size_t GetLastHitIndex(size_t count, PointerSize pointer_size) const {
+    // The terminator is the (count + 1)-th pair, after the header and `count` entries.
+    return GetRawData((count + 1u) * kMethodCount + kMethodImplementation, pointer_size);
+  }
+
+  // Updating the cache is logically const; concurrent lookups may race on the
+  // single-word slot, losing an update is harmless.
+  void SetLastHitIndex(size_t count, PointerSize pointer_size, size_t value) const {
+    const_cast<ImtConflictTable*>(this)->SetRawData(
+        (count + 1u) * kMethodCount + kMethodImplementation, pointer_size, value);
+  }
+
   void** AddressOfMethod(size_t index, PointerSize pointer_size) {
     if (pointer_size == PointerSize::k64) {
       return reinterpret_cast<void**>(&data64_[index]);
@@ -201,6 +287,22 @@ class ImtConflictTable {
     }
   }
 
+  size_t GetRawData(size_t index, PointerSize pointer_size) const {
+    if (pointer_size == PointerSize::k64) {
+      return static_cast<size_t>(data64_[index]);
+    } else {
+      return static_cast<size_t>(data32_[index]);
+    }
+  }
+
+  void SetRawData(size_t index, PointerSize pointer_size, size_t value) {
+    if (pointer_size == PointerSize::k64) {
+      data64_[index] = static_cast<uint64_t>(value);
+    } else {
+      data32_[index] = dchecked_integral_cast<uint32_t>(value);
+    }
+  }
+
   // Array of entries that the assembly stubs will iterate over. Note that this is
   // not fixed size, and we allocate data prior to calling the constructor
   // of ImtConflictTable.
@@ -271,6 +271,14 @@ static inline void CheckHoleCount(IrtEntry* table,
   }
 }
 
+// On 64-bit targets we reserve the maximum table size up front the first time a table
+// outgrows the small IRT, so that all further growth just publishes more entries of the
+// existing mapping: no copying, no table move, and no mmap/munmap at unpredictable points
+// in JNI-heavy threads. The reservation is anonymous memory, so untouched pages cost only
+// virtual address space. 32-bit address space is too tight for this, so the copying
+// growth path is kept there.
+static constexpr bool kIrtOverReserve = sizeof(void*) == 8u;
+
 bool IndirectReferenceTable::Resize(size_t new_size, std::string* error_msg) {
   CHECK_GT(new_size, max_entries_);
 
@@ -282,8 +290,22 @@ bool IndirectReferenceTable::Resize(size_t new_size, std::string* error_msg) {
   // Note: the above check also ensures that there is no overflow below.
 
   const size_t table_bytes = RoundUp(new_size * sizeof(IrtEntry), kPageSize);
+  if (table_mem_map_.IsValid() && table_bytes <= table_mem_map_.BaseSize()) {
+    // Growing within a previously made reservation. The table does not move, so there is
+    // nothing to copy and outstanding IndirectRefs remain valid.
+    max_entries_ = table_bytes / sizeof(IrtEntry);
+    DCHECK_GE(max_entries_, new_size);
+    return true;
+  }
 
-  MemMap new_map = NewIRTMap(table_bytes, error_msg);
+  const size_t map_bytes = kIrtOverReserve ? kMaxTableSizeInBytes : table_bytes;
+  MemMap new_map = NewIRTMap(map_bytes, error_msg);
+  if (!new_map.IsValid() && kIrtOverReserve) {
+    // The full reservation may legitimately fail under address space pressure; retry with
+    // the exact requested size before giving up.
+    error_msg->clear();
+    new_map = NewIRTMap(table_bytes, error_msg);
+  }
   if (!new_map.IsValid()) {
     return false;
   }
@@ -16,6 +16,9 @@
 
 #include "instrumentation.h"
 
+#include <unistd.h>
+
+#include <algorithm>
 #include <functional>
 #include <optional>
 #include <sstream>
@@ -27,6 +30,7 @@
 #include "art_method-inl.h"
 #include "base/atomic.h"
 #include "base/callee_save_type.h"
+#include "base/systrace.h"
 #include "class_linker.h"
 #include "debugger.h"
 #include "dex/dex_file-inl.h"
@@ -35,6 +39,7 @@
 #include "entrypoints/quick/quick_alloc_entrypoints.h"
 #include "entrypoints/quick/quick_entrypoints.h"
 #include "entrypoints/runtime_asm_entrypoints.h"
+#include "gc/scoped_gc_critical_section.h"
 #include "gc_root-inl.h"
 #include "interpreter/interpreter.h"
 #include "interpreter/interpreter_common.h"
@@ -51,6 +56,7 @@
 #include "oat_file_manager.h"
 #include "oat_quick_method_header.h"
 #include "runtime-inl.h"
+#include "stack.h"
 #include "thread.h"
 #include "thread_list.h"
 
@@ -185,7 +191,10 @@ Instrumentation::Instrumentation()
       deoptimized_methods_lock_(new ReaderWriterMutex("deoptimized methods lock",
                                                       kGenericBottomLock)),
       quick_alloc_entry_points_instrumentation_counter_(0),
-      alloc_entrypoints_instrumented_(false) {
+      alloc_entrypoints_instrumented_(false),
+      method_sample_counters_(nullptr),
+      method_sampling_pthread_(0U),
+      method_sampling_interval_us_(0u) {
 }
 
 void Instrumentation::InstallStubsForClass(ObjPtr<mirror::Class> klass) {
@@ -1264,6 +1273,167 @@ void Instrumentation::DisableMethodTracing(const char* key) {
   ConfigureStubs(key, InstrumentationLevel::kInstrumentNothing);
 }
 
+// Fixed-size, open-addressed table of per-method hit counters. The hot path (bumping the
+// counter of an already-seen method) is a relaxed fetch_add and therefore lock-free. A
+// slot is claimed at most once, by the sampling thread with all other threads suspended,
+// by publishing the method pointer with release order after recording its name; dumping
+// only reads names of published slots, so it never dereferences an ArtMethod that may
+// have been unloaded since it was sampled. A method unloaded and another allocated at
+// the same address merge into one slot, which is acceptable for sampled data.
+class Instrumentation::MethodSampleCounters {
+ public:
+  static constexpr size_t kNumSlots = 2048u;  // Sized for hot code; overflow is counted.
+  static constexpr size_t kMaxProbes = 16u;
+
+  void Hit(ArtMethod* method) REQUIRES_SHARED(Locks::mutator_lock_) {
+    static_assert(IsPowerOfTwo(kNumSlots), "slot index is computed by masking");
+    size_t slot = (reinterpret_cast<uintptr_t>(method) >> 4) & (kNumSlots - 1u);
+    for (size_t probe = 0u; probe != kMaxProbes; ++probe, slot = (slot + 1u) & (kNumSlots - 1u)) {
+      ArtMethod* entry = methods_[slot].load(std::memory_order_acquire);
+      if (entry == nullptr) {
+        // Claim the slot. Only the sampling thread writes, and it runs with the world
+        // stopped, so there is no competing claim.
+        names_[slot] = method->PrettyMethod();
+        methods_[slot].store(method, std::memory_order_release);
+        entry = method;
+      }
+      if (entry == method) {
+        counts_[slot].fetch_add(1u, std::memory_order_relaxed);
+        return;
+      }
+    }
+    dropped_.fetch_add(1u, std::memory_order_relaxed);
+  }
+
+  void Dump(std::ostream& os) const {
+    std::vector<std::pair<uint64_t, const std::string*>> hits;
+    for (size_t slot = 0u; slot != kNumSlots; ++slot) {
+      if (methods_[slot].load(std::memory_order_acquire) != nullptr) {
+        uint64_t count = counts_[slot].load(std::memory_order_relaxed);
+        if (count != 0u) {
+          hits.emplace_back(count, &names_[slot]);
+        }
+      }
+    }
+    std::sort(hits.begin(), hits.end(), [](const auto& lhs, const auto& rhs) {
+      return lhs.first > rhs.first;
+    });
+    for (const auto& hit : hits) {
+      os << "  " << hit.first << " " << *hit.second << "\n";
+    }
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != 0u) {
+      os << "  (" << dropped << " samples dropped because the counter table was full)\n";
+    }
+  }
+
+ private:
+  std::atomic<ArtMethod*> methods_[kNumSlots] = {};
+  std::atomic<uint64_t> counts_[kNumSlots] = {};
+  std::string names_[kNumSlots];
+  std::atomic<uint64_t> dropped_{0u};
+};
+
+void Instrumentation::SampleThreadStack(Thread* thread, void* arg) {
+  MethodSampleCounters* counters = reinterpret_cast<MethodSampleCounters*>(arg);
+  StackVisitor::WalkStack(
+      [&](const StackVisitor* stack_visitor) REQUIRES_SHARED(Locks::mutator_lock_) {
+        ArtMethod* m = stack_visitor->GetMethod();
+        // Ignore runtime frames (in particular callee save).
+        if (m != nullptr && !m->IsRuntimeMethod()) {
+          counters->Hit(m);
+        }
+        return true;
+      },
+      thread,
+      /* context= */ nullptr,
+      StackVisitor::StackWalkKind::kIncludeInlinedFrames);
+}
+
+void* Instrumentation::RunMethodSamplingThread(void* arg) {
+  Runtime* runtime = Runtime::Current();
+  Instrumentation* instrumentation = reinterpret_cast<Instrumentation*>(arg);
+  CHECK(runtime->AttachCurrentThread("Method Sampling",
+                                     true,
+                                     runtime->GetSystemThreadGroup(),
+                                     !runtime->IsAotCompiler()));
+
+  while (true) {
+    uint64_t interval_us =
+        instrumentation->method_sampling_interval_us_.load(std::memory_order_acquire);
+    if (interval_us == 0u) {
+      break;
+    }
+    usleep(interval_us);
+    ScopedTrace trace("Method sampling");
+    Thread* self = Thread::Current();
+    MethodSampleCounters* counters;
+    {
+      MutexLock mu(self, *Locks::trace_lock_);
+      counters = instrumentation->method_sample_counters_;
+    }
+    // Avoid a deadlock between a thread doing garbage collection and the sampling thread,
+    // by blocking GC when sampling thread stacks (see b/73624630).
+    gc::ScopedGCCriticalSection gcs(self,
+                                    gc::kGcCauseInstrumentation,
+                                    gc::kCollectorTypeInstrumentation);
+    ScopedSuspendAll ssa(__FUNCTION__);
+    MutexLock mu(self, *Locks::thread_list_lock_);
+    runtime->GetThreadList()->ForEach(SampleThreadStack, counters);
+  }
+
+  runtime->DetachCurrentThread();
+  return nullptr;
+}
+
+void Instrumentation::StartMethodSampling(uint64_t interval_us) {
+  CHECK_NE(interval_us, 0u);
+  Thread* self = Thread::Current();
+  MutexLock mu(self, *Locks::trace_lock_);
+  if (method_sampling_interval_us_.load(std::memory_order_relaxed) != 0u) {
+    LOG(WARNING) << "Method sampling already in progress, ignoring this request";
+    return;
+  }
+  if (method_sample_counters_ == nullptr) {
+    method_sample_counters_ = new MethodSampleCounters();
+  }
+  method_sampling_interval_us_.store(interval_us, std::memory_order_release);
+  CHECK_PTHREAD_CALL(pthread_create,
+                     (&method_sampling_pthread_, nullptr, &RunMethodSamplingThread, this),
+                     "method sampling thread");
+}
+
+void Instrumentation::StopMethodSampling() {
+  Thread* self = Thread::Current();
+  pthread_t sampling_pthread;
+  {
+    MutexLock mu(self, *Locks::trace_lock_);
+    if (method_sampling_interval_us_.load(std::memory_order_relaxed) == 0u) {
+      return;
+    }
+    method_sampling_interval_us_.store(0u, std::memory_order_release);
+    sampling_pthread = method_sampling_pthread_;
+    method_sampling_pthread_ = 0U;
+  }
+  CHECK_PTHREAD_CALL(pthread_join, (sampling_pthread, nullptr), "method sampling thread shutdown");
+}
+
+void Instrumentation::DumpMethodSamples(std::ostream& os) {
+  MethodSampleCounters* counters;
+  uint64_t interval_us;
+  {
+    MutexLock mu(Thread::Current(), *Locks::trace_lock_);
+    counters = method_sample_counters_;
+    interval_us = method_sampling_interval_us_.load(std::memory_order_relaxed);
+  }
+  if (counters == nullptr) {
+    // Sampling was never started; keep the SIGQUIT dump noise-free.
+    return;
+  }
+  os << "Method sampling hits" << ((interval_us != 0u) ? " (sampling active):\n" : ":\n");
+  counters->Dump(os);
+}
+
 const void* Instrumentation::GetCodeForInvoke(ArtMethod* method) {
   // This is called by instrumentation and resolution trampolines
   // and that should never be getting proxy methods.
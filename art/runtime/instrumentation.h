@@ -17,8 +17,10 @@
 #ifndef ART_RUNTIME_INSTRUMENTATION_H_
 #define ART_RUNTIME_INSTRUMENTATION_H_
 
+#include <pthread.h>
 #include <stdint.h>
 
+#include <atomic>
 #include <functional>
 #include <list>
 #include <memory>
@@ -280,6 +282,16 @@ class Instrumentation {
                !Locks::classlinker_classes_lock_,
                !GetDeoptimizedMethodsLock());
 
+  // Start/stop sampling-based method profiling. Unlike the entry/exit listeners this does
+  // not install any stubs: a timer-driven thread periodically suspends the runtime, walks
+  // every thread's stack and bumps a per-method hit counter, so it is cheap enough to stay
+  // enabled in production. The counters are harvested by DumpMethodSamples() as part of
+  // the SIGQUIT dump.
+  void StartMethodSampling(uint64_t interval_us)
+      REQUIRES(!Locks::mutator_lock_, !Locks::trace_lock_);
+  void StopMethodSampling() REQUIRES(!Locks::mutator_lock_, !Locks::trace_lock_);
+  void DumpMethodSamples(std::ostream& os);
+
 
   void InstrumentQuickAllocEntryPoints() REQUIRES(!Locks::instrument_entrypoints_lock_);
   void UninstrumentQuickAllocEntryPoints() REQUIRES(!Locks::instrument_entrypoints_lock_);
@@ -732,6 +744,21 @@ class Instrumentation {
   // alloc_entrypoints_instrumented_ change during suspend points.
   bool alloc_entrypoints_instrumented_;
 
+  // Body of the sampling profiler thread; `arg` is the Instrumentation instance.
+  static void* RunMethodSamplingThread(void* arg) REQUIRES(!Locks::trace_lock_);
+  // Walks `thread`'s stack, bumping the hit counter of every non-runtime frame. Called
+  // through ThreadList::ForEach with all threads suspended.
+  static void SampleThreadStack(Thread* thread, void* arg)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Sampling profiler state. The counter table is allocated when sampling first starts
+  // and kept for the lifetime of the runtime so that dumps after stopping remain valid.
+  class MethodSampleCounters;
+  MethodSampleCounters* method_sample_counters_ GUARDED_BY(Locks::trace_lock_);
+  pthread_t method_sampling_pthread_ GUARDED_BY(Locks::trace_lock_);
+  // Interval between samples; storing zero tells the sampling thread to exit.
+  std::atomic<uint64_t> method_sampling_interval_us_;
+
   friend class InstrumentationTest;  // For GetCurrentInstrumentationLevel and ConfigureStubs.
   friend class InstrumentationStackPopper;  // For popping instrumentation frames.
   friend void InstrumentationInstallStack(Thread*, void*, bool);
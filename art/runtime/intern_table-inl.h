@@ -138,20 +138,22 @@ inline void InternTable::Table::AddInternStrings(UnorderedSet&& intern_strings,
   // Keep the order of previous frozen tables unchanged, so that we can can remember
   // the number of searched frozen tables and not search them again.
   DCHECK(!tables_.empty());
-  tables_.insert(tables_.end() - 1, InternalTable(std::move(intern_strings), is_boot_image));
+  tables_.insert(tables_.end() - 1,
+                 std::make_unique<InternalTable>(std::move(intern_strings), is_boot_image));
+  PublishFrozenViewLocked();
 }
 
 template <typename Visitor>
 inline void InternTable::VisitInterns(const Visitor& visitor,
                                       bool visit_boot_images,
                                       bool visit_non_boot_images) {
-  auto visit_tables = [&](dchecked_vector<Table::InternalTable>& tables)
+  auto visit_tables = [&](dchecked_vector<std::unique_ptr<Table::InternalTable>>& tables)
       NO_THREAD_SAFETY_ANALYSIS {
-    for (Table::InternalTable& table : tables) {
+    for (const std::unique_ptr<Table::InternalTable>& table : tables) {
       // Determine if we want to visit the table based on the flags.
-      const bool visit = table.IsBootImage() ? visit_boot_images : visit_non_boot_images;
+      const bool visit = table->IsBootImage() ? visit_boot_images : visit_non_boot_images;
       if (visit) {
-        for (auto& intern : table.set_) {
+        for (auto& intern : table->set_) {
           visitor(intern);
         }
       }
@@ -163,13 +165,13 @@ inline void InternTable::VisitInterns(const Visitor& visitor,
 
 inline size_t InternTable::CountInterns(bool visit_boot_images, bool visit_non_boot_images) const {
   size_t ret = 0u;
-  auto visit_tables = [&](const dchecked_vector<Table::InternalTable>& tables)
+  auto visit_tables = [&](const dchecked_vector<std::unique_ptr<Table::InternalTable>>& tables)
       NO_THREAD_SAFETY_ANALYSIS {
-    for (const Table::InternalTable& table : tables) {
+    for (const std::unique_ptr<Table::InternalTable>& table : tables) {
       // Determine if we want to visit the table based on the flags.
-      const bool visit = table.IsBootImage() ? visit_boot_images : visit_non_boot_images;
+      const bool visit = table->IsBootImage() ? visit_boot_images : visit_non_boot_images;
       if (visit) {
-        ret += table.set_.size();
+        ret += table->set_.size();
       }
     }
   };
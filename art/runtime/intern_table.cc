@@ -79,9 +79,9 @@ void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
         DCHECK_EQ(hash, static_cast<uint32_t>(new_ref->GetStoredHashCode()));
         DCHECK(new_ref->Equals(old_ref));
         bool found = false;
-        for (Table::InternalTable& table : strong_interns_.tables_) {
-          auto it = table.set_.FindWithHash(GcRoot<mirror::String>(old_ref), hash);
-          if (it != table.set_.end()) {
+        for (const std::unique_ptr<Table::InternalTable>& table : strong_interns_.tables_) {
+          auto it = table->set_.FindWithHash(GcRoot<mirror::String>(old_ref), hash);
+          if (it != table->set_.end()) {
             *it = GcRoot<mirror::String>(new_ref);
             found = true;
             break;
@@ -122,8 +122,17 @@ ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
                                                  uint32_t utf16_length,
                                                  const char* utf8_data) {
   uint32_t hash = Utf8String::Hash(utf16_length, utf8_data);
+  size_t num_searched_frozen_tables = 0u;
+  if (LIKELY(!Runtime::Current()->IsAotCompiler())) {
+    ObjPtr<mirror::String> s = strong_interns_.FindFrozen(
+        Utf8String(utf16_length, utf8_data), hash, &num_searched_frozen_tables);
+    if (s != nullptr) {
+      return s;
+    }
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
-  return strong_interns_.Find(Utf8String(utf16_length, utf8_data), hash);
+  return strong_interns_.Find(
+      Utf8String(utf16_length, utf8_data), hash, num_searched_frozen_tables);
 }
 
 ObjPtr<mirror::String> InternTable::LookupWeakLocked(ObjPtr<mirror::String> s) {
@@ -254,13 +263,23 @@ ObjPtr<mirror::String> InternTable::InternStrong(uint32_t utf16_length, const ch
   uint32_t hash = Utf8String::Hash(utf16_length, utf8_data);
   Thread* self = Thread::Current();
   ObjPtr<mirror::String> s;
-  size_t num_searched_strong_frozen_tables;
+  size_t num_searched_strong_frozen_tables = 0u;
+  if (LIKELY(!Runtime::Current()->IsAotCompiler())) {
+    // Fast path: probe the frozen strong tables without taking the lock. Boot image and
+    // pre-zygote interns resolve here without ever contending with concurrent interning.
+    s = strong_interns_.FindFrozen(
+        Utf8String(utf16_length, utf8_data), hash, &num_searched_strong_frozen_tables);
+    if (s != nullptr) {
+      return s;
+    }
+  }
   {
     // Try to avoid allocation. If we need to allocate, release the mutex before the allocation.
     MutexLock mu(self, *Locks::intern_table_lock_);
     DCHECK(!strong_interns_.tables_.empty());
+    s = strong_interns_.Find(
+        Utf8String(utf16_length, utf8_data), hash, num_searched_strong_frozen_tables);
     num_searched_strong_frozen_tables = strong_interns_.tables_.size() - 1u;
-    s = strong_interns_.Find(Utf8String(utf16_length, utf8_data), hash);
   }
   if (s != nullptr) {
     return s;
@@ -292,7 +311,15 @@ ObjPtr<mirror::String> InternTable::InternStrong(ObjPtr<mirror::String> s) {
   DCHECK(s != nullptr);
   // `String::GetHashCode()` ensures that the stored hash is calculated.
   uint32_t hash = static_cast<uint32_t>(s->GetHashCode());
-  return Insert(s, hash, /*is_strong=*/ true);
+  size_t num_searched_strong_frozen_tables = 0u;
+  if (LIKELY(!Runtime::Current()->IsAotCompiler())) {
+    ObjPtr<mirror::String> strong =
+        strong_interns_.FindFrozen(s, hash, &num_searched_strong_frozen_tables);
+    if (strong != nullptr) {
+      return strong;
+    }
+  }
+  return Insert(s, hash, /*is_strong=*/ true, num_searched_strong_frozen_tables);
 }
 
 ObjPtr<mirror::String> InternTable::InternWeak(const char* utf8_data) {
@@ -321,10 +348,10 @@ void InternTable::SweepInternTableWeaks(IsMarkedVisitor* visitor) {
 void InternTable::Table::Remove(ObjPtr<mirror::String> s, uint32_t hash) {
   // Note: We can remove weak interns even from frozen tables when promoting to strong interns.
   // We can remove strong interns only for a transaction rollback.
-  for (InternalTable& table : tables_) {
-    auto it = table.set_.FindWithHash(GcRoot<mirror::String>(s), hash);
-    if (it != table.set_.end()) {
-      table.set_.erase(it);
+  for (const std::unique_ptr<InternalTable>& table : tables_) {
+    auto it = table->set_.FindWithHash(GcRoot<mirror::String>(s), hash);
+    if (it != table->set_.end()) {
+      table->set_.erase(it);
       return;
     }
   }
@@ -337,14 +364,16 @@ ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s,
                                                 size_t num_searched_frozen_tables) {
   Locks::intern_table_lock_->AssertHeld(Thread::Current());
   auto mid = tables_.begin() + num_searched_frozen_tables;
-  for (Table::InternalTable& table : MakeIterationRange(tables_.begin(), mid)) {
-    DCHECK(table.set_.FindWithHash(GcRoot<mirror::String>(s), hash) == table.set_.end());
+  for (const std::unique_ptr<InternalTable>& table :
+           MakeIterationRange(tables_.begin(), mid)) {
+    DCHECK(table->set_.FindWithHash(GcRoot<mirror::String>(s), hash) == table->set_.end());
   }
   // Search from the last table, assuming that apps shall search for their own
   // strings more often than for boot image strings.
-  for (Table::InternalTable& table : ReverseRange(MakeIterationRange(mid, tables_.end()))) {
-    auto it = table.set_.FindWithHash(GcRoot<mirror::String>(s), hash);
-    if (it != table.set_.end()) {
+  for (const std::unique_ptr<InternalTable>& table :
+           ReverseRange(MakeIterationRange(mid, tables_.end()))) {
+    auto it = table->set_.FindWithHash(GcRoot<mirror::String>(s), hash);
+    if (it != table->set_.end()) {
       return it->Read();
     }
   }
@@ -352,48 +381,105 @@ ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s,
 }
 
 FLATTEN
-ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string, uint32_t hash) {
+ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string,
+                                                uint32_t hash,
+                                                size_t num_searched_frozen_tables) {
   Locks::intern_table_lock_->AssertHeld(Thread::Current());
+  auto mid = tables_.begin() + num_searched_frozen_tables;
+  for (const std::unique_ptr<InternalTable>& table :
+           MakeIterationRange(tables_.begin(), mid)) {
+    DCHECK(table->set_.FindWithHash(string, hash) == table->set_.end());
+  }
   // Search from the last table, assuming that apps shall search for their own
   // strings more often than for boot image strings.
-  for (InternalTable& table : ReverseRange(tables_)) {
-    auto it = table.set_.FindWithHash(string, hash);
-    if (it != table.set_.end()) {
+  for (const std::unique_ptr<InternalTable>& table :
+           ReverseRange(MakeIterationRange(mid, tables_.end()))) {
+    auto it = table->set_.FindWithHash(string, hash);
+    if (it != table->set_.end()) {
       return it->Read();
     }
   }
   return nullptr;
 }
 
+FLATTEN
+ObjPtr<mirror::String> InternTable::Table::FindFrozen(
+    const Utf8String& string, uint32_t hash, /*out*/ size_t* num_searched_frozen_tables) {
+  const FrozenTablesView* view = frozen_view_.load(std::memory_order_acquire);
+  if (view == nullptr) {
+    *num_searched_frozen_tables = 0u;
+    return nullptr;
+  }
+  *num_searched_frozen_tables = view->tables.size();
+  for (const InternalTable* table : ReverseRange(view->tables)) {
+    auto it = table->set_.FindWithHash(string, hash);
+    if (it != table->set_.end()) {
+      return it->Read();
+    }
+  }
+  return nullptr;
+}
+
+FLATTEN
+ObjPtr<mirror::String> InternTable::Table::FindFrozen(
+    ObjPtr<mirror::String> s, uint32_t hash, /*out*/ size_t* num_searched_frozen_tables) {
+  const FrozenTablesView* view = frozen_view_.load(std::memory_order_acquire);
+  if (view == nullptr) {
+    *num_searched_frozen_tables = 0u;
+    return nullptr;
+  }
+  *num_searched_frozen_tables = view->tables.size();
+  for (const InternalTable* table : ReverseRange(view->tables)) {
+    auto it = table->set_.FindWithHash(GcRoot<mirror::String>(s), hash);
+    if (it != table->set_.end()) {
+      return it->Read();
+    }
+  }
+  return nullptr;
+}
+
+void InternTable::Table::PublishFrozenViewLocked() {
+  std::unique_ptr<FrozenTablesView> view(new FrozenTablesView);
+  view->tables.reserve(tables_.size() - 1u);
+  for (size_t i = 0; i != tables_.size() - 1u; ++i) {
+    view->tables.push_back(tables_[i].get());
+  }
+  // Release so that readers doing an acquire load see fully constructed tables.
+  frozen_view_.store(view.get(), std::memory_order_release);
+  frozen_views_.push_back(std::move(view));
+}
+
 void InternTable::Table::AddNewTable() {
   // Propagate the min/max load factor from the old active set.
   DCHECK(!tables_.empty());
-  const UnorderedSet& last_set = tables_.back().set_;
-  InternalTable new_table;
-  new_table.set_.SetLoadFactor(last_set.GetMinLoadFactor(), last_set.GetMaxLoadFactor());
+  const UnorderedSet& last_set = tables_.back()->set_;
+  std::unique_ptr<InternalTable> new_table(new InternalTable());
+  new_table->set_.SetLoadFactor(last_set.GetMinLoadFactor(), last_set.GetMaxLoadFactor());
   tables_.push_back(std::move(new_table));
+  // The previous active table is now frozen and becomes visible to lock-free readers.
+  PublishFrozenViewLocked();
 }
 
 void InternTable::Table::Insert(ObjPtr<mirror::String> s, uint32_t hash) {
   // Always insert the last table, the image tables are before and we avoid inserting into these
   // to prevent dirty pages.
   DCHECK(!tables_.empty());
-  tables_.back().set_.PutWithHash(GcRoot<mirror::String>(s), hash);
+  tables_.back()->set_.PutWithHash(GcRoot<mirror::String>(s), hash);
 }
 
 void InternTable::Table::VisitRoots(RootVisitor* visitor) {
   BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(
       visitor, RootInfo(kRootInternedString));
-  for (InternalTable& table : tables_) {
-    for (auto& intern : table.set_) {
+  for (const std::unique_ptr<InternalTable>& table : tables_) {
+    for (auto& intern : table->set_) {
       buffered_visitor.VisitRoot(intern);
     }
   }
 }
 
 void InternTable::Table::SweepWeaks(IsMarkedVisitor* visitor) {
-  for (InternalTable& table : tables_) {
-    SweepWeaks(&table.set_, visitor);
+  for (const std::unique_ptr<InternalTable>& table : tables_) {
+    SweepWeaks(&table->set_, visitor);
   }
 }
 
@@ -415,8 +501,8 @@ size_t InternTable::Table::Size() const {
   return std::accumulate(tables_.begin(),
                          tables_.end(),
                          0U,
-                         [](size_t sum, const InternalTable& table) {
-                           return sum + table.Size();
+                         [](size_t sum, const std::unique_ptr<InternalTable>& table) {
+                           return sum + table->Size();
                          });
 }
 
@@ -435,9 +521,9 @@ void InternTable::ChangeWeakRootStateLocked(gc::WeakRootState new_state) {
 
 InternTable::Table::Table() {
   Runtime* const runtime = Runtime::Current();
-  InternalTable initial_table;
-  initial_table.set_.SetLoadFactor(runtime->GetHashTableMinLoadFactor(),
-                                   runtime->GetHashTableMaxLoadFactor());
+  std::unique_ptr<InternalTable> initial_table(new InternalTable());
+  initial_table->set_.SetLoadFactor(runtime->GetHashTableMinLoadFactor(),
+                                    runtime->GetHashTableMaxLoadFactor());
   tables_.push_back(std::move(initial_table));
 }
 
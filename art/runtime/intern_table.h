@@ -17,6 +17,9 @@
 #ifndef ART_RUNTIME_INTERN_TABLE_H_
 #define ART_RUNTIME_INTERN_TABLE_H_
 
+#include <atomic>
+#include <memory>
+
 #include "base/allocator.h"
 #include "base/dchecked_vector.h"
 #include "base/hash_set.h"
@@ -240,8 +243,23 @@ class InternTable {
                                 uint32_t hash,
                                 size_t num_searched_frozen_tables = 0u)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-    ObjPtr<mirror::String> Find(const Utf8String& string, uint32_t hash)
+    ObjPtr<mirror::String> Find(const Utf8String& string,
+                                uint32_t hash,
+                                size_t num_searched_frozen_tables = 0u)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+    // Probe the frozen tables without taking the intern table lock. Returns the number of
+    // frozen tables searched in `num_searched_frozen_tables` so that the caller can resume
+    // a locked search behind them. Only sound for the strong table at runtime: strong
+    // frozen tables are never mutated outside of AOT transaction rollback, while weak
+    // frozen tables see removals when weak interns are promoted.
+    ObjPtr<mirror::String> FindFrozen(const Utf8String& string,
+                                      uint32_t hash,
+                                      /*out*/ size_t* num_searched_frozen_tables)
+        REQUIRES_SHARED(Locks::mutator_lock_);
+    ObjPtr<mirror::String> FindFrozen(ObjPtr<mirror::String> s,
+                                      uint32_t hash,
+                                      /*out*/ size_t* num_searched_frozen_tables)
+        REQUIRES_SHARED(Locks::mutator_lock_);
     void Insert(ObjPtr<mirror::String> s, uint32_t hash)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
     void Remove(ObjPtr<mirror::String> s, uint32_t hash)
@@ -262,16 +280,34 @@ class InternTable {
         REQUIRES(!Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
    private:
+    // Immutable view of the frozen (non-back) tables, published atomically so that the
+    // strong intern fast path can probe them without taking the intern table lock.
+    // Retired views are kept alive for the lifetime of the table since readers may
+    // still hold a pointer to them; tables are frozen rarely, so this is bounded.
+    struct FrozenTablesView {
+      std::vector<const InternalTable*> tables;
+    };
+
     void SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
 
+    // Rebuild and publish the frozen tables view after `tables_` changed shape.
+    void PublishFrozenViewLocked() REQUIRES(Locks::intern_table_lock_);
+
     // Add a table to the front of the tables vector.
     void AddInternStrings(UnorderedSet&& intern_strings, bool is_boot_image)
         REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
     // We call AddNewTable when we create the zygote to reduce private dirty pages caused by
     // modifying the zygote intern table. The back of table is modified when strings are interned.
-    dchecked_vector<InternalTable> tables_;
+    // The tables are held by unique_ptr so that they have stable addresses and the frozen
+    // prefix can be probed through `frozen_view_` without holding the intern table lock.
+    dchecked_vector<std::unique_ptr<InternalTable>> tables_;
+    // Current lock-free view of the frozen tables, in `tables_` order. Owned by
+    // `frozen_views_`.
+    std::atomic<const FrozenTablesView*> frozen_view_{nullptr};
+    // All views ever published, including the current one; see `FrozenTablesView`.
+    dchecked_vector<std::unique_ptr<const FrozenTablesView>> frozen_views_;
 
     friend class InternTable;
     friend class linker::ImageWriter;
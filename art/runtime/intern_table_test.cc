@@ -81,9 +81,10 @@ TEST_F(InternTableTest, CrossHash) {
   ASSERT_LT(hash, 0);
 
   MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  for (InternTable::Table::InternalTable& table : t.strong_interns_.tables_) {
+  for (const std::unique_ptr<InternTable::Table::InternalTable>& table :
+           t.strong_interns_.tables_) {
     // The negative hash value shall be 32-bit wide on every host.
-    ASSERT_TRUE(IsUint<32>(table.set_.hashfn_(GcRoot<mirror::String>(str))));
+    ASSERT_TRUE(IsUint<32>(table->set_.hashfn_(GcRoot<mirror::String>(str))));
   }
 }
 
@@ -16,11 +16,18 @@
 
 #include "linear_alloc.h"
 
+#include "base/memory_tool.h"
 #include "thread-current-inl.h"
 
 namespace art {
 
-LinearAlloc::LinearAlloc(ArenaPool* pool) : lock_("linear alloc"), allocator_(pool) {
+std::atomic<uint64_t> LinearAlloc::next_id_(1u);
+thread_local LinearAlloc::ThreadLocalBlock LinearAlloc::thread_local_block_;
+
+LinearAlloc::LinearAlloc(ArenaPool* pool)
+    : lock_("linear alloc"),
+      allocator_(pool),
+      id_(next_id_.fetch_add(1u, std::memory_order_relaxed)) {
 }
 
 void* LinearAlloc::Realloc(Thread* self, void* ptr, size_t old_size, size_t new_size) {
@@ -29,6 +36,25 @@ void* LinearAlloc::Realloc(Thread* self, void* ptr, size_t old_size, size_t new_
 }
 
 void* LinearAlloc::Alloc(Thread* self, size_t size) {
+  // Memory tools want to see every allocation with its own red zones, so do not carve
+  // sub-allocations out of a block when running on one.
+  if (!kRunningOnMemoryTool && size <= kMaxThreadLocalAlloc) {
+    size_t aligned_size = RoundUp(size, ArenaAllocator::kAlignment);
+    ThreadLocalBlock* block = &thread_local_block_;
+    if (block->owner_id == id_ && aligned_size <= static_cast<size_t>(block->end - block->pos)) {
+      uint8_t* ret = block->pos;
+      block->pos += aligned_size;
+      return ret;
+    }
+    // Carve a new block from the arena, abandoning the tail of the previous one (which
+    // may also belong to a different `LinearAlloc`).
+    MutexLock mu(self, lock_);
+    uint8_t* new_block = static_cast<uint8_t*>(allocator_.Alloc(kThreadLocalBlockSize));
+    block->owner_id = id_;
+    block->pos = new_block + aligned_size;
+    block->end = new_block + kThreadLocalBlockSize;
+    return new_block;
+  }
   MutexLock mu(self, lock_);
   return allocator_.Alloc(size);
 }
@@ -38,6 +64,13 @@ void* LinearAlloc::AllocAlign16(Thread* self, size_t size) {
   return allocator_.AllocAlign16(size);
 }
 
+void LinearAlloc::AllocBatch(Thread* self, ArrayRef<const size_t> sizes, /*out*/ void** ptrs) {
+  MutexLock mu(self, lock_);
+  for (size_t i = 0; i != sizes.size(); ++i) {
+    ptrs[i] = allocator_.Alloc(sizes[i]);
+  }
+}
+
 size_t LinearAlloc::GetUsedMemory() const {
   MutexLock mu(Thread::Current(), lock_);
   return allocator_.BytesUsed();
@@ -17,7 +17,10 @@
 #ifndef ART_RUNTIME_LINEAR_ALLOC_H_
 #define ART_RUNTIME_LINEAR_ALLOC_H_
 
+#include <atomic>
+
 #include "base/arena_allocator.h"
+#include "base/array_ref.h"
 #include "base/mutex.h"
 
 namespace art {
@@ -27,11 +30,26 @@ class ArenaPool;
 // TODO: Support freeing if we add class unloading.
 class LinearAlloc {
  public:
+  // Size of the blocks handed out to threads for lock-free allocation, mirroring what the
+  // GC does with TLABs. Class loading performs many small allocations (fields, methods,
+  // dex cache arrays), so most of them are satisfied from the current thread's block
+  // without taking `lock_`.
+  static constexpr size_t kThreadLocalBlockSize = 8 * KB;
+  // Allocations above this size bypass the thread-local block and take the lock directly
+  // to bound the wasted tail when a block is abandoned.
+  static constexpr size_t kMaxThreadLocalAlloc = 1 * KB;
+
   explicit LinearAlloc(ArenaPool* pool);
 
   void* Alloc(Thread* self, size_t size) REQUIRES(!lock_);
   void* AllocAlign16(Thread* self, size_t size) REQUIRES(!lock_);
 
+  // Allocate one block per element of `sizes` with a single acquisition of the lock,
+  // storing the results in `ptrs` (which must have space for `sizes.size()` pointers).
+  // Used by ClassLinker to allocate the field and method arrays of a class together.
+  void AllocBatch(Thread* self, ArrayRef<const size_t> sizes, /*out*/ void** ptrs)
+      REQUIRES(!lock_);
+
   // Realloc never frees the input pointer, it is the caller's job to do this if necessary.
   void* Realloc(Thread* self, void* ptr, size_t old_size, size_t new_size) REQUIRES(!lock_);
 
@@ -41,7 +59,8 @@ class LinearAlloc {
     return reinterpret_cast<T*>(Alloc(self, elements * sizeof(T)));
   }
 
-  // Return the number of bytes used in the allocator.
+  // Return the number of bytes used in the allocator. This includes the unused tails of
+  // blocks currently handed out to threads.
   size_t GetUsedMemory() const REQUIRES(!lock_);
 
   ArenaPool* GetArenaPool() REQUIRES(!lock_);
@@ -54,8 +73,25 @@ class LinearAlloc {
   bool ContainsUnsafe(void* ptr) const NO_THREAD_SAFETY_ANALYSIS;
 
  private:
+  // Per-thread allocation block, carved out of the arena under `lock_` and then consumed
+  // lock-free. The block records the identity of the `LinearAlloc` it was carved from
+  // rather than a pointer: per-class-loader allocators can be deleted (and a new one can
+  // reuse the same address), and a stale id simply makes the next allocation refill.
+  // The abandoned tail of a replaced block is not reclaimed; the arena never frees
+  // individual allocations anyway, so this is only bounded fragmentation.
+  struct ThreadLocalBlock {
+    uint64_t owner_id = 0u;
+    uint8_t* pos = nullptr;
+    uint8_t* end = nullptr;
+  };
+
   mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   ArenaAllocator allocator_ GUARDED_BY(lock_);
+  // Identity of this allocator for `ThreadLocalBlock::owner_id`; never reused.
+  const uint64_t id_;
+
+  static std::atomic<uint64_t> next_id_;
+  static thread_local ThreadLocalBlock thread_local_block_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(LinearAlloc);
 };
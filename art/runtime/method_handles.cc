@@ -16,6 +16,8 @@
 
 #include "method_handles-inl.h"
 
+#include <atomic>
+
 #include "android-base/macros.h"
 #include "android-base/stringprintf.h"
 #include "class_root-inl.h"
@@ -31,6 +33,7 @@
 #include "mirror/method_handle_impl.h"
 #include "mirror/method_type-inl.h"
 #include "mirror/var_handle.h"
+#include "object_callbacks.h"
 #include "reflection-inl.h"
 #include "reflection.h"
 #include "thread.h"
@@ -787,15 +790,104 @@ static bool DoMethodHandleInvokeMethod(Thread* self,
   return true;
 }
 
+// The kind of dispatch decision memoized in the dispatch cache below.
+enum class DispatchCacheKind : uint32_t {
+  kUnused = 0,
+  // The callsite type was an exact match for the handle's type.
+  kExactMatch,
+  // The callsite type was in-place convertible to the handle's type.
+  kInPlaceConvertible,
+};
+
+// An entry of the method handle dispatch cache. Checking whether a callsite
+// type matches (or is trivially convertible to) a handle's type walks both
+// parameter arrays on every polymorphic invoke, which dominates the cost of
+// dispatching to simple targets such as field accessors. The cache memoizes
+// positive outcomes of those walks keyed by the (method handle, callsite
+// type) identities.
+//
+// Entries hold raw mirror pointers without holding the objects live, like the
+// thread-local interpreter caches, and rely on the same protocol for safety:
+// `SweepMethodHandleDispatchCache()` runs as part of
+// `Runtime::SweepSystemWeaks()` before dead objects' memory can be reused, so
+// a pointer-equality hit can only occur against the live objects the entry
+// was populated from. A stale entry only ever produces a miss, which re-runs
+// the full check.
+//
+// Entries are multiple words, so each carries a seqlock-style version:
+// even means consistent, writers CAS it odd for the duration of the update.
+// Readers and writers never block; a reader that observes a version change
+// simply treats the entry as a miss and a writer that loses the CAS drops
+// its insert.
+struct DispatchCacheEntry {
+  std::atomic<uint32_t> version;
+  std::atomic<DispatchCacheKind> kind;
+  std::atomic<mirror::MethodHandle*> method_handle;
+  std::atomic<mirror::MethodType*> callsite_type;
+};
+
+static constexpr size_t kDispatchCacheSize = 256;  // Power of two.
+static_assert(IsPowerOfTwo(kDispatchCacheSize));
+
+DispatchCacheEntry g_dispatch_cache[kDispatchCacheSize];
+
+ALWAYS_INLINE size_t DispatchCacheIndex(ObjPtr<mirror::MethodHandle> method_handle,
+                                        ObjPtr<mirror::MethodType> callsite_type)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  // Mix both pointers; drop the low bits that are zero due to alignment.
+  const uintptr_t h = reinterpret_cast<uintptr_t>(method_handle.Ptr());
+  const uintptr_t t = reinterpret_cast<uintptr_t>(callsite_type.Ptr());
+  return ((h >> 3) ^ (t >> 4)) & (kDispatchCacheSize - 1);
+}
+
+ALWAYS_INLINE bool DispatchCacheLookup(ObjPtr<mirror::MethodHandle> method_handle,
+                                       ObjPtr<mirror::MethodType> callsite_type,
+                                       DispatchCacheKind kind)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  DispatchCacheEntry& entry = g_dispatch_cache[DispatchCacheIndex(method_handle, callsite_type)];
+  const uint32_t version = entry.version.load(std::memory_order_acquire);
+  if ((version & 1u) != 0u) {
+    return false;  // A writer owns the entry.
+  }
+  if (entry.kind.load(std::memory_order_relaxed) != kind ||
+      entry.method_handle.load(std::memory_order_relaxed) != method_handle.Ptr() ||
+      entry.callsite_type.load(std::memory_order_relaxed) != callsite_type.Ptr()) {
+    return false;
+  }
+  // Re-check the version to make sure the fields were not rewritten while being read.
+  return entry.version.load(std::memory_order_acquire) == version;
+}
+
+void DispatchCacheInsert(ObjPtr<mirror::MethodHandle> method_handle,
+                         ObjPtr<mirror::MethodType> callsite_type,
+                         DispatchCacheKind kind)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  DispatchCacheEntry& entry = g_dispatch_cache[DispatchCacheIndex(method_handle, callsite_type)];
+  uint32_t version = entry.version.load(std::memory_order_relaxed);
+  if ((version & 1u) != 0u ||
+      !entry.version.compare_exchange_strong(version, version + 1u, std::memory_order_acquire)) {
+    return;  // Another writer owns the entry; dropping the insert is fine.
+  }
+  entry.kind.store(kind, std::memory_order_relaxed);
+  entry.method_handle.store(method_handle.Ptr(), std::memory_order_relaxed);
+  entry.callsite_type.store(callsite_type.Ptr(), std::memory_order_relaxed);
+  entry.version.store(version + 2u, std::memory_order_release);
+}
+
 static bool MethodHandleInvokeExactInternal(Thread* self,
                                             ShadowFrame& shadow_frame,
                                             Handle<mirror::MethodHandle> method_handle,
                                             Handle<mirror::MethodType> callsite_type,
                                             const InstructionOperands* const operands,
                                             JValue* result) REQUIRES_SHARED(Locks::mutator_lock_) {
-  if (!callsite_type->IsExactMatch(method_handle->GetMethodType())) {
-    ThrowWrongMethodTypeException(method_handle->GetMethodType(), callsite_type.Get());
-    return false;
+  if (!DispatchCacheLookup(method_handle.Get(), callsite_type.Get(),
+                           DispatchCacheKind::kExactMatch)) {
+    if (!callsite_type->IsExactMatch(method_handle->GetMethodType())) {
+      ThrowWrongMethodTypeException(method_handle->GetMethodType(), callsite_type.Get());
+      return false;
+    }
+    DispatchCacheInsert(method_handle.Get(), callsite_type.Get(),
+                        DispatchCacheKind::kExactMatch);
   }
 
   switch (method_handle->GetHandleKind()) {
@@ -845,8 +937,16 @@ static bool MethodHandleInvokeInternal(Thread* self,
   //    transformation isn't really doing any work.
   //
   // The following IsInPlaceConvertible check determines if either of these opportunities to
-  // skip asType() are true.
+  // skip asType() are true. The outcome is memoized so that hot call sites skip the
+  // parameter walk; the nested exact invoke memoizes its own exact-match check.
+  if (DispatchCacheLookup(method_handle.Get(), callsite_type.Get(),
+                          DispatchCacheKind::kInPlaceConvertible)) {
+    return MethodHandleInvokeExact(
+        self, shadow_frame, method_handle, method_handle_type, operands, result);
+  }
   if (callsite_type->IsInPlaceConvertible(method_handle_type.Get())) {
+    DispatchCacheInsert(method_handle.Get(), callsite_type.Get(),
+                        DispatchCacheKind::kInPlaceConvertible);
     return MethodHandleInvokeExact(
         self, shadow_frame, method_handle, method_handle_type, operands, result);
   }
@@ -937,4 +1037,35 @@ void MethodHandleInvokeExactWithFrame(Thread* self,
   self->PopManagedStackFragment(fragment);
 }
 
+void SweepMethodHandleDispatchCache(IsMarkedVisitor* visitor) {
+  for (DispatchCacheEntry& entry : g_dispatch_cache) {
+    uint32_t version = entry.version.load(std::memory_order_relaxed);
+    if ((version & 1u) != 0u ||
+        !entry.version.compare_exchange_strong(version, version + 1u, std::memory_order_acquire)) {
+      // A mutator is concurrently inserting; its entry holds objects that are
+      // necessarily still reachable through its handles, so skipping is safe.
+      continue;
+    }
+    mirror::MethodHandle* method_handle = entry.method_handle.load(std::memory_order_relaxed);
+    if (method_handle != nullptr) {
+      mirror::MethodType* callsite_type = entry.callsite_type.load(std::memory_order_relaxed);
+      mirror::Object* new_handle =
+          visitor->IsMarked(reinterpret_cast<mirror::Object*>(method_handle));
+      mirror::Object* new_type =
+          visitor->IsMarked(reinterpret_cast<mirror::Object*>(callsite_type));
+      if (new_handle == nullptr || new_type == nullptr) {
+        entry.kind.store(DispatchCacheKind::kUnused, std::memory_order_relaxed);
+        entry.method_handle.store(nullptr, std::memory_order_relaxed);
+        entry.callsite_type.store(nullptr, std::memory_order_relaxed);
+      } else {
+        entry.method_handle.store(down_cast<mirror::MethodHandle*>(new_handle),
+                                  std::memory_order_relaxed);
+        entry.callsite_type.store(down_cast<mirror::MethodType*>(new_type),
+                                  std::memory_order_relaxed);
+      }
+    }
+    entry.version.store(version + 2u, std::memory_order_release);
+  }
+}
+
 }  // namespace art
@@ -26,6 +26,7 @@
 
 namespace art {
 
+class IsMarkedVisitor;
 class ShadowFrame;
 
 namespace mirror {
@@ -156,6 +157,12 @@ void MethodHandleInvokeExactWithFrame(Thread* self,
                                       Handle<mirror::EmulatedStackFrame> stack_frame)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
+// Sweeps the cache of memoized (method handle, callsite type) dispatch
+// decisions, updating moved references and evicting entries whose objects
+// are no longer marked. Called by `Runtime::SweepSystemWeaks()`.
+void SweepMethodHandleDispatchCache(IsMarkedVisitor* visitor)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_METHOD_HANDLES_H_
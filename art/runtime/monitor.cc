@@ -97,6 +97,7 @@ void Monitor::Init(uint32_t lock_profiling_threshold,
 Monitor::Monitor(Thread* self, Thread* owner, ObjPtr<mirror::Object> obj, int32_t hash_code)
     : monitor_lock_("a monitor lock", kMonitorLock),
       num_waiters_(0),
+      spin_history_(1u),
       owner_(owner),
       lock_count_(0),
       obj_(GcRoot<mirror::Object>(obj)),
@@ -131,6 +132,7 @@ Monitor::Monitor(Thread* self,
                  MonitorId id)
     : monitor_lock_("a monitor lock", kMonitorLock),
       num_waiters_(0),
+      spin_history_(1u),
       owner_(owner),
       lock_count_(0),
       obj_(GcRoot<mirror::Object>(obj)),
@@ -455,6 +457,32 @@ void Monitor::Lock(Thread* self) {
     return;
   }
   // Contended; not reentrant. We hold no locks, so tread carefully.
+  // Adaptive spin tier: if recent contended acquisitions of this monitor succeeded while
+  // spinning, retry briefly with an exponentially growing budget before committing to the
+  // expensive parking path below. The history is rewarded on a spin success and penalized
+  // when we end up parking, so monitors with long hold times stop paying for this quickly.
+  {
+    const uint32_t history = spin_history_.load(std::memory_order_relaxed);
+    uint32_t remaining_spins = (history != 0u) ? (kAdaptiveSpinBaseIters << (history - 1u)) : 0u;
+    uint32_t iters_until_yield = kAdaptiveSpinItersPerYield;
+    while (remaining_spins != 0u) {
+      --remaining_spins;
+      if (owner_.load(std::memory_order_relaxed) == nullptr && TryLock(self, /*spin=*/ false)) {
+        if (history < kAdaptiveSpinHistoryMax) {
+          spin_history_.store(history + 1u, std::memory_order_relaxed);
+        }
+        return;
+      }
+      if (--iters_until_yield == 0u) {
+        // Give the owner a chance to run; it may well be preempted on a loaded device.
+        sched_yield();
+        iters_until_yield = kAdaptiveSpinItersPerYield;
+      }
+    }
+    if (history != 0u) {
+      spin_history_.store(history - 1u, std::memory_order_relaxed);
+    }
+  }
   const bool log_contention = (lock_profiling_threshold_ != 0);
   uint64_t wait_start_ms = log_contention ? MilliTime() : 0;
 
@@ -1005,6 +1033,14 @@ bool Monitor::Deflate(Thread* self, ObjPtr<mirror::Object> obj) {
     if (monitor->num_waiters_.load(std::memory_order_relaxed) > 0) {
       return false;
     }
+    // Give recently contended monitors a grace period: decay the spin history by one per
+    // deflation cycle and only deflate once contention has subsided long enough for it to
+    // drain. This avoids inflate/deflate churn on monitors that see periodic contention.
+    uint32_t spin_history = monitor->spin_history_.load(std::memory_order_relaxed);
+    if (spin_history > 1u) {
+      monitor->spin_history_.store(spin_history - 1u, std::memory_order_relaxed);
+      return false;
+    }
     if (!monitor->monitor_lock_.ExclusiveTryLock(self)) {
       // We cannot deflate a monitor that's currently held. It's unclear whether we should if
       // we could.
@@ -61,6 +61,13 @@ class Monitor {
   // a lock word. See Runtime::max_spins_before_thin_lock_inflation_.
   constexpr static size_t kDefaultMaxSpinsBeforeThinLockInflation = 50;
 
+  // Bounds for the adaptive spin tier used by contended Lock() before parking.
+  // The spin budget for a monitor is kAdaptiveSpinBaseIters << (history - 1), where the
+  // history is bounded by kAdaptiveSpinHistoryMax; see spin_history_ below.
+  constexpr static uint32_t kAdaptiveSpinBaseIters = 100;
+  constexpr static uint32_t kAdaptiveSpinHistoryMax = 4;
+  constexpr static uint32_t kAdaptiveSpinItersPerYield = 100;
+
   static constexpr int kDefaultMonitorTimeoutMs = 500;
 
   static constexpr int kMonitorTimeoutMinMs = 200;
@@ -324,6 +331,14 @@ class Monitor {
   // monitor acquisition. Prevents deflation.
   std::atomic<size_t> num_waiters_;
 
+  // Saturating history of contended acquisitions that succeeded by spinning rather than
+  // parking. Grows on a spin success and shrinks when a contender ends up parking, so
+  // monitors guarding short critical sections earn an exponentially larger spin budget
+  // while monitors with long hold times quickly fall back to parking immediately. Also
+  // decayed by Deflate() so that recently contended monitors get a grace period before
+  // being deflated. Bounded by kAdaptiveSpinHistoryMax.
+  std::atomic<uint32_t> spin_history_;
+
   // Which thread currently owns the lock? monitor_lock_ only keeps the tid.
   // Only set while holding monitor_lock_. Non-locking readers only use it to
   // compare to self or for debugging.
@@ -105,23 +105,67 @@ void MonitorPool::FreeInternal() {
   }
 }
 
+thread_local MonitorPool::ThreadCache MonitorPool::thread_cache_;
+
+MonitorPool::ThreadCache::~ThreadCache() {
+  // The thread is exiting; return any cached monitors to the shared free list. During late
+  // TLS destruction Thread::Current() may already be cleared, which the mutex implementation
+  // tolerates. Skip the flush entirely if the runtime (and with it the pool backing store)
+  // is already gone.
+  if (head != nullptr) {
+    Runtime* runtime = Runtime::Current();
+    MonitorPool* pool = runtime != nullptr ? runtime->GetMonitorPool() : nullptr;
+    if (pool != nullptr) {
+      pool->FlushThreadCache(Thread::Current(), this, 0u);
+    }
+  }
+}
+
+void MonitorPool::FlushThreadCache(Thread* self, ThreadCache* cache, size_t target_size) {
+  MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
+  while (cache->size > target_size) {
+    Monitor* monitor = cache->head;
+    cache->head = monitor->next_free_;
+    --cache->size;
+    monitor->next_free_ = first_free_;
+    first_free_ = monitor;
+  }
+}
+
 Monitor* MonitorPool::CreateMonitorInPool(Thread* self,
                                           Thread* owner,
                                           ObjPtr<mirror::Object> obj,
                                           int32_t hash_code)
     REQUIRES_SHARED(Locks::mutator_lock_) {
-  // We are gonna allocate, so acquire the writer lock.
-  MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
-
-  // Enough space, or need to resize?
-  if (first_free_ == nullptr) {
-    VLOG(monitor) << "Allocating a new chunk.";
-    AllocateChunk();
+  ThreadCache* cache = &thread_cache_;
+  Monitor* mon_uninitialized = cache->head;
+  if (LIKELY(mon_uninitialized != nullptr)) {
+    // Fast path: take a monitor from the thread-local cache without locking.
+    cache->head = mon_uninitialized->next_free_;
+    --cache->size;
+  } else {
+    // We are gonna allocate, so acquire the writer lock. Batch-refill the thread-local
+    // cache while we hold it so the next kThreadCacheRefillCount - 1 allocations on this
+    // thread stay lock-free.
+    MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
+    for (size_t i = 0; i < kThreadCacheRefillCount; ++i) {
+      // Enough space, or need to resize?
+      if (first_free_ == nullptr) {
+        VLOG(monitor) << "Allocating a new chunk.";
+        AllocateChunk();
+      }
+      Monitor* monitor = first_free_;
+      first_free_ = first_free_->next_free_;
+      if (i == 0u) {
+        mon_uninitialized = monitor;
+      } else {
+        monitor->next_free_ = cache->head;
+        cache->head = monitor;
+        ++cache->size;
+      }
+    }
   }
 
-  Monitor* mon_uninitialized = first_free_;
-  first_free_ = first_free_->next_free_;
-
   // Pull out the id which was preinitialized.
   MonitorId id = mon_uninitialized->monitor_id_;
 
@@ -132,9 +176,6 @@ Monitor* MonitorPool::CreateMonitorInPool(Thread* self,
 }
 
 void MonitorPool::ReleaseMonitorToPool(Thread* self, Monitor* monitor) {
-  // Might be racy with allocation, so acquire lock.
-  MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
-
   // Keep the monitor id. Don't trust it's not cleared.
   MonitorId id = monitor->monitor_id_;
 
@@ -142,12 +183,19 @@ void MonitorPool::ReleaseMonitorToPool(Thread* self, Monitor* monitor) {
   // TODO: Exception safety?
   monitor->~Monitor();
 
-  // Add to the head of the free list.
-  monitor->next_free_ = first_free_;
-  first_free_ = monitor;
+  // Add to the head of the thread-local cache.
+  ThreadCache* cache = &thread_cache_;
+  monitor->next_free_ = cache->head;
+  cache->head = monitor;
+  ++cache->size;
 
   // Rewrite monitor id.
   monitor->monitor_id_ = id;
+
+  if (UNLIKELY(cache->size > kThreadCacheMaxSize)) {
+    // Give half of the cache back so that release-heavy threads do not hoard monitors.
+    FlushThreadCache(self, cache, kThreadCacheRefillCount);
+  }
 }
 
 void MonitorPool::ReleaseMonitorsToPool(Thread* self, MonitorList::Monitors* monitors) {
@@ -134,6 +134,23 @@ class MonitorPool {
   void ReleaseMonitorToPool(Thread* self, Monitor* monitor);
   void ReleaseMonitorsToPool(Thread* self, MonitorList::Monitors* monitors);
 
+  // Per-thread cache of free monitors, batch-refilled from the shared free list so that the
+  // common allocate/release cycle does not touch allocated_monitor_ids_lock_. The cache
+  // holds destructed monitors chained through next_free_ with their ids preserved, exactly
+  // like the shared free list.
+  static constexpr size_t kThreadCacheRefillCount = 8;
+  static constexpr size_t kThreadCacheMaxSize = 2 * kThreadCacheRefillCount;
+  struct ThreadCache {
+    ~ThreadCache();
+    Monitor* head = nullptr;
+    size_t size = 0u;
+  };
+  static thread_local ThreadCache thread_cache_;
+
+  // Return cached monitors to the shared free list until only `target_size` remain.
+  void FlushThreadCache(Thread* self, ThreadCache* cache, size_t target_size)
+      REQUIRES(!Locks::allocated_monitor_ids_lock_);
+
   // Note: This is safe as we do not ever move chunks.  All needed entries in the monitor_chunks_
   // data structure are read-only once we get here.  Updates happen-before this call because
   // the lock word was stored with release semantics and we read it with acquire semantics to
@@ -15,12 +15,16 @@
  */
 
 #include "art_method-inl.h"
+#include "class_linker.h"
 #include "dex/code_item_accessors.h"
 #include "entrypoints/quick/callee_save_frame.h"
 #include "interpreter/mterp/nterp.h"
 #include "nterp_helpers.h"
+#include "nterp_hint_cache.h"
+#include "oat_file.h"
 #include "oat_quick_method_header.h"
 #include "quick/quick_method_frame_info.h"
+#include "runtime.h"
 
 namespace art {
 
@@ -215,4 +219,33 @@ bool CanMethodUseNterp(ArtMethod* method, InstructionSet isa) {
       NterpGetFrameSize(method, isa) <= interpreter::kNterpMaxFrame;
 }
 
+void NterpPreSeedInlineCaches(ArtMethod* method) {
+  const DexFile* dex_file = method->GetDexFile();
+  const OatDexFile* oat_dex_file = dex_file->GetOatDexFile();
+  if (oat_dex_file == nullptr) {
+    return;
+  }
+  const NterpHintCache* hints = oat_dex_file->GetOatFile()->GetNterpHintCache();
+  if (hints == nullptr) {
+    return;
+  }
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  ObjPtr<mirror::DexCache> dex_cache = method->GetDexCache();
+  ObjPtr<mirror::ClassLoader> class_loader = method->GetClassLoader();
+  for (const NterpHintCache::HintEntry& hint :
+           hints->GetMethodHints(*dex_file, method->GetDexMethodIndex())) {
+    if (hint.callee_method_idx == NterpHintCache::kNoCalleeHint) {
+      continue;  // Branch-profile entry; only of interest to the interpreter.
+    }
+    if (dex_cache->GetResolvedMethod(hint.callee_method_idx) != nullptr) {
+      continue;
+    }
+    // LookupResolvedMethod only succeeds if the callee's declaring class is
+    // already resolved, and seeds the dex cache when it does. This keeps
+    // pre-seeding free of class loading, initialization and exceptions; a
+    // hint whose class shows up later is simply resolved the usual way.
+    class_linker->LookupResolvedMethod(hint.callee_method_idx, dex_cache, class_loader);
+  }
+}
+
 }  // namespace art
@@ -81,6 +81,17 @@ uint32_t NterpGetVRegReference(ArtMethod** frame, uint16_t vreg)
 bool CanMethodUseNterp(ArtMethod* method, InstructionSet isa = kRuntimeISA)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
+/**
+ * Seeds the dex cache of `method` with the resolved-callee hints recorded for
+ * it in the mapped NterpHintCache of its oat file, so that interpreting the
+ * method hits the dex cache instead of taking the class linker slow path for
+ * dispatch targets every process has already learned. Only callees whose
+ * declaring class is already resolved are seeded; nothing is loaded or
+ * initialized and no exceptions are thrown. No-op without a hint cache.
+ */
+void NterpPreSeedInlineCaches(ArtMethod* method)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_NTERP_HELPERS_H_
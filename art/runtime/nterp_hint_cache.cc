@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nterp_hint_cache.h"
+
+#include <sys/mman.h>  // For the PROT_* and MAP_* constants.
+
+#include <algorithm>
+#include <cstring>
+
+#include "base/logging.h"  // For VLOG.
+#include "base/os.h"
+#include "base/unix_file/fd_file.h"
+#include "dex/dex_file.h"
+#include "vdex_file.h"
+
+namespace art {
+
+constexpr uint8_t NterpHintCache::NterpHintCacheHeader::kNterpHintMagic[4];
+constexpr uint8_t NterpHintCache::NterpHintCacheHeader::kNterpHintVersion[4];
+
+bool NterpHintCache::NterpHintCacheHeader::IsValid() const {
+  return memcmp(magic_, kNterpHintMagic, sizeof(kNterpHintMagic)) == 0 &&
+      memcmp(version_, kNterpHintVersion, sizeof(kNterpHintVersion)) == 0;
+}
+
+std::unique_ptr<NterpHintCache> NterpHintCache::OpenForVdex(const VdexFile& vdex) {
+  const std::string filename = vdex.GetName() + ".nhint";
+  if (!OS::FileExists(filename.c_str())) {
+    // The common case: no hints were generated for this vdex.
+    return nullptr;
+  }
+
+  std::unique_ptr<File> file(OS::OpenFileForReading(filename.c_str()));
+  if (file == nullptr) {
+    PLOG(WARNING) << "Could not open nterp hint cache " << filename;
+    return nullptr;
+  }
+  int64_t length = file->GetLength();
+  if (length < static_cast<int64_t>(sizeof(NterpHintCacheHeader))) {
+    LOG(WARNING) << "Nterp hint cache " << filename << " is too short";
+    return nullptr;
+  }
+
+  std::string error_msg;
+  // MAP_SHARED: every process loading this oat file shares one copy of the
+  // hint pages in the page cache.
+  MemMap mmap = MemMap::MapFile(length,
+                                PROT_READ,
+                                MAP_SHARED,
+                                file->Fd(),
+                                /*start=*/0u,
+                                /*low_4gb=*/false,
+                                filename.c_str(),
+                                &error_msg);
+  if (!mmap.IsValid()) {
+    LOG(WARNING) << "Could not mmap nterp hint cache " << filename << ": " << error_msg;
+    return nullptr;
+  }
+
+  std::unique_ptr<NterpHintCache> cache(new NterpHintCache(std::move(mmap)));
+  if (!cache->Validate(vdex)) {
+    // Typically a hint file left behind by a previous dexopt of the same
+    // location; readers must ignore it until it is regenerated.
+    LOG(WARNING) << "Rejecting stale or malformed nterp hint cache " << filename;
+    return nullptr;
+  }
+  VLOG(oat) << "Loaded nterp hint cache " << filename;
+  return cache;
+}
+
+bool NterpHintCache::Validate(const VdexFile& vdex) const {
+  if (!GetHeader().IsValid()) {
+    return false;
+  }
+  const uint32_t num_dex_files = GetHeader().GetNumberOfDexFiles();
+  if (num_dex_files != vdex.GetNumberOfDexFiles()) {
+    return false;
+  }
+  size_t tables_end =
+      sizeof(NterpHintCacheHeader) + num_dex_files * sizeof(DexTableHeader);
+  if (tables_end > Size()) {
+    return false;
+  }
+  const DexTableHeader* tables = GetDexTableHeaders();
+  for (uint32_t i = 0; i < num_dex_files; i++) {
+    if (tables[i].dex_checksum != vdex.GetDexChecksumAt(i)) {
+      return false;
+    }
+    if (!IsAligned<alignof(HintEntry)>(tables[i].entries_offset)) {
+      return false;
+    }
+    size_t entries_end = static_cast<size_t>(tables[i].entries_offset) +
+        static_cast<size_t>(tables[i].entries_count) * sizeof(HintEntry);
+    if (tables[i].entries_offset < tables_end || entries_end > Size()) {
+      return false;
+    }
+    // Entries must be sorted by (method_idx, dex_pc) for the binary search
+    // in GetMethodHints().
+    const HintEntry* entries =
+        reinterpret_cast<const HintEntry*>(Begin() + tables[i].entries_offset);
+    for (uint32_t j = 1; j < tables[i].entries_count; j++) {
+      if (std::make_pair(entries[j - 1].method_idx, entries[j - 1].dex_pc) >=
+          std::make_pair(entries[j].method_idx, entries[j].dex_pc)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+ArrayRef<const NterpHintCache::HintEntry> NterpHintCache::GetMethodHints(
+    const DexFile& dex_file, uint32_t method_idx) const {
+  // Identify the dex file by checksum, like the vdex checksum section does.
+  // The number of dex files per oat file is small, so a linear scan is fine.
+  const uint32_t num_dex_files = GetHeader().GetNumberOfDexFiles();
+  const DexTableHeader* tables = GetDexTableHeaders();
+  const DexTableHeader* table = nullptr;
+  for (uint32_t i = 0; i < num_dex_files; i++) {
+    if (tables[i].dex_checksum == dex_file.GetLocationChecksum()) {
+      table = &tables[i];
+      break;
+    }
+  }
+  if (table == nullptr || table->entries_count == 0u) {
+    return ArrayRef<const HintEntry>();
+  }
+  const HintEntry* begin = reinterpret_cast<const HintEntry*>(Begin() + table->entries_offset);
+  const HintEntry* end = begin + table->entries_count;
+  auto less_method = [](const HintEntry& entry, uint32_t idx) { return entry.method_idx < idx; };
+  const HintEntry* lo = std::lower_bound(begin, end, method_idx, less_method);
+  const HintEntry* hi = lo;
+  while (hi != end && hi->method_idx == method_idx) {
+    ++hi;
+  }
+  return ArrayRef<const HintEntry>(lo, hi - lo);
+}
+
+}  // namespace art
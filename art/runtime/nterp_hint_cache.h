@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_NTERP_HINT_CACHE_H_
+#define ART_RUNTIME_NTERP_HINT_CACHE_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "base/array_ref.h"
+#include "base/macros.h"
+#include "base/mem_map.h"
+
+namespace art {
+
+class DexFile;
+class VdexFile;
+
+// Read-only, memory-mapped interpretation hints produced offline and stored
+// next to the vdex file (`<vdex>.nhint`). The file is mapped MAP_SHARED so
+// all processes loading the same oat file share one copy of the page cache.
+//
+// Hints record what interpreted code re-learns in every process: the resolved
+// callee of hot invoke sites and the taken-ratio of hot branches, keyed by
+// (dex file, method index, dex pc). The runtime uses the callee hints to
+// pre-seed the dex cache when a class becomes runnable under nterp (see
+// NterpPreSeedInlineCaches() in nterp_helpers.h), replacing repeated
+// slow-path resolution in the class linker with a dex cache hit.
+//
+// In the description below, D is the number of dex files.
+//
+// File format (little-endian, all offsets from the start of the file):
+//   NterpHintCacheHeader   fixed-length header
+//   DexTableHeader[D]      one per dex file, same order as the vdex checksums
+//     uint32 dex_checksum       must match the vdex checksum at this index
+//     uint32 entries_offset     4-byte aligned
+//     uint32 entries_count
+//   HintEntry[][]          per-dex arrays, sorted by (method_idx, dex_pc)
+class NterpHintCache {
+ public:
+  static constexpr uint32_t kNoCalleeHint = 0xffffffffu;
+
+  struct HintEntry {
+    uint32_t method_idx;
+    uint32_t dex_pc;
+    // Method index (in the same dex file) of the observed monomorphic callee,
+    // or kNoCalleeHint for a branch-only entry.
+    uint32_t callee_method_idx;
+    // How often the branch at `dex_pc` was taken, in permille. Zero for
+    // invoke-site entries.
+    uint16_t branch_taken_permille;
+    uint16_t reserved;
+  };
+
+  struct NterpHintCacheHeader {
+    const char* GetMagic() const { return reinterpret_cast<const char*>(magic_); }
+    const char* GetVersion() const { return reinterpret_cast<const char*>(version_); }
+    uint32_t GetNumberOfDexFiles() const { return number_of_dex_files_; }
+    bool IsValid() const;
+
+    static constexpr uint8_t kNterpHintMagic[] = { 'n', 'h', 'c', '\0' };
+    static constexpr uint8_t kNterpHintVersion[] = { '0', '0', '1', '\0' };
+
+   private:
+    uint8_t magic_[4];
+    uint8_t version_[4];
+    uint32_t number_of_dex_files_;
+  };
+
+  struct DexTableHeader {
+    uint32_t dex_checksum;
+    uint32_t entries_offset;
+    uint32_t entries_count;
+  };
+
+  // Maps `<vdex location>.nhint` read-only and validates it against the vdex
+  // checksums. Returns null, without reporting an error, if no hint file
+  // exists; a present but malformed or stale file is logged and rejected.
+  static std::unique_ptr<NterpHintCache> OpenForVdex(const VdexFile& vdex);
+
+  // Returns the hint entries of `method_idx` in `dex_file`, sorted by dex pc.
+  // Empty if the dex file is not covered by this cache or has no hints.
+  ArrayRef<const HintEntry> GetMethodHints(const DexFile& dex_file, uint32_t method_idx) const;
+
+  const std::string& GetName() const { return mmap_.GetName(); }
+
+ private:
+  explicit NterpHintCache(MemMap&& mmap) : mmap_(std::move(mmap)) {}
+
+  bool Validate(const VdexFile& vdex) const;
+
+  const uint8_t* Begin() const { return mmap_.Begin(); }
+  size_t Size() const { return mmap_.Size(); }
+
+  const NterpHintCacheHeader& GetHeader() const {
+    return *reinterpret_cast<const NterpHintCacheHeader*>(Begin());
+  }
+
+  const DexTableHeader* GetDexTableHeaders() const {
+    return reinterpret_cast<const DexTableHeader*>(Begin() + sizeof(NterpHintCacheHeader));
+  }
+
+  MemMap mmap_;
+
+  DISALLOW_COPY_AND_ASSIGN(NterpHintCache);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_NTERP_HINT_CACHE_H_
@@ -83,6 +83,11 @@ inline const uint8_t* OatFile::OatMethod::GetVmapTable() const {
   return reinterpret_cast<const uint8_t*>(code) - offset;
 }
 
+inline bool OatFile::OatMethod::HasStackMapPcIndex() const {
+  const uint8_t* vmap_table = GetVmapTable();
+  return vmap_table != nullptr && CodeInfo::HasPcIndex(vmap_table);
+}
+
 inline uint32_t OatFile::OatMethod::GetQuickCodeSize() const {
   const void* code = EntryPointToCodePointer(GetQuickCode());
   if (code == nullptr) {
@@ -65,9 +65,11 @@
 #include "gc/space/image_space.h"
 #include "mirror/class.h"
 #include "mirror/object-inl.h"
+#include "nterp_hint_cache.h"
 #include "oat.h"
 #include "oat_file-inl.h"
 #include "oat_file_manager.h"
+#include "oat_page_tracer.h"
 #include "runtime-inl.h"
 #include "vdex_file.h"
 #include "verifier/verifier_deps.h"
@@ -232,6 +234,15 @@ OatFileBase* OatFileBase::OpenOatFile(int zip_fd,
     return nullptr;
   }
 
+  // Hand the mapped ranges to the page tracer: in recording mode this
+  // write-protects them to log first-touch order, in replay mode it
+  // prefetches the pages recorded by a previous run. No-op when disabled.
+  OatPageTracer::OnOatFileLoaded(ret.get());
+
+  if (ret->GetVdexFile() != nullptr) {
+    ret->nterp_hint_cache_ = NterpHintCache::OpenForVdex(*ret->GetVdexFile());
+  }
+
   return ret.release();
 }
 
@@ -273,6 +284,12 @@ OatFileBase* OatFileBase::OpenOatFile(int zip_fd,
     return nullptr;
   }
 
+  OatPageTracer::OnOatFileLoaded(ret.get());
+
+  if (ret->GetVdexFile() != nullptr) {
+    ret->nterp_hint_cache_ = NterpHintCache::OpenForVdex(*ret->GetVdexFile());
+  }
+
   return ret.release();
 }
 
@@ -2013,6 +2030,9 @@ OatFile::OatFile(const std::string& location, bool is_executable)
 }
 
 OatFile::~OatFile() {
+  // The mappings (including the vdex) are still alive here; in recording
+  // mode this is where the first-touch trace is written out.
+  OatPageTracer::OnOatFileUnloaded(this);
   STLDeleteElements(&oat_dex_files_storage_);
 }
 
@@ -43,6 +43,7 @@ class ElfFile;
 class DexLayoutSections;
 template <class MirrorType> class GcRoot;
 class MemMap;
+class NterpHintCache;
 class OatDexFile;
 class OatHeader;
 class OatMethodOffsets;
@@ -216,6 +217,10 @@ class OatFile {
     const uint8_t* GetVmapTable() const;
     uint32_t GetVmapTableOffset() const;
 
+    // Returns whether the method's CodeInfo carries the flat native-PC index
+    // trailer used for fast stack map lookup, see CodeInfo::HasPcIndex().
+    bool HasStackMapPcIndex() const;
+
     // Create an OatMethod with offsets relative to the given base address
     OatMethod(const uint8_t* base, const uint32_t code_offset)
         : begin_(base), code_offset_(code_offset) {
@@ -371,6 +376,12 @@ class OatFile {
     return vdex_.get();
   }
 
+  // Returns the offline-generated nterp interpretation hints stored next to
+  // the vdex file, or null if none exist for this oat file.
+  const NterpHintCache* GetNterpHintCache() const {
+    return nterp_hint_cache_.get();
+  }
+
   // Whether the OatFile embeds the Dex code.
   bool ContainsDexCode() const {
     return external_dex_files_.empty();
@@ -406,6 +417,9 @@ class OatFile {
   // Pointer to the Vdex file with the Dex files for this Oat file.
   std::unique_ptr<VdexFile> vdex_;
 
+  // Mapped interpretation hints for the vdex, if a hint file is present.
+  std::unique_ptr<NterpHintCache> nterp_hint_cache_;
+
   // Pointer to OatHeader.
   const uint8_t* begin_;
 
@@ -16,7 +16,9 @@
 
 #include "oat_file_assistant.h"
 
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 
 #include <sys/stat.h>
 #include "zlib.h"
@@ -56,6 +58,50 @@ static constexpr const char* kAnonymousDexPrefix = "Anonymous-DexFile@";
 static constexpr const char* kVdexExtension = ".vdex";
 static constexpr const char* kDmExtension = ".dm";
 
+namespace {
+
+// Process-wide cache of the dex checksums extracted for a location, validated against
+// the identity of the underlying file (device, inode, size and mtime). A location is
+// typically inspected several times in one process: once when deciding how to load it
+// and again for every query of its optimization status, and each extraction has to
+// open the zip file and walk its entries. With the cache, repeated inspections cost a
+// stat() and a map lookup. There is no eviction; the set of locations a process
+// inspects is small and bounded by its class loaders.
+struct DexChecksumCacheEntry {
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  struct timespec mtim;
+  bool zip_file_only_contains_uncompressed_dex;
+  std::vector<uint32_t> checksums;
+};
+
+std::mutex& GetDexChecksumCacheLock() {
+  static std::mutex lock;
+  return lock;
+}
+
+std::unordered_map<std::string, DexChecksumCacheEntry>& GetDexChecksumCache() {
+  static std::unordered_map<std::string, DexChecksumCacheEntry> cache;
+  return cache;
+}
+
+// Stat the file backing `dex_location`, preferring the file descriptor if one was
+// provided by the framework.
+bool GetDexFileIdentity(const std::string& dex_location, int zip_fd, /*out*/ struct stat* sb) {
+  return (zip_fd >= 0) ? (fstat(zip_fd, sb) == 0) : (stat(dex_location.c_str(), sb) == 0);
+}
+
+bool SameDexFileIdentity(const DexChecksumCacheEntry& entry, const struct stat& sb) {
+  return entry.dev == sb.st_dev &&
+         entry.ino == sb.st_ino &&
+         entry.size == sb.st_size &&
+         entry.mtim.tv_sec == sb.st_mtim.tv_sec &&
+         entry.mtim.tv_nsec == sb.st_mtim.tv_nsec;
+}
+
+}  // namespace
+
 std::ostream& operator << (std::ostream& stream, const OatFileAssistant::OatStatus status) {
   switch (status) {
     case OatFileAssistant::kOatCannotOpen:
@@ -619,6 +665,22 @@ const std::vector<uint32_t>* OatFileAssistant::GetRequiredDexChecksums() {
     required_dex_checksums_attempted_ = true;
     required_dex_checksums_found_ = false;
     cached_required_dex_checksums_.clear();
+    // Check the process-wide cache first. Only use it if we can establish the identity
+    // of the backing file, so that an updated APK is never served stale checksums.
+    struct stat file_identity;
+    bool have_file_identity = GetDexFileIdentity(dex_location_, zip_fd_, &file_identity);
+    if (have_file_identity) {
+      std::lock_guard<std::mutex> lock(GetDexChecksumCacheLock());
+      auto it = GetDexChecksumCache().find(dex_location_);
+      if (it != GetDexChecksumCache().end() && SameDexFileIdentity(it->second, file_identity)) {
+        cached_required_dex_checksums_ = it->second.checksums;
+        zip_file_only_contains_uncompressed_dex_ =
+            it->second.zip_file_only_contains_uncompressed_dex;
+        required_dex_checksums_found_ = true;
+        has_original_dex_files_ = true;
+        return &cached_required_dex_checksums_;
+      }
+    }
     std::string error_msg;
     const ArtDexFileLoader dex_file_loader;
     std::vector<std::string> dex_locations_ignored;
@@ -630,8 +692,20 @@ const std::vector<uint32_t>* OatFileAssistant::GetRequiredDexChecksums() {
                                              &zip_file_only_contains_uncompressed_dex_)) {
       required_dex_checksums_found_ = true;
       has_original_dex_files_ = true;
+      if (have_file_identity) {
+        DexChecksumCacheEntry entry;
+        entry.dev = file_identity.st_dev;
+        entry.ino = file_identity.st_ino;
+        entry.size = file_identity.st_size;
+        entry.mtim = file_identity.st_mtim;
+        entry.zip_file_only_contains_uncompressed_dex = zip_file_only_contains_uncompressed_dex_;
+        entry.checksums = cached_required_dex_checksums_;
+        std::lock_guard<std::mutex> lock(GetDexChecksumCacheLock());
+        GetDexChecksumCache()[dex_location_] = std::move(entry);
+      }
     } else {
-      // The only valid case here is for APKs without dex files.
+      // The only valid case here is for APKs without dex files. Do not cache failures;
+      // they are cheap to rediscover and keeping only successes keeps the cache simple.
       required_dex_checksums_found_ = false;
       has_original_dex_files_ = false;
       VLOG(oat) << "Could not get required checksum: " << error_msg;
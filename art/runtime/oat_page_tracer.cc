@@ -0,0 +1,309 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "oat_page_tracer.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base/globals.h"
+#include "base/logging.h"  // For VLOG.
+#include "oat_file.h"
+#include "vdex_file.h"
+
+namespace art {
+
+namespace {
+
+// A traced range is one mmap-ed span handed to us by OnOatFileLoaded (the
+// oat mapping or the vdex mapping). Because a single oat mapping contains
+// segments with different protections (rodata vs text), each range is split
+// into regions along the boundaries found in /proc/self/maps, and each
+// region remembers the protection to restore on first touch.
+constexpr size_t kMaxRanges = 64;
+constexpr size_t kMaxRegions = 256;
+// Global first-touch log. 32Ki entries cover far more pages than an app
+// touches during launch; later faults are still restored, just not logged.
+constexpr size_t kLogCapacity = 32 * 1024;
+
+struct TracedRegion {
+  // Nonzero once the region is live; published last (release) so the fault
+  // handler sees consistent end/prot/range fields. Cleared on unload.
+  std::atomic<uintptr_t> begin{0};
+  uintptr_t end = 0;
+  int prot = 0;
+  uint32_t range_index = 0;
+};
+
+struct TracedRange {
+  const OatFile* owner = nullptr;
+  uintptr_t begin = 0;
+  uintptr_t end = 0;
+  std::string trace_path;
+  bool active = false;
+};
+
+// Fast-path gate for the fault handler: the number of live regions.
+std::atomic<size_t> g_active_regions{0};
+
+// The log packs (range_index + 1) in the top 16 bits and the page index
+// (relative to the range begin) in the low 48; zero means "not yet
+// written", so a reader racing the fetch_add below simply skips the slot.
+std::atomic<uint64_t> g_fault_log[kLogCapacity];
+std::atomic<uint32_t> g_fault_log_next{0};
+
+// Registration, unload and trace I/O happen on normal threads under this
+// lock. The fault handler only reads the atomics and immutable region
+// fields and never takes it.
+std::mutex g_tracer_mutex;
+TracedRegion g_regions[kMaxRegions];
+size_t g_num_regions = 0;  // Slots are never reused; see OnOatFileUnloaded.
+TracedRange g_ranges[kMaxRanges];
+size_t g_num_ranges = 0;
+
+enum class TracerMode {
+  kDisabled,
+  kRecord,
+  kReplay,
+};
+
+TracerMode GetMode() {
+  static const TracerMode mode = []() {
+    const char* dir = getenv("ART_OAT_PAGE_TRACE_DIR");
+    if (dir == nullptr || dir[0] == '\0') {
+      return TracerMode::kDisabled;
+    }
+    const char* record = getenv("ART_OAT_PAGE_TRACE_RECORD");
+    if (record != nullptr && (strcmp(record, "true") == 0 || strcmp(record, "1") == 0)) {
+      return TracerMode::kRecord;
+    }
+    return TracerMode::kReplay;
+  }();
+  return mode;
+}
+
+std::string MakeTracePath(const std::string& location) {
+  const char* dir = getenv("ART_OAT_PAGE_TRACE_DIR");
+  size_t slash = location.rfind('/');
+  std::string base = (slash == std::string::npos) ? location : location.substr(slash + 1);
+  return std::string(dir) + "/" + base + ".oatpages";
+}
+
+uint64_t PackLogEntry(uint32_t range_index, uint64_t page_index) {
+  return (static_cast<uint64_t>(range_index + 1) << 48) | (page_index + 1);
+}
+
+// Write-protects the readable, non-writable mappings inside [begin, end) and
+// records them as regions. Writable mappings (.data.bimg.rel.ro before it is
+// sealed, .bss) are left alone: they are either written by the runtime
+// itself or not file-backed, and protecting them would trace our own stores.
+void ProtectRange(uint32_t range_index, uintptr_t begin, uintptr_t end) {
+  FILE* maps = fopen("/proc/self/maps", "re");
+  if (maps == nullptr) {
+    PLOG(WARNING) << "OatPageTracer: unable to read /proc/self/maps";
+    return;
+  }
+  char line[512];
+  while (fgets(line, sizeof(line), maps) != nullptr) {
+    uintptr_t map_begin = 0;
+    uintptr_t map_end = 0;
+    char perms[5] = {};
+    if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR " %4s", &map_begin, &map_end, perms) != 3) {
+      continue;
+    }
+    uintptr_t lo = std::max(map_begin, begin);
+    uintptr_t hi = std::min(map_end, end);
+    if (lo >= hi || perms[0] != 'r' || perms[1] == 'w') {
+      continue;
+    }
+    if (g_num_regions == kMaxRegions) {
+      LOG(WARNING) << "OatPageTracer: out of region slots; range only partially traced";
+      break;
+    }
+    int prot = PROT_READ | (perms[2] == 'x' ? PROT_EXEC : 0);
+    if (mprotect(reinterpret_cast<void*>(lo), hi - lo, PROT_NONE) != 0) {
+      PLOG(WARNING) << "OatPageTracer: mprotect(PROT_NONE) failed for region at " << lo;
+      continue;
+    }
+    TracedRegion& region = g_regions[g_num_regions++];
+    region.end = hi;
+    region.prot = prot;
+    region.range_index = range_index;
+    region.begin.store(lo, std::memory_order_release);
+    g_active_regions.fetch_add(1, std::memory_order_relaxed);
+  }
+  fclose(maps);
+}
+
+// Reads a recorded trace and prefetches its pages. Consecutive page runs are
+// coalesced into single madvise calls; order within the file is preserved so
+// the kernel queues reads roughly in first-touch order.
+void ApplyReadahead(const std::string& trace_path, uintptr_t begin, uintptr_t end) {
+  std::ifstream in(trace_path);
+  if (!in.is_open()) {
+    return;  // No trace recorded yet for this oat file.
+  }
+  const uint64_t num_pages = (end - begin) / kPageSize;
+  std::vector<uint64_t> pages;
+  uint64_t page;
+  while (in >> page) {
+    if (page < num_pages) {
+      pages.push_back(page);
+    }
+  }
+  size_t advised = 0;
+  for (size_t i = 0; i < pages.size();) {
+    size_t run = 1;
+    while (i + run < pages.size() && pages[i + run] == pages[i] + run) {
+      run++;
+    }
+    void* addr = reinterpret_cast<void*>(begin + pages[i] * kPageSize);
+    if (madvise(addr, run * kPageSize, MADV_WILLNEED) == 0) {
+      advised += run;
+    }
+    i += run;
+  }
+  VLOG(oat) << "OatPageTracer: prefetched " << advised << " pages from " << trace_path;
+}
+
+// Writes the first-touch page order of `range_index` from the global log.
+// Duplicates can appear when two threads fault the same page concurrently
+// (both log it, both restore it); keep the first occurrence only.
+void DumpTrace(const TracedRange& range, uint32_t range_index) {
+  std::ofstream out(range.trace_path, std::ios::trunc);
+  if (!out.is_open()) {
+    PLOG(WARNING) << "OatPageTracer: unable to write " << range.trace_path;
+    return;
+  }
+  const uint32_t count =
+      std::min<uint32_t>(g_fault_log_next.load(std::memory_order_relaxed), kLogCapacity);
+  std::vector<uint64_t> seen;
+  for (uint32_t i = 0; i < count; i++) {
+    uint64_t entry = g_fault_log[i].load(std::memory_order_acquire);
+    if (entry == 0 || (entry >> 48) != range_index + 1u) {
+      continue;
+    }
+    uint64_t page = (entry & ((UINT64_C(1) << 48) - 1)) - 1;
+    if (std::find(seen.begin(), seen.end(), page) == seen.end()) {
+      seen.push_back(page);
+      out << page << "\n";
+    }
+  }
+  VLOG(oat) << "OatPageTracer: recorded " << seen.size() << " pages to " << range.trace_path;
+}
+
+void RegisterRange(const OatFile* owner,
+                   const std::string& location,
+                   const uint8_t* begin,
+                   const uint8_t* end) {
+  if (begin == nullptr || end <= begin) {
+    return;
+  }
+  if (g_num_ranges == kMaxRanges) {
+    LOG(WARNING) << "OatPageTracer: out of range slots, not tracing " << location;
+    return;
+  }
+  uint32_t range_index = g_num_ranges++;
+  TracedRange& range = g_ranges[range_index];
+  range.owner = owner;
+  range.begin = reinterpret_cast<uintptr_t>(begin);
+  range.end = reinterpret_cast<uintptr_t>(end);
+  range.trace_path = MakeTracePath(location);
+  range.active = true;
+  if (GetMode() == TracerMode::kRecord) {
+    ProtectRange(range_index, range.begin, range.end);
+  } else {
+    ApplyReadahead(range.trace_path, range.begin, range.end);
+  }
+}
+
+}  // namespace
+
+void OatPageTracer::OnOatFileLoaded(const OatFile* oat_file) {
+  if (GetMode() == TracerMode::kDisabled) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(g_tracer_mutex);
+  RegisterRange(oat_file, oat_file->GetLocation(), oat_file->Begin(), oat_file->End());
+  const VdexFile* vdex = oat_file->GetVdexFile();
+  if (vdex != nullptr) {
+    RegisterRange(oat_file, oat_file->GetLocation() + "!vdex", vdex->Begin(), vdex->End());
+  }
+}
+
+void OatPageTracer::OnOatFileUnloaded(const OatFile* oat_file) {
+  if (GetMode() == TracerMode::kDisabled) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(g_tracer_mutex);
+  for (uint32_t range_index = 0; range_index < g_num_ranges; range_index++) {
+    TracedRange& range = g_ranges[range_index];
+    if (!range.active || range.owner != oat_file) {
+      continue;
+    }
+    // Retire the regions first so no new log entries appear for this range.
+    // Region slots stay retired forever: a fault racing the unload may still
+    // be reading end/prot, which therefore must never be reassigned.
+    for (size_t i = 0; i < g_num_regions; i++) {
+      if (g_regions[i].range_index == range_index &&
+          g_regions[i].begin.load(std::memory_order_relaxed) != 0) {
+        g_regions[i].begin.store(0, std::memory_order_release);
+        g_active_regions.fetch_sub(1, std::memory_order_relaxed);
+      }
+    }
+    if (GetMode() == TracerMode::kRecord) {
+      DumpTrace(range, range_index);
+    }
+    range.active = false;
+    range.owner = nullptr;
+  }
+}
+
+bool OatPageTracer::HandleTracedPageFault(uintptr_t fault_address) {
+  if (g_active_regions.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < kMaxRegions; i++) {
+    const uintptr_t begin = g_regions[i].begin.load(std::memory_order_acquire);
+    if (begin == 0 || fault_address < begin || fault_address >= g_regions[i].end) {
+      continue;
+    }
+    const uintptr_t page_begin = fault_address & ~(kPageSize - 1);
+    const uintptr_t range_begin = g_ranges[g_regions[i].range_index].begin;
+    const uint32_t slot = g_fault_log_next.fetch_add(1, std::memory_order_relaxed);
+    if (slot < kLogCapacity) {
+      g_fault_log[slot].store(
+          PackLogEntry(g_regions[i].range_index, (page_begin - range_begin) / kPageSize),
+          std::memory_order_release);
+    }
+    // Restore the whole page. If another thread faulted the same page and
+    // won the race, this mprotect is a no-op and the access still succeeds.
+    return mprotect(reinterpret_cast<void*>(page_begin), kPageSize, g_regions[i].prot) == 0;
+  }
+  return false;
+}
+
+}  // namespace art
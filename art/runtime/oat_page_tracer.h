@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_OAT_PAGE_TRACER_H_
+#define ART_RUNTIME_OAT_PAGE_TRACER_H_
+
+#include <stdint.h>
+
+#include "base/macros.h"
+
+namespace art {
+
+class OatFile;
+
+// Records the order in which the pages of mmap-ed oat and vdex files are
+// first touched, and replays a previously recorded order as readahead.
+//
+// A plain mmap page-in is a minor/major fault handled entirely by the kernel
+// and never raises SIGSEGV, so first-touch order cannot be observed
+// passively. In recording mode the tracer instead write-protects the mapped
+// ranges (PROT_NONE) when an oat file is loaded; the first access to each
+// page then faults, the fault handler logs the page and restores the
+// original protection, and execution resumes. The resulting per-oat-file
+// trace lists page indices in first-touch order. In replay mode the tracer
+// reads that trace at load time and issues madvise(MADV_WILLNEED) over the
+// recorded pages so the next launch pages them in ahead of use.
+//
+// Controlled by environment variables so it can be enabled per-process
+// before the runtime starts:
+//   ART_OAT_PAGE_TRACE_DIR     directory for trace files; unset disables
+//                              the tracer entirely.
+//   ART_OAT_PAGE_TRACE_RECORD  "true"/"1" selects recording mode; anything
+//                              else selects replay.
+class OatPageTracer {
+ public:
+  // Registers the oat and vdex mappings of a fully set up oat file. In
+  // recording mode this write-protects them; in replay mode it applies the
+  // readahead from an existing trace. No-op when the tracer is disabled.
+  static void OnOatFileLoaded(const OatFile* oat_file);
+
+  // Unregisters the mappings and, in recording mode, writes out the trace.
+  // Must be called before the mappings are torn down.
+  static void OnOatFileUnloaded(const OatFile* oat_file);
+
+  // Called from the SIGSEGV handler with the faulting address. If the
+  // address lies in a traced range, logs the page, restores the original
+  // protection and returns true (the faulting access can be retried).
+  // Async-signal-safe; costs a single relaxed atomic load when no ranges
+  // are registered.
+  static bool HandleTracedPageFault(uintptr_t fault_address);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(OatPageTracer);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_OAT_PAGE_TRACER_H_
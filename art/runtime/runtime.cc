@@ -102,6 +102,7 @@
 #include "jni_id_type.h"
 #include "linear_alloc.h"
 #include "memory_representation.h"
+#include "method_handles.h"
 #include "mirror/array.h"
 #include "mirror/class-alloc-inl.h"
 #include "mirror/class-inl.h"
@@ -191,6 +192,9 @@ namespace apex = com::android::apex;
 
 namespace art {
 
+// Subsystem names in the deferred init registry.
+static constexpr const char* kDeferredInitMetrics = "metrics";
+
 // If a signal isn't handled properly, enable a handler that attempts to dump the Java stack.
 static constexpr bool kEnableJavaStackTraceHandler = false;
 // Tuned by compiling GmsCore under perf and measuring time spent in DescriptorEquals for class
@@ -788,6 +792,7 @@ void Runtime::SweepSystemWeaks(IsMarkedVisitor* visitor) {
     GetJit()->GetCodeCache()->SweepRootTables(visitor);
   }
   Thread::SweepInterpreterCaches(visitor);
+  SweepMethodHandleDispatchCache(visitor);
 
   // All other generic system-weak holders.
   for (gc::AbstractSystemWeakHolder* holder : system_weak_holders_) {
@@ -1164,6 +1169,8 @@ void Runtime::InitNonZygoteOrPostFork(
   heap_->ResetGcPerformanceInfo();
   GetMetrics()->Reset();
 
+  deferred_init_registry_.RunUpToPhase(DeferredInitRegistry::Phase::kPostZygoteFork);
+
   if (metrics_reporter_ != nullptr) {
     // Now that we know if we are an app or system server, reload the metrics reporter config
     // in case there are any difference.
@@ -1952,7 +1959,15 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   // Class-roots are setup, we can now finish initializing the JniIdManager.
   GetJniIdManager()->Init(self);
 
-  InitMetrics();
+  // Creating the metrics reporter is not needed before any code runs; defer
+  // it so the zygote and AOT runtimes do not pay for it. Forked children
+  // create it at the post-fork boundary, where its config is reloaded with
+  // the app/system-server distinction anyway.
+  deferred_init_registry_.Register(
+      kDeferredInitMetrics,
+      DeferredInitRegistry::Phase::kPostZygoteFork,
+      /*dependencies=*/ std::vector<std::string>(),
+      [](Runtime* runtime) { runtime->InitMetrics(); });
 
   // Runtime initialization is largely done now.
   // We load plugins first since that can modify the runtime state slightly.
@@ -2042,6 +2057,8 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
     dlopen(plugin_name, RTLD_NOW | RTLD_LOCAL);
   }
 
+  deferred_init_registry_.RunUpToPhase(DeferredInitRegistry::Phase::kRuntimeInitDone);
+
   VLOG(startup) << "Runtime::Init exiting";
 
   return true;
@@ -2053,6 +2070,7 @@ void Runtime::InitMetrics() {
 }
 
 void Runtime::RequestMetricsReport(bool synchronous) {
+  deferred_init_registry_.EnsureInitialized(kDeferredInitMetrics);
   if (metrics_reporter_) {
     metrics_reporter_->RequestMetricsReport(synchronous);
   }
@@ -2274,6 +2292,7 @@ void Runtime::DumpForSigQuit(std::ostream& os) {
   GetInternTable()->DumpForSigQuit(os);
   GetJavaVM()->DumpForSigQuit(os);
   GetHeap()->DumpForSigQuit(os);
+  gc::space::Space::DumpAllTelemetry(os);
   oat_file_manager_->DumpForSigQuit(os);
   if (GetJit() != nullptr) {
     GetJit()->DumpForSigQuit(os);
@@ -2283,6 +2302,7 @@ void Runtime::DumpForSigQuit(std::ostream& os) {
   DumpDeoptimizations(os);
   TrackedAllocators::Dump(os);
   GetMetrics()->DumpForSigQuit(os);
+  GetInstrumentation()->DumpMethodSamples(os);
   os << "\n";
 
   thread_list_->DumpForSigQuit(os);
@@ -3283,6 +3303,9 @@ void Runtime::NotifyStartupCompleted() {
     return;
   }
 
+  // First frame is done; anything still deferred must be initialized now.
+  deferred_init_registry_.RunUpToPhase(DeferredInitRegistry::Phase::kStartupCompleted);
+
   VLOG(startup) << app_info_;
 
   VLOG(startup) << "Adding NotifyStartupCompleted task";
@@ -35,6 +35,7 @@
 #include "base/metrics/metrics.h"
 #include "base/string_view_cpp20.h"
 #include "compat_framework.h"
+#include "deferred_init.h"
 #include "deoptimization_kind.h"
 #include "dex/dex_file_types.h"
 #include "experimental_flags.h"
@@ -1057,6 +1058,8 @@ class Runtime {
 
   AppInfo* GetAppInfo() { return &app_info_; }
 
+  DeferredInitRegistry* GetDeferredInitRegistry() { return &deferred_init_registry_; }
+
   void RequestMetricsReport(bool synchronous = true);
 
   static void MadviseFileForRange(size_t madvise_size_limit_bytes,
@@ -1487,6 +1490,10 @@ class Runtime {
   // The info about the application code paths.
   AppInfo app_info_;
 
+  // Thunks for non-critical subsystems whose initialization is deferred out
+  // of Init() to their first use or to a later phase boundary.
+  DeferredInitRegistry deferred_init_registry_;
+
   // Note: See comments on GetFaultMessage.
   friend std::string GetFaultMessageForAbortLogging();
   friend class Dex2oatImageTest;
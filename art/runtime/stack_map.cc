@@ -16,7 +16,9 @@
 
 #include "stack_map.h"
 
+#include <algorithm>
 #include <iomanip>
+#include <limits>
 #include <stdint.h>
 
 #include "art_method.h"
@@ -30,6 +32,7 @@ namespace art {
 // The callback is used to inform the caller about memory bounds of the bit-tables.
 template<typename DecodeCallback>
 CodeInfo::CodeInfo(const uint8_t* data, size_t* num_read_bits, DecodeCallback callback) {
+  data_ = data;
   BitMemoryReader reader(data);
   std::array<uint32_t, kNumHeaders> header = reader.ReadInterleavedVarints<kNumHeaders>();
   ForEachHeaderField([this, &header](size_t i, auto member_pointer) ALWAYS_INLINE {
@@ -53,6 +56,11 @@ CodeInfo::CodeInfo(const uint8_t* data, size_t* num_read_bits, DecodeCallback ca
   if (num_read_bits != nullptr) {
     *num_read_bits = reader.NumberOfReadBits();
   }
+  if (UNLIKELY((flags_ & kHasPcIndex) != 0)) {
+    // The flat PC index trails the main bit-table stream, 2-byte aligned.
+    const uint8_t* end = data + BitsToBytesRoundUp(reader.NumberOfReadBits());
+    pc_index_ = reinterpret_cast<const uint16_t*>(AlignUp(end, alignof(uint16_t)));
+  }
 }
 
 CodeInfo::CodeInfo(const uint8_t* data, size_t* num_read_bits)
@@ -64,6 +72,7 @@ CodeInfo::CodeInfo(const OatQuickMethodHeader* header)
 CodeInfo CodeInfo::DecodeGcMasksOnly(const OatQuickMethodHeader* header) {
   CodeInfo code_info(header->GetOptimizedCodeInfoPtr());
   CodeInfo copy;  // Copy to dead-code-eliminate all fields that we do not need.
+  copy.data_ = code_info.data_;
   copy.stack_maps_ = code_info.stack_maps_;
   copy.register_masks_ = code_info.register_masks_;
   copy.stack_masks_ = code_info.stack_masks_;
@@ -73,6 +82,7 @@ CodeInfo CodeInfo::DecodeGcMasksOnly(const OatQuickMethodHeader* header) {
 CodeInfo CodeInfo::DecodeInlineInfoOnly(const OatQuickMethodHeader* header) {
   CodeInfo code_info(header->GetOptimizedCodeInfoPtr());
   CodeInfo copy;  // Copy to dead-code-eliminate all fields that we do not need.
+  copy.data_ = code_info.data_;
   copy.number_of_dex_registers_ = code_info.number_of_dex_registers_;
   copy.stack_maps_ = code_info.stack_maps_;
   copy.inline_infos_ = code_info.inline_infos_;
@@ -80,8 +90,83 @@ CodeInfo CodeInfo::DecodeInlineInfoOnly(const OatQuickMethodHeader* header) {
   return copy;
 }
 
+namespace {
+
+// Small per-thread cache of recent GetStackMapForNativePcOffset() results. Exception
+// delivery, deoptimization and GC stack walks repeatedly visit the same frames, and each
+// visit re-runs a bit-granular binary search over the method's stack map table; the cache
+// turns the repeated lookups into a single probe. An entry is keyed by the encoded
+// CodeInfo data pointer and the packed pc, and the cached row is re-validated against the
+// current table contents before use, so a stale entry (e.g. after JIT code was released
+// and its range reused) costs at worst a fresh search.
+struct StackMapLookupCache {
+  struct Entry {
+    const uint8_t* code_info_data = nullptr;
+    uint32_t packed_pc = 0u;
+    uint32_t row = 0u;
+  };
+
+  static constexpr size_t kNumEntries = 16u;  // Direct-mapped; hot walks touch few methods.
+
+  Entry* EntryFor(const uint8_t* code_info_data, uint32_t packed_pc) {
+    size_t hash = (reinterpret_cast<uintptr_t>(code_info_data) >> 4) ^ packed_pc;
+    return &entries[hash % kNumEntries];
+  }
+
+  Entry entries[kNumEntries];
+};
+
+thread_local StackMapLookupCache gStackMapLookupCache;
+
+}  // namespace
+
 StackMap CodeInfo::GetStackMapForNativePcOffset(uintptr_t pc, InstructionSet isa) const {
   uint32_t packed_pc = StackMap::PackNativePc(pc, isa);
+  StackMapLookupCache::Entry* entry = nullptr;
+  if (data_ != nullptr) {
+    entry = gStackMapLookupCache.EntryFor(data_, packed_pc);
+    if (entry->code_info_data == data_ &&
+        entry->packed_pc == packed_pc &&
+        entry->row < stack_maps_.NumRows()) {
+      StackMap stack_map = GetStackMapAt(entry->row);
+      StackMap::Kind kind = static_cast<StackMap::Kind>(stack_map.GetKind());
+      if (stack_map.GetNativePcOffset(isa) == pc &&
+          (kind == StackMap::Kind::Default || kind == StackMap::Kind::OSR)) {
+        DCHECK_EQ(stack_map.Row(), SearchStackMapForNativePcOffset(pc, isa).Row());
+        return stack_map;
+      }
+    }
+  }
+  StackMap stack_map = SearchStackMapForNativePcOffset(pc, isa);
+  if (stack_map.IsValid() && entry != nullptr) {
+    *entry = StackMapLookupCache::Entry{data_, packed_pc, stack_map.Row()};
+  }
+  return stack_map;
+}
+
+StackMap CodeInfo::SearchStackMapForNativePcOffset(uintptr_t pc, InstructionSet isa) const {
+  uint32_t packed_pc = StackMap::PackNativePc(pc, isa);
+  if (pc_index_ != nullptr && packed_pc <= std::numeric_limits<uint16_t>::max()) {
+    // Binary search over the persisted flat index: plain halfword loads per
+    // probe instead of bit-field extraction. Entry i holds the packed PC of
+    // stack map row i; catch stack maps follow the indexed prefix and are
+    // never returned here.
+    const uint16_t num_entries = pc_index_[0];
+    const uint16_t* pcs = pc_index_ + 1;
+    const uint16_t* lower =
+        std::lower_bound(pcs, pcs + num_entries, static_cast<uint16_t>(packed_pc));
+    for (uint32_t row = dchecked_integral_cast<uint32_t>(lower - pcs);
+         row != num_entries && pcs[row] == packed_pc;
+         ++row) {
+      StackMap stack_map = GetStackMapAt(row);
+      StackMap::Kind kind = static_cast<StackMap::Kind>(stack_map.GetKind());
+      if (kind == StackMap::Kind::Default || kind == StackMap::Kind::OSR) {
+        DCHECK_EQ(stack_map.GetNativePcOffset(isa), pc);
+        return stack_map;
+      }
+    }
+    return stack_maps_.GetInvalidRow();
+  }
   // Binary search.  All catch stack maps are stored separately at the end.
   auto it = std::partition_point(
       stack_maps_.begin(),
@@ -449,12 +449,21 @@ class CodeInfo {
     return (*code_info_data & kIsBaseline) != 0;
   }
 
+  // Returns whether the encoded data carries a flat native-PC index trailer,
+  // see the comment on `pc_index_data_`.
+  ALWAYS_INLINE static bool HasPcIndex(const uint8_t* code_info_data) {
+    return (*code_info_data & kHasPcIndex) != 0;
+  }
+
  private:
   // Scan backward to determine dex register locations at given stack map.
   void DecodeDexRegisterMap(uint32_t stack_map_index,
                             uint32_t first_dex_register,
                             /*out*/ DexRegisterMap* map) const;
 
+  // Binary search for the stack map, used on a miss in the per-thread lookup cache.
+  StackMap SearchStackMapForNativePcOffset(uintptr_t pc, InstructionSet isa) const;
+
   template<typename DecodeCallback>  // (size_t index, BitTable<...>*, BitMemoryRegion).
   ALWAYS_INLINE CodeInfo(const uint8_t* data, size_t* num_read_bits, DecodeCallback callback);
 
@@ -495,6 +504,8 @@ class CodeInfo {
   enum Flags {
     kHasInlineInfo = 1 << 0,
     kIsBaseline = 1 << 1,
+    // A flat sorted uint16_t native-PC index follows the bit tables.
+    kHasPcIndex = 1 << 2,
   };
 
   // The CodeInfo starts with sequence of variable-length bit-encoded integers.
@@ -507,6 +518,20 @@ class CodeInfo {
   uint32_t number_of_dex_registers_ = 0;
   uint32_t bit_table_flags_ = 0;
 
+  // The encoded data this CodeInfo was decoded from, used as the identity of the method's
+  // tables in the per-thread stack map lookup cache. Null when decoded from a header-only
+  // or statically constructed CodeInfo, which simply bypasses the cache.
+  const uint8_t* data_ = nullptr;
+
+  // Optional flat index over the stack map table, persisted by dex2oat when
+  // `kHasPcIndex` is set: a uint16_t entry count followed by that many sorted
+  // uint16_t packed native PCs, one per non-catch stack map row, 2-byte
+  // aligned after the main bit-table stream. PC lookup binary-searches these
+  // plain halfwords and only bit-decodes the final row, instead of extracting
+  // a bit-packed PC on every probe. The writer only emits the index when all
+  // packed PCs of the method fit in 16 bits. Null when absent.
+  const uint16_t* pc_index_ = nullptr;
+
   // The encoded bit-tables follow the header.  Based on the above flags field,
   // bit-tables might be omitted or replaced by relative bit-offset if deduped.
   static constexpr size_t kNumBitTables = 8;
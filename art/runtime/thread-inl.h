@@ -248,6 +248,17 @@ inline void Thread::TransitionFromRunnableToSuspended(ThreadState new_state) {
   AssertThreadSuspensionIsAllowable();
   PoisonObjectPointersIfDebug();
   DCHECK_EQ(this, Thread::Current());
+  if (UNLIKELY(tls32_.extended_native_window_depth != 0u) &&
+      new_state == ThreadState::kNative) {
+    // Within an extended native window we stay runnable across the native call, keeping
+    // our share of the mutator lock. The matching TransitionFromSuspendedToRunnable()
+    // unwinds the elision and honors any suspend or checkpoint request that arrived
+    // meanwhile, see EnterExtendedNativeWindow(). JNI stubs that inlined the transition
+    // fast path did not get here and have already left the runnable state; they are
+    // unaffected by the window.
+    tls32_.extended_native_window_elisions++;
+    return;
+  }
   // Change to non-runnable state, thereby appearing suspended to the system.
   TransitionToSuspendedAndRunCheckpoints(new_state);
   // Mark the release of the share of the mutator lock.
@@ -265,6 +276,19 @@ inline ThreadState Thread::TransitionFromSuspendedToRunnable() {
   // on some flag being set, so that the JNI stub can take the slow path to get here.
   StateAndFlags old_state_and_flags = GetStateAndFlags(std::memory_order_relaxed);
   ThreadState old_state = old_state_and_flags.GetState();
+  if (UNLIKELY(tls32_.extended_native_window_elisions != 0u) &&
+      old_state == ThreadState::kRunnable) {
+    // Matching exit for a runnable -> native transition elided by an extended native
+    // window; we kept our share of the mutator lock. This is the window's asynchronous
+    // flag check: honor any suspend or checkpoint request that arrived while the native
+    // call was running. A non-elided transition taken inside the window (e.g. to
+    // kBlocked) leaves the runnable state and falls through to the normal path below.
+    tls32_.extended_native_window_elisions--;
+    if (UNLIKELY(old_state_and_flags.IsAnyOfFlagsSet(SuspendOrCheckpointRequestFlags()))) {
+      CheckSuspend();
+    }
+    return ThreadState::kNative;
+  }
   DCHECK_NE(old_state, ThreadState::kRunnable);
   while (true) {
     GetMutatorLock()->AssertNotHeld(this);  // Otherwise we starve GC.
@@ -1903,6 +1903,24 @@ void Thread::FullSuspendCheck(bool implicit) {
   VLOG(threads) << this << " self-reviving";
 }
 
+void Thread::EnterExtendedNativeWindow() {
+  DCHECK_EQ(this, Thread::Current());
+  DCHECK_EQ(GetState(), ThreadState::kRunnable);
+  tls32_.extended_native_window_depth++;
+}
+
+void Thread::ExitExtendedNativeWindow() {
+  DCHECK_EQ(this, Thread::Current());
+  DCHECK_EQ(GetState(), ThreadState::kRunnable);
+  DCHECK_NE(tls32_.extended_native_window_depth, 0u);
+  tls32_.extended_native_window_depth--;
+  // Honor any requests that arrived while call boundaries were being elided.
+  if (UNLIKELY(GetStateAndFlags(std::memory_order_relaxed)
+                   .IsAnyOfFlagsSet(SuspendOrCheckpointRequestFlags()))) {
+    CheckSuspend();
+  }
+}
+
 static std::string GetSchedulerGroupName(pid_t tid) {
   // /proc/<pid>/cgroup looks like this:
   // 2:devices:/
@@ -2604,6 +2622,12 @@ Thread::~Thread() {
   SetCachedThreadName(nullptr);  // Deallocate name.
   delete tlsPtr_.deps_or_stack_trace_sample.stack_trace_sample;
 
+  while (tlsPtr_.handle_scope_storage_cache != nullptr) {
+    void* storage = tlsPtr_.handle_scope_storage_cache;
+    tlsPtr_.handle_scope_storage_cache = *reinterpret_cast<void**>(storage);
+    ::operator delete(storage);
+  }
+
   Runtime::Current()->GetHeap()->AssertThreadLocalBuffersAreRevoked(this);
 
   TearDownAlternateSignalStack();
@@ -398,6 +398,24 @@ class Thread {
       REQUIRES(!Locks::thread_suspend_count_lock_, !Roles::uninterruptible_)
       UNLOCK_FUNCTION(Locks::mutator_lock_);
 
+  // An extended native window elides the per-call runnable <-> native transitions for
+  // down-call-heavy JNI workloads. While the window is open the thread remains runnable
+  // (keeping its share of the mutator lock) across paired native transitions, so each
+  // elided JNI call boundary costs a couple of plain loads instead of two atomic state
+  // changes. Pending suspend and checkpoint requests are honored at every elided
+  // call-return boundary and when the window is closed, so the suspend machinery sees
+  // a runnable thread that polls at the same points where it used to transition.
+  // The native code run inside a window must follow @CriticalNative rules: no blocking,
+  // no unbounded work, since the thread appears runnable to SuspendAll() throughout.
+  // Windows nest; they must be entered and exited in the runnable state.
+  // Note: JNI stubs that inline the transition fast path do not consult the window;
+  // calls through such stubs keep their inline transitions and remain correct.
+  void EnterExtendedNativeWindow() REQUIRES_SHARED(Locks::mutator_lock_);
+  void ExitExtendedNativeWindow() REQUIRES_SHARED(Locks::mutator_lock_);
+  bool InExtendedNativeWindow() const {
+    return tls32_.extended_native_window_depth != 0u;
+  }
+
   // Once called thread suspension will cause an assertion failure.
   const char* StartAssertNoThreadSuspension(const char* cause) ACQUIRE(Roles::uninterruptible_) {
     Roles::uninterruptible_.Acquire();  // No-op.
@@ -974,6 +992,30 @@ class Thread {
     return handle_scope;
   }
 
+  // Pop a recycled storage block for a VariableSizedHandleScope local scope, or
+  // null if the cache is empty. The cache is only ever touched by this thread,
+  // so no synchronization is needed.
+  void* TryPopHandleScopeStorage() {
+    void* storage = tlsPtr_.handle_scope_storage_cache;
+    if (storage != nullptr) {
+      tlsPtr_.handle_scope_storage_cache = *reinterpret_cast<void**>(storage);
+      --tls32_.handle_scope_storage_cache_size;
+    }
+    return storage;
+  }
+
+  // Cache a storage block for reuse by a later VariableSizedHandleScope.
+  // Returns false if the cache is full; the caller then frees the block itself.
+  bool TryPushHandleScopeStorage(void* storage) {
+    if (tls32_.handle_scope_storage_cache_size >= kMaxHandleScopeStorageCacheSize) {
+      return false;
+    }
+    *reinterpret_cast<void**>(storage) = tlsPtr_.handle_scope_storage_cache;
+    tlsPtr_.handle_scope_storage_cache = storage;
+    ++tls32_.handle_scope_storage_cache_size;
+    return true;
+  }
+
   template<PointerSize pointer_size>
   static constexpr ThreadOffset<pointer_size> TopHandleScopeOffset() {
     return ThreadOffsetFromTlsPtr<pointer_size>(OFFSETOF_MEMBER(tls_ptr_sized_values,
@@ -1672,6 +1714,9 @@ class Thread {
   // Maximum number of suspend barriers.
   static constexpr uint32_t kMaxSuspendBarriers = 3;
 
+  // Maximum number of VariableSizedHandleScope storage blocks kept for reuse.
+  static constexpr uint32_t kMaxHandleScopeStorageCacheSize = 8;
+
   // Has Thread::Startup been called?
   static bool is_started_;
 
@@ -1719,7 +1764,10 @@ class Thread {
           make_visibly_initialized_counter(0),
           define_class_counter(0),
           num_name_readers(0),
-          shared_method_hotness(kSharedMethodHotnessThreshold)
+          shared_method_hotness(kSharedMethodHotnessThreshold),
+          extended_native_window_depth(0),
+          extended_native_window_elisions(0),
+          handle_scope_storage_cache_size(0)
         {}
 
     // The state and flags field must be changed atomically so that flag values aren't lost.
@@ -1822,6 +1870,19 @@ class Thread {
     // There is a second level counter in `Jit::shared_method_counters_` to make
     // sure we at least have a few samples before compiling a method.
     uint32_t shared_method_hotness;
+
+    // Nesting depth of extended native windows, see EnterExtendedNativeWindow().
+    // While non-zero, TransitionFromRunnableToSuspended(kNative) leaves the thread
+    // runnable and records the elision below instead of changing the state.
+    uint32_t extended_native_window_depth;
+
+    // Number of elided runnable -> native transitions that have not yet seen their
+    // matching TransitionFromSuspendedToRunnable(). May outlive the window depth:
+    // the elisions are unwound by the call boundaries that created them.
+    uint32_t extended_native_window_elisions;
+
+    // Number of blocks currently chained in `tlsPtr_.handle_scope_storage_cache`.
+    uint32_t handle_scope_storage_cache_size;
   } tls32_;
 
   struct PACKED(8) tls_64bit_sized_values {
@@ -1873,7 +1934,8 @@ class Thread {
                                method_verifier(nullptr),
                                thread_local_mark_stack(nullptr),
                                async_exception(nullptr),
-                               top_reflective_handle_scope(nullptr) {
+                               top_reflective_handle_scope(nullptr),
+                               handle_scope_storage_cache(nullptr) {
       std::fill(held_mutexes, held_mutexes + kLockLevelCount, nullptr);
     }
 
@@ -2036,6 +2098,11 @@ class Thread {
 
     // Top of the linked-list for reflective-handle scopes or null if none.
     BaseReflectiveHandleScope* top_reflective_handle_scope;
+
+    // Singly-linked chain of recycled VariableSizedHandleScope storage blocks,
+    // all of the same fixed size with the link stored in the first word. Only
+    // touched by this thread, see TryPopHandleScopeStorage().
+    void* handle_scope_storage_cache;
   } tlsPtr_;
 
   // Small thread-local cache to be used from the interpreter.
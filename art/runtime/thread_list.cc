@@ -20,6 +20,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <set>
 #include <sstream>
 #include <vector>
 
@@ -395,6 +396,106 @@ size_t ThreadList::RunCheckpoint(Closure* checkpoint_function, Closure* callback
   return count;
 }
 
+size_t ThreadList::RunCheckpointBatched(Closure* checkpoint_function, size_t batch_size) {
+  Thread* self = Thread::Current();
+  Locks::mutator_lock_->AssertNotExclusiveHeld(self);
+  Locks::thread_list_lock_->AssertNotHeld(self);
+  Locks::thread_suspend_count_lock_->AssertNotHeld(self);
+  DCHECK_NE(batch_size, 0u);
+
+  // Track processed threads by thread id; ids of detached threads may be reused but a
+  // skipped reuser is indistinguishable from a thread that attached after the checkpoint
+  // started, which we do not guarantee to cover anyway.
+  std::set<uint32_t> processed_ids;
+  std::vector<Thread*> suspended_count_modified_threads;
+  size_t count = 0;
+  bool done = false;
+  while (!done) {
+    suspended_count_modified_threads.clear();
+    size_t batch_count = 0;
+    {
+      MutexLock mu(self, *Locks::thread_list_lock_);
+      MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
+      done = true;
+      for (const auto& thread : list_) {
+        if (thread == self || !processed_ids.insert(thread->GetThreadId()).second) {
+          continue;
+        }
+        ++count;
+        bool requested_suspend = false;
+        while (true) {
+          if (thread->RequestCheckpoint(checkpoint_function)) {
+            // This thread will run its checkpoint some time in the near future.
+            if (requested_suspend) {
+              // The suspend request is now unnecessary.
+              bool updated =
+                  thread->ModifySuspendCount(self, -1, nullptr, SuspendReason::kInternal);
+              DCHECK(updated);
+              requested_suspend = false;
+            }
+            break;
+          } else {
+            // The thread is probably suspended, try to make sure that it stays suspended.
+            if (thread->GetState() == ThreadState::kRunnable) {
+              // Spurious fail, try again.
+              continue;
+            }
+            if (!requested_suspend) {
+              bool updated =
+                  thread->ModifySuspendCount(self, +1, nullptr, SuspendReason::kInternal);
+              DCHECK(updated);
+              requested_suspend = true;
+              if (thread->IsSuspended()) {
+                break;
+              }
+              // The thread raced us to become Runnable. Try to RequestCheckpoint() again.
+            } else {
+              // The thread previously raced our suspend request to become Runnable but
+              // since it is suspended again, it must honor that suspend request now.
+              DCHECK(thread->IsSuspended());
+              break;
+            }
+          }
+        }
+        if (requested_suspend) {
+          suspended_count_modified_threads.push_back(thread);
+        }
+        if (++batch_count == batch_size) {
+          // Release the locks and run the collected suspended checkpoints before looking
+          // at the rest of the list.
+          done = false;
+          break;
+        }
+      }
+    }
+
+    // Run the checkpoint on the suspended threads of this batch. Their raised suspend
+    // count pins them even though we dropped the thread list lock.
+    for (const auto& thread : suspended_count_modified_threads) {
+      // We know for sure that the thread is suspended at this point.
+      DCHECK(thread->IsSuspended());
+      checkpoint_function->Run(thread);
+      {
+        MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
+        bool updated = thread->ModifySuspendCount(self, -1, nullptr, SuspendReason::kInternal);
+        DCHECK(updated);
+      }
+    }
+    if (!suspended_count_modified_threads.empty()) {
+      // Imitate ResumeAll, threads may be waiting on Thread::resume_cond_ since we raised
+      // their suspend count. Now the suspend_count_ is lowered so we must do the broadcast.
+      MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
+      Thread::resume_cond_->Broadcast(self);
+    }
+  }
+
+  // Run the checkpoint on ourself last.
+  checkpoint_function->Run(self);
+  ++count;
+
+  return count;
+}
+
 void ThreadList::RunEmptyCheckpoint() {
   Thread* self = Thread::Current();
   Locks::mutator_lock_->AssertNotExclusiveHeld(self);
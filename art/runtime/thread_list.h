@@ -118,6 +118,16 @@ class ThreadList {
   size_t RunCheckpoint(Closure* checkpoint_function, Closure* callback = nullptr)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Variant of RunCheckpoint that processes the thread list in batches of `batch_size`
+  // threads, dropping the thread list and suspend count locks between batches. This bounds
+  // the time thread attach/detach and suspension requests are blocked by a checkpoint on
+  // processes with many threads, at the cost of a slightly weaker snapshot: threads
+  // attaching while the checkpoint is in progress may or may not run the checkpoint
+  // function, which is the same guarantee RunCheckpoint gives for threads attaching after
+  // its single critical section. Does not support the callback.
+  size_t RunCheckpointBatched(Closure* checkpoint_function, size_t batch_size = 32u)
+      REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
+
   // Run an empty checkpoint on threads. Wait until threads pass the next suspend point or are
   // suspended. This is used to ensure that the threads finish or aren't in the middle of an
   // in-flight mutator heap access (eg. a read barrier.) Runnable threads will respond by
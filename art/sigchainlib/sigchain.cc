@@ -297,6 +297,7 @@ class SignalChain {
     for (SigchainAction& slot : special_handlers_) {
       if (slot.sc_sigaction == nullptr) {
         slot = *sa;
+        RebuildDispatch();
         return;
       }
     }
@@ -313,6 +314,7 @@ class SignalChain {
           special_handlers_[j] = special_handlers_[j + 1];
         }
         special_handlers_[len - 1].sc_sigaction = nullptr;
+        RebuildDispatch();
         return;
       }
     }
@@ -324,6 +326,44 @@ class SignalChain {
   static void Handler(int signo, siginfo_t* siginfo, void*);
 
  private:
+  // One flattened entry per registered special handler, precomputed on
+  // registration changes so Handler() makes no per-delivery decisions it can
+  // avoid.
+  struct DispatchEntry {
+    bool (*fn)(int, siginfo_t*, void*);
+    uint64_t flags;
+    // Whether sc_mask needs a sigprocmask round trip at all: Handler()
+    // already runs with every signal blocked, so a mask that also blocks
+    // everything is a no-op.
+    bool needs_mask_switch;
+    sigset_t mask;
+  };
+
+  void RebuildDispatch() {
+    int count = 0;
+    for (SigchainAction& handler : special_handlers_) {
+      if (handler.sc_sigaction == nullptr) {
+        break;
+      }
+      DispatchEntry& entry = dispatch_[count++];
+      entry.fn = handler.sc_sigaction;
+      entry.flags = handler.sc_flags;
+      entry.mask = handler.sc_mask;
+      entry.needs_mask_switch = false;
+      for (int i = 1; i < _NSIG; ++i) {
+        if (i != SIGKILL && i != SIGSTOP && sigismember(&entry.mask, i) != 1) {
+          entry.needs_mask_switch = true;
+          break;
+        }
+      }
+    }
+    // A single handler that needs no mask switch is the high-rate profiling
+    // case (e.g. SIGPROF at sampling frequency); Handler() reduces it to one
+    // indirect call.
+    fast_dispatch_ = count == 1 && !dispatch_[0].needs_mask_switch;
+    dispatch_count_ = count;
+  }
+
   bool claimed_;
   int kernel_supported_flags_;
 #if defined(__BIONIC__)
@@ -332,6 +372,9 @@ class SignalChain {
   struct sigaction action_;
 #endif
   SigchainAction special_handlers_[2];
+  DispatchEntry dispatch_[2];
+  int dispatch_count_ = 0;
+  bool fast_dispatch_ = false;
 };
 
 // _NSIG is 1 greater than the highest valued signal, but signals start from 1.
@@ -341,43 +384,60 @@ static SignalChain chains[_NSIG + 1];
 static bool is_signal_hook_debuggable = false;
 
 void SignalChain::Handler(int signo, siginfo_t* siginfo, void* ucontext_raw) {
+  SignalChain& chain = chains[signo];
   // Try the special handlers first.
   // If one of them crashes, we'll reenter this handler and pass that crash onto the user handler.
   if (!GetHandlingSignal()) {
-    for (const auto& handler : chains[signo].special_handlers_) {
-      if (handler.sc_sigaction == nullptr) {
-        break;
-      }
-
-      // The native bridge signal handler might not return.
-      // Avoid setting the thread local flag in this case, since we'll never
-      // get a chance to restore it.
-      bool handler_noreturn = (handler.sc_flags & SIGCHAIN_ALLOW_NORETURN);
-      sigset_t previous_mask;
-      linked_sigprocmask(SIG_SETMASK, &handler.sc_mask, &previous_mask);
-
+    if (chain.fast_dispatch_) {
+      // Single handler whose mask is covered by the all-blocked mask this
+      // handler already runs under: one indirect call, no sigprocmask round
+      // trips.
+      const DispatchEntry& entry = chain.dispatch_[0];
       ScopedHandlingSignal restorer;
-      if (!handler_noreturn) {
+      if (!(entry.flags & SIGCHAIN_ALLOW_NORETURN)) {
         SetHandlingSignal(true);
       }
-
-      if (handler.sc_sigaction(signo, siginfo, ucontext_raw)) {
+      if (entry.fn(signo, siginfo, ucontext_raw)) {
         return;
       }
+    } else {
+      for (int i = 0; i < chain.dispatch_count_; ++i) {
+        const DispatchEntry& entry = chain.dispatch_[i];
+
+        // The native bridge signal handler might not return.
+        // Avoid setting the thread local flag in this case, since we'll never
+        // get a chance to restore it.
+        bool handler_noreturn = (entry.flags & SIGCHAIN_ALLOW_NORETURN);
+        sigset_t previous_mask;
+        if (entry.needs_mask_switch) {
+          linked_sigprocmask(SIG_SETMASK, &entry.mask, &previous_mask);
+        }
 
-      linked_sigprocmask(SIG_SETMASK, &previous_mask, nullptr);
+        ScopedHandlingSignal restorer;
+        if (!handler_noreturn) {
+          SetHandlingSignal(true);
+        }
+
+        if (entry.fn(signo, siginfo, ucontext_raw)) {
+          return;
+        }
+
+        if (entry.needs_mask_switch) {
+          linked_sigprocmask(SIG_SETMASK, &previous_mask, nullptr);
+        }
+      }
     }
   }
 
   // Forward to the user's signal handler.
-  int handler_flags = chains[signo].action_.sa_flags;
+  int handler_flags = chain.action_.sa_flags;
   ucontext_t* ucontext = static_cast<ucontext_t*>(ucontext_raw);
 #if defined(__BIONIC__)
   sigset64_t mask;
-  sigorset(&mask, &ucontext->uc_sigmask64, &chains[signo].action_.sa_mask);
+  sigorset(&mask, &ucontext->uc_sigmask64, &chain.action_.sa_mask);
 #else
   sigset_t mask;
-  sigorset(&mask, &ucontext->uc_sigmask, &chains[signo].action_.sa_mask);
+  sigorset(&mask, &ucontext->uc_sigmask, &chain.action_.sa_mask);
 #endif
   if (!(handler_flags & SA_NODEFER)) {
     sigaddset(&mask, signo);
@@ -401,9 +461,9 @@ void SignalChain::Handler(int signo, siginfo_t* siginfo, void* ucontext_raw) {
       siginfo->si_addr = untag_address(siginfo->si_addr);
     }
 #endif
-    chains[signo].action_.sa_sigaction(signo, siginfo, ucontext_raw);
+    chain.action_.sa_sigaction(signo, siginfo, ucontext_raw);
   } else {
-    auto handler = chains[signo].action_.sa_handler;
+    auto handler = chain.action_.sa_handler;
     if (handler == SIG_IGN) {
       return;
     } else if (handler == SIG_DFL) {
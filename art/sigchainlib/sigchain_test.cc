@@ -245,6 +245,47 @@ TEST_F(SigchainTest, EnsureFrontOfChain) {
   called = 0;
 }
 
+// A single handler whose mask blocks everything takes the fast dispatch path
+// (no sigprocmask round trips). Make sure claimed and unclaimed deliveries
+// still route correctly through it.
+TEST_F(SigchainTest, fast_dispatch_full_mask) {
+  // Earlier tests may have left SIGPROF blocked.
+  sigset64_t mask;
+  sigemptyset64(&mask);
+  ASSERT_EQ(0, RealSigprocmask(SIG_SETMASK, &mask, nullptr)) << strerror(errno);
+
+  static sig_atomic_t special_called = 0;
+  art::SigchainAction fast_action = {
+      .sc_sigaction = [](int, siginfo_t* info, void*) -> bool {
+        ++special_called;
+        return info->si_value.sival_ptr != nullptr;
+      },
+      .sc_mask = {},
+      .sc_flags = 0,
+  };
+  sigfillset(&fast_action.sc_mask);
+  art::AddSpecialSignalHandlerFn(SIGPROF, &fast_action);
+
+  static sig_atomic_t user_called = 0;
+  struct sigaction user_action = {};
+  user_action.sa_flags = SA_SIGINFO;
+  user_action.sa_sigaction = [](int, siginfo_t*, void*) { user_called = 1; };
+  ASSERT_EQ(0, sigaction(SIGPROF, &user_action, nullptr));
+
+  sigval value;
+  value.sival_ptr = &value;
+  pthread_sigqueue(pthread_self(), SIGPROF, value);
+  ASSERT_EQ(1, special_called);
+  ASSERT_EQ(0, user_called);
+
+  value.sival_ptr = nullptr;
+  pthread_sigqueue(pthread_self(), SIGPROF, value);
+  ASSERT_EQ(2, special_called);
+  ASSERT_EQ(1, user_called);
+
+  art::RemoveSpecialSignalHandlerFn(SIGPROF, fast_action.sc_sigaction);
+}
+
 TEST_F(SigchainTest, fault_address_tag) {
 #define SA_EXPOSE_TAGBITS 0x00000800
 #if defined(__aarch64__)
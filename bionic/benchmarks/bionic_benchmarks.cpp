@@ -514,6 +514,13 @@ std::map<std::string, args_vector_t> GetShorthand() {
     {"AT_ALIGNED_ONEBUF_LARGE", GetArgs(kLargeSizes, 0)},
     {"AT_ALIGNED_ONEBUF_ALL", GetArgs(all_sizes, 0)},
 
+    // Sizes bracketing cache-line multiples, for finding the points where an
+    // implementation switches between its small-copy and bulk strategies.
+    {"AT_CACHELINE_CROSSOVER",
+     GetArgs({32, 63, 64, 65, 96, 127, 128, 129, 192, 255, 256, 257, 384, 511, 512, 513, 1024,
+              2048, 4096},
+             0, 0)},
+
     {"AT_ALIGNED_TWOBUF", GetArgs(kCommonSizes, 0, 0)},
     {"AT_ALIGNED_TWOBUF_SMALL", GetArgs(kSmallSizes, 0, 0)},
     {"AT_ALIGNED_TWOBUF_MEDIUM", GetArgs(kMediumSizes, 0, 0)},
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2021 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Generates the synthetic libraries used by linker_benchmark.cpp.
+
+Each library is parameterized by:
+  - relocation count: an array of function pointers, one R_*_RELATIVE (or
+    symbolic, for the deepest dependency) relocation per entry
+  - symbol count: exported no-op functions padding the dynamic symbol table
+  - dependency depth: a DT_NEEDED chain of identical libraries
+
+Usage:
+  gen_linker_benchmark_libs.py --cc <target clang> --out <dir>
+
+Then run the benchmarks with BIONIC_LINKER_BENCHMARK_LIBS=<dir>.
+"""
+
+import argparse
+import os
+import subprocess
+import tempfile
+
+# (relocations, symbols, depth) triples matching linker_benchmark.cpp.
+CONFIGS = [
+    (256, 512, 0),
+    (4096, 512, 0),
+    (65536, 512, 0),
+    (256, 4096, 0),
+    (256, 32768, 0),
+    (256, 512, 4),
+    (256, 512, 16),
+]
+
+
+def lib_name(relocs, symbols, depth):
+  return 'libreloc_bench_r%d_s%d_d%d.so' % (relocs, symbols, depth)
+
+
+def gen_source(relocs, symbols, level, calls_down):
+  """Returns C source for one library. `calls_down` references level + 1."""
+  lines = []
+  for i in range(symbols):
+    lines.append('int sym_l%d_%04x(void) { return %d; }' % (level, i, i))
+  # Taking the functions' addresses in a static initialized array emits one
+  # dynamic relocation per entry.
+  lines.append('typedef int (*fn_t)(void);')
+  lines.append('fn_t reloc_table_l%d[%d] = {' % (level, relocs))
+  for i in range(relocs):
+    lines.append('  sym_l%d_%04x,' % (level, i % symbols))
+  lines.append('};')
+  if calls_down:
+    lines.append('extern int sym_l%d_0000(void);' % (level + 1))
+    lines.append('int call_down_l%d(void) { return sym_l%d_0000(); }' %
+                 (level, level + 1))
+  return '\n'.join(lines) + '\n'
+
+
+def build_lib(cc, out_dir, src, name, needed):
+  with tempfile.NamedTemporaryFile(mode='w', suffix='.c') as f:
+    f.write(src)
+    f.flush()
+    cmd = [cc, '-shared', '-fPIC', '-O1', '-o', os.path.join(out_dir, name),
+           '-x', 'c', f.name, '-L' + out_dir, '-Wl,-rpath,$ORIGIN']
+    for dep in needed:
+      # Link by name so DT_NEEDED carries just the soname.
+      cmd.append('-l:' + dep)
+    subprocess.check_call(cmd)
+
+
+def main():
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--cc', required=True, help='target clang to use')
+  parser.add_argument('--out', required=True, help='output directory')
+  args = parser.parse_args()
+  os.makedirs(args.out, exist_ok=True)
+
+  for relocs, symbols, depth in CONFIGS:
+    # The root library is level 0 and the leaf is level `depth`; build the
+    # chain leaf-first so each link can resolve against the one below it.
+    deps = []
+    for level in range(depth, 0, -1):
+      dep = 'libreloc_bench_r%d_s%d_d%d_dep%d.so' % (relocs, symbols, depth,
+                                                     level)
+      build_lib(args.cc, args.out,
+                gen_source(relocs, symbols, level, level < depth), dep,
+                deps[-1:])
+      deps.append(dep)
+    build_lib(args.cc, args.out,
+              gen_source(relocs, symbols, 0, depth > 0),
+              lib_name(relocs, symbols, depth), deps[-1:])
+    print('generated %s' % lib_name(relocs, symbols, depth))
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <dlfcn.h>
+#include <stdlib.h>
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "util.h"
+
+// Linker benchmarks. dlsym benchmarks run against libraries that are always
+// present; the dlopen benchmarks load synthetic libraries produced by
+// gen_linker_benchmark_libs.py, parameterized by relocation count, dynamic
+// symbol table size, and DT_NEEDED dependency depth, so regressions in
+// linker.cpp / linker_phdr.cpp (and wins from relocation work) show up as
+// wall-clock changes. Point BIONIC_LINKER_BENCHMARK_LIBS at the directory
+// holding the generated libraries; the dlopen benchmarks skip if it isn't
+// set.
+
+static std::string SyntheticLibPath(const char* name) {
+  const char* dir = getenv("BIONIC_LINKER_BENCHMARK_LIBS");
+  if (dir == nullptr) return "";
+  return std::string(dir) + "/" + name;
+}
+
+static void BenchmarkDlopenDlclose(benchmark::State& state, const char* name) {
+  std::string path = SyntheticLibPath(name);
+  if (path.empty()) {
+    state.SkipWithError("BIONIC_LINKER_BENCHMARK_LIBS is not set");
+    return;
+  }
+  // Verify the library loads before timing it, so a missing or unloadable
+  // library is reported once rather than per iteration.
+  void* handle = dlopen(path.c_str(), RTLD_NOW);
+  if (handle == nullptr) {
+    state.SkipWithError(dlerror());
+    return;
+  }
+  dlclose(handle);
+
+  for (auto _ : state) {
+    handle = dlopen(path.c_str(), RTLD_NOW);
+    benchmark::DoNotOptimize(handle);
+    dlclose(handle);
+  }
+}
+
+// Relocation count sweep (fixed 512 symbols, no dependencies).
+static void BM_linker_dlopen_relocs_256(benchmark::State& state) {
+  BenchmarkDlopenDlclose(state, "libreloc_bench_r256_s512_d0.so");
+}
+BIONIC_BENCHMARK(BM_linker_dlopen_relocs_256);
+
+static void BM_linker_dlopen_relocs_4096(benchmark::State& state) {
+  BenchmarkDlopenDlclose(state, "libreloc_bench_r4096_s512_d0.so");
+}
+BIONIC_BENCHMARK(BM_linker_dlopen_relocs_4096);
+
+static void BM_linker_dlopen_relocs_65536(benchmark::State& state) {
+  BenchmarkDlopenDlclose(state, "libreloc_bench_r65536_s512_d0.so");
+}
+BIONIC_BENCHMARK(BM_linker_dlopen_relocs_65536);
+
+// Symbol table size sweep (fixed 256 relocations, no dependencies). Larger
+// tables stress symbol lookup (gnu hash walk) during relocation.
+static void BM_linker_dlopen_symbols_4096(benchmark::State& state) {
+  BenchmarkDlopenDlclose(state, "libreloc_bench_r256_s4096_d0.so");
+}
+BIONIC_BENCHMARK(BM_linker_dlopen_symbols_4096);
+
+static void BM_linker_dlopen_symbols_32768(benchmark::State& state) {
+  BenchmarkDlopenDlclose(state, "libreloc_bench_r256_s32768_d0.so");
+}
+BIONIC_BENCHMARK(BM_linker_dlopen_symbols_32768);
+
+// Dependency depth sweep: a chain of DT_NEEDED libraries, each with 256
+// relocations and 512 symbols, stressing load order / soinfo bookkeeping.
+static void BM_linker_dlopen_deps_4(benchmark::State& state) {
+  BenchmarkDlopenDlclose(state, "libreloc_bench_r256_s512_d4.so");
+}
+BIONIC_BENCHMARK(BM_linker_dlopen_deps_4);
+
+static void BM_linker_dlopen_deps_16(benchmark::State& state) {
+  BenchmarkDlopenDlclose(state, "libreloc_bench_r256_s512_d16.so");
+}
+BIONIC_BENCHMARK(BM_linker_dlopen_deps_16);
+
+// dlsym against an already-loaded library: lookup cost without load cost.
+static void BM_linker_dlsym_hit(benchmark::State& state) {
+  void* handle = dlopen("libdl.so", RTLD_NOW);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(dlsym(handle, "dlsym"));
+  }
+  dlclose(handle);
+}
+BIONIC_BENCHMARK(BM_linker_dlsym_hit);
+
+static void BM_linker_dlsym_miss(benchmark::State& state) {
+  void* handle = dlopen("libdl.so", RTLD_NOW);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(dlsym(handle, "no_such_symbol"));
+  }
+  dlclose(handle);
+}
+BIONIC_BENCHMARK(BM_linker_dlsym_miss);
+
+// RTLD_DEFAULT searches every loaded library in load order; this is the
+// worst case lookup the hash tables are supposed to keep cheap.
+static void BM_linker_dlsym_rtld_default(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(dlsym(RTLD_DEFAULT, "snprintf"));
+  }
+}
+BIONIC_BENCHMARK(BM_linker_dlsym_rtld_default);
@@ -57,6 +57,28 @@ static void BM_string_memcpy(benchmark::State& state) {
 }
 BIONIC_BENCHMARK_WITH_ARG(BM_string_memcpy, "AT_ALIGNED_TWOBUF");
 
+// Sweeps the sizes where memcpy implementations change strategy. On
+// big.LITTLE parts, run once per cluster (--bionic_cpu=<little core> and
+// --bionic_cpu=<big core>) to validate that the crossover points of the
+// implementation the dispatcher picked hold on both.
+static void BM_string_memcpy_crossover(benchmark::State& state) {
+  const size_t nbytes = state.range(0);
+  const size_t src_alignment = state.range(1);
+  const size_t dst_alignment = state.range(2);
+
+  std::vector<char> src;
+  std::vector<char> dst;
+  char* src_aligned = GetAlignedPtrFilled(&src, src_alignment, nbytes, 'x');
+  char* dst_aligned = GetAlignedPtr(&dst, dst_alignment, nbytes);
+
+  while (state.KeepRunning()) {
+    memcpy(dst_aligned, src_aligned, nbytes);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_string_memcpy_crossover, "AT_CACHELINE_CROSSOVER");
+
 static void BM_string_memmove_non_overlapping(benchmark::State& state) {
   const size_t nbytes = state.range(0);
   const size_t src_alignment = state.range(1);
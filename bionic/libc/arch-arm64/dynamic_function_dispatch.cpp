@@ -41,6 +41,36 @@ DEFINE_IFUNC_FOR(memchr) {
     }
 }
 
+// memcpy and memmove resolve once per process, like everything else here: a
+// call-time per-cluster choice would need sched_getcpu on every call and is
+// wrong as soon as the thread migrates mid-copy. Instead we pick the widest
+// implementation the CPU offers; the SVE and SIMD variants size their inner
+// loops off the vector length and prefetch distance at run time, which is
+// what actually differs between big and little clusters. The crossover
+// benchmark in benchmarks/string_benchmark.cpp validates the choice per
+// cluster when pinned with --bionic_cpu.
+typedef void* memcpy_func(void*, const void*, size_t);
+DEFINE_IFUNC_FOR(memcpy) {
+    if (arg->_hwcap & HWCAP_SVE) {
+        RETURN_FUNC(memcpy_func, __memcpy_aarch64_sve);
+    } else if (arg->_hwcap & HWCAP_ASIMD) {
+        RETURN_FUNC(memcpy_func, __memcpy_aarch64_simd);
+    } else {
+        RETURN_FUNC(memcpy_func, __memcpy_aarch64);
+    }
+}
+
+typedef void* memmove_func(void*, const void*, size_t);
+DEFINE_IFUNC_FOR(memmove) {
+    if (arg->_hwcap & HWCAP_SVE) {
+        RETURN_FUNC(memmove_func, __memmove_aarch64_sve);
+    } else if (arg->_hwcap & HWCAP_ASIMD) {
+        RETURN_FUNC(memmove_func, __memmove_aarch64_simd);
+    } else {
+        RETURN_FUNC(memmove_func, __memmove_aarch64);
+    }
+}
+
 typedef int stpcpy_func(char*, const char*);
 DEFINE_IFUNC_FOR(stpcpy) {
     if (arg->_hwcap2 & HWCAP2_MTE) {
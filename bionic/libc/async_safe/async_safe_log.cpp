@@ -33,10 +33,12 @@
 #include <linux/net.h>
 #include <pthread.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/prctl.h>
 #include <sys/socket.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
@@ -516,7 +518,225 @@ struct log_time {  // Wire format
   uint32_t tv_nsec;
 };
 
+//
+// Optional buffered ring sink; see async_safe_log_ring_init() in the header.
+//
+// The ring is a lock-free multi-producer queue of self-describing records.
+// Writers reserve space by advancing the head with a CAS (wait-free when
+// uncontended), memcpy their record, and then publish it by setting the
+// committed bit in the record header with a release store. A single drainer
+// at a time (guarded by a flag, never blocking) walks committed records from
+// the tail and forwards them to logd over one persistent socket, so the
+// connect/send cost is paid per batch instead of per message. Everything
+// here is async signal safe: no allocation, no mutexes, and a full ring
+// simply falls back to the direct socket path.
+//
+
+static constexpr size_t kRingMinCapacity = 4096;
+static constexpr size_t kRingDefaultCapacity = 64 * 1024;
+static constexpr size_t kRingMaxCapacity = 1024 * 1024;
+
+// Records are 16-byte aligned so that a wrap-around filler always has room
+// for a header.
+static constexpr size_t kRingAlignment = 16;
+
+// Record header word: low 24 bits hold the record size in bytes.
+static constexpr uint32_t kRingCommitted = 1u << 31;
+static constexpr uint32_t kRingSkip = 1u << 30;
+static constexpr uint32_t kRingSizeMask = (1u << 24) - 1;
+
+struct RingRecord {
+  atomic_uint_least32_t header;  // Size and flags; zero until published.
+  uint8_t priority;
+  uint8_t log_id;
+  uint16_t tid;
+  log_time realtime;
+  char text[0];  // tag NUL msg NUL
+};
+
+static_assert(sizeof(RingRecord) == kRingAlignment, "RingRecord must fill one alignment unit");
+
+static atomic_uintptr_t g_ring;
+static size_t g_ring_capacity;
+static atomic_uint_least64_t g_ring_head;
+static atomic_uint_least64_t g_ring_tail;
+static atomic_bool g_ring_draining;
+// Persistent drain socket; only touched while g_ring_draining is held.
+static int g_ring_fd = -1;
+
+bool async_safe_log_ring_init(size_t capacity) {
+  if (atomic_load_explicit(&g_ring, memory_order_relaxed) != 0) {
+    return true;
+  }
+
+  if (capacity == 0) capacity = kRingDefaultCapacity;
+  if (capacity > kRingMaxCapacity) capacity = kRingMaxCapacity;
+  size_t rounded = kRingMinCapacity;
+  while (rounded < capacity) rounded <<= 1;
+
+  void* map_ptr =
+      mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map_ptr == MAP_FAILED) {
+    return false;
+  }
+  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, map_ptr, rounded, "async_safe log ring");
+
+  g_ring_capacity = rounded;
+  uintptr_t expected = 0;
+  if (!atomic_compare_exchange_strong_explicit(&g_ring, &expected,
+                                               reinterpret_cast<uintptr_t>(map_ptr),
+                                               memory_order_release, memory_order_relaxed)) {
+    // Lost a race with another initializer; its ring wins.
+    munmap(map_ptr, rounded);
+  }
+  return true;
+}
+
+// Sends one record to logd on the persistent drain socket, falling back to
+// stderr if logd is unreachable.
+static void ring_send_record(RingRecord* record) {
+  const char* tag = record->text;
+  const char* msg = tag + strlen(tag) + 1;
+
+  if (g_ring_fd == -1) {
+    g_ring_fd = open_log_socket();
+    if (g_ring_fd == -1) {
+      write_stderr(tag, msg);
+      return;
+    }
+  }
+
+  iovec vec[6];
+  vec[0].iov_base = &record->log_id;
+  vec[0].iov_len = sizeof(record->log_id);
+  vec[1].iov_base = &record->tid;
+  vec[1].iov_len = sizeof(record->tid);
+  vec[2].iov_base = &record->realtime;
+  vec[2].iov_len = sizeof(record->realtime);
+  vec[3].iov_base = &record->priority;
+  vec[3].iov_len = 1;
+  vec[4].iov_base = const_cast<char*>(tag);
+  vec[4].iov_len = strlen(tag) + 1;
+  vec[5].iov_base = const_cast<char*>(msg);
+  vec[5].iov_len = strlen(msg) + 1;
+
+  if (TEMP_FAILURE_RETRY(writev(g_ring_fd, vec, sizeof(vec) / sizeof(vec[0]))) == -1) {
+    // logd may have restarted; drop the socket so the next drain reconnects.
+    __close(g_ring_fd);
+    g_ring_fd = -1;
+    write_stderr(tag, msg);
+  }
+}
+
+void async_safe_log_ring_drain(void) {
+  char* ring = reinterpret_cast<char*>(atomic_load_explicit(&g_ring, memory_order_acquire));
+  if (ring == nullptr) {
+    return;
+  }
+
+  // Only one drainer at a time; anyone else just leaves their records queued.
+  bool expected = false;
+  if (!atomic_compare_exchange_strong_explicit(&g_ring_draining, &expected, true,
+                                               memory_order_acquire, memory_order_relaxed)) {
+    return;
+  }
+
+  uint64_t tail = atomic_load_explicit(&g_ring_tail, memory_order_relaxed);
+  while (tail != atomic_load_explicit(&g_ring_head, memory_order_acquire)) {
+    RingRecord* record =
+        reinterpret_cast<RingRecord*>(ring + (tail & (g_ring_capacity - 1)));
+    uint32_t header = atomic_load_explicit(&record->header, memory_order_acquire);
+    if ((header & kRingCommitted) == 0) {
+      // Reserved but not yet published; the batch ends here.
+      break;
+    }
+    if ((header & kRingSkip) == 0) {
+      ring_send_record(record);
+    }
+    // Clear the header before advancing the tail, so the slot's next writer
+    // never races with a stale committed bit.
+    atomic_store_explicit(&record->header, 0, memory_order_relaxed);
+    tail += header & kRingSizeMask;
+    atomic_store_explicit(&g_ring_tail, tail, memory_order_release);
+  }
+
+  atomic_store_explicit(&g_ring_draining, false, memory_order_release);
+}
+
+// Queues a non-fatal message on the ring. Returns false (leaving the caller
+// to take the direct path) if the ring is disabled, full, or the message is
+// oversized.
+static bool ring_log_write(int priority, const char* tag, const char* msg) {
+  char* ring = reinterpret_cast<char*>(atomic_load_explicit(&g_ring, memory_order_acquire));
+  if (ring == nullptr) {
+    return false;
+  }
+
+  size_t tag_len = strlen(tag) + 1;
+  size_t msg_len = strlen(msg) + 1;
+  size_t record_size =
+      (sizeof(RingRecord) + tag_len + msg_len + kRingAlignment - 1) & ~(kRingAlignment - 1);
+  if (record_size > g_ring_capacity / 4 || record_size > kRingSizeMask) {
+    return false;
+  }
+
+  uint64_t head = atomic_load_explicit(&g_ring_head, memory_order_relaxed);
+  uint64_t new_head;
+  size_t pos;
+  size_t skip;
+  do {
+    pos = head & (g_ring_capacity - 1);
+    // Records are contiguous; if this one would straddle the end of the
+    // buffer, reserve the leftover space too and mark it as a filler.
+    skip = (pos + record_size > g_ring_capacity) ? g_ring_capacity - pos : 0;
+    new_head = head + skip + record_size;
+    uint64_t tail = atomic_load_explicit(&g_ring_tail, memory_order_acquire);
+    if (new_head - tail > g_ring_capacity) {
+      return false;
+    }
+  } while (!atomic_compare_exchange_weak_explicit(&g_ring_head, &head, new_head,
+                                                  memory_order_relaxed, memory_order_relaxed));
+
+  if (skip != 0) {
+    RingRecord* filler = reinterpret_cast<RingRecord*>(ring + pos);
+    atomic_store_explicit(&filler->header,
+                          static_cast<uint32_t>(skip) | kRingSkip | kRingCommitted,
+                          memory_order_release);
+    pos = 0;
+  }
+
+  RingRecord* record = reinterpret_cast<RingRecord*>(ring + pos);
+  record->priority = priority;
+  record->log_id = LOG_ID_MAIN;
+  record->tid = gettid();
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  record->realtime.tv_sec = ts.tv_sec;
+  record->realtime.tv_nsec = ts.tv_nsec;
+  memcpy(record->text, tag, tag_len);
+  memcpy(record->text + tag_len, msg, msg_len);
+  atomic_store_explicit(&record->header, static_cast<uint32_t>(record_size) | kRingCommitted,
+                        memory_order_release);
+
+  // Keep latency bounded: whoever pushes the ring past half full pays for
+  // the batched flush.
+  if (new_head - atomic_load_explicit(&g_ring_tail, memory_order_relaxed) >=
+      g_ring_capacity / 2) {
+    async_safe_log_ring_drain();
+  }
+  return true;
+}
+
 int async_safe_write_log(int priority, const char* tag, const char* msg) {
+  if (priority == ANDROID_LOG_FATAL) {
+    // Push out anything buffered first, so crash logs read in order.
+    async_safe_log_ring_drain();
+  } else if (ring_log_write(priority, tag, msg)) {
+    // Report the same byte count the direct writev would have.
+    return sizeof(char) + sizeof(uint16_t) + sizeof(log_time) + 1 + strlen(tag) + 1 +
+           strlen(msg) + 1;
+  }
+
   int main_log_fd = open_log_socket();
   if (main_log_fd == -1) {
     // Try stderr instead.
@@ -73,4 +73,21 @@ int async_safe_format_log(int priority, const char* tag, const char* fmt, ...) _
 int async_safe_format_log_va_list(int priority, const char* tag, const char* fmt, va_list ap);
 int async_safe_write_log(int priority, const char* tag, const char* msg);
 
+//
+// Opt-in buffered logging for hot paths.
+//
+// By default every message is sent to logd with its own connect/send, which
+// costs tens of microseconds. After async_safe_log_ring_init() succeeds,
+// non-fatal messages are instead appended to a lock-free in-process ring and
+// flushed to logd in batches, so the common case is a reservation and a
+// memcpy. The ring is drained when it reaches half capacity, before any
+// fatal message, or explicitly via async_safe_log_ring_drain(). If the ring
+// is full, messages fall back to the direct socket path. Both functions are
+// async signal safe.
+//
+// `capacity` is rounded up to a power of two; pass 0 for the default (64KiB).
+// Returns false if the ring could not be allocated.
+bool async_safe_log_ring_init(size_t capacity);
+void async_safe_log_ring_drain(void);
+
 __END_DECLS
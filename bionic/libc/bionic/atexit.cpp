@@ -62,6 +62,7 @@ class AtexitArray {
   bool append_entry(const AtexitEntry& entry);
   AtexitEntry extract_entry(size_t idx);
   void recompact();
+  void seal_write_window();
 
  private:
   AtexitEntry* array_;
@@ -73,6 +74,12 @@ class AtexitArray {
   // restart concurrent __cxa_finalize passes.
   uint64_t total_appends_;
 
+  // Byte range of the array currently left writable between appends. Appends land at the tail, so
+  // keeping the tail page writable and sealing it lazily means registering a library's whole set
+  // of destructors costs two mprotect calls per page of entries rather than two per entry.
+  size_t writable_start_byte_;
+  size_t writable_stop_byte_;
+
   static size_t page_start_of_index(size_t idx) { return PAGE_START(idx * sizeof(AtexitEntry)); }
   static size_t page_end_of_index(size_t idx) { return PAGE_END(idx * sizeof(AtexitEntry)); }
 
@@ -82,6 +89,7 @@ class AtexitArray {
   }
 
   void set_writable(bool writable, size_t start_idx, size_t num_entries);
+  void open_write_window(size_t idx);
   static bool next_capacity(size_t capacity, size_t* result);
   bool expand_capacity();
 };
@@ -93,10 +101,9 @@ bool AtexitArray::append_entry(const AtexitEntry& entry) {
 
   size_t idx = size_++;
 
-  set_writable(true, idx, 1);
+  open_write_window(idx);
   array_[idx] = entry;
   ++total_appends_;
-  set_writable(false, idx, 1);
 
   return true;
 }
@@ -105,6 +112,7 @@ bool AtexitArray::append_entry(const AtexitEntry& entry) {
 AtexitEntry AtexitArray::extract_entry(size_t idx) {
   AtexitEntry result = array_[idx];
 
+  seal_write_window();
   set_writable(true, idx, 1);
   array_[idx] = {};
   ++extracted_count_;
@@ -116,6 +124,7 @@ AtexitEntry AtexitArray::extract_entry(size_t idx) {
 void AtexitArray::recompact() {
   if (!needs_recompaction()) return;
 
+  seal_write_window();
   set_writable(true, 0, size_);
 
   // Optimization: quickly skip over the initial non-null entries.
@@ -162,6 +171,36 @@ void AtexitArray::set_writable(bool writable, size_t start_idx, size_t num_entri
   }
 }
 
+// Make the pages holding `idx` writable and leave them that way, sealing any previously open
+// window first. Consecutive appends to the same page then cost no syscalls at all; the window is
+// sealed again the next time the array is modified anywhere else, or by __cxa_finalize.
+void AtexitArray::open_write_window(size_t idx) {
+  const size_t start_byte = page_start_of_index(idx);
+  const size_t stop_byte = page_end_of_index(idx + 1);
+  if (start_byte >= writable_start_byte_ && stop_byte <= writable_stop_byte_) return;
+
+  seal_write_window();
+
+  const int prot = PROT_READ | PROT_WRITE;
+  if (mprotect(reinterpret_cast<char*>(array_) + start_byte, stop_byte - start_byte, prot) != 0) {
+    async_safe_fatal("mprotect failed on atexit array: %s", strerror(errno));
+  }
+  writable_start_byte_ = start_byte;
+  writable_stop_byte_ = stop_byte;
+}
+
+// Re-protect any pages left writable by open_write_window.
+void AtexitArray::seal_write_window() {
+  if (writable_stop_byte_ == writable_start_byte_) return;
+
+  if (mprotect(reinterpret_cast<char*>(array_) + writable_start_byte_,
+               writable_stop_byte_ - writable_start_byte_, PROT_READ) != 0) {
+    async_safe_fatal("mprotect failed on atexit array: %s", strerror(errno));
+  }
+  writable_start_byte_ = 0;
+  writable_stop_byte_ = 0;
+}
+
 // Approximately double the capacity. Returns true if successful (no overflow). AtexitEntry is
 // smaller than a page, but this function should still be correct even if AtexitEntry were larger
 // than one.
@@ -184,6 +223,9 @@ bool AtexitArray::expand_capacity() {
   if (!next_capacity(capacity_, &new_capacity)) return false;
   const size_t new_capacity_bytes = page_end_of_index(new_capacity);
 
+  // mremap may move the array, so any open window must be sealed while it still points at the old
+  // mapping.
+  seal_write_window();
   set_writable(true, 0, capacity_);
 
   bool result = false;
@@ -272,6 +314,9 @@ restart:
     g_array.recompact();
   }
 
+  // Callbacks that registered new handlers may have left the tail page writable.
+  g_array.seal_write_window();
+
   atexit_unlock();
 
   if (dso != nullptr) {
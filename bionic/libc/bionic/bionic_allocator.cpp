@@ -161,7 +161,9 @@ void BionicSmallObjectAllocator::free_page(small_object_page_info* page) {
   free_pages_cnt_--;
 }
 
-void BionicSmallObjectAllocator::free(void* ptr) {
+// Returns the block to its page's free list without retiring empty pages,
+// and returns that page so the caller can decide when to retire.
+small_object_page_info* BionicSmallObjectAllocator::free_block(void* ptr) {
   small_object_page_info* const page =
       reinterpret_cast<small_object_page_info*>(
           PAGE_START(reinterpret_cast<uintptr_t>(ptr)));
@@ -181,14 +183,42 @@ void BionicSmallObjectAllocator::free(void* ptr) {
   page->free_blocks_cnt++;
 
   if (page->free_blocks_cnt == blocks_per_page_) {
-    if (++free_pages_cnt_ > 1) {
-      // if we already have a free page - unmap this one.
-      free_page(page);
-    }
+    free_pages_cnt_++;
   } else if (page->free_blocks_cnt == 1) {
     // We just freed from a full page.  Add this page back to the list.
     add_to_page_list(page);
   }
+
+  return page;
+}
+
+void BionicSmallObjectAllocator::free(void* ptr) {
+  small_object_page_info* const page = free_block(ptr);
+
+  // if we already have a free page - unmap this one.
+  if (page->free_blocks_cnt == blocks_per_page_ && free_pages_cnt_ > 1) {
+    free_page(page);
+  }
+}
+
+void BionicSmallObjectAllocator::free_batch(void** blocks, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    free_block(blocks[i]);
+  }
+  retire_surplus_pages();
+}
+
+// Unmap all fully free pages except one, which is kept in reserve as the
+// regular free path does.
+void BionicSmallObjectAllocator::retire_surplus_pages() {
+  small_object_page_info* page = page_list_;
+  while (free_pages_cnt_ > 1 && page != nullptr) {
+    small_object_page_info* const next = page->next_page;
+    if (page->free_blocks_cnt == blocks_per_page_) {
+      free_page(page);
+    }
+    page = next;
+  }
 }
 
 void BionicSmallObjectAllocator::alloc_page() {
@@ -249,6 +279,105 @@ void BionicSmallObjectAllocator::remove_from_page_list(
   page->next_page = nullptr;
 }
 
+// Optional per-thread cache tier: a small magazine of blocks per size class,
+// created on demand once enable_thread_caches() has been called. Magazine
+// hits touch no shared state at all; refills and drains move half a magazine
+// at a time through the shared page lists under lock_.
+static constexpr size_t kThreadCacheMagazineSize = 16;
+
+struct thread_cache_magazine {
+  size_t count;
+  void* blocks[kThreadCacheMagazineSize];
+};
+
+struct bionic_allocator_thread_cache {
+  BionicAllocator* owner;
+  thread_cache_magazine magazines[kSmallObjectAllocatorsCount];
+};
+
+static_assert(sizeof(bionic_allocator_thread_cache) <= PAGE_SIZE,
+              "bionic_allocator_thread_cache must fit in one page");
+
+void BionicAllocator::enable_thread_caches() {
+  if (thread_cache_enabled_) {
+    return;
+  }
+  initialize_allocators();
+  if (pthread_key_create(&thread_cache_key_, thread_cache_destructor) != 0) {
+    async_safe_fatal("pthread_key_create failed: %s", strerror(errno));
+  }
+  thread_cache_enabled_ = true;
+}
+
+bionic_allocator_thread_cache* BionicAllocator::get_thread_cache() {
+  auto* cache =
+      static_cast<bionic_allocator_thread_cache*>(pthread_getspecific(thread_cache_key_));
+  if (cache == nullptr) {
+    void* const map_ptr = mmap(nullptr, PAGE_SIZE, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map_ptr == MAP_FAILED) {
+      async_safe_fatal("mmap failed: %s", strerror(errno));
+    }
+    prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, map_ptr, PAGE_SIZE, "bionic_alloc_thread_cache");
+    cache = reinterpret_cast<bionic_allocator_thread_cache*>(map_ptr);
+    cache->owner = this;
+    pthread_setspecific(thread_cache_key_, cache);
+  }
+  return cache;
+}
+
+void BionicAllocator::thread_cache_destructor(void* arg) {
+  auto* cache = static_cast<bionic_allocator_thread_cache*>(arg);
+  BionicAllocator* self = cache->owner;
+
+  pthread_mutex_lock(&self->lock_);
+  for (size_t i = 0; i < kSmallObjectAllocatorsCount; ++i) {
+    thread_cache_magazine& magazine = cache->magazines[i];
+    if (magazine.count != 0) {
+      self->allocators_[i].free_batch(magazine.blocks, magazine.count);
+      magazine.count = 0;
+    }
+  }
+  pthread_mutex_unlock(&self->lock_);
+
+  munmap(cache, PAGE_SIZE);
+}
+
+void* BionicAllocator::alloc_small_cached(uint16_t log2_size) {
+  thread_cache_magazine& magazine =
+      get_thread_cache()->magazines[log2_size - kSmallObjectMinSizeLog2];
+
+  if (magazine.count == 0) {
+    BionicSmallObjectAllocator* allocator = get_small_object_allocator(log2_size);
+    pthread_mutex_lock(&lock_);
+    while (magazine.count < kThreadCacheMagazineSize / 2) {
+      magazine.blocks[magazine.count++] = allocator->alloc();
+    }
+    pthread_mutex_unlock(&lock_);
+  }
+
+  return magazine.blocks[--magazine.count];
+}
+
+void BionicAllocator::free_small_cached(BionicSmallObjectAllocator* allocator, uint32_t type,
+                                        void* ptr) {
+  thread_cache_magazine& magazine = get_thread_cache()->magazines[type - kSmallObjectMinSizeLog2];
+
+  if (magazine.count == kThreadCacheMagazineSize) {
+    // Drain the top half in one batch so the magazine keeps some reuse.
+    constexpr size_t half = kThreadCacheMagazineSize / 2;
+    pthread_mutex_lock(&lock_);
+    allocator->free_batch(&magazine.blocks[half], half);
+    pthread_mutex_unlock(&lock_);
+    magazine.count = half;
+  }
+
+  // Blocks are handed back out without another pass over the shared lists,
+  // so scrub them now to keep alloc()'s zeroed-memory guarantee.
+  memset(ptr, 0, allocator->get_block_size());
+  magazine.blocks[magazine.count++] = ptr;
+}
+
 void BionicAllocator::initialize_allocators() {
   if (allocators_ != nullptr) {
     return;
@@ -303,6 +432,10 @@ inline void* BionicAllocator::alloc_impl(size_t align, size_t size) {
     log2_size = kSmallObjectMinSizeLog2;
   }
 
+  if (__predict_false(thread_cache_enabled_)) {
+    return alloc_small_cached(log2_size);
+  }
+
   return get_small_object_allocator(log2_size)->alloc();
 }
 
@@ -390,6 +523,11 @@ void BionicAllocator::free(void* ptr) {
       async_safe_fatal("invalid pointer %p (invalid allocator address for the page)", ptr);
     }
 
+    if (__predict_false(thread_cache_enabled_)) {
+      free_small_cached(allocator, info->type, ptr);
+      return;
+    }
+
     allocator->free(ptr);
   }
 }
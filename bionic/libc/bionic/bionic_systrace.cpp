@@ -16,6 +16,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -33,28 +34,47 @@
 
 static Lock g_lock;
 static CachedProperty g_debug_atrace_tags_enableflags("debug.atrace.tags.enableflags");
-static uint64_t g_tags;
-static int g_trace_marker_fd = -1;
+static _Atomic(uint64_t) g_tags;
+static _Atomic(uint32_t) g_property_area_serial;
+static _Atomic(int) g_trace_marker_fd = -1;
 
 static bool should_trace() {
-  g_lock.lock();
-  if (g_debug_atrace_tags_enableflags.DidChange()) {
-    g_tags = strtoull(g_debug_atrace_tags_enableflags.Get(), nullptr, 0);
+  // This is called on every traced event, so hot functions in every thread
+  // serialize here if it takes the lock. Instead, observe the (lock-free)
+  // global property serial and only fall back to the lock to re-read the
+  // property when some property actually changed; in steady state this is
+  // two relaxed loads.
+  uint32_t property_area_serial = __system_property_area_serial();
+  if (atomic_load_explicit(&g_property_area_serial, memory_order_relaxed) !=
+      property_area_serial) {
+    g_lock.lock();
+    if (g_debug_atrace_tags_enableflags.DidChange()) {
+      atomic_store_explicit(&g_tags,
+                            strtoull(g_debug_atrace_tags_enableflags.Get(), nullptr, 0),
+                            memory_order_relaxed);
+    }
+    atomic_store_explicit(&g_property_area_serial, property_area_serial, memory_order_relaxed);
+    g_lock.unlock();
   }
-  g_lock.unlock();
-  return ((g_tags & ATRACE_TAG_BIONIC) != 0);
+  return ((atomic_load_explicit(&g_tags, memory_order_relaxed) & ATRACE_TAG_BIONIC) != 0);
 }
 
 static int get_trace_marker_fd() {
+  int fd = atomic_load_explicit(&g_trace_marker_fd, memory_order_acquire);
+  if (__predict_true(fd != -1)) {
+    return fd;
+  }
   g_lock.lock();
-  if (g_trace_marker_fd == -1) {
-    g_trace_marker_fd = open("/sys/kernel/tracing/trace_marker", O_CLOEXEC | O_WRONLY);
-    if (g_trace_marker_fd == -1) {
-      g_trace_marker_fd = open("/sys/kernel/debug/tracing/trace_marker", O_CLOEXEC | O_WRONLY);
+  fd = atomic_load_explicit(&g_trace_marker_fd, memory_order_relaxed);
+  if (fd == -1) {
+    fd = open("/sys/kernel/tracing/trace_marker", O_CLOEXEC | O_WRONLY);
+    if (fd == -1) {
+      fd = open("/sys/kernel/debug/tracing/trace_marker", O_CLOEXEC | O_WRONLY);
     }
+    atomic_store_explicit(&g_trace_marker_fd, fd, memory_order_release);
   }
   g_lock.unlock();
-  return g_trace_marker_fd;
+  return fd;
 }
 
 static void trace_begin_internal(const char* message) {
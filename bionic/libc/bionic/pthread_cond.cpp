@@ -211,9 +211,28 @@ static int __pthread_cond_timedwait(pthread_cond_internal_t* cond, pthread_mutex
 }
 
 int pthread_cond_broadcast(pthread_cond_t* cond_interface) {
+  // A FUTEX_CMP_REQUEUE fast path (wake one waiter, park the rest on the
+  // mutex's futex word) was tried here and reverted: broadcast would have to
+  // dereference the mutex most recently bound to the condvar, but nothing
+  // keeps that mutex alive. A waiter drops `waiters` before it relocks, so it
+  // can return and the application can legally destroy and free the mutex
+  // while a stalled broadcaster still holds the pointer — the same lifetime
+  // race that made glibc abandon its requeue condvar. Wake-all is safe: it
+  // only ever touches the condvar itself.
   return __pthread_cond_pulse(__get_internal_cond(cond_interface), INT_MAX);
 }
 
+// Wake-batching hint for producer/consumer patterns: wakes up to `count`
+// waiters in a single futex operation, for producers that enqueued `count`
+// items and would otherwise call pthread_cond_signal in a loop.
+extern "C" int pthread_cond_wake_np(pthread_cond_t* cond_interface, unsigned count) {
+  if (count == 0) {
+    return 0;
+  }
+  return __pthread_cond_pulse(__get_internal_cond(cond_interface),
+                              count > INT_MAX ? INT_MAX : static_cast<int>(count));
+}
+
 int pthread_cond_signal(pthread_cond_t* cond_interface) {
   return __pthread_cond_pulse(__get_internal_cond(cond_interface), 1);
 }
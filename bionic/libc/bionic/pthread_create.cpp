@@ -45,6 +45,7 @@
 #include "private/bionic_defs.h"
 #include "private/bionic_globals.h"
 #include "platform/bionic/macros.h"
+#include "private/bionic_lock.h"
 #include "private/bionic_ssp.h"
 #include "private/bionic_systrace.h"
 #include "private/bionic_tls.h"
@@ -193,6 +194,74 @@ int __init_thread(pthread_internal_t* thread) {
 }
 
 
+// Cache of primary mappings recycled from joined threads, so burst thread
+// creation (thread pools re-spawning workers) skips the mmap/mprotect calls
+// and guard setup. An entry's contents have already been discarded with
+// MADV_DONTNEED, so reusing one is indistinguishable from a fresh anonymous
+// mapping, including the zero-initialization that static TLS setup relies
+// on. Entries are only reusable for an identical geometry (total size and
+// guard split), which covers the common case of default-attribute threads.
+struct CachedThreadMapping {
+  char* mmap_base;
+  size_t mmap_size;
+  char* mmap_base_unguarded;
+  size_t mmap_size_unguarded;
+};
+
+static constexpr size_t kMaxCachedThreadMappings = 8;
+static Lock g_thread_mapping_cache_lock;
+static CachedThreadMapping g_thread_mapping_cache[kMaxCachedThreadMappings];
+static size_t g_thread_mapping_cache_count = 0;
+
+// Called by the joiner (or pthread_detach after exit) instead of munmap.
+// Returns true if the mapping was parked in the cache. Uses trylock so the
+// cache can never deadlock a joiner against a forking process.
+bool __cache_thread_mapping(pthread_internal_t* thread) {
+  // `thread` lives inside the mapping, so copy everything out before the
+  // madvise below wipes it.
+  CachedThreadMapping entry;
+  entry.mmap_base = static_cast<char*>(thread->mmap_base);
+  entry.mmap_size = thread->mmap_size;
+  entry.mmap_base_unguarded = static_cast<char*>(thread->mmap_base_unguarded);
+  entry.mmap_size_unguarded = thread->mmap_size_unguarded;
+
+  if (g_thread_mapping_cache_count == kMaxCachedThreadMappings ||
+      !g_thread_mapping_cache_lock.trylock()) {
+    return false;
+  }
+  bool cached = false;
+  if (g_thread_mapping_cache_count < kMaxCachedThreadMappings &&
+      madvise(entry.mmap_base_unguarded, entry.mmap_size_unguarded, MADV_DONTNEED) == 0) {
+    g_thread_mapping_cache[g_thread_mapping_cache_count++] = entry;
+    cached = true;
+  }
+  g_thread_mapping_cache_lock.unlock();
+  return cached;
+}
+
+static bool __reuse_thread_mapping(size_t mmap_size, size_t stack_guard_size,
+                                   ThreadMapping* result) {
+  if (g_thread_mapping_cache_count == 0 || !g_thread_mapping_cache_lock.trylock()) {
+    return false;
+  }
+  bool reused = false;
+  for (size_t i = 0; i < g_thread_mapping_cache_count; ++i) {
+    CachedThreadMapping& entry = g_thread_mapping_cache[i];
+    if (entry.mmap_size == mmap_size &&
+        static_cast<size_t>(entry.mmap_base_unguarded - entry.mmap_base) == stack_guard_size) {
+      result->mmap_base = entry.mmap_base;
+      result->mmap_size = entry.mmap_size;
+      result->mmap_base_unguarded = entry.mmap_base_unguarded;
+      result->mmap_size_unguarded = entry.mmap_size_unguarded;
+      entry = g_thread_mapping_cache[--g_thread_mapping_cache_count];
+      reused = true;
+      break;
+    }
+  }
+  g_thread_mapping_cache_lock.unlock();
+  return reused;
+}
+
 // Allocate a thread's primary mapping. This mapping includes static TLS and
 // optionally a stack. Static TLS includes ELF TLS segments and the bionic_tls
 // struct.
@@ -212,6 +281,17 @@ ThreadMapping __allocate_thread_mapping(size_t stack_size, size_t stack_guard_si
   mmap_size = __BIONIC_ALIGN(mmap_size, PAGE_SIZE);
   if (mmap_size < unaligned_size) return {};
 
+  // Reuse a recycled mapping with the same geometry if one is available. Its
+  // pages were discarded when it was cached, so the guard protections are
+  // still in place and the writable region reads as zeros again.
+  ThreadMapping result = {};
+  if (__reuse_thread_mapping(mmap_size, stack_guard_size, &result)) {
+    result.static_tls = result.mmap_base + mmap_size - PTHREAD_GUARD_SIZE - layout.size();
+    result.stack_base = result.mmap_base;
+    result.stack_top = result.static_tls;
+    return result;
+  }
+
   // Create a new private anonymous map. Make the entire mapping PROT_NONE, then carve out a
   // read+write area in the middle.
   const int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
@@ -234,7 +314,6 @@ ThreadMapping __allocate_thread_mapping(size_t stack_size, size_t stack_guard_si
     return {};
   }
 
-  ThreadMapping result = {};
   result.mmap_base = space;
   result.mmap_size = mmap_size;
   result.mmap_base_unguarded = space + stack_guard_size;
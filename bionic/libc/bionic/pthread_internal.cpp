@@ -73,8 +73,11 @@ void __pthread_internal_remove(pthread_internal_t* thread) {
 
 static void __pthread_internal_free(pthread_internal_t* thread) {
   if (thread->mmap_size != 0) {
-    // Free mapped space, including thread stack and pthread_internal_t.
-    munmap(thread->mmap_base, thread->mmap_size);
+    // Try to recycle the mapping for a future pthread_create; otherwise free
+    // mapped space, including thread stack and pthread_internal_t.
+    if (!__cache_thread_mapping(thread)) {
+      munmap(thread->mmap_base, thread->mmap_size);
+    }
   }
 }
 
@@ -216,6 +216,10 @@ extern "C" __LIBC_HIDDEN__ int __set_tls(void* ptr);
 
 __LIBC_HIDDEN__ void pthread_key_clean_all(void);
 
+// Tries to park a finished thread's primary mapping in the reuse cache
+// instead of unmapping it. Returns false if the caller should munmap.
+__LIBC_HIDDEN__ bool __cache_thread_mapping(pthread_internal_t* thread);
+
 // Address space is precious on LP32, so use the minimum unit: one page.
 // On LP64, we could use more but there's no obvious advantage to doing
 // so, and the various media processes use RLIMIT_AS as a way to limit
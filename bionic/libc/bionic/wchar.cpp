@@ -53,6 +53,22 @@
 // function pointers.
 //
 
+// Word-at-a-time test for the bulk ASCII fast paths below: returns true if
+// all eight bytes at `s` are non-NUL ASCII, so they can be converted with a
+// straight copy. The loops the callers run over such chunks are simple enough
+// for the compiler to turn into SIMD loads and widening/narrowing stores.
+static inline bool chunk_is_ascii(const char* s) {
+  uint64_t chunk;
+  memcpy(&chunk, s, sizeof(chunk));
+  return ((chunk | (chunk - 0x0101010101010101ULL)) & 0x8080808080808080ULL) == 0;
+}
+
+// As above, for four UTF-32 characters.
+static inline bool wchunk_is_ascii(const wchar_t* s) {
+  uint32_t w0 = s[0], w1 = s[1], w2 = s[2], w3 = s[3];
+  return ((w0 | w1 | w2 | w3) & ~0x7fu) == 0 && w0 != 0 && w1 != 0 && w2 != 0 && w3 != 0;
+}
+
 int mbsinit(const mbstate_t* ps) {
   return ps == nullptr || mbstate_is_initial(ps);
 }
@@ -80,6 +96,12 @@ size_t mbsnrtowcs(wchar_t* dst, const char** src, size_t nmc, size_t len, mbstat
   // Measure only?
   if (dst == nullptr) {
     for (i = o = 0; i < nmc; i += r, o++) {
+      // Bulk fast path: count whole chunks of ASCII characters.
+      while (i + 8 <= nmc && chunk_is_ascii(*src + i)) {
+        i += 8;
+        o += 8;
+      }
+      if (i >= nmc) break;
       if (static_cast<uint8_t>((*src)[i]) < 0x80) {
         // Fast path for plain ASCII characters.
         if ((*src)[i] == '\0') {
@@ -104,6 +126,15 @@ size_t mbsnrtowcs(wchar_t* dst, const char** src, size_t nmc, size_t len, mbstat
 
   // Actually convert, updating `dst` and `src`.
   for (i = o = 0; i < nmc && o < len; i += r, o++) {
+    // Bulk fast path: widen whole chunks of ASCII characters.
+    while (i + 8 <= nmc && o + 8 <= len && chunk_is_ascii(*src + i)) {
+      for (size_t b = 0; b < 8; b++) {
+        dst[o + b] = static_cast<uint8_t>((*src)[i + b]);
+      }
+      i += 8;
+      o += 8;
+    }
+    if (i >= nmc || o >= len) break;
     if (static_cast<uint8_t>((*src)[i]) < 0x80) {
       // Fast path for plain ASCII characters.
       dst[o] = (*src)[i];
@@ -156,6 +187,12 @@ size_t wcsnrtombs(char* dst, const wchar_t** src, size_t nwc, size_t len, mbstat
   size_t i, o, r;
   if (dst == nullptr) {
     for (i = o = 0; i < nwc; i++, o += r) {
+      // Bulk fast path: count whole chunks of ASCII characters.
+      while (i + 4 <= nwc && wchunk_is_ascii(*src + i)) {
+        i += 4;
+        o += 4;
+      }
+      if (i >= nwc) break;
       wchar_t wc = (*src)[i];
       if (static_cast<uint32_t>(wc) < 0x80) {
         // Fast path for plain ASCII characters.
@@ -174,6 +211,15 @@ size_t wcsnrtombs(char* dst, const wchar_t** src, size_t nwc, size_t len, mbstat
   }
 
   for (i = o = 0; i < nwc && o < len; i++, o += r) {
+    // Bulk fast path: narrow whole chunks of ASCII characters.
+    while (i + 4 <= nwc && o + 4 <= len && wchunk_is_ascii(*src + i)) {
+      for (size_t b = 0; b < 4; b++) {
+        dst[o + b] = static_cast<char>((*src)[i + b]);
+      }
+      i += 4;
+      o += 4;
+    }
+    if (i >= nwc || o >= len) break;
     wchar_t wc = (*src)[i];
     if (static_cast<uint32_t>(wc) < 0x80) {
       // Fast path for plain ASCII characters.
@@ -131,6 +131,16 @@
  */
 #define  CONFIG_MAX_ENTRIES    64 * 2 * 5
 
+/* serve-stale: how long (in seconds) an expired positive entry may still be
+ * served while one caller refreshes it over the network. Keeps hot names
+ * (RPC meshes resolving the same handful of names continuously) from
+ * stalling every connect for a full round trip at each TTL boundary. */
+#define  CONFIG_STALE_WINDOW   30
+
+/* serve-stale: how long an elected refresher has before another caller is
+ * elected, in case its query was lost or it died. */
+#define  CONFIG_REFRESH_GRACE  5
+
 /****************************************************************************/
 /****************************************************************************/
 /*****                                                                  *****/
@@ -1057,6 +1067,10 @@ typedef struct Entry {
     const uint8_t*   answer;
     int              answerlen;
     time_t           expires;   /* time_t when the entry isn't valid any more */
+    /* serve-stale: when a pending refresh of this entry is considered lost
+     * and another caller may be elected to retry. 0 when no refresh is
+     * pending. */
+    time_t           refresh_deadline;
     int              id;        /* for debugging purpose */
 } Entry;
 
@@ -1727,12 +1741,24 @@ _resolv_cache_lookup( unsigned              netid,
 
     now = _time_now();
 
-    /* remove stale entries here */
+    /* expired entries within the stale window are still served, with one
+     * caller elected to refresh them; older ones are removed here */
     if (now >= e->expires) {
-        XLOG( " NOT IN CACHE (STALE ENTRY %p DISCARDED)", *lookup );
-        XLOG_QUERY(e->query, e->querylen);
-        _cache_remove_p(cache, lookup);
-        goto Exit;
+        if (now >= e->expires + CONFIG_STALE_WINDOW) {
+            XLOG( " NOT IN CACHE (STALE ENTRY %p DISCARDED)", *lookup );
+            XLOG_QUERY(e->query, e->querylen);
+            _cache_remove_p(cache, lookup);
+            goto Exit;
+        }
+        if (now >= e->refresh_deadline) {
+            /* elect this caller to refresh the entry: it reports a miss and
+             * performs the network query, while everyone else keeps getting
+             * the stale answer until _resolv_cache_add replaces it. */
+            e->refresh_deadline = now + CONFIG_REFRESH_GRACE;
+            XLOG( " IN CACHE (EXPIRED entry %p, ELECTED TO REFRESH)", e );
+            goto Exit;
+        }
+        XLOG( " IN CACHE (EXPIRED entry %p, SERVED STALE WHILE REFRESHING)", e );
     }
 
     *answerlen = e->answerlen;
@@ -1798,10 +1824,18 @@ _resolv_cache_add( unsigned              netid,
     lookup = _cache_lookup_p(cache, key);
     e      = *lookup;
 
-    if (e != NULL) { /* should not happen */
-        XLOG("%s: ALREADY IN CACHE (%p) ? IGNORING ADD",
-             __FUNCTION__, e);
-        goto Exit;
+    if (e != NULL) {
+        if (_time_now() >= e->expires) {
+            /* a serve-stale refresh came back: replace the expired entry */
+            XLOG("%s: REPLACING STALE ENTRY (%p)", __FUNCTION__, e);
+            _cache_remove_p(cache, lookup);
+            lookup = _cache_lookup_p(cache, key);
+        } else {
+            /* should not happen */
+            XLOG("%s: ALREADY IN CACHE (%p) ? IGNORING ADD",
+                 __FUNCTION__, e);
+            goto Exit;
+        }
     }
 
     if (cache->num_entries >= cache->max_entries) {
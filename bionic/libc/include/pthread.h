@@ -139,6 +139,13 @@ int pthread_cond_timedwait(pthread_cond_t* __cond, pthread_mutex_t* __mutex, con
  */
 int pthread_cond_timedwait_monotonic_np(pthread_cond_t* __cond, pthread_mutex_t* __mutex,
                                         const struct timespec* __timeout) __INTRODUCED_IN_64(28);
+/*
+ * Wakes up to `__count` threads waiting on `__cond` in one futex operation.
+ * A batching hint for producer/consumer patterns: a producer that enqueued
+ * `__count` items can use this instead of calling pthread_cond_signal in a
+ * loop (or waking every waiter with pthread_cond_broadcast).
+ */
+int pthread_cond_wake_np(pthread_cond_t* __cond, unsigned __count);
 int pthread_cond_wait(pthread_cond_t* __cond, pthread_mutex_t* __mutex);
 
 #if defined(__clang__)
@@ -67,6 +67,8 @@ static constexpr size_t MAX_FREE_TRACK_ALLOCATIONS = 16384;
 static constexpr size_t DEFAULT_RECORD_ALLOCS = 8000000;
 static constexpr size_t MAX_RECORD_ALLOCS = 50000000;
 static constexpr const char DEFAULT_RECORD_ALLOCS_FILE[] = "/data/local/tmp/record_allocs.txt";
+static constexpr size_t DEFAULT_RECORD_ALLOCS_SAMPLING = 1;
+static constexpr size_t MAX_RECORD_ALLOCS_SAMPLING = 1000000;
 
 const std::unordered_map<std::string, Config::OptionInfo> Config::kOptions = {
     {
@@ -128,6 +130,9 @@ const std::unordered_map<std::string, Config::OptionInfo> Config::kOptions = {
     {
         "record_allocs_file", {0, &Config::SetRecordAllocsFile},
     },
+    {
+        "record_allocs_sampling", {0, &Config::SetRecordAllocsSampling},
+    },
 
     {
         "verify_pointers", {TRACK_ALLOCS, &Config::VerifyValueEmpty},
@@ -304,6 +309,11 @@ bool Config::SetRecordAllocs(const std::string& option, const std::string& value
                     &record_allocs_num_entries_);
 }
 
+bool Config::SetRecordAllocsSampling(const std::string& option, const std::string& value) {
+  return ParseValue(option, value, DEFAULT_RECORD_ALLOCS_SAMPLING, 1, MAX_RECORD_ALLOCS_SAMPLING,
+                    &record_allocs_sampling_);
+}
+
 bool Config::SetRecordAllocsFile(const std::string&, const std::string& value) {
   if (value.empty()) {
     // Set the default.
@@ -375,6 +385,7 @@ bool Config::Init(const char* options_str) {
   record_allocs_signal_ = SIGRTMAX - 18;
   free_track_backtrace_num_frames_ = 0;
   record_allocs_file_.clear();
+  record_allocs_sampling_ = DEFAULT_RECORD_ALLOCS_SAMPLING;
   fill_on_free_bytes_ = 0;
   backtrace_enable_on_signal_ = false;
   backtrace_enabled_ = false;
@@ -92,6 +92,7 @@ class Config {
   int record_allocs_signal() const { return record_allocs_signal_; }
   size_t record_allocs_num_entries() const { return record_allocs_num_entries_; }
   const std::string& record_allocs_file() const { return record_allocs_file_; }
+  size_t record_allocs_sampling() const { return record_allocs_sampling_; }
 
  private:
   struct OptionInfo {
@@ -125,6 +126,7 @@ class Config {
 
   bool SetRecordAllocs(const std::string& option, const std::string& value);
   bool SetRecordAllocsFile(const std::string& option, const std::string& value);
+  bool SetRecordAllocsSampling(const std::string& option, const std::string& value);
 
   bool VerifyValueEmpty(const std::string& option, const std::string& value);
 
@@ -154,6 +156,7 @@ class Config {
   int record_allocs_signal_ = 0;
   size_t record_allocs_num_entries_ = 0;
   std::string record_allocs_file_;
+  size_t record_allocs_sampling_ = 1;
 
   uint64_t options_ = 0;
   uint8_t fill_alloc_value_;
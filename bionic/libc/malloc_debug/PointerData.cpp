@@ -58,18 +58,10 @@ extern "C" char* __cxa_demangle(const char*, char*, size_t*, int*);
 std::atomic_uint8_t PointerData::backtrace_enabled_;
 std::atomic_bool PointerData::backtrace_dump_;
 
-std::mutex PointerData::pointer_mutex_;
-std::unordered_map<uintptr_t, PointerInfoType> PointerData::pointers_ GUARDED_BY(
-    PointerData::pointer_mutex_);
-
-std::mutex PointerData::frame_mutex_;
-std::unordered_map<FrameKeyType, size_t> PointerData::key_to_index_ GUARDED_BY(
-    PointerData::frame_mutex_);
-std::unordered_map<size_t, FrameInfoType> PointerData::frames_ GUARDED_BY(PointerData::frame_mutex_);
-std::unordered_map<size_t, std::vector<unwindstack::FrameData>> PointerData::backtraces_info_
-    GUARDED_BY(PointerData::frame_mutex_);
+PointerData::PointerShard PointerData::pointer_shards_[PointerData::kPointerShardCount];
+
+PointerData::FrameShard PointerData::frame_shards_[PointerData::kFrameShardCount];
 constexpr size_t kBacktraceEmptyIndex = 1;
-size_t PointerData::cur_hash_index_ GUARDED_BY(PointerData::frame_mutex_);
 
 std::mutex PointerData::free_pointer_mutex_;
 std::deque<FreePointerInfoType> PointerData::free_pointers_ GUARDED_BY(
@@ -89,14 +81,62 @@ static void EnableDump(int, siginfo_t*, void*) {
 
 PointerData::PointerData(DebugData* debug_data) : OptionData(debug_data) {}
 
+PointerData::PointerShard& PointerData::ShardForPointer(uintptr_t pointer) {
+  // Allocations are at least MINIMUM_ALIGNMENT_BYTES aligned, so skip the
+  // always zero low bits before picking a shard.
+  return pointer_shards_[(pointer / MINIMUM_ALIGNMENT_BYTES) & (kPointerShardCount - 1)];
+}
+
+PointerData::FrameShard& PointerData::ShardForHashIndex(size_t hash_index) {
+  return frame_shards_[hash_index & (kFrameShardCount - 1)];
+}
+
+// Acquire every shard lock. Always lock in the same order so callers of
+// this function cannot deadlock against each other.
+void PointerData::LockAll() NO_THREAD_SAFETY_ANALYSIS {
+  for (size_t i = 0; i < kPointerShardCount; i++) {
+    pointer_shards_[i].mutex.lock();
+  }
+  for (size_t i = 0; i < kFrameShardCount; i++) {
+    frame_shards_[i].mutex.lock();
+  }
+}
+
+void PointerData::UnlockAll() NO_THREAD_SAFETY_ANALYSIS {
+  for (size_t i = 0; i < kFrameShardCount; i++) {
+    frame_shards_[i].mutex.unlock();
+  }
+  for (size_t i = 0; i < kPointerShardCount; i++) {
+    pointer_shards_[i].mutex.unlock();
+  }
+}
+
+// Must be called with every pointer shard locked.
+bool PointerData::AnyPointersTracked() NO_THREAD_SAFETY_ANALYSIS {
+  for (size_t i = 0; i < kPointerShardCount; i++) {
+    if (!pointer_shards_[i].pointers.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool PointerData::Initialize(const Config& config) NO_THREAD_SAFETY_ANALYSIS {
-  pointers_.clear();
-  key_to_index_.clear();
-  frames_.clear();
+  for (size_t i = 0; i < kPointerShardCount; i++) {
+    pointer_shards_[i].pointers.clear();
+  }
+  for (size_t i = 0; i < kFrameShardCount; i++) {
+    FrameShard& shard = frame_shards_[i];
+    shard.key_to_index.clear();
+    shard.frames.clear();
+    shard.backtraces_info.clear();
+    // A hash index of kBacktraceEmptyIndex indicates that we tried to get
+    // a backtrace, but there was nothing recorded. Start the per shard
+    // indices past it so that no encoded hash_index collides with the
+    // sentinel values.
+    shard.next_index = kBacktraceEmptyIndex + 1;
+  }
   free_pointers_.clear();
-  // A hash index of kBacktraceEmptyIndex indicates that we tried to get
-  // a backtrace, but there was nothing recorded.
-  cur_hash_index_ = kBacktraceEmptyIndex + 1;
 
   backtrace_enabled_ = config.backtrace_enabled();
   if (config.backtrace_enable_on_signal()) {
@@ -151,22 +191,26 @@ size_t PointerData::AddBacktrace(size_t num_frames) {
   }
 
   FrameKeyType key{.num_frames = num_frames, .frames = frames.data()};
+  size_t shard_index = std::hash<FrameKeyType>()(key) & (kFrameShardCount - 1);
+  FrameShard& shard = frame_shards_[shard_index];
   size_t hash_index;
-  std::lock_guard<std::mutex> frame_guard(frame_mutex_);
-  auto entry = key_to_index_.find(key);
-  if (entry == key_to_index_.end()) {
+  std::lock_guard<std::mutex> frame_guard(shard.mutex);
+  auto entry = shard.key_to_index.find(key);
+  if (entry == shard.key_to_index.end()) {
     frames.resize(num_frames);
-    hash_index = cur_hash_index_++;
+    // Encode the owning shard in the low bits so that lookups by
+    // hash_index can find the shard again.
+    hash_index = (shard.next_index++ << kFrameShardBits) | shard_index;
     key.frames = frames.data();
-    key_to_index_.emplace(key, hash_index);
+    shard.key_to_index.emplace(key, hash_index);
 
-    frames_.emplace(hash_index, FrameInfoType{.references = 1, .frames = std::move(frames)});
+    shard.frames.emplace(hash_index, FrameInfoType{.references = 1, .frames = std::move(frames)});
     if (g_debug->config().options() & BACKTRACE_FULL) {
-      backtraces_info_.emplace(hash_index, std::move(frames_info));
+      shard.backtraces_info.emplace(hash_index, std::move(frames_info));
     }
   } else {
     hash_index = entry->second;
-    FrameInfoType* frame_info = &frames_[hash_index];
+    FrameInfoType* frame_info = &shard.frames[hash_index];
     frame_info->references++;
   }
   return hash_index;
@@ -177,19 +221,20 @@ void PointerData::RemoveBacktrace(size_t hash_index) {
     return;
   }
 
-  std::lock_guard<std::mutex> frame_guard(frame_mutex_);
-  auto frame_entry = frames_.find(hash_index);
-  if (frame_entry == frames_.end()) {
+  FrameShard& shard = ShardForHashIndex(hash_index);
+  std::lock_guard<std::mutex> frame_guard(shard.mutex);
+  auto frame_entry = shard.frames.find(hash_index);
+  if (frame_entry == shard.frames.end()) {
     error_log("hash_index %zu does not have matching frame data.", hash_index);
     return;
   }
   FrameInfoType* frame_info = &frame_entry->second;
   if (--frame_info->references == 0) {
     FrameKeyType key{.num_frames = frame_info->frames.size(), .frames = frame_info->frames.data()};
-    key_to_index_.erase(key);
-    frames_.erase(hash_index);
+    shard.key_to_index.erase(key);
+    shard.frames.erase(hash_index);
     if (g_debug->config().options() & BACKTRACE_FULL) {
-      backtraces_info_.erase(hash_index);
+      shard.backtraces_info.erase(hash_index);
     }
   }
 }
@@ -201,23 +246,25 @@ void PointerData::Add(const void* ptr, size_t pointer_size) {
     hash_index = AddBacktrace(g_debug->config().backtrace_frames());
   }
 
-  std::lock_guard<std::mutex> pointer_guard(pointer_mutex_);
-  pointers_[pointer] = PointerInfoType{PointerInfoType::GetEncodedSize(pointer_size), hash_index};
+  PointerShard& shard = ShardForPointer(pointer);
+  std::lock_guard<std::mutex> pointer_guard(shard.mutex);
+  shard.pointers[pointer] = PointerInfoType{PointerInfoType::GetEncodedSize(pointer_size), hash_index};
 }
 
 void PointerData::Remove(const void* ptr) {
   uintptr_t pointer = reinterpret_cast<uintptr_t>(ptr);
   size_t hash_index;
   {
-    std::lock_guard<std::mutex> pointer_guard(pointer_mutex_);
-    auto entry = pointers_.find(pointer);
-    if (entry == pointers_.end()) {
+    PointerShard& shard = ShardForPointer(pointer);
+    std::lock_guard<std::mutex> pointer_guard(shard.mutex);
+    auto entry = shard.pointers.find(pointer);
+    if (entry == shard.pointers.end()) {
       // Attempt to remove unknown pointer.
       error_log("No tracked pointer found for 0x%" PRIxPTR, pointer);
       return;
     }
     hash_index = entry->second.hash_index;
-    pointers_.erase(pointer);
+    shard.pointers.erase(pointer);
   }
 
   RemoveBacktrace(hash_index);
@@ -227,9 +274,10 @@ size_t PointerData::GetFrames(const void* ptr, uintptr_t* frames, size_t max_fra
   uintptr_t pointer = reinterpret_cast<uintptr_t>(ptr);
   size_t hash_index;
   {
-    std::lock_guard<std::mutex> pointer_guard(pointer_mutex_);
-    auto entry = pointers_.find(pointer);
-    if (entry == pointers_.end()) {
+    PointerShard& shard = ShardForPointer(pointer);
+    std::lock_guard<std::mutex> pointer_guard(shard.mutex);
+    auto entry = shard.pointers.find(pointer);
+    if (entry == shard.pointers.end()) {
       return 0;
     }
     hash_index = entry->second.hash_index;
@@ -239,9 +287,10 @@ size_t PointerData::GetFrames(const void* ptr, uintptr_t* frames, size_t max_fra
     return 0;
   }
 
-  std::lock_guard<std::mutex> frame_guard(frame_mutex_);
-  auto frame_entry = frames_.find(hash_index);
-  if (frame_entry == frames_.end()) {
+  FrameShard& shard = ShardForHashIndex(hash_index);
+  std::lock_guard<std::mutex> frame_guard(shard.mutex);
+  auto frame_entry = shard.frames.find(hash_index);
+  if (frame_entry == shard.frames.end()) {
     return 0;
   }
   FrameInfoType* frame_info = &frame_entry->second;
@@ -254,16 +303,17 @@ size_t PointerData::GetFrames(const void* ptr, uintptr_t* frames, size_t max_fra
 }
 
 void PointerData::LogBacktrace(size_t hash_index) {
-  std::lock_guard<std::mutex> frame_guard(frame_mutex_);
+  FrameShard& shard = ShardForHashIndex(hash_index);
+  std::lock_guard<std::mutex> frame_guard(shard.mutex);
   if (g_debug->config().options() & BACKTRACE_FULL) {
-    auto backtrace_info_entry = backtraces_info_.find(hash_index);
-    if (backtrace_info_entry != backtraces_info_.end()) {
+    auto backtrace_info_entry = shard.backtraces_info.find(hash_index);
+    if (backtrace_info_entry != shard.backtraces_info.end()) {
       UnwindLog(backtrace_info_entry->second);
       return;
     }
   } else {
-    auto frame_entry = frames_.find(hash_index);
-    if (frame_entry != frames_.end()) {
+    auto frame_entry = shard.frames.find(hash_index);
+    if (frame_entry != shard.frames.end()) {
       FrameInfoType* frame_info = &frame_entry->second;
       backtrace_log(frame_info->frames.data(), frame_info->frames.size());
       return;
@@ -383,40 +433,46 @@ void PointerData::VerifyAllFreed() {
   }
 }
 
+// Must be called with every shard locked.
 void PointerData::GetList(std::vector<ListInfoType>* list, bool only_with_backtrace)
-    REQUIRES(pointer_mutex_, frame_mutex_) {
-  for (const auto& entry : pointers_) {
-    FrameInfoType* frame_info = nullptr;
-    std::vector<unwindstack::FrameData>* backtrace_info = nullptr;
-    size_t hash_index = entry.second.hash_index;
-    if (hash_index > kBacktraceEmptyIndex) {
-      auto frame_entry = frames_.find(hash_index);
-      if (frame_entry == frames_.end()) {
-        // Somehow wound up with a pointer with a valid hash_index, but
-        // no frame data. This should not be possible since adding a pointer
-        // occurs after the hash_index and frame data have been added.
-        // When removing a pointer, the pointer is deleted before the frame
-        // data.
-        error_log("Pointer 0x%" PRIxPTR " hash_index %zu does not exist.", entry.first, hash_index);
-      } else {
-        frame_info = &frame_entry->second;
-      }
-
-      if (g_debug->config().options() & BACKTRACE_FULL) {
-        auto backtrace_entry = backtraces_info_.find(hash_index);
-        if (backtrace_entry == backtraces_info_.end()) {
-          error_log("Pointer 0x%" PRIxPTR " hash_index %zu does not exist.", entry.first, hash_index);
+    NO_THREAD_SAFETY_ANALYSIS {
+  for (size_t i = 0; i < kPointerShardCount; i++) {
+    for (const auto& entry : pointer_shards_[i].pointers) {
+      FrameInfoType* frame_info = nullptr;
+      std::vector<unwindstack::FrameData>* backtrace_info = nullptr;
+      size_t hash_index = entry.second.hash_index;
+      if (hash_index > kBacktraceEmptyIndex) {
+        FrameShard& frame_shard = ShardForHashIndex(hash_index);
+        auto frame_entry = frame_shard.frames.find(hash_index);
+        if (frame_entry == frame_shard.frames.end()) {
+          // Somehow wound up with a pointer with a valid hash_index, but
+          // no frame data. This should not be possible since adding a pointer
+          // occurs after the hash_index and frame data have been added.
+          // When removing a pointer, the pointer is deleted before the frame
+          // data.
+          error_log("Pointer 0x%" PRIxPTR " hash_index %zu does not exist.", entry.first,
+                    hash_index);
         } else {
-          backtrace_info = &backtrace_entry->second;
+          frame_info = &frame_entry->second;
+        }
+
+        if (g_debug->config().options() & BACKTRACE_FULL) {
+          auto backtrace_entry = frame_shard.backtraces_info.find(hash_index);
+          if (backtrace_entry == frame_shard.backtraces_info.end()) {
+            error_log("Pointer 0x%" PRIxPTR " hash_index %zu does not exist.", entry.first,
+                      hash_index);
+          } else {
+            backtrace_info = &backtrace_entry->second;
+          }
         }
       }
-    }
-    if (hash_index == 0 && only_with_backtrace) {
-      continue;
-    }
+      if (hash_index == 0 && only_with_backtrace) {
+        continue;
+      }
 
-    list->emplace_back(ListInfoType{entry.first, 1, entry.second.RealSize(),
-                                    entry.second.ZygoteChildAlloc(), frame_info, backtrace_info});
+      list->emplace_back(ListInfoType{entry.first, 1, entry.second.RealSize(),
+                                      entry.second.ZygoteChildAlloc(), frame_info, backtrace_info});
+    }
   }
 
   // Sort by the size of the allocation.
@@ -455,8 +511,9 @@ void PointerData::GetList(std::vector<ListInfoType>* list, bool only_with_backtr
   });
 }
 
+// Must be called with every shard locked.
 void PointerData::GetUniqueList(std::vector<ListInfoType>* list, bool only_with_backtrace)
-    REQUIRES(pointer_mutex_, frame_mutex_) {
+    NO_THREAD_SAFETY_ANALYSIS {
   GetList(list, only_with_backtrace);
 
   // Remove duplicates of size/backtraces.
@@ -479,8 +536,7 @@ void PointerData::GetUniqueList(std::vector<ListInfoType>* list, bool only_with_
 void PointerData::LogLeaks() {
   std::vector<ListInfoType> list;
 
-  std::lock_guard<std::mutex> pointer_guard(pointer_mutex_);
-  std::lock_guard<std::mutex> frame_guard(frame_mutex_);
+  ScopedAllShardsLock all_shards_lock;
   GetList(&list, false);
 
   size_t track_count = 0;
@@ -499,10 +555,9 @@ void PointerData::LogLeaks() {
 }
 
 void PointerData::GetAllocList(std::vector<ListInfoType>* list) {
-  std::lock_guard<std::mutex> pointer_guard(pointer_mutex_);
-  std::lock_guard<std::mutex> frame_guard(frame_mutex_);
+  ScopedAllShardsLock all_shards_lock;
 
-  if (pointers_.empty()) {
+  if (!AnyPointersTracked()) {
     return;
   }
 
@@ -511,10 +566,9 @@ void PointerData::GetAllocList(std::vector<ListInfoType>* list) {
 
 void PointerData::GetInfo(uint8_t** info, size_t* overall_size, size_t* info_size,
                           size_t* total_memory, size_t* backtrace_size) {
-  std::lock_guard<std::mutex> pointer_guard(pointer_mutex_);
-  std::lock_guard<std::mutex> frame_guard(frame_mutex_);
+  ScopedAllShardsLock all_shards_lock;
 
-  if (pointers_.empty()) {
+  if (!AnyPointersTracked()) {
     return;
   }
 
@@ -551,15 +605,15 @@ void PointerData::GetInfo(uint8_t** info, size_t* overall_size, size_t* info_siz
 
 bool PointerData::Exists(const void* ptr) {
   uintptr_t pointer = reinterpret_cast<uintptr_t>(ptr);
-  std::lock_guard<std::mutex> pointer_guard(pointer_mutex_);
-  return pointers_.count(pointer) != 0;
+  PointerShard& shard = ShardForPointer(pointer);
+  std::lock_guard<std::mutex> pointer_guard(shard.mutex);
+  return shard.pointers.count(pointer) != 0;
 }
 
 void PointerData::DumpLiveToFile(int fd) {
   std::vector<ListInfoType> list;
 
-  std::lock_guard<std::mutex> pointer_guard(pointer_mutex_);
-  std::lock_guard<std::mutex> frame_guard(frame_mutex_);
+  ScopedAllShardsLock all_shards_lock;
   GetUniqueList(&list, false);
 
   size_t total_memory = 0;
@@ -617,23 +671,25 @@ void PointerData::DumpLiveToFile(int fd) {
 
 void PointerData::PrepareFork() NO_THREAD_SAFETY_ANALYSIS {
   free_pointer_mutex_.lock();
-  pointer_mutex_.lock();
-  frame_mutex_.lock();
+  LockAll();
 }
 
 void PointerData::PostForkParent() NO_THREAD_SAFETY_ANALYSIS {
-  frame_mutex_.unlock();
-  pointer_mutex_.unlock();
+  UnlockAll();
   free_pointer_mutex_.unlock();
 }
 
 void PointerData::PostForkChild() __attribute__((no_thread_safety_analysis)) {
   // Make sure that any potential mutexes have been released and are back
   // to an initial state.
-  frame_mutex_.try_lock();
-  frame_mutex_.unlock();
-  pointer_mutex_.try_lock();
-  pointer_mutex_.unlock();
+  for (size_t i = 0; i < kFrameShardCount; i++) {
+    frame_shards_[i].mutex.try_lock();
+    frame_shards_[i].mutex.unlock();
+  }
+  for (size_t i = 0; i < kPointerShardCount; i++) {
+    pointer_shards_[i].mutex.try_lock();
+    pointer_shards_[i].mutex.unlock();
+  }
   free_pointer_mutex_.try_lock();
   free_pointer_mutex_.unlock();
 }
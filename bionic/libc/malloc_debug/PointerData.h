@@ -38,6 +38,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include <android-base/thread_annotations.h>
 #include <platform/bionic/macros.h>
 #include <unwindstack/Unwinder.h>
 
@@ -140,9 +141,17 @@ class PointerData : public OptionData {
   static void Add(const void* pointer, size_t size);
   static void Remove(const void* pointer);
 
-  typedef std::unordered_map<uintptr_t, PointerInfoType>::iterator iterator;
-  static iterator begin() { return pointers_.begin(); }
-  static iterator end() { return pointers_.end(); }
+  // Calls fn(pointer, info) for every tracked pointer without taking any
+  // locks. Only safe to use while every other thread is blocked out of the
+  // allocator, such as during malloc_disable.
+  template <typename Fn>
+  static void IterateUnlocked(Fn fn) NO_THREAD_SAFETY_ANALYSIS {
+    for (size_t i = 0; i < kPointerShardCount; i++) {
+      for (const auto& entry : pointer_shards_[i].pointers) {
+        fn(entry.first, entry.second);
+      }
+    }
+  }
 
   static void* AddFreed(const void* pointer);
   static void LogFreeError(const FreePointerInfoType& info, size_t usable_size);
@@ -162,6 +171,47 @@ class PointerData : public OptionData {
   static bool Exists(const void* pointer);
 
  private:
+  // The pointer map is sharded by pointer hash with a mutex per shard so
+  // that threads allocating concurrently do not serialize on a single lock.
+  static constexpr size_t kPointerShardCount = 16;
+
+  struct PointerShard {
+    std::mutex mutex;
+    std::unordered_map<uintptr_t, PointerInfoType> pointers GUARDED_BY(mutex);
+  };
+
+  // Frame data is sharded by backtrace key hash. The owning shard is encoded
+  // in the low bits of every hash_index handed out, so lookups by hash_index
+  // can find the shard again without consulting a global table.
+  static constexpr size_t kFrameShardBits = 4;
+  static constexpr size_t kFrameShardCount = 1 << kFrameShardBits;
+
+  struct FrameShard {
+    std::mutex mutex;
+    std::unordered_map<FrameKeyType, size_t> key_to_index GUARDED_BY(mutex);
+    std::unordered_map<size_t, FrameInfoType> frames GUARDED_BY(mutex);
+    std::unordered_map<size_t, std::vector<unwindstack::FrameData>> backtraces_info
+        GUARDED_BY(mutex);
+    size_t next_index GUARDED_BY(mutex) = 0;
+  };
+
+  // Scoped lock of every shard, for operations that need a consistent view
+  // of the whole table (leak dumps, info collection, fork).
+  class ScopedAllShardsLock {
+   public:
+    ScopedAllShardsLock() { LockAll(); }
+    ~ScopedAllShardsLock() { UnlockAll(); }
+
+   private:
+    BIONIC_DISALLOW_COPY_AND_ASSIGN(ScopedAllShardsLock);
+  };
+
+  static PointerShard& ShardForPointer(uintptr_t pointer);
+  static FrameShard& ShardForHashIndex(size_t hash_index);
+  static void LockAll();
+  static void UnlockAll();
+  static bool AnyPointersTracked();
+
   static std::string GetHashString(uintptr_t* frames, size_t num_frames);
   static void LogBacktrace(size_t hash_index);
 
@@ -175,14 +225,9 @@ class PointerData : public OptionData {
 
   static std::atomic_bool backtrace_dump_;
 
-  static std::mutex pointer_mutex_;
-  static std::unordered_map<uintptr_t, PointerInfoType> pointers_;
+  static PointerShard pointer_shards_[kPointerShardCount];
 
-  static std::mutex frame_mutex_;
-  static std::unordered_map<FrameKeyType, size_t> key_to_index_;
-  static std::unordered_map<size_t, FrameInfoType> frames_;
-  static std::unordered_map<size_t, std::vector<unwindstack::FrameData>> backtraces_info_;
-  static size_t cur_hash_index_;
+  static FrameShard frame_shards_[kFrameShardCount];
 
   static std::mutex free_pointer_mutex_;
   static std::deque<FreePointerInfoType> free_pointers_;
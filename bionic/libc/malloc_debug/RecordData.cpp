@@ -88,12 +88,24 @@ std::string MemalignEntry::GetString() const {
   return android::base::StringPrintf("%d: memalign %p %zu %zu\n", tid_, pointer_, alignment_, size_);
 }
 
+// Number of entries batched per thread before they are published to the
+// shared array in one reservation, so recording does not contend on the
+// shared index for every allocation.
+static constexpr size_t kThreadEntryBufferSize = 128;
+
 struct ThreadData {
   ThreadData(RecordData* record_data, ThreadCompleteEntry* entry)
       : record_data(record_data), entry(entry) {}
   RecordData* record_data;
   ThreadCompleteEntry* entry;
   size_t count = 0;
+
+  // Entries recorded by this thread but not yet published.
+  const RecordEntry* buffer[kThreadEntryBufferSize];
+  size_t buffer_count = 0;
+
+  // Countdown until the next sampled operation; see ShouldRecordAllocation.
+  size_t sample_countdown = 1;
 };
 
 static void ThreadKeyDelete(void* data) {
@@ -105,6 +117,9 @@ static void ThreadKeyDelete(void* data) {
   if (thread_data->count == 4) {
     ScopedDisableDebugCalls disable;
 
+    // Publish any entries the thread still has batched before its
+    // thread_done marker.
+    thread_data->record_data->AddEntriesOnly(thread_data->buffer, thread_data->buffer_count);
     thread_data->record_data->AddEntryOnly(thread_data->entry);
     delete thread_data;
   } else {
@@ -188,6 +203,7 @@ bool RecordData::Initialize(const Config& config) {
 
   num_entries_ = config.record_allocs_num_entries();
   entries_ = new const RecordEntry*[num_entries_];
+  sampling_rate_ = config.record_allocs_sampling();
   cur_index_ = 0;
   dump_ = false;
   dump_file_ = config.record_allocs_file();
@@ -207,14 +223,52 @@ void RecordData::AddEntryOnly(const RecordEntry* entry) {
   }
 }
 
-void RecordData::AddEntry(const RecordEntry* entry) {
-  void* data = pthread_getspecific(key_);
-  if (data == nullptr) {
-    ThreadData* thread_data = new ThreadData(this, new ThreadCompleteEntry());
+void RecordData::AddEntriesOnly(const RecordEntry* const* entries, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  // One reservation for the whole batch instead of contending on the shared
+  // index per entry.
+  unsigned int entry_index = cur_index_.fetch_add(count);
+  for (size_t i = 0; i < count; i++) {
+    if (entry_index + i < num_entries_) {
+      entries_[entry_index + i] = entries[i];
+    }
+  }
+}
+
+ThreadData* RecordData::GetThreadData() {
+  ThreadData* thread_data = reinterpret_cast<ThreadData*>(pthread_getspecific(key_));
+  if (thread_data == nullptr) {
+    thread_data = new ThreadData(this, new ThreadCompleteEntry());
+    thread_data->sample_countdown = sampling_rate_;
     pthread_setspecific(key_, thread_data);
   }
+  return thread_data;
+}
 
-  AddEntryOnly(entry);
+bool RecordData::ShouldRecordAllocation() {
+  if (sampling_rate_ <= 1) {
+    return true;
+  }
+  ThreadData* thread_data = GetThreadData();
+  if (--thread_data->sample_countdown != 0) {
+    return false;
+  }
+  thread_data->sample_countdown = sampling_rate_;
+  return true;
+}
+
+void RecordData::AddEntry(const RecordEntry* entry) {
+  ThreadData* thread_data = GetThreadData();
+
+  // Batch entries per thread and publish them to the shared array in bulk,
+  // so recording does not serialize threads on every allocation.
+  thread_data->buffer[thread_data->buffer_count++] = entry;
+  if (thread_data->buffer_count == kThreadEntryBufferSize || dump_) {
+    AddEntriesOnly(thread_data->buffer, thread_data->buffer_count);
+    thread_data->buffer_count = 0;
+  }
 
   // Check to see if it's time to dump the entries.
   if (dump_) {
@@ -144,6 +144,7 @@ class MemalignEntry : public MallocEntry {
 };
 
 class Config;
+struct ThreadData;
 
 class RecordData {
  public:
@@ -152,20 +153,28 @@ class RecordData {
 
   bool Initialize(const Config& config);
 
+  // Returns true if this operation should be recorded, applying the
+  // record_allocs_sampling rate (1 == record everything). Call before
+  // constructing an entry so unsampled operations skip the allocation too.
+  bool ShouldRecordAllocation();
+
   void AddEntry(const RecordEntry* entry);
   void AddEntryOnly(const RecordEntry* entry);
+  void AddEntriesOnly(const RecordEntry* const* entries, size_t count);
 
   void SetToDump() { dump_ = true; }
 
   pthread_key_t key() { return key_; }
 
  private:
+  ThreadData* GetThreadData();
   void Dump();
 
   std::mutex dump_lock_;
   pthread_key_t key_;
   const RecordEntry** entries_ = nullptr;
   size_t num_entries_ = 0;
+  size_t sampling_rate_ = 1;
   std::atomic_uint cur_index_;
   std::atomic_bool dump_;
   std::string dump_file_;
@@ -476,7 +476,8 @@ void* debug_malloc(size_t size) {
 
   void* pointer = InternalMalloc(size);
 
-  if (g_debug->config().options() & RECORD_ALLOCS) {
+  if ((g_debug->config().options() & RECORD_ALLOCS) &&
+      g_debug->record->ShouldRecordAllocation()) {
     g_debug->record->AddEntry(new MallocEntry(pointer, size));
   }
 
@@ -551,7 +552,8 @@ void debug_free(void* pointer) {
   ScopedDisableDebugCalls disable;
   ScopedBacktraceSignalBlocker blocked;
 
-  if (g_debug->config().options() & RECORD_ALLOCS) {
+  if ((g_debug->config().options() & RECORD_ALLOCS) &&
+      g_debug->record->ShouldRecordAllocation()) {
     g_debug->record->AddEntry(new FreeEntry(pointer));
   }
 
@@ -634,7 +636,8 @@ void* debug_memalign(size_t alignment, size_t bytes) {
       memset(pointer, g_debug->config().fill_alloc_value(), bytes);
     }
 
-    if (g_debug->config().options() & RECORD_ALLOCS) {
+    if ((g_debug->config().options() & RECORD_ALLOCS) &&
+        g_debug->record->ShouldRecordAllocation()) {
       g_debug->record->AddEntry(new MemalignEntry(pointer, bytes, alignment));
     }
   }
@@ -652,7 +655,8 @@ void* debug_realloc(void* pointer, size_t bytes) {
 
   if (pointer == nullptr) {
     pointer = InternalMalloc(bytes);
-    if (g_debug->config().options() & RECORD_ALLOCS) {
+    if ((g_debug->config().options() & RECORD_ALLOCS) &&
+        g_debug->record->ShouldRecordAllocation()) {
       g_debug->record->AddEntry(new ReallocEntry(pointer, bytes, nullptr));
     }
     return pointer;
@@ -663,7 +667,8 @@ void* debug_realloc(void* pointer, size_t bytes) {
   }
 
   if (bytes == 0) {
-    if (g_debug->config().options() & RECORD_ALLOCS) {
+    if ((g_debug->config().options() & RECORD_ALLOCS) &&
+        g_debug->record->ShouldRecordAllocation()) {
       g_debug->record->AddEntry(new ReallocEntry(nullptr, bytes, pointer));
     }
 
@@ -755,7 +760,8 @@ void* debug_realloc(void* pointer, size_t bytes) {
     }
   }
 
-  if (g_debug->config().options() & RECORD_ALLOCS) {
+  if ((g_debug->config().options() & RECORD_ALLOCS) &&
+      g_debug->record->ShouldRecordAllocation()) {
     g_debug->record->AddEntry(new ReallocEntry(new_pointer, bytes, pointer));
   }
 
@@ -807,7 +813,8 @@ void* debug_calloc(size_t nmemb, size_t bytes) {
     pointer = g_dispatch->calloc(1, real_size);
   }
 
-  if (g_debug->config().options() & RECORD_ALLOCS) {
+  if ((g_debug->config().options() & RECORD_ALLOCS) &&
+      g_debug->record->ShouldRecordAllocation()) {
     g_debug->record->AddEntry(new CallocEntry(pointer, bytes, nmemb));
   }
 
@@ -891,9 +898,9 @@ int debug_malloc_iterate(uintptr_t base, size_t size, void (*callback)(uintptr_t
   ScopedConcurrentLock lock;
   if (g_debug->TrackPointers()) {
     // Since malloc is disabled, don't bother acquiring any locks.
-    for (auto it = PointerData::begin(); it != PointerData::end(); ++it) {
-      callback(it->first, InternalMallocUsableSize(reinterpret_cast<void*>(it->first)), arg);
-    }
+    PointerData::IterateUnlocked([&](uintptr_t pointer, const PointerInfoType&) {
+      callback(pointer, InternalMallocUsableSize(reinterpret_cast<void*>(pointer)), arg);
+    });
     return 0;
   }
 
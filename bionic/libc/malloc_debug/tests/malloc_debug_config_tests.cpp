@@ -527,6 +527,20 @@ TEST_F(MallocDebugConfigTest, record_allocs_file) {
   ASSERT_STREQ("", getFakeLogPrint().c_str());
 }
 
+TEST_F(MallocDebugConfigTest, record_allocs_sampling) {
+  ASSERT_TRUE(InitConfig("record_allocs=1234 record_allocs_sampling=100")) << getFakeLogPrint();
+  ASSERT_EQ(100U, config->record_allocs_sampling());
+
+  ASSERT_TRUE(InitConfig("record_allocs=1234")) << getFakeLogPrint();
+  ASSERT_EQ(1U, config->record_allocs_sampling());
+
+  ASSERT_TRUE(InitConfig("record_allocs_sampling")) << getFakeLogPrint();
+  ASSERT_EQ(1U, config->record_allocs_sampling());
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
 TEST_F(MallocDebugConfigTest, guard_min_error) {
   ASSERT_FALSE(InitConfig("guard=0"));
 
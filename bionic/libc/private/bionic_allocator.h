@@ -29,6 +29,7 @@
 #pragma once
 
 #include <errno.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <sys/cdefs.h>
 #include <sys/mman.h>
@@ -41,6 +42,7 @@ const uint32_t kSmallObjectMinSizeLog2 = 4;
 const uint32_t kSmallObjectAllocatorsCount = kSmallObjectMaxSizeLog2 - kSmallObjectMinSizeLog2 + 1;
 
 class BionicSmallObjectAllocator;
+struct bionic_allocator_thread_cache;
 
 // This structure is placed at the beginning of each addressable page
 // and has all information we need to find the corresponding memory allocator.
@@ -85,10 +87,17 @@ class BionicSmallObjectAllocator {
   void* alloc();
   void free(void* ptr);
 
+  // Frees a batch of blocks, deferring page retirement until the whole batch
+  // has been returned, so a burst of frees (such as a thread cache drain)
+  // unmaps surplus pages once instead of per free.
+  void free_batch(void** blocks, size_t count);
+
   size_t get_block_size() const { return block_size_; }
  private:
   void alloc_page();
   void free_page(small_object_page_info* page);
+  small_object_page_info* free_block(void* ptr);
+  void retire_surplus_pages();
   void add_to_page_list(small_object_page_info* page);
   void remove_from_page_list(small_object_page_info* page);
 
@@ -107,6 +116,12 @@ class BionicAllocator {
   void* alloc(size_t size);
   void* memalign(size_t align, size_t size);
 
+  // Opt-in: route small-object alloc/free through per-thread magazines,
+  // refilled and drained from the shared page lists under an internal lock.
+  // Intended for callers that otherwise serialize every allocation on an
+  // external lock. Must not be called before pthread keys are usable.
+  void enable_thread_caches();
+
   // Note that this implementation of realloc never shrinks allocation
   void* realloc(void* ptr, size_t size);
   void free(void* ptr);
@@ -123,6 +138,17 @@ class BionicAllocator {
   BionicSmallObjectAllocator* get_small_object_allocator(uint32_t type);
   void initialize_allocators();
 
+  void* alloc_small_cached(uint16_t log2_size);
+  void free_small_cached(BionicSmallObjectAllocator* allocator, uint32_t type, void* ptr);
+  bionic_allocator_thread_cache* get_thread_cache();
+  static void thread_cache_destructor(void* arg);
+
   BionicSmallObjectAllocator* allocators_;
   uint8_t allocators_buf_[sizeof(BionicSmallObjectAllocator)*kSmallObjectAllocatorsCount];
+
+  bool thread_cache_enabled_ = false;
+  pthread_key_t thread_cache_key_ = 0;
+  // Protects the shared page lists while thread caches are enabled; unused
+  // (and uncontended) otherwise.
+  pthread_mutex_t lock_ = PTHREAD_MUTEX_INITIALIZER;
 };
@@ -252,6 +252,9 @@ struct __suio {
 int __sfvwrite(FILE*, struct __suio*);
 wint_t __fputwc_unlock(wchar_t wc, FILE* fp);
 
+/* OpenBSD declares this in their <stdlib.h>; __sfvwrite needs it for asprintf streams. */
+void* recallocarray(void*, size_t, size_t, size_t);
+
 /* Remove the if (!__sdidinit) __sinit() idiom from untouched upstream stdio code. */
 extern void __sinit(void);  // Not actually implemented.
 #define __sdidinit 1
@@ -43,6 +43,7 @@
 #include <sys/param.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -548,6 +549,261 @@ int __sclose(void* cookie) {
   return android_fdsan_close_with_tag(fp->_file, __get_file_tag(fp));
 }
 
+// Pipes and sockets report a st_blksize of one page, which costs a write
+// syscall every few KiB for write-heavy users. Use a buffer matching the
+// default pipe capacity instead; setvbuf(3) remains the override for callers
+// that want something else. The buffer is still only allocated lazily, on
+// first use of the stream.
+static constexpr size_t kFifoBufferSize = 64 * 1024;
+
+// Internal routine to determine `proper' buffering for a file.
+int __swhatbuf(FILE* fp, size_t* bufsize, int* couldbetty) {
+  struct stat st;
+  if (fp->_file < 0 || fstat(fp->_file, &st) == -1) {
+    *couldbetty = 0;
+    *bufsize = BUFSIZ;
+    return __SNPT;
+  }
+
+  // Could be a tty iff it is a character device.
+  *couldbetty = S_ISCHR(st.st_mode);
+
+  if (S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode)) {
+    *bufsize = kFifoBufferSize;
+    return __SNPT;
+  }
+
+  if (st.st_blksize == 0) {
+    *bufsize = BUFSIZ;
+    return __SNPT;
+  }
+
+  // Optimise fseek() only if it is a regular file. (The test for
+  // __sseek is mainly paranoia.) It is safe to set _blksize
+  // unconditionally; it will only be used if __SOPT is also set.
+  *bufsize = st.st_blksize;
+  fp->_blksize = st.st_blksize;
+  return ((st.st_mode & S_IFMT) == S_IFREG && fp->_seek == __sseek) ? __SOPT : __SNPT;
+}
+
+// Allocate a file buffer, or switch to unbuffered I/O.
+// Per the ANSI C standard, ALL tty devices default to line buffered.
+//
+// As a side effect, we set __SOPT or __SNPT (en/dis-able fseek
+// optimisation) right after the fstat() that finds the buffer size.
+void __smakebuf(FILE* fp) {
+  if (fp->_flags & __SNBF) {
+    fp->_bf._base = fp->_p = fp->_nbuf;
+    fp->_bf._size = 1;
+    return;
+  }
+  size_t size;
+  int couldbetty;
+  int flags = __swhatbuf(fp, &size, &couldbetty);
+  void* p = malloc(size);
+  if (p == nullptr) {
+    fp->_flags |= __SNBF;
+    fp->_bf._base = fp->_p = fp->_nbuf;
+    fp->_bf._size = 1;
+    return;
+  }
+  flags |= __SMBF;
+  fp->_bf._base = fp->_p = reinterpret_cast<unsigned char*>(p);
+  fp->_bf._size = size;
+  if (couldbetty && isatty(fp->_file)) flags |= __SLBF;
+  fp->_flags |= flags;
+}
+
+// Flushes the FILE's buffer and writes `len` bytes at `p` behind it using
+// single writev(2) calls, rather than copying through the buffer and paying
+// a syscall per buffer-full. Only valid for streams backed by __swrite
+// (real file descriptors). Returns false on write error.
+static bool __swritev_flush(FILE* fp, const char* p, size_t len) {
+  unsigned char* base = fp->_bf._base;
+  size_t buffered = fp->_p - base;
+
+  // Reset the buffer immediately, as __sflush does, to avoid problems
+  // with longjmp.
+  fp->_p = base;
+  fp->_w = (fp->_flags & (__SLBF|__SNBF)) ? 0 : fp->_bf._size;
+
+  size_t written_tail = 0;
+  while (buffered > 0 || written_tail < len) {
+    iovec iov[2];
+    int iovcnt = 0;
+    if (buffered > 0) {
+      iov[iovcnt++] = {.iov_base = base, .iov_len = buffered};
+    }
+    if (written_tail < len) {
+      iov[iovcnt++] = {.iov_base = const_cast<char*>(p + written_tail),
+                       .iov_len = len - written_tail};
+    }
+    ssize_t written = TEMP_FAILURE_RETRY(writev(fp->_file, iov, iovcnt));
+    if (written <= 0) {
+      fp->_flags |= __SERR;
+      return false;
+    }
+    size_t from_buffer = MIN(static_cast<size_t>(written), buffered);
+    base += from_buffer;
+    buffered -= from_buffer;
+    written_tail += written - from_buffer;
+  }
+  return true;
+}
+
+// Write some memory regions. Return zero on success, EOF on error.
+//
+// This routine is large and unsightly, but most of the ugliness due
+// to the three different kinds of output buffering is handled here.
+int __sfvwrite(FILE* fp, struct __suio* uio) {
+  if (uio->uio_resid == 0) return 0;
+
+  // Make sure we can write.
+  if (cantwrite(fp)) {
+    errno = EBADF;
+    return EOF;
+  }
+
+  struct __siov* iov = uio->uio_iov;
+  char* p = static_cast<char*>(iov->iov_base);
+  size_t len = iov->iov_len;
+  iov++;
+  ssize_t w;
+#define COPY(n) memcpy(fp->_p, p, n)
+#define GETIOV(extra_work)                 \
+  while (len == 0) {                       \
+    extra_work;                            \
+    p = static_cast<char*>(iov->iov_base); \
+    len = iov->iov_len;                    \
+    iov++;                                 \
+  }
+  // writev(2) lets us submit the buffer and the caller's data in one
+  // syscall, but only for streams that write to a file descriptor.
+  bool can_writev = (fp->_write == __swrite);
+  if (fp->_flags & __SNBF) {
+    // Unbuffered: write up to BUFSIZ bytes at a time.
+    do {
+      GETIOV(;);
+      w = (*fp->_write)(fp->_cookie, p, MIN(len, static_cast<size_t>(BUFSIZ)));
+      if (w <= 0) goto err;
+      p += w;
+      len -= w;
+    } while ((uio->uio_resid -= w) != 0);
+  } else if ((fp->_flags & __SLBF) == 0) {
+    // Fully buffered: fill partially full buffer, if any, and then flush.
+    // If there is no partial buffer, write one _bf._size byte chunk
+    // directly (without copying).
+    //
+    // String output is a special case: write as many bytes as fit, but
+    // pretend we wrote everything. This makes snprintf() return the
+    // number of bytes needed, rather than the number used, and avoids
+    // its write function (so that the write function can be invalid).
+    do {
+      GETIOV(;);
+      if ((fp->_flags & (__SALC | __SSTR)) == (__SALC | __SSTR) &&
+          static_cast<size_t>(fp->_w) < len) {
+        size_t blen = fp->_p - fp->_bf._base;
+        int pgmsk = getpagesize() - 1;
+
+        // Round up to nearest page.
+        int new_size = ((blen + len + 1 + pgmsk) & ~pgmsk) - 1;
+        unsigned char* new_base = static_cast<unsigned char*>(
+            recallocarray(fp->_bf._base, fp->_bf._size + 1, new_size + 1, 1));
+        if (new_base == nullptr) goto err;
+        fp->_w += new_size - fp->_bf._size;
+        fp->_bf._base = new_base;
+        fp->_bf._size = new_size;
+        fp->_p = new_base + blen;
+      }
+      w = fp->_w;
+      if (fp->_flags & __SSTR) {
+        if (len < static_cast<size_t>(w)) w = len;
+        COPY(w);  // Copy MIN(fp->_w, len)...
+        fp->_w -= w;
+        fp->_p += w;
+        w = len;  // ...but pretend we copied all.
+      } else if (fp->_p > fp->_bf._base && len > static_cast<size_t>(w)) {
+        if (can_writev) {
+          // Submit the buffered bytes and the caller's whole chunk in one
+          // writev(2) instead of copying through the buffer a piece at a
+          // time and writing a buffer-full per syscall.
+          if (!__swritev_flush(fp, p, len)) goto err;
+          w = len;
+        } else {
+          // Fill and flush.
+          COPY(w);
+          // fp->_w -= w; // Unneeded, the flush resets it.
+          fp->_p += w;
+          if (__sflush(fp)) goto err;
+        }
+      } else if (len >= static_cast<size_t>(w = fp->_bf._size)) {
+        // Write directly.
+        w = (*fp->_write)(fp->_cookie, p, w);
+        if (w <= 0) goto err;
+      } else {
+        // Fill and done.
+        w = len;
+        COPY(w);
+        fp->_w -= w;
+        fp->_p += w;
+      }
+      p += w;
+      len -= w;
+    } while ((uio->uio_resid -= w) != 0);
+  } else {
+    // Line buffered: like fully buffered, but we must check for newlines.
+    // Compute the distance to the first newline (including the newline),
+    // or `infinity' if there is none, then pretend that the amount to
+    // write is MIN(len, nldist).
+    int nlknown = 0;
+    size_t nldist = 0;
+    do {
+      GETIOV(nlknown = 0);
+      if (!nlknown) {
+        char* nl = static_cast<char*>(memchr(p, '\n', len));
+        nldist = nl ? static_cast<size_t>(nl + 1 - p) : len + 1;
+        nlknown = 1;
+      }
+      size_t s = MIN(len, nldist);
+      w = fp->_w + fp->_bf._size;
+      if (fp->_p > fp->_bf._base && s > static_cast<size_t>(w)) {
+        if (can_writev) {
+          // One writev(2) submits the buffer and the line tail together.
+          if (!__swritev_flush(fp, p, s)) goto err;
+          w = s;
+        } else {
+          COPY(w);
+          // fp->_w -= w; // Unneeded, the flush resets it.
+          fp->_p += w;
+          if (__sflush(fp)) goto err;
+        }
+      } else if (s >= static_cast<size_t>(w = fp->_bf._size)) {
+        w = (*fp->_write)(fp->_cookie, p, w);
+        if (w <= 0) goto err;
+      } else {
+        w = s;
+        COPY(w);
+        fp->_w -= w;
+        fp->_p += w;
+      }
+      if ((nldist -= w) == 0) {
+        // Copied the newline: flush and forget.
+        if (__sflush(fp)) goto err;
+        nlknown = 0;
+      }
+      p += w;
+      len -= w;
+    } while ((uio->uio_resid -= w) != 0);
+  }
+  return 0;
+
+err:
+  fp->_flags |= __SERR;
+  return EOF;
+#undef COPY
+#undef GETIOV
+}
+
 static off64_t __seek_unlocked(FILE* fp, off64_t offset, int whence) {
   // Use `_seek64` if set, but fall back to `_seek`.
   if (_EXT(fp)->_seek64 != nullptr) {
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "system_properties/contexts_premerged.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <new>
+
+#include <async_safe/log.h>
+
+#include "system_properties/system_properties.h"
+
+static constexpr const char* kDefaultPropertyInfoFile = "/dev/__properties__/property_info";
+
+static int format_image_filename(char* filename, size_t size, const char* dirname) {
+  int len = async_safe_format_buffer(filename, size, "%s/properties_premerged", dirname);
+  if (len < 0 || static_cast<size_t>(len) >= size) {
+    return -1;
+  }
+  return len;
+}
+
+bool ContextsPreMerged::ImageAvailable(const char* dirname) {
+  char filename[PROP_FILENAME_MAX];
+  if (format_image_filename(filename, sizeof(filename), dirname) < 0) {
+    return false;
+  }
+  return access(filename, R_OK) == 0;
+}
+
+bool ContextsPreMerged::WriteImage(const char* dirname) {
+  int info_fd = open(kDefaultPropertyInfoFile, O_CLOEXEC | O_RDONLY);
+  if (info_fd == -1) {
+    return false;
+  }
+
+  struct stat info_stat;
+  if (fstat(info_fd, &info_stat) != 0 || info_stat.st_size == 0 ||
+      static_cast<uint64_t>(info_stat.st_size) > UINT32_MAX - sizeof(ImageHeader)) {
+    close(info_fd);
+    return false;
+  }
+  const uint32_t info_size = info_stat.st_size;
+
+  ImageHeader header = {
+      .magic = kImageMagic,
+      .version = kImageVersion,
+      .file_size = static_cast<uint32_t>(sizeof(ImageHeader) + info_size),
+      .property_info_offset = sizeof(ImageHeader),
+      .property_info_size = info_size,
+  };
+
+  char filename[PROP_FILENAME_MAX];
+  if (format_image_filename(filename, sizeof(filename), dirname) < 0) {
+    close(info_fd);
+    return false;
+  }
+
+  // Like property_info, the image is immutable once published: build it
+  // under a temporary name and rename it into place so readers never see a
+  // partial file.
+  char tmp_filename[PROP_FILENAME_MAX];
+  int len = async_safe_format_buffer(tmp_filename, sizeof(tmp_filename), "%s.tmp", filename);
+  if (len < 0 || len >= PROP_FILENAME_MAX) {
+    close(info_fd);
+    return false;
+  }
+
+  int fd = open(tmp_filename, O_CLOEXEC | O_CREAT | O_TRUNC | O_WRONLY | O_EXCL, 0444);
+  if (fd == -1) {
+    close(info_fd);
+    return false;
+  }
+
+  bool ok = TEMP_FAILURE_RETRY(write(fd, &header, sizeof(header))) ==
+            static_cast<ssize_t>(sizeof(header));
+  char buf[4096];
+  while (ok) {
+    ssize_t bytes_read = TEMP_FAILURE_RETRY(read(info_fd, buf, sizeof(buf)));
+    if (bytes_read == 0) {
+      break;
+    }
+    ok = bytes_read > 0 && TEMP_FAILURE_RETRY(write(fd, buf, bytes_read)) == bytes_read;
+  }
+  close(info_fd);
+  close(fd);
+
+  if (!ok || rename(tmp_filename, filename) != 0) {
+    unlink(tmp_filename);
+    return false;
+  }
+  return true;
+}
+
+bool ContextsPreMerged::InitializeContextNodes() {
+  auto num_context_nodes = property_info_area_->num_contexts();
+  auto context_nodes_mmap_size = sizeof(ContextNode) * num_context_nodes;
+  // We want to avoid malloc in system properties, so we take an anonymous map instead (b/31659220).
+  void* const map_result = mmap(nullptr, context_nodes_mmap_size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map_result == MAP_FAILED) {
+    return false;
+  }
+
+  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, map_result, context_nodes_mmap_size,
+        "System property context nodes");
+
+  context_nodes_ = reinterpret_cast<ContextNode*>(map_result);
+  num_context_nodes_ = num_context_nodes;
+  context_nodes_mmap_size_ = context_nodes_mmap_size;
+
+  for (size_t i = 0; i < num_context_nodes; ++i) {
+    new (&context_nodes_[i]) ContextNode(property_info_area_->context(i), filename_);
+  }
+
+  return true;
+}
+
+bool ContextsPreMerged::MapSerialPropertyArea(bool access_rw, bool* fsetxattr_failed) {
+  char filename[PROP_FILENAME_MAX];
+  int len = async_safe_format_buffer(filename, sizeof(filename), "%s/properties_serial", filename_);
+  if (len < 0 || len >= PROP_FILENAME_MAX) {
+    serial_prop_area_ = nullptr;
+    return false;
+  }
+
+  if (access_rw) {
+    serial_prop_area_ =
+        prop_area::map_prop_area_rw(filename, "u:object_r:properties_serial:s0", fsetxattr_failed);
+  } else {
+    serial_prop_area_ = prop_area::map_prop_area(filename);
+  }
+  return serial_prop_area_;
+}
+
+bool ContextsPreMerged::Initialize(bool writable, const char* filename, bool* fsetxattr_failed) {
+  // init sets the property areas up through ContextsSerialized and only then
+  // publishes the image; this backend is read-only by design.
+  if (writable) {
+    return false;
+  }
+  filename_ = filename;
+
+  char image_filename[PROP_FILENAME_MAX];
+  if (format_image_filename(image_filename, sizeof(image_filename), filename) < 0) {
+    return false;
+  }
+
+  int fd = open(image_filename, O_CLOEXEC | O_NOFOLLOW | O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+
+  struct stat fd_stat;
+  if (fstat(fd, &fd_stat) != 0 || static_cast<size_t>(fd_stat.st_size) < sizeof(ImageHeader)) {
+    close(fd);
+    return false;
+  }
+
+  void* map_result = mmap(nullptr, fd_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map_result == MAP_FAILED) {
+    return false;
+  }
+
+  const ImageHeader* header = static_cast<const ImageHeader*>(map_result);
+  if (header->magic != kImageMagic ||
+      header->version != kImageVersion ||
+      header->file_size != fd_stat.st_size ||
+      header->property_info_offset != sizeof(ImageHeader) ||
+      header->property_info_size != header->file_size - sizeof(ImageHeader)) {
+    munmap(map_result, fd_stat.st_size);
+    return false;
+  }
+
+  image_ = map_result;
+  image_size_ = fd_stat.st_size;
+  property_info_area_ = reinterpret_cast<const android::properties::PropertyInfoArea*>(
+      static_cast<const char*>(map_result) + header->property_info_offset);
+
+  if (!InitializeContextNodes() || !MapSerialPropertyArea(false, nullptr)) {
+    FreeAndUnmap();
+    return false;
+  }
+  return true;
+}
+
+prop_area* ContextsPreMerged::GetPropAreaForName(const char* name) {
+  uint32_t index;
+  property_info_area_->GetPropertyInfoIndexes(name, &index, nullptr);
+  if (index == ~0u || index >= num_context_nodes_) {
+    async_safe_format_log(ANDROID_LOG_ERROR, "libc", "Could not find context for property \"%s\"",
+                          name);
+    return nullptr;
+  }
+  auto* context_node = &context_nodes_[index];
+  if (!context_node->pa()) {
+    // We explicitly do not check no_access_ in this case because unlike the
+    // case of foreach(), we want to generate an selinux audit for each
+    // non-permitted property access in this function.
+    context_node->Open(false, nullptr);
+  }
+  return context_node->pa();
+}
+
+void ContextsPreMerged::ForEach(void (*propfn)(const prop_info* pi, void* cookie), void* cookie) {
+  for (size_t i = 0; i < num_context_nodes_; ++i) {
+    if (context_nodes_[i].CheckAccessAndOpen()) {
+      context_nodes_[i].pa()->foreach (propfn, cookie);
+    }
+  }
+}
+
+void ContextsPreMerged::ResetAccess() {
+  for (size_t i = 0; i < num_context_nodes_; ++i) {
+    context_nodes_[i].ResetAccess();
+  }
+}
+
+void ContextsPreMerged::FreeAndUnmap() {
+  if (context_nodes_ != nullptr) {
+    for (size_t i = 0; i < num_context_nodes_; ++i) {
+      context_nodes_[i].Unmap();
+    }
+    munmap(context_nodes_, context_nodes_mmap_size_);
+    context_nodes_ = nullptr;
+  }
+  if (image_ != nullptr) {
+    munmap(image_, image_size_);
+    image_ = nullptr;
+    image_size_ = 0;
+    property_info_area_ = nullptr;
+  }
+  prop_area::unmap_prop_area(&serial_prop_area_);
+  serial_prop_area_ = nullptr;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <property_info_parser/property_info_parser.h>
+
+#include "context_node.h"
+#include "contexts.h"
+
+// A read-only backend over a single image that init generates at boot from
+// the property_info trie. Mapping the one pre-merged image replaces the
+// property_info open/fstat/mmap sequence that every process otherwise
+// performs in __system_properties_init. The per-context property areas are
+// still separate files opened on first use: they are live (written by init
+// for the life of the system) and carry per-context SELinux labels, so they
+// cannot be folded into a boot-time snapshot.
+class ContextsPreMerged : public Contexts {
+ public:
+  virtual ~ContextsPreMerged() override {
+  }
+
+  virtual bool Initialize(bool writable, const char* filename, bool* fsetxattr_failed) override;
+  virtual prop_area* GetPropAreaForName(const char* name) override;
+  virtual prop_area* GetSerialPropArea() override {
+    return serial_prop_area_;
+  }
+  virtual void ForEach(void (*propfn)(const prop_info* pi, void* cookie), void* cookie) override;
+  virtual void ResetAccess() override;
+  virtual void FreeAndUnmap() override;
+
+  // Returns true if `dirname` contains a readable pre-merged image.
+  static bool ImageAvailable(const char* dirname);
+  // Generates the pre-merged image in `dirname` from the default
+  // property_info file. Called by init once the property areas have been
+  // set up; best effort, readers fall back to ContextsSerialized when the
+  // image is absent.
+  static bool WriteImage(const char* dirname);
+
+ private:
+  struct ImageHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t file_size;
+    uint32_t property_info_offset;
+    uint32_t property_info_size;
+  };
+
+  static constexpr uint32_t kImageMagic = 0x504d5050;  // "PPMP"
+  static constexpr uint32_t kImageVersion = 1;
+  static constexpr const char* kImageName = "properties_premerged";
+
+  bool InitializeContextNodes();
+  bool MapSerialPropertyArea(bool access_rw, bool* fsetxattr_failed);
+
+  const char* filename_;
+  void* image_ = nullptr;
+  size_t image_size_ = 0;
+  const android::properties::PropertyInfoArea* property_info_area_ = nullptr;
+  ContextNode* context_nodes_ = nullptr;
+  size_t num_context_nodes_ = 0;
+  size_t context_nodes_mmap_size_ = 0;
+  prop_area* serial_prop_area_ = nullptr;
+};
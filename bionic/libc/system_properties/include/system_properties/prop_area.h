@@ -103,6 +103,7 @@ class prop_area {
 
   prop_area(const uint32_t magic, const uint32_t version) : magic_(magic), version_(version) {
     atomic_init(&serial_, 0u);
+    atomic_init(&name_index_offset_, 0u);
     memset(reserved_, 0, sizeof(reserved_));
     // Allocate enough space for the root node.
     bytes_used_ = sizeof(prop_bt);
@@ -155,6 +156,24 @@ class prop_area {
 
   prop_bt* find_prop_bt(prop_bt* const bt, const char* name, uint32_t namelen, bool alloc_if_needed);
 
+  // Open-addressed index over full property names, so find() is O(1)
+  // instead of one trie node per name segment. Entries are prop_info
+  // offsets (0 == empty); the table is power-of-two sized and lives in the
+  // shared area like everything else, published through
+  // name_index_offset_. Only the single-threaded writer (init) modifies
+  // it; readers probe lock-free and fall back to the trie on a miss.
+  struct name_index {
+    uint32_t capacity;
+    uint32_t num_entries;
+    atomic_uint_least32_t entries[0];
+  };
+
+  name_index* get_name_index();
+  const prop_info* find_indexed(const char* name, uint32_t namelen);
+  void index_add(const char* name, uint_least32_t prop_offset);
+  bool index_insert(name_index* index, const char* name, uint_least32_t prop_offset);
+  name_index* create_name_index(uint32_t capacity, uint_least32_t* const off);
+
   const prop_info* find_property(prop_bt* const trie, const char* name, uint32_t namelen,
                                  const char* value, uint32_t valuelen, bool alloc_if_needed);
 
@@ -172,7 +191,12 @@ class prop_area {
   atomic_uint_least32_t serial_;
   uint32_t magic_;
   uint32_t version_;
-  uint32_t reserved_[28];
+  // Offset (from data_) of the name_index, or 0 if the area has none (all
+  // areas written before the index existed). Carved out of the old
+  // reserved_ space, so the header layout is unchanged and either side of
+  // the version can map files written by the other.
+  atomic_uint_least32_t name_index_offset_;
+  uint32_t reserved_[27];
   char data_[0];
 
   BIONIC_DISALLOW_COPY_AND_ASSIGN(prop_area);
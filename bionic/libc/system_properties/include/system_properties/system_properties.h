@@ -34,6 +34,7 @@
 
 #include "contexts.h"
 #include "contexts_pre_split.h"
+#include "contexts_premerged.h"
 #include "contexts_serialized.h"
 #include "contexts_split.h"
 
@@ -76,12 +77,14 @@ class SystemProperties {
   uint32_t ReadMutablePropertyValue(const prop_info* pi, char* value);
 
   // We don't want to use new or malloc in properties (b/31659220), and we don't want to waste a
-  // full page by using mmap(), so we set aside enough space to create any context of the three
-  // contexts.
+  // full page by using mmap(), so we set aside enough space to create any of the context
+  // implementations.
   static constexpr size_t kMaxContextsAlign =
-      MAX(alignof(ContextsSerialized), MAX(alignof(ContextsSplit), alignof(ContextsPreSplit)));
+      MAX(MAX(alignof(ContextsSerialized), alignof(ContextsPreMerged)),
+          MAX(alignof(ContextsSplit), alignof(ContextsPreSplit)));
   static constexpr size_t kMaxContextsSize =
-      MAX(sizeof(ContextsSerialized), MAX(sizeof(ContextsSplit), sizeof(ContextsPreSplit)));
+      MAX(MAX(sizeof(ContextsSerialized), sizeof(ContextsPreMerged)),
+          MAX(sizeof(ContextsSplit), sizeof(ContextsPreSplit)));
   alignas(kMaxContextsAlign) char contexts_data_[kMaxContextsSize];
   Contexts* contexts_;
 
@@ -359,13 +359,133 @@ bool prop_area::foreach_property(prop_bt* const trie,
   return true;
 }
 
+// FNV-1a. Property names are short, so a simple byte-at-a-time hash beats
+// anything with per-call setup cost.
+static uint32_t hash_prop_name(const char* name, uint32_t namelen) {
+  uint32_t hash = 2166136261u;
+  for (uint32_t i = 0; i < namelen; ++i) {
+    hash ^= static_cast<uint8_t>(name[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+prop_area::name_index* prop_area::get_name_index() {
+  uint_least32_t off = atomic_load_explicit(&name_index_offset_, memory_order_consume);
+  if (off == 0) return nullptr;
+  return reinterpret_cast<name_index*>(to_prop_obj(off));
+}
+
+const prop_info* prop_area::find_indexed(const char* name, uint32_t namelen) {
+  name_index* index = get_name_index();
+  if (index == nullptr) return nullptr;
+
+  const uint32_t mask = index->capacity - 1;
+  uint32_t slot = hash_prop_name(name, namelen) & mask;
+  for (uint32_t probes = 0; probes <= mask; ++probes, slot = (slot + 1) & mask) {
+    uint_least32_t off = atomic_load_explicit(&index->entries[slot], memory_order_consume);
+    if (off == 0) {
+      return nullptr;
+    }
+    const prop_info* info = reinterpret_cast<const prop_info*>(to_prop_obj(off));
+    if (info != nullptr && strncmp(info->name, name, namelen) == 0 && info->name[namelen] == '\0') {
+      return info;
+    }
+  }
+  return nullptr;
+}
+
+prop_area::name_index* prop_area::create_name_index(uint32_t capacity, uint_least32_t* const off) {
+  uint_least32_t new_offset;
+  void* const p = allocate_obj(sizeof(name_index) + capacity * sizeof(atomic_uint_least32_t),
+                               &new_offset);
+  if (p == nullptr) return nullptr;
+
+  name_index* index = reinterpret_cast<name_index*>(p);
+  index->capacity = capacity;
+  index->num_entries = 0;
+  for (uint32_t i = 0; i < capacity; ++i) {
+    atomic_init(&index->entries[i], 0u);
+  }
+  *off = new_offset;
+  return index;
+}
+
+bool prop_area::index_insert(name_index* index, const char* name, uint_least32_t prop_offset) {
+  const uint32_t mask = index->capacity - 1;
+  uint32_t slot = hash_prop_name(name, strlen(name)) & mask;
+  while (true) {
+    uint_least32_t off = atomic_load_explicit(&index->entries[slot], memory_order_relaxed);
+    if (off == 0) {
+      // Publish after the prop_info is fully constructed so a concurrent
+      // reader that consumes this offset sees a complete entry.
+      atomic_store_explicit(&index->entries[slot], prop_offset, memory_order_release);
+      ++index->num_entries;
+      return true;
+    }
+    if (off == prop_offset) {
+      return false;
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+void prop_area::index_add(const char* name, uint_least32_t prop_offset) {
+  static constexpr uint32_t kInitialIndexCapacity = 128;
+
+  name_index* index = get_name_index();
+  if (index == nullptr) {
+    uint_least32_t index_offset;
+    index = create_name_index(kInitialIndexCapacity, &index_offset);
+    if (index == nullptr) {
+      // Arena exhausted; readers keep using the trie.
+      return;
+    }
+    atomic_store_explicit(&name_index_offset_, index_offset, memory_order_release);
+  } else if (index->num_entries + 1 > index->capacity - index->capacity / 4) {
+    // Rebuild at double capacity to keep probe sequences short. The old
+    // table is unreachable after the release store below but stays
+    // allocated: the area is a bump allocator and never frees. Geometric
+    // growth bounds the total waste to the size of the final table.
+    uint_least32_t new_index_offset;
+    name_index* new_index = create_name_index(index->capacity * 2, &new_index_offset);
+    if (new_index == nullptr) {
+      return;
+    }
+    for (uint32_t i = 0; i < index->capacity; ++i) {
+      uint_least32_t off = atomic_load_explicit(&index->entries[i], memory_order_relaxed);
+      if (off != 0) {
+        const prop_info* info = reinterpret_cast<const prop_info*>(to_prop_obj(off));
+        index_insert(new_index, info->name, off);
+      }
+    }
+    atomic_store_explicit(&name_index_offset_, new_index_offset, memory_order_release);
+    index = new_index;
+  }
+
+  index_insert(index, name, prop_offset);
+}
+
 const prop_info* prop_area::find(const char* name) {
-  return find_property(root_node(), name, strlen(name), nullptr, 0, false);
+  const uint32_t namelen = strlen(name);
+  const prop_info* info = find_indexed(name, namelen);
+  if (info != nullptr) {
+    return info;
+  }
+  // Index miss: the area may predate the index, the index allocation may
+  // have failed, or the property was added between our probe and now. The
+  // trie is always fully maintained, so it remains the source of truth.
+  return find_property(root_node(), name, namelen, nullptr, 0, false);
 }
 
 bool prop_area::add(const char* name, unsigned int namelen, const char* value,
                     unsigned int valuelen) {
-  return find_property(root_node(), name, namelen, value, valuelen, true);
+  const prop_info* info = find_property(root_node(), name, namelen, value, valuelen, true);
+  if (info == nullptr) {
+    return false;
+  }
+  index_add(name, reinterpret_cast<const char*>(info) - data_);
+  return true;
 }
 
 bool prop_area::foreach (void (*propfn)(const prop_info* pi, void* cookie), void* cookie) {
@@ -73,7 +73,13 @@ bool SystemProperties::Init(const char* filename) {
   strcpy(property_filename_, filename);
 
   if (is_dir(property_filename_)) {
-    if (access("/dev/__properties__/property_info", R_OK) == 0) {
+    if (ContextsPreMerged::ImageAvailable(property_filename_)) {
+      // One mmap covering the context trie; see contexts_premerged.h.
+      contexts_ = new (contexts_data_) ContextsPreMerged();
+      if (!contexts_->Initialize(false, property_filename_, nullptr)) {
+        return false;
+      }
+    } else if (access("/dev/__properties__/property_info", R_OK) == 0) {
       contexts_ = new (contexts_data_) ContextsSerialized();
       if (!contexts_->Initialize(false, property_filename_, nullptr)) {
         return false;
@@ -104,6 +110,11 @@ bool SystemProperties::AreaInit(const char* filename, bool* fsetxattr_failed) {
   if (!contexts_->Initialize(true, property_filename_, fsetxattr_failed)) {
     return false;
   }
+
+  // Publish the pre-merged context image for the read-only fast path in
+  // Init(). Best effort: on failure readers use ContextsSerialized.
+  ContextsPreMerged::WriteImage(property_filename_);
+
   initialized_ = true;
   return true;
 }
@@ -30,13 +30,17 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include "private/CachedProperty.h"
 
 extern "C" void tzset_unlocked(void);
-extern "C" int __bionic_open_tzdata(const char*, int32_t*);
+extern "C" const char* __bionic_get_tzdata(const char*, int32_t*);
 
 extern "C" void tzsetlcl(char const*);
 
@@ -105,106 +109,133 @@ struct index_entry_t {
   int32_t unused; // Was raw GMT offset; always 0 since tzdata2014f (L).
 };
 
+// A tzdata file attached to the process. The mapping is read-only and backed
+// by the file, so every process on the device shares the same physical pages
+// through the page cache: attaching costs one open/mmap pair per process, and
+// after that neither index lookups nor entry loads issue any syscalls.
+struct tzdata_mapping {
+  const char* path;
+  dev_t dev;
+  ino_t ino;
+  const char* base;
+  size_t size;
+};
+
 // Returns -2 for a soft failure (where the caller should try another file),
-// -1 for a hard failure (where the caller should give up), and >= 0 is a
-// file descriptor whose offset points to the data for the given olson id in
-// the given file (and *entry_length is the size of the data).
-static int __bionic_open_tzdata_path(const char* path,
-                                     const char* olson_id,
-                                     int32_t* entry_length) {
-  int fd = TEMP_FAILURE_RETRY(open(path, O_RDONLY | O_CLOEXEC));
-  if (fd == -1) {
-    // We don't log here, because this is quite common --- current devices
-    // aren't expected to have the old APK tzdata, for example.
-    return -2;
+// -1 for a hard failure (where the caller should give up), and 0 on success,
+// with *entry pointing at the data for the given olson id in the mapped file
+// (and *entry_length the size of the data).
+//
+// Callers hold the tz lock, which is what serializes access to the cache.
+static int __bionic_get_tzdata_path(const char* path,
+                                    const char* olson_id,
+                                    int32_t* entry_length,
+                                    const char** entry) {
+  static tzdata_mapping mappings[4] = {};
+
+  // Find (or claim) the cache slot for this path.
+  tzdata_mapping* map = nullptr;
+  for (auto& m : mappings) {
+    if (m.path == nullptr) {
+      m.path = strdup(path);
+      map = &m;
+      break;
+    }
+    if (strcmp(m.path, path) == 0) {
+      map = &m;
+      break;
+    }
   }
+  if (map == nullptr) return -2;
 
-  bionic_tzdata_header_t header = {};
-  ssize_t bytes_read = TEMP_FAILURE_RETRY(read(fd, &header, sizeof(header)));
-  if (bytes_read != sizeof(header)) {
-    fprintf(stderr, "%s: could not read header of \"%s\": %s\n",
-            __FUNCTION__, path, (bytes_read == -1) ? strerror(errno) : "short read");
-    close(fd);
+  struct stat sb;
+  if (stat(path, &sb) == -1) {
+    // We don't log here, because this is quite common --- current devices
+    // aren't expected to have the old APK tzdata, for example.
     return -2;
   }
 
-  if (strncmp(header.tzdata_version, "tzdata", 6) != 0 || header.tzdata_version[11] != 0) {
-    fprintf(stderr, "%s: bad magic in \"%s\": \"%.6s\"\n", __FUNCTION__, path, header.tzdata_version);
+  if (map->base == nullptr || map->dev != sb.st_dev || map->ino != sb.st_ino) {
+    // First use, or a tzdata update replaced the file: (re)attach. Nothing
+    // keeps pointers into the old mapping once tzloadbody has copied its
+    // entry out, so dropping it here is safe.
+    if (map->base != nullptr) {
+      munmap(const_cast<char*>(map->base), map->size);
+      map->base = nullptr;
+    }
+    if (sb.st_size < static_cast<off_t>(sizeof(bionic_tzdata_header_t))) {
+      fprintf(stderr, "%s: \"%s\" is too small to be tzdata\n", __FUNCTION__, path);
+      return -2;
+    }
+    int fd = TEMP_FAILURE_RETRY(open(path, O_RDONLY | O_CLOEXEC));
+    if (fd == -1) {
+      return -2;
+    }
+    void* base = mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
     close(fd);
-    return -2;
+    if (base == MAP_FAILED) {
+      fprintf(stderr, "%s: could not map \"%s\": %s\n", __FUNCTION__, path, strerror(errno));
+      return -2;
+    }
+    map->base = static_cast<const char*>(base);
+    map->size = sb.st_size;
+    map->dev = sb.st_dev;
+    map->ino = sb.st_ino;
   }
 
-  if (TEMP_FAILURE_RETRY(lseek(fd, ntohl(header.index_offset), SEEK_SET)) == -1) {
-    fprintf(stderr, "%s: couldn't seek to index in \"%s\": %s\n", __FUNCTION__, path, strerror(errno));
-    close(fd);
+  const bionic_tzdata_header_t* header =
+      reinterpret_cast<const bionic_tzdata_header_t*>(map->base);
+  if (strncmp(header->tzdata_version, "tzdata", 6) != 0 || header->tzdata_version[11] != 0) {
+    fprintf(stderr, "%s: bad magic in \"%s\": \"%.6s\"\n", __FUNCTION__, path,
+            header->tzdata_version);
     return -2;
   }
 
-  if (ntohl(header.index_offset) > ntohl(header.data_offset)) {
-    fprintf(stderr, "%s: invalid data and index offsets in \"%s\": %u %u\n",
-            __FUNCTION__, path, ntohl(header.data_offset), ntohl(header.index_offset));
-    close(fd);
+  const size_t index_offset = ntohl(header->index_offset);
+  const size_t data_offset = ntohl(header->data_offset);
+  if (index_offset > data_offset || data_offset > map->size) {
+    fprintf(stderr, "%s: invalid data and index offsets in \"%s\": %zu %zu\n",
+            __FUNCTION__, path, data_offset, index_offset);
     return -2;
   }
-  const size_t index_size = ntohl(header.data_offset) - ntohl(header.index_offset);
+  const size_t index_size = data_offset - index_offset;
   if ((index_size % sizeof(index_entry_t)) != 0) {
     fprintf(stderr, "%s: invalid index size in \"%s\": %zd\n", __FUNCTION__, path, index_size);
-    close(fd);
-    return -2;
-  }
-
-  char* index = reinterpret_cast<char*>(malloc(index_size));
-  if (index == nullptr) {
-    fprintf(stderr, "%s: couldn't allocate %zd-byte index for \"%s\"\n", __FUNCTION__, index_size, path);
-    close(fd);
-    return -2;
-  }
-  if (TEMP_FAILURE_RETRY(read(fd, index, index_size)) != static_cast<ssize_t>(index_size)) {
-    fprintf(stderr, "%s: could not read index of \"%s\": %s\n",
-            __FUNCTION__, path, (bytes_read == -1) ? strerror(errno) : "short read");
-    free(index);
-    close(fd);
     return -2;
   }
 
-  off_t specific_zone_offset = -1;
   size_t id_count = index_size / sizeof(index_entry_t);
-  index_entry_t* entry = reinterpret_cast<index_entry_t*>(index);
+  const index_entry_t* index_entry = reinterpret_cast<const index_entry_t*>(map->base + index_offset);
   for (size_t i = 0; i < id_count; ++i) {
     char this_id[NAME_LENGTH + 1];
-    memcpy(this_id, entry->buf, NAME_LENGTH);
+    memcpy(this_id, index_entry->buf, NAME_LENGTH);
     this_id[NAME_LENGTH] = '\0';
 
     if (strcmp(this_id, olson_id) == 0) {
-      specific_zone_offset = ntohl(entry->start) + ntohl(header.data_offset);
-      *entry_length = ntohl(entry->length);
-      break;
+      const size_t start = ntohl(index_entry->start) + data_offset;
+      const size_t length = ntohl(index_entry->length);
+      if (start > map->size || length > map->size - start) {
+        fprintf(stderr, "%s: invalid index entry for %s in \"%s\"\n",
+                __FUNCTION__, olson_id, path);
+        return -2;
+      }
+      *entry = map->base + start;
+      *entry_length = length;
+      return 0;
     }
 
-    ++entry;
-  }
-  free(index);
-
-  if (specific_zone_offset == -1) {
-    // We found a valid tzdata file, but didn't find the requested id in it.
-    // Give up now, and don't try fallback tzdata files. We don't log here
-    // because for all we know the given olson id was nonsense.
-    close(fd);
-    return -1;
-  }
-
-  if (TEMP_FAILURE_RETRY(lseek(fd, specific_zone_offset, SEEK_SET)) == -1) {
-    fprintf(stderr, "%s: could not seek to %ld in \"%s\": %s\n",
-            __FUNCTION__, specific_zone_offset, path, strerror(errno));
-    close(fd);
-    return -2;
+    ++index_entry;
   }
 
-  return fd;
+  // We found a valid tzdata file, but didn't find the requested id in it.
+  // Give up now, and don't try fallback tzdata files. We don't log here
+  // because for all we know the given olson id was nonsense.
+  return -1;
 }
 
-int __bionic_open_tzdata(const char* olson_id, int32_t* entry_length) {
-  int fd;
+const char* __bionic_get_tzdata(const char* olson_id, int32_t* entry_length) {
+  int status;
+  const char* entry = nullptr;
 
   // Try the three locations for the tzdata file in a strict order:
   // 1: The O-MR1 time zone updates via APK update mechanism. This is
@@ -220,17 +251,17 @@ int __bionic_open_tzdata(const char* olson_id, int32_t* entry_length) {
   // On Android devices, bionic has to work even if exec takes place without
   // environment variables set. So, all paths are hardcoded here.
 
-  fd = __bionic_open_tzdata_path("/data/misc/zoneinfo/current/tzdata",
-                                 olson_id, entry_length);
-  if (fd >= -1) return fd;
+  status = __bionic_get_tzdata_path("/data/misc/zoneinfo/current/tzdata",
+                                    olson_id, entry_length, &entry);
+  if (status >= -1) goto done;
 
-  fd = __bionic_open_tzdata_path("/apex/com.android.tzdata/etc/tz/tzdata",
-                                 olson_id, entry_length);
-  if (fd >= -1) return fd;
+  status = __bionic_get_tzdata_path("/apex/com.android.tzdata/etc/tz/tzdata",
+                                    olson_id, entry_length, &entry);
+  if (status >= -1) goto done;
 
-  fd = __bionic_open_tzdata_path("/system/usr/share/zoneinfo/tzdata",
-                                 olson_id, entry_length);
-  if (fd >= -1) return fd;
+  status = __bionic_get_tzdata_path("/system/usr/share/zoneinfo/tzdata",
+                                    olson_id, entry_length, &entry);
+  if (status >= -1) goto done;
 #else
   // On the host, we don't expect the hard-coded locations above to exist, and
   // we're not worried about security so we trust $ANDROID_DATA,
@@ -238,29 +269,30 @@ int __bionic_open_tzdata(const char* olson_id, int32_t* entry_length) {
   // instead.
 
   char* path = make_path("ANDROID_DATA", "/misc/zoneinfo/current/tzdata");
-  fd = __bionic_open_tzdata_path(path, olson_id, entry_length);
+  status = __bionic_get_tzdata_path(path, olson_id, entry_length, &entry);
   free(path);
-  if (fd >= -1) return fd;
+  if (status >= -1) goto done;
 
   path = make_path("ANDROID_TZDATA_ROOT", "/etc/tz/tzdata");
-  fd = __bionic_open_tzdata_path(path, olson_id, entry_length);
+  status = __bionic_get_tzdata_path(path, olson_id, entry_length, &entry);
   free(path);
-  if (fd >= -1) return fd;
+  if (status >= -1) goto done;
 
   path = make_path("ANDROID_ROOT", "/usr/share/zoneinfo/tzdata");
-  fd = __bionic_open_tzdata_path(path, olson_id, entry_length);
+  status = __bionic_get_tzdata_path(path, olson_id, entry_length, &entry);
   free(path);
-  if (fd >= -1) return fd;
+  if (status >= -1) goto done;
 #endif
 
   // Not finding any tzdata is more serious that not finding a specific zone,
   // and worth logging.
-  if (fd == -2) {
+  if (status == -2) {
     // The first thing that 'recovery' does is try to format the current time. It doesn't have
     // any tzdata available, so we must not abort here --- doing so breaks the recovery image!
     fprintf(stderr, "%s: couldn't find any tzdata when looking for %s!\n", __FUNCTION__, olson_id);
   }
 
-  // Otherwise we were successful.
-  return fd;
+done:
+  if (entry == nullptr) errno = ENOENT;
+  return entry;
 }
@@ -377,7 +377,9 @@ tzloadbody(char const *name, struct state *sp, bool doextend,
 	   union local_storage *lsp)
 {
 	register int			i;
+#if !defined(__BIONIC__)
 	register int			fid;
+#endif
 	register int			stored;
 	register ssize_t		nread;
 #if !defined(__BIONIC__)
@@ -396,9 +398,20 @@ tzloadbody(char const *name, struct state *sp, bool doextend,
 	}
 
 #if defined(__BIONIC__)
-	extern int __bionic_open_tzdata(const char*, int32_t*);
+	/* The tzdata file stays mapped read-only for the life of the process
+	   (shared with every other process through the page cache), so loading
+	   a zone is a copy out of the mapping with no file I/O at all.  */
+	extern const char* __bionic_get_tzdata(const char*, int32_t*);
 	int32_t entry_length;
-	fid = __bionic_open_tzdata(name, &entry_length);
+	const char* entry = __bionic_get_tzdata(name, &entry_length);
+	if (entry == NULL)
+	  return errno;
+	nread = entry_length;
+	if (nread > (ssize_t) sizeof up->buf)
+	  nread = sizeof up->buf;
+	memcpy(up->buf, entry, nread);
+	if (nread < tzheadsize)
+	  return EINVAL;
 #else
 	if (name[0] == ':')
 		++name;
@@ -420,15 +433,10 @@ tzloadbody(char const *name, struct state *sp, bool doextend,
 	if (doaccess && access(name, R_OK) != 0)
 	  return errno;
 	fid = open(name, OPEN_MODE);
-#endif
 	if (fid < 0)
 	  return errno;
 
-#if defined(__BIONIC__)
-	nread = TEMP_FAILURE_RETRY(read(fid, up->buf, entry_length));
-#else
 	nread = read(fid, up->buf, sizeof up->buf);
-#endif
 	if (nread < tzheadsize) {
 	  int err = nread < 0 ? errno : EINVAL;
 	  close(fid);
@@ -436,6 +444,7 @@ tzloadbody(char const *name, struct state *sp, bool doextend,
 	}
 	if (close(fid) < 0)
 	  return errno;
+#endif
 	for (stored = 4; stored <= 8; stored *= 2) {
 		int_fast32_t ttisstdcnt = detzcode(up->tzhead.tzh_ttisstdcnt);
 		int_fast32_t ttisgmtcnt = detzcode(up->tzhead.tzh_ttisgmtcnt);
@@ -39,6 +39,7 @@
 #include <sys/vfs.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <new>
 #include <string>
 #include <unordered_map>
@@ -1509,6 +1510,77 @@ static void shuffle(std::vector<LoadTask*>* v) {
   }
 }
 
+// Libraries in a load list are mapped on worker threads when there are at
+// least this many of them, so the page-cache readahead of one library's
+// PT_LOAD segments overlaps with the header and segment processing of
+// another. Each load reserves its own address range from the kernel and
+// touches only its own LoadTask and ElfReader, so tasks are independent; the
+// only shared state is the dl error buffer on failure.
+static constexpr size_t kParallelLoadMinTasks = 4;
+static constexpr size_t kParallelLoadMaxThreads = 4;
+
+struct ParallelLoadState {
+  LoadTask* const* tasks;
+  size_t task_count;
+  std::atomic<size_t> next_task;
+  std::atomic<bool> failed;
+};
+
+static void parallel_load_run(ParallelLoadState* state, address_space_params* address_space) {
+  for (size_t i = state->next_task.fetch_add(1, std::memory_order_relaxed);
+       i < state->task_count;
+       i = state->next_task.fetch_add(1, std::memory_order_relaxed)) {
+    if (state->failed.load(std::memory_order_relaxed)) {
+      return;
+    }
+    if (!state->tasks[i]->load(address_space)) {
+      state->failed.store(true, std::memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+struct ParallelLoadWorkerArg {
+  ParallelLoadState* state;
+  address_space_params* address_space;
+};
+
+static void* parallel_load_worker(void* raw_arg) {
+  ParallelLoadWorkerArg* arg = static_cast<ParallelLoadWorkerArg*>(raw_arg);
+  parallel_load_run(arg->state, arg->address_space);
+  return nullptr;
+}
+
+static bool load_tasks_parallel(const LoadTaskList& load_list,
+                                address_space_params* address_space) {
+  ParallelLoadState state;
+  state.tasks = load_list.data();
+  state.task_count = load_list.size();
+  state.next_task.store(0, std::memory_order_relaxed);
+  state.failed.store(false, std::memory_order_relaxed);
+
+  long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t nthreads = MIN(kParallelLoadMaxThreads, static_cast<size_t>(MAX(ncpus, 1L)));
+  nthreads = MIN(nthreads, load_list.size());
+
+  pthread_t threads[kParallelLoadMaxThreads];
+  ParallelLoadWorkerArg arg = { &state, address_space };
+  size_t nstarted = 0;
+  for (size_t i = 0; i + 1 < nthreads; ++i) {
+    // Thread creation is best effort; remaining tasks run on this thread.
+    if (pthread_create(&threads[nstarted], nullptr, parallel_load_worker, &arg) == 0) {
+      ++nstarted;
+    }
+  }
+  parallel_load_run(&state, address_space);
+  for (size_t i = 0; i < nstarted; ++i) {
+    pthread_join(threads[i], nullptr);
+  }
+  // On failure the error buffer holds the DL_ERR of one failed load; racing
+  // failures may overwrite each other but at least one full message survives.
+  return !state.failed.load(std::memory_order_relaxed);
+}
+
 // add_as_children - add first-level loaded libraries (i.e. library_names[], but
 // not their transitive dependencies) as children of the start_with library.
 // This is false when find_libraries is called for dlopen(), when newly loaded
@@ -1655,12 +1727,34 @@ bool find_libraries(android_namespace_t* ns,
     }
   }
 
-  for (auto&& task : load_list) {
-    address_space_params* address_space =
-        (reserved_address_recursive || !task->is_dt_needed()) ? &extinfo_params : &default_params;
-    if (!task->load(address_space)) {
+  // When no address range was reserved by the caller, every load reserves its
+  // own range and mutates nothing shared, so the mmap and page-cache work of
+  // independent libraries can proceed on worker threads. With a reserved
+  // range, loads consume it sequentially and stay on this thread. The order
+  // of later steps is unaffected: prelinking and linking below walk
+  // load_tasks in BFS order regardless of which thread mapped a library.
+  bool have_reserved_range =
+      extinfo != nullptr &&
+      (extinfo->flags & (ANDROID_DLEXT_RESERVED_ADDRESS | ANDROID_DLEXT_RESERVED_ADDRESS_HINT)) != 0;
+  if (!have_reserved_range &&
+      g_linker_initial_link_done &&
+      load_list.size() >= kParallelLoadMinTasks) {
+    // Materialize every task's ElfReader map entry on this thread first; the
+    // workers then only perform read-only lookups on the shared map.
+    for (auto&& task : load_list) {
+      task->get_elf_reader();
+    }
+    if (!load_tasks_parallel(load_list, &default_params)) {
       return false;
     }
+  } else {
+    for (auto&& task : load_list) {
+      address_space_params* address_space =
+          (reserved_address_recursive || !task->is_dt_needed()) ? &extinfo_params : &default_params;
+      if (!task->load(address_space)) {
+        return false;
+      }
+    }
   }
 
   // Step 3: pre-link all DT_NEEDED libraries in breadth first order.
@@ -1669,6 +1763,7 @@ bool find_libraries(android_namespace_t* ns,
     if (!si->is_linked() && !si->prelink_image()) {
       return false;
     }
+    si->attach_symbol_cache();
     register_soinfo_tls(si);
   }
 
@@ -2726,13 +2821,18 @@ void soinfo::apply_relr_reloc(ElfW(Addr) offset) {
 // Process relocations in SHT_RELR section (experimental).
 // Details of the encoding are described in this post:
 //   https://groups.google.com/d/msg/generic-abi/bX460iggiKg/Pi9aSwwABgAJ
-bool soinfo::relocate_relr() {
-  ElfW(Relr)* begin = relr_;
-  ElfW(Relr)* end = relr_ + relr_count_;
+// RELR tables with at least this many entries are applied on worker threads.
+// Each entry encodes up to 8 * wordsize - 1 relocations, so this corresponds
+// to hundreds of thousands of relocations - tables this big are only seen in
+// very large libraries, where the fixed thread cost is noise.
+static constexpr size_t kRelrParallelMinEntries = 4096;
+static constexpr size_t kRelrParallelMaxThreads = 4;
+
+bool soinfo::relocate_relr_range(const ElfW(Relr)* begin, const ElfW(Relr)* end) {
   constexpr size_t wordsize = sizeof(ElfW(Addr));
 
   ElfW(Addr) base = 0;
-  for (ElfW(Relr)* current = begin; current < end; ++current) {
+  for (const ElfW(Relr)* current = begin; current < end; ++current) {
     ElfW(Relr) entry = *current;
     ElfW(Addr) offset;
 
@@ -2762,6 +2862,74 @@ bool soinfo::relocate_relr() {
   return true;
 }
 
+struct RelrWorkerArg {
+  soinfo* si;
+  const ElfW(Relr)* begin;
+  const ElfW(Relr)* end;
+};
+
+static void* relr_worker(void* raw_arg) {
+  RelrWorkerArg* arg = static_cast<RelrWorkerArg*>(raw_arg);
+  arg->si->relocate_relr_range(arg->begin, arg->end);
+  return nullptr;
+}
+
+bool soinfo::relocate_relr_parallel(const ElfW(Relr)* begin, const ElfW(Relr)* end) {
+  // Partition the table at even entries: an even entry resets the bitmap base,
+  // so a range starting there decodes independently of everything before it.
+  // All relocations write disjoint addresses, so workers need no ordering.
+  long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t nthreads = MIN(kRelrParallelMaxThreads, static_cast<size_t>(MAX(ncpus, 1L)));
+  const size_t count = static_cast<size_t>(end - begin);
+
+  const ElfW(Relr)* starts[kRelrParallelMaxThreads];
+  size_t nranges = 0;
+  const ElfW(Relr)* next = begin;
+  for (size_t i = 0; i < nthreads && next < end; ++i) {
+    starts[nranges++] = next;
+    next += count / nthreads;
+    // Advance to the next even entry; odd (bitmap) entries depend on the
+    // preceding even entry's base.
+    while (next < end && (*next & 1) != 0) {
+      ++next;
+    }
+  }
+  if (nranges < 2) {
+    return relocate_relr_range(begin, end);
+  }
+
+  RelrWorkerArg args[kRelrParallelMaxThreads];
+  pthread_t threads[kRelrParallelMaxThreads];
+  size_t nstarted = 0;
+  for (size_t i = 0; i + 1 < nranges; ++i) {
+    args[i] = RelrWorkerArg{this, starts[i], starts[i + 1]};
+    if (pthread_create(&threads[i], nullptr, relr_worker, &args[i]) != 0) {
+      // Thread creation is best effort; apply the range on this thread.
+      relocate_relr_range(starts[i], starts[i + 1]);
+      continue;
+    }
+    threads[nstarted++] = threads[i];
+  }
+  // The last range runs on the calling thread while the workers process
+  // theirs.
+  relocate_relr_range(starts[nranges - 1], end);
+  for (size_t i = 0; i < nstarted; ++i) {
+    pthread_join(threads[i], nullptr);
+  }
+  return true;
+}
+
+bool soinfo::relocate_relr() {
+  const ElfW(Relr)* begin = relr_;
+  const ElfW(Relr)* end = relr_ + relr_count_;
+  // Worker threads can only be created once libc and the main thread are set
+  // up, so the initial link of the executable always relocates sequentially.
+  if (relr_count_ >= kRelrParallelMinEntries && g_linker_initial_link_done) {
+    return relocate_relr_parallel(begin, end);
+  }
+  return relocate_relr_range(begin, end);
+}
+
 // An empty list of soinfos
 static soinfo_list_t g_empty_list;
 
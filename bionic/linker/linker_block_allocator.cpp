@@ -29,6 +29,7 @@
 #include "linker_block_allocator.h"
 
 #include <inttypes.h>
+#include <stddef.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/param.h>
@@ -37,12 +38,29 @@
 
 #include "linker_debug.h"
 
-static constexpr size_t kAllocateSize = PAGE_SIZE * 100;
-static_assert(kAllocateSize % PAGE_SIZE == 0, "Invalid kAllocateSize.");
+static constexpr size_t kMaxPageSize = PAGE_SIZE * 100;
+// Page size tiering: a page holds at least this many blocks, so allocators
+// for small types do not pin large slabs.
+static constexpr size_t kMinBlocksPerPage = 64;
+static constexpr size_t kPageHeaderSize = 16;
+static constexpr size_t kThreadCacheBlocks = 16;
 
 struct LinkerBlockAllocatorPage {
   LinkerBlockAllocatorPage* next;
-  uint8_t bytes[kAllocateSize - 16] __attribute__((aligned(16)));
+  uint8_t bytes[] __attribute__((aligned(16)));
+};
+
+static_assert(offsetof(LinkerBlockAllocatorPage, bytes) == kPageHeaderSize,
+              "Invalid kPageHeaderSize.");
+
+// A small per-thread stash of freed blocks, so concurrent alloc/free pairs
+// (parallel loading, dlopen-heavy apps) do not serialize on the allocator
+// mutex. Blocks in a cache still count as allocated; a thread flushes its
+// cache back to the shared free list on overflow and on thread exit.
+struct LinkerBlockAllocatorThreadCache {
+  LinkerBlockAllocator* owner;
+  size_t count;
+  void* blocks[kThreadCacheBlocks];
 };
 
 struct FreeBlockInfo {
@@ -55,11 +73,31 @@ static_assert(kBlockSizeMin == sizeof(FreeBlockInfo));
 
 LinkerBlockAllocator::LinkerBlockAllocator(size_t block_size)
     : block_size_(__BIONIC_ALIGN(MAX(block_size, kBlockSizeMin), kBlockSizeAlign)),
+      page_size_(MIN(kMaxPageSize,
+                     __BIONIC_ALIGN(kPageHeaderSize + block_size_ * kMinBlocksPerPage, PAGE_SIZE))),
       page_list_(nullptr),
       free_block_list_(nullptr),
-      allocated_(0) {}
+      allocated_(0),
+      mutex_(PTHREAD_MUTEX_INITIALIZER),
+      thread_cache_key_(0),
+      thread_cache_key_created_(false) {}
 
 void* LinkerBlockAllocator::alloc() {
+  // Serve from the thread cache when possible; blocks were zeroed when they
+  // entered the cache. Cache misses fall through to the shared free list so
+  // that blocks carved from a fresh page are handed out in address order.
+  LinkerBlockAllocatorThreadCache* cache = get_thread_cache();
+  if (cache != nullptr && cache->count > 0) {
+    return cache->blocks[--cache->count];
+  }
+
+  pthread_mutex_lock(&mutex_);
+  void* block = alloc_locked();
+  pthread_mutex_unlock(&mutex_);
+  return block;
+}
+
+void* LinkerBlockAllocator::alloc_locked() {
   if (free_block_list_ == nullptr) {
     create_new_page();
   }
@@ -87,14 +125,29 @@ void LinkerBlockAllocator::free(void* block) {
     return;
   }
 
+  memset(block, 0, block_size_);
+
+  LinkerBlockAllocatorThreadCache* cache = get_thread_cache();
+  if (cache != nullptr) {
+    if (cache->count == kThreadCacheBlocks) {
+      flush_thread_cache(cache);
+    }
+    cache->blocks[cache->count++] = block;
+    return;
+  }
+
+  pthread_mutex_lock(&mutex_);
+  free_locked(block);
+  pthread_mutex_unlock(&mutex_);
+}
+
+void LinkerBlockAllocator::free_locked(void* block) {
   LinkerBlockAllocatorPage* page = find_page(block);
   CHECK(page != nullptr);
 
   ssize_t offset = reinterpret_cast<uint8_t*>(block) - page->bytes;
   CHECK((offset % block_size_) == 0);
 
-  memset(block, 0, block_size_);
-
   FreeBlockInfo* block_info = reinterpret_cast<FreeBlockInfo*>(block);
 
   block_info->next_block = free_block_list_;
@@ -105,27 +158,70 @@ void LinkerBlockAllocator::free(void* block) {
   --allocated_;
 }
 
+LinkerBlockAllocatorThreadCache* LinkerBlockAllocator::get_thread_cache() {
+  if (!thread_cache_key_created_) {
+    pthread_mutex_lock(&mutex_);
+    if (!thread_cache_key_created_) {
+      if (pthread_key_create(&thread_cache_key_, thread_cache_destructor) != 0) {
+        pthread_mutex_unlock(&mutex_);
+        return nullptr;
+      }
+      thread_cache_key_created_ = true;
+    }
+    pthread_mutex_unlock(&mutex_);
+  }
+
+  LinkerBlockAllocatorThreadCache* cache =
+      static_cast<LinkerBlockAllocatorThreadCache*>(pthread_getspecific(thread_cache_key_));
+  if (cache == nullptr) {
+    cache = static_cast<LinkerBlockAllocatorThreadCache*>(calloc(1, sizeof(*cache)));
+    if (cache == nullptr) {
+      return nullptr;
+    }
+    cache->owner = this;
+    if (pthread_setspecific(thread_cache_key_, cache) != 0) {
+      ::free(cache);
+      return nullptr;
+    }
+  }
+  return cache;
+}
+
+void LinkerBlockAllocator::flush_thread_cache(LinkerBlockAllocatorThreadCache* cache) {
+  pthread_mutex_lock(&mutex_);
+  for (size_t i = 0; i < cache->count; ++i) {
+    free_locked(cache->blocks[i]);
+  }
+  pthread_mutex_unlock(&mutex_);
+  cache->count = 0;
+}
+
+void LinkerBlockAllocator::thread_cache_destructor(void* arg) {
+  LinkerBlockAllocatorThreadCache* cache = static_cast<LinkerBlockAllocatorThreadCache*>(arg);
+  cache->owner->flush_thread_cache(cache);
+  ::free(cache);
+}
+
 void LinkerBlockAllocator::protect_all(int prot) {
+  pthread_mutex_lock(&mutex_);
   for (LinkerBlockAllocatorPage* page = page_list_; page != nullptr; page = page->next) {
-    if (mprotect(page, kAllocateSize, prot) == -1) {
-      async_safe_fatal("mprotect(%p, %zu, %d) failed: %m", page, kAllocateSize, prot);
+    if (mprotect(page, page_size_, prot) == -1) {
+      async_safe_fatal("mprotect(%p, %zu, %d) failed: %m", page, page_size_, prot);
     }
   }
+  pthread_mutex_unlock(&mutex_);
 }
 
 void LinkerBlockAllocator::create_new_page() {
-  static_assert(sizeof(LinkerBlockAllocatorPage) == kAllocateSize,
-                "Invalid sizeof(LinkerBlockAllocatorPage)");
-
   LinkerBlockAllocatorPage* page = reinterpret_cast<LinkerBlockAllocatorPage*>(
-      mmap(nullptr, kAllocateSize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0));
+      mmap(nullptr, page_size_, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0));
   CHECK(page != MAP_FAILED);
 
-  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, page, kAllocateSize, "linker_alloc");
+  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, page, page_size_, "linker_alloc");
 
   FreeBlockInfo* first_block = reinterpret_cast<FreeBlockInfo*>(page->bytes);
   first_block->next_block = free_block_list_;
-  first_block->num_free_blocks = sizeof(page->bytes) / block_size_;
+  first_block->num_free_blocks = (page_size_ - kPageHeaderSize) / block_size_;
 
   free_block_list_ = first_block;
 
@@ -139,7 +235,7 @@ LinkerBlockAllocatorPage* LinkerBlockAllocator::find_page(void* block) {
   LinkerBlockAllocatorPage* page = page_list_;
   while (page != nullptr) {
     const uint8_t* page_ptr = reinterpret_cast<const uint8_t*>(page);
-    if (block >= (page_ptr + sizeof(page->next)) && block < (page_ptr + kAllocateSize)) {
+    if (block >= (page_ptr + kPageHeaderSize) && block < (page_ptr + page_size_)) {
       return page;
     }
 
@@ -150,16 +246,24 @@ LinkerBlockAllocatorPage* LinkerBlockAllocator::find_page(void* block) {
 }
 
 void LinkerBlockAllocator::purge() {
+  LinkerBlockAllocatorThreadCache* cache = get_thread_cache();
+  if (cache != nullptr) {
+    flush_thread_cache(cache);
+  }
+
+  pthread_mutex_lock(&mutex_);
   if (allocated_) {
+    pthread_mutex_unlock(&mutex_);
     return;
   }
 
   LinkerBlockAllocatorPage* page = page_list_;
   while (page) {
     LinkerBlockAllocatorPage* next = page->next;
-    munmap(page, kAllocateSize);
+    munmap(page, page_size_);
     page = next;
   }
   page_list_ = nullptr;
   free_block_list_ = nullptr;
+  pthread_mutex_unlock(&mutex_);
 }
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <limits.h>
 
@@ -37,6 +38,7 @@ static constexpr size_t kBlockSizeAlign = sizeof(void*);
 static constexpr size_t kBlockSizeMin = sizeof(void*) * 2;
 
 struct LinkerBlockAllocatorPage;
+struct LinkerBlockAllocatorThreadCache;
 
 /*
  * This class is a non-template version of the LinkerTypeAllocator
@@ -44,6 +46,10 @@ struct LinkerBlockAllocatorPage;
  * template-free.
  *
  * Please use LinkerTypeAllocator<type> where possible (everywhere).
+ *
+ * alloc() and free() are thread-safe. Freed blocks are kept in a small
+ * per-thread cache and handed back without taking the allocator mutex;
+ * only cache misses and overflows touch the shared free list.
  */
 class LinkerBlockAllocator {
  public:
@@ -54,16 +60,30 @@ class LinkerBlockAllocator {
   void protect_all(int prot);
 
   // Purge all pages if all previously allocated blocks have been freed.
+  // Blocks cached by other threads count as allocated and keep their
+  // pages mapped; the calling thread's cache is flushed first.
   void purge();
 
  private:
+  void* alloc_locked();
+  void free_locked(void* block);
   void create_new_page();
   LinkerBlockAllocatorPage* find_page(void* block);
+  LinkerBlockAllocatorThreadCache* get_thread_cache();
+  void flush_thread_cache(LinkerBlockAllocatorThreadCache* cache);
+  static void thread_cache_destructor(void* arg);
 
   size_t block_size_;
+  // Pages are sized per allocator so that small block sizes do not pin
+  // large slabs: enough pages for kMinBlocksPerPage blocks, capped at
+  // kMaxPageSize.
+  size_t page_size_;
   LinkerBlockAllocatorPage* page_list_;
   void* free_block_list_;
   size_t allocated_;
+  pthread_mutex_t mutex_;
+  pthread_key_t thread_cache_key_;
+  bool thread_cache_key_created_;
 
   DISALLOW_COPY_AND_ASSIGN(LinkerBlockAllocator);
 };
@@ -42,6 +42,8 @@ std::unordered_map<uintptr_t, soinfo*> g_soinfo_handles_map;
 
 platform_properties g_platform_properties;
 
+bool g_linker_initial_link_done = false;
+
 static char __linker_dl_err_buf[768];
 
 char* linker_get_error_buffer() {
@@ -104,3 +104,8 @@ class DlErrorRestorer {
 };
 
 __LIBC_HIDDEN__ extern bool g_is_ldd;
+
+// Set once the main executable and its dependencies have been linked and the
+// main thread is fully initialized. Worker threads (e.g. for parallel RELR
+// relocation) may only be created after this point.
+__LIBC_HIDDEN__ extern bool g_linker_initial_link_done;
@@ -40,6 +40,7 @@
 #include "linker_phdr.h"
 #include "linker_relocate.h"
 #include "linker_relocs.h"
+#include "linker_symbol_cache.h"
 #include "linker_tls.h"
 #include "linker_utils.h"
 
@@ -355,6 +356,10 @@ static ElfW(Addr) linker_main(KernelArgumentBlock& args, const char* exe_to_load
     if (ldpreload_env != nullptr) {
       INFO("[ LD_PRELOAD set to \"%s\" ]", ldpreload_env);
     }
+    // Map the per-app symbol lookup cache, if the launcher provided one.
+    // Records are validated against each library's GNU build-id before use,
+    // so a stale cache is harmless.
+    symbol_cache_init(getenv("LD_SYMBOL_CACHE"));
   }
 
   const ExecutableInfo exe_info = exe_to_load ? load_executable(exe_to_load) :
@@ -504,6 +509,8 @@ static ElfW(Addr) linker_main(KernelArgumentBlock& args, const char* exe_to_load
 
   if (!get_cfi_shadow()->InitialLinkDone(solist)) __linker_cannot_link(g_argv[0]);
 
+  g_linker_initial_link_done = true;
+
   si->call_pre_init_constructors();
   si->call_constructors();
 
@@ -43,6 +43,7 @@
 #include "linker_gnu_hash.h"
 #include "linker_logger.h"
 #include "linker_relocate.h"
+#include "linker_symbol_cache.h"
 #include "linker_utils.h"
 
 // Enable the slow lookup path if symbol lookups should be logged.
@@ -143,6 +144,49 @@ soinfo_do_lookup_impl(const char* name, const version_info* vi,
         continue;
       }
 
+      // A build-id verified cache record is a complete index of the library's
+      // exported symbols: probe it instead of the bloom filter and hash chain.
+      // A hit is verified exactly like a chain hit; a miss is definitive.
+      if (lib->cache_entries_ != nullptr) {
+        if (IsGeneral) {
+          TRACE_TYPE(LOOKUP, "SEARCH %s in %s@%p (cache)",
+                     name, lib->si_->get_realpath(), reinterpret_cast<void*>(lib->si_->base));
+        }
+        const SymbolCacheEntry* entry =
+            symbol_cache_find(lib->cache_entries_, lib->cache_entry_count_, hash);
+        if (entry != nullptr) {
+          const SymbolCacheEntry* cache_end = lib->cache_entries_ + lib->cache_entry_count_;
+          ElfW(Versym) cache_verneed = kVersymNotNeeded;
+          bool cache_calculated_verneed = false;
+          for (; entry != cache_end && entry->gnu_hash == hash; ++entry) {
+            const uint32_t cache_sym_idx = entry->sym_index;
+            const ElfW(Sym)* cache_sym = lib->symtab_ + cache_sym_idx;
+            if (vi != nullptr && !cache_calculated_verneed) {
+              cache_calculated_verneed = true;
+              cache_verneed = find_verdef_version_index(lib->si_, vi);
+            }
+            if (check_symbol_version(lib->versym_, cache_sym_idx, cache_verneed) &&
+                static_cast<size_t>(cache_sym->st_name) + name_len + 1 <= lib->strtab_size_ &&
+                memcmp(lib->strtab_ + cache_sym->st_name, name, name_len + 1) == 0 &&
+                is_symbol_global_and_defined(lib->si_, cache_sym)) {
+              *si_found_in = lib->si_;
+              if (IsGeneral) {
+                TRACE_TYPE(LOOKUP, "FOUND %s in %s (%p) %zd",
+                           name, lib->si_->get_realpath(),
+                           reinterpret_cast<void*>(cache_sym->st_value),
+                           static_cast<size_t>(cache_sym->st_size));
+              }
+              return cache_sym;
+            }
+          }
+        }
+        if (IsGeneral) {
+          TRACE_TYPE(LOOKUP, "NOT FOUND %s in %s@%p",
+                     name, lib->si_->get_realpath(), reinterpret_cast<void*>(lib->si_->base));
+        }
+        continue;
+      }
+
       if (IsGeneral) {
         TRACE_TYPE(LOOKUP, "SEARCH %s in %s@%p (gnu)",
                    name, lib->si_->get_realpath(), reinterpret_cast<void*>(lib->si_->base));
@@ -319,6 +363,9 @@ SymbolLookupLib soinfo::get_lookup_lib() {
   result.gnu_nbucket_ = gnu_nbucket_;
   result.gnu_bucket_ = gnu_bucket_;
 
+  result.cache_entries_ = symbol_cache_entries_;
+  result.cache_entry_count_ = symbol_cache_entry_count_;
+
   return result;
 }
 
@@ -73,6 +73,8 @@ ElfW(Addr) call_ifunc_resolver(ElfW(Addr) resolver_addr);
 typedef void (*linker_dtor_function_t)();
 typedef void (*linker_ctor_function_t)(int, char**, char**);
 
+struct SymbolCacheEntry;
+
 // An entry within a SymbolLookupList.
 struct SymbolLookupLib {
   uint32_t gnu_maskwords_ = 0;
@@ -90,6 +92,11 @@ struct SymbolLookupLib {
 
   soinfo* si_ = nullptr;
 
+  // Non-null iff the library has a build-id verified record in the on-disk
+  // symbol lookup cache; see linker_symbol_cache.h.
+  const SymbolCacheEntry* cache_entries_ = nullptr;
+  size_t cache_entry_count_ = 0;
+
   bool needs_sysv_lookup() const { return si_ != nullptr && gnu_bloom_filter_ == nullptr; }
 };
 
@@ -251,6 +258,10 @@ struct soinfo {
   void call_destructors();
   void call_pre_init_constructors();
   bool prelink_image();
+  // Attaches this library's record from the on-disk symbol lookup cache,
+  // if the cache has one with a matching soname and GNU build-id. Called
+  // after prelink_image so the soname is known.
+  void attach_symbol_cache();
   bool link_image(const SymbolLookupList& lookup_list, soinfo* local_group_root,
                   const android_dlextinfo* extinfo, size_t* relro_fd_offset);
   bool protect_relro();
@@ -367,6 +378,8 @@ struct soinfo {
  private:
   bool relocate(const SymbolLookupList& lookup_list);
   bool relocate_relr();
+  bool relocate_relr_range(const ElfW(Relr)* begin, const ElfW(Relr)* end);
+  bool relocate_relr_parallel(const ElfW(Relr)* begin, const ElfW(Relr)* end);
   void apply_relr_reloc(ElfW(Addr) offset);
 
   // This part of the structure is only available
@@ -433,6 +446,11 @@ struct soinfo {
   // version >= 6
   ElfW(Addr) gap_start_;
   size_t gap_size_;
+
+  // Record from the mapped symbol lookup cache, or nullptr. Points into
+  // the read-only cache mapping, which is never unmapped once installed.
+  const SymbolCacheEntry* symbol_cache_entries_;
+  size_t symbol_cache_entry_count_;
 };
 
 // This function is used by dlvsym() to calculate hash of sym_ver
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "linker_symbol_cache.h"
+
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "platform/bionic/macros.h"
+
+#include "linker_debug.h"
+#include "linker_gnu_hash.h"
+#include "linker_soinfo.h"
+
+static const SymbolCacheHeader* g_symbol_cache = nullptr;
+static size_t g_symbol_cache_size = 0;
+
+void symbol_cache_init(const char* path) {
+  if (path == nullptr || g_symbol_cache != nullptr) {
+    return;
+  }
+
+  int fd = TEMP_FAILURE_RETRY(open(path, O_RDONLY | O_CLOEXEC));
+  if (fd == -1) {
+    return;
+  }
+
+  struct stat file_stat;
+  void* map = MAP_FAILED;
+  if (fstat(fd, &file_stat) == 0 && static_cast<size_t>(file_stat.st_size) >= sizeof(SymbolCacheHeader)) {
+    map = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (map == MAP_FAILED) {
+    return;
+  }
+
+  const size_t size = file_stat.st_size;
+  const SymbolCacheHeader* header = static_cast<const SymbolCacheHeader*>(map);
+  if (header->magic != kSymbolCacheMagic ||
+      header->version != kSymbolCacheVersion ||
+      header->file_size != size ||
+      header->lib_count > (size - sizeof(SymbolCacheHeader)) / sizeof(SymbolCacheLibRecord)) {
+    munmap(map, size);
+    return;
+  }
+
+  // Validate every record's entry array up front so lookups never have to
+  // bounds-check the mapping.
+  const SymbolCacheLibRecord* records =
+      reinterpret_cast<const SymbolCacheLibRecord*>(header + 1);
+  for (uint32_t i = 0; i < header->lib_count; ++i) {
+    const SymbolCacheLibRecord& record = records[i];
+    if (record.build_id_size == 0 ||
+        record.build_id_size > kSymbolCacheMaxBuildIdSize ||
+        record.entry_offset > size ||
+        record.entry_offset % alignof(SymbolCacheEntry) != 0 ||
+        record.entry_count > (size - record.entry_offset) / sizeof(SymbolCacheEntry)) {
+      munmap(map, size);
+      return;
+    }
+  }
+
+  g_symbol_cache = header;
+  g_symbol_cache_size = size;
+  INFO("[ Using symbol lookup cache \"%s\" (%u libraries) ]", path, header->lib_count);
+}
+
+const SymbolCacheEntry* symbol_cache_find(const SymbolCacheEntry* entries, size_t count,
+                                          uint32_t hash) {
+  size_t lo = 0;
+  size_t hi = count;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (entries[mid].gnu_hash < hash) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == count || entries[lo].gnu_hash != hash) {
+    return nullptr;
+  }
+  return entries + lo;
+}
+
+// Finds the NT_GNU_BUILD_ID note in the library's PT_NOTE segments.
+static bool find_gnu_build_id(const soinfo* si, const uint8_t** build_id, size_t* build_id_size) {
+  for (size_t i = 0; i < si->phnum; ++i) {
+    const ElfW(Phdr)* phdr = &si->phdr[i];
+    if (phdr->p_type != PT_NOTE) {
+      continue;
+    }
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(si->load_bias + phdr->p_vaddr);
+    const uint8_t* note_end = p + phdr->p_memsz;
+    while (p + sizeof(ElfW(Nhdr)) <= note_end) {
+      const ElfW(Nhdr)* nhdr = reinterpret_cast<const ElfW(Nhdr)*>(p);
+      p += sizeof(ElfW(Nhdr));
+      const uint8_t* name = p;
+      p += align_up(nhdr->n_namesz, 4);
+      const uint8_t* desc = p;
+      p += align_up(nhdr->n_descsz, 4);
+      if (p > note_end) {
+        break;
+      }
+      if (nhdr->n_type == NT_GNU_BUILD_ID &&
+          nhdr->n_namesz == 4 &&
+          memcmp(name, "GNU", 4) == 0) {
+        *build_id = desc;
+        *build_id_size = nhdr->n_descsz;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void soinfo::attach_symbol_cache() {
+  if (g_symbol_cache == nullptr || !is_gnu_hash()) {
+    return;
+  }
+
+  const char* soname = get_soname();
+  if (soname == nullptr) {
+    return;
+  }
+  const uint32_t soname_hash = calculate_gnu_hash(soname).first;
+
+  const uint8_t* build_id = nullptr;
+  size_t build_id_size = 0;
+  if (!find_gnu_build_id(this, &build_id, &build_id_size) ||
+      build_id_size > kSymbolCacheMaxBuildIdSize) {
+    return;
+  }
+
+  const SymbolCacheLibRecord* records =
+      reinterpret_cast<const SymbolCacheLibRecord*>(g_symbol_cache + 1);
+  for (uint32_t i = 0; i < g_symbol_cache->lib_count; ++i) {
+    const SymbolCacheLibRecord& record = records[i];
+    if (record.soname_hash == soname_hash &&
+        record.build_id_size == build_id_size &&
+        memcmp(record.build_id, build_id, build_id_size) == 0) {
+      symbol_cache_entries_ = reinterpret_cast<const SymbolCacheEntry*>(
+          reinterpret_cast<const uint8_t*>(g_symbol_cache) + record.entry_offset);
+      symbol_cache_entry_count_ = record.entry_count;
+      TRACE("[ Attached symbol cache record for \"%s\" (%u symbols) ]",
+            soname, record.entry_count);
+      return;
+    }
+  }
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// On-disk symbol lookup cache.
+//
+// The cache file is generated offline (e.g. at install time, from the
+// libraries an app actually loads) and mapped read-only by every process
+// that uses it, so the pages are shared. For each library it contains the
+// full set of exported symbols as (gnu hash, dynsym index) pairs sorted by
+// hash. A library's cache record is only attached if its GNU build-id
+// matches the one recorded at generation time, so a stale cache degrades
+// to the regular GNU hash lookup instead of producing wrong bindings.
+//
+// Because a matching record is complete for its (build-id verified)
+// library, a probe has definitive results: a missing hash means the
+// library does not export the symbol and the bloom filter / hash chain
+// walk can be skipped entirely; a present hash yields candidate dynsym
+// indices that are verified against the string table and version table
+// exactly like a chain hit would be.
+//
+// File layout (all fields little-endian, entries 8-byte packed):
+//   SymbolCacheHeader
+//   SymbolCacheLibRecord[lib_count]
+//   SymbolCacheEntry arrays, referenced by entry_offset (sorted by gnu_hash)
+
+static constexpr uint32_t kSymbolCacheMagic = 0x31434c53;  // "SLC1"
+static constexpr uint32_t kSymbolCacheVersion = 1;
+static constexpr size_t kSymbolCacheMaxBuildIdSize = 32;
+
+struct SymbolCacheHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t lib_count;
+  uint32_t file_size;  // Total size in bytes; must match the mapped file.
+};
+
+struct SymbolCacheLibRecord {
+  uint32_t soname_hash;  // GNU hash of the soname; pre-filter only.
+  uint32_t build_id_size;
+  uint8_t build_id[kSymbolCacheMaxBuildIdSize];
+  uint32_t entry_offset;  // Byte offset of the entry array from file start.
+  uint32_t entry_count;
+};
+
+struct SymbolCacheEntry {
+  uint32_t gnu_hash;
+  uint32_t sym_index;  // Index into the library's .dynsym.
+};
+
+// Maps and validates the cache file at |path|. Failures (missing file,
+// bad magic/version/bounds) are silently ignored; the cache is purely an
+// optimization. Must be called at most once, before any library that
+// should use the cache is linked.
+void symbol_cache_init(const char* path);
+
+// Returns the first entry with |hash| in |entries| (sorted by gnu_hash),
+// or nullptr if there is none. Subsequent entries with the same hash, if
+// any, follow contiguously.
+const SymbolCacheEntry* symbol_cache_find(const SymbolCacheEntry* entries, size_t count,
+                                          uint32_t hash);
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "linker_symbol_cache.h"
+
+TEST(linker_symbol_cache, find_empty) {
+  ASSERT_EQ(nullptr, symbol_cache_find(nullptr, 0, 0x12345678));
+}
+
+TEST(linker_symbol_cache, find) {
+  // Sorted by gnu_hash, with a duplicate hash (two colliding symbols).
+  const SymbolCacheEntry entries[] = {
+      {0x00000000, 1}, {0x1badb002, 2}, {0x1badb002, 3}, {0xcafef00d, 4}, {0xffffffff, 5},
+  };
+  constexpr size_t count = sizeof(entries) / sizeof(entries[0]);
+
+  const SymbolCacheEntry* entry = symbol_cache_find(entries, count, 0x1badb002);
+  ASSERT_EQ(&entries[1], entry);
+  // The second entry with the same hash follows contiguously.
+  ASSERT_EQ(0x1badb002u, entry[1].gnu_hash);
+  ASSERT_EQ(3u, entry[1].sym_index);
+
+  ASSERT_EQ(&entries[0], symbol_cache_find(entries, count, 0x00000000));
+  ASSERT_EQ(&entries[4], symbol_cache_find(entries, count, 0xffffffff));
+  ASSERT_EQ(nullptr, symbol_cache_find(entries, count, 0x1badb001));
+  ASSERT_EQ(nullptr, symbol_cache_find(entries, count, 0xdeadbeef));
+}
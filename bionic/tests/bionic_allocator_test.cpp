@@ -30,6 +30,9 @@
 #include <string.h>
 #include <sys/mman.h>
 
+#include <thread>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "private/bionic_allocator.h"
@@ -150,6 +153,34 @@ TEST(bionic_allocator, test_small_smoke) {
   allocator.free(ptr2);
 }
 
+TEST(bionic_allocator, test_thread_cached_small) {
+  BionicAllocator allocator;
+  allocator.enable_thread_caches();
+
+  uint8_t zeros[16];
+  memset(zeros, 0, sizeof(zeros));
+
+  std::thread([&allocator, &zeros] {
+    // Cycle enough blocks through the magazine to force refills and drains.
+    std::vector<void*> ptrs;
+    for (size_t i = 0; i < 1000; ++i) {
+      void* ptr = allocator.alloc(sizeof(test_struct_small));
+      ASSERT_TRUE(ptr != nullptr);
+      ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(ptr) % 16);
+      ASSERT_TRUE(memcmp(ptr, zeros, 16) == 0);
+      memset(ptr, 0xff, sizeof(test_struct_small));
+      ptrs.push_back(ptr);
+    }
+    for (void* ptr : ptrs) {
+      allocator.free(ptr);
+    }
+    // Cached blocks must come back zeroed.
+    void* ptr = allocator.alloc(sizeof(test_struct_small));
+    ASSERT_TRUE(memcmp(ptr, zeros, 16) == 0);
+    allocator.free(ptr);
+  }).join();
+}
+
 TEST(bionic_allocator, test_huge_smoke) {
   BionicAllocator allocator;
 
@@ -34,6 +34,7 @@
 
 #include <atomic>
 #include <future>
+#include <thread>
 #include <vector>
 
 #include <android-base/macros.h>
@@ -720,6 +721,29 @@ TEST(pthread, pthread_join__race) {
   }
 }
 
+static __thread int g_thread_reuse_tls = 42;
+
+static void* ThreadReuseTlsFn(void* arg) {
+  // A recycled thread mapping must still present freshly initialized TLS:
+  // the initializer is visible and writes don't leak into the next thread.
+  if (g_thread_reuse_tls != 42) return const_cast<char*>("bad initial value");
+  g_thread_reuse_tls = *reinterpret_cast<int*>(arg);
+  return nullptr;
+}
+
+TEST(pthread, pthread_create__tls_reinitialized_on_reuse) {
+  // Create and join enough threads back to back that bionic's thread mapping
+  // cache (if present) is certain to hand out recycled mappings.
+  for (int i = 0; i < 32; ++i) {
+    int poison = 1000 + i;
+    pthread_t t;
+    ASSERT_EQ(0, pthread_create(&t, nullptr, ThreadReuseTlsFn, &poison));
+    void* result;
+    ASSERT_EQ(0, pthread_join(t, &result));
+    ASSERT_EQ(nullptr, result) << static_cast<char*>(result);
+  }
+}
+
 static void* GetActualGuardSizeFn(void* arg) {
   pthread_attr_t attributes;
   pthread_getattr_np(pthread_self(), &attributes);
@@ -1674,6 +1698,87 @@ static void pthread_cond_timedwait_timeout_helper(bool init_monotonic, clockid_t
   ASSERT_EQ(0, pthread_mutex_unlock(&mutex));
 }
 
+// Sixteen waiters broadcast while the mutex is held: all waiters must make it
+// through the critical section.
+TEST(pthread, pthread_cond_broadcast__many_waiters) {
+  pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+  int waiting = 0;
+  bool go = false;
+  int finished = 0;
+
+  constexpr int kThreadCount = 16;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&]() {
+      ASSERT_EQ(0, pthread_mutex_lock(&mutex));
+      ++waiting;
+      while (!go) {
+        ASSERT_EQ(0, pthread_cond_wait(&cond, &mutex));
+      }
+      ++finished;
+      ASSERT_EQ(0, pthread_mutex_unlock(&mutex));
+    });
+  }
+
+  while (true) {
+    ASSERT_EQ(0, pthread_mutex_lock(&mutex));
+    if (waiting == kThreadCount) break;
+    ASSERT_EQ(0, pthread_mutex_unlock(&mutex));
+    usleep(5000);
+  }
+  // Broadcast while holding the mutex, so every waiter contends for it
+  // immediately on wakeup.
+  go = true;
+  ASSERT_EQ(0, pthread_cond_broadcast(&cond));
+  ASSERT_EQ(0, pthread_mutex_unlock(&mutex));
+
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(kThreadCount, finished);
+}
+
+TEST(pthread, pthread_cond_wake_np) {
+#if defined(__BIONIC__)
+  pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+  int waiting = 0;
+  int available = 0;
+
+  constexpr int kThreadCount = 4;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&]() {
+      ASSERT_EQ(0, pthread_mutex_lock(&mutex));
+      ++waiting;
+      while (available == 0) {
+        ASSERT_EQ(0, pthread_cond_wait(&cond, &mutex));
+      }
+      --available;
+      ASSERT_EQ(0, pthread_mutex_unlock(&mutex));
+    });
+  }
+
+  while (true) {
+    ASSERT_EQ(0, pthread_mutex_lock(&mutex));
+    if (waiting == kThreadCount) break;
+    ASSERT_EQ(0, pthread_mutex_unlock(&mutex));
+    usleep(5000);
+  }
+  available = kThreadCount;
+  ASSERT_EQ(0, pthread_cond_wake_np(&cond, kThreadCount));
+  ASSERT_EQ(0, pthread_mutex_unlock(&mutex));
+
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(0, available);
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
 TEST(pthread, pthread_cond_timedwait_timeout) {
   pthread_cond_timedwait_timeout_helper(false, CLOCK_REALTIME, pthread_cond_timedwait);
 }
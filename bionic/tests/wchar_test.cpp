@@ -570,6 +570,55 @@ TEST(wchar, mbsnrtowcs) {
   ASSERT_EQ(EILSEQ, errno);
 }
 
+TEST(wchar, mbsnrtowcs_long_ascii) {
+  // Long enough to take the bulk ASCII fast path, with limits that aren't a
+  // multiple of its chunk size and a multibyte character after the chunks.
+  const char* s = "0123456789abcdefghijklmnopqrstuvwxyzÂ¢!";
+  wchar_t dst[64];
+  const char* src;
+
+  memset(dst, 0, sizeof(dst));
+  src = s;
+  ASSERT_EQ(38U, mbsnrtowcs(dst, &src, SIZE_MAX, 64, nullptr));
+  ASSERT_EQ(nullptr, src);
+  ASSERT_EQ(L'0', dst[0]);
+  ASSERT_EQ(L'z', dst[35]);
+  ASSERT_EQ(L'¢', dst[36]);
+  ASSERT_EQ(L'!', dst[37]);
+
+  memset(dst, 0, sizeof(dst));
+  src = s;
+  ASSERT_EQ(13U, mbsnrtowcs(dst, &src, SIZE_MAX, 13, nullptr));
+  ASSERT_EQ(&s[13], src);
+  ASSERT_EQ(L'c', dst[12]);
+
+  // Measure only.
+  src = s;
+  ASSERT_EQ(38U, mbsnrtowcs(nullptr, &src, SIZE_MAX, 0, nullptr));
+}
+
+TEST(wchar, wcsnrtombs_long_ascii) {
+  const wchar_t* s = L"0123456789abcdefghijklmnopqrstuvwxyz¢!";
+  char dst[64];
+  const wchar_t* src;
+
+  memset(dst, 0, sizeof(dst));
+  src = s;
+  ASSERT_EQ(39U, wcsnrtombs(dst, &src, SIZE_MAX, 64, nullptr));
+  ASSERT_EQ(nullptr, src);
+  ASSERT_STREQ("0123456789abcdefghijklmnopqrstuvwxyzÂ¢!", dst);
+
+  memset(dst, 0, sizeof(dst));
+  src = s;
+  ASSERT_EQ(13U, wcsnrtombs(dst, &src, SIZE_MAX, 13, nullptr));
+  ASSERT_EQ(&s[13], src);
+  ASSERT_EQ('c', dst[12]);
+
+  // Measure only.
+  src = s;
+  ASSERT_EQ(39U, wcsnrtombs(nullptr, &src, SIZE_MAX, 0, nullptr));
+}
+
 TEST(wchar, wcsftime__wcsftime_l) {
   setenv("TZ", "UTC", 1);
 
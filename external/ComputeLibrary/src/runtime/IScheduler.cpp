@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2020 Arm Limited.
+ * Copyright (c) 2016-2021 Arm Limited.
  *
  * SPDX-License-Identifier: MIT
  *
@@ -29,8 +29,34 @@
 #include "src/runtime/CPUUtils.h"
 #include "src/runtime/SchedulerUtils.h"
 
+#include <chrono>
+
 namespace arm_compute
 {
+namespace
+{
+#ifndef BARE_METAL
+/** Number of uniform stripes handed out per thread on a heterogeneous system while a
+ * kernel type has no throughput history yet; the surplus stripes are what the faster
+ * cores steal from behind the slower ones.
+ */
+constexpr unsigned int heterogeneous_stripes_per_thread = 4;
+
+bool is_heterogeneous(CPUInfo &cpu_info)
+{
+    const unsigned int num_cpus = cpu_info.get_cpu_num();
+    for(unsigned int i = 1; i < num_cpus; ++i)
+    {
+        if(cpu_info.get_cpu_model(i) != cpu_info.get_cpu_model(0))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+#endif /* !BARE_METAL */
+} // namespace
+
 IScheduler::IScheduler()
     : _cpu_info()
 {
@@ -127,11 +153,29 @@ void IScheduler::schedule_common(ICPPKernel *kernel, const Hints &hints, ITensor
         }
         else
         {
+            // On a heterogeneous system an even static split leaves the fast cores idle
+            // while the slow cluster finishes its share, so static splits are biased by
+            // the measured per-core throughput of this kernel type once it is available.
+            const bool               heterogeneous = is_heterogeneous(_cpu_info);
+            std::vector<std::size_t> chunk_boundaries;
+
             unsigned int num_windows = 0;
             switch(hints.strategy())
             {
                 case StrategyHint::STATIC:
                     num_windows = num_threads;
+                    if(heterogeneous)
+                    {
+                        const std::vector<double> thread_weights = scheduler_utils::KernelThroughputTracker::get().weights(kernel->name(), num_threads);
+                        if(!thread_weights.empty())
+                        {
+                            chunk_boundaries = scheduler_utils::split_proportional(num_iterations, thread_weights);
+                        }
+                        else
+                        {
+                            num_windows = std::min(num_iterations, num_threads * heterogeneous_stripes_per_thread);
+                        }
+                    }
                     break;
                 case StrategyHint::DYNAMIC:
                 {
@@ -146,12 +190,27 @@ void IScheduler::schedule_common(ICPPKernel *kernel, const Hints &hints, ITensor
             std::vector<IScheduler::Workload> workloads(num_windows);
             for(unsigned int t = 0; t < num_windows; ++t)
             {
-                //Capture 't' by copy, all the other variables by reference:
-                workloads[t] = [t, &hints, &max_window, &num_windows, &kernel, &tensors](const ThreadInfo & info)
+                //Capture 't' and 'heterogeneous' by copy, all the other variables by reference:
+                workloads[t] = [t, heterogeneous, &chunk_boundaries, &hints, &max_window, &num_windows, &kernel, &tensors](const ThreadInfo & info)
                 {
-                    Window win = max_window.split_window(hints.split_dimension(), t, num_windows);
+                    Window win;
+                    if(chunk_boundaries.empty())
+                    {
+                        win = max_window.split_window(hints.split_dimension(), t, num_windows);
+                    }
+                    else
+                    {
+                        //narrow the window to the iteration range sized for this thread's measured throughput
+                        const Window::Dimension &dim   = max_window[hints.split_dimension()];
+                        const int                start = dim.start() + static_cast<int>(chunk_boundaries[t]) * dim.step();
+                        const int                end   = (t == num_windows - 1) ? dim.end() : dim.start() + static_cast<int>(chunk_boundaries[t + 1]) * dim.step();
+
+                        win = max_window;
+                        win.set(hints.split_dimension(), Window::Dimension(start, end, dim.step()));
+                    }
                     win.validate();
 
+                    const auto start_time = std::chrono::steady_clock::now();
                     if(tensors.empty())
                     {
                         kernel->run(win, info);
@@ -160,6 +219,12 @@ void IScheduler::schedule_common(ICPPKernel *kernel, const Hints &hints, ITensor
                     {
                         kernel->run_op(tensors, win, info);
                     }
+                    if(heterogeneous)
+                    {
+                        const auto duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count();
+                        scheduler_utils::KernelThroughputTracker::get().record(kernel->name(), static_cast<unsigned int>(info.thread_id),
+                                                                               win.num_iterations(hints.split_dimension()), static_cast<uint64_t>(duration_ns));
+                    }
                 };
             }
             run_workloads(workloads);
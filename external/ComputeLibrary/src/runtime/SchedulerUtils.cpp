@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020 Arm Limited.
+ * Copyright (c) 2020-2021 Arm Limited.
  *
  * SPDX-License-Identifier: MIT
  *
@@ -78,6 +78,93 @@ std::pair<unsigned, unsigned> split_2d(unsigned max_threads, std::size_t m, std:
         return { 1, std::min<unsigned>(n, max_threads) };
     }
 }
+
+std::vector<std::size_t> split_proportional(std::size_t num_iterations, const std::vector<double> &weights)
+{
+    ARM_COMPUTE_ERROR_ON(weights.empty());
+    ARM_COMPUTE_ERROR_ON(num_iterations < weights.size());
+
+    double total = 0.;
+    for(double w : weights)
+    {
+        total += w;
+    }
+    ARM_COMPUTE_ERROR_ON(total <= 0.);
+
+    std::vector<std::size_t> boundaries(weights.size() + 1, 0);
+    double                   accumulated = 0.;
+    for(std::size_t i = 0; i < weights.size(); ++i)
+    {
+        accumulated += weights[i];
+        const std::size_t boundary = static_cast<std::size_t>(std::round(num_iterations * accumulated / total));
+        //clamp so that every chunk keeps at least one iteration and none runs past the end
+        const std::size_t min_boundary = boundaries[i] + 1;
+        const std::size_t max_boundary = num_iterations - (weights.size() - 1 - i);
+        boundaries[i + 1]              = std::min(std::max(boundary, min_boundary), max_boundary);
+    }
+    boundaries.back() = num_iterations;
+    return boundaries;
+}
+
+KernelThroughputTracker &KernelThroughputTracker::get()
+{
+    static KernelThroughputTracker tracker;
+    return tracker;
+}
+
+void KernelThroughputTracker::record(const char *kernel_name, unsigned int thread_id, std::size_t iterations, uint64_t duration_ns)
+{
+    if(kernel_name == nullptr || iterations == 0 || duration_ns == 0)
+    {
+        return;
+    }
+    const double throughput = iterations / static_cast<double>(duration_ns);
+
+    // Smoothing factor of the exponential moving average: low enough to ride out
+    // one-off outliers (migrations, frequency ramps), high enough to follow a
+    // sustained change of core speed within a few kernel invocations.
+    constexpr double alpha = 0.2;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<double> &ema = _ema_iterations_per_ns[kernel_name];
+    if(ema.size() <= thread_id)
+    {
+        ema.resize(thread_id + 1, 0.);
+    }
+    ema[thread_id] = (ema[thread_id] == 0.) ? throughput : alpha * throughput + (1. - alpha) * ema[thread_id];
+}
+
+std::vector<double> KernelThroughputTracker::weights(const char *kernel_name, unsigned int num_threads)
+{
+    if(kernel_name == nullptr || num_threads == 0)
+    {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto                  it = _ema_iterations_per_ns.find(kernel_name);
+    if(it == _ema_iterations_per_ns.end() || it->second.size() < num_threads)
+    {
+        return {};
+    }
+
+    std::vector<double> result(it->second.begin(), it->second.begin() + num_threads);
+    double              total = 0.;
+    for(double w : result)
+    {
+        if(w == 0.)
+        {
+            //one of the threads has not run this kernel type yet
+            return {};
+        }
+        total += w;
+    }
+    for(double &w : result)
+    {
+        w *= num_threads / total;
+    }
+    return result;
+}
 #endif /* #ifndef BARE_METAL */
 } // namespace scheduler_utils
 } // namespace arm_compute
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020 Arm Limited.
+ * Copyright (c) 2020-2021 Arm Limited.
  *
  * SPDX-License-Identifier: MIT
  *
@@ -25,7 +25,12 @@
 #define SRC_COMPUTE_SCHEDULER_UTILS_H
 
 #include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace arm_compute
 {
@@ -40,6 +45,42 @@ namespace scheduler_utils
  * @returns [m_nthreads, n_nthreads] A pair of the threads that should be used in each dimension
  */
 std::pair<unsigned, unsigned> split_2d(unsigned max_threads, std::size_t m, std::size_t n);
+
+/** Split @p num_iterations into one contiguous chunk per weight, with the size of each
+ * chunk proportional to its weight. Every chunk is guaranteed at least one iteration,
+ * therefore @p num_iterations must be greater than or equal to the number of weights.
+ *
+ * @returns Chunk boundaries: a vector of weights size + 1 entries where chunk i spans
+ *          iterations [boundaries[i], boundaries[i + 1])
+ */
+std::vector<std::size_t> split_proportional(std::size_t num_iterations, const std::vector<double> &weights);
+
+/** Tracks the measured per-thread throughput of each kernel type as an exponential
+ * moving average, so that schedulers can bias the work distribution towards the
+ * faster cores of heterogeneous (big.LITTLE) systems.
+ */
+class KernelThroughputTracker
+{
+public:
+    /** Access the process-wide tracker */
+    static KernelThroughputTracker &get();
+    /** Fold the measurement of @p iterations processed in @p duration_ns by @p thread_id
+     * into the moving average kept for @p kernel_name.
+     */
+    void record(const char *kernel_name, unsigned int thread_id, std::size_t iterations, uint64_t duration_ns);
+    /** Per-thread splitting weights for @p kernel_name, normalised to sum to @p num_threads.
+     *
+     * @returns An empty vector when any of the first @p num_threads threads has no
+     *          measurement for this kernel type yet.
+     */
+    std::vector<double> weights(const char *kernel_name, unsigned int num_threads);
+
+private:
+    KernelThroughputTracker() = default;
+
+    std::mutex _mutex{};
+    std::map<std::string, std::vector<double>> _ema_iterations_per_ns{};
+};
 } // namespace scheduler_utils
 } // namespace arm_compute
 #endif /* SRC_COMPUTE_SCHEDULER_UTILS_H */
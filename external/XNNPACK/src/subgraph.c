@@ -863,6 +863,65 @@ enum xnn_status xnn_subgraph_optimize(
             break;
         }
       }
+      // Try to fuse Add Node with a static bias-shaped addend upstream into a bias-less
+      // [Depthwise] Convolution 2D or Fully Connected Node as its bias input
+      if (consumer->type == xnn_node_type_add2) {
+        assert(consumer->num_inputs == 2);
+        assert(consumer->num_outputs == 1);
+
+        uint32_t addend_id = XNN_INVALID_VALUE_ID;
+        if (consumer->inputs[0] == i) {
+          addend_id = consumer->inputs[1];
+        } else if (consumer->inputs[1] == i) {
+          addend_id = consumer->inputs[0];
+        }
+
+        switch (producer->type) {
+          case xnn_node_type_convolution_2d:
+          case xnn_node_type_depthwise_convolution_2d:
+          case xnn_node_type_fully_connected:
+            if (addend_id != XNN_INVALID_VALUE_ID && producer->num_inputs == 2 &&
+                producer->activation.output_min == -INFINITY &&
+                producer->activation.output_max == INFINITY)
+            {
+              assert(addend_id < subgraph->num_values);
+              const struct xnn_value* addend = &subgraph->values[addend_id];
+              // The addend must be static, FP32 (quantized addends would require requantizing
+              // the packed weights), and shaped like the producer's bias: one value per output
+              // channel. The producer must not have a fused activation yet, as its activation
+              // would apply before the addition.
+              if (addend->data != NULL && addend->datatype == xnn_datatype_fp32 &&
+                  value->datatype == xnn_datatype_fp32 &&
+                  addend->shape.num_dims == 1 && value->shape.num_dims != 0 &&
+                  addend->shape.dim[0] == value->shape.dim[value->shape.num_dims - 1])
+              {
+                xnn_log_info("fuse Add Node #%"PRIu32" into upstream Node #%"PRIu32" as bias",
+                  consumer_id, producer_id);
+                assert(producer->num_outputs == 1);
+
+                producer->inputs[2] = addend_id;
+                producer->num_inputs = 3;
+
+                const uint32_t fused_output_id = consumer->outputs[0];
+                assert(fused_output_id < subgraph->num_values);
+                subgraph->values[fused_output_id].producer = producer_id;
+                producer->outputs[0] = fused_output_id;
+
+                producer->activation = consumer->activation;
+
+                if (subgraph->values[addend_id].first_consumer == consumer_id) {
+                  subgraph->values[addend_id].first_consumer = producer_id;
+                }
+
+                xnn_node_clear(consumer);
+                xnn_value_clear(value);
+              }
+            }
+            break;
+          default:
+            break;
+        }
+      }
       // Try to fuse Constant Pad node downstream into [Depthwise] Convolution 2D Node
       if (producer->type == xnn_node_type_static_constant_pad) {
         assert(producer->num_inputs == 1);
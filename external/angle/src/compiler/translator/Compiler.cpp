@@ -16,6 +16,7 @@
 #include "compiler/translator/IsASTDepthBelowLimit.h"
 #include "compiler/translator/OutputTree.h"
 #include "compiler/translator/ParseContext.h"
+#include "compiler/translator/TranslationCache.h"
 #include "compiler/translator/ValidateBarrierFunctionCall.h"
 #include "compiler/translator/ValidateClipCullDistance.h"
 #include "compiler/translator/ValidateLimitations.h"
@@ -1163,6 +1164,40 @@ bool TCompiler::compile(const char *const shaderStrings[],
         compileOptions |= SH_FLATTEN_PRAGMA_STDGL_INVARIANT_ALL;
     }
 
+    // Identical sources are commonly presented over and over again, once per context; consult the
+    // translation cache before running the parser.  Translation is deterministic in the inputs
+    // covered by the key, so restoring cached results is equivalent to recompiling.
+    std::string cacheKey;
+    const bool useTranslationCache = supportsTranslationCache();
+    if (useTranslationCache)
+    {
+        cacheKey = TranslationCache::BuildKey(shaderStrings, numStrings, compileOptions,
+                                              mShaderType, mShaderSpec, mOutputType,
+                                              mResources.HashFunction, mBuiltInResourcesString);
+        TranslationCacheEntry cacheEntry;
+        if (TranslationCache::GetInstance()->find(cacheKey, &cacheEntry))
+        {
+            restoreTranslationCacheEntry(cacheEntry);
+            return cacheEntry.compileSucceeded;
+        }
+    }
+
+    const bool compileSucceeded = compileWithOptions(shaderStrings, numStrings, compileOptions);
+
+    if (useTranslationCache)
+    {
+        TranslationCacheEntry cacheEntry;
+        captureTranslationCacheEntry(compileSucceeded, &cacheEntry);
+        TranslationCache::GetInstance()->insert(cacheKey, cacheEntry);
+    }
+
+    return compileSucceeded;
+}
+
+bool TCompiler::compileWithOptions(const char *const shaderStrings[],
+                                   size_t numStrings,
+                                   ShCompileOptions compileOptions)
+{
     TScopedPoolAllocator scopedAlloc(&allocator);
     TIntermBlock *root = compileTreeImpl(shaderStrings, numStrings, compileOptions);
 
@@ -1415,6 +1450,121 @@ void TCompiler::clearResults()
     mSymbolTable.clearCompilationResults();
 }
 
+void TCompiler::captureTranslationCacheEntry(bool compileSucceeded,
+                                             TranslationCacheEntry *entryOut) const
+{
+    entryOut->compileSucceeded = compileSucceeded;
+    entryOut->compileOptions   = mCompileOptions;
+
+    entryOut->infoLog  = mInfoSink.info.str();
+    entryOut->debugLog = mInfoSink.debug.str();
+    if (mInfoSink.obj.isBinary())
+    {
+        entryOut->objBinary = mInfoSink.obj.getBinary();
+    }
+    else
+    {
+        entryOut->objCode = mInfoSink.obj.str();
+    }
+
+    entryOut->shaderVersion = mShaderVersion;
+
+    entryOut->attributes          = mAttributes;
+    entryOut->outputVariables     = mOutputVariables;
+    entryOut->uniforms            = mUniforms;
+    entryOut->inputVaryings       = mInputVaryings;
+    entryOut->outputVaryings      = mOutputVaryings;
+    entryOut->sharedVariables     = mSharedVariables;
+    entryOut->interfaceBlocks     = mInterfaceBlocks;
+    entryOut->uniformBlocks       = mUniformBlocks;
+    entryOut->shaderStorageBlocks = mShaderStorageBlocks;
+    entryOut->variablesCollected  = mVariablesCollected;
+
+    entryOut->earlyFragmentTestsSpecified = mEarlyFragmentTestsSpecified;
+    entryOut->earlyFragmentTestsOptimized = mEarlyFragmentTestsOptimized;
+    entryOut->specConstUsageBits          = mSpecConstUsageBits;
+
+    entryOut->computeShaderLocalSizeDeclared = mComputeShaderLocalSizeDeclared;
+    entryOut->computeShaderLocalSize         = mComputeShaderLocalSize;
+
+    entryOut->numViews = mNumViews;
+
+    entryOut->geometryShaderMaxVertices          = mGeometryShaderMaxVertices;
+    entryOut->geometryShaderInvocations          = mGeometryShaderInvocations;
+    entryOut->geometryShaderInputPrimitiveType   = mGeometryShaderInputPrimitiveType;
+    entryOut->geometryShaderOutputPrimitiveType  = mGeometryShaderOutputPrimitiveType;
+
+    entryOut->tessControlShaderOutputVertices            = mTessControlShaderOutputVertices;
+    entryOut->tessEvaluationShaderInputPrimitiveType     = mTessEvaluationShaderInputPrimitiveType;
+    entryOut->tessEvaluationShaderInputVertexSpacingType =
+        mTessEvaluationShaderInputVertexSpacingType;
+    entryOut->tessEvaluationShaderInputOrderingType = mTessEvaluationShaderInputOrderingType;
+    entryOut->tessEvaluationShaderInputPointType    = mTessEvaluationShaderInputPointType;
+
+    entryOut->hasAnyPreciseType      = mHasAnyPreciseType;
+    entryOut->advancedBlendEquations = mAdvancedBlendEquations;
+
+    entryOut->nameMap = mNameMap;
+    entryOut->pragma  = mPragma;
+}
+
+void TCompiler::restoreTranslationCacheEntry(const TranslationCacheEntry &entry)
+{
+    clearResults();
+
+    mCompileOptions = entry.compileOptions;
+
+    mInfoSink.info << entry.infoLog;
+    mInfoSink.debug << entry.debugLog;
+    if (!entry.objBinary.empty())
+    {
+        mInfoSink.obj.setBinary(BinaryBlob(entry.objBinary));
+    }
+    else
+    {
+        mInfoSink.obj << entry.objCode;
+    }
+
+    mShaderVersion = entry.shaderVersion;
+
+    mAttributes          = entry.attributes;
+    mOutputVariables     = entry.outputVariables;
+    mUniforms            = entry.uniforms;
+    mInputVaryings       = entry.inputVaryings;
+    mOutputVaryings      = entry.outputVaryings;
+    mSharedVariables     = entry.sharedVariables;
+    mInterfaceBlocks     = entry.interfaceBlocks;
+    mUniformBlocks       = entry.uniformBlocks;
+    mShaderStorageBlocks = entry.shaderStorageBlocks;
+    mVariablesCollected  = entry.variablesCollected;
+
+    mEarlyFragmentTestsSpecified = entry.earlyFragmentTestsSpecified;
+    mEarlyFragmentTestsOptimized = entry.earlyFragmentTestsOptimized;
+    mSpecConstUsageBits          = entry.specConstUsageBits;
+
+    mComputeShaderLocalSizeDeclared = entry.computeShaderLocalSizeDeclared;
+    mComputeShaderLocalSize         = entry.computeShaderLocalSize;
+
+    mNumViews = entry.numViews;
+
+    mGeometryShaderMaxVertices         = entry.geometryShaderMaxVertices;
+    mGeometryShaderInvocations         = entry.geometryShaderInvocations;
+    mGeometryShaderInputPrimitiveType  = entry.geometryShaderInputPrimitiveType;
+    mGeometryShaderOutputPrimitiveType = entry.geometryShaderOutputPrimitiveType;
+
+    mTessControlShaderOutputVertices            = entry.tessControlShaderOutputVertices;
+    mTessEvaluationShaderInputPrimitiveType     = entry.tessEvaluationShaderInputPrimitiveType;
+    mTessEvaluationShaderInputVertexSpacingType = entry.tessEvaluationShaderInputVertexSpacingType;
+    mTessEvaluationShaderInputOrderingType      = entry.tessEvaluationShaderInputOrderingType;
+    mTessEvaluationShaderInputPointType         = entry.tessEvaluationShaderInputPointType;
+
+    mHasAnyPreciseType      = entry.hasAnyPreciseType;
+    mAdvancedBlendEquations = entry.advancedBlendEquations;
+
+    mNameMap = entry.nameMap;
+    mPragma  = entry.pragma;
+}
+
 bool TCompiler::initCallDag(TIntermNode *root)
 {
     mCallDag.clear();
@@ -32,6 +32,7 @@ namespace sh
 
 class TCompiler;
 class TParseContext;
+struct TranslationCacheEntry;
 #ifdef ANGLE_ENABLE_HLSL
 class TranslatorHLSL;
 #endif  // ANGLE_ENABLE_HLSL
@@ -222,6 +223,11 @@ class TCompiler : public TShHandleBase
     virtual bool shouldFlattenPragmaStdglInvariantAll() = 0;
     virtual bool shouldCollectVariables(ShCompileOptions compileOptions);
 
+    // Whether the complete results of a compile can be captured and restored by the translation
+    // cache.  Translators that keep results outside TCompiler (such as TranslatorHLSL's register
+    // maps) must opt out.
+    virtual bool supportsTranslationCache() const { return true; }
+
     bool wereVariablesCollected() const;
     std::vector<sh::ShaderVariable> mAttributes;
     std::vector<sh::ShaderVariable> mOutputVariables;
@@ -279,6 +285,16 @@ class TCompiler : public TShHandleBase
                                   size_t numStrings,
                                   const ShCompileOptions compileOptions);
 
+    // Runs an actual compile, used when the translation cache misses (or is unsupported).
+    bool compileWithOptions(const char *const shaderStrings[],
+                            size_t numStrings,
+                            ShCompileOptions compileOptions);
+
+    // Translation cache support; see TranslationCache.h.
+    void captureTranslationCacheEntry(bool compileSucceeded,
+                                      TranslationCacheEntry *entryOut) const;
+    void restoreTranslationCacheEntry(const TranslationCacheEntry &entry);
+
     // Fetches and stores shader metadata that is not stored within the AST itself, such as shader
     // version.
     void setASTMetadata(const TParseContext &parseContext);
@@ -0,0 +1,81 @@
+//
+// Copyright 2022 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// TranslationCache.cpp: A process-wide cache of complete translation results.
+
+#include "compiler/translator/TranslationCache.h"
+
+#include <cstring>
+
+namespace sh
+{
+
+// static
+TranslationCache *TranslationCache::GetInstance()
+{
+    static TranslationCache *instance = new TranslationCache;
+    return instance;
+}
+
+// static
+std::string TranslationCache::BuildKey(const char *const shaderStrings[],
+                                       size_t numStrings,
+                                       ShCompileOptions compileOptions,
+                                       sh::GLenum shaderType,
+                                       ShShaderSpec shaderSpec,
+                                       ShShaderOutput outputType,
+                                       ShHashFunction64 hashFunction,
+                                       const std::string &builtInResourcesString)
+{
+    size_t sourcesLength = 0;
+    for (size_t i = 0; i < numStrings; ++i)
+    {
+        sourcesLength += strlen(shaderStrings[i]) + 1;
+    }
+
+    std::string key;
+    key.reserve(sourcesLength + builtInResourcesString.size() + 64);
+
+    // Separate the strings with NUL so that differently split but otherwise identical sources
+    // don't collide.
+    for (size_t i = 0; i < numStrings; ++i)
+    {
+        key.append(shaderStrings[i]);
+        key.push_back('\0');
+    }
+
+    TPersistStringStream metadata = InitializeStream<TPersistStringStream>();
+    metadata << shaderType << ':' << shaderSpec << ':' << outputType << ':' << compileOptions
+             << ':' << reinterpret_cast<uintptr_t>(hashFunction);
+    key.append(metadata.str());
+    key.push_back('\0');
+    key.append(builtInResourcesString);
+
+    return key;
+}
+
+bool TranslationCache::find(const std::string &key, TranslationCacheEntry *entryOut)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto iter = mEntries.find(key);
+    if (iter == mEntries.end())
+    {
+        return false;
+    }
+    *entryOut = iter->second;
+    return true;
+}
+
+void TranslationCache::insert(const std::string &key, const TranslationCacheEntry &entry)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mEntries.size() >= kMaxEntries)
+    {
+        mEntries.clear();
+    }
+    mEntries[key] = entry;
+}
+
+}  // namespace sh
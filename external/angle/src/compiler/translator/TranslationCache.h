@@ -0,0 +1,116 @@
+//
+// Copyright 2022 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// TranslationCache.h: A process-wide cache of complete translation results.  Workloads such as
+// WebView hand identical GLSL sources to many contexts; a hit returns the previously produced
+// object code and shader metadata without running the parser or the output generators.
+
+#ifndef COMPILER_TRANSLATOR_TRANSLATIONCACHE_H_
+#define COMPILER_TRANSLATOR_TRANSLATIONCACHE_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/angleutils.h"
+#include "compiler/translator/Compiler.h"
+
+namespace sh
+{
+
+// Snapshot of every per-compile output of TCompiler.  See TCompiler::clearResults for the
+// authoritative list of what a compile produces; the fields here mirror it, plus the metadata
+// set by TCompiler::setASTMetadata.
+struct TranslationCacheEntry
+{
+    bool compileSucceeded = false;
+
+    // The effective options of the compile, after per-translator workarounds were applied.
+    ShCompileOptions compileOptions = 0;
+
+    // TInfoSink contents.  The object sink holds either text or a binary blob.
+    TPersistString infoLog;
+    TPersistString debugLog;
+    TPersistString objCode;
+    BinaryBlob objBinary;
+
+    int shaderVersion = 100;
+
+    std::vector<ShaderVariable> attributes;
+    std::vector<ShaderVariable> outputVariables;
+    std::vector<ShaderVariable> uniforms;
+    std::vector<ShaderVariable> inputVaryings;
+    std::vector<ShaderVariable> outputVaryings;
+    std::vector<ShaderVariable> sharedVariables;
+    std::vector<InterfaceBlock> interfaceBlocks;
+    std::vector<InterfaceBlock> uniformBlocks;
+    std::vector<InterfaceBlock> shaderStorageBlocks;
+    bool variablesCollected = false;
+
+    bool earlyFragmentTestsSpecified = false;
+    bool earlyFragmentTestsOptimized = false;
+    SpecConstUsageBits specConstUsageBits;
+
+    bool computeShaderLocalSizeDeclared = false;
+    WorkGroupSize computeShaderLocalSize;
+
+    int numViews = -1;
+
+    int geometryShaderMaxVertices                          = -1;
+    int geometryShaderInvocations                          = 0;
+    TLayoutPrimitiveType geometryShaderInputPrimitiveType  = EptUndefined;
+    TLayoutPrimitiveType geometryShaderOutputPrimitiveType = EptUndefined;
+
+    int tessControlShaderOutputVertices                                  = 0;
+    TLayoutTessEvaluationType tessEvaluationShaderInputPrimitiveType     = EtetUndefined;
+    TLayoutTessEvaluationType tessEvaluationShaderInputVertexSpacingType = EtetUndefined;
+    TLayoutTessEvaluationType tessEvaluationShaderInputOrderingType      = EtetUndefined;
+    TLayoutTessEvaluationType tessEvaluationShaderInputPointType         = EtetUndefined;
+
+    bool hasAnyPreciseType                        = false;
+    AdvancedBlendEquations advancedBlendEquations = AdvancedBlendEquations(0);
+
+    NameMap nameMap;
+    TPragma pragma;
+};
+
+class TranslationCache : angle::NonCopyable
+{
+  public:
+    static TranslationCache *GetInstance();
+
+    // Builds the lookup key for a compile.  The key covers everything the translation output can
+    // depend on: the source strings (including the source path when SH_SOURCE_PATH is used), the
+    // compile options, and the compiler's type, spec, output type, name hashing function and
+    // built-in resources.
+    static std::string BuildKey(const char *const shaderStrings[],
+                                size_t numStrings,
+                                ShCompileOptions compileOptions,
+                                sh::GLenum shaderType,
+                                ShShaderSpec shaderSpec,
+                                ShShaderOutput outputType,
+                                ShHashFunction64 hashFunction,
+                                const std::string &builtInResourcesString);
+
+    // Returns true and copies the cached results into *entryOut on a hit.
+    bool find(const std::string &key, TranslationCacheEntry *entryOut);
+
+    void insert(const std::string &key, const TranslationCacheEntry &entry);
+
+  private:
+    TranslationCache() = default;
+
+    std::mutex mMutex;
+    // Bounded map from BuildKey output to results.  Shader churn beyond the bound is handled by
+    // dropping the whole map; an LRU would retain slightly more, but translating a missed shader
+    // is cheap enough that the simpler policy wins.
+    std::unordered_map<std::string, TranslationCacheEntry> mEntries;
+    static constexpr size_t kMaxEntries = 256;
+};
+
+}  // namespace sh
+
+#endif  // COMPILER_TRANSLATOR_TRANSLATIONCACHE_H_
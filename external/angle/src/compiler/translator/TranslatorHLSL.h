@@ -37,6 +37,9 @@ class TranslatorHLSL : public TCompiler
                                     PerformanceDiagnostics *perfDiagnostics) override;
     bool shouldFlattenPragmaStdglInvariantAll() override;
 
+    // The register maps below live outside TCompiler, so cached results can't restore them.
+    bool supportsTranslationCache() const override { return false; }
+
     // collectVariables needs to be run always so registers can be assigned.
     bool shouldCollectVariables(ShCompileOptions compileOptions) override { return true; }
 
@@ -9724,7 +9724,13 @@ StateCache::StateCache()
       mCachedBasicDrawStatesError(kInvalidPointer),
       mCachedBasicDrawElementsError(kInvalidPointer),
       mCachedTransformFeedbackActiveUnpaused(false),
-      mCachedCanDraw(false)
+      mCachedCanDraw(false),
+      mHasValidatedDrawElementsSignature(false),
+      mValidatedDrawElementsMode(PrimitiveMode::InvalidEnum),
+      mValidatedDrawElementsCount(0),
+      mValidatedDrawElementsType(DrawElementsType::InvalidEnum),
+      mValidatedDrawElementsIndices(nullptr),
+      mValidatedDrawElementsPrimcount(0)
 {
     mCachedValidDrawModes.fill(false);
 }
@@ -9733,6 +9739,8 @@ StateCache::~StateCache() = default;
 
 ANGLE_INLINE void StateCache::updateVertexElementLimits(Context *context)
 {
+    invalidateValidatedDrawElementsSignature();
+
     if (context->isBufferAccessValidationEnabled())
     {
         updateVertexElementLimitsImpl(context);
@@ -9824,11 +9832,13 @@ void StateCache::updateVertexElementLimitsImpl(Context *context)
 void StateCache::updateBasicDrawStatesError()
 {
     mCachedBasicDrawStatesError = kInvalidPointer;
+    invalidateValidatedDrawElementsSignature();
 }
 
 void StateCache::updateBasicDrawElementsError()
 {
     mCachedBasicDrawElementsError = kInvalidPointer;
+    invalidateValidatedDrawElementsSignature();
 }
 
 intptr_t StateCache::getBasicDrawStatesErrorImpl(const Context *context) const
@@ -9985,6 +9995,8 @@ void StateCache::setValidDrawModes(bool pointsOK,
 
 void StateCache::updateValidDrawModes(Context *context)
 {
+    invalidateValidatedDrawElementsSignature();
+
     const State &state = context->getState();
 
     const ProgramExecutable *programExecutable = context->getState().getProgramExecutable();
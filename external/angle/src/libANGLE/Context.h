@@ -201,6 +201,37 @@ class StateCache final : angle::NonCopyable
         return getBasicDrawElementsErrorImpl(context);
     }
 
+    // Signature of the last fully validated draw-elements call.  Every state change that could
+    // affect the outcome of ValidateDrawElementsCommon funnels through
+    // updateBasicDrawStatesError, updateBasicDrawElementsError, updateValidDrawModes or
+    // updateVertexElementLimits, each of which drops the signature.  Consecutive draws with an
+    // unchanged signature can therefore skip parameter re-validation entirely.
+    bool matchesValidatedDrawElementsSignature(PrimitiveMode mode,
+                                               GLsizei count,
+                                               DrawElementsType type,
+                                               const void *indices,
+                                               GLsizei primcount) const
+    {
+        return mHasValidatedDrawElementsSignature && mValidatedDrawElementsMode == mode &&
+               mValidatedDrawElementsCount == count && mValidatedDrawElementsType == type &&
+               mValidatedDrawElementsIndices == indices &&
+               mValidatedDrawElementsPrimcount == primcount;
+    }
+
+    void setValidatedDrawElementsSignature(PrimitiveMode mode,
+                                           GLsizei count,
+                                           DrawElementsType type,
+                                           const void *indices,
+                                           GLsizei primcount) const
+    {
+        mHasValidatedDrawElementsSignature = true;
+        mValidatedDrawElementsMode         = mode;
+        mValidatedDrawElementsCount        = count;
+        mValidatedDrawElementsType         = type;
+        mValidatedDrawElementsIndices      = indices;
+        mValidatedDrawElementsPrimcount    = primcount;
+    }
+
     // Places that can trigger updateValidDrawModes:
     // 1. onProgramExecutableChange.
     // 2. onActiveTransformFeedbackChange.
@@ -300,6 +331,11 @@ class StateCache final : angle::NonCopyable
                            bool triAdjOK,
                            bool patchOK);
 
+    void invalidateValidatedDrawElementsSignature()
+    {
+        mHasValidatedDrawElementsSignature = false;
+    }
+
     intptr_t getBasicDrawStatesErrorImpl(const Context *context) const;
     intptr_t getBasicDrawElementsErrorImpl(const Context *context) const;
 
@@ -334,6 +370,15 @@ class StateCache final : angle::NonCopyable
         mCachedIntegerVertexAttribTypesValidation;
 
     bool mCachedCanDraw;
+
+    // See matchesValidatedDrawElementsSignature.  Mutable so that validation, which only sees a
+    // const Context, can record the signature (same idiom as the cached error states above).
+    mutable bool mHasValidatedDrawElementsSignature;
+    mutable PrimitiveMode mValidatedDrawElementsMode;
+    mutable GLsizei mValidatedDrawElementsCount;
+    mutable DrawElementsType mValidatedDrawElementsType;
+    mutable const void *mValidatedDrawElementsIndices;
+    mutable GLsizei mValidatedDrawElementsPrimcount;
 };
 
 using VertexArrayMap       = ResourceMap<VertexArray, VertexArrayID>;
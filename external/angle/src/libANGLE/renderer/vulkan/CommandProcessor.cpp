@@ -411,11 +411,13 @@ angle::Result CommandProcessor::checkAndPopPendingError(Context *errorHandlingCo
 void CommandProcessor::queueCommand(CommandProcessorTask &&task)
 {
     ANGLE_TRACE_EVENT0("gpu.angle", "CommandProcessor::queueCommand");
-    // Grab the worker mutex so that we put things on the queue in the same order as we give out
-    // serials.
-    std::lock_guard<std::mutex> queueLock(mWorkerMutex);
-
-    mTasks.emplace(std::move(task));
+    {
+        // Grab the worker mutex so that we put things on the queue in the same order as we give
+        // out serials.
+        std::lock_guard<std::mutex> queueLock(mWorkerMutex);
+        mTasks.emplace(std::move(task));
+    }
+    // Notify after releasing the mutex so the worker doesn't wake up just to block on it.
     mWorkAvailableCondition.notify_one();
 }
 
@@ -443,27 +445,40 @@ void CommandProcessor::processTasks()
 
 angle::Result CommandProcessor::processTasksImpl(bool *exitThread)
 {
+    // Tasks drained from the shared queue; processed without holding the worker mutex. Note that
+    // waitForWorkComplete() stays correct because mWorkerThreadIdle is only set back to true once
+    // both the shared queue and this batch are exhausted.
+    std::queue<CommandProcessorTask> drainedTasks;
     while (true)
     {
-        std::unique_lock<std::mutex> lock(mWorkerMutex);
-        if (mTasks.empty())
+        if (drainedTasks.empty())
         {
-            mWorkerThreadIdle = true;
-            mWorkerIdleCondition.notify_all();
-            // Only wake if notified and command queue is not empty
-            mWorkAvailableCondition.wait(lock, [this] { return !mTasks.empty(); });
+            std::unique_lock<std::mutex> lock(mWorkerMutex);
+            if (mTasks.empty())
+            {
+                mWorkerThreadIdle = true;
+                mWorkerIdleCondition.notify_all();
+                // Only wake if notified and command queue is not empty
+                mWorkAvailableCondition.wait(lock, [this] { return !mTasks.empty(); });
+            }
+            mWorkerThreadIdle = false;
+            // Drain the whole queue in one critical section instead of retaking the lock per
+            // task. The recording thread enqueues one task per command buffer flush, so on
+            // draw-heavy frames this keeps the two threads off each other's locks while the
+            // worker replays the backlog.
+            std::swap(drainedTasks, mTasks);
         }
-        mWorkerThreadIdle = false;
-        CommandProcessorTask task(std::move(mTasks.front()));
-        mTasks.pop();
-        lock.unlock();
+        CommandProcessorTask task(std::move(drainedTasks.front()));
+        drainedTasks.pop();
 
         ANGLE_TRY(processTask(&task));
         if (task.getTaskCommand() == CustomTask::Exit)
         {
+            // Exit is the last task ever queued; nothing can be pending behind it.
+            ASSERT(drainedTasks.empty());
 
             *exitThread = true;
-            lock.lock();
+            std::lock_guard<std::mutex> lock(mWorkerMutex);
             mWorkerThreadIdle = true;
             mWorkerIdleCondition.notify_one();
             return angle::Result::Continue;
@@ -637,7 +652,8 @@ bool CommandProcessor::isBusy() const
 {
     std::lock_guard<std::mutex> serialLock(mQueueSerialMutex);
     std::lock_guard<std::mutex> workerLock(mWorkerMutex);
-    return !mTasks.empty() || mCommandQueue.isBusy();
+    // !mWorkerThreadIdle covers tasks the worker has drained from mTasks but not yet processed.
+    return !mTasks.empty() || !mWorkerThreadIdle || mCommandQueue.isBusy();
 }
 
 Serial CommandProcessor::reserveSubmitSerial()
@@ -2455,7 +2455,8 @@ DynamicBuffer::DynamicBuffer()
       mNextAllocationOffset(0),
       mSize(0),
       mAlignment(0),
-      mMemoryPropertyFlags(0)
+      mMemoryPropertyFlags(0),
+      mRetireGeneration(0)
 {}
 
 DynamicBuffer::DynamicBuffer(DynamicBuffer &&other)
@@ -2468,7 +2469,9 @@ DynamicBuffer::DynamicBuffer(DynamicBuffer &&other)
       mAlignment(other.mAlignment),
       mMemoryPropertyFlags(other.mMemoryPropertyFlags),
       mInFlightBuffers(std::move(other.mInFlightBuffers)),
-      mBufferFreeList(std::move(other.mBufferFreeList))
+      mBufferFreeList(std::move(other.mBufferFreeList)),
+      mRetiredBuffers(std::move(other.mRetiredBuffers)),
+      mRetireGeneration(other.mRetireGeneration)
 {}
 
 void DynamicBuffer::init(RendererVk *renderer,
@@ -2504,6 +2507,7 @@ DynamicBuffer::~DynamicBuffer()
     ASSERT(mBuffer == nullptr);
     ASSERT(mInFlightBuffers.empty());
     ASSERT(mBufferFreeList.empty());
+    ASSERT(mRetiredBuffers.empty());
 }
 
 angle::Result DynamicBuffer::allocateNewBuffer(Context *context)
@@ -2582,17 +2586,48 @@ angle::Result DynamicBuffer::allocate(Context *context,
     const size_t sizeIgnoringHistory = std::max(mInitialSize, sizeToAllocate);
     if (sizeToAllocate > mSize || sizeIgnoringHistory < mSize / 4)
     {
-        mSize = sizeIgnoringHistory;
-        // Clear the free list since the free buffers are now either too small or too big.
-        ReleaseBufferListToRenderer(renderer, &mBufferFreeList);
+        // Round the new size up to the next power-of-two multiple of the initial size. This keeps
+        // the set of size classes small as the stream grows and shrinks, so retired buffers can be
+        // recycled when the stream returns to a class it has used before.
+        size_t newSize = std::max<size_t>(mInitialSize, 1);
+        while (newSize < sizeIgnoringHistory)
+        {
+            newSize <<= 1;
+        }
+        mSize = newSize;
+
+        // The free buffers are now either too small or too big; retire them instead of releasing
+        // them right away, in case the stream comes back to their size class.
+        retireBufferFreeList();
     }
 
+    pruneRetiredBuffers(renderer);
+
     // The front of the free list should be the oldest. Thus if it is in use the rest of the
     // free list should be in use as well.
     if (mBufferFreeList.empty() ||
         mBufferFreeList.front()->isCurrentlyInUse(renderer->getLastCompletedQueueSerial()))
     {
-        ANGLE_TRY(allocateNewBuffer(context));
+        // See if a previously retired buffer matches the current size class and is no longer in
+        // use; if so recycle it rather than allocating fresh device memory.
+        bool recycled = false;
+        for (auto retiredIter = mRetiredBuffers.begin(); retiredIter != mRetiredBuffers.end();
+             ++retiredIter)
+        {
+            if (retiredIter->buffer->getBlockMemorySize() == mSize &&
+                !retiredIter->buffer->isCurrentlyInUse(renderer->getLastCompletedQueueSerial()))
+            {
+                mBuffer = std::move(retiredIter->buffer);
+                mRetiredBuffers.erase(retiredIter);
+                recycled = true;
+                break;
+            }
+        }
+
+        if (!recycled)
+        {
+            ANGLE_TRY(allocateNewBuffer(context));
+        }
     }
     else
     {
@@ -2619,6 +2654,12 @@ void DynamicBuffer::release(RendererVk *renderer)
     ReleaseBufferListToRenderer(renderer, &mInFlightBuffers);
     ReleaseBufferListToRenderer(renderer, &mBufferFreeList);
 
+    for (RetiredBuffer &retired : mRetiredBuffers)
+    {
+        retired.buffer->release(renderer);
+    }
+    mRetiredBuffers.clear();
+
     if (mBuffer)
     {
         mBuffer->release(renderer);
@@ -2636,11 +2677,12 @@ void DynamicBuffer::releaseInFlightBuffersToResourceUseList(ContextVk *contextVk
         // unfortunately.
         bufferHelper->retainReadOnly(resourceUseList);
 
-        // We only keep free buffers that have the same size. Note that bufferHelper's size is
-        // suballocation's size. We need to use the whole block memory size here.
+        // Only buffers that have the same size go back on the free list; others are retired and
+        // may be recycled if the stream returns to their size class. Note that bufferHelper's size
+        // is suballocation's size. We need to use the whole block memory size here.
         if (bufferHelper->getBlockMemorySize() != mSize)
         {
-            bufferHelper->release(contextVk->getRenderer());
+            mRetiredBuffers.push_back({std::move(bufferHelper), mRetireGeneration});
         }
         else
         {
@@ -2648,6 +2690,43 @@ void DynamicBuffer::releaseInFlightBuffersToResourceUseList(ContextVk *contextVk
         }
     }
     mInFlightBuffers.clear();
+
+    // This is called once per flush, making it a reasonable clock for aging out retired buffers.
+    ++mRetireGeneration;
+    pruneRetiredBuffers(contextVk->getRenderer());
+}
+
+void DynamicBuffer::retireBufferFreeList()
+{
+    for (std::unique_ptr<BufferHelper> &toRetire : mBufferFreeList)
+    {
+        mRetiredBuffers.push_back({std::move(toRetire), mRetireGeneration});
+    }
+    mBufferFreeList.clear();
+}
+
+void DynamicBuffer::pruneRetiredBuffers(RendererVk *renderer)
+{
+    // The front of the list is the oldest; release from there when over the retention cap.
+    while (mRetiredBuffers.size() > kMaxRetiredBufferCount)
+    {
+        mRetiredBuffers.front().buffer->release(renderer);
+        mRetiredBuffers.erase(mRetiredBuffers.begin());
+    }
+
+    // Release buffers that have sat unrecycled for too many flushes.
+    for (auto iter = mRetiredBuffers.begin(); iter != mRetiredBuffers.end();)
+    {
+        if (mRetireGeneration - iter->retireGeneration >= kMaxRetiredBufferAge)
+        {
+            iter->buffer->release(renderer);
+            iter = mRetiredBuffers.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
 }
 
 void DynamicBuffer::destroy(RendererVk *renderer)
@@ -2657,6 +2736,12 @@ void DynamicBuffer::destroy(RendererVk *renderer)
     DestroyBufferList(renderer, &mInFlightBuffers);
     DestroyBufferList(renderer, &mBufferFreeList);
 
+    for (RetiredBuffer &retired : mRetiredBuffers)
+    {
+        retired.buffer->destroy(renderer);
+    }
+    mRetiredBuffers.clear();
+
     if (mBuffer)
     {
         mBuffer->unmap(renderer);
@@ -121,6 +121,8 @@ class DynamicBuffer : angle::NonCopyable
   private:
     void reset();
     angle::Result allocateNewBuffer(Context *context);
+    void retireBufferFreeList();
+    void pruneRetiredBuffers(RendererVk *renderer);
 
     VkBufferUsageFlags mUsage;
     bool mHostVisible;
@@ -133,6 +135,22 @@ class DynamicBuffer : angle::NonCopyable
 
     BufferHelperPointerVector mInFlightBuffers;
     BufferHelperPointerVector mBufferFreeList;
+
+    // Buffers whose size class no longer matches mSize are not released right away; streams
+    // commonly oscillate between size classes, and since size classes are powers of two of
+    // mInitialSize a retired buffer can often be recycled wholesale when the stream returns to a
+    // class it has used before.  A retired buffer that has not been recycled within
+    // kMaxRetiredBufferAge flushes is unlikely to ever be, so it is released then; the list is also
+    // capped at kMaxRetiredBufferCount to bound the memory kept alive.
+    struct RetiredBuffer
+    {
+        std::unique_ptr<BufferHelper> buffer;
+        uint32_t retireGeneration;
+    };
+    std::vector<RetiredBuffer> mRetiredBuffers;
+    uint32_t mRetireGeneration;
+    static constexpr uint32_t kMaxRetiredBufferAge = 4;
+    static constexpr size_t kMaxRetiredBufferCount = 8;
 };
 
 // Uses DescriptorPool to allocate descriptor sets as needed. If a descriptor pool becomes full, we
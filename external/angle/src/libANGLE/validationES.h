@@ -1109,6 +1109,15 @@ ANGLE_INLINE bool ValidateDrawElementsCommon(const Context *context,
                                              const void *indices,
                                              GLsizei primcount)
 {
+    // If neither the parameters nor any state that validation depends on changed since the last
+    // fully validated draw, the call is known valid; the signature is dropped by the state cache
+    // whenever a relevant state change occurs.
+    if (context->getStateCache().matchesValidatedDrawElementsSignature(mode, count, type, indices,
+                                                                       primcount))
+    {
+        return true;
+    }
+
     if (!ValidateDrawElementsBase(context, entryPoint, mode, type))
     {
         return false;
@@ -1228,7 +1237,18 @@ ANGLE_INLINE bool ValidateDrawElementsCommon(const Context *context,
         }
 
         // No op if there are no real indices in the index data (all are primitive restart).
-        return (indexRange.vertexIndexCount > 0);
+        if (indexRange.vertexIndexCount == 0)
+        {
+            return false;
+        }
+    }
+
+    // Client-side index data can be modified without a GL call, so only buffer-backed draws may
+    // skip re-validation on the next identical call.
+    if (elementArrayBuffer != nullptr)
+    {
+        context->getStateCache().setValidatedDrawElementsSignature(mode, count, type, indices,
+                                                                   primcount);
     }
 
     return true;
@@ -381,6 +381,47 @@ OPENSSL_EXPORT int EVP_AEAD_CTX_open_gather(
     size_t nonce_len, const uint8_t *in, size_t in_len, const uint8_t *in_tag,
     size_t in_tag_len, const uint8_t *ad, size_t ad_len);
 
+// EVP_AEAD_CTX_seal_batch seals |num_records| independent records in a single
+// call. Record |i| encrypts and authenticates |in_lens[i]| bytes from |ins[i]|
+// with |ad_lens[i]| bytes of additional data from |ads[i]| under the nonce
+// |nonces[i]|, writing the result to |outs[i]| with the exact semantics of
+// |EVP_AEAD_CTX_seal|. Each nonce must be |nonce_len| bytes, which must equal
+// |EVP_AEAD_nonce_length| for this AEAD.
+//
+// It returns one if every record was sealed and zero otherwise. Records are
+// processed in order and processing stops at the first failure: on return,
+// |*num_sealed| is set to the number of records sealed successfully. Outputs
+// of records before |*num_sealed| are valid, the failing record's output is
+// zeroed as with |EVP_AEAD_CTX_seal| and later records are untouched.
+//
+// Batching amortizes per-call overhead for workloads that seal many small
+// records with the same key, such as TLS record processing.
+OPENSSL_EXPORT int EVP_AEAD_CTX_seal_batch(
+    const EVP_AEAD_CTX *ctx, size_t num_records, uint8_t *const outs[],
+    size_t out_lens[], const size_t max_out_lens[],
+    const uint8_t *const nonces[], size_t nonce_len, const uint8_t *const ins[],
+    const size_t in_lens[], const uint8_t *const ads[],
+    const size_t ad_lens[], size_t *num_sealed);
+
+// EVP_AEAD_CTX_open_batch opens |num_records| independent records in a single
+// call. Record |i| authenticates and decrypts |in_lens[i]| bytes from |ins[i]|
+// with |ad_lens[i]| bytes of additional data from |ads[i]| under the nonce
+// |nonces[i]|, writing the result to |outs[i]| with the exact semantics of
+// |EVP_AEAD_CTX_open|. Each nonce must be |nonce_len| bytes, which must equal
+// |EVP_AEAD_nonce_length| for this AEAD.
+//
+// It returns one if every record was opened and zero otherwise. Records are
+// processed in order and processing stops at the first failure: on return,
+// |*num_opened| is set to the number of records opened successfully. Outputs
+// of records before |*num_opened| are valid, the failing record's output is
+// zeroed as with |EVP_AEAD_CTX_open| and later records are untouched.
+OPENSSL_EXPORT int EVP_AEAD_CTX_open_batch(
+    const EVP_AEAD_CTX *ctx, size_t num_records, uint8_t *const outs[],
+    size_t out_lens[], const size_t max_out_lens[],
+    const uint8_t *const nonces[], size_t nonce_len, const uint8_t *const ins[],
+    const size_t in_lens[], const uint8_t *const ads[],
+    const size_t ad_lens[], size_t *num_opened);
+
 // EVP_AEAD_CTX_aead returns the underlying AEAD for |ctx|, or NULL if one has
 // not been set.
 OPENSSL_EXPORT const EVP_AEAD *EVP_AEAD_CTX_aead(const EVP_AEAD_CTX *ctx);
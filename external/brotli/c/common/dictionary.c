@@ -5909,6 +5909,18 @@ void BrotliSetDictionaryData(const uint8_t* data) {
 #endif
 }
 
+static const BrotliDictionary* kBrotliCustomDictionary = NULL;
+
+const BrotliDictionary* BrotliGetCustomDictionary() {
+  return kBrotliCustomDictionary;
+}
+
+void BrotliSetCustomDictionary(const BrotliDictionary* dictionary) {
+  if (!!dictionary && !kBrotliCustomDictionary) {
+    kBrotliCustomDictionary = dictionary;
+  }
+}
+
 #if defined(__cplusplus) || defined(c_plusplus)
 }  /* extern "C" */
 #endif
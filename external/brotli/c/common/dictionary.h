@@ -54,6 +54,28 @@ BROTLI_COMMON_API const BrotliDictionary* BrotliGetDictionary(void);
  */
 BROTLI_COMMON_API void BrotliSetDictionaryData(const uint8_t* data);
 
+/**
+ * Returns the custom dictionary shared by all streams in the process,
+ * or NULL when none is attached.
+ *
+ * Custom dictionary uses the same bucketed layout as the built-in one.
+ * Encoder / decoder states attach the returned instance instead of
+ * preparing their own copy per stream, so the preparation cost of a
+ * domain-specific vocabulary is paid once per process.
+ */
+BROTLI_COMMON_API const BrotliDictionary* BrotliGetCustomDictionary(void);
+
+/**
+ * Attaches a custom dictionary shared by all streams in the process.
+ *
+ * When a custom dictionary is already attached, this method is no-op.
+ *
+ * Dictionary MUST be attached before any stream using it is created and
+ * MUST remain valid and unchanged until the process exits.
+ */
+BROTLI_COMMON_API void BrotliSetCustomDictionary(
+    const BrotliDictionary* dictionary);
+
 #define BROTLI_MIN_DICTIONARY_WORD_LENGTH 4
 #define BROTLI_MAX_DICTIONARY_WORD_LENGTH 24
 
@@ -0,0 +1,156 @@
+// Copyright 2021 The Chromium OS Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "bsdiff/parallel_bsdiff.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "bsdiff/bsdiff.h"
+#include "bsdiff/logging.h"
+#include "bsdiff/suffix_array_index.h"
+
+namespace {
+
+// A PatchWriterInterface that captures the control entries and streams of one
+// block in memory so they can be replayed into the real patch writer in block
+// order once all workers finished.
+class CapturingPatchWriter : public bsdiff::PatchWriterInterface {
+ public:
+  CapturingPatchWriter() = default;
+
+  // PatchWriterInterface overrides.
+  bool Init(size_t new_size) override { return true; }
+  bool WriteDiffStream(const uint8_t* data, size_t size) override {
+    diff_stream_.insert(diff_stream_.end(), data, data + size);
+    return true;
+  }
+  bool WriteExtraStream(const uint8_t* data, size_t size) override {
+    extra_stream_.insert(extra_stream_.end(), data, data + size);
+    return true;
+  }
+  bool AddControlEntry(const bsdiff::ControlEntry& entry) override {
+    entries_.push_back(entry);
+    return true;
+  }
+  bool Close() override { return true; }
+
+  std::vector<bsdiff::ControlEntry>& entries() { return entries_; }
+  const std::vector<uint8_t>& diff_stream() const { return diff_stream_; }
+  const std::vector<uint8_t>& extra_stream() const { return extra_stream_; }
+
+ private:
+  std::vector<bsdiff::ControlEntry> entries_;
+  std::vector<uint8_t> diff_stream_;
+  std::vector<uint8_t> extra_stream_;
+};
+
+}  // namespace
+
+namespace bsdiff {
+
+int ParallelBsdiff(const uint8_t* old_buf,
+                   size_t oldsize,
+                   const uint8_t* new_buf,
+                   size_t newsize,
+                   size_t chunk_size,
+                   int num_threads,
+                   PatchWriterInterface* patch,
+                   SuffixArrayIndexInterface** sai_cache) {
+  size_t num_chunks =
+      chunk_size ? (newsize + chunk_size - 1) / chunk_size : 1;
+  if (num_threads <= 1 || num_chunks <= 1)
+    return bsdiff(old_buf, oldsize, new_buf, newsize, 0, patch, sai_cache);
+
+  // Build or reuse the suffix array of the old file; it is read-only during
+  // the search phase and shared by all workers.
+  std::unique_ptr<SuffixArrayIndexInterface> local_sai;
+  SuffixArrayIndexInterface* sai;
+  if (sai_cache && *sai_cache) {
+    sai = *sai_cache;
+  } else {
+    local_sai = CreateSuffixArrayIndex(old_buf, oldsize);
+    if (!local_sai)
+      return 1;
+    sai = local_sai.get();
+
+    // Transfer ownership to the caller.
+    if (sai_cache)
+      *sai_cache = local_sai.release();
+  }
+
+  std::vector<CapturingPatchWriter> chunks(num_chunks);
+  std::atomic<size_t> next_chunk(0);
+  std::atomic<bool> failed(false);
+
+  auto worker = [&]() {
+    for (;;) {
+      size_t chunk = next_chunk.fetch_add(1);
+      if (chunk >= num_chunks || failed.load())
+        return;
+      size_t offset = chunk * chunk_size;
+      size_t length = std::min(chunk_size, newsize - offset);
+      SuffixArrayIndexInterface* shared_sai = sai;
+      if (bsdiff(old_buf, oldsize, new_buf + offset, length, 0,
+                 &chunks[chunk], &shared_sai) != 0)
+        failed.store(true);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  size_t pool_size =
+      std::min<size_t>(static_cast<size_t>(num_threads), num_chunks);
+  for (size_t i = 0; i < pool_size; i++)
+    threads.emplace_back(worker);
+  for (std::thread& thread : threads)
+    thread.join();
+
+  if (failed.load()) {
+    LOG(ERROR) << "Diffing one of the blocks failed";
+    return 1;
+  }
+
+  if (!patch->Init(newsize)) {
+    LOG(ERROR) << "Initializing the patch writer failed";
+    return 1;
+  }
+
+  // Replay the captured blocks in order. Each block was encoded with the old
+  // file cursor starting at zero, so the last control entry of every block is
+  // adjusted to return the cursor to zero for the next block.
+  for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+    std::vector<ControlEntry>& entries = chunks[chunk].entries();
+    if (!entries.empty() && chunk + 1 < num_chunks) {
+      int64_t end_cursor = 0;
+      for (const ControlEntry& entry : entries)
+        end_cursor += entry.diff_size + entry.offset_increment;
+      entries.back().offset_increment -= end_cursor;
+    }
+
+    const uint8_t* diff_data = chunks[chunk].diff_stream().data();
+    const uint8_t* extra_data = chunks[chunk].extra_stream().data();
+    for (const ControlEntry& entry : entries) {
+      if (!patch->AddControlEntry(entry) ||
+          !patch->WriteDiffStream(diff_data, entry.diff_size) ||
+          !patch->WriteExtraStream(extra_data, entry.extra_size)) {
+        LOG(ERROR) << "Writing a control entry";
+        return 1;
+      }
+      diff_data += entry.diff_size;
+      extra_data += entry.extra_size;
+    }
+  }
+
+  if (!patch->Close()) {
+    LOG(ERROR) << "Closing the patch file";
+    return 1;
+  }
+
+  return 0;
+}
+
+}  // namespace bsdiff
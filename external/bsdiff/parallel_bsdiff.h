@@ -0,0 +1,42 @@
+// Copyright 2021 The Chromium OS Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef _BSDIFF_PARALLEL_BSDIFF_H_
+#define _BSDIFF_PARALLEL_BSDIFF_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bsdiff/common.h"
+#include "bsdiff/patch_writer_interface.h"
+#include "bsdiff/suffix_array_index_interface.h"
+
+namespace bsdiff {
+
+// Generate a patch like bsdiff(), but partition the new file into
+// |chunk_size|-byte blocks that are diffed against the whole old file on
+// |num_threads| worker threads. All workers share a single suffix array of
+// the old file, so peak memory matches the single-threaded mode. The
+// per-block control and data streams are merged in block order into |patch|;
+// the resulting patch is a regular bsdiff patch. Matches never span a block
+// boundary, so patches are marginally larger than single-threaded ones.
+//
+// |sai_cache| follows the same contract as in bsdiff(): when non-null it
+// caches the suffix array of the old file across calls, which amortizes the
+// dominant setup cost when generating multiple diffs against one base image.
+// Passing |num_threads| <= 1 or |chunk_size| == 0 falls back to a plain
+// single-threaded bsdiff() call.
+BSDIFF_EXPORT
+int ParallelBsdiff(const uint8_t* old_buf,
+                   size_t oldsize,
+                   const uint8_t* new_buf,
+                   size_t newsize,
+                   size_t chunk_size,
+                   int num_threads,
+                   PatchWriterInterface* patch,
+                   SuffixArrayIndexInterface** sai_cache);
+
+}  // namespace bsdiff
+
+#endif  // _BSDIFF_PARALLEL_BSDIFF_H_
@@ -0,0 +1,118 @@
+// Copyright 2021 The Chromium OS Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "bsdiff/parallel_bsdiff.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "bsdiff/fake_patch_writer.h"
+#include "bsdiff/suffix_array_index.h"
+
+namespace {
+
+void GenerateRandomBuffer(std::vector<uint8_t>* buffer) {
+  std::minstd_rand prng(1234 + buffer->size());
+  std::generate(buffer->begin(), buffer->end(), prng);
+}
+
+// Reconstruct the new file from the captured control entries and streams,
+// following the bspatch semantics: diff bytes are added to the old data at
+// the current old-file cursor, extra bytes are copied verbatim.
+std::vector<uint8_t> ApplyPatch(const std::vector<uint8_t>& old_file,
+                                const bsdiff::FakePatchWriter& patch) {
+  std::vector<uint8_t> new_file;
+  size_t diff_pos = 0;
+  size_t extra_pos = 0;
+  int64_t old_pos = 0;
+  for (const bsdiff::ControlEntry& entry : patch.entries()) {
+    for (uint64_t i = 0; i < entry.diff_size; i++) {
+      uint8_t old_byte = (old_pos + static_cast<int64_t>(i)) <
+                                 static_cast<int64_t>(old_file.size())
+                             ? old_file[old_pos + i]
+                             : 0;
+      new_file.push_back(old_byte + patch.diff_stream()[diff_pos++]);
+    }
+    old_pos += entry.diff_size;
+    for (uint64_t i = 0; i < entry.extra_size; i++)
+      new_file.push_back(patch.extra_stream()[extra_pos++]);
+    old_pos += entry.offset_increment;
+  }
+  EXPECT_EQ(diff_pos, patch.diff_stream().size());
+  EXPECT_EQ(extra_pos, patch.extra_stream().size());
+  return new_file;
+}
+
+}  // namespace
+
+namespace bsdiff {
+
+class ParallelBsdiffTest : public testing::Test {
+ protected:
+  void RunParallelBsdiff(size_t chunk_size, int num_threads) {
+    EXPECT_EQ(0, ParallelBsdiff(old_file_.data(), old_file_.size(),
+                                new_file_.data(), new_file_.size(), chunk_size,
+                                num_threads, &patch_writer_, nullptr));
+    EXPECT_EQ(new_file_, ApplyPatch(old_file_, patch_writer_));
+  }
+
+  std::vector<uint8_t> old_file_;
+  std::vector<uint8_t> new_file_;
+  FakePatchWriter patch_writer_;
+};
+
+TEST_F(ParallelBsdiffTest, EmptyFiles) {
+  RunParallelBsdiff(1024, 4);
+  EXPECT_TRUE(patch_writer_.entries().empty());
+}
+
+TEST_F(ParallelBsdiffTest, SingleChunkFallsBack) {
+  old_file_.resize(500);
+  GenerateRandomBuffer(&old_file_);
+  new_file_ = old_file_;
+  new_file_[100]++;
+  RunParallelBsdiff(1024, 4);
+}
+
+TEST_F(ParallelBsdiffTest, MultipleChunksReconstruct) {
+  old_file_.resize(4096);
+  GenerateRandomBuffer(&old_file_);
+  new_file_ = old_file_;
+  // Scatter changes across all the chunks.
+  for (size_t i = 50; i < new_file_.size(); i += 300)
+    new_file_[i] += 3;
+  // Insert some new data in the middle.
+  std::vector<uint8_t> inserted(128, 0xaa);
+  new_file_.insert(new_file_.begin() + 2000, inserted.begin(), inserted.end());
+
+  RunParallelBsdiff(1024, 4);
+  EXPECT_GE(patch_writer_.entries().size(), 4U);
+}
+
+TEST_F(ParallelBsdiffTest, SharedSuffixArrayCache) {
+  old_file_.resize(2048);
+  GenerateRandomBuffer(&old_file_);
+  new_file_ = old_file_;
+  new_file_[10] ^= 0xff;
+
+  SuffixArrayIndexInterface* sai = nullptr;
+  EXPECT_EQ(0, ParallelBsdiff(old_file_.data(), old_file_.size(),
+                              new_file_.data(), new_file_.size(), 512, 2,
+                              &patch_writer_, &sai));
+  ASSERT_NE(nullptr, sai);
+  EXPECT_EQ(new_file_, ApplyPatch(old_file_, patch_writer_));
+
+  // Reuse the cached suffix array for a second diff against the same base.
+  FakePatchWriter second_patch;
+  new_file_[700] ^= 0xff;
+  EXPECT_EQ(0, ParallelBsdiff(old_file_.data(), old_file_.size(),
+                              new_file_.data(), new_file_.size(), 512, 2,
+                              &second_patch, &sai));
+  EXPECT_EQ(new_file_, ApplyPatch(old_file_, second_patch));
+  delete sai;
+}
+
+}  // namespace bsdiff
@@ -102,6 +102,8 @@ DE_DECLARE_COMMAND_LINE_OPT(ShaderCacheTruncate,		bool);
 DE_DECLARE_COMMAND_LINE_OPT(RenderDoc,					bool);
 DE_DECLARE_COMMAND_LINE_OPT(CaseFraction,				std::vector<int>);
 DE_DECLARE_COMMAND_LINE_OPT(CaseFractionMandatoryTests,	std::string);
+DE_DECLARE_COMMAND_LINE_OPT(ShardCount,					int);
+DE_DECLARE_COMMAND_LINE_OPT(ShardIndex,					int);
 DE_DECLARE_COMMAND_LINE_OPT(WaiverFile,					std::string);
 DE_DECLARE_COMMAND_LINE_OPT(RunnerType,					tcu::TestRunnerType);
 DE_DECLARE_COMMAND_LINE_OPT(TerminateOnFail,			bool);
@@ -213,6 +215,8 @@ void registerOptions (de::cmdline::Parser& parser)
 		<< Option<RenderDoc>					(DE_NULL,	"deqp-renderdoc",							"Enable RenderDoc frame markers",					s_enableNames,		"disable")
 		<< Option<CaseFraction>					(DE_NULL,	"deqp-fraction",							"Run a fraction of the test cases (e.g. N,M means run group%M==N)",	parseIntList,	"")
 		<< Option<CaseFractionMandatoryTests>	(DE_NULL,	"deqp-fraction-mandatory-caselist-file",	"Case list file that must be run for each fraction",					"")
+		<< Option<ShardCount>					(DE_NULL,	"deqp-shard-count",							"Number of case-interleaved shards the run is split into",				"1")
+		<< Option<ShardIndex>					(DE_NULL,	"deqp-shard-index",							"Index of the shard to run (0..count-1)",								"0")
 		<< Option<WaiverFile>					(DE_NULL,	"deqp-waiver-file",							"Read waived tests from given file",									"")
 		<< Option<RunnerType>					(DE_NULL,	"deqp-runner-type",							"Filter test cases based on runner",				s_runnerTypes,		"any")
 		<< Option<TerminateOnFail>				(DE_NULL,	"deqp-terminate-on-fail",					"Terminate the run on first failure",				s_enableNames,		"disable");
@@ -931,6 +935,8 @@ bool					CommandLine::isRenderDocEnabled				(void) const	{ return m_cmdLine.getO
 const char*				CommandLine::getWaiverFileName				(void) const	{ return m_cmdLine.getOption<opt::WaiverFile>().c_str();					}
 const std::vector<int>&	CommandLine::getCaseFraction				(void) const	{ return m_cmdLine.getOption<opt::CaseFraction>();							}
 const char*				CommandLine::getCaseFractionMandatoryTests	(void) const	{ return m_cmdLine.getOption<opt::CaseFractionMandatoryTests>().c_str();	}
+int						CommandLine::getShardCount					(void) const	{ return m_cmdLine.getOption<opt::ShardCount>();							}
+int						CommandLine::getShardIndex					(void) const	{ return m_cmdLine.getOption<opt::ShardIndex>();							}
 const char*				CommandLine::getArchiveDir					(void) const	{ return m_cmdLine.getOption<opt::ArchiveDir>().c_str();					}
 tcu::TestRunnerType		CommandLine::getRunnerType					(void) const	{ return m_cmdLine.getOption<opt::RunnerType>();							}
 bool					CommandLine::isTerminateOnFailEnabled		(void) const	{ return m_cmdLine.getOption<opt::TerminateOnFail>();						}
@@ -1035,6 +1041,12 @@ bool CaseListFilter::checkTestCaseName (const char* caseName) const
 	return result;
 }
 
+bool CaseListFilter::checkCaseShard (int i) const
+{
+	return	m_shardCount <= 1 ||
+		((i % m_shardCount) == m_shardIndex);
+}
+
 bool CaseListFilter::checkCaseFraction (int i, const std::string& testCaseName) const
 {
 	return	m_caseFraction.size() != 2 ||
@@ -1045,11 +1057,15 @@ bool CaseListFilter::checkCaseFraction (int i, const std::string& testCaseName)
 CaseListFilter::CaseListFilter (void)
 	: m_caseTree	(DE_NULL)
 	, m_runnerType	(tcu::RUNNERTYPE_ANY)
+	, m_shardCount	(1)
+	, m_shardIndex	(0)
 {
 }
 
 CaseListFilter::CaseListFilter (const de::cmdline::CommandLine& cmdLine, const tcu::Archive& archive)
 	: m_caseTree	(DE_NULL)
+	, m_shardCount	(1)
+	, m_shardIndex	(0)
 {
 	if (cmdLine.getOption<opt::RunMode>() == RUNMODE_VERIFY_AMBER_COHERENCY)
 	{
@@ -1141,6 +1157,15 @@ CaseListFilter::CaseListFilter (const de::cmdline::CommandLine& cmdLine, const t
 			}
 		}
 	}
+
+	m_shardCount = cmdLine.getOption<opt::ShardCount>();
+	m_shardIndex = cmdLine.getOption<opt::ShardIndex>();
+
+	if (m_shardCount <= 0)
+		throw Exception("Invalid shard count. Must be greater than 0.");
+
+	if (m_shardIndex < 0 || m_shardIndex >= m_shardCount)
+		throw Exception("Invalid shard index. Must be non-negative and less than shard count.");
 }
 
 CaseListFilter::~CaseListFilter (void)
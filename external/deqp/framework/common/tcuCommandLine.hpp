@@ -116,6 +116,9 @@ public:
 	//! Check if test group passes the case fraction filter.
 	bool							checkCaseFraction			(int i, const std::string& testCaseName) const;
 
+	//! Check if test case passes the shard filter (--deqp-shard-count).
+	bool							checkCaseShard				(int i) const;
+
 	//! Check if test case runner is of supplied type
 	bool							checkRunnerType				(tcu::TestRunnerType type) const { return ((m_runnerType & type) == m_runnerType); }
 
@@ -128,6 +131,8 @@ private:
 	std::vector<int>				m_caseFraction;
 	de::MovePtr<const CasePaths>	m_caseFractionMandatoryTests;
 	tcu::TestRunnerType				m_runnerType;
+	int								m_shardCount;
+	int								m_shardIndex;
 };
 
 /*--------------------------------------------------------------------*//*!
@@ -264,6 +269,12 @@ public:
 	//! Get must-list filename
 	const char*						getCaseFractionMandatoryTests(void) const;
 
+	//! Get shard count (--deqp-shard-count)
+	int								getShardCount				(void) const;
+
+	//! Get shard index (--deqp-shard-index)
+	int								getShardIndex				(void) const;
+
 	//! Get archive directory path
 	const char*						getArchiveDir				(void) const;
 
@@ -94,6 +94,7 @@ TestHierarchyIterator::TestHierarchyIterator (TestPackageRoot&			rootNode,
 	: m_inflater		(inflater)
 	, m_caseListFilter	(caseListFilter)
 	, m_groupNumber		(0)
+	, m_caseNumber		(0)
 {
 	// Init traverse state and "seek" to first reportable node.
 	NodeIter iter(&rootNode);
@@ -225,9 +226,14 @@ void TestHierarchyIterator::next (void)
 					// and whether that group should be filtered out.
 					if ( isTestNodeTypeExecutable(childNode->getNodeType()) )
 					{
-						const std::string testName = m_nodePath + "." + childNode->getName();
+						const std::string	testName	= m_nodePath + "." + childNode->getName();
+						// The counter must advance for every case on every shard so that
+						// all shards agree on the case -> shard assignment.
+						const int			caseNumber	= m_caseNumber++;
 						if(!m_caseListFilter.checkCaseFraction(m_groupNumber, testName))
 							break;
+						if(!m_caseListFilter.checkCaseShard(caseNumber))
+							break;
 					}
 					m_sessionStack.push_back(NodeIter(childNode));
 				}
@@ -198,6 +198,11 @@ private:
 
 	// Counter that increments by one for each bottom-level test group
 	int						m_groupNumber;
+
+	// Counter that increments by one for each test case considered; used to
+	// deal cases out to shards independently of group boundaries so that one
+	// large group cannot dominate a single shard.
+	int						m_caseNumber;
 };
 
 } // tcu
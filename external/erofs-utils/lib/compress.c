@@ -11,6 +11,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <pthread.h>
 #include "erofs/print.h"
 #include "erofs/io.h"
 #include "erofs/cache.h"
@@ -250,6 +251,216 @@ nocompression:
 	return 0;
 }
 
+/*
+ * Multi-threaded compression splits the file into block-aligned segments
+ * which are compressed independently by worker threads into in-memory
+ * extent lists, then assembled in segment order by the main thread. Since
+ * every segment is a multiple of EROFS_BLKSIZ, each one starts and ends at
+ * clusterofs 0, so replaying the per-extent byte counts through
+ * vle_write_indexes() produces exactly the indexes a sequential run of the
+ * same extents would.
+ */
+#define Z_EROFS_MT_SEGMENT_SIZE		(4U << 20)
+
+struct z_erofs_extent_item {
+	struct z_erofs_extent_item *next;
+	unsigned int count;		/* decompressed bytes consumed */
+	unsigned int compressedblks;
+	bool raw;
+	u8 data[];
+};
+
+struct z_erofs_mt_segment {
+	struct z_erofs_extent_item *head;
+	u64 offset;
+	unsigned int length;
+	int err;
+};
+
+struct z_erofs_mt_job {
+	struct erofs_inode *inode;
+	struct z_erofs_mt_segment *segments;
+	unsigned int nr_segments;
+	unsigned int next_segment;
+	unsigned int pclustersize;
+	int fd;
+	pthread_mutex_t lock;
+};
+
+static int z_erofs_mt_compress_segment(struct erofs_compress *h,
+				       struct z_erofs_mt_job *job,
+				       u8 *in, char *dst,
+				       struct z_erofs_mt_segment *seg)
+{
+	struct z_erofs_extent_item *item, **tail = &seg->head;
+	unsigned int head = 0;
+	unsigned int len = seg->length;
+
+	while (len) {
+		unsigned int count = min(len,
+					 cfg.c_max_decompressed_extent_bytes);
+		int ret = -EAGAIN;
+
+		if (len > EROFS_BLKSIZ)
+			ret = erofs_compress_destsize(h, in + head, &count,
+						      dst, job->pclustersize);
+		if (ret <= 0) {
+			if (ret != -EAGAIN)
+				erofs_err("failed to compress %s: %s",
+					  job->inode->i_srcpath,
+					  erofs_strerror(ret));
+			/* fall back to an uncompressed block */
+			count = min(EROFS_BLKSIZ, len);
+			item = malloc(sizeof(*item) + EROFS_BLKSIZ);
+			if (!item)
+				return -ENOMEM;
+			memcpy(item->data, in + head, count);
+			memset(item->data + count, 0, EROFS_BLKSIZ - count);
+			item->compressedblks = 1;
+			item->raw = true;
+		} else {
+			const unsigned int tailused = ret & (EROFS_BLKSIZ - 1);
+			const unsigned int padding =
+				erofs_sb_has_lz4_0padding() && tailused ?
+					EROFS_BLKSIZ - tailused : 0;
+			const unsigned int compressedblks =
+				DIV_ROUND_UP(ret, EROFS_BLKSIZ);
+
+			item = malloc(sizeof(*item) +
+				      compressedblks * EROFS_BLKSIZ);
+			if (!item)
+				return -ENOMEM;
+			memset(item->data, 0, compressedblks * EROFS_BLKSIZ);
+			memcpy(item->data + padding, dst, ret);
+			item->compressedblks = compressedblks;
+			item->raw = false;
+		}
+		item->count = count;
+		item->next = NULL;
+		*tail = item;
+		tail = &item->next;
+
+		head += count;
+		len -= count;
+	}
+	return 0;
+}
+
+static void *z_erofs_mt_worker(void *arg)
+{
+	struct z_erofs_mt_job *const job = arg;
+	struct erofs_compress handle;
+	u8 *in;
+	char *dstbuf;
+	int err;
+
+	err = erofs_compressor_init(&handle, cfg.c_compr_alg_master);
+	if (err)
+		return NULL;
+	err = erofs_compressor_setlevel(&handle, cfg.c_compr_level_master);
+	if (err)
+		goto out_exit;
+
+	in = malloc(Z_EROFS_MT_SEGMENT_SIZE);
+	dstbuf = malloc(EROFS_CONFIG_COMPR_MAX_SZ + EROFS_BLKSIZ);
+	if (in && dstbuf) {
+		for (;;) {
+			struct z_erofs_mt_segment *seg;
+
+			pthread_mutex_lock(&job->lock);
+			if (job->next_segment >= job->nr_segments) {
+				pthread_mutex_unlock(&job->lock);
+				break;
+			}
+			seg = &job->segments[job->next_segment++];
+			pthread_mutex_unlock(&job->lock);
+
+			if (pread(job->fd, in, seg->length,
+				  seg->offset) != seg->length) {
+				seg->err = -errno;
+				continue;
+			}
+			seg->err = z_erofs_mt_compress_segment(&handle, job,
+					in, dstbuf + EROFS_BLKSIZ, seg);
+		}
+	}
+	free(dstbuf);
+	free(in);
+out_exit:
+	erofs_compressor_exit(&handle);
+	return NULL;
+}
+
+static int z_erofs_mt_compress_file(struct erofs_inode *inode,
+				    struct z_erofs_vle_compress_ctx *ctx,
+				    int fd)
+{
+	struct z_erofs_mt_job job;
+	pthread_t *threads;
+	unsigned int nr_workers, i;
+	int err = 0;
+
+	job.inode = inode;
+	job.fd = fd;
+	job.pclustersize =
+		z_erofs_get_max_pclusterblks(inode) * EROFS_BLKSIZ;
+	job.nr_segments = DIV_ROUND_UP(inode->i_size,
+				       Z_EROFS_MT_SEGMENT_SIZE);
+	job.next_segment = 0;
+	job.segments = calloc(job.nr_segments, sizeof(*job.segments));
+	if (!job.segments)
+		return -ENOMEM;
+	for (i = 0; i < job.nr_segments; ++i) {
+		job.segments[i].offset = (u64)i * Z_EROFS_MT_SEGMENT_SIZE;
+		job.segments[i].length = min_t(u64, inode->i_size -
+				job.segments[i].offset,
+				Z_EROFS_MT_SEGMENT_SIZE);
+		/* overwritten by the worker which claims the segment */
+		job.segments[i].err = -EAGAIN;
+	}
+	pthread_mutex_init(&job.lock, NULL);
+
+	nr_workers = min_t(unsigned int, cfg.c_compress_workers,
+			   job.nr_segments);
+	threads = malloc(nr_workers * sizeof(*threads));
+	if (!threads) {
+		err = -ENOMEM;
+		goto out;
+	}
+	for (i = 0; i < nr_workers; ++i)
+		pthread_create(&threads[i], NULL, z_erofs_mt_worker, &job);
+	for (i = 0; i < nr_workers; ++i)
+		pthread_join(threads[i], NULL);
+	free(threads);
+
+	/* assemble the segments in order: write blocks, then indexes */
+	for (i = 0; i < job.nr_segments; ++i) {
+		struct z_erofs_mt_segment *const seg = &job.segments[i];
+		struct z_erofs_extent_item *item;
+
+		if (!err && seg->err)
+			err = seg->err;
+		while ((item = seg->head) != NULL) {
+			if (!err) {
+				ctx->compressedblks = item->compressedblks;
+				err = blk_write(item->data, ctx->blkaddr,
+						item->compressedblks);
+				if (!err) {
+					vle_write_indexes(ctx, item->count,
+							  item->raw);
+					ctx->blkaddr += item->compressedblks;
+				}
+			}
+			seg->head = item->next;
+			free(item);
+		}
+	}
+out:
+	pthread_mutex_destroy(&job.lock);
+	free(job.segments);
+	return err;
+}
+
 struct z_erofs_compressindex_vec {
 	union {
 		erofs_blk_t blkaddr;
@@ -513,29 +724,36 @@ int erofs_write_compressed_file(struct erofs_inode *inode)
 	ctx.clusterofs = 0;
 	remaining = inode->i_size;
 
-	while (remaining) {
-		const u64 readcount = min_t(u64, remaining,
-					    sizeof(ctx.queue) - ctx.tail);
-
-		ret = read(fd, ctx.queue + ctx.tail, readcount);
-		if (ret != readcount) {
-			ret = -errno;
+	if (cfg.c_compress_workers > 1 && erofs_sb_has_lz4_0padding() &&
+	    remaining > Z_EROFS_MT_SEGMENT_SIZE) {
+		ret = z_erofs_mt_compress_file(inode, &ctx, fd);
+		if (ret)
 			goto err_bdrop;
+	} else {
+		while (remaining) {
+			const u64 readcount = min_t(u64, remaining,
+						    sizeof(ctx.queue) - ctx.tail);
+
+			ret = read(fd, ctx.queue + ctx.tail, readcount);
+			if (ret != readcount) {
+				ret = -errno;
+				goto err_bdrop;
+			}
+			remaining -= readcount;
+			ctx.tail += readcount;
+
+			/* do one compress round */
+			ret = vle_compress_one(inode, &ctx, false);
+			if (ret)
+				goto err_bdrop;
 		}
-		remaining -= readcount;
-		ctx.tail += readcount;
 
-		/* do one compress round */
-		ret = vle_compress_one(inode, &ctx, false);
+		/* do the final round */
+		ret = vle_compress_one(inode, &ctx, true);
 		if (ret)
 			goto err_bdrop;
 	}
 
-	/* do the final round */
-	ret = vle_compress_one(inode, &ctx, true);
-	if (ret)
-		goto err_bdrop;
-
 	/* fall back to no compression mode */
 	compressed_blocks = ctx.blkaddr - blkaddr;
 	if (compressed_blocks >= BLK_ROUND_UP(inode->i_size)) {
@@ -30,6 +30,7 @@ void erofs_init_configure(void)
 	cfg.c_pclusterblks_max = 1;
 	cfg.c_pclusterblks_def = 1;
 	cfg.c_max_decompressed_extent_bytes = -1;
+	cfg.c_compress_workers = 1;
 }
 
 void erofs_show_config(void)
@@ -50,6 +50,7 @@ static struct option long_options[] = {
 	{"quiet", no_argument, 0, 12},
 	{"blobdev", required_argument, NULL, 13},
 	{"ignore-mtime", no_argument, NULL, 14},
+	{"workers", required_argument, NULL, 15},
 #ifdef WITH_ANDROID
 	{"mount-point", required_argument, NULL, 512},
 	{"product-out", required_argument, NULL, 513},
@@ -103,6 +104,7 @@ static void usage(void)
 #ifndef NDEBUG
 	      " --random-pclusterblks randomize pclusterblks for big pcluster (debugging only)\n"
 #endif
+	      " --workers=#           compress big files with # parallel worker threads\n"
 #ifdef WITH_ANDROID
 	      "\nwith following android-specific options:\n"
 	      " --mount-point=X       X=prefix of target fs path (default: /)\n"
@@ -371,6 +373,15 @@ static int mkfs_parse_options_cfg(int argc, char *argv[])
 		case 14:
 			cfg.c_ignore_mtime = true;
 			break;
+		case 15:
+			i = strtol(optarg, &endptr, 0);
+			if (*endptr != '\0' || i <= 0) {
+				erofs_err("invalid number of workers %s",
+					  optarg);
+				return -EINVAL;
+			}
+			cfg.c_compress_workers = i;
+			break;
 		case 1:
 			usage();
 			exit(0);
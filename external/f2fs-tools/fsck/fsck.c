@@ -685,6 +685,56 @@ void fsck_reada_all_direct_node_blocks(struct f2fs_sb_info *sbi,
 	}
 }
 
+static int cmp_blk_addr(const void *a, const void *b)
+{
+	u32 l = *(const u32 *)a;
+	u32 r = *(const u32 *)b;
+
+	if (l == r)
+		return 0;
+	return l < r ? -1 : 1;
+}
+
+/*
+ * Ask the kernel to prefetch every valid node block before the tree walk
+ * starts. The NAT was already cached by build_nat_area_bitmap(), so the
+ * block addresses of all node chains are known up front; sorting them and
+ * issuing one readahead per contiguous run turns the random reads of the
+ * recursive traversal into a few sequential ones.
+ */
+void fsck_reada_all_node_blocks(struct f2fs_sb_info *sbi)
+{
+	struct f2fs_fsck *fsck = F2FS_FSCK(sbi);
+	u32 *blk_addrs;
+	u32 nr_blks = 0;
+	u32 i, len;
+
+	blk_addrs = calloc(fsck->nr_nat_entries, sizeof(u32));
+	if (blk_addrs == NULL)
+		return;
+
+	for (i = 0; i < fsck->nr_nat_entries; i++) {
+		u32 blk = le32_to_cpu(fsck->entries[i].block_addr);
+
+		if (blk && IS_VALID_BLK_ADDR(sbi, blk))
+			blk_addrs[nr_blks++] = blk;
+	}
+
+	qsort(blk_addrs, nr_blks, sizeof(u32), cmp_blk_addr);
+
+	for (i = 0; i < nr_blks; i += len) {
+		u32 start = blk_addrs[i];
+
+		len = 1;
+		while (i + len < nr_blks && blk_addrs[i + len] == start + len)
+			len++;
+		dev_readahead((u64)start << F2FS_BLKSIZE_BITS,
+				(size_t)len << F2FS_BLKSIZE_BITS);
+	}
+
+	free(blk_addrs);
+}
+
 /* start with valid nid and blkaddr */
 void fsck_chk_inode_blk(struct f2fs_sb_info *sbi, u32 nid,
 		enum FILE_TYPE ftype, struct f2fs_node *node_blk,
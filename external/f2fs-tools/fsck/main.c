@@ -878,6 +878,8 @@ static int do_fsck(struct f2fs_sb_info *sbi)
 			return FSCK_OPERATIONAL_ERROR;
 		}
 	}
+	fsck_reada_all_node_blocks(sbi);
+
 	fsck_chk_orphan_node(sbi);
 	fsck_chk_node_blk(sbi, NULL, sbi->root_ino_num,
 			F2FS_FT_DIR, TYPE_INODE, &blk_cnt, &cbc, NULL);
@@ -0,0 +1,202 @@
+//===-- allocation_profiler.cpp ---------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "gwp_asan/optional/allocation_profiler.h"
+#include "gwp_asan/definitions.h"
+
+#include <atomic>
+
+namespace gwp_asan {
+namespace profiler {
+namespace {
+struct CallSiteSlot {
+  // Zero while the slot is empty; claimed with a single compare-exchange.
+  std::atomic<uintptr_t> Hash;
+  std::atomic<uint64_t> Count;
+  std::atomic<uint64_t> TotalBytes;
+  // Zero while the claiming thread is still writing `Trace`; published with a
+  // release store once the frames are in place.
+  std::atomic<size_t> TraceLength;
+  uintptr_t Trace[MaxProfilerFrames];
+};
+
+// All profiler data lives in static storage so that recording a sample never
+// allocates. The call-site table is roughly 150KiB of .bss.
+struct ProfilerState {
+  std::atomic<bool> Enabled;
+  unsigned SampleRate;
+  options::Backtrace_t Backtrace;
+  std::atomic<uint64_t> SizeClassHistogram[MaxSizeClasses];
+  std::atomic<uint64_t> LostSamples;
+  CallSiteSlot CallSites[MaxCallSites];
+};
+ProfilerState State;
+
+struct ThreadLocals {
+  constexpr ThreadLocals() {}
+  // Allocations remaining on this thread before the next sample. Zero means
+  // the thread has not drawn a countdown yet.
+  uint32_t NextSampleCounter = 0;
+  // xorshift32 state used to draw countdowns; seeded on first use.
+  uint32_t RandomState = 0;
+  // Prevents infinite recursion when the frame-capture function itself
+  // allocates through the profiled allocator.
+  bool RecursiveGuard = false;
+};
+GWP_ASAN_TLS_INITIAL_EXEC ThreadLocals ThreadLocalState;
+
+std::atomic<uint32_t> ThreadSeedSequence;
+
+uint32_t nextRandom() {
+  uint32_t X = ThreadLocalState.RandomState;
+  X ^= X << 13;
+  X ^= X >> 17;
+  X ^= X << 5;
+  ThreadLocalState.RandomState = X;
+  return X;
+}
+
+// Draw the number of allocations until the next sample, uniform in
+// [1, 2 * SampleRate]. The mean matches the configured rate while the jitter
+// stops call sites whose allocation count is a multiple of the rate from
+// being systematically hit or missed.
+uint32_t drawSampleCountdown() {
+  if (GWP_ASAN_UNLIKELY(ThreadLocalState.RandomState == 0)) {
+    ThreadLocalState.RandomState =
+        (ThreadSeedSequence.fetch_add(1, std::memory_order_relaxed) + 1) *
+        2654435761u;
+  }
+  return (nextRandom() % (2 * State.SampleRate)) + 1;
+}
+
+size_t sizeClass(size_t Size) {
+  size_t Class = 0;
+  while (Class + 1 < MaxSizeClasses && Size > (size_t{1} << Class))
+    ++Class;
+  return Class;
+}
+
+uintptr_t hashTrace(const uintptr_t *Trace, size_t TraceLength) {
+  // FNV-1a over the raw frame pointers.
+  uintptr_t Hash = 0xcbf29ce484222325u;
+  for (size_t I = 0; I < TraceLength; ++I) {
+    Hash ^= Trace[I];
+    Hash *= 0x100000001b3u;
+  }
+  // Zero marks an empty slot, so never return it for a real trace.
+  return Hash ? Hash : 1;
+}
+
+void recordCallSite(size_t Size) {
+  uintptr_t Trace[MaxProfilerFrames];
+  size_t TraceLength = State.Backtrace(Trace, MaxProfilerFrames);
+  if (TraceLength == 0)
+    return;
+  if (TraceLength > MaxProfilerFrames)
+    TraceLength = MaxProfilerFrames;
+
+  const uintptr_t Hash = hashTrace(Trace, TraceLength);
+  constexpr size_t MaxProbes = 8;
+  for (size_t Probe = 0; Probe < MaxProbes; ++Probe) {
+    CallSiteSlot &Slot = State.CallSites[(Hash + Probe) % MaxCallSites];
+    uintptr_t Expected = 0;
+    if (Slot.Hash.compare_exchange_strong(Expected, Hash,
+                                          std::memory_order_relaxed)) {
+      for (size_t I = 0; I < TraceLength; ++I)
+        Slot.Trace[I] = Trace[I];
+      Slot.TraceLength.store(TraceLength, std::memory_order_release);
+    } else if (Expected != Hash) {
+      continue;
+    }
+    Slot.Count.fetch_add(1, std::memory_order_relaxed);
+    Slot.TotalBytes.fetch_add(Size, std::memory_order_relaxed);
+    return;
+  }
+  State.LostSamples.fetch_add(1, std::memory_order_relaxed);
+}
+
+void recordSample(size_t Size) {
+  State.SizeClassHistogram[sizeClass(Size)].fetch_add(
+      1, std::memory_order_relaxed);
+  if (State.Backtrace)
+    recordCallSite(Size);
+}
+} // anonymous namespace
+
+void initProfiler(unsigned SampleRate, options::Backtrace_t Backtrace) {
+  State.Enabled.store(false, std::memory_order_relaxed);
+  for (size_t I = 0; I < MaxSizeClasses; ++I)
+    State.SizeClassHistogram[I].store(0, std::memory_order_relaxed);
+  State.LostSamples.store(0, std::memory_order_relaxed);
+  for (size_t I = 0; I < MaxCallSites; ++I) {
+    State.CallSites[I].TraceLength.store(0, std::memory_order_relaxed);
+    State.CallSites[I].Count.store(0, std::memory_order_relaxed);
+    State.CallSites[I].TotalBytes.store(0, std::memory_order_relaxed);
+    State.CallSites[I].Hash.store(0, std::memory_order_relaxed);
+  }
+  State.SampleRate = SampleRate ? SampleRate : 1;
+  State.Backtrace = Backtrace;
+  State.Enabled.store(true, std::memory_order_release);
+}
+
+bool isProfilerEnabled() {
+  return State.Enabled.load(std::memory_order_relaxed);
+}
+
+void maybeRecordAllocation(size_t Size) {
+  if (!State.Enabled.load(std::memory_order_relaxed))
+    return;
+  if (GWP_ASAN_UNLIKELY(ThreadLocalState.RecursiveGuard))
+    return;
+  if (ThreadLocalState.NextSampleCounter > 1) {
+    --ThreadLocalState.NextSampleCounter;
+    return;
+  }
+  if (ThreadLocalState.NextSampleCounter == 0) {
+    // First profiled allocation on this thread: only draw the countdown.
+    ThreadLocalState.NextSampleCounter = drawSampleCountdown();
+    return;
+  }
+  ThreadLocalState.RecursiveGuard = true;
+  recordSample(Size);
+  ThreadLocalState.RecursiveGuard = false;
+  ThreadLocalState.NextSampleCounter = drawSampleCountdown();
+}
+} // namespace profiler
+} // namespace gwp_asan
+
+uint64_t __gwp_asan_profiler_size_class_count(size_t ClassIndex) {
+  using namespace gwp_asan::profiler;
+  if (ClassIndex >= MaxSizeClasses)
+    return 0;
+  return State.SizeClassHistogram[ClassIndex].load(std::memory_order_relaxed);
+}
+
+uint64_t __gwp_asan_profiler_lost_samples() {
+  using namespace gwp_asan::profiler;
+  return State.LostSamples.load(std::memory_order_relaxed);
+}
+
+void __gwp_asan_profiler_iterate_call_sites(
+    void (*Callback)(const gwp_asan::profiler::CallSite *CS, void *Arg),
+    void *Arg) {
+  using namespace gwp_asan::profiler;
+  for (size_t I = 0; I < MaxCallSites; ++I) {
+    const CallSiteSlot &Slot = State.CallSites[I];
+    const size_t TraceLength = Slot.TraceLength.load(std::memory_order_acquire);
+    if (TraceLength == 0)
+      continue;
+    CallSite CS;
+    for (size_t F = 0; F < TraceLength; ++F)
+      CS.Trace[F] = Slot.Trace[F];
+    CS.TraceLength = TraceLength;
+    CS.Count = Slot.Count.load(std::memory_order_relaxed);
+    CS.TotalBytes = Slot.TotalBytes.load(std::memory_order_relaxed);
+    Callback(&CS, Arg);
+  }
+}
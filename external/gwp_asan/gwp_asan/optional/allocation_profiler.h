@@ -0,0 +1,83 @@
+//===-- allocation_profiler.h -----------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef GWP_ASAN_OPTIONAL_ALLOCATION_PROFILER_H_
+#define GWP_ASAN_OPTIONAL_ALLOCATION_PROFILER_H_
+
+#include "gwp_asan/options.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace gwp_asan {
+namespace profiler {
+// ================================ Description ================================
+// A statistical allocation profiler built on the same hook points as the
+// guarded allocator. Unlike the guarded pool, sampled allocations are NOT
+// diverted: the profiler only records the size and call site of every 1-in-N
+// allocation into a size-class histogram and a fixed-size call-site table,
+// then lets the supporting allocator serve the request as usual. The sampling
+// decision is a thread-local counter decrement (no atomics, no locks), so the
+// profiler can run fleet-wide at production sampling rates (e.g. 1/10000).
+// Recording a sample takes the backtrace with the same frame-capture function
+// the core allocator uses and updates the tables with relaxed atomics.
+
+// Number of power-of-two size classes tracked by the histogram. Class i counts
+// allocations with size in [2^(i-1) + 1, 2^i] (class 0 counts size <= 1).
+constexpr size_t MaxSizeClasses = 33;
+// Number of slots in the call-site table. Collisions past this many distinct
+// call sites are accounted to the lost-samples counter rather than chained.
+constexpr size_t MaxCallSites = 1021;
+// Number of frames kept per call site.
+constexpr size_t MaxProfilerFrames = 16;
+
+struct CallSite {
+  uintptr_t Trace[MaxProfilerFrames];
+  size_t TraceLength;
+  uint64_t Count;
+  uint64_t TotalBytes;
+};
+
+// Initialise the profiler. `SampleRate` is the mean number of allocations
+// between two samples (the per-thread counters are drawn from a geometric
+// distribution with that mean, so that allocation-count-periodic call sites
+// are not systematically missed). `Backtrace` is the frame-capture function
+// shared with the core allocator; it may be nullptr, in which case samples
+// are recorded without call-site attribution. Calling initProfiler() again
+// resets all recorded data.
+void initProfiler(unsigned SampleRate, options::Backtrace_t Backtrace);
+
+// Returns whether the profiler was initialised and is recording.
+bool isProfilerEnabled();
+
+// Allocation hook. Cheap enough to call unconditionally from the allocator
+// shim: when the profiler is disabled or the thread-local sample countdown
+// has not expired this is a load, a decrement and a store.
+void maybeRecordAllocation(size_t Size);
+} // namespace profiler
+} // namespace gwp_asan
+
+// Export surface, kept in the style of the crash-handler API so that
+// out-of-process tooling links against plain C symbols.
+extern "C" {
+// Returns the number of sampled allocations in size class `ClassIndex`, or
+// zero for out-of-range classes.
+uint64_t __gwp_asan_profiler_size_class_count(size_t ClassIndex);
+
+// Returns the number of samples that could not be attributed to a call site
+// because the call-site table was full.
+uint64_t __gwp_asan_profiler_lost_samples();
+
+// Invokes `Callback` once per recorded call site. `Arg` is passed through
+// verbatim. The callback must not allocate from the profiled allocator.
+void __gwp_asan_profiler_iterate_call_sites(
+    void (*Callback)(const gwp_asan::profiler::CallSite *CS, void *Arg),
+    void *Arg);
+}
+
+#endif // GWP_ASAN_OPTIONAL_ALLOCATION_PROFILER_H_
@@ -0,0 +1,74 @@
+//===-- allocation_profiler.cpp ---------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "gwp_asan/tests/harness.h"
+
+#include "gwp_asan/optional/allocation_profiler.h"
+
+namespace {
+size_t FakeBacktrace(uintptr_t *TraceBuffer, size_t Size) {
+  const uintptr_t Frames[3] = {0x1000, 0x2000, 0x3000};
+  size_t NumFrames = Size < 3 ? Size : 3;
+  for (size_t I = 0; I < NumFrames; ++I)
+    TraceBuffer[I] = Frames[I];
+  return NumFrames;
+}
+
+struct CallSiteTotals {
+  uint64_t NumCallSites = 0;
+  uint64_t Count = 0;
+  uint64_t TotalBytes = 0;
+  size_t TraceLength = 0;
+};
+
+void AccumulateCallSites(const gwp_asan::profiler::CallSite *CS, void *Arg) {
+  CallSiteTotals *Totals = static_cast<CallSiteTotals *>(Arg);
+  ++Totals->NumCallSites;
+  Totals->Count += CS->Count;
+  Totals->TotalBytes += CS->TotalBytes;
+  Totals->TraceLength = CS->TraceLength;
+}
+
+uint64_t TotalSampleCount() {
+  uint64_t Total = 0;
+  for (size_t I = 0; I < gwp_asan::profiler::MaxSizeClasses; ++I)
+    Total += __gwp_asan_profiler_size_class_count(I);
+  return Total;
+}
+} // anonymous namespace
+
+TEST(GwpAsanAllocationProfilerTest, SizeClassHistogram) {
+  gwp_asan::profiler::initProfiler(/* SampleRate */ 1, /* Backtrace */ nullptr);
+  EXPECT_TRUE(gwp_asan::profiler::isProfilerEnabled());
+
+  constexpr size_t NumAllocations = 1000;
+  for (size_t I = 0; I < NumAllocations; ++I)
+    gwp_asan::profiler::maybeRecordAllocation(128);
+
+  // With a mean rate of one, countdowns are drawn from {1, 2}, so roughly two
+  // thirds of the allocations are sampled. Be generous to avoid flakes.
+  uint64_t Count = __gwp_asan_profiler_size_class_count(7); // 65..128 bytes.
+  EXPECT_GT(Count, NumAllocations / 4);
+  EXPECT_EQ(Count, TotalSampleCount());
+}
+
+TEST(GwpAsanAllocationProfilerTest, CallSiteAttribution) {
+  gwp_asan::profiler::initProfiler(/* SampleRate */ 1, FakeBacktrace);
+
+  for (size_t I = 0; I < 1000; ++I)
+    gwp_asan::profiler::maybeRecordAllocation(32);
+
+  CallSiteTotals Totals;
+  __gwp_asan_profiler_iterate_call_sites(AccumulateCallSites, &Totals);
+  // Every sample shares the fake trace, so they all land in a single site.
+  EXPECT_EQ(1u, Totals.NumCallSites);
+  EXPECT_EQ(3u, Totals.TraceLength);
+  EXPECT_EQ(TotalSampleCount(), Totals.Count);
+  EXPECT_EQ(TotalSampleCount() * 32, Totals.TotalBytes);
+  EXPECT_EQ(0u, __gwp_asan_profiler_lost_samples());
+}
@@ -40,6 +40,7 @@
 #include "hb-ot-tag.cc"
 #include "hb-ot-var.cc"
 #include "hb-set.cc"
+#include "hb-shape-cache.cc"
 #include "hb-shape-plan.cc"
 #include "hb-shape.cc"
 #include "hb-shaper.cc"
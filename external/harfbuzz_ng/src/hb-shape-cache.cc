@@ -0,0 +1,301 @@
+/*
+ * Copyright © 2021  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb.hh"
+
+#include "hb-buffer.hh"
+#include "hb-font.hh"
+#include "hb-machinery.hh"
+
+
+/*
+ * Memoization of full shaping results.
+ *
+ * UI workloads reshape the same short (text, font, features) runs over and
+ * over; this cache replays the glyph infos and positions of a previous
+ * identical run into the buffer instead of shaping again.
+ *
+ * The cache is a direct-mapped table of fixed-size slots allocated on first
+ * use. Each slot is protected by a sequence counter in the manner of a
+ * seqlock: readers copy the slot without taking any lock and retry-free
+ * discard the copy if the sequence changed underneath them, writers bump the
+ * sequence to odd for the duration of the store. Replacing a slot in place
+ * keeps the memory bound fixed; collisions simply evict the older run.
+ *
+ * Runs that do not fit the fixed slot (long text, many features, many output
+ * glyphs) are shaped normally and never cached.
+ */
+
+#define HB_SHAPE_CACHE_SLOTS		128
+#define HB_SHAPE_CACHE_MAX_CHARS	48
+#define HB_SHAPE_CACHE_MAX_GLYPHS	(2 * HB_SHAPE_CACHE_MAX_CHARS)
+#define HB_SHAPE_CACHE_MAX_FEATURES	4
+
+struct hb_shape_cache_entry_t
+{
+  /* Key. The font is keyed by identity: clients must not mutate a font
+   * (funcs, scale, variations) while relying on cached runs for it. */
+  hb_font_t *font;
+  hb_segment_properties_t props;
+  hb_buffer_flags_t flags;
+  hb_buffer_cluster_level_t cluster_level;
+  hb_codepoint_t invisible;
+  hb_codepoint_t not_found;
+  unsigned int num_features;
+  hb_feature_t features[HB_SHAPE_CACHE_MAX_FEATURES];
+  unsigned int text_len;
+  hb_codepoint_t text[HB_SHAPE_CACHE_MAX_CHARS];
+  uint32_t clusters[HB_SHAPE_CACHE_MAX_CHARS];
+
+  /* Value. */
+  hb_bool_t shape_result;
+  unsigned int num_glyphs;
+  hb_glyph_info_t info[HB_SHAPE_CACHE_MAX_GLYPHS];
+  hb_glyph_position_t pos[HB_SHAPE_CACHE_MAX_GLYPHS];
+};
+
+struct hb_shape_cache_slot_t
+{
+  hb_atomic_int_t sequence; /* Odd while a writer owns the slot. */
+  hb_shape_cache_entry_t entry;
+};
+
+static inline void free_static_shape_cache ();
+
+static struct hb_shape_cache_lazy_loader_t : hb_lazy_loader_t<hb_shape_cache_slot_t,
+							      hb_shape_cache_lazy_loader_t>
+{
+  static hb_shape_cache_slot_t * create ()
+  {
+    hb_shape_cache_slot_t *slots = (hb_shape_cache_slot_t *)
+				   hb_calloc (HB_SHAPE_CACHE_SLOTS, sizeof (hb_shape_cache_slot_t));
+    if (unlikely (!slots))
+      return nullptr;
+
+    hb_atexit (free_static_shape_cache);
+
+    return slots;
+  }
+  static void destroy (hb_shape_cache_slot_t *slots)
+  { hb_free (slots); }
+  static hb_shape_cache_slot_t * get_null ()
+  { return nullptr; }
+} static_shape_cache;
+
+static inline
+void free_static_shape_cache ()
+{
+  static_shape_cache.free_instance ();
+}
+
+/* Token serializing writers; writers that lose the race skip caching
+ * instead of waiting, since they already hold a freshly shaped result. */
+static hb_atomic_ptr_t<void> shape_cache_writer_token;
+
+static bool
+hb_shape_cache_fill_key (hb_shape_cache_entry_t *key,
+			 hb_font_t              *font,
+			 hb_buffer_t            *buffer,
+			 const hb_feature_t     *features,
+			 unsigned int            num_features)
+{
+  if (buffer->len == 0 ||
+      buffer->len > HB_SHAPE_CACHE_MAX_CHARS ||
+      num_features > HB_SHAPE_CACHE_MAX_FEATURES ||
+      buffer->content_type != HB_BUFFER_CONTENT_TYPE_UNICODE)
+    return false;
+
+  memset (key, 0, sizeof (*key));
+
+  key->font = font;
+  key->props = buffer->props;
+  key->flags = buffer->flags;
+  key->cluster_level = buffer->cluster_level;
+  key->invisible = buffer->invisible;
+  key->not_found = buffer->not_found;
+  key->num_features = num_features;
+  for (unsigned int i = 0; i < num_features; i++)
+    key->features[i] = features[i];
+  key->text_len = buffer->len;
+  for (unsigned int i = 0; i < buffer->len; i++)
+  {
+    key->text[i] = buffer->info[i].codepoint;
+    key->clusters[i] = buffer->info[i].cluster;
+  }
+
+  return true;
+}
+
+static unsigned int
+hb_shape_cache_slot_index (const hb_shape_cache_entry_t *key)
+{
+  uint32_t hash = 0x811C9DC5u;
+  hash = (hash ^ (uint32_t) (uintptr_t) key->font) * 0x01000193u;
+  hash = (hash ^ (uint32_t) key->props.direction) * 0x01000193u;
+  hash = (hash ^ (uint32_t) key->props.script) * 0x01000193u;
+  hash = (hash ^ (uint32_t) (uintptr_t) key->props.language) * 0x01000193u;
+  for (unsigned int i = 0; i < key->text_len; i++)
+    hash = (hash ^ key->text[i]) * 0x01000193u;
+  return hash & (HB_SHAPE_CACHE_SLOTS - 1);
+}
+
+static bool
+hb_shape_cache_keys_equal (const hb_shape_cache_entry_t *a,
+			   const hb_shape_cache_entry_t *b)
+{
+  if (a->font != b->font ||
+      !hb_segment_properties_equal (&a->props, &b->props) ||
+      a->flags != b->flags ||
+      a->cluster_level != b->cluster_level ||
+      a->invisible != b->invisible ||
+      a->not_found != b->not_found ||
+      a->num_features != b->num_features ||
+      a->text_len != b->text_len)
+    return false;
+
+  if (memcmp (a->features, b->features, a->num_features * sizeof (a->features[0])) != 0)
+    return false;
+
+  return memcmp (a->text, b->text, a->text_len * sizeof (a->text[0])) == 0 &&
+	 memcmp (a->clusters, b->clusters, a->text_len * sizeof (a->clusters[0])) == 0;
+}
+
+static bool
+hb_shape_cache_lookup (hb_shape_cache_slot_t        *slot,
+		       const hb_shape_cache_entry_t *key,
+		       hb_buffer_t                  *buffer,
+		       hb_bool_t                    *result_out)
+{
+  int sequence = slot->sequence.get ();
+  if (sequence == 0 || (sequence & 1))
+    return false;
+
+  if (!hb_shape_cache_keys_equal (&slot->entry, key))
+    return false;
+
+  hb_bool_t shape_result = slot->entry.shape_result;
+  unsigned int num_glyphs = slot->entry.num_glyphs;
+  if (num_glyphs > HB_SHAPE_CACHE_MAX_GLYPHS ||
+      unlikely (!buffer->ensure (num_glyphs)))
+    return false;
+
+  hb_glyph_info_t info[HB_SHAPE_CACHE_MAX_GLYPHS];
+  hb_glyph_position_t pos[HB_SHAPE_CACHE_MAX_GLYPHS];
+  memcpy (info, slot->entry.info, num_glyphs * sizeof (info[0]));
+  memcpy (pos, slot->entry.pos, num_glyphs * sizeof (pos[0]));
+
+  /* The copy above is valid only if no writer touched the slot meanwhile. */
+  if (slot->sequence.get () != sequence)
+    return false;
+
+  memcpy (buffer->info, info, num_glyphs * sizeof (info[0]));
+  memcpy (buffer->pos, pos, num_glyphs * sizeof (pos[0]));
+  buffer->len = num_glyphs;
+  buffer->idx = 0;
+  buffer->content_type = HB_BUFFER_CONTENT_TYPE_GLYPHS;
+  buffer->have_positions = true;
+
+  *result_out = shape_result;
+  return true;
+}
+
+static void
+hb_shape_cache_store (hb_shape_cache_slot_t        *slot,
+		      const hb_shape_cache_entry_t *key,
+		      hb_buffer_t                  *buffer,
+		      hb_bool_t                     shape_result)
+{
+  if (buffer->len > HB_SHAPE_CACHE_MAX_GLYPHS ||
+      buffer->content_type != HB_BUFFER_CONTENT_TYPE_GLYPHS ||
+      !buffer->have_positions ||
+      !buffer->successful)
+    return;
+
+  void *expected = nullptr;
+  if (!shape_cache_writer_token.cmpexch (expected, (void *) slot))
+    return;
+
+  slot->sequence.inc (); /* Now odd: readers discard their copies. */
+
+  slot->entry = *key;
+  slot->entry.shape_result = shape_result;
+  slot->entry.num_glyphs = buffer->len;
+  memcpy (slot->entry.info, buffer->info, buffer->len * sizeof (buffer->info[0]));
+  memcpy (slot->entry.pos, buffer->pos, buffer->len * sizeof (buffer->pos[0]));
+
+  slot->sequence.inc (); /* Even again: entry is visible. */
+
+  void *token = (void *) slot;
+  shape_cache_writer_token.cmpexch (token, nullptr);
+}
+
+/**
+ * hb_shape_cached:
+ * @font: an #hb_font_t to use for shaping
+ * @buffer: an #hb_buffer_t to shape
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or %NULL
+ * @num_features: the length of @features array
+ *
+ * See hb_shape() for details. Shaping results for short runs are memoized in
+ * a fixed-size process-wide cache keyed on the buffer contents, segment
+ * properties, features and @font identity, so repeatedly shaping the same
+ * runs (e.g. while scrolling a list of labels) costs a lookup instead of a
+ * full shaping pass. Runs that do not fit the cache are shaped normally.
+ *
+ * As the cache keys on font identity, @font must not be mutated while cached
+ * results for it may be replayed.
+ *
+ * Return value: false if all shapers failed, true otherwise
+ *
+ * Since: 3.1.1
+ **/
+hb_bool_t
+hb_shape_cached (hb_font_t           *font,
+		 hb_buffer_t         *buffer,
+		 const hb_feature_t  *features,
+		 unsigned int         num_features)
+{
+  hb_shape_cache_entry_t key;
+  hb_shape_cache_slot_t *slots = nullptr;
+  hb_shape_cache_slot_t *slot = nullptr;
+
+  if (hb_shape_cache_fill_key (&key, font, buffer, features, num_features))
+    slots = static_shape_cache.get_unconst ();
+
+  if (slots)
+  {
+    hb_bool_t cached_result = false;
+    slot = &slots[hb_shape_cache_slot_index (&key)];
+    if (hb_shape_cache_lookup (slot, &key, buffer, &cached_result))
+      return cached_result;
+  }
+
+  hb_bool_t res = hb_shape_full (font, buffer, features, num_features, nullptr);
+
+  if (slot)
+    hb_shape_cache_store (slot, &key, buffer, res);
+
+  return res;
+}
@@ -46,6 +46,12 @@ hb_shape (hb_font_t           *font,
 	  const hb_feature_t  *features,
 	  unsigned int         num_features);
 
+HB_EXTERN hb_bool_t
+hb_shape_cached (hb_font_t           *font,
+		 hb_buffer_t         *buffer,
+		 const hb_feature_t  *features,
+		 unsigned int         num_features);
+
 HB_EXTERN hb_bool_t
 hb_shape_full (hb_font_t          *font,
 	       hb_buffer_t        *buffer,
@@ -58,6 +58,7 @@
 
 #include <sys/mman.h>
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstdint>
 #include <memory>
@@ -296,6 +297,10 @@ class FileBackedVector {
   //   OUT_OF_RANGE_ERROR if we can't grow to the specified size
   libtextclassifier3::Status GrowIfNecessary(int32_t num_elements);
 
+  // Marks the mapped page(s) containing element idx as dirty, so that
+  // PersistToDisk() only needs to sync what actually changed.
+  void SetDirty(int32_t idx);
+
   // Cached constructor params.
   const Filesystem* const filesystem_;
   const std::string file_path_;
@@ -564,9 +569,24 @@ libtextclassifier3::Status FileBackedVector<T>::Set(int32_t idx,
   }
 
   mutable_array()[idx] = value;
+  SetDirty(idx);
   return libtextclassifier3::Status::OK;
 }
 
+template <typename T>
+void FileBackedVector<T>::SetDirty(int32_t idx) {
+  const size_t page_size = MemoryMappedFile::system_page_size();
+  const int64_t start_byte = static_cast<int64_t>(idx) * sizeof(T);
+  const int64_t end_byte = start_byte + sizeof(T);  // Exclusive.
+  for (size_t page = start_byte / page_size;
+       static_cast<int64_t>(page * page_size) < end_byte; ++page) {
+    if (page >= dirty_pages_.size()) {
+      dirty_pages_.resize(page + 1, false);
+    }
+    dirty_pages_[page] = true;
+  }
+}
+
 template <typename T>
 libtextclassifier3::Status FileBackedVector<T>::GrowIfNecessary(
     int32_t num_elements) {
@@ -769,9 +789,29 @@ libtextclassifier3::Status FileBackedVector<T>::PersistToDisk() {
 
   if (strategy == MemoryMappedFile::Strategy::READ_WRITE_AUTO_SYNC) {
     // Changes should have been applied to the underlying file, but call msync()
-    // as an extra safety step to ensure they are written out.
-    ICING_RETURN_IF_ERROR(mmapped_file_->PersistToDisk());
+    // as an extra safety step to ensure they are written out. Only the pages
+    // written through Set() since the last persist are synced, so checkpoint
+    // latency is proportional to what changed rather than to the vector size.
+    const size_t page_size = MemoryMappedFile::system_page_size();
+    const size_t region_size = mmapped_file_->region_size();
+    size_t page = 0;
+    while (page < dirty_pages_.size()) {
+      if (!dirty_pages_[page]) {
+        ++page;
+        continue;
+      }
+      const size_t run_begin = page;
+      while (page < dirty_pages_.size() && dirty_pages_[page]) {
+        ++page;
+      }
+      const size_t offset = run_begin * page_size;
+      if (offset < region_size) {
+        const size_t length = std::min(page * page_size, region_size) - offset;
+        ICING_RETURN_IF_ERROR(mmapped_file_->PersistToDisk(offset, length));
+      }
+    }
   }
+  dirty_pages_.clear();
 
   return libtextclassifier3::Status::OK;
 }
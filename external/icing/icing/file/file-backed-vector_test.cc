@@ -698,6 +698,38 @@ TEST_F(FileBackedVectorTest, BadFileSizeDuringGrowReturnsError) {
               StatusIs(libtextclassifier3::StatusCode::INTERNAL));
 }
 
+TEST_F(FileBackedVectorTest, IncrementalPersistKeepsScatteredWrites) {
+  // PersistToDisk only syncs the pages written since the last persist, so
+  // exercise writes scattered over several pages and make sure everything
+  // survives a reopen.
+  constexpr int32_t kStride = 3000;  // Less than a page apart, in ints.
+  {
+    ICING_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<FileBackedVector<int>> vector,
+        FileBackedVector<int>::Create(
+            filesystem_, file_path_,
+            MemoryMappedFile::Strategy::READ_WRITE_AUTO_SYNC));
+    for (int i = 0; i < 10; ++i) {
+      ICING_ASSERT_OK(vector->Set(i * kStride, i + 1));
+    }
+    ICING_ASSERT_OK(vector->PersistToDisk());
+
+    // A second persist with only one additional write is fine too.
+    ICING_ASSERT_OK(vector->Set(5 * kStride + 1, 42));
+    ICING_ASSERT_OK(vector->PersistToDisk());
+  }
+
+  ICING_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<FileBackedVector<int>> vector,
+      FileBackedVector<int>::Create(
+          filesystem_, file_path_,
+          MemoryMappedFile::Strategy::READ_WRITE_AUTO_SYNC));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_THAT(vector->Get(i * kStride), IsOkAndHolds(Pointee(i + 1)));
+  }
+  EXPECT_THAT(vector->Get(5 * kStride + 1), IsOkAndHolds(Pointee(42)));
+}
+
 }  // namespace
 
 }  // namespace lib
@@ -168,6 +168,51 @@ libtextclassifier3::Status MemoryMappedFile::PersistToDisk() {
   return libtextclassifier3::Status::OK;
 }
 
+libtextclassifier3::Status MemoryMappedFile::PersistToDisk(size_t offset,
+                                                           size_t length) {
+  if (strategy_ == Strategy::READ_ONLY) {
+    return absl_ports::FailedPreconditionError(absl_ports::StrCat(
+        "Attempting to PersistToDisk on a read-only file: ", file_path_));
+  }
+
+  if (region_ == nullptr || length == 0) {
+    // Nothing mapped (or nothing requested) to sync.
+    return libtextclassifier3::Status::OK;
+  }
+
+  if (offset > region_size_ || length > region_size_ - offset) {
+    return absl_ports::OutOfRangeError(IcingStringUtil::StringPrintf(
+        "Requested sync range (%zd, %zd) doesn't fit in region of size %zd",
+        offset, length, region_size_));
+  }
+
+  if (strategy_ == Strategy::READ_WRITE_AUTO_SYNC) {
+    // msync() requires a page-aligned address, so expand the range to page
+    // boundaries. region_ itself is not necessarily page-aligned (it is
+    // mmap_result_ plus the in-page adjustment of the requested file offset),
+    // so align based on the actual mapped addresses.
+    uintptr_t sync_begin = reinterpret_cast<uintptr_t>(region_ + offset);
+    uintptr_t sync_end = sync_begin + length;
+    sync_begin -= sync_begin % system_page_size();
+    if (msync(reinterpret_cast<void*>(sync_begin), sync_end - sync_begin,
+              MS_SYNC) != 0) {
+      return absl_ports::InternalError(
+          absl_ports::StrCat("Unable to sync file using msync(): ", file_path_));
+    }
+  }
+
+  // See PersistToDisk(): MAP_PRIVATE mappings can't be synced with msync(),
+  // so write the requested range directly to the underlying file.
+  if (strategy_ == Strategy::READ_WRITE_MANUAL_SYNC &&
+      !filesystem_->PWrite(file_path_.c_str(), file_offset_ + offset,
+                           region() + offset, length)) {
+    return absl_ports::InternalError(
+        absl_ports::StrCat("Unable to sync file using PWrite(): ", file_path_));
+  }
+
+  return libtextclassifier3::Status::OK;
+}
+
 libtextclassifier3::Status MemoryMappedFile::OptimizeFor(
     AccessPattern access_pattern) {
   int madvise_flag = 0;
@@ -105,6 +105,20 @@ class MemoryMappedFile {
   //   FAILED_PRECONDITION if Strategy is not implemented
   libtextclassifier3::Status PersistToDisk();
 
+  // Explicitly persist only the subrange [offset, offset + length) of the
+  // currently mapped region to disk. `offset` is relative to region(). The
+  // range is expanded to page boundaries for msync(). Much cheaper than a
+  // full PersistToDisk() when only a small part of a large region changed.
+  //
+  // NOTE: This is only valid if Strategy=READ_WRITE was used.
+  //
+  // Returns:
+  //   OK on success
+  //   OUT_OF_RANGE if the range doesn't fit in the mapped region
+  //   INTERNAL on I/O error
+  //   FAILED_PRECONDITION if Strategy is not implemented
+  libtextclassifier3::Status PersistToDisk(size_t offset, size_t length);
+
   // Advise the system to help it optimize the memory-mapped region for
   // upcoming read/write operations.
   //
@@ -120,6 +120,17 @@ uint64_t Fingerprint64(const char* s, size_t len);
 // Fingerprint function for a byte array.
 uint128_t Fingerprint128(const char* s, size_t len);
 
+// BATCH FINGERPRINTING
+
+// Fingerprint function for a batch of byte arrays. Writes
+// Fingerprint64(data[i], lengths[i]) to hashes[i] for i in [0, count).
+// Produces exactly the same values as per-element Fingerprint64 calls, but
+// schedules several independent inputs per loop iteration and prefetches
+// upcoming inputs, so token streams (many small strings) hash at a much
+// higher throughput than one-at-a-time calls.
+void Fingerprint64Batch(const char* const* data, const size_t* lengths,
+                        size_t count, uint64_t* hashes);
+
 // This is intended to be a good fingerprinting primitive.
 // See below for more overloads.
 inline uint64_t Fingerprint(uint128_t x) {
@@ -248,6 +259,28 @@ inline uint64_t Fingerprint64(const Str& s) {
   return Fingerprint64(s.data(), s.length());
 }
 
+// Fingerprint function for a batch of C++ strings (or string views); see the
+// pointer-based Fingerprint64Batch above. Writes Fingerprint64(strs[i]) to
+// hashes[i] for i in [0, count).
+template <typename Str>
+inline void Fingerprint64Batch(const Str* strs, size_t count, uint64_t* hashes) {
+  const size_t kChunk = 64;
+  const char* data[kChunk];
+  size_t lengths[kChunk];
+  while (count > 0) {
+    size_t n = count < kChunk ? count : kChunk;
+    for (size_t i = 0; i < n; i++) {
+      assert(sizeof(strs[i][0]) == 1);
+      data[i] = strs[i].data();
+      lengths[i] = strs[i].length();
+    }
+    Fingerprint64Batch(data, lengths, n, hashes);
+    strs += n;
+    hashes += n;
+    count -= n;
+  }
+}
+
 // Fingerprint function for a byte array.
 template <typename Str>
 inline uint128_t Fingerprint128(const Str& s) {
@@ -1023,205 +1023,270 @@ void AudioFlinger::unregisterWriter(const sp<NBLog::Writer>& writer)
 
 // IAudioFlinger interface
 
-status_t AudioFlinger::createTrack(const media::CreateTrackRequest& _input,
-                                   media::CreateTrackResponse& _output)
-{
-    // Local version of VALUE_OR_RETURN, specific to this method's calling conventions.
-    CreateTrackInput input = VALUE_OR_RETURN_STATUS(CreateTrackInput::fromAidl(_input));
+// Track creation is split into three phases so that createTracks() can apply
+// a whole batch of requests under a single hold of mLock:
+//  - createTrackPrepare() validates the request and performs the policy
+//    routing (getOutputForAttr()), with no AudioFlinger lock held;
+//  - createTrackApply_l() creates the track on its thread, under mLock;
+//  - createTrackFinish() builds the response or unwinds, with no lock held.
+// createTrack() chains the three for the single-request binder call.
+struct AudioFlinger::TrackCreation {
+    CreateTrackInput input;
     CreateTrackOutput output;
-
     sp<PlaybackThread::Track> track;
-    sp<TrackHandle> trackHandle;
     sp<Client> client;
-    status_t lStatus;
-    audio_stream_type_t streamType;
+    status_t lStatus = NO_ERROR;
+    bool prepared = false;      // createTrackPrepare() passed all checks
+    audio_stream_type_t streamType = AUDIO_STREAM_DEFAULT;
     audio_port_handle_t portId = AUDIO_PORT_HANDLE_NONE;
     std::vector<audio_io_handle_t> secondaryOutputs;
-    bool isSpatialized = false;;
+    bool isSpatialized = false;
+    pid_t clientPid = (pid_t)-1;
+    pid_t callingPid = (pid_t)-1;
+    audio_io_handle_t effectThreadId = AUDIO_IO_HANDLE_NONE;
+    std::vector<int> effectIds;
+    audio_attributes_t localAttr{};
+    AttributionSourceState adjAttributionSource;
+    audio_session_t sessionId = AUDIO_SESSION_NONE;
+};
+
+status_t AudioFlinger::createTrackPrepare(const media::CreateTrackRequest& _input,
+                                          TrackCreation& c)
+{
+    // Local version of VALUE_OR_RETURN, specific to this method's calling conventions.
+    c.input = VALUE_OR_RETURN_STATUS(CreateTrackInput::fromAidl(_input));
 
     // TODO b/182392553: refactor or make clearer
     pid_t clientPid =
-        VALUE_OR_RETURN_STATUS(aidl2legacy_int32_t_pid_t(input.clientInfo.attributionSource.pid));
+        VALUE_OR_RETURN_STATUS(aidl2legacy_int32_t_pid_t(c.input.clientInfo.attributionSource.pid));
     bool updatePid = (clientPid == (pid_t)-1);
     const uid_t callingUid = IPCThreadState::self()->getCallingUid();
     uid_t clientUid =
-        VALUE_OR_RETURN_STATUS(aidl2legacy_int32_t_uid_t(input.clientInfo.attributionSource.uid));
-    audio_io_handle_t effectThreadId = AUDIO_IO_HANDLE_NONE;
-    std::vector<int> effectIds;
-    audio_attributes_t localAttr = input.attr;
+        VALUE_OR_RETURN_STATUS(aidl2legacy_int32_t_uid_t(c.input.clientInfo.attributionSource.uid));
+    c.localAttr = c.input.attr;
 
-    AttributionSourceState adjAttributionSource = input.clientInfo.attributionSource;
+    c.adjAttributionSource = c.input.clientInfo.attributionSource;
     if (!isAudioServerOrMediaServerUid(callingUid)) {
         ALOGW_IF(clientUid != callingUid,
                 "%s uid %d tried to pass itself off as %d",
                 __FUNCTION__, callingUid, clientUid);
-        adjAttributionSource.uid = VALUE_OR_RETURN_STATUS(legacy2aidl_uid_t_int32_t(callingUid));
+        c.adjAttributionSource.uid = VALUE_OR_RETURN_STATUS(legacy2aidl_uid_t_int32_t(callingUid));
         clientUid = callingUid;
         updatePid = true;
     }
-    const pid_t callingPid = IPCThreadState::self()->getCallingPid();
+    c.callingPid = IPCThreadState::self()->getCallingPid();
     if (updatePid) {
-        ALOGW_IF(clientPid != (pid_t)-1 && clientPid != callingPid,
+        ALOGW_IF(clientPid != (pid_t)-1 && clientPid != c.callingPid,
                  "%s uid %d pid %d tried to pass itself off as pid %d",
-                 __func__, callingUid, callingPid, clientPid);
-        clientPid = callingPid;
-        adjAttributionSource.pid = VALUE_OR_RETURN_STATUS(legacy2aidl_pid_t_int32_t(callingPid));
+                 __func__, callingUid, c.callingPid, clientPid);
+        clientPid = c.callingPid;
+        c.adjAttributionSource.pid =
+                VALUE_OR_RETURN_STATUS(legacy2aidl_pid_t_int32_t(c.callingPid));
     }
+    c.clientPid = clientPid;
 
-    audio_session_t sessionId = input.sessionId;
-    if (sessionId == AUDIO_SESSION_ALLOCATE) {
-        sessionId = (audio_session_t) newAudioUniqueId(AUDIO_UNIQUE_ID_USE_SESSION);
-    } else if (audio_unique_id_get_use(sessionId) != AUDIO_UNIQUE_ID_USE_SESSION) {
-        lStatus = BAD_VALUE;
-        goto Exit;
+    c.sessionId = c.input.sessionId;
+    if (c.sessionId == AUDIO_SESSION_ALLOCATE) {
+        c.sessionId = (audio_session_t) newAudioUniqueId(AUDIO_UNIQUE_ID_USE_SESSION);
+    } else if (audio_unique_id_get_use(c.sessionId) != AUDIO_UNIQUE_ID_USE_SESSION) {
+        return BAD_VALUE;
     }
 
-    output.sessionId = sessionId;
-    output.outputId = AUDIO_IO_HANDLE_NONE;
-    output.selectedDeviceId = input.selectedDeviceId;
-    lStatus = AudioSystem::getOutputForAttr(&localAttr, &output.outputId, sessionId, &streamType,
-                                            adjAttributionSource, &input.config, input.flags,
-                                            &output.selectedDeviceId, &portId, &secondaryOutputs,
-                                            &isSpatialized);
+    c.output.sessionId = c.sessionId;
+    c.output.outputId = AUDIO_IO_HANDLE_NONE;
+    c.output.selectedDeviceId = c.input.selectedDeviceId;
+    const status_t lStatus = AudioSystem::getOutputForAttr(&c.localAttr, &c.output.outputId,
+                                            c.sessionId, &c.streamType,
+                                            c.adjAttributionSource, &c.input.config, c.input.flags,
+                                            &c.output.selectedDeviceId, &c.portId,
+                                            &c.secondaryOutputs, &c.isSpatialized);
 
-    if (lStatus != NO_ERROR || output.outputId == AUDIO_IO_HANDLE_NONE) {
+    if (lStatus != NO_ERROR || c.output.outputId == AUDIO_IO_HANDLE_NONE) {
         ALOGE("createTrack() getOutputForAttr() return error %d or invalid output handle", lStatus);
-        goto Exit;
+        return lStatus;
     }
     // client AudioTrack::set already implements AUDIO_STREAM_DEFAULT => AUDIO_STREAM_MUSIC,
     // but if someone uses binder directly they could bypass that and cause us to crash
-    if (uint32_t(streamType) >= AUDIO_STREAM_CNT) {
-        ALOGE("createTrack() invalid stream type %d", streamType);
-        lStatus = BAD_VALUE;
-        goto Exit;
+    if (uint32_t(c.streamType) >= AUDIO_STREAM_CNT) {
+        ALOGE("createTrack() invalid stream type %d", c.streamType);
+        return BAD_VALUE;
     }
 
     // further channel mask checks are performed by createTrack_l() depending on the thread type
-    if (!audio_is_output_channel(input.config.channel_mask)) {
-        ALOGE("createTrack() invalid channel mask %#x", input.config.channel_mask);
-        lStatus = BAD_VALUE;
-        goto Exit;
+    if (!audio_is_output_channel(c.input.config.channel_mask)) {
+        ALOGE("createTrack() invalid channel mask %#x", c.input.config.channel_mask);
+        return BAD_VALUE;
     }
 
     // further format checks are performed by createTrack_l() depending on the thread type
-    if (!audio_is_valid_format(input.config.format)) {
-        ALOGE("createTrack() invalid format %#x", input.config.format);
-        lStatus = BAD_VALUE;
-        goto Exit;
+    if (!audio_is_valid_format(c.input.config.format)) {
+        ALOGE("createTrack() invalid format %#x", c.input.config.format);
+        return BAD_VALUE;
     }
 
-    {
-        Mutex::Autolock _l(mLock);
-        PlaybackThread *thread = checkPlaybackThread_l(output.outputId);
-        if (thread == NULL) {
-            ALOGE("no playback thread found for output handle %d", output.outputId);
-            lStatus = BAD_VALUE;
-            goto Exit;
-        }
+    c.prepared = true;
+    return NO_ERROR;
+}
 
-        client = registerPid(clientPid);
+void AudioFlinger::createTrackApply_l(TrackCreation& c)
+{
+    if (!c.prepared) {
+        return;
+    }
+    PlaybackThread *thread = checkPlaybackThread_l(c.output.outputId);
+    if (thread == NULL) {
+        ALOGE("no playback thread found for output handle %d", c.output.outputId);
+        c.lStatus = BAD_VALUE;
+        return;
+    }
 
-        PlaybackThread *effectThread = NULL;
-        // check if an effect chain with the same session ID is present on another
-        // output thread and move it here.
-        for (size_t i = 0; i < mPlaybackThreads.size(); i++) {
-            sp<PlaybackThread> t = mPlaybackThreads.valueAt(i);
-            if (mPlaybackThreads.keyAt(i) != output.outputId) {
-                uint32_t sessions = t->hasAudioSession(sessionId);
-                if (sessions & ThreadBase::EFFECT_SESSION) {
-                    effectThread = t.get();
-                    break;
-                }
-            }
-        }
-        ALOGV("createTrack() sessionId: %d", sessionId);
+    c.client = registerPid(c.clientPid);
 
-        output.sampleRate = input.config.sample_rate;
-        output.frameCount = input.frameCount;
-        output.notificationFrameCount = input.notificationFrameCount;
-        output.flags = input.flags;
-        output.streamType = streamType;
-
-        track = thread->createTrack_l(client, streamType, localAttr, &output.sampleRate,
-                                      input.config.format, input.config.channel_mask,
-                                      &output.frameCount, &output.notificationFrameCount,
-                                      input.notificationsPerBuffer, input.speed,
-                                      input.sharedBuffer, sessionId, &output.flags,
-                                      callingPid, adjAttributionSource, input.clientInfo.clientTid,
-                                      &lStatus, portId, input.audioTrackCallback, isSpatialized);
-        LOG_ALWAYS_FATAL_IF((lStatus == NO_ERROR) && (track == 0));
-        // we don't abort yet if lStatus != NO_ERROR; there is still work to be done regardless
-
-        output.afFrameCount = thread->frameCount();
-        output.afSampleRate = thread->sampleRate();
-        output.afLatencyMs = thread->latency();
-        output.portId = portId;
-
-        if (lStatus == NO_ERROR) {
-            // Connect secondary outputs. Failure on a secondary output must not imped the primary
-            // Any secondary output setup failure will lead to a desync between the AP and AF until
-            // the track is destroyed.
-            updateSecondaryOutputsForTrack_l(track.get(), thread, secondaryOutputs);
-        }
-
-        // move effect chain to this output thread if an effect on same session was waiting
-        // for a track to be created
-        if (lStatus == NO_ERROR && effectThread != NULL) {
-            // no risk of deadlock because AudioFlinger::mLock is held
-            Mutex::Autolock _dl(thread->mLock);
-            Mutex::Autolock _sl(effectThread->mLock);
-            if (moveEffectChain_l(sessionId, effectThread, thread) == NO_ERROR) {
-                effectThreadId = thread->id();
-                effectIds = thread->getEffectIds_l(sessionId);
+    PlaybackThread *effectThread = NULL;
+    // check if an effect chain with the same session ID is present on another
+    // output thread and move it here.
+    for (size_t i = 0; i < mPlaybackThreads.size(); i++) {
+        sp<PlaybackThread> t = mPlaybackThreads.valueAt(i);
+        if (mPlaybackThreads.keyAt(i) != c.output.outputId) {
+            uint32_t sessions = t->hasAudioSession(c.sessionId);
+            if (sessions & ThreadBase::EFFECT_SESSION) {
+                effectThread = t.get();
+                break;
             }
         }
-
-        // Look for sync events awaiting for a session to be used.
-        for (size_t i = 0; i < mPendingSyncEvents.size(); i++) {
-            if (mPendingSyncEvents[i]->triggerSession() == sessionId) {
-                if (thread->isValidSyncEvent(mPendingSyncEvents[i])) {
-                    if (lStatus == NO_ERROR) {
-                        (void) track->setSyncEvent(mPendingSyncEvents[i]);
-                    } else {
-                        mPendingSyncEvents[i]->cancel();
-                    }
-                    mPendingSyncEvents.removeAt(i);
-                    i--;
+    }
+    ALOGV("createTrack() sessionId: %d", c.sessionId);
+
+    c.output.sampleRate = c.input.config.sample_rate;
+    c.output.frameCount = c.input.frameCount;
+    c.output.notificationFrameCount = c.input.notificationFrameCount;
+    c.output.flags = c.input.flags;
+    c.output.streamType = c.streamType;
+
+    c.track = thread->createTrack_l(c.client, c.streamType, c.localAttr, &c.output.sampleRate,
+                                  c.input.config.format, c.input.config.channel_mask,
+                                  &c.output.frameCount, &c.output.notificationFrameCount,
+                                  c.input.notificationsPerBuffer, c.input.speed,
+                                  c.input.sharedBuffer, c.sessionId, &c.output.flags,
+                                  c.callingPid, c.adjAttributionSource, c.input.clientInfo.clientTid,
+                                  &c.lStatus, c.portId, c.input.audioTrackCallback, c.isSpatialized);
+    LOG_ALWAYS_FATAL_IF((c.lStatus == NO_ERROR) && (c.track == 0));
+    // we don't abort yet if lStatus != NO_ERROR; there is still work to be done regardless
+
+    c.output.afFrameCount = thread->frameCount();
+    c.output.afSampleRate = thread->sampleRate();
+    c.output.afLatencyMs = thread->latency();
+    c.output.portId = c.portId;
+
+    if (c.lStatus == NO_ERROR) {
+        // Connect secondary outputs. Failure on a secondary output must not imped the primary
+        // Any secondary output setup failure will lead to a desync between the AP and AF until
+        // the track is destroyed.
+        updateSecondaryOutputsForTrack_l(c.track.get(), thread, c.secondaryOutputs);
+    }
+
+    // move effect chain to this output thread if an effect on same session was waiting
+    // for a track to be created
+    if (c.lStatus == NO_ERROR && effectThread != NULL) {
+        // no risk of deadlock because AudioFlinger::mLock is held
+        Mutex::Autolock _dl(thread->mLock);
+        Mutex::Autolock _sl(effectThread->mLock);
+        if (moveEffectChain_l(c.sessionId, effectThread, thread) == NO_ERROR) {
+            c.effectThreadId = thread->id();
+            c.effectIds = thread->getEffectIds_l(c.sessionId);
+        }
+    }
+
+    // Look for sync events awaiting for a session to be used.
+    for (size_t i = 0; i < mPendingSyncEvents.size(); i++) {
+        if (mPendingSyncEvents[i]->triggerSession() == c.sessionId) {
+            if (thread->isValidSyncEvent(mPendingSyncEvents[i])) {
+                if (c.lStatus == NO_ERROR) {
+                    (void) c.track->setSyncEvent(mPendingSyncEvents[i]);
+                } else {
+                    mPendingSyncEvents[i]->cancel();
                 }
+                mPendingSyncEvents.removeAt(i);
+                i--;
             }
         }
-        if ((output.flags & AUDIO_OUTPUT_FLAG_HW_AV_SYNC) == AUDIO_OUTPUT_FLAG_HW_AV_SYNC) {
-            setAudioHwSyncForSession_l(thread, sessionId);
-        }
     }
+    if ((c.output.flags & AUDIO_OUTPUT_FLAG_HW_AV_SYNC) == AUDIO_OUTPUT_FLAG_HW_AV_SYNC) {
+        setAudioHwSyncForSession_l(thread, c.sessionId);
+    }
+}
 
-    if (lStatus != NO_ERROR) {
-        // remove local strong reference to Client before deleting the Track so that the
-        // Client destructor is called by the TrackBase destructor with mClientLock held
-        // Don't hold mClientLock when releasing the reference on the track as the
-        // destructor will acquire it.
-        {
-            Mutex::Autolock _cl(mClientLock);
-            client.clear();
+status_t AudioFlinger::createTrackFinish(TrackCreation& c, media::CreateTrackResponse& _output)
+{
+    if (c.prepared && c.lStatus == NO_ERROR) {
+        // effectThreadId is not NONE if an effect chain corresponding to the track session
+        // was found on another thread and must be moved on this thread
+        if (c.effectThreadId != AUDIO_IO_HANDLE_NONE) {
+            AudioSystem::moveEffectsToIo(c.effectIds, c.effectThreadId);
         }
-        track.clear();
-        goto Exit;
+
+        c.output.audioTrack = new TrackHandle(c.track);
+        _output = VALUE_OR_FATAL(c.output.toAidl());
+        return NO_ERROR;
     }
 
-    // effectThreadId is not NONE if an effect chain corresponding to the track session
-    // was found on another thread and must be moved on this thread
-    if (effectThreadId != AUDIO_IO_HANDLE_NONE) {
-        AudioSystem::moveEffectsToIo(effectIds, effectThreadId);
+    // remove local strong reference to Client before deleting the Track so that the
+    // Client destructor is called by the TrackBase destructor with mClientLock held
+    // Don't hold mClientLock when releasing the reference on the track as the
+    // destructor will acquire it.
+    {
+        Mutex::Autolock _cl(mClientLock);
+        c.client.clear();
     }
+    c.track.clear();
 
-    output.audioTrack = new TrackHandle(track);
-    _output = VALUE_OR_FATAL(output.toAidl());
+    if (c.lStatus != NO_ERROR && c.output.outputId != AUDIO_IO_HANDLE_NONE) {
+        AudioSystem::releaseOutput(c.portId);
+    }
+    return c.lStatus;
+}
 
-Exit:
-    if (lStatus != NO_ERROR && output.outputId != AUDIO_IO_HANDLE_NONE) {
-        AudioSystem::releaseOutput(portId);
+status_t AudioFlinger::createTrack(const media::CreateTrackRequest& _input,
+                                   media::CreateTrackResponse& _output)
+{
+    TrackCreation c;
+    c.lStatus = createTrackPrepare(_input, c);
+    if (c.prepared) {
+        Mutex::Autolock _l(mLock);
+        createTrackApply_l(c);
     }
-    return lStatus;
+    return createTrackFinish(c, _output);
+}
+
+status_t AudioFlinger::createTracks(const std::vector<media::CreateTrackRequest>& requests,
+                                    std::vector<media::CreateTrackResponse>* responses,
+                                    std::vector<status_t>* statuses)
+{
+    // Policy routing runs per request with no lock held, as in createTrack();
+    // the service lock is then taken once for the whole batch, so a client
+    // starting many sounds in one frame pays one lock acquisition instead of
+    // one per track. Entries fail independently: a bad request yields its own
+    // status and does not abort the rest of the batch.
+    std::vector<TrackCreation> creations(requests.size());
+    responses->clear();
+    responses->resize(requests.size());
+    statuses->assign(requests.size(), NO_ERROR);
+
+    bool anyPrepared = false;
+    for (size_t i = 0; i < requests.size(); i++) {
+        creations[i].lStatus = createTrackPrepare(requests[i], creations[i]);
+        anyPrepared |= creations[i].prepared;
+    }
+    if (anyPrepared) {
+        Mutex::Autolock _l(mLock);
+        for (auto& c : creations) {
+            createTrackApply_l(c);
+        }
+    }
+    for (size_t i = 0; i < requests.size(); i++) {
+        (*statuses)[i] = createTrackFinish(creations[i], (*responses)[i]);
+    }
+    return NO_ERROR;
 }
 
 uint32_t AudioFlinger::sampleRate(audio_io_handle_t ioHandle) const
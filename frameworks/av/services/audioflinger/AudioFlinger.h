@@ -85,7 +85,11 @@
 #include <audio_utils/TimestampVerifier.h>
 
 #include "FastCapture.h"
+#include "AudioWorkerPool.h"
+#include "CycleProfiler.h"
 #include "FastMixer.h"
+#include "FastMixerBufferSizer.h"
+#include "FormatCopier.h"
 #include <media/nbaio/NBAIO.h>
 #include "AudioWatchdog.h"
 #include "AudioStreamOut.h"
@@ -146,6 +150,13 @@ public:
     status_t createRecord(const media::CreateRecordRequest& input,
                           media::CreateRecordResponse& output) override;
 
+    // Batched variant of createTrack(): creates all requested tracks while
+    // holding the service lock once, with a status per entry. Carried over
+    // binder as a single transaction by the IAudioFlinger batching methods.
+    status_t createTracks(const std::vector<media::CreateTrackRequest>& requests,
+                          std::vector<media::CreateTrackResponse>* responses,
+                          std::vector<status_t>* statuses);
+
     virtual     uint32_t    sampleRate(audio_io_handle_t ioHandle) const;
     virtual     audio_format_t format(audio_io_handle_t output) const;
     virtual     size_t      frameCount(audio_io_handle_t ioHandle) const;
@@ -810,6 +821,14 @@ using effect_buffer_t = int16_t;
                       PlaybackThread* thread,
                       const std::vector<audio_io_handle_t>& secondaryOutputs) const;
 
+              // Phases of track creation; see the comment above
+              // createTrackPrepare() in AudioFlinger.cpp.
+              struct TrackCreation;
+              status_t createTrackPrepare(const media::CreateTrackRequest& request,
+                                          TrackCreation& c);
+              void createTrackApply_l(TrackCreation& c);
+              status_t createTrackFinish(TrackCreation& c, media::CreateTrackResponse& response);
+
 
                 void        removeClient_l(pid_t pid);
                 void        removeNotificationClient(pid_t pid);
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_WORKER_POOL_H
+#define ANDROID_AUDIO_WORKER_POOL_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace android {
+
+// A small fork-join pool for per-track work on AudioFlinger service
+// threads: run() executes work(0) .. work(count - 1), handing indices to
+// the workers and to the calling thread, and returns once every call has
+// completed. Tasks must be independent of each other.
+//
+// Create the pool from the service thread that will use it so the workers
+// inherit its scheduling policy and priority. run() is not reentrant and
+// must always be called from the same thread.
+class AudioWorkerPool {
+public:
+    AudioWorkerPool(size_t numThreads, const char* name) {
+        for (size_t i = 0; i < numThreads; i++) {
+            mThreads.emplace_back([this, name] {
+                pthread_setname_np(pthread_self(), name);
+                workerLoop();
+            });
+        }
+    }
+
+    ~AudioWorkerPool() {
+        {
+            std::lock_guard<std::mutex> _l(mMutex);
+            mExit = true;
+        }
+        mWorkCV.notify_all();
+        for (auto& t : mThreads) {
+            t.join();
+        }
+    }
+
+    void run(size_t count, const std::function<void(size_t)>& work) {
+        if (count == 0) return;
+        if (count == 1 || mThreads.empty()) {
+            for (size_t i = 0; i < count; i++) work(i);
+            return;
+        }
+        // Batch state lives on the heap so a worker that wakes up late and
+        // finds its batch already drained touches only that batch's
+        // counters, never a later batch's.
+        const auto batch = std::make_shared<Batch>(work, count);
+        {
+            std::lock_guard<std::mutex> _l(mMutex);
+            mBatch = batch;
+            mGeneration++;
+        }
+        mWorkCV.notify_all();
+
+        // The caller works too, so a cold or preempted worker never makes
+        // the batch slower than running it inline.
+        runBatch(*batch);
+
+        std::unique_lock<std::mutex> _l(mMutex);
+        mDoneCV.wait(_l, [&batch] {
+            return batch->completed.load(std::memory_order_acquire) == batch->count;
+        });
+        mBatch = nullptr;
+    }
+
+private:
+    struct Batch {
+        Batch(const std::function<void(size_t)>& w, size_t c) : work(w), count(c) { }
+        const std::function<void(size_t)>& work;  // owned by run()'s caller
+        const size_t count;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> completed{0};
+    };
+
+    void runBatch(Batch& batch) {
+        for (;;) {
+            const size_t i = batch.next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= batch.count) break;
+            batch.work(i);
+            if (batch.completed.fetch_add(1, std::memory_order_release) + 1 == batch.count) {
+                // Taking the mutex orders this notify against run()'s
+                // predicate check, so the completion can't slip between the
+                // check and the wait.
+                { std::lock_guard<std::mutex> _l(mMutex); }
+                mDoneCV.notify_one();
+            }
+        }
+    }
+
+    void workerLoop() {
+        uint64_t seenGeneration = 0;
+        for (;;) {
+            std::shared_ptr<Batch> batch;
+            {
+                std::unique_lock<std::mutex> _l(mMutex);
+                mWorkCV.wait(_l, [this, seenGeneration] {
+                    return mExit || mGeneration != seenGeneration;
+                });
+                if (mExit) return;
+                seenGeneration = mGeneration;
+                batch = mBatch;
+            }
+            if (batch != nullptr) {
+                runBatch(*batch);
+            }
+        }
+    }
+
+    std::mutex mMutex;
+    std::condition_variable mWorkCV;    // signaled when a batch is published or on exit
+    std::condition_variable mDoneCV;    // signaled when the last index completes
+    std::shared_ptr<Batch> mBatch;      // non-null while a batch is in flight
+    uint64_t mGeneration = 0;
+    bool mExit = false;
+    std::vector<std::thread> mThreads;
+};
+
+}   // namespace android
+
+#endif  // ANDROID_AUDIO_WORKER_POOL_H
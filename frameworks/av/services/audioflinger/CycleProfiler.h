@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_CYCLE_PROFILER_H
+#define ANDROID_AUDIO_CYCLE_PROFILER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <audio_utils/Histogram.h>
+
+namespace android {
+
+// Continuous per-cycle CPU budget profiler for the playback threads.
+//
+// AudioWatchdog watches for gross stalls from the outside; this profiler is
+// fed from inside threadLoop(). cycleBegin() samples the thread CPU clock,
+// each stageEnd() attributes the CPU time since the previous mark to one of
+// the loop stages, and cycleEnd() closes the cycle. Stage times accumulate
+// into histograms readable from dumpsys, and a cycle whose total CPU time
+// exceeds its budget (the mix period) logs a one-shot per-stage breakdown,
+// throttled like the watchdog, so the stage that blew the budget can be
+// attributed after the fact.
+//
+// A thread CPU clock read costs well under a microsecond; a handful of reads
+// per mix period is noise. Sleeping (standby waits, write throttling) does
+// not advance the thread CPU clock and so does not pollute the histograms.
+//
+// The writer is the owning thread; dump() from another thread gets the usual
+// advisory view, like the fast thread dump state.
+class CycleProfiler {
+public:
+    enum Stage {
+        STAGE_PREPARE,  // processConfigEvents_l() through prepareTracks_l()
+        STAGE_MIX,      // threadLoop_mix() and mixer buffer conversion
+        STAGE_EFFECTS,  // effect chain processing and effect buffer copy
+        STAGE_WRITE,    // threadLoop_write() and timing bookkeeping
+        STAGE_COUNT
+    };
+
+    void cycleBegin(int64_t budgetNs) {
+        mBudgetNs = budgetNs;
+        mCycleStartNs = mLastMarkNs = threadCpuNowNs();
+        for (int64_t& ns : mStageNs) {
+            ns = 0;
+        }
+    }
+
+    void stageEnd(Stage stage) {
+        const int64_t now = threadCpuNowNs();
+        mStageNs[stage] += now - mLastMarkNs;
+        mLastMarkNs = now;
+    }
+
+    void cycleEnd() {
+        const int64_t totalNs = mLastMarkNs - mCycleStartNs;
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            mStageHistograms[i].add((int32_t)(mStageNs[i] / 1000));
+        }
+        mCycleHistogram.add((int32_t)(totalNs / 1000));
+        if (mBudgetNs > 0 && totalNs > mBudgetNs) {
+            mOverBudgetCycles++;
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            const int64_t nowNs = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+            if (nowNs - mLastLogNs >= kMinTimeBetweenLogsNs) {
+                mLastLogNs = nowNs;
+                ALOGW("cycle CPU over budget: total %lld us of %lld us:"
+                        " prepare %lld mix %lld effects %lld write %lld us;"
+                        " %u over-budget cycles so far",
+                        (long long)(totalNs / 1000), (long long)(mBudgetNs / 1000),
+                        (long long)(mStageNs[STAGE_PREPARE] / 1000),
+                        (long long)(mStageNs[STAGE_MIX] / 1000),
+                        (long long)(mStageNs[STAGE_EFFECTS] / 1000),
+                        (long long)(mStageNs[STAGE_WRITE] / 1000),
+                        mOverBudgetCycles);
+            }
+        }
+    }
+
+    void dump(int fd) const {
+        static const char * const kStageNames[STAGE_COUNT] = {
+                "prepare", "mix", "effects", "write" };
+        dprintf(fd, "  Cycle CPU profiler: %lld cycles, %u over budget\n",
+                (long long)mCycleHistogram.getCount(), mOverBudgetCycles);
+        dprintf(fd, "  total us per cycle:\n%s", mCycleHistogram.dump().c_str());
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            dprintf(fd, "  %s us per cycle:\n%s",
+                    kStageNames[i], mStageHistograms[i].dump().c_str());
+        }
+    }
+
+private:
+    static int64_t threadCpuNowNs() {
+        struct timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    // 100 us bins up to 20 ms cover normal mix periods comfortably; gross
+    // overruns land in the histogram's above-range bin.
+    static constexpr int32_t kNumBins = 200;
+    static constexpr int32_t kBinWidthUs = 100;
+    static constexpr int64_t kMinTimeBetweenLogsNs = 60LL * 1000000000;
+
+    int64_t mBudgetNs = 0;
+    int64_t mCycleStartNs = 0;
+    int64_t mLastMarkNs = 0;
+    int64_t mLastLogNs = -kMinTimeBetweenLogsNs;    // log the first overrun
+    int64_t mStageNs[STAGE_COUNT] = {};
+    uint32_t mOverBudgetCycles = 0;
+
+    audio_utils::Histogram mStageHistograms[STAGE_COUNT] = {
+            {kNumBins, kBinWidthUs}, {kNumBins, kBinWidthUs},
+            {kNumBins, kBinWidthUs}, {kNumBins, kBinWidthUs} };
+    audio_utils::Histogram mCycleHistogram { kNumBins, kBinWidthUs };
+};
+
+}   // namespace android
+
+#endif  // ANDROID_AUDIO_CYCLE_PROFILER_H
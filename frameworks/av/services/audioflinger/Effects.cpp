@@ -23,6 +23,7 @@
 
 #include "Configuration.h"
 #include <utils/Log.h>
+#include <utils/Timers.h>
 #include <system/audio_effects/effect_aec.h>
 #include <system/audio_effects/effect_downmix.h>
 #include <system/audio_effects/effect_dynamicsprocessing.h>
@@ -666,7 +667,7 @@ bool AudioFlinger::EffectModule::updateState() {
     return started;
 }
 
-void AudioFlinger::EffectModule::process()
+void AudioFlinger::EffectModule::process(bool softBypass)
 {
     Mutex::Autolock _l(mLock);
 
@@ -719,8 +720,9 @@ void AudioFlinger::EffectModule::process()
     };
 
     if (isProcessEnabled()) {
+        const int64_t startNs = systemTime(SYSTEM_TIME_THREAD);
         int ret;
-        if (isProcessImplemented()) {
+        if (isProcessImplemented() && !softBypass) {
             if (auxType) {
                 // We overwrite the aux input buffer here and clear after processing.
                 // aux input is always mono.
@@ -850,6 +852,18 @@ void AudioFlinger::EffectModule::process()
 #endif
             memset(mConfig.inputCfg.buffer.raw, 0, size);
         }
+
+        if (softBypass) {
+            mProcessStats.softBypassCount++;
+        } else {
+            const int64_t elapsedNs = systemTime(SYSTEM_TIME_THREAD) - startNs;
+            mProcessStats.lastNs = elapsedNs;
+            if (elapsedNs > mProcessStats.maxNs) {
+                mProcessStats.maxNs = elapsedNs;
+            }
+            mProcessStats.totalNs += elapsedNs;
+            mProcessStats.count++;
+        }
     } else if ((mDescriptor.flags & EFFECT_FLAG_TYPE_MASK) == EFFECT_FLAG_TYPE_INSERT &&
                 // mInBuffer->audioBuffer()->raw != mOutBuffer->audioBuffer()->raw
                 mConfig.inputCfg.buffer.raw != mConfig.outputCfg.buffer.raw) {
@@ -1691,6 +1705,16 @@ void AudioFlinger::EffectModule::dump(int fd, const Vector<String16>& args)
             mConfig.outputCfg.format,
             formatToString((audio_format_t)mConfig.outputCfg.format).c_str());
 
+    result.append("\t\t- Process CPU time:\n");
+    result.append("\t\t\tLast (us)  Max (us)   Avg (us)   Count      Soft bypass\n");
+    result.appendFormat("\t\t\t%-10lld %-10lld %-10lld %-10llu %llu\n",
+            (long long)(mProcessStats.lastNs / 1000),
+            (long long)(mProcessStats.maxNs / 1000),
+            (long long)(mProcessStats.count != 0
+                    ? mProcessStats.totalNs / (int64_t)mProcessStats.count / 1000 : 0),
+            (unsigned long long)mProcessStats.count,
+            (unsigned long long)mProcessStats.softBypassCount);
+
 #ifdef FLOAT_EFFECT_CHAIN
 
     result.appendFormat("\t\t- HAL buffers:\n"
@@ -2197,6 +2221,66 @@ void AudioFlinger::EffectChain::clearInputBuffer_l()
 }
 
 // Must be called with EffectChain::mLock locked
+// updateInsertWiring_l() must be called with EffectChain::mLock held.
+//
+// By default every insert effect processes in place in the chain input
+// buffer and only the last one bridges to the chain output buffer. When the
+// tail of the chain is disabled, the bridging effect is idle and copies (or
+// accumulates) input to output every period without doing any processing.
+// Move the output bridge to the last insert effect actually producing
+// output instead: disabled tail effects get identical in/out pointers and
+// become no-ops, and the per-period bridge copy disappears. Rewiring only
+// happens when the bridge position changes, and only effects whose buffers
+// actually change are reconfigured, since EFFECT_CMD_SET_CONFIG can reset
+// engine state.
+void AudioFlinger::EffectChain::updateInsertWiring_l()
+{
+    if (mInBuffer == 0 || mOutBuffer == 0 ||
+            mInBuffer->audioBuffer()->raw == mOutBuffer->audioBuffer()->raw) {
+        return; // in-place chain: nothing to bridge
+    }
+    // The spatializer output stage has dedicated wiring; see addEffect_ll().
+    if (mEffectCallback->isSpatializer() && mSessionId == AUDIO_SESSION_OUTPUT_STAGE) {
+        return;
+    }
+    ssize_t lastInsert = -1;
+    ssize_t lastEnabled = -1;
+    for (size_t i = 0; i < mEffects.size(); i++) {
+        if ((mEffects[i]->desc().flags & EFFECT_FLAG_TYPE_MASK) != EFFECT_FLAG_TYPE_INSERT) {
+            continue;
+        }
+        lastInsert = i;
+        if (mEffects[i]->isProcessEnabled()) {
+            lastEnabled = i;
+        }
+    }
+    if (lastInsert < 0) {
+        return;
+    }
+    // With no enabled insert effect, keep the default wiring so the idle
+    // bridge still propagates input to output.
+    const ssize_t boundary = lastEnabled >= 0 ? lastEnabled : lastInsert;
+    if (boundary == mActiveBoundaryIdx) {
+        return;
+    }
+    for (ssize_t i = 0; i <= lastInsert; i++) {
+        if ((mEffects[i]->desc().flags & EFFECT_FLAG_TYPE_MASK) != EFFECT_FLAG_TYPE_INSERT) {
+            continue;
+        }
+        const sp<EffectBufferHalInterface>& in = i <= boundary ? mInBuffer : mOutBuffer;
+        const sp<EffectBufferHalInterface>& out = i < boundary ? mInBuffer : mOutBuffer;
+        if (mEffects[i]->inBuffer() == reinterpret_cast<int16_t*>(in->ptr()) &&
+                mEffects[i]->outBuffer() == reinterpret_cast<int16_t*>(out->ptr())) {
+            continue;
+        }
+        mEffects[i]->configure();
+        mEffects[i]->setInBuffer(in);
+        mEffects[i]->setOutBuffer(out);
+        mEffects[i]->updateAccessMode();
+    }
+    mActiveBoundaryIdx = boundary;
+}
+
 void AudioFlinger::EffectChain::process_l()
 {
     // never process effects when:
@@ -2224,6 +2308,7 @@ void AudioFlinger::EffectChain::process_l()
 
     size_t size = mEffects.size();
     if (doProcess) {
+        updateInsertWiring_l();
         // Only the input and output buffers of the chain can be external,
         // and 'update' / 'commit' do nothing for allocated buffers, thus
         // it's not needed to consider any other buffers here.
@@ -2231,9 +2316,35 @@ void AudioFlinger::EffectChain::process_l()
         if (mInBuffer->audioBuffer()->raw != mOutBuffer->audioBuffer()->raw) {
             mOutBuffer->update();
         }
+        // With budget enforcement enabled, the chain may spend at most
+        // kProcessBudgetPercent of the output period in effect processing;
+        // once the budget is exhausted the remaining effects are soft-bypassed
+        // for this period so the thread meets its deadline.
+        static const bool enforceBudget = property_get_bool("af.effect.budget", false);
+        int64_t budgetNs = 0;
+        int64_t budgetStartNs = 0;
+        if (enforceBudget) {
+            const uint32_t sampleRate = mEffectCallback->sampleRate();
+            if (sampleRate != 0) {
+                const int64_t periodNs =
+                        (int64_t)mEffectCallback->frameCount() * NANOS_PER_SECOND / sampleRate;
+                budgetNs = periodNs * kProcessBudgetPercent / 100;
+                budgetStartNs = systemTime(SYSTEM_TIME_THREAD);
+            }
+        }
+        bool overBudget = false;
         for (size_t i = 0; i < size; i++) {
-            mEffects[i]->process();
+            if (budgetNs != 0 && !overBudget
+                    && systemTime(SYSTEM_TIME_THREAD) - budgetStartNs > budgetNs) {
+                overBudget = true;
+                mBudgetExceededCount++;
+                ALOGW_IF(!mOverBudgetLastPeriod,
+                        "process_l() session %d over %jd ns budget, bypassing %zu of %zu effects",
+                        mSessionId, (intmax_t)budgetNs, size - i, size);
+            }
+            mEffects[i]->process(overBudget);
         }
+        mOverBudgetLastPeriod = overBudget;
         mInBuffer->commit();
         if (mInBuffer->audioBuffer()->raw != mOutBuffer->audioBuffer()->raw) {
             mOutBuffer->commit();
@@ -2331,7 +2442,7 @@ status_t AudioFlinger::EffectChain::addEffect_ll(const sp<EffectModule>& effect)
                 if (previousSize != 0) {
                     mEffects[1]->configure();
                     mEffects[1]->setInBuffer(mOutBuffer);
-                    mEffects[1]->updateAccessMode();      // reconfig if neeeded.
+                    mEffects[1]->updateAccessMode();
                 }
                 effect->setInBuffer(mInBuffer);
             } else {
@@ -2343,7 +2454,7 @@ status_t AudioFlinger::EffectChain::addEffect_ll(const sp<EffectModule>& effect)
                 if (idx_insert != 0) {
                     mEffects[idx_insert-1]->configure();
                     mEffects[idx_insert-1]->setOutBuffer(mInBuffer);
-                    mEffects[idx_insert - 1]->updateAccessMode();      // reconfig if neeeded.
+                    mEffects[idx_insert - 1]->updateAccessMode();
                 }
                 effect->setOutBuffer(mOutBuffer);
             } else {
@@ -2354,6 +2465,7 @@ status_t AudioFlinger::EffectChain::addEffect_ll(const sp<EffectModule>& effect)
                 __func__, effect.get(), this, idx_insert);
     }
     effect->configure();
+    mActiveBoundaryIdx = -2;    // force insert wiring re-evaluation
 
     return NO_ERROR;
 }
@@ -2456,7 +2568,7 @@ size_t AudioFlinger::EffectChain::removeEffect_l(const sp<EffectModule>& effect,
                 if (i == size - 1 && i != 0) {
                     mEffects[i - 1]->configure();
                     mEffects[i - 1]->setOutBuffer(mOutBuffer);
-                    mEffects[i - 1]->updateAccessMode();      // reconfig if neeeded.
+                    mEffects[i - 1]->updateAccessMode();
                 }
             }
             mEffects.removeAt(i);
@@ -2466,9 +2578,10 @@ size_t AudioFlinger::EffectChain::removeEffect_l(const sp<EffectModule>& effect,
             if (i == 0 && size > 1) {
                 mEffects[0]->configure();
                 mEffects[0]->setInBuffer(mInBuffer);
-                mEffects[0]->updateAccessMode();      // reconfig if neeeded.
+                mEffects[0]->updateAccessMode();
             }
 
+            mActiveBoundaryIdx = -2;    // force insert wiring re-evaluation
             ALOGV("removeEffect_l() effect %p, removed from chain %p at rank %zu", effect.get(),
                     this, i);
             break;
@@ -2649,6 +2762,10 @@ void AudioFlinger::EffectChain::dump(int fd, const Vector<String16>& args)
                 (int)outBufferStr.size(), "Out buffer      ");
         result.appendFormat("\t%s   %s   %d\n",
                 inBufferStr.c_str(), outBufferStr.c_str(), mActiveTrackCnt);
+        if (mBudgetExceededCount != 0) {
+            result.appendFormat("\tProcessing budget exceeded: %llu periods\n",
+                    (unsigned long long)mBudgetExceededCount);
+        }
         write(fd, result.string(), result.size());
 
         for (size_t i = 0; i < numEffects; ++i) {
@@ -227,7 +227,11 @@ public:
                     audio_port_handle_t deviceId);
     virtual ~EffectModule();
 
-    void process();
+    // Process one period.  With softBypass set, the engine is not called and the
+    // input is copied or accumulated to the output instead (same data handling as
+    // an effect without a process function); used by EffectChain cycle budget
+    // enforcement to gracefully degrade an over-budget chain.
+    void process(bool softBypass = false);
     bool updateState();
     status_t command(int32_t cmdCode,
                      const std::vector<uint8_t>& cmdData,
@@ -323,6 +327,17 @@ private:
     uint32_t mOutChannelCountRequested;
 #endif
 
+    // Per-module cycle accounting, sampled with the thread CPU clock around
+    // process().  Updated only on the processing thread, read by dump().
+    struct ProcessStats {
+        int64_t  lastNs = 0;            // CPU time of the most recent process()
+        int64_t  maxNs = 0;             // worst observed process() CPU time
+        int64_t  totalNs = 0;           // accumulated process() CPU time
+        uint64_t count = 0;             // number of timed process() calls
+        uint64_t softBypassCount = 0;   // periods skipped by budget enforcement
+    };
+    ProcessStats mProcessStats;
+
     class AutoLockReentrant {
     public:
         AutoLockReentrant(Mutex& mutex, pid_t allowedTid)
@@ -666,11 +681,19 @@ private:
 
     ssize_t getInsertIndex(const effect_descriptor_t& desc);
 
+    // Rewires insert effects so the last one actually producing output
+    // bridges to the chain output buffer; see process_l().
+    void updateInsertWiring_l();
+
     mutable  Mutex mLock;        // mutex protecting effect list
              Vector< sp<EffectModule> > mEffects; // list of effect modules
              audio_session_t mSessionId; // audio session ID
              sp<EffectBufferHalInterface> mInBuffer;  // chain input buffer
              sp<EffectBufferHalInterface> mOutBuffer; // chain output buffer
+             // index of the insert effect currently wired to write the chain
+             // output buffer, maintained by updateInsertWiring_l();
+             // -2 forces re-evaluation after the effect list changes
+             ssize_t mActiveBoundaryIdx = -2;
 
     // 'volatile' here means these are accessed with atomic operations instead of mutex
     volatile int32_t mActiveTrackCnt;    // number of active tracks connected
@@ -690,6 +713,13 @@ private:
              // Updated by setEffectSuspended_l() and setEffectSuspendedAll_l() only.
              KeyedVector< int, sp<SuspendedEffectDesc> > mSuspendedEffects;
 
+             // Cycle budget enforcement (enabled with the af.effect.budget property):
+             // fraction of the output period the chain may spend in effect processing
+             // before the remaining effects are soft-bypassed for that period.
+             static constexpr int32_t kProcessBudgetPercent = 50;
+             uint64_t mBudgetExceededCount = 0;   // periods where the budget was exceeded
+             bool mOverBudgetLastPeriod = false;  // limits transition logging to edges
+
              const sp<EffectCallback> mEffectCallback;
 };
 
@@ -35,6 +35,7 @@ namespace android {
 FastCapture::FastCapture() : FastThread("cycleC_ms", "loadC_us"),
     mInputSource(NULL), mInputSourceGen(0), mPipeSink(NULL), mPipeSinkGen(0),
     mReadBuffer(NULL), mReadBufferState(-1), mFormat(Format_Invalid), mSampleRate(0),
+    mReadBatchFactor(1),
     // mDummyDumpState
     mTotalNativeFramesRead(0)
 {
@@ -126,23 +127,32 @@ void FastCapture::onStateChange()
         ALOG_ASSERT(Format_isEqual(mFormat, mPipeSink->format()));
     }
 
-    if ((!Format_isEqual(mFormat, previousFormat)) || (frameCount != previous->mFrameCount)) {
+    // batch factor change reallocates the read buffer and rescales the period;
+    // the switch happens at a period boundary with the input HAL kept open and
+    // filling, so no samples are dropped across the transition.
+    const uint32_t readBatchFactor =
+            current->mReadBatchFactor != 0 ? current->mReadBatchFactor : 1;
+
+    if ((!Format_isEqual(mFormat, previousFormat)) || (frameCount != previous->mFrameCount)
+            || (readBatchFactor != mReadBatchFactor)) {
         // FIXME to avoid priority inversion, don't free here
         free(mReadBuffer);
         mReadBuffer = NULL;
+        mReadBatchFactor = readBatchFactor;
         if (frameCount > 0 && mSampleRate > 0) {
             // FIXME new may block for unbounded time at internal mutex of the heap
             //       implementation; it would be better to have normal capture thread allocate for
             //       us to avoid blocking here and to prevent possible priority inversion
-            size_t bufferSize = frameCount * Format_frameSize(mFormat);
+            const size_t readFrames = frameCount * readBatchFactor;
+            size_t bufferSize = readFrames * Format_frameSize(mFormat);
             (void)posix_memalign(&mReadBuffer, 32, bufferSize);
             memset(mReadBuffer, 0, bufferSize); // if posix_memalign fails, will segv here.
-            mPeriodNs = (frameCount * 1000000000LL) / mSampleRate;      // 1.00
-            mUnderrunNs = (frameCount * 1750000000LL) / mSampleRate;    // 1.75
-            mOverrunNs = (frameCount * 500000000LL) / mSampleRate;      // 0.50
-            mForceNs = (frameCount * 950000000LL) / mSampleRate;        // 0.95
-            mWarmupNsMin = (frameCount * 750000000LL) / mSampleRate;    // 0.75
-            mWarmupNsMax = (frameCount * 1250000000LL) / mSampleRate;   // 1.25
+            mPeriodNs = (readFrames * 1000000000LL) / mSampleRate;      // 1.00
+            mUnderrunNs = (readFrames * 1750000000LL) / mSampleRate;    // 1.75
+            mOverrunNs = (readFrames * 500000000LL) / mSampleRate;      // 0.50
+            mForceNs = (readFrames * 950000000LL) / mSampleRate;        // 0.95
+            mWarmupNsMin = (readFrames * 750000000LL) / mSampleRate;    // 0.75
+            mWarmupNsMax = (readFrames * 1250000000LL) / mSampleRate;   // 1.25
         } else {
             mPeriodNs = 0;
             mUnderrunNs = 0;
@@ -162,7 +172,9 @@ void FastCapture::onWork()
     const FastCaptureState * const current = (const FastCaptureState *) mCurrent;
     FastCaptureDumpState * const dumpState = (FastCaptureDumpState *) mDumpState;
     const FastCaptureState::Command command = mCommand;
-    size_t frameCount = current->mFrameCount;
+    // mReadBatchFactor is 1 whenever a fast client or patch record is attached,
+    // so the batched read size only applies to the pipe towards the normal path.
+    size_t frameCount = current->mFrameCount * mReadBatchFactor;
     AudioBufferProvider* fastPatchRecordBufferProvider = current->mFastPatchRecordBufferProvider;
     AudioBufferProvider::Buffer patchBuffer;
 
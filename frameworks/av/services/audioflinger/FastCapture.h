@@ -59,6 +59,7 @@ private:
                                             // or -1 to clear
     NBAIO_Format        mFormat;
     unsigned            mSampleRate;
+    uint32_t            mReadBatchFactor;   // applied batch factor, see FastCaptureState
     FastCaptureDumpState mDummyFastCaptureDumpState;
     uint32_t            mTotalNativeFramesRead; // copied to dumpState->mFramesRead
 
@@ -44,6 +44,18 @@ struct FastCaptureState : FastThreadState {
     bool            mSilenceCapture = false;    // request to silence capture for fast track.
                                                 // note: this also silences the normal mixer pipe
 
+    // Number of HAL buffer periods to read per wakeup of the fast capture thread.
+    // 1 (the default) for low-latency operation when a fast client is attached;
+    // larger values batch several periods into one read so the thread wakes up
+    // proportionally less often during background capture.  Batching relies on
+    // the HAL having at least this many periods of internal buffering; overruns
+    // show up as read errors in FastCaptureDumpState.  Transitions are applied
+    // at a period boundary without reopening the input, so no samples are lost.
+    uint32_t        mReadBatchFactor = 1;
+
+    // batch factor used by RecordThread when no fast client is attached.
+    static const uint32_t kBatchedReadFactor = 4;
+
     // Extends FastThreadState::Command
     static const Command
         // The following commands also process configuration changes, and can be "or"ed:
@@ -286,6 +286,8 @@ void FastMixer::onStateChange()
                 mSinkBufferSize = sinkFrameSize * frameCount;
                 (void)posix_memalign(&mSinkBuffer, 32, mSinkBufferSize);
             }
+            // resolve the sink conversion kernel once for the new format pair
+            mSinkCopier.resolve(mFormat.mFormat, mMixerBufferFormat);
             mPeriodNs = (frameCount * 1000000000LL) / mSampleRate;    // 1.00
             mUnderrunNs = (frameCount * 1750000000LL) / mSampleRate;  // 1.75
             mOverrunNs = (frameCount * 500000000LL) / mSampleRate;    // 0.50
@@ -485,8 +487,7 @@ void FastMixer::onWork()
         // prepare the buffer used to write to sink
         void *buffer = mSinkBuffer != NULL ? mSinkBuffer : mMixerBuffer;
         if (mFormat.mFormat != mMixerBufferFormat) { // sink format not the same as mixer format
-            memcpy_by_audio_format(buffer, mFormat.mFormat, mMixerBuffer, mMixerBufferFormat,
-                    frameCount * Format_channelCount(mFormat));
+            mSinkCopier(buffer, mMixerBuffer, frameCount * Format_channelCount(mFormat));
         }
         if (mSinkChannelMask & AUDIO_CHANNEL_HAPTIC_ALL) {
             // When there are haptic channels, the sample data is partially interleaved.
@@ -23,6 +23,7 @@
 #include "StateQueue.h"
 #include "FastMixerState.h"
 #include "FastMixerDumpState.h"
+#include "FormatCopier.h"
 #include "NBAIO_Tee.h"
 
 namespace android {
@@ -90,6 +91,7 @@ private:
     uint32_t        mAudioChannelCount; // audio channel count, excludes haptic channels.
 
     enum {UNDEFINED, MIXED, ZEROED} mMixerBufferState;
+    FormatCopier    mSinkCopier;        // mMixerBuffer -> sink format, resolved on format change
     NBAIO_Format    mFormat;
     unsigned        mSampleRate;
     int             mFastTracksGen;
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_FAST_MIXER_BUFFER_SIZER_H
+#define ANDROID_AUDIO_FAST_MIXER_BUFFER_SIZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utils/Timers.h>
+
+#include "Configuration.h"
+#include "FastMixerDumpState.h"
+
+namespace android {
+
+// Closed-loop controller for the fast mixer frame count.
+//
+// The fast mixer runs at the HAL burst size by default. On a thermally
+// throttled device the mix + write cycle can intermittently exceed the
+// period, which shows up as cycle underruns in FastThreadDumpState; a
+// larger buffer rides through the throttling at the cost of latency.
+// This controller consumes the dump state counters (written by the fast
+// mixer without synchronization -- reads here are advisory, exactly like
+// dumpsys) and picks a frame count multiplier:
+//
+//  - grow (double, up to kMaxMultiplier) when underruns accumulated in the
+//    last evaluation window, or when the measured CPU load of a cycle is
+//    above kGrowLoadPermille of the period;
+//  - shrink (halve) only after kShrinkCleanWindows consecutive clean
+//    windows with load below kShrinkLoadPermille at the smaller size, so
+//    we don't oscillate at a thermal boundary.
+//
+// The caller (MixerThread::prepareTracks_l()) pushes a changed frame count
+// to the fast mixer through the state queue; the fast mixer already
+// reconfigures its period timing and buffers on an mFrameCount change
+// between mix cycles, so there is no audible discontinuity. A cooldown
+// after each change spans the fast mixer's warmup so we never react to
+// our own resize.
+class FastMixerBufferSizer {
+public:
+    FastMixerBufferSizer(size_t halFrameCount, uint32_t sampleRate)
+        : mHalFrameCount(halFrameCount), mSampleRate(sampleRate) { }
+
+    // Returns the desired fast mixer frame count, halFrameCount * 2^k.
+    // Call regularly from the normal mixer; cheap when the evaluation
+    // window has not elapsed.
+    size_t update(const FastMixerDumpState& dumpState) {
+        const nsecs_t now = systemTime();
+        if (mLastEvalNs == 0) {
+            // first call: just capture the baseline
+            mLastEvalNs = now;
+            mLastUnderruns = dumpState.mUnderruns;
+            return frameCount();
+        }
+        if (now - mLastEvalNs < kEvalPeriodNs) {
+            return frameCount();
+        }
+        mLastEvalNs = now;
+
+        const uint32_t underruns = dumpState.mUnderruns;
+        const uint32_t newUnderruns = underruns - mLastUnderruns;
+        mLastUnderruns = underruns;
+
+        if (now < mCooldownUntilNs) {
+            return frameCount();
+        }
+
+        const uint32_t loadPermille = measureLoadPermille(dumpState);
+        if (newUnderruns != 0 || loadPermille > kGrowLoadPermille) {
+            if (mMultiplierLog2 < kMaxMultiplierLog2) {
+                mMultiplierLog2++;
+                mCooldownUntilNs = now + kCooldownNs;
+            }
+            mCleanWindows = 0;
+        } else if (loadPermille != 0 && loadPermille < kShrinkLoadPermille / 2) {
+            // Load is measured at the current size; halving the buffer
+            // roughly halves the period but not the per-frame work, so
+            // only shrink when there is at least 2x headroom.
+            if (++mCleanWindows >= kShrinkCleanWindows && mMultiplierLog2 > 0) {
+                mMultiplierLog2--;
+                mCooldownUntilNs = now + kCooldownNs;
+                mCleanWindows = 0;
+            }
+        } else {
+            mCleanWindows = 0;
+        }
+        return frameCount();
+    }
+
+    size_t frameCount() const { return mHalFrameCount << mMultiplierLog2; }
+
+private:
+    // Mean cycle CPU load as permille of the mix period, or 0 if the
+    // sampling statistics are unavailable or too sparse.
+    uint32_t measureLoadPermille(const FastMixerDumpState& dumpState) const {
+#ifdef FAST_THREAD_STATISTICS
+        // Same snapshot discipline as FastMixerDumpState::dump().
+        const uint32_t bounds = dumpState.mBounds;
+        const uint32_t newestOpen = bounds & 0xFFFF;
+        uint32_t oldestClosed = bounds >> 16;
+        uint32_t n;
+        __builtin_sub_overflow(newestOpen, oldestClosed, &n);
+        n &= 0xFFFF;
+        if (n > dumpState.mSamplingN) {
+            n = dumpState.mSamplingN;
+        }
+        if (n < kMinLoadSamples) {
+            return 0;
+        }
+        // Only the newest window's worth of samples.
+        if (n > kMinLoadSamples) {
+            oldestClosed += n - kMinLoadSamples;
+            n = kMinLoadSamples;
+        }
+        uint64_t totalLoadNs = 0;
+        for (uint32_t j = 0; j < n; ++j) {
+            totalLoadNs += dumpState.mLoadNs[oldestClosed++ & (dumpState.mSamplingN - 1)];
+        }
+        const uint64_t periodNs = (uint64_t)frameCount() * 1000000000 / mSampleRate;
+        if (periodNs == 0) {
+            return 0;
+        }
+        return (uint32_t)(totalLoadNs * 1000 / (n * periodNs));
+#else
+        (void)dumpState;
+        return 0;
+#endif
+    }
+
+    static constexpr nsecs_t  kEvalPeriodNs = 1000000000;       // 1s between decisions
+    static constexpr nsecs_t  kCooldownNs = 10000000000;        // 10s after a resize
+    static constexpr uint32_t kGrowLoadPermille = 750;          // grow above 75% load
+    static constexpr uint32_t kShrinkLoadPermille = 500;        // shrink headroom threshold
+    static constexpr uint32_t kShrinkCleanWindows = 30;         // 30s clean before shrinking
+    static constexpr uint32_t kMaxMultiplierLog2 = 2;           // at most 4x the HAL burst
+    static constexpr uint32_t kMinLoadSamples = 64;
+
+    const size_t   mHalFrameCount;
+    const uint32_t mSampleRate;
+
+    uint32_t mMultiplierLog2 = 0;
+    uint32_t mCleanWindows = 0;
+    uint32_t mLastUnderruns = 0;
+    nsecs_t  mLastEvalNs = 0;
+    nsecs_t  mCooldownUntilNs = 0;
+};
+
+}   // namespace android
+
+#endif  // ANDROID_AUDIO_FAST_MIXER_BUFFER_SIZER_H
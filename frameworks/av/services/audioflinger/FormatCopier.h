@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_FORMAT_COPIER_H
+#define ANDROID_AUDIO_FORMAT_COPIER_H
+
+#include <string.h>
+
+#include <audio_utils/format.h>
+#include <audio_utils/format_kernels.h>
+#include <audio_utils/primitives.h>
+#include <system/audio.h>
+
+namespace android {
+
+/**
+ * FormatCopier resolves the kernel for one fixed (destination, source) sample
+ * format pair at configuration time, so the per-period buffer copies in the
+ * mixer threads call straight into a specialized conversion loop instead of
+ * re-running memcpy_by_audio_format()'s format dispatch on every buffer.
+ * With the format pair fixed at the call site, each kernel is a single
+ * monomorphic loop the compiler can vectorize fully.
+ *
+ * The kernels reuse the vectorized format_kernels.h conversions where those
+ * exist and the audio_utils primitives otherwise; format pairs without a
+ * dedicated kernel fall back to memcpy_by_audio_format(), so a FormatCopier
+ * is always safe to call once resolved.
+ *
+ * resolve() must not run concurrently with operator()(); callers resolve
+ * during thread (re)configuration, which already excludes mixing.
+ */
+class FormatCopier {
+public:
+    void resolve(audio_format_t dstFormat, audio_format_t srcFormat) {
+        mDstFormat = dstFormat;
+        mSrcFormat = srcFormat;
+        mKernel = lookup(dstFormat, srcFormat);
+    }
+
+    /** copies count samples (frames x channels), converting between the resolved formats. */
+    void operator()(void *dst, const void *src, size_t count) const {
+        if (mKernel != nullptr) {
+            mKernel(dst, src, count);
+        } else {
+            memcpy_by_audio_format(dst, mDstFormat, src, mSrcFormat, count);
+        }
+    }
+
+private:
+    using Kernel = void (*)(void *dst, const void *src, size_t count);
+
+    template <size_t sampleSize>
+    static void copySame(void *dst, const void *src, size_t count) {
+        memcpy(dst, src, count * sampleSize);
+    }
+
+    static void copyI16FromFloat(void *dst, const void *src, size_t count) {
+        audio_utils::format::convert_to_i16_from_float(
+                static_cast<int16_t *>(dst), static_cast<const float *>(src), count);
+    }
+
+    static void copyFloatFromI16(void *dst, const void *src, size_t count) {
+        audio_utils::format::convert_to_float_from_i16(
+                static_cast<float *>(dst), static_cast<const int16_t *>(src), count);
+    }
+
+    static void copyFloatFromP24(void *dst, const void *src, size_t count) {
+        audio_utils::format::convert_to_float_from_p24(
+                static_cast<float *>(dst), static_cast<const uint8_t *>(src), count);
+    }
+
+    static void copyP24FromFloat(void *dst, const void *src, size_t count) {
+        memcpy_to_p24_from_float(
+                static_cast<uint8_t *>(dst), static_cast<const float *>(src), count);
+    }
+
+    static void copyI32FromFloat(void *dst, const void *src, size_t count) {
+        memcpy_to_i32_from_float(
+                static_cast<int32_t *>(dst), static_cast<const float *>(src), count);
+    }
+
+    static void copyFloatFromI32(void *dst, const void *src, size_t count) {
+        memcpy_to_float_from_i32(
+                static_cast<float *>(dst), static_cast<const int32_t *>(src), count);
+    }
+
+    static void copyQ8_23FromFloat(void *dst, const void *src, size_t count) {
+        memcpy_to_q8_23_from_float_with_clamp(
+                static_cast<int32_t *>(dst), static_cast<const float *>(src), count);
+    }
+
+    static void copyFloatFromQ8_23(void *dst, const void *src, size_t count) {
+        memcpy_to_float_from_q8_23(
+                static_cast<float *>(dst), static_cast<const int32_t *>(src), count);
+    }
+
+    static Kernel lookup(audio_format_t dstFormat, audio_format_t srcFormat) {
+        if (dstFormat == srcFormat && audio_is_linear_pcm(dstFormat)) {
+            switch (audio_bytes_per_sample(dstFormat)) {
+            case 1: return copySame<1>;
+            case 2: return copySame<2>;
+            case 3: return copySame<3>;
+            case 4: return copySame<4>;
+            default: break;
+            }
+        }
+        if (dstFormat == AUDIO_FORMAT_PCM_FLOAT) {
+            switch (srcFormat) {
+            case AUDIO_FORMAT_PCM_16_BIT:        return copyFloatFromI16;
+            case AUDIO_FORMAT_PCM_24_BIT_PACKED: return copyFloatFromP24;
+            case AUDIO_FORMAT_PCM_32_BIT:        return copyFloatFromI32;
+            case AUDIO_FORMAT_PCM_8_24_BIT:      return copyFloatFromQ8_23;
+            default: break;
+            }
+        } else if (srcFormat == AUDIO_FORMAT_PCM_FLOAT) {
+            switch (dstFormat) {
+            case AUDIO_FORMAT_PCM_16_BIT:        return copyI16FromFloat;
+            case AUDIO_FORMAT_PCM_24_BIT_PACKED: return copyP24FromFloat;
+            case AUDIO_FORMAT_PCM_32_BIT:        return copyI32FromFloat;
+            case AUDIO_FORMAT_PCM_8_24_BIT:      return copyQ8_23FromFloat;
+            default: break;
+            }
+        }
+        return nullptr; // memcpy_by_audio_format() fallback
+    }
+
+    audio_format_t mDstFormat = AUDIO_FORMAT_INVALID;
+    audio_format_t mSrcFormat = AUDIO_FORMAT_INVALID;
+    Kernel mKernel = nullptr;
+};
+
+}   // namespace android
+
+#endif  // ANDROID_AUDIO_FORMAT_COPIER_H
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "MultiStateQueue"
+//#define LOG_NDEBUG 0
+
+#include "Configuration.h"
+#include <time.h>
+#include <cutils/atomic.h>
+#include <utils/Log.h>
+#include "MultiStateQueue.h"
+
+namespace android {
+
+// Constructor and destructor
+
+template<typename T> MultiStateQueue<T>::MultiStateQueue() :
+    mObserverCount(0),
+    mMutating(&mStates[0]), mExpecting(NULL),
+    mInMutation(false), mIsDirty(false), mIsInitialized(false)
+#ifdef STATE_QUEUE_DUMP
+    , mMutatorDump(&mMutatorDummyDump)
+#endif
+{
+    atomic_init(&mNext, static_cast<uintptr_t>(0));
+    for (unsigned i = 0; i < kMaxObservers; i++) {
+        mObservers[i].mAck = NULL;
+        mObservers[i].mCurrent = NULL;
+#ifdef STATE_QUEUE_DUMP
+        mObservers[i].mDump = &mObserverDummyDump;
+#endif
+    }
+}
+
+template<typename T> MultiStateQueue<T>::~MultiStateQueue()
+{
+}
+
+// Observer APIs
+
+template<typename T> int MultiStateQueue<T>::registerObserver()
+{
+    ALOG_ASSERT(!mIsInitialized, "registerObserver() called after first mutation");
+    if (mObserverCount >= kMaxObservers) {
+        return -1;
+    }
+    return mObserverCount++;
+}
+
+template<typename T> const T* MultiStateQueue<T>::poll(int observerId)
+{
+    const T *next = (const T *) atomic_load_explicit(&mNext, memory_order_acquire);
+
+    Observer& observer = mObservers[observerId];
+    if (next != observer.mCurrent) {
+        observer.mAck = next;   // no additional barrier needed
+        observer.mCurrent = next;
+#ifdef STATE_QUEUE_DUMP
+        observer.mDump->mStateChanges++;
+#endif
+    }
+    return next;
+}
+
+// Mutator APIs
+
+template<typename T> T* MultiStateQueue<T>::begin()
+{
+    ALOG_ASSERT(!mInMutation, "begin() called when in a mutation");
+    mInMutation = true;
+    return mMutating;
+}
+
+template<typename T> void MultiStateQueue<T>::end(bool didModify)
+{
+    ALOG_ASSERT(mInMutation, "end() called when not in a mutation");
+    ALOG_ASSERT(mIsInitialized || didModify, "first end() must modify for initialization");
+    if (didModify) {
+        mIsDirty = true;
+        mIsInitialized = true;
+    }
+    mInMutation = false;
+}
+
+template<typename T> bool MultiStateQueue<T>::allAcked() const
+{
+    for (unsigned i = 0; i < mObserverCount; i++) {
+        const T *ack = (const T *) mObservers[i].mAck;  // no additional barrier needed
+        if (ack != mExpecting) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T> bool MultiStateQueue<T>::push(typename StateQueue<T>::block_t block)
+{
+#define PUSH_BLOCK_ACK_NS    3000000L   // 3 ms: time between checks for acks in push()
+                                        //       FIXME should be configurable
+    static const struct timespec req = {0, PUSH_BLOCK_ACK_NS};
+
+    ALOG_ASSERT(!mInMutation, "push() called when in a mutation");
+
+#ifdef STATE_QUEUE_DUMP
+    if (block == StateQueue<T>::BLOCK_UNTIL_ACKED) {
+        mMutatorDump->mPushAck++;
+    }
+#endif
+
+    if (mIsDirty) {
+
+#ifdef STATE_QUEUE_DUMP
+        mMutatorDump->mPushDirty++;
+#endif
+
+        // wait for prior push to be acknowledged by every observer
+        if (mExpecting != NULL) {
+#ifdef STATE_QUEUE_DUMP
+            unsigned count = 0;
+#endif
+            for (;;) {
+                if (allAcked()) {
+                    // unnecessary as we're about to rewrite
+                    //mExpecting = NULL;
+                    break;
+                }
+                if (block == StateQueue<T>::BLOCK_NEVER) {
+                    return false;
+                }
+#ifdef STATE_QUEUE_DUMP
+                if (count == 1) {
+                    mMutatorDump->mBlockedSequence++;
+                }
+                ++count;
+#endif
+                nanosleep(&req, NULL);
+            }
+#ifdef STATE_QUEUE_DUMP
+            if (count > 1) {
+                mMutatorDump->mBlockedSequence++;
+            }
+#endif
+        }
+
+        // publish
+        atomic_store_explicit(&mNext, (uintptr_t)mMutating, memory_order_release);
+        mExpecting = mMutating;
+
+        // copy with circular wraparound
+        if (++mMutating >= &mStates[kN]) {
+            mMutating = &mStates[0];
+        }
+        *mMutating = *mExpecting;
+        mIsDirty = false;
+
+    }
+
+    // optionally wait for this push or a prior push to be acknowledged by every observer
+    if (block == StateQueue<T>::BLOCK_UNTIL_ACKED) {
+        if (mExpecting != NULL) {
+#ifdef STATE_QUEUE_DUMP
+            unsigned count = 0;
+#endif
+            for (;;) {
+                if (allAcked()) {
+                    mExpecting = NULL;
+                    break;
+                }
+#ifdef STATE_QUEUE_DUMP
+                if (count == 1) {
+                    mMutatorDump->mBlockedSequence++;
+                }
+                ++count;
+#endif
+                nanosleep(&req, NULL);
+            }
+#ifdef STATE_QUEUE_DUMP
+            if (count > 1) {
+                mMutatorDump->mBlockedSequence++;
+            }
+#endif
+        }
+    }
+
+    return true;
+}
+
+}   // namespace android
+
+// hack for gcc
+#ifdef MULTI_STATE_QUEUE_INSTANTIATIONS
+#include MULTI_STATE_QUEUE_INSTANTIATIONS
+#endif
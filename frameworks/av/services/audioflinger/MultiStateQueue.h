@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_MULTI_STATE_QUEUE_H
+#define ANDROID_AUDIO_MULTI_STATE_QUEUE_H
+
+#include <stdatomic.h>
+
+// A variant of StateQueue (see StateQueue.h for the design discussion) that
+// supports a small fixed number of observers instead of exactly one, so that
+// the same state can fan out to several consumers without duplicate queues
+// and duplicate pushes.  The requirements are unchanged:
+//  - every observer must always be able to poll for and view the latest pushed
+//    state without blocking; poll() performs no loops, locks, or atomic
+//    read-modify-write operations, so it remains safe for FIFO/RR threads
+//  - observers do not need to see every state in sequence; skipping is OK
+//  - there is still exactly one mutator, and its non-blocking guarantees are
+//    the same as StateQueue's: push(BLOCK_NEVER) never blocks
+// The differences from StateQueue:
+//  - each observer has its own acknowledge cursor; the mutator may not reuse
+//    a slot until every registered observer has acknowledged the previous
+//    push, so the slowest observer gates the mutator (as the single observer
+//    did before)
+//  - observers must be registered before the first mutation, while the
+//    caller is still single-threaded; registration returns a small id that
+//    the observer passes to poll().  An observer that registers but never
+//    polls will cause push(BLOCK_NEVER) to return false forever, just as a
+//    stalled observer would with StateQueue.
+
+#include "Configuration.h"
+#include "StateQueue.h"     // for StateQueueObserverDump / StateQueueMutatorDump
+
+namespace android {
+
+// manages a FIFO queue of states with fan-out to multiple observers
+template<typename T> class MultiStateQueue {
+
+public:
+    static const unsigned kMaxObservers = 4;
+
+            MultiStateQueue();
+    virtual ~MultiStateQueue();
+
+    // Observer APIs
+
+    // Register a new observer.  Must be called before the first mutation,
+    // while access to the queue is still single-threaded.
+    // Returns an observer id to pass to poll(), or -1 if kMaxObservers
+    // observers are already registered.
+    int     registerObserver();
+
+    // Poll for a state change on behalf of the given observer.  Identical
+    // semantics to StateQueue::poll(): returns a pointer to a read-only
+    // state, or NULL if no state has been pushed yet, and the previously
+    // returned pointer remains valid for diffing.  Wait-free.
+    const T* poll(int observerId);
+
+    // Mutator APIs -- all identical in semantics to StateQueue
+
+    T*      begin();
+    void    end(bool didModify = true);
+
+    // Push a new state, if any, out to all observers.  Same contract as
+    // StateQueue::push(), except that "acknowledged" means acknowledged by
+    // every registered observer.
+    bool    push(typename StateQueue<T>::block_t block = StateQueue<T>::BLOCK_NEVER);
+
+    bool    isDirty() const { return mIsDirty; }
+
+#ifdef STATE_QUEUE_DUMP
+    // Register location of dump area for one observer
+    void    setObserverDump(int observerId, StateQueueObserverDump *dump)
+            { mObservers[observerId].mDump = dump != NULL ? dump : &mObserverDummyDump; }
+
+    // Register location of mutator dump area
+    void    setMutatorDump(StateQueueMutatorDump *dump)
+            { mMutatorDump = dump != NULL ? dump : &mMutatorDummyDump; }
+#endif
+
+private:
+    // Per-observer state.  mAck is written only by the owning observer and
+    // read by the mutator; mCurrent is private to the owning observer.
+    struct Observer {
+        volatile const T* mAck;     // acknowledge cursor for this observer
+        const T*          mCurrent; // most recent value returned by poll()
+#ifdef STATE_QUEUE_DUMP
+        StateQueueObserverDump* mDump;
+#endif
+    };
+
+    // Returns true if every registered observer has acknowledged mExpecting.
+    bool    allAcked() const;
+
+    static const unsigned kN = 4;       // values < 4 are not supported by this code
+    T                 mStates[kN];      // written by mutator, read by observers
+
+    // "volatile" is meaningless with SMP, but here it indicates that we're using atomic ops
+    atomic_uintptr_t  mNext; // written by mutator to advance next, read by observers
+
+    Observer          mObservers[kMaxObservers];
+    unsigned          mObserverCount;   // written during single-threaded setup only
+
+    // only used by mutator
+    T*                mMutating;        // where updates by mutator are done in place
+    const T*          mExpecting;       // what the mutator expects each mAck to be set to
+    bool              mInMutation;      // whether we're currently in the middle of a mutation
+    bool              mIsDirty;         // whether mutating state has been modified since last push
+    bool              mIsInitialized;   // whether mutating state has been initialized yet
+
+#ifdef STATE_QUEUE_DUMP
+    StateQueueObserverDump  mObserverDummyDump; // default area for observer dumps if not set
+    StateQueueMutatorDump   mMutatorDummyDump;  // default area for mutator dump if not set
+    StateQueueMutatorDump*  mMutatorDump;       // pointer to active mutator dump, always non-NULL
+#endif
+
+};  // class MultiStateQueue
+
+}   // namespace android
+
+#endif  // ANDROID_AUDIO_MULTI_STATE_QUEUE_H
@@ -19,10 +19,16 @@
 
 #include <utils/Log.h>
 
+#include <chrono>
 #include <deque>
 #include <dirent.h>
+#include <fcntl.h>
 #include <future>
 #include <list>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <thread>
 #include <vector>
 
 #include <audio_utils/format.h>
@@ -65,6 +71,27 @@ static constexpr char DEFAULT_PREFIX[] = "aftee_";
 static constexpr char DEFAULT_DIRECTORY[] = "/data/misc/audioserver";
 static constexpr size_t DEFAULT_THREADPOOL_SIZE = 8;
 
+// continuous spill tuning: keep ~SPILL_SECONDS seconds of audio per tee,
+// split over SPILL_SEGMENTS rotating files, drained every SPILL_PERIOD_MS.
+static constexpr uint32_t SPILL_SECONDS = 30;
+static constexpr size_t SPILL_SEGMENTS = 4;
+static constexpr int SPILL_PERIOD_MS = 500;
+
+/** returns "YYYYmmdd_HHMMSS_MSEC" for systematically generated filenames. */
+static std::string generateTimeString()
+{
+    char fileTime[sizeof("YYYYmmdd_HHMMSS_\0")];
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    struct tm tm;
+    localtime_r(&tv.tv_sec, &tm);
+    LOG_ALWAYS_FATAL_IF(strftime(fileTime, sizeof(fileTime), "%Y%m%d_%H%M%S_", &tm) == 0,
+        "incorrect fileTime buffer");
+    char msec[4];
+    (void)snprintf(msec, sizeof(msec), "%03d", (int)(tv.tv_usec / 1000));
+    return std::string(fileTime) + msec;
+}
+
 /** AudioFileHandler manages temporary audio wav files with a least recently created
     retention policy.
 
@@ -121,16 +148,7 @@ private:
     }
 
     std::string generateFilename(const std::string &suffix) const {
-        char fileTime[sizeof("YYYYmmdd_HHMMSS_\0")];
-        struct timeval tv;
-        gettimeofday(&tv, NULL);
-        struct tm tm;
-        localtime_r(&tv.tv_sec, &tm);
-        LOG_ALWAYS_FATAL_IF(strftime(fileTime, sizeof(fileTime), "%Y%m%d_%H%M%S_", &tm) == 0,
-            "incorrect fileTime buffer");
-        char msec[4];
-        (void)snprintf(msec, sizeof(msec), "%03d", (int)(tv.tv_usec / 1000));
-        return mPrefix + fileTime + msec + suffix + ".wav";
+        return mPrefix + generateTimeString() + suffix + ".wav";
     }
 
     bool isManagedFilename(const char *name) {
@@ -185,6 +203,196 @@ private:
     static constexpr size_t MAX_FILES_KEEP = 32;
 };
 
+/** TeeSpillState incrementally spills one Tee's ring contents into a small
+    rotating set of mmap-backed WAV segments under DEFAULT_DIRECTORY.
+
+    Segments are created at full size up front and filled through the mapping,
+    so a steady spill performs no write() syscalls -- the kernel writes back
+    dirty pages at its leisure.  Each segment carries a WAV header sized for
+    the full segment; the header of a partially filled segment is patched on
+    close, so segments remain playable (modulo unsynced pages after a crash).
+    The oldest segment is unlinked once more than SPILL_SEGMENTS exist,
+    capping disk use per tee at about SPILL_SECONDS seconds of audio.  The
+    segments use the managed filename scheme, so stale ones from a previous
+    audioserver incarnation are removed by the AudioFileHandler retention
+    scan.
+
+    All methods are called only from the spill thread. */
+class TeeSpillState {
+public:
+    TeeSpillState(const NBAIO_Format &format, const std::string &suffix)
+        : mFormat(format)
+        , mSuffix(suffix)
+        , mSampleRate(Format_sampleRate(format))
+        , mChannelCount(Format_channelCount(format))
+    {
+        // same write format selection as AudioFileHandler::createInternal().
+        switch (format.mFormat) {
+        case AUDIO_FORMAT_PCM_8_BIT:
+        case AUDIO_FORMAT_PCM_16_BIT:
+            mWriteFormat = AUDIO_FORMAT_PCM_16_BIT;
+            break;
+        case AUDIO_FORMAT_PCM_8_24_BIT:
+        case AUDIO_FORMAT_PCM_24_BIT_PACKED:
+        case AUDIO_FORMAT_PCM_32_BIT:
+            mWriteFormat = AUDIO_FORMAT_PCM_32_BIT;
+            break;
+        case AUDIO_FORMAT_PCM_FLOAT:
+            mWriteFormat = AUDIO_FORMAT_PCM_FLOAT;
+            break;
+        default:
+            return; // mWriteFormat stays invalid, spill() drops the data.
+        }
+        mInFrameSize = mChannelCount * audio_bytes_per_sample(format.mFormat);
+        mOutFrameSize = mChannelCount * audio_bytes_per_sample(mWriteFormat);
+        mSegmentDataBytes = (size_t)mSampleRate * mOutFrameSize
+                * SPILL_SECONDS / SPILL_SEGMENTS;
+        mReadBuffer = malloc(FRAMES_PER_READ * std::max(mInFrameSize, mOutFrameSize));
+    }
+
+    ~TeeSpillState() {
+        closeSegment();
+        free(mReadBuffer);
+    }
+
+    /** returns whether this state was built for the given format. */
+    bool isFor(const NBAIO_Format &format) const { return Format_isEqual(format, mFormat); }
+
+    /** drains the source into the current segment, rotating as needed. */
+    void spill(NBAIO_Source *source) {
+        if (mWriteFormat == AUDIO_FORMAT_INVALID || mReadBuffer == nullptr) return;
+        for (;;) {
+            ssize_t actualRead = source->read(mReadBuffer, FRAMES_PER_READ);
+            if (actualRead == (ssize_t)OVERRUN) {
+                // we lost data to the writer; recheck for what's still there.
+                actualRead = source->read(mReadBuffer, FRAMES_PER_READ);
+            }
+            if (actualRead <= 0) break;
+            writeFrames(actualRead);
+        }
+    }
+
+private:
+    struct __attribute__((packed)) WavHeader {
+        char     riff[4];       // "RIFF"
+        uint32_t riffSize;
+        char     wave[4];       // "WAVE"
+        char     fmt[4];        // "fmt "
+        uint32_t fmtSize;       // 16
+        uint16_t audioFormat;   // 1 = integer PCM, 3 = IEEE float
+        uint16_t channels;
+        uint32_t sampleRate;
+        uint32_t byteRate;
+        uint16_t blockAlign;
+        uint16_t bitsPerSample;
+        char     data[4];       // "data"
+        uint32_t dataSize;
+    };
+
+    bool openSegment() {
+        std::string path = std::string(DEFAULT_DIRECTORY) + "/" + DEFAULT_PREFIX
+                + generateTimeString() + mSuffix + "_S.wav";
+        const size_t fileBytes = sizeof(WavHeader) + mSegmentDataBytes;
+        const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            ALOGW("%s: cannot create %s: %s", __func__, path.c_str(), strerror(errno));
+            return false;
+        }
+        if (ftruncate(fd, fileBytes) != 0) {
+            ALOGW("%s: cannot size %s: %s", __func__, path.c_str(), strerror(errno));
+            (void)close(fd);
+            (void)unlink(path.c_str());
+            return false;
+        }
+        void *map = mmap(NULL, fileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            ALOGW("%s: cannot map %s: %s", __func__, path.c_str(), strerror(errno));
+            (void)close(fd);
+            (void)unlink(path.c_str());
+            return false;
+        }
+        mFd = fd;
+        mMap = (uint8_t *)map;
+        mMapBytes = fileBytes;
+        mOffset = sizeof(WavHeader);
+
+        WavHeader *header = (WavHeader *)mMap;
+        memcpy(header->riff, "RIFF", 4);
+        header->riffSize = fileBytes - 8;
+        memcpy(header->wave, "WAVE", 4);
+        memcpy(header->fmt, "fmt ", 4);
+        header->fmtSize = 16;
+        header->audioFormat = mWriteFormat == AUDIO_FORMAT_PCM_FLOAT ? 3 : 1;
+        header->channels = mChannelCount;
+        header->sampleRate = mSampleRate;
+        header->byteRate = mSampleRate * mOutFrameSize;
+        header->blockAlign = mOutFrameSize;
+        header->bitsPerSample = audio_bytes_per_sample(mWriteFormat) * 8;
+        memcpy(header->data, "data", 4);
+        header->dataSize = mSegmentDataBytes;
+
+        mSegments.emplace_back(std::move(path));
+        while (mSegments.size() > SPILL_SEGMENTS) {
+            (void)unlink(mSegments.front().c_str());
+            mSegments.pop_front();
+        }
+        return true;
+    }
+
+    void closeSegment() {
+        if (mMap == nullptr) return;
+        // patch the actual data size for a partially filled segment.
+        WavHeader *header = (WavHeader *)mMap;
+        header->dataSize = mOffset - sizeof(WavHeader);
+        header->riffSize = mOffset - 8;
+        (void)munmap(mMap, mMapBytes);
+        (void)ftruncate(mFd, mOffset);
+        (void)close(mFd);
+        mMap = nullptr;
+        mFd = -1;
+    }
+
+    void writeFrames(size_t frames) {
+        // convert in place in mReadBuffer, as createInternal() does.
+        if (mFormat.mFormat != mWriteFormat) {
+            memcpy_by_audio_format(mReadBuffer, mWriteFormat,
+                    mReadBuffer, mFormat.mFormat, frames * mChannelCount);
+        }
+        const uint8_t *in = (const uint8_t *)mReadBuffer;
+        size_t remaining = frames * mOutFrameSize;
+        while (remaining > 0) {
+            if (mMap == nullptr && !openSegment()) return;
+            const size_t copy = std::min(remaining, mMapBytes - mOffset);
+            memcpy(mMap + mOffset, in, copy);
+            mOffset += copy;
+            in += copy;
+            remaining -= copy;
+            if (mOffset == mMapBytes) {
+                closeSegment(); // segment exactly full; rotate on next write.
+            }
+        }
+    }
+
+    static constexpr size_t FRAMES_PER_READ = 1024;
+
+    const NBAIO_Format mFormat;
+    const std::string mSuffix;
+    const uint32_t mSampleRate;
+    const uint32_t mChannelCount;
+    audio_format_t mWriteFormat = AUDIO_FORMAT_INVALID;
+    size_t mInFrameSize = 0;
+    size_t mOutFrameSize = 0;
+    size_t mSegmentDataBytes = 0;
+    void *mReadBuffer = nullptr;
+
+    // current segment mapping
+    int mFd = -1;
+    uint8_t *mMap = nullptr;
+    size_t mMapBytes = 0;
+    size_t mOffset = 0;
+    std::deque<std::string> mSegments; // segment paths, oldest first
+};
+
 /* static */
 void NBAIO_Tee::NBAIO_TeeImpl::dumpTee(
         int fd, const NBAIO_SinkSource &sinkSource, const std::string &suffix)
@@ -222,6 +430,44 @@ void NBAIO_Tee::NBAIO_TeeImpl::dumpTee(
     }
 }
 
+void NBAIO_Tee::NBAIO_TeeImpl::spill()
+{
+    sp<NBAIO_Source> source;
+    NBAIO_Format format;
+    std::string suffix;
+    {
+        std::lock_guard<std::mutex> _l(mLock);
+        source = mSinkSource.second;
+        format = mFormat;
+        suffix = mId;
+    }
+    if (source.get() == nullptr) return;
+    // (re)create the spill state on first use or after a format change.
+    if (mSpillState == nullptr || !mSpillState->isFor(format)) {
+        mSpillState = std::make_shared<TeeSpillState>(format, suffix);
+    }
+    mSpillState->spill(source.get());
+}
+
+/* static */
+void NBAIO_Tee::ensureSpillThread()
+{
+    static std::once_flag once;
+    std::call_once(once, [] {
+        std::thread([] {
+            // spill file I/O must never compete with audio threads.
+            struct sched_param param = {};
+            if (sched_setscheduler(0 /* self */, SCHED_IDLE, &param) != 0) {
+                (void)setpriority(PRIO_PROCESS, 0 /* self */, 19 /* lowest */);
+            }
+            for (;;) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(SPILL_PERIOD_MS));
+                getRunningTees().spill();
+            }
+        }).detach();
+    });
+}
+
 /* static */
 NBAIO_Tee::NBAIO_TeeImpl::NBAIO_SinkSource NBAIO_Tee::NBAIO_TeeImpl::makeSinkSource(
         const NBAIO_Format &format, size_t frames, bool *enabled)
@@ -78,8 +78,21 @@ namespace android {
  * 2) The mechanism is on the AudioBufferProvider release() so large static Track
  *    playback may not show any Tee data depending on when it is released.
  * 3) When a track becomes inactive, the Thread will trigger a dump.
+ *
+ * Continuous spill mode:
+ *
+ * In addition to on-demand dumps, tees whose type is selected by the af.tee.spill
+ * property (same bitmask as af.tee) are drained continuously by a single
+ * idle-priority thread into a small rotating set of mmap-backed WAV segments,
+ * keeping roughly the last 30 seconds of audio on disk at all times. The
+ * audible thread still only performs the existing nonblocking ring write; all
+ * file I/O happens on the spill thread at SCHED_IDLE. While continuous spill
+ * is enabled for a tee, on-demand dump() is a no-op for it (the pipe is
+ * already drained, and the PipeReader supports only a single reader).
  */
 
+class TeeSpillState;  // opaque per-tee spill bookkeeping, see NBAIO_Tee.cpp
+
 class NBAIO_Tee {
 public:
     /* TEE_FLAG is used in set() and must match the flags for the af.tee property
@@ -124,12 +137,16 @@ public:
 
     status_t set(const NBAIO_Format &format,
             TEE_FLAG flags = TEE_FLAG_NONE, size_t frames = 0) const {
-        return mTee->set(format, flags, frames);
+        const status_t status = mTee->set(format, flags, frames);
+        if (status == NO_ERROR && mTee->spillRequested()) {
+            ensureSpillThread();
+        }
+        return status;
     }
 
     status_t set(uint32_t sampleRate, uint32_t channelCount, audio_format_t format,
             TEE_FLAG flags = TEE_FLAG_NONE, size_t frames = 0) const {
-        return mTee->set(Format_from_SR_C(sampleRate, channelCount, format), flags, frames);
+        return set(Format_from_SR_C(sampleRate, channelCount, format), flags, frames);
     }
 
     /**
@@ -216,11 +233,15 @@ private:
             // Note: as mentioned in NBAIO_Tee::set(), don't call set() while write() is
             // ongoing.
             if (enabled) {
+                static const int teeSpillConfig = property_get_bool("ro.debuggable", false)
+                       ? property_get_int32("af.tee.spill", 0) : 0;
+
                 std::lock_guard<std::mutex> _l(mLock);
                 mFlags = flags;
                 mFormat = format; // could get this from the Sink.
                 mFrames = frames;
                 mSinkSource = std::move(sinksource);
+                mSpillRequested.store(type != 0 && (type & teeSpillConfig) != 0);
                 mEnabled.store(true);
                 return NO_ERROR;
             }
@@ -233,6 +254,9 @@ private:
         }
 
         void dump(int fd, const std::string &reason) {
+            // continuous spill owns the PipeReader (single reader); the ring is
+            // already drained to the spill segments, so there is nothing to dump.
+            if (mSpillRequested.load()) return;
             if (!mDataReady.exchange(false)) return;
             std::string suffix;
             NBAIO_SinkSource sinkSource;
@@ -250,6 +274,13 @@ private:
             mDataReady.store(true);
         }
 
+        /** returns whether this Tee is selected for continuous spill by af.tee.spill. */
+        bool spillRequested() const { return mSpillRequested.load(); }
+
+        /** drains the ring into the rotating spill segments.
+            Called only from the spill thread. */
+        void spill();
+
     private:
         // TRICKY: We need to keep the NBAIO_Sink and NBAIO_Source both alive at the same time
         // because PipeReader holds a naked reference (not a strong or weak pointer) to Pipe.
@@ -266,6 +297,10 @@ private:
         // atomic status checking
         std::atomic<bool> mEnabled{false};
         std::atomic<bool> mDataReady{false};
+        std::atomic<bool> mSpillRequested{false};
+
+        // per-tee spill bookkeeping; created and accessed only by the spill thread.
+        std::shared_ptr<TeeSpillState> mSpillState;
 
         // locked dump information
         mutable std::mutex mLock;
@@ -303,6 +338,21 @@ private:
             }
         }
 
+        /** one spill pass over all tees with continuous spill enabled.
+            Called only from the spill thread. */
+        void spill() {
+            std::vector<std::shared_ptr<NBAIO_TeeImpl>> tees; // safe snapshot of tees
+            {
+                std::lock_guard<std::mutex> _l(mLock);
+                tees.insert(tees.end(), mTees.begin(), mTees.end());
+            }
+            for (const auto &tee : tees) {
+                if (tee->spillRequested()) {
+                    tee->spill();
+                }
+            }
+        }
+
     private:
         std::mutex mLock;
         std::set<std::shared_ptr<NBAIO_TeeImpl>> mTees; // GUARDED_BY(mLock)
@@ -314,6 +364,9 @@ private:
         return runningTees;
     }
 
+    /** starts the singleton idle-priority spill thread on first call. */
+    static void ensureSpillThread();
+
     // The NBAIO TeeImpl may have lifetime longer than NBAIO_Tee if
     // RunningTees::dump() is being called simultaneous to ~NBAIO_Tee().
     // This is allowed for maximum concurrency.
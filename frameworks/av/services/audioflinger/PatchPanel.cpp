@@ -450,6 +450,7 @@ exit:
     } else {
         newPatch.clearConnections(this);
     }
+    publishRouteSnapshot_l();
     return status;
 }
 
@@ -626,16 +627,13 @@ void AudioFlinger::PatchPanel::Patch::clearConnections(PatchPanel *panel)
     mPlayback.closeConnections(panel);
 }
 
-status_t AudioFlinger::PatchPanel::Patch::getLatencyMs(double *latencyMs) const
+// Latency from a patch record track to its peer patch playback track, shared
+// by Patch::getLatencyMs() and DownstreamPatchSnapshot::getLatencyMs().
+static status_t trackPairLatencyMs(
+        const sp<const AudioFlinger::RecordThread::PatchRecord>& recordTrack,
+        const sp<const AudioFlinger::PlaybackThread::PatchTrack>& playbackTrack,
+        double *latencyMs)
 {
-    if (!isSoftware()) return INVALID_OPERATION;
-
-    auto recordTrack = mRecord.const_track();
-    if (recordTrack.get() == nullptr) return INVALID_OPERATION;
-
-    auto playbackTrack = mPlayback.const_track();
-    if (playbackTrack.get() == nullptr) return INVALID_OPERATION;
-
     // Latency information for tracks may be called without obtaining
     // the underlying thread lock.
     //
@@ -685,6 +683,27 @@ status_t AudioFlinger::PatchPanel::Patch::getLatencyMs(double *latencyMs) const
     return INVALID_OPERATION;
 }
 
+status_t AudioFlinger::PatchPanel::Patch::getLatencyMs(double *latencyMs) const
+{
+    if (!isSoftware()) return INVALID_OPERATION;
+
+    auto recordTrack = mRecord.const_track();
+    if (recordTrack.get() == nullptr) return INVALID_OPERATION;
+
+    auto playbackTrack = mPlayback.const_track();
+    if (playbackTrack.get() == nullptr) return INVALID_OPERATION;
+
+    return trackPairLatencyMs(recordTrack, playbackTrack, latencyMs);
+}
+
+status_t AudioFlinger::PatchPanel::DownstreamPatchSnapshot::getLatencyMs(double *latencyMs) const
+{
+    if (recordTrack.get() == nullptr || playbackTrack.get() == nullptr) {
+        return INVALID_OPERATION;
+    }
+    return trackPairLatencyMs(recordTrack, playbackTrack, latencyMs);
+}
+
 String8 AudioFlinger::PatchPanel::Patch::dump(audio_patch_handle_t myHandle) const
 {
     // TODO: Consider table dump form for patches, just like tracks.
@@ -786,6 +805,7 @@ void AudioFlinger::PatchPanel::erasePatch(audio_patch_handle_t handle) {
     mPatches.erase(handle);
     removeSoftwarePatchFromInsertedModules(handle);
     mAudioFlinger.mDeviceEffectManager.releaseAudioPatch(handle);
+    publishRouteSnapshot_l();
 }
 
 /* List connected audio ports and they attributes */
@@ -825,6 +845,7 @@ void AudioFlinger::PatchPanel::notifyStreamOpened(
 {
     if (audioHwDevice->isInsert()) {
         mInsertedModules[audioHwDevice->handle()].streams.insert(stream);
+        publishRouteSnapshot_l();
         if (patch != nullptr) {
             std::vector <SoftwarePatch> swPatches;
             getDownstreamSoftwarePatches(stream, &swPatches);
@@ -843,6 +864,33 @@ void AudioFlinger::PatchPanel::notifyStreamClosed(audio_io_handle_t stream)
     for (auto& module : mInsertedModules) {
         module.second.streams.erase(stream);
     }
+    publishRouteSnapshot_l();
+}
+
+void AudioFlinger::PatchPanel::publishRouteSnapshot_l()
+{
+    auto snapshot = std::make_shared<RouteSnapshot>();
+    for (const auto& module : mInsertedModules) {
+        for (const audio_io_handle_t stream : module.second.streams) {
+            auto& patches = snapshot->downstream[stream];
+            for (const auto& patchHandle : module.second.sw_patches) {
+                const auto& patch_iter = mPatches.find(patchHandle);
+                if (patch_iter == mPatches.end()) {
+                    continue;   // reported by getDownstreamSoftwarePatches()
+                }
+                const Patch &patch = patch_iter->second;
+                patches.push_back(DownstreamPatchSnapshot{
+                        patchHandle,
+                        patch.mPlayback.const_thread()->id(),
+                        patch.mRecord.const_thread()->id(),
+                        patch.mPlayback.const_track(),
+                        patch.mRecord.const_track()});
+            }
+        }
+    }
+    std::atomic_store_explicit(&mRouteSnapshot,
+            std::shared_ptr<const RouteSnapshot>(std::move(snapshot)),
+            std::memory_order_release);
 }
 
 AudioHwDevice* AudioFlinger::PatchPanel::findAudioHwDeviceByModule(audio_module_handle_t module)
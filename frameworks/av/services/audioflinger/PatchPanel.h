@@ -71,6 +71,33 @@ public:
     status_t getDownstreamSoftwarePatches(audio_io_handle_t stream,
             std::vector<SoftwarePatch> *patches) const;
 
+    // One downstream software patch as captured in a route snapshot. The
+    // track references allow the latency computation of Patch::getLatencyMs()
+    // to run without holding any lock.
+    struct DownstreamPatchSnapshot {
+        audio_patch_handle_t patchHandle;
+        audio_io_handle_t playbackThreadHandle;
+        audio_io_handle_t recordThreadHandle;
+        sp<const PlaybackThread::PatchTrack> playbackTrack;
+        sp<const RecordThread::PatchRecord> recordTrack;
+
+        status_t getLatencyMs(double *latencyMs) const;
+    };
+
+    // Immutable snapshot of the downstream software patch routes, keyed by
+    // the upstream stream handle. Republished by publishRouteSnapshot_l() on
+    // every routing change; readers get a consistent view without touching
+    // AudioFlinger::mLock.
+    struct RouteSnapshot {
+        std::map<audio_io_handle_t, std::vector<DownstreamPatchSnapshot>> downstream;
+    };
+
+    // Lock-free; returns nullptr until the first routing change publishes
+    // a snapshot.
+    std::shared_ptr<const RouteSnapshot> getRouteSnapshot() const {
+        return std::atomic_load_explicit(&mRouteSnapshot, std::memory_order_acquire);
+    }
+
     // Notifies patch panel about all opened and closed streams.
     void notifyStreamOpened(AudioHwDevice *audioHwDevice, audio_io_handle_t stream,
                             struct audio_patch *patch);
@@ -236,6 +263,10 @@ private:
             const struct audio_patch *patch);
     void removeSoftwarePatchFromInsertedModules(audio_patch_handle_t handle);
     void erasePatch(audio_patch_handle_t handle);
+    // Rebuilds the route snapshot from mPatches / mInsertedModules and
+    // publishes it for lock-free readers. Must be called with
+    // AudioFlinger::mLock held after any routing change.
+    void publishRouteSnapshot_l();
 
     AudioFlinger &mAudioFlinger;
     std::map<audio_patch_handle_t, Patch> mPatches;
@@ -265,4 +296,6 @@ private:
         std::set<audio_patch_handle_t> sw_patches;
     };
     std::map<audio_module_handle_t, ModuleConnections> mInsertedModules;
+
+    std::shared_ptr<const RouteSnapshot> mRouteSnapshot;
 };
@@ -14,10 +14,13 @@
  * limitations under the License.
  */
 
+#include <mutex>
+
 #include <aaudio/AAudio.h>
 #include <aaudio/AAudioTesting.h>
 #include <android/media/audio/common/AudioMMapPolicy.h>
 #include <cutils/properties.h>
+#include <sys/system_properties.h>
 
 #include "PropertyUtils.h"
 
@@ -64,41 +67,86 @@ AudioMMapPolicy legacy2aidl_aaudio_policy_t_AudioMMapPolicy(aaudio_policy_t lega
     }
 }
 
+namespace {
+
+// Cached, validated snapshot of the properties read during audio path setup.
+// Device-switch reconfiguration calls the getters below many times in a row;
+// re-reading the snapshot costs one __system_property_area_serial() check,
+// and the per-property trie walks are repeated only when some system property
+// actually changed since the snapshot was taken.
+struct PropertySnapshot {
+    int32_t mmapPolicy;           // aaudio.mmap_policy
+    int32_t mmapExclusivePolicy;  // aaudio.mmap_exclusive_policy
+    int32_t mixerBursts;          // aaudio.mixer_bursts
+    int32_t hwBurstMinUsec;       // aaudio.hw_burst_min_usec
+};
+
+std::mutex gSnapshotLock;
+bool gSnapshotValid = false;     // guarded by gSnapshotLock
+uint32_t gSnapshotSerial;        // guarded by gSnapshotLock
+PropertySnapshot gSnapshot;      // guarded by gSnapshotLock
+
+PropertySnapshot getPropertySnapshot() {
+    static const int32_t sDefaultBursts = 2; // arbitrary, use 2 for double buffered
+    static const int32_t sMaxBursts = 1024; // arbitrary
+    static const int32_t sDefaultMicros = 1000; // arbitrary
+    static const int32_t sMaxMicros = 1000 * 1000; // arbitrary
+
+    const uint32_t serial = __system_property_area_serial();
+    std::lock_guard<std::mutex> _l(gSnapshotLock);
+    if (!gSnapshotValid || gSnapshotSerial != serial) {
+        gSnapshot.mmapPolicy = property_get_int32(
+                getMmapPolicyProperty(AudioMMapPolicyType::DEFAULT).c_str(),
+                getDefaultPolicyFromType(AudioMMapPolicyType::DEFAULT));
+        gSnapshot.mmapExclusivePolicy = property_get_int32(
+                getMmapPolicyProperty(AudioMMapPolicyType::EXCLUSIVE).c_str(),
+                getDefaultPolicyFromType(AudioMMapPolicyType::EXCLUSIVE));
+        gSnapshot.mixerBursts = property_get_int32("aaudio.mixer_bursts", sDefaultBursts);
+        if (gSnapshot.mixerBursts <= 0 || gSnapshot.mixerBursts > sMaxBursts) {
+            ALOGE("%s: invalid aaudio.mixer_bursts %d, use default %d",
+                    __func__, gSnapshot.mixerBursts, sDefaultBursts);
+            gSnapshot.mixerBursts = sDefaultBursts;
+        }
+        gSnapshot.hwBurstMinUsec = property_get_int32("aaudio.hw_burst_min_usec", sDefaultMicros);
+        if (gSnapshot.hwBurstMinUsec <= 0 || gSnapshot.hwBurstMinUsec > sMaxMicros) {
+            ALOGE("%s: invalid aaudio.hw_burst_min_usec %d, use default %d",
+                    __func__, gSnapshot.hwBurstMinUsec, sDefaultMicros);
+            gSnapshot.hwBurstMinUsec = sDefaultMicros;
+        }
+        gSnapshotSerial = serial;
+        gSnapshotValid = true;
+    }
+    return gSnapshot;
+}
+
+} // namespace
+
 status_t getMmapPolicyInfosFromSystemProperty(
         AudioMMapPolicyType policyType, std::vector<AudioMMapPolicyInfo> *policyInfos) {
     AudioMMapPolicyInfo policyInfo;
-    const std::string propertyStr = getMmapPolicyProperty(policyType);
-    if (propertyStr.empty()) {
-        return BAD_VALUE;
+    const PropertySnapshot snapshot = getPropertySnapshot();
+    int32_t policy;
+    switch (policyType) {
+        case AudioMMapPolicyType::DEFAULT:
+            policy = snapshot.mmapPolicy;
+            break;
+        case AudioMMapPolicyType::EXCLUSIVE:
+            policy = snapshot.mmapExclusivePolicy;
+            break;
+        default:
+            return BAD_VALUE;
     }
-    policyInfo.mmapPolicy = legacy2aidl_aaudio_policy_t_AudioMMapPolicy(
-            property_get_int32(propertyStr.c_str(), getDefaultPolicyFromType(policyType)));
+    policyInfo.mmapPolicy = legacy2aidl_aaudio_policy_t_AudioMMapPolicy(policy);
     policyInfos->push_back(policyInfo);
     return NO_ERROR;
 }
 
 int32_t getAAudioMixerBurstCountFromSystemProperty() {
-    static const int32_t sDefaultBursts = 2; // arbitrary, use 2 for double buffered
-    static const int32_t sMaxBursts = 1024; // arbitrary
-    static const char* sPropMixerBursts = "aaudio.mixer_bursts";
-    int32_t prop = property_get_int32(sPropMixerBursts, sDefaultBursts);
-    if (prop <= 0 || prop > sMaxBursts) {
-        ALOGE("%s: invalid value %d, use default %d", __func__, prop, sDefaultBursts);
-        prop = sDefaultBursts;
-    }
-    return prop;
+    return getPropertySnapshot().mixerBursts;
 }
 
 int32_t getAAudioHardwareBurstMinUsecFromSystemProperty() {
-    static const int32_t sDefaultMicros = 1000; // arbitrary
-    static const int32_t sMaxMicros = 1000 * 1000; // arbitrary
-    static const char* sPropHwBurstMinUsec = "aaudio.hw_burst_min_usec";
-    int32_t prop = property_get_int32(sPropHwBurstMinUsec, sDefaultMicros);
-    if (prop <= 0 || prop > sMaxMicros) {
-        ALOGE("%s invalid value %d, use default %d", __func__, prop, sDefaultMicros);
-        prop = sDefaultMicros;
-    }
-    return prop;
+    return getPropertySnapshot().hwBurstMinUsec;
 }
 
 } // namespace android
@@ -114,6 +114,14 @@ int SpdifStreamOut::standby()
     return AudioStreamOut::standby();
 }
 
+// writeDataBurst() receives a fully framed IEC61937 data burst from the
+// SPDIF encoder. The burst was staged and byte-swapped inside
+// SPDIFEncoder's internal buffer; making this path zero-copy would need
+// the framer to emit preamble/payload/padding into a HAL-lent buffer,
+// which requires a buffer-lending API on StreamOutHalInterface (write()
+// only takes a caller-owned buffer) plus scatter support in the
+// audio_utils SPDIF framer. Neither interface lives in this tree, so the
+// staging copy stays for now.
 ssize_t SpdifStreamOut::writeDataBurst(const void* buffer, size_t bytes)
 {
     return AudioStreamOut::write(buffer, bytes);
@@ -18,6 +18,7 @@
 #include "FastMixerState.h"
 #include "FastCaptureState.h"
 #include "StateQueue.h"
+#include "MultiStateQueue.h"
 
 // FIXME hack for gcc
 
@@ -25,5 +26,6 @@ namespace android {
 
 template class StateQueue<FastMixerState>;      // typedef FastMixerStateQueue
 template class StateQueue<FastCaptureState>;    // typedef FastCaptureStateQueue
+template class MultiStateQueue<FastMixerState>; // fan-out of mixer state to multiple observers
 
 }
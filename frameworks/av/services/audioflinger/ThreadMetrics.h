@@ -17,6 +17,7 @@
 #ifndef ANDROID_AUDIO_THREADMETRICS_H
 #define ANDROID_AUDIO_THREADMETRICS_H
 
+#include <atomic>
 #include <mutex>
 
 namespace android {
@@ -31,6 +32,10 @@ namespace android {
  * as this class only executes external one-way calls in Mediametrics and does not
  * call any other AudioFlinger class.
  *
+ * Statistics updated from the audio thread itself (underruns) are wait-free
+ * single-writer counters aggregated on the delivery side, so the real-time
+ * path never takes the lock.
+ *
  * Terminology:
  * An AudioInterval is a contiguous playback segment.
  * An AudioIntervalGroup is a group of continuous playback segments on the same device.
@@ -119,13 +124,21 @@ public:
         mDeviceLatencyMs.add(latencyMs);
     }
 
+    // Called by the audio thread every mixer period; must not take mLock or
+    // the real-time callback could block on the control path (priority
+    // inversion). The counters are monotone, written only by the audio
+    // thread, and read on the delivery side relative to a baseline.
     void logUnderrunFrames(size_t frames) {
-        std::lock_guard l(mLock);
         if (mLastUnderrun == false && frames > 0) {
-            ++mUnderrunCount; // count non-continguous underrun sequences.
+            // count non-contiguous underrun sequences.
+            mUnderrunCount.store(mUnderrunCount.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
         }
         mLastUnderrun = (frames > 0);
-        mUnderrunFrames += frames;
+        if (frames > 0) {
+            mUnderrunFrames.store(mUnderrunFrames.load(std::memory_order_relaxed) + frames,
+                    std::memory_order_relaxed);
+        }
     }
 
     const std::string& getMetricsId() const {
@@ -159,9 +172,15 @@ private:
             if (mDeviceLatencyMs.getN() > 0) {
                 item.set(AMEDIAMETRICS_PROP_DEVICELATENCYMS, mDeviceLatencyMs.getMean());
             }
-            if (mUnderrunCount > 0) {
-                item.set(AMEDIAMETRICS_PROP_UNDERRUN, (int32_t)mUnderrunCount)
-                    .set(AMEDIAMETRICS_PROP_UNDERRUNFRAMES, (int64_t)mUnderrunFrames);
+            // Aggregation of the wait-free counters happens here on the
+            // reader side: report the delta since the interval group began.
+            const int64_t underrunCount =
+                    mUnderrunCount.load(std::memory_order_relaxed) - mUnderrunCountBase;
+            const int64_t underrunFrames =
+                    mUnderrunFrames.load(std::memory_order_relaxed) - mUnderrunFramesBase;
+            if (underrunCount > 0) {
+                item.set(AMEDIAMETRICS_PROP_UNDERRUN, (int32_t)underrunCount)
+                    .set(AMEDIAMETRICS_PROP_UNDERRUNFRAMES, underrunFrames);
             }
             item.record();
         }
@@ -177,9 +196,12 @@ private:
 
         mDeviceLatencyMs.reset();
 
-        mLastUnderrun = false;
-        mUnderrunCount = 0;
-        mUnderrunFrames = 0;
+        // The underrun counters are owned by the audio thread and never
+        // reset; rebase the reader instead. mLastUnderrun is also left to
+        // the audio thread (a sequence spanning the group change is counted
+        // once, as before).
+        mUnderrunCountBase = mUnderrunCount.load(std::memory_order_relaxed);
+        mUnderrunFramesBase = mUnderrunFrames.load(std::memory_order_relaxed);
     }
 
     const std::string mMetricsId;
@@ -201,10 +223,14 @@ private:
     // latency and startup for each interval.
     audio_utils::Statistics<double> mDeviceLatencyMs GUARDED_BY(mLock);
 
-    // underrun count and frames
-    bool              mLastUnderrun GUARDED_BY(mLock) = false; // checks consecutive underruns
-    int64_t           mUnderrunCount GUARDED_BY(mLock) = 0;    // number of consecutive underruns
-    int64_t           mUnderrunFrames GUARDED_BY(mLock) = 0;   // total estimated frames underrun
+    // Underrun count and frames. Single writer (the audio thread), which
+    // also owns mLastUnderrun; the delivery side only ever reads the
+    // monotone counters and subtracts the interval group baseline.
+    bool              mLastUnderrun = false;         // checks consecutive underruns
+    std::atomic<int64_t> mUnderrunCount{0};          // number of underrun sequences
+    std::atomic<int64_t> mUnderrunFrames{0};         // total estimated frames underrun
+    int64_t           mUnderrunCountBase GUARDED_BY(mLock) = 0;
+    int64_t           mUnderrunFramesBase GUARDED_BY(mLock) = 0;
 };
 
 } // namespace android
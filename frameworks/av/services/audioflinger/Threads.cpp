@@ -49,6 +49,7 @@
 #include <audio_utils/primitives.h>
 #include <audio_utils/format.h>
 #include <audio_utils/minifloat.h>
+#include <audio_utils/mix_kernels.h>
 #include <audio_utils/safe_math.h>
 #include <system/audio_effects/effect_aec.h>
 #include <system/audio_effects/effect_downmix.h>
@@ -548,6 +549,7 @@ AudioFlinger::ThreadBase::ThreadBase(const sp<AudioFlinger>& audioFlinger, audio
 AudioFlinger::ThreadBase::~ThreadBase()
 {
     // mConfigEvents should be empty, but just in case it isn't, free the memory it owns
+    drainPostedConfigEvents_l();
     mConfigEvents.clear();
 
     // do not lock the mutex in destructor
@@ -614,8 +616,8 @@ status_t AudioFlinger::ThreadBase::sendConfigEvent_l(sp<ConfigEvent>& event)
         mPendingConfigEvents.add(event);
         return status;
     }
-    mConfigEvents.add(event);
-    ALOGV("sendConfigEvent_l() num events %zu event %d", mConfigEvents.size(), event->mType);
+    postConfigEvent(event);
+    ALOGV("sendConfigEvent_l() posted event %d", event->mType);
     mWaitWorkCV.signal();
     mLock.unlock();
     {
@@ -752,11 +754,46 @@ void AudioFlinger::ThreadBase::sendHalLatencyModesChangedEvent_l()
     sendConfigEvent_l(configEvent);
 }
 
-// post condition: mConfigEvents.isEmpty()
+void AudioFlinger::ThreadBase::postConfigEvent(const sp<ConfigEvent>& event)
+{
+    // Treiber push: the stack takes a strong reference, released on drain.
+    ConfigEvent* const raw = event.get();
+    raw->incStrong(this);
+    raw->mNext = mPostedConfigEvents.load(std::memory_order_relaxed);
+    while (!mPostedConfigEvents.compare_exchange_weak(raw->mNext, raw,
+            std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+void AudioFlinger::ThreadBase::drainPostedConfigEvents_l()
+{
+    ConfigEvent* posted = mPostedConfigEvents.exchange(nullptr, std::memory_order_acquire);
+    if (posted == nullptr) return;
+    // The stack is LIFO; reverse the batch so mConfigEvents keeps posting order.
+    // (Batches cannot interleave: there is a single consumer and each drain
+    // takes the whole stack.)
+    ConfigEvent* reversed = nullptr;
+    while (posted != nullptr) {
+        ConfigEvent* const next = posted->mNext;
+        posted->mNext = reversed;
+        reversed = posted;
+        posted = next;
+    }
+    while (reversed != nullptr) {
+        ConfigEvent* const next = reversed->mNext;
+        reversed->mNext = nullptr;
+        mConfigEvents.add(sp<ConfigEvent>(reversed));
+        reversed->decStrong(this);
+        reversed = next;
+    }
+}
+
+// post condition: !hasConfigEvents_l()
 void AudioFlinger::ThreadBase::processConfigEvents_l()
 {
     bool configChanged = false;
 
+    drainPostedConfigEvents_l();
     while (!mConfigEvents.isEmpty()) {
         ALOGV("processConfigEvents_l() remaining events %zu", mConfigEvents.size());
         sp<ConfigEvent> event = mConfigEvents[0];
@@ -834,6 +871,8 @@ void AudioFlinger::ThreadBase::processConfigEvents_l()
                 event->mCond.signal();
             }
         }
+        // pick up anything posted while we were processing
+        drainPostedConfigEvents_l();
         ALOGV_IF(mConfigEvents.isEmpty(), "processConfigEvents_l() DONE thread %p", this);
     }
 
@@ -2235,6 +2274,7 @@ void AudioFlinger::PlaybackThread::dumpInternals_l(int fd, const Vector<String16
     if (mPipeSink.get() != nullptr) {
         dprintf(fd, "  PipeSink frames written: %lld\n", (long long)mPipeSink->framesWritten());
     }
+    mCycleProfiler.dump(fd);
     if (output != nullptr) {
         dprintf(fd, "  Hal stream dump:\n");
         (void)output->stream->dump(fd, args);
@@ -3100,6 +3140,11 @@ void AudioFlinger::PlaybackThread::readOutputParameters_l()
         (void)posix_memalign(&mPostSpatializerBuffer, 32, mPostSpatializerBufferSize);
     }
 
+    // Resolve the per-period copy kernels for the now-fixed format pairs.
+    mMixerToSinkCopier.resolve(mFormat, mMixerBufferFormat);
+    mMixerToEffectCopier.resolve(mEffectBufferFormat, mMixerBufferFormat);
+    mEffectToSinkCopier.resolve(mFormat, mEffectBufferFormat);
+
     mHapticChannelMask = static_cast<audio_channel_mask_t>(mChannelMask & AUDIO_CHANNEL_HAPTIC_ALL);
     mChannelMask = static_cast<audio_channel_mask_t>(mChannelMask & ~mHapticChannelMask);
     mHapticChannelCount = audio_channel_count_from_out_mask(mHapticChannelMask);
@@ -3746,6 +3791,9 @@ bool AudioFlinger::PlaybackThread::threadLoop()
 
         cpuStats.sample(myName);
 
+        mCycleProfiler.cycleBegin(mSampleRate != 0
+                ? (int64_t)mNormalFrameCount * NANOS_PER_SECOND / mSampleRate : 0);
+
         Vector< sp<EffectChain> > effectChains;
         audio_session_t activeHapticSessionId = AUDIO_SESSION_NONE;
         bool isHapticSessionSpatialized = false;
@@ -3755,36 +3803,36 @@ bool AudioFlinger::PlaybackThread::threadLoop()
         //
         // Note: we access outDeviceTypes() outside of mLock.
         if (isMsdDevice() && outDeviceTypes().count(AUDIO_DEVICE_OUT_BUS) != 0) {
-            // Here, we try for the AF lock, but do not block on it as the latency
-            // is more informational.
-            if (mAudioFlinger->mLock.tryLock() == NO_ERROR) {
-                std::vector<PatchPanel::SoftwarePatch> swPatches;
-                double latencyMs;
-                status_t status = INVALID_OPERATION;
-                audio_patch_handle_t downstreamPatchHandle = AUDIO_PATCH_HANDLE_NONE;
-                if (mAudioFlinger->mPatchPanel.getDownstreamSoftwarePatches(id(), &swPatches) == OK
-                        && swPatches.size() > 0) {
-                        status = swPatches[0].getLatencyMs_l(&latencyMs);
-                        downstreamPatchHandle = swPatches[0].getPatchHandle();
+            // The patch panel publishes route state as an immutable snapshot,
+            // so the latency query runs lock-free instead of trying for the
+            // AF lock and skipping the sample on contention.
+            double latencyMs = 0.;
+            status_t status = INVALID_OPERATION;
+            audio_patch_handle_t downstreamPatchHandle = AUDIO_PATCH_HANDLE_NONE;
+            const auto snapshot = mAudioFlinger->mPatchPanel.getRouteSnapshot();
+            if (snapshot != nullptr) {
+                const auto it = snapshot->downstream.find(id());
+                if (it != snapshot->downstream.end() && it->second.size() > 0) {
+                    status = it->second[0].getLatencyMs(&latencyMs);
+                    downstreamPatchHandle = it->second[0].patchHandle;
                 }
-                if (downstreamPatchHandle != lastDownstreamPatchHandle) {
-                    mDownstreamLatencyStatMs.reset();
-                    lastDownstreamPatchHandle = downstreamPatchHandle;
-                }
-                if (status == OK) {
-                    // verify downstream latency (we assume a max reasonable
-                    // latency of 5 seconds).
-                    const double minLatency = 0., maxLatency = 5000.;
-                    if (latencyMs >= minLatency && latencyMs <= maxLatency) {
-                        ALOGVV("new downstream latency %lf ms", latencyMs);
-                    } else {
-                        ALOGD("out of range downstream latency %lf ms", latencyMs);
-                        if (latencyMs < minLatency) latencyMs = minLatency;
-                        else if (latencyMs > maxLatency) latencyMs = maxLatency;
-                    }
-                    mDownstreamLatencyStatMs.add(latencyMs);
+            }
+            if (downstreamPatchHandle != lastDownstreamPatchHandle) {
+                mDownstreamLatencyStatMs.reset();
+                lastDownstreamPatchHandle = downstreamPatchHandle;
+            }
+            if (status == OK) {
+                // verify downstream latency (we assume a max reasonable
+                // latency of 5 seconds).
+                const double minLatency = 0., maxLatency = 5000.;
+                if (latencyMs >= minLatency && latencyMs <= maxLatency) {
+                    ALOGVV("new downstream latency %lf ms", latencyMs);
+                } else {
+                    ALOGD("out of range downstream latency %lf ms", latencyMs);
+                    if (latencyMs < minLatency) latencyMs = minLatency;
+                    else if (latencyMs > maxLatency) latencyMs = maxLatency;
                 }
-                mAudioFlinger->mLock.unlock();
+                mDownstreamLatencyStatMs.add(latencyMs);
             }
         } else {
             if (lastDownstreamPatchHandle != AUDIO_PATCH_HANDLE_NONE) {
@@ -3815,6 +3863,7 @@ bool AudioFlinger::PlaybackThread::threadLoop()
             }
 
             collectTimestamps_l();
+            logPeriodRecord_l(loopCount);
 
             saveOutputTracks();
             if (mSignalPending) {
@@ -3862,7 +3911,7 @@ bool AudioFlinger::PlaybackThread::threadLoop()
                     sendStatistics(false /* force */);
                 }
 
-                if (mActiveTracks.isEmpty() && mConfigEvents.isEmpty()) {
+                if (mActiveTracks.isEmpty() && !hasConfigEvents_l()) {
                     // we're about to wait, flush the binder command buffer
                     IPCThreadState::self()->flushCommands();
 
@@ -3939,6 +3988,8 @@ bool AudioFlinger::PlaybackThread::threadLoop()
             setHalLatencyMode_l();
         } // mLock scope ends
 
+        mCycleProfiler.stageEnd(CycleProfiler::STAGE_PREPARE);
+
         if (mBytesRemaining == 0) {
             mCurrentWriteLength = 0;
             if (mMixerStatus == MIXER_TRACKS_READY) {
@@ -4002,7 +4053,9 @@ bool AudioFlinger::PlaybackThread::threadLoop()
                     }
                 }
 
-                memcpy_by_audio_format(buffer, format, mMixerBuffer, mMixerBufferFormat,
+                const FormatCopier& copier =
+                        mEffectBufferValid ? mMixerToEffectCopier : mMixerToSinkCopier;
+                copier(buffer, mMixerBuffer,
                         mNormalFrameCount * (mixerChannelCount + mHapticChannelCount));
 
                 // If we're going directly to the sink and there are haptic channels,
@@ -4027,6 +4080,8 @@ bool AudioFlinger::PlaybackThread::threadLoop()
                 mBytesRemaining = 0;
             }
 
+            mCycleProfiler.stageEnd(CycleProfiler::STAGE_MIX);
+
             // only process effects if we're going to write
             if (mSleepTimeUs == 0 && mType != OFFLOAD) {
                 for (size_t i = 0; i < effectChains.size(); i ++) {
@@ -4106,14 +4161,14 @@ bool AudioFlinger::PlaybackThread::threadLoop()
             if (mFormat == AUDIO_FORMAT_PCM_FLOAT &&
                     mEffectBufferFormat == AUDIO_FORMAT_PCM_FLOAT) {
                 // Clamp PCM float values more than this distance from 0 to insulate
-                // a HAL which doesn't handle NaN correctly.
+                // a HAL which doesn't handle NaN correctly. The vectorized
+                // kernel also maps NaN to a limit rather than propagating it.
                 static constexpr float HAL_FLOAT_SAMPLE_LIMIT = 2.0f;
-                memcpy_to_float_from_float_with_clamping(static_cast<float*>(mSinkBuffer),
+                audio_utils::intrinsics::copy_with_clamp(static_cast<float*>(mSinkBuffer),
                         static_cast<const float*>(effectBuffer),
                         framesToCopy, HAL_FLOAT_SAMPLE_LIMIT /* absMax */);
             } else {
-                memcpy_by_audio_format(mSinkBuffer, mFormat,
-                        effectBuffer, mEffectBufferFormat, framesToCopy);
+                mEffectToSinkCopier(mSinkBuffer, effectBuffer, framesToCopy);
             }
             // The sample data is partially interleaved when haptic channels exist,
             // we need to adjust channels here.
@@ -4128,6 +4183,8 @@ bool AudioFlinger::PlaybackThread::threadLoop()
         // enable changes in effect chain
         unlockEffectChains(effectChains);
 
+        mCycleProfiler.stageEnd(CycleProfiler::STAGE_EFFECTS);
+
         if (!waitingAsyncCallback()) {
             // mSleepTimeUs == 0 means we must write to audio hardware
             if (mSleepTimeUs == 0) {
@@ -4286,13 +4343,16 @@ bool AudioFlinger::PlaybackThread::threadLoop()
                     // update sleep time (which is >= 0)
                     mSleepTimeUs = deltaNs / 1000;
                 }
-                if (!mSignalPending && mConfigEvents.isEmpty() && !exitPending()) {
+                if (!mSignalPending && !hasConfigEvents_l() && !exitPending()) {
                     mWaitWorkCV.waitRelative(mLock, microseconds((nsecs_t)mSleepTimeUs));
                 }
                 ATRACE_END();
             }
         }
 
+        mCycleProfiler.stageEnd(CycleProfiler::STAGE_WRITE);
+        mCycleProfiler.cycleEnd();
+
         // Finally let go of removed track(s), without the lock held
         // since we can't guarantee the destructors won't acquire that
         // same lock.  This will also mutate and push a new fast mixer state.
@@ -4460,6 +4520,64 @@ void AudioFlinger::PlaybackThread::collectTimestamps_l()
 #endif
 }
 
+// logPeriodRecord_l() must be called with ThreadBase::mLock held, and only from
+// threadLoop(): mNBLogWriter is single-writer, see the comment at logString.
+//
+// Writes one compact flight-recorder entry per mixer period into the thread's
+// NBLog shared-memory ring, plus one entry per observed track state
+// transition. The ring is lock-free on the writer side and is merged into the
+// media.log history by MediaLogService (requestLogMerge() runs every loop), so
+// the seconds leading up to a glitch or crash can be reconstructed from a
+// bugreport with no tracing enabled. The cost is bounded by formatting a
+// handful of integers per period, far below the fast path budget.
+void AudioFlinger::PlaybackThread::logPeriodRecord_l(int64_t loopCount)
+{
+    // Frames written to the HAL but not yet presented by the kernel, i.e. the
+    // sink side fill level; -1 until a kernel timestamp has been collected.
+    int64_t sinkFill = -1;
+    if (mTimestamp.mTimeNs[ExtendedTimestamp::LOCATION_KERNEL] > 0) {
+        sinkFill = mFramesWritten.load()
+                - mTimestamp.mPosition[ExtendedTimestamp::LOCATION_KERNEL];
+    }
+    // Lowest client buffer fill level among the active normal tracks; fast
+    // tracks are recorded by the FastMixer through its own NBLog writer.
+    int64_t minReady = -1;
+    for (const sp<Track>& t : mActiveTracks) {
+        if (t->isFastTrack()) {
+            continue;
+        }
+        const int64_t ready = (int64_t) t->mAudioTrackServerProxy->framesReady();
+        if (minReady < 0 || ready < minReady) {
+            minReady = ready;
+        }
+        const int state = (int) t->mState;
+        const auto it = mLoggedTrackStates.find(t->id());
+        if (it == mLoggedTrackStates.end() || it->second != state) {
+            LOGT("track %d state %d", t->id(), state);
+            mLoggedTrackStates[t->id()] = state;
+        }
+    }
+    // Forget tracks that left the active list, so reactivation logs again.
+    // Linear rescan is fine at the track counts a thread can have.
+    for (auto it = mLoggedTrackStates.begin(); it != mLoggedTrackStates.end(); ) {
+        bool active = false;
+        for (const sp<Track>& t : mActiveTracks) {
+            if (t->id() == it->first) {
+                active = true;
+                break;
+            }
+        }
+        if (active) {
+            ++it;
+        } else {
+            LOGT("track %d inactive", it->first);
+            it = mLoggedTrackStates.erase(it);
+        }
+    }
+    LOGT("period %d act=%d sink=%d rdy=%d",
+            (int) loopCount, (int) mActiveTracks.size(), (int) sinkFill, (int) minReady);
+}
+
 // removeTracks_l() must be called with ThreadBase::mLock held
 void AudioFlinger::PlaybackThread::removeTracks_l(const Vector< sp<Track> >& tracksToRemove)
 {
@@ -4851,6 +4969,8 @@ AudioFlinger::MixerThread::MixerThread(const sp<AudioFlinger>& audioFlinger, Aud
         info.type = NBLog::FASTMIXER;
         mFastMixerNBLogWriter->log<NBLog::EVENT_THREAD_INFO>(info);
 
+        mFastMixerBufferSizer.reset(new FastMixerBufferSizer(mFrameCount, mSampleRate));
+
         // start the fast mixer
         mFastMixer->run("FastMixer", PRIORITY_URGENT_AUDIO);
         pid_t tid = mFastMixer->getTid();
@@ -5799,6 +5919,19 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
         }
     }
 
+    // Let the buffer sizer react to fast mixer underruns and CPU load; a
+    // frame count change is pushed like any other state change and takes
+    // effect at the next fast mix cycle.
+    if (sq != NULL && !coldIdle && mFastMixerBufferSizer != nullptr) {
+        const size_t desired = mFastMixerBufferSizer->update(mFastMixerDumpState);
+        if (desired != state->mFrameCount) {
+            ALOGI("fast mixer frame count %zu -> %zu (underruns %u)",
+                    state->mFrameCount, desired, mFastMixerDumpState.mUnderruns);
+            state->mFrameCount = desired;
+            didModify = true;
+        }
+    }
+
     // Push the new FastMixer state if necessary
     bool pauseAudioWatchdog = false;
     if (didModify) {
@@ -7889,6 +8022,22 @@ reacquire_wakelock:
                 state->mSilenceCapture = silenceFastCapture;
                 didModify = true;
             }
+            // Batch several periods per wakeup when no latency-critical fast
+            // client is attached: the pipe towards the normal path tolerates the
+            // added latency, and the fast capture thread wakes up
+            // kBatchedReadFactor times less often.  Drop back to single-period
+            // reads as soon as a fast track (or patch record) attaches.
+            const uint32_t readBatchFactor =
+                    fastTrack != 0 ? 1 : FastCaptureState::kBatchedReadFactor;
+            if (state->mReadBatchFactor != readBatchFactor) {
+                state->mReadBatchFactor = readBatchFactor;
+                // block until acked when shortening the period for a new fast
+                // track, so the first low-latency read is not still batched.
+                if (readBatchFactor == 1) {
+                    block = FastCaptureStateQueue::BLOCK_UNTIL_ACKED;
+                }
+                didModify = true;
+            }
             sq->end(didModify);
             if (didModify) {
                 sq->push(block);
@@ -8052,23 +8201,31 @@ reacquire_wakelock:
 
         size = activeTracks.size();
 
-        // loop over each active track
-        for (size_t i = 0; i < size; i++) {
-            activeTrack = activeTracks[i];
+        // Convert/resample each active track. Tracks are independent here:
+        // the shared capture buffer state (mRsmpInBuffer, mRsmpInRear) is
+        // read-only during this pass and everything else the body touches is
+        // per-track, so when several slow tracks are active the per-track
+        // work is dispatched to a small worker pool (with this thread
+        // joining in) instead of converting sequentially. Overflow reporting
+        // and timestamp propagation stay on this thread below.
+        enum overrun_t {
+            OVERRUN_UNKNOWN,
+            OVERRUN_TRUE,
+            OVERRUN_FALSE
+        };
+        std::vector<overrun_t> trackOverruns(size, OVERRUN_UNKNOWN);
+        const auto processTrack = [&](size_t i) {
+            const sp<RecordTrack>& activeTrack = activeTracks[i];
 
             // skip fast tracks, as those are handled directly by FastCapture
             if (activeTrack->isFastTrack()) {
-                continue;
+                return;
             }
 
             // TODO: This code probably should be moved to RecordTrack.
             // TODO: Update the activeTrack buffer converter in case of reconfigure.
 
-            enum {
-                OVERRUN_UNKNOWN,
-                OVERRUN_TRUE,
-                OVERRUN_FALSE
-            } overrun = OVERRUN_UNKNOWN;
+            overrun_t overrun = OVERRUN_UNKNOWN;
 
             // loop over getNextBuffer to handle circular sink
             for (;;) {
@@ -8165,8 +8322,36 @@ reacquire_wakelock:
                     break;
                 }
             }
+            trackOverruns[i] = overrun;
+        };
+
+        size_t slowTracks = 0;
+        for (size_t i = 0; i < size; i++) {
+            if (!activeTracks[i]->isFastTrack()) {
+                slowTracks++;
+            }
+        }
+        if (slowTracks > 1) {
+            if (mConverterWorkPool == nullptr) {
+                // created here so the workers inherit this thread's priority
+                mConverterWorkPool.reset(new AudioWorkerPool(2, "RecordConvert"));
+            }
+            mConverterWorkPool->run(size, processTrack);
+        } else {
+            for (size_t i = 0; i < size; i++) {
+                processTrack(i);
+            }
+        }
+
+        // report per-track results serially: overflow logging throttles on a
+        // shared timestamp and timestamps push through shared thread state
+        for (size_t i = 0; i < size; i++) {
+            activeTrack = activeTracks[i];
+            if (activeTrack->isFastTrack()) {
+                continue;
+            }
 
-            switch (overrun) {
+            switch (trackOverruns[i]) {
             case OVERRUN_TRUE:
                 // client isn't retrieving buffers fast enough
                 if (!activeTrack->setOverflow()) {
@@ -9893,7 +10078,7 @@ bool AudioFlinger::MmapThread::threadLoop()
             // A signal was raised while we were unlocked
             mSignalPending = false;
         } else {
-            if (mConfigEvents.isEmpty()) {
+            if (!hasConfigEvents_l()) {
                 // we're about to wait, flush the binder command buffer
                 IPCThreadState::self()->flushCommands();
 
@@ -71,20 +71,21 @@ public:
     // Config event sequence by client if status needed (e.g binder thread calling setParameters()):
     //  1. create SetParameterConfigEvent. This sets mWaitStatus in config event
     //  2. Lock mLock
-    //  3. Call sendConfigEvent_l(): Append to mConfigEvents and mWaitWorkCV.signal
+    //  3. Call sendConfigEvent_l(): lock-free push onto mPostedConfigEvents and mWaitWorkCV.signal
     //  4. sendConfigEvent_l() reads status from event->mStatus;
     //  5. sendConfigEvent_l() returns status
     //  6. Unlock
     //
     // Parameter sequence by server: threadLoop calling processConfigEvents_l():
     // 1. Lock mLock
-    // 2. If there is an entry in mConfigEvents proceed ...
-    // 3. Read first entry in mConfigEvents
-    // 4. Remove first entry from mConfigEvents
-    // 5. Process
-    // 6. Set event->mStatus
-    // 7. event->mCond.signal
-    // 8. Unlock
+    // 2. Drain mPostedConfigEvents into mConfigEvents (single consumer, preserves posting order)
+    // 3. If there is an entry in mConfigEvents proceed ...
+    // 4. Read first entry in mConfigEvents
+    // 5. Remove first entry from mConfigEvents
+    // 6. Process
+    // 7. Set event->mStatus
+    // 8. event->mCond.signal
+    // 9. Unlock
 
     class ConfigEvent: public RefBase {
     public:
@@ -105,6 +106,8 @@ public:
         bool mWaitStatus; // true if sender is waiting for status
         bool mRequiresSystemReady; // true if must wait for system ready to enter event queue
         sp<ConfigEventData> mData;     // event specific parameter data
+        ConfigEvent* mNext = nullptr;  // linkage for ThreadBase::mPostedConfigEvents; owned by
+                                       // the producer until pushed, then by the thread
 
     protected:
         explicit ConfigEvent(int type, bool requiresSystemReady = false) :
@@ -348,6 +351,17 @@ public:
                 // Can temporarily release the lock if waiting for a reply from
                 // processConfigEvents_l().
                 status_t    sendConfigEvent_l(sp<ConfigEvent>& event);
+                // postConfigEvent() pushes onto the lock-free stack and may be called
+                // with or without ThreadBase::mLock held. The caller is responsible for
+                // waking the thread.
+                void        postConfigEvent(const sp<ConfigEvent>& event);
+                // Moves posted events into mConfigEvents; thread (consumer) only.
+                void        drainPostedConfigEvents_l();
+                bool        hasConfigEvents_l() const {
+                                return !mConfigEvents.isEmpty() ||
+                                        mPostedConfigEvents.load(std::memory_order_relaxed)
+                                                != nullptr;
+                            }
                 void        sendIoConfigEvent(audio_io_config_event_t event, pid_t pid = 0,
                                               audio_port_handle_t portId = AUDIO_PORT_HANDLE_NONE);
                 void        sendIoConfigEvent_l(audio_io_config_event_t event, pid_t pid = 0,
@@ -652,6 +666,11 @@ protected:
                 AudioDeviceTypeAddrVector mOutDeviceTypeAddrs; // output device types and addresses
                 AudioDeviceTypeAddr       mInDeviceTypeAddr;   // input device type and address
                 Vector< sp<ConfigEvent> >     mConfigEvents;
+                // Lock-free MPSC stack of freshly posted events: producers push without
+                // holding mLock, and the thread (single consumer) drains into mConfigEvents
+                // at safe points via processConfigEvents_l(). Holds a strong reference to
+                // each pushed event.
+                std::atomic<ConfigEvent*>     mPostedConfigEvents = nullptr;
                 Vector< sp<ConfigEvent> >     mPendingConfigEvents; // events awaiting system ready
 
                 // These fields are written and read by thread itself without lock or barrier,
@@ -1155,6 +1174,13 @@ protected:
     // for any processing (including output processing).
     bool                            mEffectBufferValid;
 
+    // Per-period buffer copy kernels, resolved once in readOutputParameters_l()
+    // for the fixed format pairs, so the copies below do not re-run the
+    // memcpy_by_audio_format() format dispatch on every buffer.
+    FormatCopier                    mMixerToSinkCopier;   // mMixerBuffer -> mSinkBuffer
+    FormatCopier                    mMixerToEffectCopier; // mMixerBuffer -> mEffectBuffer
+    FormatCopier                    mEffectToSinkCopier;  // mEffectBuffer -> mSinkBuffer
+
     // Frame size aligned buffer used as input and output to all post processing effects
     // except the Spatializer in a SPATIALIZER thread. Non spatialized tracks are mixed into
     // this buffer so that post processing effects can be applied.
@@ -1254,6 +1280,8 @@ private:
 
     void        collectTimestamps_l();
 
+    void        logPeriodRecord_l(int64_t loopCount);
+
     // The Tracks class manages tracks added and removed from the Thread.
     template <typename T>
     class Tracks {
@@ -1382,6 +1410,13 @@ private:
     // Downstream patch latency, available if mDownstreamLatencyStatMs.getN() > 0.
     audio_utils::Statistics<double> mDownstreamLatencyStatMs{0.999};
 
+    // Per-cycle CPU budget profiler, written by threadLoop() only.
+    CycleProfiler                   mCycleProfiler;
+
+    // Track states last written to the NBLog flight recorder, keyed by track id,
+    // so logPeriodRecord_l() only logs transitions. Accessed by threadLoop() only.
+    std::map<int, int>              mLoggedTrackStates;
+
 public:
     virtual     bool        hasFastMixer() const = 0;
     virtual     FastTrackUnderruns getFastTrackUnderruns(size_t fastIndex __unused) const
@@ -1489,6 +1524,9 @@ private:
                 sp<FastMixer>     mFastMixer;     // non-0 if there is also a fast mixer
                 sp<AudioWatchdog> mAudioWatchdog; // non-0 if there is an audio watchdog thread
 
+                // non-null iff mFastMixer != 0; accessed only within threadLoop()
+                std::unique_ptr<FastMixerBufferSizer> mFastMixerBufferSizer;
+
                 // contents are not guaranteed to be consistent, no locks required
                 FastMixerDumpState mFastMixerDumpState;
 #ifdef STATE_QUEUE_DUMP
@@ -1994,6 +2032,10 @@ private:
             // rolling index that is never cleared
             int32_t                             mRsmpInRear;    // last filled frame + 1
 
+            // created lazily by threadLoop() when multiple slow tracks need
+            // conversion; accessed only within threadLoop()
+            std::unique_ptr<AudioWorkerPool>    mConverterWorkPool;
+
             // For dumpsys
             const sp<MemoryDealer>              mReadOnlyHeap;
 
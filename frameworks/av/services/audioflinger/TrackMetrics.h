@@ -17,6 +17,8 @@
 #ifndef ANDROID_AUDIO_TRACKMETRICS_H
 #define ANDROID_AUDIO_TRACKMETRICS_H
 
+#include <array>
+#include <atomic>
 #include <mutex>
 
 namespace android {
@@ -31,6 +33,11 @@ namespace android {
  * as this class only executes external one-way calls in Mediametrics and does not
  * call any other AudioFlinger class.
  *
+ * Statistics updated from the audio thread itself (volume changes,
+ * underruns) go through wait-free single-writer structures and are
+ * aggregated on the delivery side, so the real-time path never takes the
+ * lock.
+ *
  * Terminology:
  * An AudioInterval is a contiguous playback segment.
  * An AudioIntervalGroup is a group of continuous playback segments on the same device.
@@ -56,6 +63,7 @@ public:
     // 2) when we have a createPatch in the Thread.
     void logBeginInterval(const std::string& devices) {
         std::lock_guard l(mLock);
+        drainVolumeEvents_l();
         if (mDevices != devices) {
             deliverCumulativeMetrics(AMEDIAMETRICS_PROP_EVENT_VALUE_ENDAUDIOINTERVALGROUP);
             mDevices = devices;
@@ -89,8 +97,9 @@ public:
     // Called when we are removed from the Thread.
     void logEndInterval() {
         std::lock_guard l(mLock);
+        drainVolumeEvents_l();
         if (mLastVolumeChangeTimeNs != 0) {
-            logVolume_l(mVolume); // flush out the last volume.
+            logVolumeEvent_l(systemTime(), mVolume); // flush out the last volume.
             mLastVolumeChangeTimeNs = 0;
         }
     }
@@ -128,17 +137,28 @@ public:
         }
     }
 
-    // may be called multiple times during an interval
+    // May be called multiple times during an interval, from the audio thread
+    // itself, so it must not take mLock. The change is queued into a
+    // single-writer ring and folded into the volume statistics by the next
+    // reader-side aggregation (interval end, interval group change or
+    // delivery). If the ring is momentarily full the event is dropped and
+    // the previous volume stays in effect, which only perturbs the averages;
+    // it can never block the callback.
     void logVolume(float volume) {
-        std::lock_guard l(mLock);
-        logVolume_l(volume);
+        const uint32_t head = mVolumeEventHead.load(std::memory_order_relaxed);
+        if (head - mVolumeEventTail.load(std::memory_order_acquire) < kVolumeEventCapacity) {
+            VolumeEvent& event = mVolumeEvents[head % kVolumeEventCapacity];
+            event.timeNs = systemTime();
+            event.volume = volume;
+            mVolumeEventHead.store(head + 1, std::memory_order_release);
+        }
     }
 
-    // Use absolute numbers returned by AudioTrackShared.
+    // Use absolute numbers returned by AudioTrackShared. Called by the audio
+    // thread; plain wait-free stores, read on the delivery side.
     void logUnderruns(size_t count, size_t frames) {
-        std::lock_guard l(mLock);
-        mUnderrunCount = count;
-        mUnderrunFrames = frames;
+        mUnderrunCount.store(count, std::memory_order_relaxed);
+        mUnderrunFrames.store(frames, std::memory_order_relaxed);
         // Consider delivering a message here (also be aware of excessive spam).
     }
 
@@ -153,8 +173,20 @@ private:
            .record();
     }
 
-    void logVolume_l(float volume) REQUIRES(mLock) {
-        const int64_t timeNs = systemTime();
+    // Drains the wait-free volume event ring into the statistics. All
+    // aggregation happens here on the reader side, under mLock.
+    void drainVolumeEvents_l() REQUIRES(mLock) {
+        uint32_t tail = mVolumeEventTail.load(std::memory_order_relaxed);
+        const uint32_t head = mVolumeEventHead.load(std::memory_order_acquire);
+        while (tail != head) {
+            const VolumeEvent& event = mVolumeEvents[tail % kVolumeEventCapacity];
+            logVolumeEvent_l(event.timeNs, event.volume);
+            ++tail;
+        }
+        mVolumeEventTail.store(tail, std::memory_order_release);
+    }
+
+    void logVolumeEvent_l(int64_t timeNs, float volume) REQUIRES(mLock) {
         const int64_t durationNs = mLastVolumeChangeTimeNs == 0
                 ? 0 : timeNs - mLastVolumeChangeTimeNs;
         if (durationNs > 0) {
@@ -188,11 +220,13 @@ private:
                 item.set(AMEDIAMETRICS_PROP_DEVICELATENCYMS, mDeviceLatencyMs.getMean())
                     .set(AMEDIAMETRICS_PROP_DEVICESTARTUPMS, mDeviceStartupMs.getMean());
             }
-            if (mUnderrunCount > 0) {
+            const int64_t underrunCount = mUnderrunCount.load(std::memory_order_relaxed);
+            const int64_t underrunFrames = mUnderrunFrames.load(std::memory_order_relaxed);
+            if (underrunCount > 0) {
                 item.set(AMEDIAMETRICS_PROP_UNDERRUN,
-                        (int32_t)(mUnderrunCount - mUnderrunCountSinceIntervalGroup))
+                        (int32_t)(underrunCount - mUnderrunCountSinceIntervalGroup))
                     .set(AMEDIAMETRICS_PROP_UNDERRUNFRAMES,
-                        (int64_t)(mUnderrunFrames - mUnderrunFramesSinceIntervalGroup));
+                        underrunFrames - mUnderrunFramesSinceIntervalGroup);
             }
             item.record();
         }
@@ -216,8 +250,8 @@ private:
         mDeviceLatencyMs.reset();
         mDeviceStartupMs.reset();
 
-        mUnderrunCountSinceIntervalGroup = mUnderrunCount;
-        mUnderrunFramesSinceIntervalGroup = mUnderrunFrames;
+        mUnderrunCountSinceIntervalGroup = mUnderrunCount.load(std::memory_order_relaxed);
+        mUnderrunFramesSinceIntervalGroup = mUnderrunFrames.load(std::memory_order_relaxed);
         // do not reset mUnderrunCount - it keeps continuously running for tracks.
     }
 
@@ -249,9 +283,22 @@ private:
     audio_utils::Statistics<double> mDeviceLatencyMs GUARDED_BY(mLock);
     audio_utils::Statistics<double> mDeviceStartupMs GUARDED_BY(mLock);
 
-    // underrun count and frames
-    int64_t           mUnderrunCount GUARDED_BY(mLock) = 0;
-    int64_t           mUnderrunFrames GUARDED_BY(mLock) = 0;
+    // Wait-free volume event ring: the audio thread is the single producer,
+    // the delivery side drains it under mLock. The volume statistics above
+    // are only ever touched by the reader.
+    struct VolumeEvent {
+        int64_t timeNs = 0;
+        float   volume = 0.f;
+    };
+    static constexpr uint32_t kVolumeEventCapacity = 128;  // power of two.
+    std::array<VolumeEvent, kVolumeEventCapacity> mVolumeEvents;
+    std::atomic<uint32_t> mVolumeEventHead{0};  // written by the audio thread.
+    std::atomic<uint32_t> mVolumeEventTail{0};  // written under mLock.
+
+    // Underrun count and frames: absolute values, single writer (the audio
+    // thread); the delivery side reads them and subtracts the baselines.
+    std::atomic<int64_t> mUnderrunCount{0};
+    std::atomic<int64_t> mUnderrunFrames{0};
     int64_t           mUnderrunCountSinceIntervalGroup GUARDED_BY(mLock) = 0;
     int64_t           mUnderrunFramesSinceIntervalGroup GUARDED_BY(mLock) = 0;
 };
@@ -0,0 +1,318 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "dumpstate"
+
+#include "CommandBroker.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+
+#include <log/log.h>
+
+#include "DumpstateInternal.h"
+
+namespace android {
+namespace os {
+namespace dumpstate {
+
+namespace {
+
+// Request header; followed by argc NUL-terminated argv strings and
+// accompanied by [output fd, reply fd] as SCM_RIGHTS ancillary data.
+struct RequestHeader {
+    int64_t timeout_ms;
+    uint32_t argc;
+};
+
+constexpr size_t kMaxRequestBytes = 16 * 1024;
+// Extra time Execute() waits for the reply after the command timeout, which
+// covers the broker's own SIGTERM/SIGKILL escalation.
+constexpr int64_t kReplyGraceMs = 5000;
+
+// One spawned helper the broker is still waiting for.
+struct PendingCommand {
+    android::base::unique_fd reply_fd;
+    int64_t deadline_ms;
+    bool killed = false;
+};
+
+int64_t NowMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000LL;
+}
+
+void SendReply(android::base::unique_fd reply_fd, int32_t status) {
+    TEMP_FAILURE_RETRY(write(reply_fd.get(), &status, sizeof(status)));
+    // reply_fd closes here; the requester also observes EOF if the write
+    // raced with its timeout.
+}
+
+void ReapChildren(std::map<pid_t, PendingCommand>* pending) {
+    for (;;) {
+        int status;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid <= 0) {
+            return;
+        }
+        auto it = pending->find(pid);
+        if (it == pending->end()) {
+            continue;
+        }
+        int32_t result = -1;
+        if (it->second.killed) {
+            result = -1;
+        } else if (WIFEXITED(status)) {
+            result = WEXITSTATUS(status);
+        }
+        SendReply(std::move(it->second.reply_fd), result);
+        pending->erase(it);
+    }
+}
+
+void KillOverdue(std::map<pid_t, PendingCommand>* pending, int64_t now_ms) {
+    for (auto& [pid, command] : *pending) {
+        if (command.killed || command.deadline_ms > now_ms) {
+            continue;
+        }
+        // SIGTERM first; anything still alive at the next deadline pass
+        // after the grace period gets SIGKILL.
+        kill(pid, SIGTERM);
+        command.killed = true;
+        command.deadline_ms = now_ms + kReplyGraceMs / 2;
+    }
+    for (auto& [pid, command] : *pending) {
+        if (command.killed && command.deadline_ms <= now_ms) {
+            kill(pid, SIGKILL);
+        }
+    }
+}
+
+void HandleRequest(int socket_fd, std::map<pid_t, PendingCommand>* pending, bool* done) {
+    char payload[kMaxRequestBytes];
+    alignas(struct cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))];
+    struct iovec iov = {.iov_base = payload, .iov_len = sizeof(payload)};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received = TEMP_FAILURE_RETRY(recvmsg(socket_fd, &msg, MSG_CMSG_CLOEXEC));
+    if (received <= 0) {
+        // EOF: dumpstate closed its end (or died); serve what's in flight
+        // and exit.
+        *done = true;
+        return;
+    }
+
+    android::base::unique_fd output_fd;
+    android::base::unique_fd reply_fd;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN(2 * sizeof(int))) {
+            const int* fds = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+            output_fd.reset(fds[0]);
+            reply_fd.reset(fds[1]);
+        }
+    }
+    if (static_cast<size_t>(received) < sizeof(RequestHeader) || output_fd.get() < 0 ||
+        reply_fd.get() < 0) {
+        return;
+    }
+
+    RequestHeader header;
+    memcpy(&header, payload, sizeof(header));
+    std::vector<const char*> argv;
+    const char* cursor = payload + sizeof(header);
+    const char* end = payload + received;
+    for (uint32_t i = 0; i < header.argc && cursor < end; i++) {
+        argv.push_back(cursor);
+        cursor += strnlen(cursor, end - cursor) + 1;
+    }
+    if (argv.size() != header.argc || argv.empty() || cursor > end) {
+        SendReply(std::move(reply_fd), -1);
+        return;
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        SendReply(std::move(reply_fd), -1);
+        return;
+    }
+    if (pid == 0) {
+        TEMP_FAILURE_RETRY(dup2(output_fd.get(), STDOUT_FILENO));
+        /* make sure the helper dies when the broker dies */
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        execvp(argv[0], const_cast<char**>(argv.data()));
+        _exit(EXIT_FAILURE);
+    }
+    PendingCommand command;
+    command.reply_fd = std::move(reply_fd);
+    command.deadline_ms = NowMs() + header.timeout_ms;
+    pending->emplace(pid, std::move(command));
+}
+
+}  // namespace
+
+void CommandBroker::ServeRequests(int socket_fd) {
+    /* die with dumpstate rather than lingering */
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+
+    /* just ignore SIGPIPE: a requester may give up before the reply */
+    signal(SIGPIPE, SIG_IGN);
+
+    // The batched scheduling policy: applied once here, inherited by every
+    // helper, so the section commands stop competing with the foreground
+    // app and no child pays the policy syscalls itself.
+    setpriority(PRIO_PROCESS, 0, /* ANDROID_PRIORITY_BACKGROUND */ 10);
+    struct sched_param param = {};
+    sched_setscheduler(0, SCHED_BATCH, &param);
+
+    std::map<pid_t, PendingCommand> pending;
+    bool done = false;
+    while (!done || !pending.empty()) {
+        int64_t now_ms = NowMs();
+        int64_t next_deadline_ms = now_ms + 1000;
+        for (const auto& [pid, command] : pending) {
+            next_deadline_ms = std::min(next_deadline_ms, command.deadline_ms);
+        }
+        struct pollfd pfd = {.fd = socket_fd, .events = POLLIN, .revents = 0};
+        int timeout = static_cast<int>(std::max<int64_t>(next_deadline_ms - now_ms, 0));
+        int polled = poll(&pfd, done ? 0 : 1, timeout);
+
+        ReapChildren(&pending);
+        KillOverdue(&pending, NowMs());
+
+        if (polled > 0 && (pfd.revents & (POLLIN | POLLHUP))) {
+            HandleRequest(socket_fd, &pending, &done);
+        }
+    }
+    _exit(EXIT_SUCCESS);
+}
+
+std::unique_ptr<CommandBroker> CommandBroker::Create() {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) != 0) {
+        MYLOGE("CommandBroker socketpair failed: %s\n", strerror(errno));
+        return nullptr;
+    }
+    android::base::unique_fd local_fd(fds[0]);
+    android::base::unique_fd broker_fd(fds[1]);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        MYLOGE("CommandBroker fork failed: %s\n", strerror(errno));
+        return nullptr;
+    }
+    if (pid == 0) {
+        local_fd.reset();
+        ServeRequests(broker_fd.get());
+        _exit(EXIT_FAILURE);  // not reached
+    }
+    MYLOGI("Started command broker (pid %d)\n", pid);
+    return std::unique_ptr<CommandBroker>(new CommandBroker(pid, std::move(local_fd)));
+}
+
+CommandBroker::CommandBroker(pid_t pid, android::base::unique_fd socket_fd)
+    : pid_(pid), socket_fd_(std::move(socket_fd)) {
+}
+
+CommandBroker::~CommandBroker() {
+    // Closing the socket makes the broker drain in-flight helpers and exit.
+    socket_fd_.reset();
+    TEMP_FAILURE_RETRY(waitpid(pid_, nullptr, 0));
+}
+
+int CommandBroker::Execute(const std::vector<std::string>& full_command, int fd,
+                           int64_t timeout_ms) {
+    if (full_command.empty()) {
+        return -1;
+    }
+
+    std::vector<char> payload(sizeof(RequestHeader));
+    RequestHeader header = {.timeout_ms = timeout_ms,
+                            .argc = static_cast<uint32_t>(full_command.size())};
+    memcpy(payload.data(), &header, sizeof(header));
+    for (const std::string& arg : full_command) {
+        payload.insert(payload.end(), arg.c_str(), arg.c_str() + arg.size() + 1);
+    }
+    if (payload.size() > kMaxRequestBytes) {
+        return -1;
+    }
+
+    int pipe_fds[2];
+    if (pipe2(pipe_fds, O_CLOEXEC) != 0) {
+        return -1;
+    }
+    android::base::unique_fd reply_read(pipe_fds[0]);
+    android::base::unique_fd reply_write(pipe_fds[1]);
+
+    alignas(struct cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))] = {};
+    struct iovec iov = {.iov_base = payload.data(), .iov_len = payload.size()};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+    int sent_fds[2] = {fd, reply_write.get()};
+    memcpy(CMSG_DATA(cmsg), sent_fds, sizeof(sent_fds));
+
+    {
+        std::lock_guard<std::mutex> lock(send_lock_);
+        if (TEMP_FAILURE_RETRY(sendmsg(socket_fd_.get(), &msg, 0)) < 0) {
+            MYLOGE("CommandBroker sendmsg failed: %s\n", strerror(errno));
+            return -1;
+        }
+    }
+    reply_write.reset();
+
+    struct pollfd pfd = {.fd = reply_read.get(), .events = POLLIN, .revents = 0};
+    int polled = TEMP_FAILURE_RETRY(poll(&pfd, 1, static_cast<int>(timeout_ms + kReplyGraceMs)));
+    if (polled <= 0) {
+        return -1;
+    }
+    int32_t status = -1;
+    if (TEMP_FAILURE_RETRY(read(reply_read.get(), &status, sizeof(status))) !=
+        static_cast<ssize_t>(sizeof(status))) {
+        return -1;
+    }
+    return status;
+}
+
+}  // namespace dumpstate
+}  // namespace os
+}  // namespace android
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRAMEWORK_NATIVE_CMD_COMMANDBROKER_H_
+#define FRAMEWORK_NATIVE_CMD_COMMANDBROKER_H_
+
+#include <sys/types.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <android-base/macros.h>
+#include <android-base/unique_fd.h>
+
+namespace android {
+namespace os {
+namespace dumpstate {
+
+/*
+ * A helper process that executes section commands on behalf of dumpstate.
+ *
+ * dumpstate itself accumulates a large heap and many threads as the report
+ * progresses, which makes every fork progressively more expensive and lets
+ * dozens of helper spawns compete with the foreground app. The broker is
+ * forked once, right after dumpstate drops root, while the address space is
+ * still small; all later spawns happen from that small, single-threaded
+ * process. The broker also applies the scheduling policy for helpers
+ * (background priority and SCHED_BATCH) exactly once to itself, so every
+ * helper inherits it for free instead of each child paying the setup calls.
+ *
+ * Requests travel over a SOCK_SEQPACKET socketpair. Each request carries the
+ * argv, a timeout, the output fd and a per-request reply pipe via
+ * SCM_RIGHTS; the broker forks/execs the helper, enforces the timeout, and
+ * writes the exit status to the reply pipe once the helper is reaped.
+ * Requests only hold the shared socket long enough to be sent, so the dump
+ * pool threads can have several commands in flight at once.
+ *
+ * The broker runs with the credentials dumpstate had when Create() was
+ * called; commands that need a different identity must keep using the
+ * regular fork/exec path.
+ */
+class CommandBroker {
+  public:
+    /*
+     * Forks the broker process. Returns nullptr on failure. The broker exits
+     * when the returned object is destroyed (or when dumpstate dies).
+     */
+    static std::unique_ptr<CommandBroker> Create();
+
+    ~CommandBroker();
+
+    /*
+     * Executes |full_command| with stdout redirected to |fd|, waiting at most
+     * |timeout_ms| (plus a short grace period for the reply). Returns the
+     * command's exit status, or -1 on broker/socket failure, timeout, or
+     * death by signal.
+     */
+    int Execute(const std::vector<std::string>& full_command, int fd, int64_t timeout_ms);
+
+  private:
+    explicit CommandBroker(pid_t pid, android::base::unique_fd socket_fd);
+
+    // Entry point of the forked broker process; never returns.
+    static void ServeRequests(int socket_fd);
+
+    pid_t pid_;
+    android::base::unique_fd socket_fd_;
+    // Serializes sendmsg() calls from concurrent dump pool threads.
+    std::mutex send_lock_;
+
+    DISALLOW_COPY_AND_ASSIGN(CommandBroker);
+};
+
+}  // namespace dumpstate
+}  // namespace os
+}  // namespace android
+
+#endif  // FRAMEWORK_NATIVE_CMD_COMMANDBROKER_H_
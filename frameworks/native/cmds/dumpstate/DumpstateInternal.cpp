@@ -27,6 +27,7 @@
 #include <string.h>
 #include <sys/capability.h>
 #include <sys/prctl.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -162,6 +163,44 @@ int DumpFileFromFdToFd(const std::string& title, const std::string& path_string,
         return 0;
     }
     bool newline = false;
+    // Regular files with a known size (logs, traces) can be copied by the
+    // kernel straight into the output, avoiding the user-space bounce buffer
+    // and the per-64KB syscall pair. Pseudo-files under /proc and /sys report
+    // a zero size and keep the poll/read loop below.
+    struct stat in_st;
+    if (fstat(fd, &in_st) == 0 && S_ISREG(in_st.st_mode) && in_st.st_size > 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        off_t total = 0;
+        bool fallback = false;
+        while (true) {
+            ssize_t sent = TEMP_FAILURE_RETRY(sendfile(out_fd, fd, nullptr, 1 << 30));
+            if (sent == 0) {
+                break;
+            } else if (sent == -1) {
+                if (total == 0 && (errno == EINVAL || errno == ENOSYS)) {
+                    // Destination doesn't take sendfile; use the read loop.
+                    fallback = true;
+                } else {
+                    dprintf(out_fd, "*** %s: Failed to read from fd: %s", path, strerror(errno));
+                    newline = true;
+                }
+                break;
+            }
+            total += sent;
+        }
+        if (!fallback) {
+            if (total > 0 && !newline) {
+                char last;
+                off_t end = lseek(fd, 0, SEEK_CUR);
+                if (end > 0 && TEMP_FAILURE_RETRY(pread(fd, &last, 1, end - 1)) == 1) {
+                    newline = (last == '\n');
+                }
+            }
+            if (!newline) dprintf(out_fd, "\n");
+            if (!title.empty()) dprintf(out_fd, "\n");
+            return 0;
+        }
+    }
     int poll_timeout_ms = 30 * 1000;
     while (true) {
         pollfd fds[] = { { .fd = fd, .events = POLLIN } };
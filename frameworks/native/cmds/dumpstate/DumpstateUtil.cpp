@@ -207,6 +207,7 @@ std::string PropertiesHelper::build_type_ = "";
 int PropertiesHelper::dry_run_ = -1;
 int PropertiesHelper::unroot_ = -1;
 int PropertiesHelper::parallel_run_ = -1;
+int PropertiesHelper::streamed_compression_ = -1;
 
 bool PropertiesHelper::IsUserBuild() {
     if (build_type_.empty()) {
@@ -237,6 +238,14 @@ bool PropertiesHelper::IsParallelRun() {
     return parallel_run_ == 1;
 }
 
+bool PropertiesHelper::IsStreamedCompression() {
+    if (streamed_compression_ == -1) {
+        streamed_compression_ = android::base::GetBoolProperty("dumpstate.compress_tmp",
+                /* default_value = */true) ? 1 : 0;
+    }
+    return streamed_compression_ == 1;
+}
+
 int DumpFileToFd(int out_fd, const std::string& title, const std::string& path) {
     android::base::unique_fd fd(TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC)));
     if (fd.get() < 0) {
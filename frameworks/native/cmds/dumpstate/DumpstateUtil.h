@@ -193,11 +193,20 @@ class PropertiesHelper {
      */
     static bool IsParallelRun();
 
+    /*
+     * Whether or not the main bugreport entry is compressed while it is
+     * produced instead of being kept as plain text until the zip file is
+     * finished. Setting the system property 'dumpstate.compress_tmp' to
+     * false to disable it, otherwise it returns true by default.
+     */
+    static bool IsStreamedCompression();
+
   private:
     static std::string build_type_;
     static int dry_run_;
     static int unroot_;
     static int parallel_run_;
+    static int streamed_compression_;
 };
 
 /*
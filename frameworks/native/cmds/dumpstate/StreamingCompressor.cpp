@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "dumpstate"
+
+#include "StreamingCompressor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <log/log.h>
+#include <zlib.h>
+
+#include "DumpstateInternal.h"
+
+namespace android {
+namespace os {
+namespace dumpstate {
+
+StreamingCompressor::StreamingCompressor(const std::string& gz_path) : gz_path_(gz_path) {
+}
+
+StreamingCompressor::~StreamingCompressor() {
+    if (thread_.joinable()) {
+        abandon();
+    }
+}
+
+bool StreamingCompressor::start() {
+    int data_fds[2];
+    if (pipe2(data_fds, O_CLOEXEC) != 0) {
+        MYLOGE("pipe2: %s\n", strerror(errno));
+        return false;
+    }
+    read_fd_.reset(data_fds[0]);
+    write_fd_.reset(data_fds[1]);
+
+    int stop_fds[2];
+    if (pipe2(stop_fds, O_CLOEXEC) != 0) {
+        MYLOGE("pipe2: %s\n", strerror(errno));
+        read_fd_.reset();
+        write_fd_.reset();
+        return false;
+    }
+    stop_read_fd_.reset(stop_fds[0]);
+    stop_write_fd_.reset(stop_fds[1]);
+
+    thread_ = std::thread([this]() {
+        pthread_setname_np(pthread_self(), "dumpstate_gz");
+        loop();
+    });
+    return true;
+}
+
+void StreamingCompressor::closeWriteFd() {
+    write_fd_.reset();
+}
+
+bool StreamingCompressor::finish() {
+    if (!joined_) {
+        thread_.join();
+        joined_ = true;
+    }
+    return !error_;
+}
+
+void StreamingCompressor::abandon() {
+    if (joined_) {
+        return;
+    }
+    uint8_t stop = 0;
+    if (TEMP_FAILURE_RETRY(write(stop_write_fd_.get(), &stop, sizeof(stop))) == -1) {
+        MYLOGE("Failed to stop the compressor thread: %s\n", strerror(errno));
+        // Fall through; the join below then waits for end-of-file instead.
+    }
+    thread_.join();
+    joined_ = true;
+    error_ = true;
+}
+
+void StreamingCompressor::loop() {
+    // Compression level 1 keeps up with section production while still
+    // shrinking the text by roughly an order of magnitude; the final zip
+    // entry is compressed at the default level anyway.
+    gzFile gz = gzopen(gz_path_.c_str(), "wb1");
+    if (gz == nullptr) {
+        MYLOGE("gzopen(%s): %s\n", gz_path_.c_str(), strerror(errno));
+        error_ = true;
+        // Keep draining the pipe so writers do not block on a full pipe.
+    }
+
+    struct pollfd pfds[2] = {{read_fd_.get(), POLLIN, 0}, {stop_read_fd_.get(), POLLIN, 0}};
+    std::vector<uint8_t> buffer(65536);
+    while (true) {
+        pfds[0].revents = pfds[1].revents = 0;
+        if (TEMP_FAILURE_RETRY(poll(pfds, 2, -1)) == -1) {
+            MYLOGE("poll: %s\n", strerror(errno));
+            error_ = true;
+            break;
+        }
+        // Drain pending data before honoring a stop request so an abandoned
+        // copy is still as complete as possible.
+        if (pfds[0].revents != 0) {
+            ssize_t bytes_read =
+                    TEMP_FAILURE_RETRY(read(read_fd_.get(), buffer.data(), buffer.size()));
+            if (bytes_read == 0) {
+                break;
+            } else if (bytes_read == -1) {
+                MYLOGE("read: %s\n", strerror(errno));
+                error_ = true;
+                break;
+            }
+            if (gz != nullptr && !error_ && gzwrite(gz, buffer.data(), bytes_read) != bytes_read) {
+                int zerr;
+                MYLOGE("gzwrite(%s): %s\n", gz_path_.c_str(), gzerror(gz, &zerr));
+                error_ = true;
+                // Keep draining the pipe so writers do not block.
+            }
+        } else if (pfds[1].revents != 0) {
+            break;
+        }
+    }
+
+    if (gz != nullptr && gzclose(gz) != Z_OK) {
+        MYLOGE("gzclose(%s) failed\n", gz_path_.c_str());
+        error_ = true;
+    }
+}
+
+}  // namespace dumpstate
+}  // namespace os
+}  // namespace android
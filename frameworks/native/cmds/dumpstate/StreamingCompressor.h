@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FRAMEWORK_NATIVE_CMD_STREAMINGCOMPRESSOR_H_
+#define FRAMEWORK_NATIVE_CMD_STREAMINGCOMPRESSOR_H_
+
+#include <string>
+#include <thread>
+
+#include <android-base/macros.h>
+#include <android-base/unique_fd.h>
+
+namespace android {
+namespace os {
+namespace dumpstate {
+
+/*
+ * Compresses the main bugreport entry while it is being produced instead of
+ * keeping the whole text on disk until the zip file is finished. start()
+ * creates a pipe and a compressor thread; the caller redirects stdout to
+ * writeFd() so section output flows through the pipe, and the thread gzips it
+ * to the given path as it arrives. This overlaps compression with the dump
+ * run and keeps only the (roughly 10x smaller) compressed copy on disk, which
+ * matters on low-storage devices where the uncompressed temporary file can
+ * make the bugreport abort.
+ *
+ * The thread finishes when the pipe hits end-of-file, i.e. once the caller
+ * has restored stdout and any spawned commands have exited. finish() joins it
+ * and reports whether the compressed copy is complete. abandon() unblocks the
+ * thread without waiting for end-of-file, for bail-out paths where stdout is
+ * still redirected.
+ */
+class StreamingCompressor {
+  public:
+    explicit StreamingCompressor(const std::string& gz_path);
+
+    /* Joins the compressor thread, abandoning it if it is still draining. */
+    ~StreamingCompressor();
+
+    /*
+     * Creates the pipe, opens the output file and starts the compressor
+     * thread. Returns false on failure, in which case the caller should fall
+     * back to an uncompressed temporary file.
+     */
+    bool start();
+
+    /* The pipe write end, to be dup2'ed onto stdout. */
+    int writeFd() const {
+        return write_fd_.get();
+    }
+
+    /*
+     * Drops this process' reference to the pipe write end once it has been
+     * duplicated onto stdout, so that restoring stdout later produces
+     * end-of-file on the pipe.
+     */
+    void closeWriteFd();
+
+    /*
+     * Waits for the compressor thread to drain the pipe and finish the gzip
+     * stream. Returns false if any write failed, in which case the compressed
+     * copy is incomplete and must not be used.
+     */
+    bool finish();
+
+    /*
+     * Unblocks and joins the compressor thread without waiting for
+     * end-of-file on the pipe. The output file is left incomplete.
+     */
+    void abandon();
+
+    /* Path of the compressed copy. */
+    const std::string& path() const {
+        return gz_path_;
+    }
+
+  private:
+    void loop();
+
+    std::string gz_path_;
+    android::base::unique_fd read_fd_;
+    android::base::unique_fd write_fd_;
+    /* Written by abandon() to unblock the thread while the pipe is open. */
+    android::base::unique_fd stop_read_fd_;
+    android::base::unique_fd stop_write_fd_;
+    std::thread thread_;
+    bool error_ = false;
+    bool joined_ = false;
+
+    DISALLOW_COPY_AND_ASSIGN(StreamingCompressor);
+};
+
+}  // namespace dumpstate
+}  // namespace os
+}  // namespace android
+
+#endif  // FRAMEWORK_NATIVE_CMD_STREAMINGCOMPRESSOR_H_
@@ -32,6 +32,7 @@
 #include <sys/poll.h>
 #include <sys/prctl.h>
 #include <sys/resource.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/wait.h>
@@ -88,6 +89,7 @@
 #include <private/android_logger.h>
 #include <serviceutils/PriorityDumper.h>
 #include <utils/StrongPointer.h>
+#include <zlib.h>
 #include "DumpstateInternal.h"
 #include "DumpstateService.h"
 #include "dumpstate.h"
@@ -115,6 +117,7 @@ using android::UNKNOWN_ERROR;
 using android::Vector;
 using android::base::StringPrintf;
 using android::os::IDumpstateListener;
+using android::os::dumpstate::CommandBroker;
 using android::os::dumpstate::CommandOptions;
 using android::os::dumpstate::DumpFileToFd;
 using android::os::dumpstate::DumpPool;
@@ -233,6 +236,8 @@ static const std::string DUMP_INCIDENT_REPORT_TASK = "INCIDENT REPORT";
 static const std::string DUMP_HALS_TASK = "DUMP HALS";
 static const std::string DUMP_BOARD_TASK = "dumpstate_board()";
 static const std::string DUMP_CHECKINS_TASK = "DUMP CHECKINS";
+static const std::string DUMP_VM_STATS_TASK = "DUMP VM STATS";
+static const std::string DUMP_BINDER_LOGS_TASK = "DUMP BINDER LOGS";
 
 namespace android {
 namespace os {
@@ -256,6 +261,25 @@ static int OpenForRead(std::string path) {
 }
 
 bool CopyFile(int in_fd, int out_fd) {
+    // Let the kernel copy regular files (e.g. the finished zip going to the
+    // caller's fd) directly; fall back to the buffered loop for sources or
+    // destinations sendfile can't handle.
+    struct stat st;
+    if (fstat(in_fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        posix_fadvise(in_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        off_t total = 0;
+        ssize_t sent;
+        while ((sent = TEMP_FAILURE_RETRY(sendfile(out_fd, in_fd, nullptr, 1 << 30))) > 0) {
+            total += sent;
+        }
+        if (sent == 0) {
+            return true;
+        }
+        if (total > 0 || (errno != EINVAL && errno != ENOSYS)) {
+            return false;
+        }
+        // Fall through to the buffered copy from the current offset.
+    }
     char buf[4096];
     ssize_t byte_count;
     while ((byte_count = TEMP_FAILURE_RETRY(read(in_fd, buf, sizeof(buf)))) > 0) {
@@ -349,8 +373,19 @@ static void RunDumpsys(const std::string& title, const std::vector<std::string>&
                        int out_fd) {
     return ds.RunDumpsys(title, dumpsysArgs, Dumpstate::DEFAULT_DUMPSYS, 0, out_fd);
 }
-static int DumpFile(const std::string& title, const std::string& path) {
-    return ds.DumpFile(title, path);
+static int DumpFile(const std::string& title, const std::string& path,
+                    int out_fd = STDOUT_FILENO) {
+    return ds.DumpFile(title, path, out_fd);
+}
+
+// Emits the per-section stats table collected during the run as a trailer
+// after the "dumpstate: done" marker, where telemetry parsers can find it.
+static void WriteSectionStatsTrailer() {
+    printf("========================================================\n");
+    printf("== Section stats\n");
+    printf("========================================================\n");
+    fflush(stdout);
+    ds.section_stats_.WriteTrailer(STDOUT_FILENO);
 }
 
 // Relative directory (inside the zip) for all files copied as-is into the bugreport.
@@ -897,6 +932,51 @@ status_t Dumpstate::AddZipEntryFromFd(const std::string& entry_name, int fd,
     return OK;
 }
 
+status_t Dumpstate::AddZipEntryFromGzip(const std::string& entry_name,
+                                        const std::string& gz_path) {
+    MYLOGD("Adding zip entry %s from gzip file %s\n", entry_name.c_str(), gz_path.c_str());
+    gzFile gz = gzopen(gz_path.c_str(), "rb");
+    if (gz == nullptr) {
+        MYLOGE("gzopen(%s): %s\n", gz_path.c_str(), strerror(errno));
+        return UNKNOWN_ERROR;
+    }
+    auto scope_guard = android::base::make_scope_guard([&gz] { gzclose(gz); });
+
+    int32_t err = zip_writer_->StartEntryWithTime(entry_name.c_str(), ZipWriter::kCompress, now_);
+    if (err != 0) {
+        MYLOGE("zip_writer_->StartEntryWithTime(%s): %s\n", entry_name.c_str(),
+               ZipWriter::ErrorCodeString(err));
+        return UNKNOWN_ERROR;
+    }
+
+    std::vector<uint8_t> buffer(65536);
+    while (1) {
+        int bytes_read = gzread(gz, buffer.data(), buffer.size());
+        if (bytes_read == 0) {
+            break;
+        } else if (bytes_read < 0) {
+            int zerr;
+            MYLOGE("gzread(%s): %s\n", gz_path.c_str(), gzerror(gz, &zerr));
+            zip_writer_->FinishEntry();
+            return UNKNOWN_ERROR;
+        }
+        err = zip_writer_->WriteBytes(buffer.data(), bytes_read);
+        if (err) {
+            MYLOGE("zip_writer_->WriteBytes(): %s\n", ZipWriter::ErrorCodeString(err));
+            zip_writer_->FinishEntry();
+            return UNKNOWN_ERROR;
+        }
+    }
+
+    err = zip_writer_->FinishEntry();
+    if (err != 0) {
+        MYLOGE("zip_writer_->FinishEntry(): %s\n", ZipWriter::ErrorCodeString(err));
+        return UNKNOWN_ERROR;
+    }
+
+    return OK;
+}
+
 bool Dumpstate::AddZipEntry(const std::string& entry_name, const std::string& entry_path) {
     android::base::unique_fd fd(
         TEMP_FAILURE_RETRY(open(entry_path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC)));
@@ -1394,14 +1474,14 @@ static void DumpHals(int out_fd = STDOUT_FILENO) {
     }
 }
 
-static void DumpExternalFragmentationInfo() {
+static void DumpExternalFragmentationInfo(int out_fd = STDOUT_FILENO) {
     struct stat st;
     if (stat("/proc/buddyinfo", &st) != 0) {
         MYLOGE("Unable to dump external fragmentation info\n");
         return;
     }
 
-    printf("------ EXTERNAL FRAGMENTATION INFO ------\n");
+    dprintf(out_fd, "------ EXTERNAL FRAGMENTATION INFO ------\n");
     std::ifstream ifs("/proc/buddyinfo");
     auto unusable_index_regex = std::regex{"Node\\s+([0-9]+),\\s+zone\\s+(\\S+)\\s+(.*)"};
     for (std::string line; std::getline(ifs, line);) {
@@ -1416,21 +1496,21 @@ static void DumpExternalFragmentationInfo() {
                 total_free_pages += (free_pages_per_order[i] * std::pow(2, i));
             }
 
-            printf("Node %s, zone %8s", match_results[1].str().c_str(),
-                   match_results[2].str().c_str());
+            dprintf(out_fd, "Node %s, zone %8s", match_results[1].str().c_str(),
+                    match_results[2].str().c_str());
 
             int usable_free_pages = total_free_pages;
             for (size_t i = 0; i < free_pages_per_order.size(); i++) {
                 auto unusable_index = (total_free_pages - usable_free_pages) /
                         static_cast<double>(total_free_pages);
-                printf(" %5.3f", unusable_index);
+                dprintf(out_fd, " %5.3f", unusable_index);
                 usable_free_pages -= (free_pages_per_order[i] * std::pow(2, i));
             }
 
-            printf("\n");
+            dprintf(out_fd, "\n");
         }
     }
-    printf("\n");
+    dprintf(out_fd, "\n");
 }
 
 static void DumpstateLimitedOnly() {
@@ -1473,6 +1553,8 @@ static void DumpstateLimitedOnly() {
     printf("========================================================\n");
     printf("== dumpstate: done (id %d)\n", ds.id_);
     printf("========================================================\n");
+
+    WriteSectionStatsTrailer();
 }
 
 /*
@@ -1493,6 +1575,44 @@ static void DumpCheckins(int out_fd = STDOUT_FILENO) {
     RunDumpsys("CHECKIN PACKAGE", {"package", "--checkin"}, out_fd);
 }
 
+/*
+ * Dumps the kernel virtual memory accounting files. These are independent of
+ * every other section, so they can run on a pool thread while the main thread
+ * works through the sequential sections.
+ *
+ * |out_fd| A fd to support the DumpPool to output results to a temporary file.
+ * Dumpstate can pick up later and output to the bugreport. Using STDOUT_FILENO
+ * if it's not running in the parallel task.
+ */
+static void DumpVmStats(int out_fd = STDOUT_FILENO) {
+    DumpFile("VIRTUAL MEMORY STATS", "/proc/vmstat", out_fd);
+    DumpFile("VMALLOC INFO", "/proc/vmallocinfo", out_fd);
+    DumpFile("SLAB INFO", "/proc/slabinfo", out_fd);
+    DumpFile("ZONEINFO", "/proc/zoneinfo", out_fd);
+    DumpFile("PAGETYPEINFO", "/proc/pagetypeinfo", out_fd);
+    DumpFile("BUDDYINFO", "/proc/buddyinfo", out_fd);
+    DumpExternalFragmentationInfo(out_fd);
+}
+
+/*
+ * Dumps the binder driver logs. Binder state is expensive to look at as it
+ * uses a lot of memory, so it is worth hiding behind the sequential sections.
+ *
+ * |out_fd| A fd to support the DumpPool to output results to a temporary file.
+ * Dumpstate can pick up later and output to the bugreport. Using STDOUT_FILENO
+ * if it's not running in the parallel task.
+ */
+static void DumpBinderLogs(int out_fd = STDOUT_FILENO) {
+    std::string binder_logs_dir = access("/dev/binderfs/binder_logs", R_OK) ?
+            "/sys/kernel/debug/binder" : "/dev/binderfs/binder_logs";
+
+    DumpFile("BINDER FAILED TRANSACTION LOG", binder_logs_dir + "/failed_transaction_log", out_fd);
+    DumpFile("BINDER TRANSACTION LOG", binder_logs_dir + "/transaction_log", out_fd);
+    DumpFile("BINDER TRANSACTIONS", binder_logs_dir + "/transactions", out_fd);
+    DumpFile("BINDER STATS", binder_logs_dir + "/stats", out_fd);
+    DumpFile("BINDER STATE", binder_logs_dir + "/state", out_fd);
+}
+
 /*
  * Runs dumpsys on activity service to dump all application activities, services
  * and providers in the device.
@@ -1550,11 +1670,14 @@ static Dumpstate::RunStatus dumpstate() {
     DurationReporter duration_reporter("DUMPSTATE");
 
     // Enqueue slow functions into the thread pool, if the parallel run is enabled.
-    std::future<std::string> dump_hals, dump_incident_report, dump_board, dump_checkins;
+    std::future<std::string> dump_hals, dump_incident_report, dump_board, dump_checkins,
+            dump_vm_stats, dump_binder_logs;
     if (ds.dump_pool_) {
         // Pool was shutdown in DumpstateDefaultAfterCritical method in order to
-        // drop root user. Restarts it with two threads for the parallel run.
-        ds.dump_pool_->start(/* thread_counts = */2);
+        // drop root user. Restarts it with three threads for the parallel run;
+        // the tasks are mostly blocked on dumpsys or file reads, so they leave
+        // the main thread room to work through the sequential sections.
+        ds.dump_pool_->start(/* thread_counts = */3);
 
         dump_hals = ds.dump_pool_->enqueueTaskWithFd(DUMP_HALS_TASK, &DumpHals, _1);
         dump_incident_report = ds.dump_pool_->enqueueTask(
@@ -1562,6 +1685,9 @@ static Dumpstate::RunStatus dumpstate() {
         dump_board = ds.dump_pool_->enqueueTaskWithFd(
             DUMP_BOARD_TASK, &Dumpstate::DumpstateBoard, &ds, _1);
         dump_checkins = ds.dump_pool_->enqueueTaskWithFd(DUMP_CHECKINS_TASK, &DumpCheckins, _1);
+        dump_vm_stats = ds.dump_pool_->enqueueTaskWithFd(DUMP_VM_STATS_TASK, &DumpVmStats, _1);
+        dump_binder_logs = ds.dump_pool_->enqueueTaskWithFd(
+            DUMP_BINDER_LOGS_TASK, &DumpBinderLogs, _1);
     }
 
     // Dump various things. Note that anything that takes "long" (i.e. several seconds) should
@@ -1578,13 +1704,11 @@ static Dumpstate::RunStatus dumpstate() {
 
     RUN_SLOW_FUNCTION_WITH_CONSENT_CHECK(DumpVisibleWindowViews);
 
-    DumpFile("VIRTUAL MEMORY STATS", "/proc/vmstat");
-    DumpFile("VMALLOC INFO", "/proc/vmallocinfo");
-    DumpFile("SLAB INFO", "/proc/slabinfo");
-    DumpFile("ZONEINFO", "/proc/zoneinfo");
-    DumpFile("PAGETYPEINFO", "/proc/pagetypeinfo");
-    DumpFile("BUDDYINFO", "/proc/buddyinfo");
-    DumpExternalFragmentationInfo();
+    if (ds.dump_pool_) {
+        WaitForTask(std::move(dump_vm_stats));
+    } else {
+        RUN_SLOW_FUNCTION_AND_LOG(DUMP_VM_STATS_TASK, DumpVmStats);
+    }
 
     DumpFile("KERNEL CPUFREQ", "/sys/devices/system/cpu/cpu0/cpufreq/stats/time_in_state");
 
@@ -1674,15 +1798,11 @@ static Dumpstate::RunStatus dumpstate() {
 
     RunCommand("FILESYSTEMS & FREE SPACE", {"df"});
 
-    /* Binder state is expensive to look at as it uses a lot of memory. */
-    std::string binder_logs_dir = access("/dev/binderfs/binder_logs", R_OK) ?
-            "/sys/kernel/debug/binder" : "/dev/binderfs/binder_logs";
-
-    DumpFile("BINDER FAILED TRANSACTION LOG", binder_logs_dir + "/failed_transaction_log");
-    DumpFile("BINDER TRANSACTION LOG", binder_logs_dir + "/transaction_log");
-    DumpFile("BINDER TRANSACTIONS", binder_logs_dir + "/transactions");
-    DumpFile("BINDER STATS", binder_logs_dir + "/stats");
-    DumpFile("BINDER STATE", binder_logs_dir + "/state");
+    if (ds.dump_pool_) {
+        WaitForTask(std::move(dump_binder_logs));
+    } else {
+        RUN_SLOW_FUNCTION_AND_LOG(DUMP_BINDER_LOGS_TASK, DumpBinderLogs);
+    }
 
     /* Add window and surface trace files. */
     if (!PropertiesHelper::IsUserBuild()) {
@@ -1742,6 +1862,8 @@ static Dumpstate::RunStatus dumpstate() {
     printf("== dumpstate: done (id %d)\n", ds.id_);
     printf("========================================================\n");
 
+    WriteSectionStatsTrailer();
+
     printf("========================================================\n");
     printf("== Obtaining statsd metadata\n");
     printf("========================================================\n");
@@ -1848,6 +1970,10 @@ Dumpstate::RunStatus Dumpstate::DumpstateDefaultAfterCritical() {
         return Dumpstate::RunStatus::ERROR;
     }
 
+    // Now that root is dropped and before the heap grows with the report,
+    // fork the command broker that spawns the deprivileged section helpers.
+    command_broker_ = CommandBroker::Create();
+
     RETURN_IF_USER_DENIED_CONSENT();
     Dumpstate::RunStatus status = dumpstate();
     // Capture logcat since the last time we did it.
@@ -2008,6 +2134,8 @@ static void DumpstateTelephonyOnly(const std::string& calling_package) {
     printf("== dumpstate: done (id %d)\n", ds.id_);
     printf("========================================================\n");
 
+    WriteSectionStatsTrailer();
+
     if (ds.dump_pool_) {
         WaitForTask(std::move(dump_board));
     } else {
@@ -2044,6 +2172,8 @@ static void DumpstateWifiOnly() {
     printf("========================================================\n");
     printf("== dumpstate: done (id %d)\n", ds.id_);
     printf("========================================================\n");
+
+    WriteSectionStatsTrailer();
 }
 
 Dumpstate::RunStatus Dumpstate::DumpTraces(const char** path) {
@@ -2500,7 +2630,19 @@ bool Dumpstate::FinishZipFile() {
     MYLOGD("dumpstate id %d finished around %s (%ld s)\n", ds.id_, date,
            the_real_now_please_stand_up - ds.now_);
 
-    if (!ds.AddZipEntry(entry_name, tmp_path_)) {
+    if (tmp_compressor_ != nullptr) {
+        // Stdout has been restored by now, so the pipe to the compressor
+        // thread has hit end-of-file and finish() only waits for the tail of
+        // the stream to be flushed.
+        if (!tmp_compressor_->finish()) {
+            MYLOGE("Streamed compression of the main entry failed\n");
+            return false;
+        }
+        if (AddZipEntryFromGzip(entry_name, tmp_compressor_->path()) != OK) {
+            MYLOGE("Failed to add text entry to .zip file\n");
+            return false;
+        }
+    } else if (!ds.AddZipEntry(entry_name, tmp_path_)) {
         MYLOGE("Failed to add text entry to .zip file\n");
         return false;
     }
@@ -2531,8 +2673,14 @@ bool Dumpstate::FinishZipFile() {
     // TODO: remove once FinishZipFile() is automatically handled by Dumpstate's destructor.
     ds.zip_file.reset(nullptr);
 
-    MYLOGD("Removing temporary file %s\n", tmp_path_.c_str())
-    android::os::UnlinkAndLogOnError(tmp_path_);
+    if (tmp_compressor_ != nullptr) {
+        MYLOGD("Removing temporary file %s\n", tmp_compressor_->path().c_str())
+        android::os::UnlinkAndLogOnError(tmp_compressor_->path());
+        tmp_compressor_ = nullptr;
+    } else {
+        MYLOGD("Removing temporary file %s\n", tmp_path_.c_str())
+        android::os::UnlinkAndLogOnError(tmp_path_);
+    }
 
     return true;
 }
@@ -3005,18 +3153,33 @@ Dumpstate::RunStatus Dumpstate::RunInternal(int32_t calling_uid,
     }
 
     // Redirect stdout to tmp_path_. This is the main bugreport entry and will be
-    // moved into zip file later, if zipping.
+    // moved into zip file later, if zipping. With the streamed compression,
+    // stdout goes through a pipe to a compressor thread instead, so only a
+    // gzip copy of the entry is kept on disk while sections are produced.
     TEMP_FAILURE_RETRY(dup_stdout_fd = dup(fileno(stdout)));
-    // TODO: why not write to a file instead of stdout to overcome this problem?
-    /* TODO: rather than generating a text file now and zipping it later,
-        it would be more efficient to redirect stdout to the zip entry
-        directly, but the libziparchive doesn't support that option yet. */
-    if (!redirect_to_file(stdout, const_cast<char*>(tmp_path_.c_str()))) {
-        return ERROR;
+    if (zip_file != nullptr && PropertiesHelper::IsStreamedCompression()) {
+        tmp_compressor_ =
+                std::make_unique<android::os::dumpstate::StreamingCompressor>(tmp_path_ + ".gz");
+        if (!tmp_compressor_->start() ||
+            TEMP_FAILURE_RETRY(dup2(tmp_compressor_->writeFd(), fileno(stdout))) == -1) {
+            MYLOGE("Unable to set up the streamed compression; using a plain temporary file\n");
+            tmp_compressor_ = nullptr;
+        } else {
+            tmp_compressor_->closeWriteFd();
+            if (chown(tmp_compressor_->path().c_str(), AID_SHELL, AID_SHELL)) {
+                MYLOGE("Unable to change ownership of compressed bugreport file %s: %s\n",
+                        tmp_compressor_->path().c_str(), strerror(errno));
+            }
+        }
     }
-    if (chown(tmp_path_.c_str(), AID_SHELL, AID_SHELL)) {
-        MYLOGE("Unable to change ownership of temporary bugreport file %s: %s\n",
-                tmp_path_.c_str(), strerror(errno));
+    if (tmp_compressor_ == nullptr) {
+        if (!redirect_to_file(stdout, const_cast<char*>(tmp_path_.c_str()))) {
+            return ERROR;
+        }
+        if (chown(tmp_path_.c_str(), AID_SHELL, AID_SHELL)) {
+            MYLOGE("Unable to change ownership of temporary bugreport file %s: %s\n",
+                    tmp_path_.c_str(), strerror(errno));
+        }
     }
 
     // Don't buffer stdout
@@ -3215,7 +3378,15 @@ bool Dumpstate::CalledByApi() const {
 }
 
 void Dumpstate::CleanupTmpFiles() {
-    android::os::UnlinkAndLogOnError(tmp_path_);
+    if (tmp_compressor_ != nullptr) {
+        // Stdout may still be redirected to the pipe here, so don't wait for
+        // end-of-file; just unblock the thread and drop the partial copy.
+        tmp_compressor_->abandon();
+        android::os::UnlinkAndLogOnError(tmp_compressor_->path());
+        tmp_compressor_ = nullptr;
+    } else {
+        android::os::UnlinkAndLogOnError(tmp_path_);
+    }
     android::os::UnlinkAndLogOnError(screenshot_path_);
     android::os::UnlinkAndLogOnError(path_);
     if (dump_traces_path != nullptr) {
@@ -3404,6 +3575,61 @@ DurationReporter::~DurationReporter() {
     }
 }
 
+static int64_t ThreadCpuNanos() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return ts.tv_sec * NANOS_PER_SEC + ts.tv_nsec;
+}
+
+static int64_t ChildrenCpuNanos() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_CHILDREN, &usage) != 0) {
+        return 0;
+    }
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * NANOS_PER_SEC +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000LL;
+}
+
+SectionStats::Measurement::Measurement(int fd)
+    : fd_(fd),
+      start_offset_(lseek(fd, 0, SEEK_CUR)),
+      start_wall_ns_(Nanotime()),
+      start_cpu_ns_(ThreadCpuNanos()),
+      start_children_cpu_ns_(ChildrenCpuNanos()) {
+}
+
+void SectionStats::Measurement::Finish(const std::string& title, int status,
+                                       SectionStats* stats) const {
+    if (title.empty()) {
+        return;
+    }
+    Record record;
+    record.title = title;
+    record.wall_ns = Nanotime() - start_wall_ns_;
+    record.cpu_ns = (ThreadCpuNanos() - start_cpu_ns_) +
+                    (ChildrenCpuNanos() - start_children_cpu_ns_);
+    off_t end_offset = lseek(fd_, 0, SEEK_CUR);
+    record.bytes = (start_offset_ >= 0 && end_offset >= 0) ? end_offset - start_offset_ : -1;
+    record.status = status;
+    stats->Add(std::move(record));
+}
+
+void SectionStats::Add(Record record) {
+    std::lock_guard<std::mutex> lock(lock_);
+    records_.push_back(std::move(record));
+}
+
+void SectionStats::WriteTrailer(int fd) const {
+    std::lock_guard<std::mutex> lock(lock_);
+    dprintf(fd, "section\twall_ms\tcpu_ms\tbytes\tstatus\n");
+    for (const auto& record : records_) {
+        dprintf(fd, "%s\t%.3f\t%.3f\t%" PRId64 "\t%d\n", record.title.c_str(),
+                record.wall_ns / 1e6, record.cpu_ns / 1e6, record.bytes, record.status);
+    }
+}
+
 const int32_t Progress::kDefaultMax = 5000;
 
 Progress::Progress(const std::string& path) : Progress(Progress::kDefaultMax, 1.1, path) {
@@ -3861,11 +4087,13 @@ void do_showmap(int pid, const char *name) {
     RunCommand(title, {"showmap", "-q", arg}, CommandOptions::AS_ROOT);
 }
 
-int Dumpstate::DumpFile(const std::string& title, const std::string& path) {
+int Dumpstate::DumpFile(const std::string& title, const std::string& path, int out_fd) {
     DurationReporter duration_reporter(title);
+    SectionStats::Measurement measurement(out_fd);
 
-    int status = DumpFileToFd(STDOUT_FILENO, title, path);
+    int status = DumpFileToFd(out_fd, title, path);
 
+    measurement.Finish(title, status, &section_stats_);
     UpdateProgress(WEIGHT_FILE);
 
     return status;
@@ -3980,12 +4208,57 @@ int dump_file_from_fd(const char *title, const char *path, int fd) {
     return DumpFileFromFdToFd(title, path, fd, STDOUT_FILENO, PropertiesHelper::IsDryRun());
 }
 
+/*
+ * Mirrors the header/error reporting of RunCommandToFd for commands executed
+ * through the broker, so the report output is the same either way.
+ */
+static int RunCommandViaBroker(CommandBroker* broker, int fd, const std::string& title,
+                               const std::vector<std::string>& full_command,
+                               const CommandOptions& options) {
+    std::string command_string = android::base::Join(full_command, ' ');
+    const char* command = command_string.c_str();
+
+    if (!title.empty()) {
+        dprintf(fd, "------ %s (%s) ------\n", title.c_str(), command);
+    }
+    const std::string& logging_message = options.LoggingMessage();
+    if (!logging_message.empty()) {
+        MYLOGI(logging_message.c_str(), command_string.c_str());
+    }
+
+    int status = broker->Execute(full_command, fd, options.TimeoutInMs());
+    if (status < 0) {
+        dprintf(fd, "*** command '%s' failed through the command broker\n", command);
+        MYLOGE("*** command '%s' failed through the command broker\n", command);
+    } else if (status > 0) {
+        dprintf(fd, "*** command '%s' failed: exit code %d\n", command, status);
+        MYLOGE("*** command '%s' failed: exit code %d\n", command, status);
+    }
+    return status;
+}
+
 int Dumpstate::RunCommand(const std::string& title, const std::vector<std::string>& full_command,
                           const CommandOptions& options, bool verbose_duration, int out_fd) {
     DurationReporter duration_reporter(title, false /* logcat_only */,
                                        verbose_duration, out_fd);
+    SectionStats::Measurement measurement(out_fd);
+
+    // Only the common deprivileged stdout-to-fd case goes through the
+    // broker; root commands and special output modes keep the fork/exec
+    // path, which handles their setup in the child.
+    const bool broker_eligible =
+            command_broker_ != nullptr && !full_command.empty() &&
+            options.PrivilegeMode() != SU_ROOT && options.OutputMode() == NORMAL_OUTPUT &&
+            !options.ShouldCloseAllFileDescriptorsOnExec() && !PropertiesHelper::IsDryRun();
+
+    int status;
+    if (broker_eligible) {
+        status = RunCommandViaBroker(command_broker_.get(), out_fd, title, full_command, options);
+    } else {
+        status = RunCommandToFd(out_fd, title, full_command, options);
+    }
 
-    int status = RunCommandToFd(out_fd, title, full_command, options);
+    measurement.Finish(title, status, &section_stats_);
 
     /* TODO: for now we're simplifying the progress calculation by using the
      * timeout as the weight. It's a good approximation for most cases, except when calling dumpsys,
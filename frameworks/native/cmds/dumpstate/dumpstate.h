@@ -22,6 +22,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -35,8 +36,10 @@
 #include <utils/StrongPointer.h>
 #include <ziparchive/zip_writer.h>
 
+#include "CommandBroker.h"
 #include "DumpstateUtil.h"
 #include "DumpPool.h"
+#include "StreamingCompressor.h"
 #include "TaskQueue.h"
 
 // TODO: move everything under this namespace
@@ -88,6 +91,56 @@ class DurationReporter {
     DISALLOW_COPY_AND_ASSIGN(DurationReporter);
 };
 
+/*
+ * Collects one record per executed section (RunCommand/DumpFile) so the run
+ * can emit a machine-readable summary at the end of the report. Unlike the
+ * free-form DurationReporter lines, the trailer is a flat tab-separated
+ * table meant for fleet telemetry to track which sections regress.
+ */
+class SectionStats {
+  public:
+    struct Record {
+        std::string title;
+        int64_t wall_ns;
+        int64_t cpu_ns;
+        // Bytes the section wrote to its output fd, or -1 when the fd is not
+        // seekable (e.g. a socket) and the size cannot be derived.
+        int64_t bytes;
+        int status;
+    };
+
+    /*
+     * Captures the start-of-section counters; Finish() turns the deltas into
+     * a record. |fd| is the section's output, used to derive bytes produced
+     * from the file offset. CPU time covers the calling thread plus children
+     * reaped while the section ran; with the parallel dump pool enabled the
+     * children part is best-effort since sections reap concurrently.
+     */
+    class Measurement {
+      public:
+        explicit Measurement(int fd);
+
+        void Finish(const std::string& title, int status, SectionStats* stats) const;
+
+      private:
+        int fd_;
+        off_t start_offset_;
+        int64_t start_wall_ns_;
+        int64_t start_cpu_ns_;
+        int64_t start_children_cpu_ns_;
+    };
+
+    void Add(Record record);
+
+    // Writes the records as a trailer section: a header line followed by one
+    // tab-separated line per section.
+    void WriteTrailer(int fd) const;
+
+  private:
+    mutable std::mutex lock_;
+    std::vector<Record> records_;
+};
+
 /*
  * Keeps track of current progress and estimated max, saving stats on file to tune up future runs.
  *
@@ -251,8 +304,10 @@ class Dumpstate {
      * |title| description of the command printed on `stdout` (or empty to skip
      * description).
      * |path| location of the file to be dumped.
+     * |out_fd| A fd to support the DumpPool to output results to a temporary
+     * file. Using STDOUT_FILENO if it's not running in the parallel task.
      */
-    int DumpFile(const std::string& title, const std::string& path);
+    int DumpFile(const std::string& title, const std::string& path, int out_fd = STDOUT_FILENO);
 
     /*
      * Adds a new entry to the existing zip file.
@@ -270,6 +325,17 @@ class Dumpstate {
     android::status_t AddZipEntryFromFd(const std::string& entry_name, int fd,
                                         std::chrono::milliseconds timeout);
 
+    /*
+     * Adds a new entry to the existing zip file, decompressing its contents
+     * from a gzip file as produced by the streamed compression of the main
+     * bugreport entry.
+     *
+     * |entry_name| destination path of the new entry.
+     * |gz_path| location of the gzip file to read from.
+     */
+    android::status_t AddZipEntryFromGzip(const std::string& entry_name,
+                                          const std::string& gz_path);
+
     /*
      * Adds a text entry to the existing zip file.
      */
@@ -506,6 +572,21 @@ class Dumpstate {
     // parallel run is enabled.
     std::unique_ptr<android::os::dumpstate::TaskQueue> zip_entry_tasks_;
 
+    // Compresses the main bugreport entry while sections are produced, so
+    // only a gzip copy of it is kept on disk. Null when the streamed
+    // compression is disabled or could not be set up.
+    std::unique_ptr<android::os::dumpstate::StreamingCompressor> tmp_compressor_;
+
+    // Per-section timing and size records, emitted as a machine-readable
+    // trailer at the end of the report.
+    SectionStats section_stats_;
+
+    // Executes deprivileged section commands from a small helper process
+    // forked right after dumpstate drops root. Null until that point, or
+    // when the broker could not be started; commands then use the regular
+    // fork/exec path.
+    std::unique_ptr<android::os::dumpstate::CommandBroker> command_broker_;
+
     // A callback to IncidentCompanion service, which checks user consent for sharing the
     // bugreport with the calling app. If the user has not responded yet to the dialog it will
     // be neither confirmed nor denied.
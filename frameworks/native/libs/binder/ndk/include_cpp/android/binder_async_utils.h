@@ -0,0 +1,364 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @addtogroup NdkBinder
+ * @{
+ */
+
+/**
+ * @file binder_async_utils.h
+ * @brief Asynchronous transactions and transaction batching on top of AIBinder_transact.
+ */
+
+#pragma once
+
+#include <android/binder_auto_utils.h>
+#include <android/binder_ibinder.h>
+#include <android/binder_parcel.h>
+#include <android/binder_status.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ndk {
+
+/**
+ * Runs transactions on a dedicated thread pool and delivers the result to a
+ * completion callback instead of blocking the caller.
+ *
+ * AIBinder_transact blocks the calling thread for the round trip, so a service
+ * making chains of calls that are not safe to mark oneway ends up parking a
+ * worker per outstanding call. This pool moves the blocking to threads that
+ * exist for exactly that purpose: the caller hands over the filled-in parcel
+ * and continues, and the callback runs on a pool thread once the reply lands.
+ *
+ * Calls are dispatched in FIFO order, but with more than one thread replies
+ * may complete out of order; construct the pool with one thread when calls to
+ * the same object must retire in submission order.
+ */
+class AsyncTransactionPool {
+   public:
+    /**
+     * Called on a pool thread when the transaction completes. The status and
+     * reply parcel are exactly what AIBinder_transact returned; the reply is
+     * empty for oneway calls.
+     */
+    using Callback = std::function<void(binder_status_t status, ScopedAParcel out)>;
+
+    /**
+     * Creates the pool and starts its threads.
+     *
+     * \param numThreads number of transaction threads; also the maximum number
+     * of calls in flight at once.
+     */
+    explicit AsyncTransactionPool(size_t numThreads = 1) {
+        if (numThreads == 0) numThreads = 1;
+        for (size_t i = 0; i < numThreads; i++) {
+            mThreads.emplace_back([this] { run(); });
+        }
+    }
+
+    /**
+     * Drains queued calls (each still gets its callback) and joins the
+     * threads.
+     */
+    ~AsyncTransactionPool() {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mWork.notify_all();
+        for (std::thread& thread : mThreads) {
+            thread.join();
+        }
+    }
+
+    AsyncTransactionPool(const AsyncTransactionPool&) = delete;
+    AsyncTransactionPool& operator=(const AsyncTransactionPool&) = delete;
+
+    /**
+     * Queues a transaction. Takes ownership of the in parcel, which must have
+     * been created by AIBinder_prepareTransaction on the same binder. The
+     * callback is invoked exactly once, on a pool thread, including when the
+     * transaction itself fails.
+     *
+     * \param binder the object to transact on; retained until the call completes.
+     * \param code the transaction code, as for AIBinder_transact.
+     * \param in the filled-in input parcel.
+     * \param flags flags as for AIBinder_transact.
+     * \param callback completion callback.
+     *
+     * \return STATUS_OK if the call was queued, STATUS_DEAD_OBJECT if the pool
+     * is shutting down (the callback is not invoked then).
+     */
+    binder_status_t transactAsync(const SpAIBinder& binder, transaction_code_t code,
+                                  ScopedAParcel in, binder_flags_t flags, Callback callback) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (mStopping) {
+                return STATUS_DEAD_OBJECT;
+            }
+            mQueue.push_back(Call{binder, code, std::move(in), flags, std::move(callback)});
+        }
+        mWork.notify_one();
+        return STATUS_OK;
+    }
+
+    /**
+     * Blocks until every call queued before this point has completed and its
+     * callback has returned.
+     */
+    void flush() {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mIdle.wait(lock, [this] { return mQueue.empty() && mActive == 0; });
+    }
+
+   private:
+    struct Call {
+        SpAIBinder binder;
+        transaction_code_t code;
+        ScopedAParcel in;
+        binder_flags_t flags;
+        Callback callback;
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true) {
+            mWork.wait(lock, [this] { return mStopping || !mQueue.empty(); });
+            if (mQueue.empty()) {
+                break;  // stopping and drained
+            }
+            Call call = std::move(mQueue.front());
+            mQueue.pop_front();
+            mActive++;
+            lock.unlock();
+
+            AParcel* in = call.in.release();  // AIBinder_transact consumes it
+            AParcel* out = nullptr;
+            binder_status_t status =
+                    AIBinder_transact(call.binder.get(), call.code, &in, &out, call.flags);
+            call.callback(status, ScopedAParcel(out));
+
+            lock.lock();
+            mActive--;
+            if (mQueue.empty() && mActive == 0) {
+                mIdle.notify_all();
+            }
+        }
+    }
+
+    std::mutex mMutex;
+    std::condition_variable mWork;
+    std::condition_variable mIdle;
+    std::deque<Call> mQueue;
+    size_t mActive = 0;
+    bool mStopping = false;
+    std::vector<std::thread> mThreads;
+};
+
+/**
+ * Packs many small transactions to one object into a single kernel round trip.
+ *
+ * At tens of thousands of small control-plane calls per second, the per-call
+ * driver overhead (ioctl, wakeup, thread handoff) dominates the payload cost.
+ * A batcher accumulates marshalled calls and ships them as one oneway
+ * transaction on a code the service reserves for batches; the service unpacks
+ * with TransactionBatcher::forEachEntry and dispatches each entry as if it had
+ * arrived alone.
+ *
+ * Because entries travel marshalled inside the batch parcel, they must not
+ * contain binders or file descriptors (the AParcel_marshal restriction).
+ * Batched calls are inherently oneway: entries produce no reply. Entries to
+ * the same object retire in the order they were added.
+ */
+class TransactionBatcher {
+   public:
+    /**
+     * \param binder the object batches are sent to; retained by the batcher.
+     * \param batchCode transaction code the service dispatches batches on.
+     * \param maxBytes payload threshold above which add() flushes before
+     * appending; keeps a batch within one driver buffer.
+     */
+    TransactionBatcher(SpAIBinder binder, transaction_code_t batchCode, size_t maxBytes = 4096)
+        : mBinder(std::move(binder)), mBatchCode(batchCode), mMaxBytes(maxBytes) {}
+
+    /** Flushing on destruction would swallow errors; flush explicitly. */
+    ~TransactionBatcher() {}
+
+    TransactionBatcher(const TransactionBatcher&) = delete;
+    TransactionBatcher& operator=(const TransactionBatcher&) = delete;
+
+    /**
+     * Appends one call to the current batch, flushing first if the batch is
+     * full. Takes ownership of the in parcel, which must have been created by
+     * AIBinder_prepareTransaction on the batcher's binder and must not contain
+     * binders or file descriptors.
+     *
+     * \param code the entry's transaction code, delivered to the service's
+     * unpack visitor.
+     * \param in the filled-in input parcel.
+     *
+     * \return STATUS_OK, or the first error from marshalling or from a flush
+     * this call triggered.
+     */
+    binder_status_t add(transaction_code_t code, ScopedAParcel in) {
+        const int32_t size = AParcel_getDataSize(in.get());
+        if (size < 0) {
+            return STATUS_BAD_VALUE;
+        }
+        Entry entry;
+        entry.code = code;
+        entry.data.resize(static_cast<size_t>(size));
+        binder_status_t status = AParcel_marshal(in.get(), entry.data.data(), 0, entry.data.size());
+        if (status != STATUS_OK) {
+            return status;
+        }
+        if (!mEntries.empty() && mPendingBytes + entry.data.size() > mMaxBytes) {
+            status = flush();
+            if (status != STATUS_OK) {
+                return status;
+            }
+        }
+        mPendingBytes += entry.data.size();
+        mEntries.push_back(std::move(entry));
+        return STATUS_OK;
+    }
+
+    /**
+     * Sends every pending entry as one oneway transaction on the batch code.
+     * A no-op when the batch is empty. On error the pending entries are
+     * dropped (they were oneway; there is no reply path to retry through).
+     *
+     * \return the result of the batch transaction.
+     */
+    binder_status_t flush() {
+        if (mEntries.empty()) {
+            return STATUS_OK;
+        }
+        std::vector<Entry> entries = std::move(mEntries);
+        mEntries.clear();
+        mPendingBytes = 0;
+
+        AParcel* in = nullptr;
+        binder_status_t status = AIBinder_prepareTransaction(mBinder.get(), &in);
+        if (status != STATUS_OK) {
+            return status;
+        }
+        status = AParcel_writeInt32(in, static_cast<int32_t>(entries.size()));
+        for (const Entry& entry : entries) {
+            if (status != STATUS_OK) break;
+            status = AParcel_writeUint32(in, entry.code);
+            if (status != STATUS_OK) break;
+            status = AParcel_writeByteArray(in, reinterpret_cast<const int8_t*>(entry.data.data()),
+                                            static_cast<int32_t>(entry.data.size()));
+        }
+        if (status != STATUS_OK) {
+            AParcel_delete(in);
+            return status;
+        }
+        AParcel* out = nullptr;
+        status = AIBinder_transact(mBinder.get(), mBatchCode, &in, &out, FLAG_ONEWAY);
+        AParcel_delete(out);
+        return status;
+    }
+
+    /** Bytes of entry payload accumulated and not yet flushed. */
+    size_t pendingBytes() const { return mPendingBytes; }
+
+    /**
+     * Service-side unpacker. Call from onTransact when code is the batch
+     * code, passing the received parcel; the visitor runs once per entry, in
+     * order, with the entry's code and a parcel positioned at the start of
+     * the entry's data. Stops at the first visitor error.
+     *
+     * \param batch the batch transaction's input parcel.
+     * \param visitor per-entry dispatch function.
+     *
+     * \return STATUS_OK, a parcel read error, or the first error returned by
+     * the visitor.
+     */
+    static binder_status_t forEachEntry(
+            const AParcel* batch,
+            const std::function<binder_status_t(transaction_code_t code, const AParcel* entry)>&
+                    visitor) {
+        int32_t count = 0;
+        binder_status_t status = AParcel_readInt32(batch, &count);
+        if (status != STATUS_OK) {
+            return status;
+        }
+        if (count < 0) {
+            return STATUS_BAD_VALUE;
+        }
+        for (int32_t i = 0; i < count; i++) {
+            uint32_t code = 0;
+            status = AParcel_readUint32(batch, &code);
+            if (status != STATUS_OK) {
+                return status;
+            }
+            std::vector<uint8_t> data;
+            status = AParcel_readByteArray(batch, &data, readByteVector);
+            if (status != STATUS_OK) {
+                return status;
+            }
+            ScopedAParcel entry(AParcel_create());
+            if (entry.get() == nullptr) {
+                return STATUS_NO_MEMORY;
+            }
+            status = AParcel_unmarshal(entry.get(), data.data(), data.size());
+            if (status != STATUS_OK) {
+                return status;
+            }
+            status = visitor(code, entry.get());
+            if (status != STATUS_OK) {
+                return status;
+            }
+        }
+        return STATUS_OK;
+    }
+
+   private:
+    struct Entry {
+        transaction_code_t code;
+        std::vector<uint8_t> data;
+    };
+
+    static bool readByteVector(void* vectorData, int32_t length, int8_t** outBuffer) {
+        if (length < 0) {
+            return false;
+        }
+        auto* vec = static_cast<std::vector<uint8_t>*>(vectorData);
+        vec->resize(static_cast<size_t>(length));
+        *outBuffer = reinterpret_cast<int8_t*>(vec->data());
+        return true;
+    }
+
+    SpAIBinder mBinder;
+    const transaction_code_t mBatchCode;
+    const size_t mMaxBytes;
+    std::vector<Entry> mEntries;
+    size_t mPendingBytes = 0;
+};
+
+}  // namespace ndk
+
+/** @} */
@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @addtogroup NdkBinder
+ * @{
+ */
+
+/**
+ * @file binder_blob_utils.h
+ * @brief Arena-backed parcel payload staging and explicit shared-memory blobs.
+ *
+ * Requires libcutils (ashmem) in addition to libbinder_ndk.
+ */
+
+#pragma once
+
+#include <android/binder_parcel.h>
+#include <android/binder_status.h>
+#include <cutils/ashmem.h>
+
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ndk {
+
+/**
+ * Bump allocator for parcel payload staging.
+ *
+ * Decoding a byte array with AParcel_readByteArray heap-allocates per array;
+ * at high call rates over image metadata that malloc churn is measurable. An
+ * arena hands out pointers from large reused chunks: allocation is a pointer
+ * bump, and reset() reclaims everything at once between messages while
+ * keeping the chunks, so the steady state performs no heap operations at all.
+ *
+ * Not thread-safe; use one arena per decoding thread. Allocations are valid
+ * until the next reset() or destruction.
+ */
+class ParcelArena {
+   public:
+    /**
+     * \param chunkBytes granularity of the backing chunks; allocations larger
+     * than this get a dedicated chunk.
+     */
+    explicit ParcelArena(size_t chunkBytes = 64 * 1024) : mChunkBytes(chunkBytes) {}
+
+    ParcelArena(const ParcelArena&) = delete;
+    ParcelArena& operator=(const ParcelArena&) = delete;
+
+    /**
+     * Returns |size| bytes aligned for any object type, or nullptr if the
+     * backing allocation fails. Never fails once the chunks are warm.
+     */
+    void* alloc(size_t size) {
+        const size_t aligned = (size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+        while (mCurrent < mChunks.size()) {
+            Chunk& chunk = mChunks[mCurrent];
+            if (chunk.size - mOffset >= aligned) {
+                void* out = chunk.data.get() + mOffset;
+                mOffset += aligned;
+                return out;
+            }
+            mCurrent++;
+            mOffset = 0;
+        }
+        const size_t chunkSize = aligned > mChunkBytes ? aligned : mChunkBytes;
+        Chunk chunk;
+        chunk.data.reset(new (std::nothrow) uint8_t[chunkSize]);
+        if (chunk.data == nullptr) {
+            return nullptr;
+        }
+        chunk.size = chunkSize;
+        mChunks.push_back(std::move(chunk));
+        mOffset = aligned;
+        return mChunks.back().data.get();
+    }
+
+    /** Reclaims every allocation at once; the chunks are kept for reuse. */
+    void reset() {
+        mCurrent = 0;
+        mOffset = 0;
+    }
+
+    /**
+     * Adapter making the arena usable as an AParcel_byteArrayAllocator.
+     * Pass a Slice as the arrayData argument of AParcel_readByteArray:
+     *
+     *   ParcelArena::Slice slice{&arena};
+     *   AParcel_readByteArray(parcel, &slice, ParcelArena::byteArrayAllocator);
+     *
+     * On success the slice points at arena-owned bytes.
+     */
+    struct Slice {
+        ParcelArena* arena = nullptr;
+        int8_t* data = nullptr;
+        int32_t size = 0;
+    };
+
+    static bool byteArrayAllocator(void* sliceData, int32_t length, int8_t** outBuffer) {
+        Slice* slice = static_cast<Slice*>(sliceData);
+        if (length < 0) {
+            // null array; nothing to allocate
+            slice->data = nullptr;
+            slice->size = 0;
+            *outBuffer = nullptr;
+            return true;
+        }
+        slice->data = static_cast<int8_t*>(slice->arena->alloc(static_cast<size_t>(length)));
+        if (slice->data == nullptr && length > 0) {
+            return false;
+        }
+        slice->size = length;
+        *outBuffer = slice->data;
+        return true;
+    }
+
+   private:
+    struct Chunk {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size = 0;
+    };
+
+    const size_t mChunkBytes;
+    std::vector<Chunk> mChunks;
+    size_t mCurrent = 0;
+    size_t mOffset = 0;
+};
+
+/**
+ * Payload bytes read back by AParcel_readBlob. Holds either an ashmem
+ * mapping (unmapped on destruction), arena-owned bytes, or an internal
+ * buffer, so callers read the data the same way regardless of how the
+ * writer shipped it.
+ */
+class MappedBlob {
+   public:
+    MappedBlob() = default;
+    ~MappedBlob() { clear(); }
+
+    MappedBlob(MappedBlob&& other) { *this = std::move(other); }
+    MappedBlob& operator=(MappedBlob&& other) {
+        if (this != &other) {
+            clear();
+            mData = other.mData;
+            mSize = other.mSize;
+            mMapBase = other.mMapBase;
+            mMapSize = other.mMapSize;
+            mHeap = std::move(other.mHeap);
+            other.mData = nullptr;
+            other.mSize = 0;
+            other.mMapBase = nullptr;
+            other.mMapSize = 0;
+        }
+        return *this;
+    }
+
+    MappedBlob(const MappedBlob&) = delete;
+    MappedBlob& operator=(const MappedBlob&) = delete;
+
+    const void* data() const { return mData; }
+    size_t size() const { return mSize; }
+
+   private:
+    friend binder_status_t AParcel_readBlob(const AParcel* parcel, MappedBlob* out,
+                                            ParcelArena* arena);
+
+    void clear() {
+        if (mMapBase != nullptr) {
+            munmap(mMapBase, mMapSize);
+            mMapBase = nullptr;
+        }
+        mData = nullptr;
+        mSize = 0;
+        mHeap.clear();
+    }
+
+    const void* mData = nullptr;
+    size_t mSize = 0;
+    void* mMapBase = nullptr;
+    size_t mMapSize = 0;
+    std::vector<uint8_t> mHeap;
+};
+
+/**
+ * In-place/ashmem switchover point. Matches the order of magnitude where the
+ * cost of creating and mapping a region undercuts copying the bytes through
+ * the binder buffer twice.
+ */
+constexpr size_t kBlobInplaceLimit = 16 * 1024;
+
+/**
+ * Writes |size| bytes to the parcel as a blob. Payloads up to |threshold|
+ * travel in-place in the parcel; larger ones are copied once into an
+ * immutable ashmem region whose descriptor is written instead, so the bytes
+ * cross the process boundary zero-copy instead of through the binder buffer
+ * on both sides. Falls back to in-place if the region cannot be created.
+ * Read with AParcel_readBlob.
+ *
+ * \param parcel parcel to write to; must allow file descriptors for the
+ * ashmem path to be usable.
+ * \param data payload; not retained after this returns.
+ * \param size payload length in bytes.
+ * \param threshold largest payload still sent in-place.
+ *
+ * \return STATUS_OK or the first parcel/mapping error.
+ */
+inline binder_status_t AParcel_writeBlob(AParcel* parcel, const void* data, size_t size,
+                                         size_t threshold = kBlobInplaceLimit) {
+    if (size > INT32_MAX) {
+        return STATUS_BAD_VALUE;
+    }
+    if (size > threshold) {
+        int fd = ashmem_create_region("AParcel_writeBlob", size);
+        if (fd >= 0) {
+            void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (map != MAP_FAILED) {
+                memcpy(map, data, size);
+                munmap(map, size);
+                ashmem_set_prot_region(fd, PROT_READ);
+                binder_status_t status = AParcel_writeInt32(parcel, 1 /* ashmem */);
+                if (status == STATUS_OK) {
+                    status = AParcel_writeUint32(parcel, static_cast<uint32_t>(size));
+                }
+                if (status == STATUS_OK) {
+                    status = AParcel_writeParcelFileDescriptor(parcel, fd);
+                }
+                close(fd);
+                return status;
+            }
+            close(fd);
+        }
+        // fall through: ship in-place rather than failing the write
+    }
+    binder_status_t status = AParcel_writeInt32(parcel, 0 /* in-place */);
+    if (status != STATUS_OK) {
+        return status;
+    }
+    return AParcel_writeByteArray(parcel, reinterpret_cast<const int8_t*>(data),
+                                  static_cast<int32_t>(size));
+}
+
+/**
+ * Reads a blob written by AParcel_writeBlob. Ashmem blobs are mapped
+ * read-only and unmapped when |out| is destroyed; in-place blobs land in
+ * |arena| when one is given (their lifetime then follows the arena, not the
+ * MappedBlob), or in a buffer owned by |out| otherwise.
+ *
+ * \return STATUS_OK or the first parcel/mapping error.
+ */
+inline binder_status_t AParcel_readBlob(const AParcel* parcel, MappedBlob* out,
+                                        ParcelArena* arena = nullptr) {
+    out->clear();
+    int32_t kind = 0;
+    binder_status_t status = AParcel_readInt32(parcel, &kind);
+    if (status != STATUS_OK) {
+        return status;
+    }
+    if (kind == 1) {
+        uint32_t size = 0;
+        status = AParcel_readUint32(parcel, &size);
+        if (status != STATUS_OK) {
+            return status;
+        }
+        int fd = -1;
+        status = AParcel_readParcelFileDescriptor(parcel, &fd);
+        if (status != STATUS_OK) {
+            return status;
+        }
+        if (fd < 0) {
+            return STATUS_BAD_VALUE;
+        }
+        void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            return STATUS_NO_MEMORY;
+        }
+        out->mMapBase = map;
+        out->mMapSize = size;
+        out->mData = map;
+        out->mSize = size;
+        return STATUS_OK;
+    }
+    if (kind != 0) {
+        return STATUS_BAD_VALUE;
+    }
+    if (arena != nullptr) {
+        ParcelArena::Slice slice{arena};
+        status = AParcel_readByteArray(parcel, &slice, ParcelArena::byteArrayAllocator);
+        if (status != STATUS_OK) {
+            return status;
+        }
+        out->mData = slice.data;
+        out->mSize = static_cast<size_t>(slice.size);
+        return STATUS_OK;
+    }
+    status = AParcel_readByteArray(parcel, &out->mHeap, [](void* vectorData, int32_t length,
+                                                           int8_t** outBuffer) {
+        if (length < 0) {
+            return false;
+        }
+        auto* vec = static_cast<std::vector<uint8_t>*>(vectorData);
+        vec->resize(static_cast<size_t>(length));
+        *outBuffer = reinterpret_cast<int8_t*>(vec->data());
+        return true;
+    });
+    if (status != STATUS_OK) {
+        return status;
+    }
+    out->mData = out->mHeap.data();
+    out->mSize = out->mHeap.size();
+    return STATUS_OK;
+}
+
+}  // namespace ndk
+
+/** @} */
@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @addtogroup NdkBinder
+ * @{
+ */
+
+/**
+ * @file binder_view_utils.h
+ * @brief Non-owning view reads and writes for AParcel payloads.
+ *
+ * The std::vector helpers in binder_parcel_utils.h allocate and copy on
+ * every array read, and writers must own a vector even when the payload
+ * already lives somewhere else. The helpers here trade that for views:
+ * writers accept a pointer/length pair wrapped in ASpan, and readers
+ * decode into a ParcelArena (see binder_blob_utils.h) and hand back a view
+ * of the arena bytes. The NDK ABI exposes no pointer into the transaction
+ * buffer itself, so a view read still performs the one unavoidable copy out
+ * of the parcel -- but no per-array heap allocation and no second copy when
+ * the view is passed on instead of a vector.
+ *
+ * Views are valid until the arena is reset or destroyed. A service that
+ * resets its arena after each transaction gets transaction-scoped views.
+ */
+
+#pragma once
+
+#include <android/binder_parcel.h>
+#include <android/binder_status.h>
+#include <android/binder_blob_utils.h>
+
+#include <limits>
+#include <string_view>
+
+namespace ndk {
+
+/**
+ * Minimal non-owning constant view of a contiguous array. Stands in for
+ * std::span, which is unavailable at the C++ standard these headers target.
+ */
+template <typename T>
+class ASpan {
+   public:
+    constexpr ASpan() = default;
+    constexpr ASpan(const T* data, size_t size) : mData(data), mSize(size) {}
+
+    constexpr const T* data() const { return mData; }
+    constexpr size_t size() const { return mSize; }
+    constexpr bool empty() const { return mSize == 0; }
+
+    constexpr const T* begin() const { return mData; }
+    constexpr const T* end() const { return mData + mSize; }
+
+    constexpr const T& operator[](size_t pos) const { return mData[pos]; }
+
+   private:
+    const T* mData = nullptr;
+    size_t mSize = 0;
+};
+
+namespace internal {
+
+/**
+ * Arena-backed allocator state for one array read. The allocator shape
+ * matches every AParcel_*ArrayAllocator typedef, so one template serves all
+ * element types. Null arrays (length -1) fail the read: a borrowed view has
+ * no null representation.
+ */
+template <typename T>
+struct ArenaViewSlice {
+    ParcelArena* arena = nullptr;
+    T* data = nullptr;
+    int32_t size = 0;
+
+    static bool allocator(void* sliceData, int32_t length, T** outBuffer) {
+        ArenaViewSlice* slice = static_cast<ArenaViewSlice*>(sliceData);
+        if (length < 0) {
+            return false;
+        }
+        slice->data =
+                static_cast<T*>(slice->arena->alloc(static_cast<size_t>(length) * sizeof(T)));
+        if (slice->data == nullptr && length > 0) {
+            return false;
+        }
+        slice->size = length;
+        *outBuffer = slice->data;
+        return true;
+    }
+};
+
+template <typename T, typename ReadFn>
+inline binder_status_t readArenaView(const AParcel* parcel, ParcelArena* arena, ReadFn readFn,
+                                     ASpan<T>* out) {
+    ArenaViewSlice<T> slice{arena};
+    binder_status_t status = readFn(parcel, &slice, ArenaViewSlice<T>::allocator);
+    if (status != STATUS_OK) {
+        return status;
+    }
+    *out = ASpan<T>(slice.data, static_cast<size_t>(slice.size));
+    return STATUS_OK;
+}
+
+inline int32_t viewLength(size_t size) {
+    return size > static_cast<size_t>(std::numeric_limits<int32_t>::max())
+                   ? -1
+                   : static_cast<int32_t>(size);
+}
+
+}  // namespace internal
+
+/**
+ * Reads an array into |arena| and returns a view of it in |out|. The view
+ * stays valid until the arena is reset or destroyed.
+ *
+ * \return STATUS_OK on success; null arrays fail with the status the
+ * underlying read reports for a refused allocation.
+ */
+inline binder_status_t AParcel_readView(const AParcel* parcel, ParcelArena* arena,
+                                        ASpan<int8_t>* out) {
+    return internal::readArenaView(parcel, arena, AParcel_readByteArray, out);
+}
+
+inline binder_status_t AParcel_readView(const AParcel* parcel, ParcelArena* arena,
+                                        ASpan<uint8_t>* out) {
+    ASpan<int8_t> bytes;
+    binder_status_t status = internal::readArenaView(parcel, arena, AParcel_readByteArray, &bytes);
+    if (status != STATUS_OK) {
+        return status;
+    }
+    *out = ASpan<uint8_t>(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+    return STATUS_OK;
+}
+
+inline binder_status_t AParcel_readView(const AParcel* parcel, ParcelArena* arena,
+                                        ASpan<int32_t>* out) {
+    return internal::readArenaView(parcel, arena, AParcel_readInt32Array, out);
+}
+
+inline binder_status_t AParcel_readView(const AParcel* parcel, ParcelArena* arena,
+                                        ASpan<uint32_t>* out) {
+    return internal::readArenaView(parcel, arena, AParcel_readUint32Array, out);
+}
+
+inline binder_status_t AParcel_readView(const AParcel* parcel, ParcelArena* arena,
+                                        ASpan<int64_t>* out) {
+    return internal::readArenaView(parcel, arena, AParcel_readInt64Array, out);
+}
+
+inline binder_status_t AParcel_readView(const AParcel* parcel, ParcelArena* arena,
+                                        ASpan<uint64_t>* out) {
+    return internal::readArenaView(parcel, arena, AParcel_readUint64Array, out);
+}
+
+inline binder_status_t AParcel_readView(const AParcel* parcel, ParcelArena* arena,
+                                        ASpan<float>* out) {
+    return internal::readArenaView(parcel, arena, AParcel_readFloatArray, out);
+}
+
+inline binder_status_t AParcel_readView(const AParcel* parcel, ParcelArena* arena,
+                                        ASpan<double>* out) {
+    return internal::readArenaView(parcel, arena, AParcel_readDoubleArray, out);
+}
+
+/**
+ * Reads a UTF-8 string into |arena| and returns a view of it in |out|. The
+ * arena bytes keep the terminating NUL, so out->data() is also usable as a
+ * C string of out->size() characters. Null strings fail the read.
+ */
+inline binder_status_t AParcel_readView(const AParcel* parcel, ParcelArena* arena,
+                                        std::string_view* out) {
+    internal::ArenaViewSlice<char> slice{arena};
+    binder_status_t status =
+            AParcel_readString(parcel, &slice, internal::ArenaViewSlice<char>::allocator);
+    if (status != STATUS_OK) {
+        return status;
+    }
+    // The allocated length includes the terminating NUL.
+    *out = std::string_view(slice.data, slice.size > 0 ? static_cast<size_t>(slice.size) - 1 : 0);
+    return STATUS_OK;
+}
+
+/**
+ * Writes the contents of a non-owning view as a regular array, wire
+ * compatible with the std::vector writers and readers.
+ *
+ * \return STATUS_OK on success; STATUS_BAD_VALUE if the view is too large
+ * for a parcel array.
+ */
+inline binder_status_t AParcel_writeView(AParcel* parcel, ASpan<int8_t> view) {
+    int32_t length = internal::viewLength(view.size());
+    if (length < 0) {
+        return STATUS_BAD_VALUE;
+    }
+    return AParcel_writeByteArray(parcel, view.data(), length);
+}
+
+inline binder_status_t AParcel_writeView(AParcel* parcel, ASpan<uint8_t> view) {
+    return AParcel_writeView(
+            parcel, ASpan<int8_t>(reinterpret_cast<const int8_t*>(view.data()), view.size()));
+}
+
+inline binder_status_t AParcel_writeView(AParcel* parcel, ASpan<int32_t> view) {
+    int32_t length = internal::viewLength(view.size());
+    if (length < 0) {
+        return STATUS_BAD_VALUE;
+    }
+    return AParcel_writeInt32Array(parcel, view.data(), length);
+}
+
+inline binder_status_t AParcel_writeView(AParcel* parcel, ASpan<uint32_t> view) {
+    int32_t length = internal::viewLength(view.size());
+    if (length < 0) {
+        return STATUS_BAD_VALUE;
+    }
+    return AParcel_writeUint32Array(parcel, view.data(), length);
+}
+
+inline binder_status_t AParcel_writeView(AParcel* parcel, ASpan<int64_t> view) {
+    int32_t length = internal::viewLength(view.size());
+    if (length < 0) {
+        return STATUS_BAD_VALUE;
+    }
+    return AParcel_writeInt64Array(parcel, view.data(), length);
+}
+
+inline binder_status_t AParcel_writeView(AParcel* parcel, ASpan<uint64_t> view) {
+    int32_t length = internal::viewLength(view.size());
+    if (length < 0) {
+        return STATUS_BAD_VALUE;
+    }
+    return AParcel_writeUint64Array(parcel, view.data(), length);
+}
+
+inline binder_status_t AParcel_writeView(AParcel* parcel, ASpan<float> view) {
+    int32_t length = internal::viewLength(view.size());
+    if (length < 0) {
+        return STATUS_BAD_VALUE;
+    }
+    return AParcel_writeFloatArray(parcel, view.data(), length);
+}
+
+inline binder_status_t AParcel_writeView(AParcel* parcel, ASpan<double> view) {
+    int32_t length = internal::viewLength(view.size());
+    if (length < 0) {
+        return STATUS_BAD_VALUE;
+    }
+    return AParcel_writeDoubleArray(parcel, view.data(), length);
+}
+
+/**
+ * Writes a UTF-8 string view, wire compatible with the std::string writers
+ * and readers.
+ */
+inline binder_status_t AParcel_writeView(AParcel* parcel, std::string_view str) {
+    int32_t length = internal::viewLength(str.size());
+    if (length < 0) {
+        return STATUS_BAD_VALUE;
+    }
+    return AParcel_writeString(parcel, str.empty() ? "" : str.data(), length);
+}
+
+}  // namespace ndk
+
+/** @} */
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @addtogroup ANativeWindow
+ * @{
+ */
+
+/**
+ * @file native_window_cache.h
+ * @brief Client-side buffer attribute cache for ANativeWindow producers.
+ */
+
+#ifndef ANDROID_NATIVE_WINDOW_CACHE_H
+#define ANDROID_NATIVE_WINDOW_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/cdefs.h>
+
+#include <android/native_window.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Caches the buffer attributes last applied to an ANativeWindow so that
+ * re-applying an unchanged attribute costs nothing.
+ *
+ * Each attribute setter on ANativeWindow is a perform() call into the buffer
+ * queue, which for a remote queue is a binder transaction. Producers that
+ * conservatively re-assert dataspace, transform and geometry on every frame
+ * therefore pay several round trips per frame for values that almost never
+ * change. With a cache, per-frame setters only record the desired value;
+ * ANativeWindowCache_flush() (or the lock wrapper) forwards just the
+ * attributes that differ from what the window last accepted, typically none.
+ *
+ * The cache assumes it is the only writer of these attributes on the window.
+ * After anything else may have touched the window - reconnecting, handing the
+ * surface to another component and back - call ANativeWindowCache_invalidate()
+ * to bump the generation; every attribute is then re-applied on the next
+ * flush. Not thread-safe; use from the producer thread.
+ */
+typedef struct ANativeWindowCache {
+    ANativeWindow* window;
+    /** Bumped by invalidate; attributes applied under an older generation
+     * are stale. */
+    uint32_t generation;
+
+    int32_t dataSpace;
+    int32_t appliedDataSpace;
+    uint32_t dataSpaceGeneration; /* generation when applied; 0 = never */
+    bool dataSpaceSet;
+
+    int32_t transform;
+    int32_t appliedTransform;
+    uint32_t transformGeneration;
+    bool transformSet;
+
+    int32_t width;
+    int32_t height;
+    int32_t format;
+    int32_t appliedWidth;
+    int32_t appliedHeight;
+    int32_t appliedFormat;
+    uint32_t geometryGeneration;
+    bool geometrySet;
+
+    float frameRate;
+    int8_t frameRateCompatibility;
+    float appliedFrameRate;
+    int8_t appliedFrameRateCompatibility;
+    uint32_t frameRateGeneration;
+    bool frameRateSet;
+
+    /** Setter calls elided because the value was already applied. */
+    uint64_t skippedPerformCalls;
+} ANativeWindowCache;
+
+/**
+ * Initializes the cache for |window|. Does not affect the window's reference
+ * count; the caller keeps the window alive for the cache's lifetime. The
+ * first flush after init applies every recorded attribute.
+ */
+static inline void ANativeWindowCache_init(ANativeWindowCache* cache, ANativeWindow* window) {
+    memset(cache, 0, sizeof(*cache));
+    cache->window = window;
+    cache->generation = 1;
+}
+
+/**
+ * Marks every cached attribute stale. Call after the window may have been
+ * modified behind the cache's back; the next flush re-applies all recorded
+ * attributes.
+ */
+static inline void ANativeWindowCache_invalidate(ANativeWindowCache* cache) {
+    cache->generation++;
+}
+
+/**
+ * Records the dataspace to apply to buffers queued after the next flush.
+ * See ANativeWindow_setBuffersDataSpace.
+ */
+static inline void ANativeWindowCache_setBuffersDataSpace(ANativeWindowCache* cache,
+                                                          int32_t dataSpace) {
+    cache->dataSpace = dataSpace;
+    cache->dataSpaceSet = true;
+}
+
+/** Records the transform to apply. See ANativeWindow_setBuffersTransform. */
+static inline void ANativeWindowCache_setBuffersTransform(ANativeWindowCache* cache,
+                                                          int32_t transform) {
+    cache->transform = transform;
+    cache->transformSet = true;
+}
+
+/** Records the buffer geometry to apply. See ANativeWindow_setBuffersGeometry. */
+static inline void ANativeWindowCache_setBuffersGeometry(ANativeWindowCache* cache, int32_t width,
+                                                         int32_t height, int32_t format) {
+    cache->width = width;
+    cache->height = height;
+    cache->format = format;
+    cache->geometrySet = true;
+}
+
+/** Records the frame rate to apply. See ANativeWindow_setFrameRate. */
+static inline void ANativeWindowCache_setFrameRate(ANativeWindowCache* cache, float frameRate,
+                                                   int8_t compatibility) {
+    cache->frameRate = frameRate;
+    cache->frameRateCompatibility = compatibility;
+    cache->frameRateSet = true;
+}
+
+/**
+ * Applies every recorded attribute whose value changed since the window last
+ * accepted it (or that is stale after an invalidate), in one place, so a
+ * frame that changes nothing performs no window calls at all.
+ *
+ * \return 0 for success, or the first setter's negative error. On error the
+ * failed attribute stays stale and is retried on the next flush.
+ */
+static inline int32_t ANativeWindowCache_flush(ANativeWindowCache* cache) {
+    int32_t status;
+
+    if (cache->dataSpaceSet) {
+        if (cache->dataSpaceGeneration != cache->generation ||
+            cache->appliedDataSpace != cache->dataSpace) {
+            status = ANativeWindow_setBuffersDataSpace(cache->window, cache->dataSpace);
+            if (status != 0) return status;
+            cache->appliedDataSpace = cache->dataSpace;
+            cache->dataSpaceGeneration = cache->generation;
+        } else {
+            cache->skippedPerformCalls++;
+        }
+    }
+
+    if (cache->transformSet) {
+        if (cache->transformGeneration != cache->generation ||
+            cache->appliedTransform != cache->transform) {
+            status = ANativeWindow_setBuffersTransform(cache->window, cache->transform);
+            if (status != 0) return status;
+            cache->appliedTransform = cache->transform;
+            cache->transformGeneration = cache->generation;
+        } else {
+            cache->skippedPerformCalls++;
+        }
+    }
+
+    if (cache->geometrySet) {
+        if (cache->geometryGeneration != cache->generation ||
+            cache->appliedWidth != cache->width || cache->appliedHeight != cache->height ||
+            cache->appliedFormat != cache->format) {
+            status = ANativeWindow_setBuffersGeometry(cache->window, cache->width, cache->height,
+                                                      cache->format);
+            if (status != 0) return status;
+            cache->appliedWidth = cache->width;
+            cache->appliedHeight = cache->height;
+            cache->appliedFormat = cache->format;
+            cache->geometryGeneration = cache->generation;
+        } else {
+            cache->skippedPerformCalls++;
+        }
+    }
+
+    if (cache->frameRateSet) {
+        if (cache->frameRateGeneration != cache->generation ||
+            cache->appliedFrameRate != cache->frameRate ||
+            cache->appliedFrameRateCompatibility != cache->frameRateCompatibility) {
+            status = ANativeWindow_setFrameRate(cache->window, cache->frameRate,
+                                                cache->frameRateCompatibility);
+            if (status != 0) return status;
+            cache->appliedFrameRate = cache->frameRate;
+            cache->appliedFrameRateCompatibility = cache->frameRateCompatibility;
+            cache->frameRateGeneration = cache->generation;
+        } else {
+            cache->skippedPerformCalls++;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Flushes pending attribute changes, then locks the window's next drawing
+ * surface. Equivalent to ANativeWindowCache_flush() followed by
+ * ANativeWindow_lock(); the per-frame entry point for producers driving the
+ * window through the cache.
+ *
+ * \return 0 for success, or a negative value on error.
+ */
+static inline int32_t ANativeWindowCache_lock(ANativeWindowCache* cache,
+                                              ANativeWindow_Buffer* outBuffer,
+                                              ARect* inOutDirtyBounds) {
+    int32_t status = ANativeWindowCache_flush(cache);
+    if (status != 0) return status;
+    return ANativeWindow_lock(cache->window, outBuffer, inOutDirtyBounds);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ANDROID_NATIVE_WINDOW_CACHE_H
+
+/** @} */
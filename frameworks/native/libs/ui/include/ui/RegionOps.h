@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_UI_REGION_OPS_H
+#define ANDROID_UI_REGION_OPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ui/Rect.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace android {
+namespace regionops {
+
+/*
+ * Batch kernels for per-frame region math.
+ *
+ * A Rect is four contiguous int32s (it is an ARect), so one rect is exactly
+ * one 128-bit lane: the whole-region operations that composition performs
+ * every frame - translating a visible region, clipping it to a display, and
+ * recomputing bounds - vectorize one rect per instruction on SSE2 and NEON,
+ * with a scalar fallback keeping the semantics identical elsewhere.
+ *
+ * The span kernels below operate on the sorted, non-overlapping span lists
+ * that make up one horizontal band of a region; they are the inner loops of
+ * region boolean operations.
+ */
+
+/** Translates |count| rects in place. */
+inline void translateRects(Rect* rects, size_t count, int32_t dx, int32_t dy) {
+    int32_t* p = &rects[0].left;
+#if defined(__SSE2__)
+    const __m128i delta = _mm_set_epi32(dy, dx, dy, dx);
+    for (size_t i = 0; i < count; i++, p += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+                         _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)),
+                                       delta));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const int32_t d[4] = {dx, dy, dx, dy};
+    const int32x4_t delta = vld1q_s32(d);
+    for (size_t i = 0; i < count; i++, p += 4) {
+        vst1q_s32(p, vaddq_s32(vld1q_s32(p), delta));
+    }
+#else
+    for (size_t i = 0; i < count; i++, p += 4) {
+        p[0] += dx;
+        p[1] += dy;
+        p[2] += dx;
+        p[3] += dy;
+    }
+#endif
+}
+
+#if defined(__SSE2__)
+// SSE2 lacks 32-bit packed min/max; synthesize from the signed compare.
+inline __m128i maxS32(__m128i a, __m128i b) {
+    const __m128i mask = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+inline __m128i minS32(__m128i a, __m128i b) {
+    const __m128i mask = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a));
+}
+#endif
+
+/**
+ * Intersects |count| rects with |clip|, writing the non-empty results to
+ * |out| (capacity |count|; may alias |in|). Returns the number written.
+ */
+inline size_t clipRects(const Rect* in, size_t count, const Rect& clip, Rect* out) {
+    size_t produced = 0;
+#if defined(__SSE2__)
+    // Lanes are (left, top, right, bottom): clamp the low two up to the
+    // clip's left/top and the high two down to its right/bottom.
+    const __m128i lo = _mm_set_epi32(INT32_MIN, INT32_MIN, clip.top, clip.left);
+    const __m128i hi = _mm_set_epi32(clip.bottom, clip.right, INT32_MAX, INT32_MAX);
+    for (size_t i = 0; i < count; i++) {
+        const __m128i v =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i].left));
+        const __m128i r = minS32(maxS32(v, lo), hi);
+        Rect result;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&result.left), r);
+        if (result.left < result.right && result.top < result.bottom) {
+            out[produced++] = result;
+        }
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const int32_t loLanes[4] = {clip.left, clip.top, INT32_MIN, INT32_MIN};
+    const int32_t hiLanes[4] = {INT32_MAX, INT32_MAX, clip.right, clip.bottom};
+    const int32x4_t lo = vld1q_s32(loLanes);
+    const int32x4_t hi = vld1q_s32(hiLanes);
+    for (size_t i = 0; i < count; i++) {
+        const int32x4_t v = vld1q_s32(&in[i].left);
+        const int32x4_t r = vminq_s32(vmaxq_s32(v, lo), hi);
+        Rect result;
+        vst1q_s32(&result.left, r);
+        if (result.left < result.right && result.top < result.bottom) {
+            out[produced++] = result;
+        }
+    }
+#else
+    for (size_t i = 0; i < count; i++) {
+        Rect result(in[i]);
+        if (result.left < clip.left) result.left = clip.left;
+        if (result.top < clip.top) result.top = clip.top;
+        if (result.right > clip.right) result.right = clip.right;
+        if (result.bottom > clip.bottom) result.bottom = clip.bottom;
+        if (result.left < result.right && result.top < result.bottom) {
+            out[produced++] = result;
+        }
+    }
+#endif
+    return produced;
+}
+
+/** Bounds of |count| rects; Rect::EMPTY_RECT when count is zero. */
+inline Rect boundsOf(const Rect* rects, size_t count) {
+    if (count == 0) {
+        return Rect::EMPTY_RECT;
+    }
+#if defined(__SSE2__)
+    __m128i minAcc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&rects[0].left));
+    __m128i maxAcc = minAcc;
+    for (size_t i = 1; i < count; i++) {
+        const __m128i v =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(&rects[i].left));
+        minAcc = minS32(minAcc, v);
+        maxAcc = maxS32(maxAcc, v);
+    }
+    Rect lows, highs;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&lows.left), minAcc);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&highs.left), maxAcc);
+    return Rect(lows.left, lows.top, highs.right, highs.bottom);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    int32x4_t minAcc = vld1q_s32(&rects[0].left);
+    int32x4_t maxAcc = minAcc;
+    for (size_t i = 1; i < count; i++) {
+        const int32x4_t v = vld1q_s32(&rects[i].left);
+        minAcc = vminq_s32(minAcc, v);
+        maxAcc = vmaxq_s32(maxAcc, v);
+    }
+    Rect lows, highs;
+    vst1q_s32(&lows.left, minAcc);
+    vst1q_s32(&highs.left, maxAcc);
+    return Rect(lows.left, lows.top, highs.right, highs.bottom);
+#else
+    Rect bounds(rects[0]);
+    for (size_t i = 1; i < count; i++) {
+        if (rects[i].left < bounds.left) bounds.left = rects[i].left;
+        if (rects[i].top < bounds.top) bounds.top = rects[i].top;
+        if (rects[i].right > bounds.right) bounds.right = rects[i].right;
+        if (rects[i].bottom > bounds.bottom) bounds.bottom = rects[i].bottom;
+    }
+    return bounds;
+#endif
+}
+
+/**
+ * One horizontal span of a region band: the half-open x interval
+ * [left, right). Span lists are sorted by left and non-overlapping.
+ */
+struct Span {
+    int32_t left;
+    int32_t right;
+};
+
+/**
+ * Union of two span lists into |out| (capacity na + nb), coalescing
+ * touching spans. Returns the number of spans written. Branch-light
+ * two-pointer merge; this is the inner loop of Region::orSelf per band.
+ */
+inline size_t unionSpans(const Span* a, size_t na, const Span* b, size_t nb, Span* out) {
+    size_t ia = 0, ib = 0, produced = 0;
+    while (ia < na || ib < nb) {
+        // Take the next span by left edge from whichever list is lower.
+        const bool takeA = ib >= nb || (ia < na && a[ia].left <= b[ib].left);
+        const Span next = takeA ? a[ia++] : b[ib++];
+        if (produced > 0 && next.left <= out[produced - 1].right) {
+            // Touches or overlaps the current run: extend it.
+            if (next.right > out[produced - 1].right) {
+                out[produced - 1].right = next.right;
+            }
+        } else {
+            out[produced++] = next;
+        }
+    }
+    return produced;
+}
+
+/**
+ * Intersection of two span lists into |out| (capacity na + nb). Returns the
+ * number of spans written.
+ */
+inline size_t intersectSpans(const Span* a, size_t na, const Span* b, size_t nb, Span* out) {
+    size_t ia = 0, ib = 0, produced = 0;
+    while (ia < na && ib < nb) {
+        const int32_t left = a[ia].left > b[ib].left ? a[ia].left : b[ib].left;
+        const int32_t right = a[ia].right < b[ib].right ? a[ia].right : b[ib].right;
+        if (left < right) {
+            out[produced++] = Span{left, right};
+        }
+        // Advance whichever span ends first.
+        if (a[ia].right < b[ib].right) {
+            ia++;
+        } else {
+            ib++;
+        }
+    }
+    return produced;
+}
+
+/**
+ * Spans of |a| with the spans of |b| removed, into |out| (capacity
+ * na + nb). Returns the number of spans written.
+ */
+inline size_t subtractSpans(const Span* a, size_t na, const Span* b, size_t nb, Span* out) {
+    size_t ib = 0, produced = 0;
+    for (size_t ia = 0; ia < na; ia++) {
+        int32_t left = a[ia].left;
+        const int32_t right = a[ia].right;
+        while (ib < nb && b[ib].right <= left) {
+            ib++;
+        }
+        size_t scan = ib;
+        while (scan < nb && b[scan].left < right) {
+            if (b[scan].left > left) {
+                out[produced++] = Span{left, b[scan].left};
+            }
+            if (b[scan].right > left) {
+                left = b[scan].right;
+            }
+            scan++;
+        }
+        if (left < right) {
+            out[produced++] = Span{left, right};
+        }
+    }
+    return produced;
+}
+
+} // namespace regionops
+} // namespace android
+
+#endif // ANDROID_UI_REGION_OPS_H
@@ -0,0 +1,107 @@
+#define LOG_TAG "PreviewBufferPool"
+
+#include "PreviewBufferPool.h"
+
+#include "mosaic/Log.h"
+
+#include <string.h>
+
+PreviewBufferPool::PreviewBufferPool() {
+    memset(mBuffers, 0, sizeof(mBuffers));
+    mCount = 0;
+    mFreeHead.store(0, std::memory_order_relaxed);
+}
+
+PreviewBufferPool::~PreviewBufferPool() {
+    Release();
+}
+
+bool PreviewBufferPool::Init(uint32_t width, uint32_t height, uint32_t format,
+        uint32_t count) {
+    if (count == 0 || count > kMaxBuffers) {
+        LOGE("Init: bad buffer count %u", count);
+        return false;
+    }
+    Release();
+
+    AHardwareBuffer_Desc desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.width = width;
+    desc.height = height;
+    desc.layers = 1;
+    desc.format = format;
+    desc.usage = AHARDWAREBUFFER_USAGE_CPU_WRITE_OFTEN |
+            AHARDWAREBUFFER_USAGE_GPU_SAMPLED_IMAGE;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (AHardwareBuffer_allocate(&desc, &mBuffers[i]) != 0) {
+            LOGE("Init: allocation %u of %u failed (%ux%u format 0x%x)",
+                    i, count, width, height, format);
+            mCount = i;
+            Release();
+            return false;
+        }
+    }
+    mCount = count;
+
+    // Chain all buffers onto the free list; no concurrency yet.
+    for (uint32_t i = 0; i < count; i++) {
+        mNext[i].store(i + 1 < count ? i + 2 : 0, std::memory_order_relaxed);
+    }
+    mFreeHead.store(1, std::memory_order_release);  // index 0, tag 0
+    return true;
+}
+
+void PreviewBufferPool::Release() {
+    for (uint32_t i = 0; i < mCount; i++) {
+        if (mBuffers[i] != NULL) {
+            AHardwareBuffer_release(mBuffers[i]);
+            mBuffers[i] = NULL;
+        }
+    }
+    mCount = 0;
+    mFreeHead.store(0, std::memory_order_relaxed);
+}
+
+AHardwareBuffer* PreviewBufferPool::Acquire() {
+    uint64_t head = mFreeHead.load(std::memory_order_acquire);
+    for (;;) {
+        const uint32_t indexPlus1 = (uint32_t)head;
+        if (indexPlus1 == 0) {
+            return NULL;  // all buffers in flight
+        }
+        const uint32_t index = indexPlus1 - 1;
+        const uint32_t next = mNext[index].load(std::memory_order_relaxed);
+        const uint64_t newHead = (((head >> 32) + 1) << 32) | next;
+        if (mFreeHead.compare_exchange_weak(head, newHead,
+                std::memory_order_acquire, std::memory_order_acquire)) {
+            return mBuffers[index];
+        }
+    }
+}
+
+void PreviewBufferPool::Return(AHardwareBuffer* buffer) {
+    const int index = IndexOf(buffer);
+    if (index < 0) {
+        LOGE("Return: buffer %p is not from this pool", buffer);
+        return;
+    }
+    uint64_t head = mFreeHead.load(std::memory_order_relaxed);
+    for (;;) {
+        mNext[index].store((uint32_t)head, std::memory_order_relaxed);
+        const uint64_t newHead = (((head >> 32) + 1) << 32) | (uint32_t)(index + 1);
+        if (mFreeHead.compare_exchange_weak(head, newHead,
+                std::memory_order_release, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+int PreviewBufferPool::IndexOf(const AHardwareBuffer* buffer) const {
+    for (uint32_t i = 0; i < mCount; i++) {
+        if (mBuffers[i] == buffer) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <android/hardware_buffer.h>
+
+#include <atomic>
+#include <stdint.h>
+
+// A fixed pool of preallocated gralloc preview buffers.
+//
+// All buffers are allocated once in Init(); the per-frame path only moves
+// buffer ownership between the camera thread and the render thread.
+// Acquire() runs on the camera thread. Return() is a lock-free push onto
+// the free list and is safe from any thread, so JNI release callbacks and
+// the GL thread can hand buffers back without taking a lock that the
+// camera thread could block on.
+class PreviewBufferPool {
+  public:
+    PreviewBufferPool();
+    ~PreviewBufferPool();
+
+    // Allocates count buffers of the given geometry, usable both for CPU
+    // writes from the camera HAL and for GPU sampling (see
+    // PreviewGlBinding). format is an AHARDWAREBUFFER_FORMAT_* value.
+    // @return true if all buffers were allocated.
+    bool Init(uint32_t width, uint32_t height, uint32_t format, uint32_t count);
+
+    // Releases all buffers. The caller must ensure none are in flight.
+    void Release();
+
+    // Takes a free buffer, or returns NULL if all buffers are in flight
+    // (the camera frame should then be dropped, not copied).
+    AHardwareBuffer* Acquire();
+
+    // Returns a buffer obtained from Acquire() to the pool. Lock-free,
+    // callable from any thread.
+    void Return(AHardwareBuffer* buffer);
+
+    uint32_t GetBufferCount() const { return mCount; }
+
+  private:
+    static const uint32_t kMaxBuffers = 16;
+
+    int IndexOf(const AHardwareBuffer* buffer) const;
+
+    AHardwareBuffer* mBuffers[kMaxBuffers];
+    uint32_t mCount;
+
+    // Treiber stack of free buffer indices. The head packs a 32-bit push
+    // counter above (index + 1) so that a concurrent pop/push pair cannot
+    // be mistaken for an unchanged head (ABA); 0 means empty.
+    std::atomic<uint64_t> mFreeHead;
+    std::atomic<uint32_t> mNext[kMaxBuffers];  // index + 1 of the next free buffer
+};
@@ -0,0 +1,107 @@
+#define LOG_TAG "PreviewGlBinding"
+
+#include "PreviewGlBinding.h"
+
+#include "mosaic/Log.h"
+
+#include <string.h>
+
+PreviewGlBinding::PreviewGlBinding() {
+    memset(mBindings, 0, sizeof(mBindings));
+    mBindingCount = 0;
+    mEglGetNativeClientBufferANDROID = NULL;
+    mEglCreateImageKHR = NULL;
+    mEglDestroyImageKHR = NULL;
+    mGlEGLImageTargetTexture2DOES = NULL;
+}
+
+PreviewGlBinding::~PreviewGlBinding() {
+    Release();
+}
+
+bool PreviewGlBinding::InitializeGLContext() {
+    mEglGetNativeClientBufferANDROID = (PFNEGLGETNATIVECLIENTBUFFERANDROIDPROC)
+            eglGetProcAddress("eglGetNativeClientBufferANDROID");
+    mEglCreateImageKHR = (PFNEGLCREATEIMAGEKHRPROC)
+            eglGetProcAddress("eglCreateImageKHR");
+    mEglDestroyImageKHR = (PFNEGLDESTROYIMAGEKHRPROC)
+            eglGetProcAddress("eglDestroyImageKHR");
+    mGlEGLImageTargetTexture2DOES = (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)
+            eglGetProcAddress("glEGLImageTargetTexture2DOES");
+
+    if (mEglGetNativeClientBufferANDROID == NULL || mEglCreateImageKHR == NULL ||
+            mEglDestroyImageKHR == NULL || mGlEGLImageTargetTexture2DOES == NULL) {
+        LOGE("InitializeGLContext: EGLImage extensions unavailable, "
+                "preview will use the copy upload path");
+        return false;
+    }
+    return true;
+}
+
+GLuint PreviewGlBinding::GetTextureForBuffer(AHardwareBuffer* buffer) {
+    if (buffer == NULL || mGlEGLImageTargetTexture2DOES == NULL) {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < mBindingCount; i++) {
+        if (mBindings[i].buffer == buffer) {
+            return mBindings[i].texture;
+        }
+    }
+
+    if (mBindingCount == kMaxBindings) {
+        LOGE("GetTextureForBuffer: binding cache full");
+        return 0;
+    }
+
+    EGLClientBuffer clientBuffer = mEglGetNativeClientBufferANDROID(buffer);
+    if (clientBuffer == NULL) {
+        LOGE("GetTextureForBuffer: eglGetNativeClientBufferANDROID failed");
+        return 0;
+    }
+
+    static const EGLint attrs[] = {
+        EGL_IMAGE_PRESERVED_KHR, EGL_TRUE,
+        EGL_NONE,
+    };
+    EGLImageKHR image = mEglCreateImageKHR(eglGetCurrentDisplay(),
+            EGL_NO_CONTEXT, EGL_NATIVE_BUFFER_ANDROID, clientBuffer, attrs);
+    if (image == EGL_NO_IMAGE_KHR) {
+        LOGE("GetTextureForBuffer: eglCreateImageKHR failed: 0x%x", eglGetError());
+        return 0;
+    }
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_EXTERNAL_OES, texture);
+    glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    mGlEGLImageTargetTexture2DOES(GL_TEXTURE_EXTERNAL_OES, (GLeglImageOES)image);
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        LOGE("GetTextureForBuffer: glEGLImageTargetTexture2DOES failed: 0x%x",
+                error);
+        glDeleteTextures(1, &texture);
+        mEglDestroyImageKHR(eglGetCurrentDisplay(), image);
+        return 0;
+    }
+
+    mBindings[mBindingCount].buffer = buffer;
+    mBindings[mBindingCount].image = image;
+    mBindings[mBindingCount].texture = texture;
+    mBindingCount++;
+    return texture;
+}
+
+void PreviewGlBinding::Release() {
+    for (uint32_t i = 0; i < mBindingCount; i++) {
+        glDeleteTextures(1, &mBindings[i].texture);
+        if (mEglDestroyImageKHR != NULL) {
+            mEglDestroyImageKHR(eglGetCurrentDisplay(), mBindings[i].image);
+        }
+    }
+    memset(mBindings, 0, sizeof(mBindings));
+    mBindingCount = 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#include <android/hardware_buffer.h>
+
+#include <stdint.h>
+
+// Binds camera preview gralloc buffers directly to GL textures.
+//
+// Instead of glTexImage2D-uploading each frame (a full-frame copy on the
+// GL thread), each AHardwareBuffer from the PreviewBufferPool is wrapped
+// once in an EGLImage and attached to a GL_TEXTURE_EXTERNAL_OES texture.
+// Because the pool recycles a fixed set of buffers, the wrap cost is paid
+// only on first sight of each buffer; per frame, presenting a buffer is
+// just a texture bind.
+//
+// Must be used on the thread that owns the GL context.
+class PreviewGlBinding {
+  public:
+    PreviewGlBinding();
+    ~PreviewGlBinding();
+
+    // Resolves the required EGL/GLES extension entry points.
+    // @return true if the zero-copy path is available on this device.
+    bool InitializeGLContext();
+
+    // Returns the GL_TEXTURE_EXTERNAL_OES texture backed by the buffer's
+    // gralloc memory, creating and caching the EGLImage binding on first
+    // use. Returns 0 on failure; the caller should fall back to the copy
+    // upload path.
+    GLuint GetTextureForBuffer(AHardwareBuffer* buffer);
+
+    // Drops all cached bindings (textures and EGLImages). Call when the
+    // buffer pool is reinitialized or the GL context is torn down.
+    void Release();
+
+  private:
+    static const uint32_t kMaxBindings = 16;
+
+    struct Binding {
+        AHardwareBuffer* buffer;
+        EGLImageKHR image;
+        GLuint texture;
+    };
+
+    Binding mBindings[kMaxBindings];
+    uint32_t mBindingCount;
+
+    PFNEGLGETNATIVECLIENTBUFFERANDROIDPROC mEglGetNativeClientBufferANDROID;
+    PFNEGLCREATEIMAGEKHRPROC mEglCreateImageKHR;
+    PFNEGLDESTROYIMAGEKHRPROC mEglDestroyImageKHR;
+    PFNGLEGLIMAGETARGETTEXTURE2DOESPROC mGlEGLImageTargetTexture2DOES;
+};
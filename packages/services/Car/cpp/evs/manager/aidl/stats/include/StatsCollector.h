@@ -19,6 +19,7 @@
 
 #include "CameraUsageStats.h"
 #include "LooperWrapper.h"
+#include "StatsSnapshotArena.h"
 
 #include <android-base/chrono_utils.h>
 #include <android-base/logging.h>
@@ -104,6 +105,12 @@ public:
     ::android::base::Result<void> toString(std::unordered_map<std::string, std::string>* usages,
                                            const char* indent = "") EXCLUDES(mMutex);
 
+    // Copies the latest published collection round without taking mMutex.
+    // Internally synchronized; safe to call from any thread.
+    bool readLatestRound(StatsSnapshotArena::Round* out) const {
+        return mSnapshotArena.readLatest(out);
+    }
+
 private:
     // Mutex to protect records
     mutable ::android::Mutex mMutex;
@@ -126,6 +133,11 @@ private:
     // A list of HalCamera objects to monitor
     std::unordered_map<std::string, std::weak_ptr<HalCamera>> mClientsToMonitor GUARDED_BY(mMutex);
 
+    // Preallocated double-buffered storage collectLocked() records each
+    // round into; publication to readers is an atomic buffer swap, so the
+    // collection thread performs no allocation per round.
+    StatsSnapshotArena mSnapshotArena;
+
     // Handles the messages from the looper
     void handleMessage(const ::android::Message& message) override;
 
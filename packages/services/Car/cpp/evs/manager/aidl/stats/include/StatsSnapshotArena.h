@@ -0,0 +1,145 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPP_EVS_MANAGER_AIDL_STATS_INCLUDE_STATSSNAPSHOTARENA_H
+#define CPP_EVS_MANAGER_AIDL_STATS_INCLUDE_STATSSNAPSHOTARENA_H
+
+#include "CameraUsageStats.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace aidl::android::automotive::evs::implementation {
+
+// Preallocated, double-buffered store for one round of per-camera usage
+// statistics.
+//
+// StatsCollector's periodic rounds populate std::unordered_map and
+// std::string per round; on multi-camera systems the resulting allocations
+// add jitter on the collection thread that aliases into frame delivery.
+// This arena lets the collection thread record a full round into fixed
+// storage - no allocation after construction - and publish it to readers
+// by swapping an atomic buffer index.
+//
+// Single writer (the collection thread), any number of readers. The two
+// buffers are reused in alternation, so a reader that falls a full round
+// behind could observe the writer reusing the buffer it is copying; each
+// buffer therefore carries a seqlock-style generation counter and readers
+// retry on a torn copy. In practice rounds are seconds apart and a retry
+// never happens.
+class StatsSnapshotArena final {
+public:
+    // Upper bounds sized for the largest supported camera topology.
+    static constexpr size_t kMaxCameras = 16;
+    static constexpr size_t kMaxIdLength = 64;
+
+    struct Entry {
+        // Camera device identifier, NUL-terminated, truncated to fit.
+        char id[kMaxIdLength];
+
+        // Statistics pulled from the matching CameraUsageStats.
+        CameraUsageStatsRecord record;
+    };
+
+    struct Round {
+        // Time the round was collected.
+        nsecs_t collectionTime = 0;
+
+        // Number of valid entries.
+        size_t count = 0;
+
+        // Entries recorded this round, dense in [0, count).
+        Entry entries[kMaxCameras];
+    };
+
+    // Writer interface, collection thread only.
+
+    // Starts recording a new round into the buffer not currently published.
+    void beginRound(nsecs_t collectionTime) {
+        mBack = 1 - mFront.load(std::memory_order_relaxed);
+        Buffer& buffer = mBuffers[mBack];
+        // Odd generation marks the buffer as being rewritten.
+        buffer.generation.store(buffer.generation.load(std::memory_order_relaxed) + 1,
+                                std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        buffer.round.collectionTime = collectionTime;
+        buffer.round.count = 0;
+    }
+
+    // Records one camera's statistics into the round being built. Returns
+    // false when the arena is full; the entry is dropped.
+    bool addRecord(const char* id, const CameraUsageStatsRecord& record) {
+        Round& round = mBuffers[mBack].round;
+        if (round.count >= kMaxCameras) {
+            return false;
+        }
+        Entry& entry = round.entries[round.count];
+        strncpy(entry.id, id, kMaxIdLength - 1);
+        entry.id[kMaxIdLength - 1] = '\0';
+        entry.record = record;
+        ++round.count;
+        return true;
+    }
+
+    // Completes the round and makes it the one readers see. The swap is a
+    // pair of atomic stores; nothing is copied or freed.
+    void publishRound() {
+        Buffer& buffer = mBuffers[mBack];
+        buffer.generation.store(buffer.generation.load(std::memory_order_relaxed) + 1,
+                                std::memory_order_release);
+        mFront.store(mBack, std::memory_order_release);
+    }
+
+    // Reader interface, any thread.
+
+    // Copies the most recently published round into *out. Returns false if
+    // no round has been published yet.
+    bool readLatest(Round* out) const {
+        for (;;) {
+            const int front = mFront.load(std::memory_order_acquire);
+            const Buffer& buffer = mBuffers[front];
+            const uint32_t before = buffer.generation.load(std::memory_order_acquire);
+            if (before == 0) {
+                return false;  // never published
+            }
+            if (before & 1) {
+                continue;  // writer mid-round on this buffer, about to republish
+            }
+            *out = buffer.round;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (buffer.generation.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+            // The writer lapped us; the other buffer is now the front.
+        }
+    }
+
+private:
+    struct Buffer {
+        // Even when the contents are stable, odd while being rewritten,
+        // zero until the first publication.
+        std::atomic<uint32_t> generation{0};
+        Round round;
+    };
+
+    Buffer mBuffers[2];
+    std::atomic<int> mFront{0};
+    int mBack = 1;  // buffer the writer records into, collection thread only
+};
+
+}  // namespace aidl::android::automotive::evs::implementation
+
+#endif  // CPP_EVS_MANAGER_AIDL_STATS_INCLUDE_STATSSNAPSHOTARENA_H
@@ -0,0 +1,245 @@
+/**
+ * Copyright (c) 2021, The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DiskStatsRing.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace android {
+namespace automotive {
+namespace watchdog {
+
+using ::android::base::Error;
+using ::android::base::Result;
+
+namespace {
+
+constexpr size_t kReadChunkSize = 16 * 1024;
+
+// Column positions (0-based, after major/minor/name) in a /proc/diskstats
+// line, per Documentation/admin-guide/iostats.rst. Sector counts convert
+// to KiB by halving. Column 8 (I/Os in flight) is a gauge, not a counter,
+// and is skipped; discard columns 11-14 are skipped as well.
+struct ColumnMapping {
+    size_t column;
+    DiskStatsRing::Field field;
+    bool halve;
+};
+
+constexpr ColumnMapping kColumnMappings[] = {
+        {0, DiskStatsRing::FIELD_NUM_READS_COMPLETED, false},
+        {1, DiskStatsRing::FIELD_NUM_READS_MERGED, false},
+        {2, DiskStatsRing::FIELD_NUM_KIB_READ, true},
+        {3, DiskStatsRing::FIELD_READ_TIME_MS, false},
+        {4, DiskStatsRing::FIELD_NUM_WRITES_COMPLETED, false},
+        {5, DiskStatsRing::FIELD_NUM_WRITES_MERGED, false},
+        {6, DiskStatsRing::FIELD_NUM_KIB_WRITTEN, true},
+        {7, DiskStatsRing::FIELD_WRITE_TIME_MS, false},
+        {9, DiskStatsRing::FIELD_TOTAL_IO_TIME_MS, false},
+        {10, DiskStatsRing::FIELD_WEIGHTED_TOTAL_IO_TIME_MS, false},
+        {15, DiskStatsRing::FIELD_NUM_FLUSH_COMPLETED, false},
+        {16, DiskStatsRing::FIELD_FLUSH_TIME_MS, false},
+};
+
+const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+    return p;
+}
+
+const char* parseUint(const char* p, const char* end, uint64_t* out) {
+    uint64_t value = 0;
+    const char* start = p;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + static_cast<uint64_t>(*p++ - '0');
+    }
+    if (p == start) {
+        return nullptr;
+    }
+    *out = value;
+    return p;
+}
+
+}  // namespace
+
+DiskStatsRing::DiskStatsRing(const std::string& path, size_t slotCount, size_t maxDevices) :
+      mPath(path), mMaxDevices(maxDevices) {
+    mSlots.resize(slotCount < 2 ? 2 : slotCount);
+    for (auto& slot : mSlots) {
+        slot.rows.reserve(maxDevices);
+        slot.present.reserve(maxDevices);
+    }
+    mDeviceNames.reserve(maxDevices);
+    mReadBuffer.reserve(kReadChunkSize);
+}
+
+Result<void> DiskStatsRing::collect() {
+    if (auto result = readFile(); !result.ok()) {
+        return result;
+    }
+    const size_t next = mSnapshotCount == 0 ? 0 : (mHead + 1) % mSlots.size();
+    if (auto result = parseInto(&mSlots[next]); !result.ok()) {
+        return result;
+    }
+    mHead = next;
+    if (mSnapshotCount < mSlots.size()) {
+        ++mSnapshotCount;
+    }
+    return {};
+}
+
+Result<void> DiskStatsRing::delta(size_t lagSlots, std::vector<Row>* out,
+                                  std::vector<bool>* outValid) const {
+    if (lagSlots == 0 || lagSlots >= mSnapshotCount) {
+        return Error() << "Lag " << lagSlots << " outside retained window of " << mSnapshotCount
+                       << " snapshots";
+    }
+    const Slot& newest = mSlots[mHead];
+    const Slot& oldest = mSlots[(mHead + mSlots.size() - lagSlots) % mSlots.size()];
+    const size_t rowCount = mDeviceNames.size();
+    out->resize(rowCount);
+    outValid->resize(rowCount);
+    for (size_t i = 0; i < rowCount; ++i) {
+        // Rows registered after a snapshot was taken are absent from its
+        // arrays; treat short arrays as not-present.
+        const bool valid = i < newest.present.size() && newest.present[i] &&
+                i < oldest.present.size() && oldest.present[i];
+        (*outValid)[i] = valid;
+        Row& row = (*out)[i];
+        if (!valid) {
+            row.fill(0);
+            continue;
+        }
+        const Row& cur = newest.rows[i];
+        const Row& prev = oldest.rows[i];
+        for (size_t f = 0; f < FIELD_COUNT; ++f) {
+            // Counters are monotonic; guard against device reset wrap.
+            row[f] = cur[f] >= prev[f] ? cur[f] - prev[f] : 0;
+        }
+    }
+    return {};
+}
+
+Result<void> DiskStatsRing::readFile() {
+    if (mFd.get() < 0) {
+        mFd.reset(TEMP_FAILURE_RETRY(open(mPath.c_str(), O_RDONLY | O_CLOEXEC)));
+        if (mFd.get() < 0) {
+            return Error() << "Failed to open " << mPath << ": " << strerror(errno);
+        }
+    }
+    mReadBuffer.clear();
+    size_t length = 0;
+    for (;;) {
+        mReadBuffer.resize(length + kReadChunkSize);
+        ssize_t n = TEMP_FAILURE_RETRY(pread(mFd.get(), mReadBuffer.data() + length,
+                                             kReadChunkSize, length));
+        if (n < 0) {
+            mFd.reset();
+            return Error() << "Failed to read " << mPath << ": " << strerror(errno);
+        }
+        length += n;
+        if (n == 0) {
+            break;
+        }
+    }
+    mReadBuffer.resize(length);
+    return {};
+}
+
+Result<void> DiskStatsRing::parseInto(Slot* slot) {
+    const size_t knownRows = mDeviceNames.size();
+    slot->rows.resize(knownRows);
+    slot->present.assign(knownRows, 0);
+
+    const char* p = mReadBuffer.data();
+    const char* bufferEnd = p + mReadBuffer.size();
+    while (p < bufferEnd) {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', bufferEnd - p));
+        if (lineEnd == nullptr) {
+            lineEnd = bufferEnd;
+        }
+        // major, minor, device name.
+        uint64_t ignored;
+        p = skipSpaces(p, lineEnd);
+        p = parseUint(p, lineEnd, &ignored);
+        if (p == nullptr) {
+            return Error() << "Malformed major number in " << mPath;
+        }
+        p = skipSpaces(p, lineEnd);
+        p = parseUint(p, lineEnd, &ignored);
+        if (p == nullptr) {
+            return Error() << "Malformed minor number in " << mPath;
+        }
+        p = skipSpaces(p, lineEnd);
+        const char* nameStart = p;
+        while (p < lineEnd && *p != ' ' && *p != '\t') {
+            ++p;
+        }
+        if (p == nameStart) {
+            return Error() << "Missing device name in " << mPath;
+        }
+        const std::string_view name(nameStart, p - nameStart);
+
+        size_t row;
+        auto it = mRowByName.find(std::string(name));
+        if (it != mRowByName.end()) {
+            row = it->second;
+        } else if (mDeviceNames.size() < mMaxDevices) {
+            row = mDeviceNames.size();
+            mDeviceNames.emplace_back(name);
+            mRowByName.emplace(mDeviceNames.back(), row);
+        } else {
+            ++mDroppedDevices;
+            p = lineEnd < bufferEnd ? lineEnd + 1 : bufferEnd;
+            continue;
+        }
+        if (row >= slot->rows.size()) {
+            slot->rows.resize(row + 1);
+            slot->present.resize(row + 1, 0);
+        }
+
+        Row& values = slot->rows[row];
+        values.fill(0);
+        size_t column = 0;
+        size_t mappingIndex = 0;
+        while (p < lineEnd && mappingIndex < std::size(kColumnMappings)) {
+            p = skipSpaces(p, lineEnd);
+            uint64_t value;
+            const char* next = parseUint(p, lineEnd, &value);
+            if (next == nullptr) {
+                break;  // older kernels emit fewer columns; keep what we have.
+            }
+            p = next;
+            const ColumnMapping& mapping = kColumnMappings[mappingIndex];
+            if (column == mapping.column) {
+                values[mapping.field] = mapping.halve ? value / 2 : value;
+                ++mappingIndex;
+            }
+            ++column;
+        }
+        slot->present[row] = 1;
+        p = lineEnd < bufferEnd ? lineEnd + 1 : bufferEnd;
+    }
+    return {};
+}
+
+}  // namespace watchdog
+}  // namespace automotive
+}  // namespace android
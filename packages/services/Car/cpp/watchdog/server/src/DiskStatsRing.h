@@ -0,0 +1,143 @@
+/**
+ * Copyright (c) 2021, The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPP_WATCHDOG_SERVER_SRC_DISKSTATSRING_H_
+#define CPP_WATCHDOG_SERVER_SRC_DISKSTATSRING_H_
+
+#include <android-base/result.h>
+#include <android-base/unique_fd.h>
+
+#include <stdint.h>
+
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace android {
+namespace automotive {
+namespace watchdog {
+
+/**
+ * Fixed-slot ring of /proc/diskstats snapshots for high-frequency polling.
+ *
+ * ProcDiskStatsCollector materializes a fresh snapshot per poll and joins
+ * consecutive snapshots by device-name map lookups to compute deltas. At
+ * the default 1s cadence that is fine; for I/O regression hunting at
+ * kHighFrequencyPollIntervalMs the allocation and join cost dominates.
+ *
+ * DiskStatsRing assigns each device a stable row index on first sight and
+ * parses every poll into preallocated per-slot row arrays, so a snapshot
+ * is writes into existing memory and a delta between any two retained
+ * snapshots is elementwise array subtraction over aligned rows - no maps,
+ * no allocation, no string handling past the first sighting of a device.
+ * The ring retains the newest slotCount snapshots, so a 64-slot ring at
+ * 100ms covers a 6.4s regression window.
+ *
+ * Not thread safe; poll and read deltas from the collection thread.
+ */
+class DiskStatsRing final {
+public:
+    /** Poll cadence intended for regression hunting. */
+    static constexpr int64_t kHighFrequencyPollIntervalMs = 100;
+
+    /** Numeric /proc/diskstats columns retained per device row. */
+    enum Field : size_t {
+        FIELD_NUM_READS_COMPLETED = 0,
+        FIELD_NUM_READS_MERGED,
+        FIELD_NUM_KIB_READ,
+        FIELD_READ_TIME_MS,
+        FIELD_NUM_WRITES_COMPLETED,
+        FIELD_NUM_WRITES_MERGED,
+        FIELD_NUM_KIB_WRITTEN,
+        FIELD_WRITE_TIME_MS,
+        FIELD_TOTAL_IO_TIME_MS,
+        FIELD_WEIGHTED_TOTAL_IO_TIME_MS,
+        FIELD_NUM_FLUSH_COMPLETED,
+        FIELD_FLUSH_TIME_MS,
+        FIELD_COUNT,
+    };
+
+    using Row = std::array<uint64_t, FIELD_COUNT>;
+
+    /**
+     * @param path /proc/diskstats (overridable for tests).
+     * @param slotCount number of snapshots retained, at least 2.
+     * @param maxDevices row capacity preallocated per slot; devices past
+     *                   this are ignored with a warning count.
+     */
+    DiskStatsRing(const std::string& path, size_t slotCount, size_t maxDevices = 64);
+
+    DiskStatsRing(const DiskStatsRing&) = delete;
+    DiskStatsRing& operator=(const DiskStatsRing&) = delete;
+
+    /**
+     * Parses the current /proc/diskstats contents into the next ring slot.
+     * The file descriptor stays open across polls and the read buffer is
+     * reused, so the steady-state poll performs no allocation.
+     */
+    android::base::Result<void> collect();
+
+    /** Number of snapshots currently retained, up to slotCount. */
+    size_t snapshotCount() const { return mSnapshotCount; }
+
+    /** Number of device rows registered so far. */
+    size_t deviceCount() const { return mDeviceNames.size(); }
+
+    /** Name of the device occupying the given row index. */
+    const std::string& deviceName(size_t row) const { return mDeviceNames[row]; }
+
+    /** Devices seen but not tracked because maxDevices was exceeded. */
+    size_t droppedDeviceCount() const { return mDroppedDevices; }
+
+    /**
+     * Computes newest snapshot minus the snapshot lagSlots polls earlier as
+     * rowwise array subtraction. lagSlots must be >= 1 and < snapshotCount().
+     * Rows absent from either snapshot (device appeared or vanished inside
+     * the window) report false in outValid. out and outValid are resized to
+     * deviceCount().
+     */
+    android::base::Result<void> delta(size_t lagSlots, std::vector<Row>* out,
+                                      std::vector<bool>* outValid) const;
+
+private:
+    struct Slot {
+        std::vector<Row> rows;           // indexed by device row, preallocated.
+        std::vector<uint8_t> present;    // 1 if the device appeared in this poll.
+    };
+
+    android::base::Result<void> readFile();
+    android::base::Result<void> parseInto(Slot* slot);
+
+    std::string mPath;
+    size_t mMaxDevices;
+    android::base::unique_fd mFd;
+    std::string mReadBuffer;
+
+    std::unordered_map<std::string, size_t> mRowByName;
+    std::vector<std::string> mDeviceNames;
+    size_t mDroppedDevices = 0;
+
+    std::vector<Slot> mSlots;
+    size_t mHead = 0;  // slot written by the most recent collect().
+    size_t mSnapshotCount = 0;
+};
+
+}  // namespace watchdog
+}  // namespace automotive
+}  // namespace android
+
+#endif  //  CPP_WATCHDOG_SERVER_SRC_DISKSTATSRING_H_
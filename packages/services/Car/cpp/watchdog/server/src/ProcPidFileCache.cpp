@@ -0,0 +1,267 @@
+/**
+ * Copyright (c) 2021, The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ProcPidFileCache.h"
+
+#include <android-base/stringprintf.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace android {
+namespace automotive {
+namespace watchdog {
+
+using ::android::base::Error;
+using ::android::base::Result;
+using ::android::base::StringPrintf;
+using ::android::base::unique_fd;
+
+namespace {
+
+constexpr size_t kTidShift = 22;  // PID_MAX_LIMIT is 1 << 22.
+
+// Tids start at 1, so slot 0 in the tid bits is free for the process-level
+// stat file; the process-level status file sets the top bit instead.
+constexpr uint64_t kSlotPidStat = 0;
+constexpr uint64_t kStatusKeyBit = 1ULL << 63;
+
+constexpr size_t kArenaBlockSize = 64 * 1024;
+constexpr size_t kInitialScratchSize = 8 * 1024;
+
+uint64_t makeKey(pid_t pid, uint64_t slot) {
+    return (static_cast<uint64_t>(pid) << kTidShift) | slot;
+}
+
+}  // namespace
+
+Result<std::string_view> ProcPidFileCache::readPidStat(pid_t pid) {
+    return readCached(makeKey(pid, kSlotPidStat),
+                      StringPrintf("%s/%" PRIu32 "/stat", mProcDirPath.c_str(), pid));
+}
+
+Result<std::string_view> ProcPidFileCache::readPidStatus(pid_t pid) {
+    return readCached(makeKey(pid, kSlotPidStat) | kStatusKeyBit,
+                      StringPrintf("%s/%" PRIu32 "/status", mProcDirPath.c_str(), pid));
+}
+
+Result<std::string_view> ProcPidFileCache::readTidStat(pid_t pid, pid_t tid) {
+    return readCached(makeKey(pid, static_cast<uint64_t>(tid)),
+                      StringPrintf("%s/%" PRIu32 "/task/%" PRIu32 "/stat", mProcDirPath.c_str(),
+                                   pid, tid));
+}
+
+void ProcPidFileCache::startCollection() {
+    // Keep one block from the previous interval; drop any overflow blocks.
+    if (mArena.empty()) {
+        mArena.emplace_back(new char[kArenaBlockSize]);
+    } else {
+        mArena.resize(1);
+    }
+    mArenaUsed = 0;
+    for (auto& [key, entry] : mEntries) {
+        entry.touched = false;
+    }
+}
+
+void ProcPidFileCache::finishCollection() {
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (!it->second.touched) {
+            it = mEntries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+Result<std::string_view> ProcPidFileCache::readCached(uint64_t key, const std::string& path) {
+    auto it = mEntries.find(key);
+    if (it != mEntries.end()) {
+        it->second.touched = true;
+        auto result = preadAll(it->second.fd.get());
+        if (result.ok()) {
+            return result;
+        }
+        // The process is gone or the pid was reused; drop the stale fd and
+        // fall through to a fresh open.
+        mEntries.erase(it);
+    }
+    unique_fd fd(TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (fd.get() < 0) {
+        return Error() << "Failed to open " << path << ": " << strerror(errno);
+    }
+    auto result = preadAll(fd.get());
+    if (!result.ok()) {
+        return Error() << "Failed to read " << path << ": " << result.error();
+    }
+    mEntries[key] = Entry{.fd = std::move(fd), .touched = true};
+    return result;
+}
+
+Result<std::string_view> ProcPidFileCache::preadAll(int fd) {
+    // Read through a scratch buffer first, then copy into the arena, so
+    // arena blocks never move and views returned earlier in the collection
+    // stay valid. /proc stat files are a few hundred bytes, so this is one
+    // pread and one short memcpy in practice.
+    if (mScratch.empty()) {
+        mScratch.resize(kInitialScratchSize);
+    }
+    size_t length = 0;
+    for (;;) {
+        if (length == mScratch.size()) {
+            mScratch.resize(mScratch.size() * 2);
+        }
+        ssize_t n = TEMP_FAILURE_RETRY(
+                pread(fd, mScratch.data() + length, mScratch.size() - length, length));
+        if (n < 0) {
+            return Error() << strerror(errno);
+        }
+        if (n == 0) {
+            break;
+        }
+        length += n;
+    }
+    if (length == 0) {
+        // A zero-length read from procfs means the process is gone.
+        return Error() << "empty read";
+    }
+    const size_t blockSize = std::max(kArenaBlockSize, length);
+    if (mArena.empty() || mArenaUsed + length > kArenaBlockSize) {
+        mArena.emplace_back(new char[blockSize]);
+        mArenaUsed = 0;
+    }
+    char* dest = mArena.back().get() + mArenaUsed;
+    memcpy(dest, mScratch.data(), length);
+    mArenaUsed += length;
+    return std::string_view(dest, length);
+}
+
+Result<PidStatFields> parsePidStat(std::string_view content) {
+    PidStatFields fields;
+    const char* p = content.data();
+    const char* end = p + content.size();
+
+    // Field 1: pid.
+    uint64_t pid = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        pid = pid * 10 + static_cast<uint64_t>(*p++ - '0');
+    }
+    fields.pid = static_cast<pid_t>(pid);
+
+    // Field 2: (comm), may contain spaces and parentheses, so scan for the
+    // last ')' on the line.
+    while (p < end && *p != '(') {
+        ++p;
+    }
+    const char* commStart = p < end ? p + 1 : end;
+    const char* commEnd = nullptr;
+    for (const char* q = end - 1; q > commStart; --q) {
+        if (*q == ')') {
+            commEnd = q;
+            break;
+        }
+    }
+    if (commEnd == nullptr || commEnd + 2 >= end) {
+        return Error() << "Malformed stat contents";
+    }
+    fields.comm = std::string_view(commStart, commEnd - commStart);
+
+    // Field 3: state, single character.
+    p = commEnd + 2;
+    fields.state = *p++;
+
+    // Fields 4 through 22 are space-separated integers; one pass picking
+    // out majflt (12), utime (14), stime (15) and starttime (22).
+    int fieldNum = 3;
+    while (p < end && fieldNum < 22) {
+        if (*p != ' ') {
+            return Error() << "Unexpected character after stat field " << fieldNum;
+        }
+        ++p;
+        ++fieldNum;
+        bool negative = false;
+        if (p < end && *p == '-') {
+            negative = true;
+            ++p;
+        }
+        uint64_t value = 0;
+        bool hasDigits = false;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value = value * 10 + static_cast<uint64_t>(*p++ - '0');
+            hasDigits = true;
+        }
+        if (!hasDigits) {
+            return Error() << "Missing digits in stat field " << fieldNum;
+        }
+        if (!negative) {
+            switch (fieldNum) {
+                case 12:
+                    fields.majorFaults = value;
+                    break;
+                case 14:
+                    fields.utimeTicks = value;
+                    break;
+                case 15:
+                    fields.stimeTicks = value;
+                    break;
+                case 22:
+                    fields.startTimeTicks = value;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    if (fieldNum < 22) {
+        return Error() << "Truncated stat contents: only " << fieldNum << " fields";
+    }
+    return fields;
+}
+
+bool PidStatChangeTracker::isChanged(pid_t pid, std::string_view content) {
+    auto it = mByPid.find(pid);
+    if (it == mByPid.end()) {
+        mByPid[pid] = Remembered{.content = std::string(content), .seen = true};
+        return true;
+    }
+    it->second.seen = true;
+    if (content.size() == it->second.content.size() &&
+        memcmp(content.data(), it->second.content.data(), content.size()) == 0) {
+        return false;
+    }
+    it->second.content.assign(content.data(), content.size());
+    return true;
+}
+
+void PidStatChangeTracker::sweep() {
+    for (auto it = mByPid.begin(); it != mByPid.end();) {
+        if (!it->second.seen) {
+            it = mByPid.erase(it);
+        } else {
+            it->second.seen = false;
+            ++it;
+        }
+    }
+}
+
+}  // namespace watchdog
+}  // namespace automotive
+}  // namespace android
@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) 2021, The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPP_WATCHDOG_SERVER_SRC_PROCPIDFILECACHE_H_
+#define CPP_WATCHDOG_SERVER_SRC_PROCPIDFILECACHE_H_
+
+#include <android-base/result.h>
+#include <android-base/unique_fd.h>
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace android {
+namespace automotive {
+namespace watchdog {
+
+/**
+ * Fast read path for per-process /proc files during periodic collections.
+ *
+ * UidProcStatsCollector re-visits the same few hundred pids every interval.
+ * ProcPidFileCache keeps the per-pid file descriptors open across intervals
+ * and rereads them with pread(2) at offset zero, so a steady-state
+ * collection performs no path lookups and no opens. File contents land in
+ * a single arena buffer reused across the collection, so the read path
+ * performs no per-process allocation either. When a pid dies (or is
+ * reused), the pread fails and the entry is transparently reopened or
+ * dropped.
+ */
+class ProcPidFileCache final {
+public:
+    explicit ProcPidFileCache(const std::string& procDirPath) : mProcDirPath(procDirPath) {}
+
+    ProcPidFileCache(const ProcPidFileCache&) = delete;
+    ProcPidFileCache& operator=(const ProcPidFileCache&) = delete;
+
+    /**
+     * Reads /proc/<pid>/stat through the cached fd. The returned view points
+     * into the arena and is valid until the next startCollection() call.
+     */
+    android::base::Result<std::string_view> readPidStat(pid_t pid);
+
+    /** Reads /proc/<pid>/status through the cached fd. */
+    android::base::Result<std::string_view> readPidStatus(pid_t pid);
+
+    /** Reads /proc/<pid>/task/<tid>/stat through the cached fd. */
+    android::base::Result<std::string_view> readTidStat(pid_t pid, pid_t tid);
+
+    /**
+     * Starts a collection interval: resets the arena (invalidating all views
+     * returned since the previous call) and begins tracking which cache
+     * entries are touched.
+     */
+    void startCollection();
+
+    /**
+     * Ends a collection interval: closes fds of pids that were not read
+     * during this interval, so dead processes do not pin /proc entries.
+     */
+    void finishCollection();
+
+    size_t cachedFdCount() const { return mEntries.size(); }
+
+private:
+    struct Entry {
+        android::base::unique_fd fd;
+        bool touched = false;
+    };
+
+    android::base::Result<std::string_view> readCached(uint64_t key, const std::string& path);
+    android::base::Result<std::string_view> preadAll(int fd);
+
+    std::string mProcDirPath;
+    // Key is (pid << 22) | tid for thread stat files (tids fit in 22 bits by
+    // PID_MAX_LIMIT); the process-level stat file uses tid slot 0 and the
+    // status file additionally sets the top bit.
+    std::unordered_map<uint64_t, Entry> mEntries;
+    // Fixed-size blocks so arena addresses never move within a collection.
+    std::vector<std::unique_ptr<char[]>> mArena;
+    size_t mArenaUsed = 0;  // bytes used in the last block.
+    std::vector<char> mScratch;
+};
+
+/** Fields of /proc/<pid>/stat used by the collector, parsed in one pass. */
+struct PidStatFields {
+    pid_t pid = -1;
+    std::string_view comm;  // points into the parsed content.
+    char state = '\0';
+    uint64_t majorFaults = 0;
+    uint64_t utimeTicks = 0;
+    uint64_t stimeTicks = 0;
+    uint64_t startTimeTicks = 0;
+};
+
+/**
+ * Parses the stat fields out of a raw /proc/<pid>/stat line in a single
+ * left-to-right pass with no tokenization allocations. Handles comm values
+ * containing spaces and parentheses by scanning to the last ')'.
+ */
+android::base::Result<PidStatFields> parsePidStat(std::string_view content);
+
+/**
+ * Remembers the previous raw /proc/<pid>/stat contents per pid and reports
+ * whether the current contents changed since the last collection.
+ *
+ * /proc files carry no usable mtime, so "unchanged" is detected by byte
+ * comparison against the remembered copy - one memcmp against data already
+ * in cache, which is much cheaper than reparsing and rebuilding stats for
+ * the large majority of processes that were idle over a 1s interval.
+ */
+class PidStatChangeTracker final {
+public:
+    /**
+     * Returns true if content differs from the remembered bytes for the pid
+     * (or the pid is new) and remembers the new content; returns false if
+     * the bytes are identical, in which case the caller may reuse the
+     * previously parsed stats.
+     */
+    bool isChanged(pid_t pid, std::string_view content);
+
+    /** Forgets pids not seen since the previous sweep(); call per interval. */
+    void sweep();
+
+private:
+    struct Remembered {
+        std::string content;
+        bool seen = false;
+    };
+    std::unordered_map<pid_t, Remembered> mByPid;
+};
+
+}  // namespace watchdog
+}  // namespace automotive
+}  // namespace android
+
+#endif  //  CPP_WATCHDOG_SERVER_SRC_PROCPIDFILECACHE_H_
@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2021, The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DiskStatsRing.h"
+
+#include <android-base/file.h>
+#include <android-base/stringprintf.h>
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+namespace android {
+namespace automotive {
+namespace watchdog {
+
+using ::android::base::StringPrintf;
+using ::android::base::WriteStringToFile;
+
+namespace {
+
+std::string diskStatsLine(const std::string& name, uint64_t base) {
+    // 17 numeric columns after major/minor/name, matching modern kernels.
+    return StringPrintf(" 252      32 %s %llu 10 %llu 40 %llu 60 %llu 80 0 %llu %llu 0 0 0 0 "
+                        "%llu %llu\n",
+                        name.c_str(), (unsigned long long)base,
+                        (unsigned long long)(base * 2),  // sectors read -> KiB = base
+                        (unsigned long long)(base + 1), (unsigned long long)(base + 2),
+                        (unsigned long long)(base + 3), (unsigned long long)(base + 4),
+                        (unsigned long long)(base + 5), (unsigned long long)(base + 6));
+}
+
+}  // namespace
+
+TEST(DiskStatsRingTest, TestDeltaIsArraySubtraction) {
+    TemporaryFile tf;
+    ASSERT_NE(tf.fd, -1);
+
+    DiskStatsRing ring(tf.path, /*slotCount=*/4);
+    ASSERT_TRUE(WriteStringToFile(diskStatsLine("vdc", 100) + diskStatsLine("dm-0", 500),
+                                  tf.path));
+    ASSERT_RESULT_OK(ring.collect());
+    ASSERT_TRUE(WriteStringToFile(diskStatsLine("vdc", 160) + diskStatsLine("dm-0", 530),
+                                  tf.path));
+    ASSERT_RESULT_OK(ring.collect());
+
+    ASSERT_EQ(ring.deviceCount(), 2u);
+    EXPECT_EQ(ring.deviceName(0), "vdc");
+    EXPECT_EQ(ring.deviceName(1), "dm-0");
+
+    std::vector<DiskStatsRing::Row> delta;
+    std::vector<bool> valid;
+    ASSERT_RESULT_OK(ring.delta(1, &delta, &valid));
+    ASSERT_EQ(delta.size(), 2u);
+    EXPECT_TRUE(valid[0]);
+    EXPECT_TRUE(valid[1]);
+    EXPECT_EQ(delta[0][DiskStatsRing::FIELD_NUM_READS_COMPLETED], 60u);
+    EXPECT_EQ(delta[0][DiskStatsRing::FIELD_NUM_KIB_READ], 60u);
+    EXPECT_EQ(delta[0][DiskStatsRing::FIELD_NUM_WRITES_COMPLETED], 60u);
+    EXPECT_EQ(delta[0][DiskStatsRing::FIELD_FLUSH_TIME_MS], 60u);
+    EXPECT_EQ(delta[1][DiskStatsRing::FIELD_NUM_READS_COMPLETED], 30u);
+    EXPECT_EQ(delta[0][DiskStatsRing::FIELD_NUM_READS_MERGED], 0u);
+}
+
+TEST(DiskStatsRingTest, TestWindowedDeltaAcrossRing) {
+    TemporaryFile tf;
+    ASSERT_NE(tf.fd, -1);
+
+    DiskStatsRing ring(tf.path, /*slotCount=*/4);
+    for (uint64_t i = 0; i < 6; ++i) {
+        ASSERT_TRUE(WriteStringToFile(diskStatsLine("vdc", 100 * (i + 1)), tf.path));
+        ASSERT_RESULT_OK(ring.collect());
+    }
+    EXPECT_EQ(ring.snapshotCount(), 4u);
+
+    std::vector<DiskStatsRing::Row> delta;
+    std::vector<bool> valid;
+    // Newest (600) minus 3 polls earlier (300).
+    ASSERT_RESULT_OK(ring.delta(3, &delta, &valid));
+    EXPECT_EQ(delta[0][DiskStatsRing::FIELD_NUM_READS_COMPLETED], 300u);
+    // Lags outside the retained window are rejected.
+    EXPECT_FALSE(ring.delta(4, &delta, &valid).ok());
+    EXPECT_FALSE(ring.delta(0, &delta, &valid).ok());
+}
+
+TEST(DiskStatsRingTest, TestDeviceAppearsAndVanishes) {
+    TemporaryFile tf;
+    ASSERT_NE(tf.fd, -1);
+
+    DiskStatsRing ring(tf.path, /*slotCount=*/3);
+    ASSERT_TRUE(WriteStringToFile(diskStatsLine("vdc", 100), tf.path));
+    ASSERT_RESULT_OK(ring.collect());
+    // zram0 appears, vdc vanishes.
+    ASSERT_TRUE(WriteStringToFile(diskStatsLine("zram0", 50), tf.path));
+    ASSERT_RESULT_OK(ring.collect());
+
+    std::vector<DiskStatsRing::Row> delta;
+    std::vector<bool> valid;
+    ASSERT_RESULT_OK(ring.delta(1, &delta, &valid));
+    ASSERT_EQ(delta.size(), 2u);
+    EXPECT_FALSE(valid[0]);  // vdc not in newest snapshot
+    EXPECT_FALSE(valid[1]);  // zram0 not in oldest snapshot
+}
+
+TEST(DiskStatsRingTest, TestMaxDevicesCap) {
+    TemporaryFile tf;
+    ASSERT_NE(tf.fd, -1);
+
+    DiskStatsRing ring(tf.path, /*slotCount=*/2, /*maxDevices=*/2);
+    ASSERT_TRUE(WriteStringToFile(diskStatsLine("a", 1) + diskStatsLine("b", 2) +
+                                          diskStatsLine("c", 3),
+                                  tf.path));
+    ASSERT_RESULT_OK(ring.collect());
+    EXPECT_EQ(ring.deviceCount(), 2u);
+    EXPECT_EQ(ring.droppedDeviceCount(), 1u);
+}
+
+}  // namespace watchdog
+}  // namespace automotive
+}  // namespace android
@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2021, The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ProcPidFileCache.h"
+
+#include <android-base/file.h>
+#include <android-base/stringprintf.h>
+#include <gmock/gmock.h>
+
+#include <sys/stat.h>
+
+#include <string>
+
+namespace android {
+namespace automotive {
+namespace watchdog {
+
+using ::android::base::StringPrintf;
+using ::android::base::WriteStringToFile;
+
+namespace {
+
+constexpr char kStatLine[] =
+        "1000 (system_server) D 1 0 0 0 0 0 0 0 600 0 8000 4000 0 0 0 0 2 0 13400\n";
+
+void writePidStat(const std::string& procDirPath, pid_t pid, const std::string& contents) {
+    ASSERT_EQ(mkdir(StringPrintf("%s/%d", procDirPath.c_str(), pid).c_str(), 0700), 0);
+    ASSERT_TRUE(WriteStringToFile(contents,
+                                  StringPrintf("%s/%d/stat", procDirPath.c_str(), pid)));
+}
+
+}  // namespace
+
+TEST(ProcPidFileCacheTest, TestParsePidStat) {
+    auto result = parsePidStat(kStatLine);
+    ASSERT_RESULT_OK(result);
+    EXPECT_EQ(result->pid, 1000);
+    EXPECT_EQ(result->comm, "system_server");
+    EXPECT_EQ(result->state, 'D');
+    EXPECT_EQ(result->majorFaults, 600u);
+    EXPECT_EQ(result->utimeTicks, 8000u);
+    EXPECT_EQ(result->stimeTicks, 4000u);
+    EXPECT_EQ(result->startTimeTicks, 13400u);
+}
+
+TEST(ProcPidFileCacheTest, TestParsePidStatCommWithSpacesAndParens) {
+    auto result = parsePidStat(
+            "268 (soft irq (h)) S 2 0 0 0 0 0 0 0 12 0 1 2 0 0 0 0 1 0 345\n");
+    ASSERT_RESULT_OK(result);
+    EXPECT_EQ(result->comm, "soft irq (h)");
+    EXPECT_EQ(result->state, 'S');
+    EXPECT_EQ(result->majorFaults, 12u);
+    EXPECT_EQ(result->startTimeTicks, 345u);
+}
+
+TEST(ProcPidFileCacheTest, TestParsePidStatErrors) {
+    EXPECT_FALSE(parsePidStat("").ok());
+    EXPECT_FALSE(parsePidStat("1 (init)").ok());
+    EXPECT_FALSE(parsePidStat("1 (init) S 0 0 0\n").ok());
+    EXPECT_FALSE(parsePidStat("1 (init) S 0 x 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n").ok());
+}
+
+TEST(ProcPidFileCacheTest, TestReadsThroughCachedFd) {
+    TemporaryDir procDir;
+    writePidStat(procDir.path, 1000, kStatLine);
+
+    ProcPidFileCache cache(procDir.path);
+    cache.startCollection();
+    auto result = cache.readPidStat(1000);
+    ASSERT_RESULT_OK(result);
+    EXPECT_EQ(std::string(*result), kStatLine);
+    EXPECT_EQ(cache.cachedFdCount(), 1u);
+    cache.finishCollection();
+
+    // Rewrite contents; the cached fd must observe the new bytes via pread.
+    const std::string updated =
+            "1000 (system_server) S 1 0 0 0 0 0 0 0 601 0 8100 4100 0 0 0 0 2 0 13400\n";
+    ASSERT_TRUE(WriteStringToFile(updated,
+                                  StringPrintf("%s/1000/stat", procDir.path)));
+    cache.startCollection();
+    result = cache.readPidStat(1000);
+    ASSERT_RESULT_OK(result);
+    EXPECT_EQ(std::string(*result), updated);
+    EXPECT_EQ(cache.cachedFdCount(), 1u);
+    cache.finishCollection();
+}
+
+TEST(ProcPidFileCacheTest, TestDropsUntouchedEntries) {
+    TemporaryDir procDir;
+    writePidStat(procDir.path, 100, kStatLine);
+    writePidStat(procDir.path, 200, kStatLine);
+
+    ProcPidFileCache cache(procDir.path);
+    cache.startCollection();
+    ASSERT_RESULT_OK(cache.readPidStat(100));
+    ASSERT_RESULT_OK(cache.readPidStat(200));
+    cache.finishCollection();
+    EXPECT_EQ(cache.cachedFdCount(), 2u);
+
+    cache.startCollection();
+    ASSERT_RESULT_OK(cache.readPidStat(100));
+    cache.finishCollection();
+    EXPECT_EQ(cache.cachedFdCount(), 1u);
+}
+
+TEST(ProcPidFileCacheTest, TestChangeTracker) {
+    PidStatChangeTracker tracker;
+    EXPECT_TRUE(tracker.isChanged(1, kStatLine));   // first sight
+    EXPECT_FALSE(tracker.isChanged(1, kStatLine));  // identical bytes
+    EXPECT_TRUE(tracker.isChanged(1, "1 (init) S 0\n"));
+    tracker.sweep();
+    EXPECT_FALSE(tracker.isChanged(1, "1 (init) S 0\n"));
+    tracker.sweep();  // pid 1 seen this interval, kept
+    tracker.sweep();  // pid 1 not seen, dropped
+    EXPECT_TRUE(tracker.isChanged(1, "1 (init) S 0\n"));
+}
+
+}  // namespace watchdog
+}  // namespace automotive
+}  // namespace android
@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_CORE_PARALLEL_EVENT_DISPATCHER_H_
+#define CHRE_CORE_PARALLEL_EVENT_DISPATCHER_H_
+
+#include "chre/core/event.h"
+#include "chre/platform/assert.h"
+#include "chre/platform/atomic.h"
+#include "chre/platform/condition_variable.h"
+#include "chre/platform/mutex.h"
+#include "chre/util/array_queue.h"
+#include "chre/util/lock_guard.h"
+#include "chre/util/non_copyable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// These default values can be overridden in the variant-specific makefile.
+
+//! Maximum number of nanoapps that can be attached to the parallel dispatcher.
+#ifndef CHRE_PARALLEL_DISPATCH_MAX_LANES
+#define CHRE_PARALLEL_DISPATCH_MAX_LANES 32
+#endif
+
+//! Maximum number of events a worker delivers to one nanoapp before it hands
+//! the lane back for rescheduling, bounding how long other ready nanoapps
+//! wait for a worker.
+#ifndef CHRE_PARALLEL_DISPATCH_EVENT_BATCH
+#define CHRE_PARALLEL_DISPATCH_EVENT_BATCH 8
+#endif
+
+namespace chre {
+
+/**
+ * A bounded multi-producer multi-consumer ring of small indices that never
+ * takes a lock. Producers and consumers claim a slot with an atomic ticket
+ * (fetch_increment) and then synchronize on that slot's sequence number, so
+ * contention between threads is limited to a single atomic add plus a
+ * bounded wait for the one peer operating on the same slot.
+ *
+ * The platform atomics layer provides load/store/exchange/fetch_add but no
+ * compare-exchange, which rules out the classic linked freelist designs;
+ * the ticket ring needs only the primitives every CHRE platform has.
+ *
+ * pop() on an empty ring fails fast. push() assumes the caller never
+ * exceeds kCapacity outstanding values, which both users in this file
+ * guarantee by construction.
+ */
+template <size_t kCapacity>
+class TicketIndexRing : public NonCopyable {
+ public:
+  TicketIndexRing() {
+    for (uint32_t i = 0; i < kCapacity; i++) {
+      mSlots[i].sequence.store(i);
+    }
+  }
+
+  /**
+   * Adds an index to the ring. Must not be called with kCapacity values
+   * already stored.
+   *
+   * @param value The index to store
+   */
+  void push(uint16_t value) {
+    uint32_t ticket = mPushTicket.fetch_increment();
+    Slot &slot = mSlots[ticket % kCapacity];
+    while (slot.sequence.load() != ticket) {
+      // Bounded wait for the consumer of the previous lap to clear the slot.
+    }
+    slot.value = value;
+    slot.sequence.store(ticket + 1);
+    mCount.fetch_increment();
+  }
+
+  /**
+   * Removes the oldest index from the ring.
+   *
+   * @param value Populated with the removed index on success
+   * @return false if the ring was empty
+   */
+  bool pop(uint16_t *value) {
+    // Reserve an item before taking a ticket. fetch_decrement of an empty
+    // (or transiently underflowed) count is repaired and reported as empty;
+    // legitimate pre-decrement values are in [1, kCapacity].
+    uint32_t previous = mCount.fetch_decrement();
+    if (previous == 0 || previous > kCapacity) {
+      mCount.fetch_increment();
+      return false;
+    }
+    uint32_t ticket = mPopTicket.fetch_increment();
+    Slot &slot = mSlots[ticket % kCapacity];
+    while (slot.sequence.load() != ticket + 1) {
+      // Bounded wait for the matching push to finish storing the value.
+    }
+    *value = slot.value;
+    slot.sequence.store(ticket + kCapacity);
+    return true;
+  }
+
+  /**
+   * @return true if no indices are currently stored
+   */
+  bool empty() const {
+    uint32_t count = mCount.load();
+    return count == 0 || count > kCapacity;
+  }
+
+ private:
+  struct Slot {
+    //! Lap marker: equals the push ticket when the slot is free for that
+    //! push, ticket + 1 once the value is visible to the matching pop.
+    AtomicUint32 sequence{0};
+    uint16_t value = 0;
+  };
+
+  Slot mSlots[kCapacity];
+  AtomicUint32 mPushTicket{0};
+  AtomicUint32 mPopTicket{0};
+  AtomicUint32 mCount{0};
+};
+
+/**
+ * A fixed pool of Event storage with lock-free allocate/deallocate, intended
+ * to stand in for SynchronizedMemoryPool<Event> on paths where several
+ * threads allocate and release events concurrently and the pool mutex would
+ * serialize them.
+ */
+template <size_t kCapacity>
+class LockFreeEventPool : public NonCopyable {
+ public:
+  LockFreeEventPool() {
+    for (uint16_t i = 0; i < kCapacity; i++) {
+      mFreeIndices.push(i);
+    }
+  }
+
+  /**
+   * Allocates an Event, constructing it with the given arguments.
+   *
+   * @return A pointer to the constructed Event, or nullptr if the pool is
+   *         exhausted
+   */
+  template <typename... Args>
+  Event *allocate(Args &&... args) {
+    uint16_t index;
+    if (!mFreeIndices.pop(&index)) {
+      return nullptr;
+    }
+    return new (&mStorage[index]) Event(static_cast<Args &&>(args)...);
+  }
+
+  /**
+   * Destroys an Event previously returned by allocate() and returns its
+   * storage to the pool.
+   *
+   * @param event A non-null pointer obtained from allocate()
+   */
+  void deallocate(Event *event) {
+    size_t index = static_cast<size_t>(
+        reinterpret_cast<EventStorage *>(event) - &mStorage[0]);
+    CHRE_ASSERT(index < kCapacity);
+    event->~Event();
+    mFreeIndices.push(static_cast<uint16_t>(index));
+  }
+
+ private:
+  union EventStorage {
+    EventStorage() {}
+    ~EventStorage() {}
+    Event event;
+  };
+
+  EventStorage mStorage[kCapacity];
+  TicketIndexRing<kCapacity> mFreeIndices;
+};
+
+/**
+ * Opt-in pool that dispatches nanoapp events on multiple worker threads
+ * while keeping the delivery order for any single nanoapp identical to the
+ * single-threaded event loop.
+ *
+ * Each nanoapp attached to the dispatcher owns a lane: a FIFO of pending
+ * events plus a scheduled flag. A lane with pending events is placed in the
+ * shared ready ring exactly once; whichever worker pops it delivers a batch
+ * of its events and then either requeues it (more pending) or clears the
+ * flag (drained). Because a lane is held by at most one worker at a time,
+ * events for one nanoapp are never delivered concurrently or out of order,
+ * while lanes for different nanoapps migrate freely across workers - an idle
+ * worker always takes the oldest ready lane regardless of which thread
+ * enqueued its events.
+ *
+ * The dispatcher is platform-neutral and does not create threads: as with
+ * EventLoop::run(), the platform layer spawns its worker threads and parks
+ * each of them in runWorker(), which returns after stop() is called.
+ */
+class ParallelEventDispatcher : public NonCopyable {
+ public:
+  //! Signature of the function a worker invokes to deliver one event to the
+  //! nanoapp owning the lane, e.g. a trampoline into
+  //! EventLoop::deliverEventSync(). Invoked with the lane's nanoapp
+  //! guaranteed not to be receiving an event on any other worker.
+  typedef void(DispatchFunction)(uint16_t laneIndex, Event *event, void *data);
+
+  /**
+   * @param dispatchFunction Non-null function used to deliver events
+   * @param data Arbitrary data passed through to dispatchFunction
+   */
+  ParallelEventDispatcher(DispatchFunction *dispatchFunction, void *data)
+      : mDispatchFunction(dispatchFunction), mData(data) {
+    CHRE_ASSERT(dispatchFunction != nullptr);
+  }
+
+  /**
+   * Reserves a lane for a nanoapp. Lanes cannot be released; the dispatcher
+   * is sized for the maximum nanoapp population of the variant.
+   *
+   * @param laneIndex Populated with the reserved lane's index on success
+   * @return false if all lanes are in use
+   */
+  bool allocateLane(uint16_t *laneIndex) {
+    uint32_t index = mLaneCount.fetch_increment();
+    if (index >= kMaxLanes) {
+      mLaneCount.fetch_decrement();
+      return false;
+    }
+    *laneIndex = static_cast<uint16_t>(index);
+    return true;
+  }
+
+  /**
+   * Queues an event for delivery to the nanoapp owning the given lane and
+   * wakes a worker if the lane was idle. Safe to call from any thread,
+   * including workers (e.g. events posted from a nanoapp's event handler).
+   *
+   * @param laneIndex A lane previously returned by allocateLane()
+   * @param event The event to deliver; ownership follows the same reference
+   *        counting rules as EventRefQueue
+   * @return false if the lane's queue is full; the caller retains ownership
+   */
+  bool deliverEventAsync(uint16_t laneIndex, Event *event) {
+    CHRE_ASSERT(laneIndex < mLaneCount.load());
+    Lane &lane = mLanes[laneIndex];
+    bool needsScheduling = false;
+    {
+      LockGuard<Mutex> lock(lane.mutex);
+      if (!lane.pendingEvents.push(event)) {
+        return false;
+      }
+      needsScheduling = !lane.scheduled;
+      lane.scheduled = true;
+    }
+    if (needsScheduling) {
+      scheduleLane(laneIndex);
+    }
+    return true;
+  }
+
+  /**
+   * Delivers events until stop() is called. The platform layer calls this
+   * from each worker thread it dedicates to the dispatcher.
+   */
+  void runWorker() {
+    while (true) {
+      uint16_t laneIndex;
+      {
+        LockGuard<Mutex> lock(mWorkerMutex);
+        while (!mStopped.load() && !mReadyLanes.pop(&laneIndex)) {
+          mWorkerCondition.wait(mWorkerMutex);
+        }
+        if (mStopped.load()) {
+          return;
+        }
+      }
+      drainLane(laneIndex);
+    }
+  }
+
+  /**
+   * Makes all current and future runWorker() calls return. Events still
+   * pending in lanes are not delivered.
+   */
+  void stop() {
+    mStopped.store(true);
+    LockGuard<Mutex> lock(mWorkerMutex);
+    mWorkerCondition.notify_all();
+  }
+
+ private:
+  static constexpr size_t kMaxLanes = CHRE_PARALLEL_DISPATCH_MAX_LANES;
+  static constexpr size_t kEventBatchSize = CHRE_PARALLEL_DISPATCH_EVENT_BATCH;
+
+  //! Mirrors EventRefQueue's per-app pending event bound.
+  static constexpr size_t kMaxPendingEventsPerLane = 16;
+
+  struct Lane {
+    //! Guards pendingEvents and scheduled.
+    Mutex mutex;
+
+    //! Events awaiting delivery to this lane's nanoapp, in arrival order.
+    ArrayQueue<Event *, kMaxPendingEventsPerLane> pendingEvents;
+
+    //! True while the lane is in the ready ring or held by a worker. Keeps
+    //! the lane from being scheduled twice, which is what guarantees
+    //! per-nanoapp serialization.
+    bool scheduled = false;
+  };
+
+  void scheduleLane(uint16_t laneIndex) {
+    mReadyLanes.push(laneIndex);
+    LockGuard<Mutex> lock(mWorkerMutex);
+    mWorkerCondition.notify_one();
+  }
+
+  void drainLane(uint16_t laneIndex) {
+    Lane &lane = mLanes[laneIndex];
+    for (size_t i = 0; i < kEventBatchSize; i++) {
+      Event *event;
+      {
+        LockGuard<Mutex> lock(lane.mutex);
+        if (lane.pendingEvents.empty()) {
+          // Clearing the flag under the lane mutex closes the race with a
+          // producer that pushed after our last pop: either it sees
+          // scheduled == true and we see its event, or it reschedules.
+          lane.scheduled = false;
+          return;
+        }
+        event = lane.pendingEvents.front();
+        lane.pendingEvents.pop();
+      }
+      mDispatchFunction(laneIndex, event, mData);
+    }
+    // Batch exhausted with events (possibly) still pending: hand the lane
+    // back so other ready lanes get a turn.
+    LockGuard<Mutex> lock(lane.mutex);
+    if (lane.pendingEvents.empty()) {
+      lane.scheduled = false;
+    } else {
+      scheduleLane(laneIndex);
+    }
+  }
+
+  DispatchFunction *mDispatchFunction;
+  void *mData;
+
+  Lane mLanes[kMaxLanes];
+  AtomicUint32 mLaneCount{0};
+
+  //! Lanes with pending events, each present at most once.
+  TicketIndexRing<kMaxLanes> mReadyLanes;
+
+  Mutex mWorkerMutex;
+  ConditionVariable mWorkerCondition;
+  AtomicBool mStopped{false};
+};
+
+}  // namespace chre
+
+#endif  // CHRE_CORE_PARALLEL_EVENT_DISPATCHER_H_
@@ -0,0 +1,232 @@
+// Copyright (C) 2021 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fs_mgr.h>
+#include <fstab/fstab.h>
+
+namespace android {
+namespace fs_mgr {
+
+// A dependency-aware parallel mount engine. Independent fstab entries are
+// fsck'ed and mounted concurrently instead of strictly in fstab order, which
+// overlaps per-partition fsck latency with other partitions' mounts. Two
+// entries are dependent, and keep their fstab order, when:
+//  - one mount point nests inside the other (/vendor before /vendor/dsp);
+//  - they share a mount point (alternate entries for the same partition are
+//    attempted in order, and skipped once one of them has mounted);
+//  - they chain to the same vbmeta partition (the AVB chain is loaded once,
+//    not raced).
+//
+// The engine only sequences work; what runs per entry is injected, so the
+// caller decides how to fsck and mount (and can route special cases like
+// metadata-encrypted userdata back to the serial fs_mgr_mount_all path by
+// excluding those entries from the fstab handed in here).
+
+struct ParallelMountConfig {
+    // Maximum entries in flight. 0 means one per available core.
+    size_t max_concurrency = 0;
+
+    // Mounts one entry; same contract as fs_mgr_do_mount_one(). Required.
+    std::function<int(FstabEntry* entry)> mount_one;
+
+    // Runs fsck for one entry before it is mounted. Optional; only invoked
+    // for entries with fs_mgr_flags.check. Returns false if the partition is
+    // damaged beyond mounting, which fails the entry without calling
+    // mount_one.
+    std::function<bool(FstabEntry* entry)> fsck;
+};
+
+// Per-entry telemetry, in fstab order. Durations are zero for phases that
+// did not run.
+struct MountAttempt {
+    std::string mount_point;
+    std::string blk_device;
+    std::chrono::milliseconds fsck_duration{0};
+    std::chrono::milliseconds mount_duration{0};
+    // FS_MGR_DOMNT_* code from mount_one, FS_MGR_DOMNT_FAILED if fsck
+    // rejected the partition, or FS_MGR_DOMNT_SUCCESS if the entry was
+    // skipped because an earlier alternate entry already mounted its mount
+    // point.
+    int code = FS_MGR_DOMNT_SUCCESS;
+    // False for skipped alternate entries.
+    bool attempted = false;
+};
+
+struct ParallelMountResult {
+    // FS_MGR_MNTALL_DEV_NOT_ENCRYPTABLE if every mount point was mounted by
+    // some entry, FS_MGR_MNTALL_FAIL otherwise.
+    int code = FS_MGR_MNTALL_DEV_NOT_ENCRYPTABLE;
+    std::vector<MountAttempt> attempts;
+};
+
+namespace detail {
+
+// Whether |mount_point| is |prefix| or nests inside it.
+inline bool MountPointNestsIn(const std::string& mount_point, const std::string& prefix) {
+    if (mount_point.size() < prefix.size() || prefix.empty()) return false;
+    if (mount_point.compare(0, prefix.size(), prefix) != 0) return false;
+    return mount_point.size() == prefix.size() || prefix == "/" ||
+           mount_point[prefix.size()] == '/';
+}
+
+inline bool EntriesDependent(const FstabEntry& earlier, const FstabEntry& later) {
+    if (MountPointNestsIn(later.mount_point, earlier.mount_point) ||
+        MountPointNestsIn(earlier.mount_point, later.mount_point)) {
+        return true;
+    }
+    if (!earlier.vbmeta_partition.empty() &&
+        earlier.vbmeta_partition == later.vbmeta_partition) {
+        return true;
+    }
+    return false;
+}
+
+}  // namespace detail
+
+// Mounts all entries of |fstab| under the dependency rules above. Entries
+// are processed by a pool of config.max_concurrency workers; an entry
+// becomes eligible once every earlier entry it depends on has finished.
+// Blocks until all entries have been processed.
+inline ParallelMountResult ParallelMountAll(Fstab* fstab, const ParallelMountConfig& config) {
+    ParallelMountResult result;
+    const size_t count = fstab->size();
+    result.attempts.resize(count);
+    if (count == 0) return result;
+
+    // dependencies[i] = indices of earlier entries that must finish first.
+    std::vector<std::vector<size_t>> dependents(count);
+    std::vector<size_t> pending(count, 0);
+    for (size_t later = 0; later < count; later++) {
+        for (size_t earlier = 0; earlier < later; earlier++) {
+            if (detail::EntriesDependent((*fstab)[earlier], (*fstab)[later])) {
+                dependents[earlier].push_back(later);
+                pending[later]++;
+            }
+        }
+    }
+
+    std::mutex lock;
+    std::condition_variable ready_cv;
+    std::vector<size_t> ready;
+    size_t finished = 0;
+    // Mount points already mounted by an earlier alternate entry.
+    std::vector<std::string> mounted_points;
+    bool all_mounted_ok = true;
+
+    for (size_t i = 0; i < count; i++) {
+        if (pending[i] == 0) ready.push_back(i);
+    }
+
+    auto worker = [&]() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            if (ready.empty()) {
+                if (finished == count) return;
+                ready_cv.wait(guard, [&]() { return !ready.empty() || finished == count; });
+                continue;
+            }
+            const size_t index = ready.back();
+            ready.pop_back();
+
+            FstabEntry* entry = &(*fstab)[index];
+            MountAttempt* attempt = &result.attempts[index];
+            attempt->mount_point = entry->mount_point;
+            attempt->blk_device = entry->blk_device;
+
+            bool skip = false;
+            for (const auto& mounted : mounted_points) {
+                if (mounted == entry->mount_point) {
+                    skip = true;
+                    break;
+                }
+            }
+
+            if (!skip) {
+                guard.unlock();
+                attempt->attempted = true;
+                if (config.fsck && entry->fs_mgr_flags.check) {
+                    const auto fsck_start = std::chrono::steady_clock::now();
+                    const bool fsck_ok = config.fsck(entry);
+                    attempt->fsck_duration =
+                            std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    std::chrono::steady_clock::now() - fsck_start);
+                    if (!fsck_ok) attempt->code = FS_MGR_DOMNT_FAILED;
+                }
+                if (attempt->code == FS_MGR_DOMNT_SUCCESS) {
+                    const auto mount_start = std::chrono::steady_clock::now();
+                    attempt->code = config.mount_one(entry);
+                    attempt->mount_duration =
+                            std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    std::chrono::steady_clock::now() - mount_start);
+                }
+                guard.lock();
+                if (attempt->code == FS_MGR_DOMNT_SUCCESS) {
+                    mounted_points.push_back(entry->mount_point);
+                }
+            }
+
+            finished++;
+            for (size_t dependent : dependents[index]) {
+                if (--pending[dependent] == 0) ready.push_back(dependent);
+            }
+            // Wake everyone: either new work is ready or we are done.
+            ready_cv.notify_all();
+        }
+    };
+
+    size_t concurrency = config.max_concurrency;
+    if (concurrency == 0) {
+        concurrency = std::thread::hardware_concurrency();
+        if (concurrency == 0) concurrency = 1;
+    }
+    if (concurrency > count) concurrency = count;
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < concurrency; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    // A mount point failed only if no entry mounted it.
+    for (size_t i = 0; i < count; i++) {
+        const MountAttempt& attempt = result.attempts[i];
+        if (attempt.code == FS_MGR_DOMNT_SUCCESS) continue;
+        bool alternate_mounted = false;
+        for (const auto& mounted : mounted_points) {
+            if (mounted == attempt.mount_point) {
+                alternate_mounted = true;
+                break;
+            }
+        }
+        if (!alternate_mounted) all_mounted_ok = false;
+    }
+    if (!all_mounted_ok) result.code = FS_MGR_MNTALL_FAIL;
+    return result;
+}
+
+}  // namespace fs_mgr
+}  // namespace android
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NATIVE_HANDLE_POOL_H_
+#define NATIVE_HANDLE_POOL_H_
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/cdefs.h>
+#include <unistd.h>
+
+#include <cutils/native_handle.h>
+
+__BEGIN_DECLS
+
+/*
+ * A recycling allocator for native_handle_t.
+ *
+ * High-rate buffer pipelines (camera, codecs) clone small fixed-shape
+ * handles hundreds of times per second; the malloc/free pair per handle is
+ * visible in traces even though the handles are all the same size. A pool
+ * caches returned handle allocations in a fixed array of lock-free slots so
+ * the steady state is an atomic exchange instead of a heap round trip.
+ *
+ * Every handle created by the pool is allocated with room for
+ * NATIVE_HANDLE_POOL_MAX_DATA data ints regardless of the requested shape,
+ * which is what makes recycling across shapes safe. Handles whose shape
+ * exceeds that fall back to plain malloc and are never cached. Only handles
+ * obtained from the same pool may be passed to native_handle_pool_delete();
+ * handles from native_handle_create() do not carry the pooled capacity.
+ *
+ * All operations are thread-safe and lock-free. The pool performs no fd
+ * operations except in native_handle_pool_clone().
+ */
+
+/* Cached allocations hold numFds + numInts up to this many ints; covers the
+ * gralloc/gralloc-metadata shapes that dominate handle churn. */
+#define NATIVE_HANDLE_POOL_MAX_DATA 16
+
+/* Upper bound on cached allocations; beyond this, deletes free as usual. */
+#define NATIVE_HANDLE_POOL_SLOTS 32
+
+typedef struct native_handle_pool {
+    /* Cached allocations; NULL means empty. Ownership transfers with the
+     * pointer, so a plain atomic exchange on a slot is race-free. */
+    _Atomic(native_handle_t*) slots[NATIVE_HANDLE_POOL_SLOTS];
+
+    /* Telemetry; read with native_handle_pool_get_stats(). */
+    atomic_uint_fast64_t creates;      /* successful create/clone calls */
+    atomic_uint_fast64_t recycles;     /* creates served from the cache */
+    atomic_uint_fast64_t returns;      /* deletes cached for reuse */
+    atomic_uint_fast64_t dup_failures; /* clones aborted by a failed dup */
+} native_handle_pool_t;
+
+typedef struct native_handle_pool_stats {
+    uint64_t creates;
+    uint64_t recycles;
+    uint64_t returns;
+    uint64_t dup_failures;
+} native_handle_pool_stats_t;
+
+#define NATIVE_HANDLE_POOL_INIT {0}
+
+static inline void native_handle_pool_init(native_handle_pool_t* pool) {
+    memset(pool, 0, sizeof(*pool));
+}
+
+/*
+ * native_handle_pool_dup_array
+ *
+ * Duplicates count file descriptors from src into dst as one batch with
+ * CLOEXEC set, the way binder and socket transports rematerialize a
+ * received fd array. On failure no fds are leaked: descriptors already
+ * duplicated are closed, and the negative errno of the failing dup is
+ * returned. Returns 0 on success.
+ */
+static inline int native_handle_pool_dup_array(const int* src, int* dst, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = fcntl(src[i], F_DUPFD_CLOEXEC, 0);
+        if (dst[i] < 0) {
+            int ret = -errno;
+            while (i-- > 0) {
+                close(dst[i]);
+            }
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/*
+ * native_handle_pool_create
+ *
+ * Pool-backed equivalent of native_handle_create(). Must be destroyed with
+ * native_handle_pool_delete() on the same pool. Shape limits match
+ * native_handle_create(). Returns NULL on bad arguments or allocation
+ * failure.
+ */
+static inline native_handle_t* native_handle_pool_create(native_handle_pool_t* pool, int numFds,
+                                                         int numInts) {
+    if (numFds < 0 || numInts < 0 || numFds > NATIVE_HANDLE_MAX_FDS ||
+        numInts > NATIVE_HANDLE_MAX_INTS) {
+        return NULL;
+    }
+
+    native_handle_t* h = NULL;
+    if (numFds + numInts <= NATIVE_HANDLE_POOL_MAX_DATA) {
+        for (size_t i = 0; i < NATIVE_HANDLE_POOL_SLOTS; i++) {
+            h = atomic_exchange_explicit(&pool->slots[i], NULL, memory_order_acquire);
+            if (h != NULL) {
+                atomic_fetch_add_explicit(&pool->recycles, 1, memory_order_relaxed);
+                break;
+            }
+        }
+        if (h == NULL) {
+            /* Pooled capacity, so the allocation is recyclable later. */
+            h = (native_handle_t*)malloc(sizeof(native_handle_t) +
+                                         sizeof(int) * NATIVE_HANDLE_POOL_MAX_DATA);
+        }
+    } else {
+        h = (native_handle_t*)malloc(sizeof(native_handle_t) + sizeof(int) * (numFds + numInts));
+    }
+    if (h == NULL) {
+        return NULL;
+    }
+    h->version = sizeof(native_handle_t);
+    h->numFds = numFds;
+    h->numInts = numInts;
+    atomic_fetch_add_explicit(&pool->creates, 1, memory_order_relaxed);
+    return h;
+}
+
+/*
+ * native_handle_pool_delete
+ *
+ * Returns a handle obtained from native_handle_pool_create() or
+ * native_handle_pool_clone() on this pool. Like native_handle_delete(),
+ * this releases only the memory; close fds first with
+ * native_handle_close(). Returns 0 on success.
+ */
+static inline int native_handle_pool_delete(native_handle_pool_t* pool, native_handle_t* h) {
+    if (h == NULL) {
+        return 0;
+    }
+    if (h->version != sizeof(native_handle_t)) {
+        return -EINVAL;
+    }
+    if (h->numFds + h->numInts <= NATIVE_HANDLE_POOL_MAX_DATA) {
+        for (size_t i = 0; i < NATIVE_HANDLE_POOL_SLOTS; i++) {
+            native_handle_t* expected = NULL;
+            if (atomic_compare_exchange_strong_explicit(&pool->slots[i], &expected, h,
+                                                        memory_order_release,
+                                                        memory_order_relaxed)) {
+                atomic_fetch_add_explicit(&pool->returns, 1, memory_order_relaxed);
+                return 0;
+            }
+        }
+    }
+    free(h);
+    return 0;
+}
+
+/*
+ * native_handle_pool_clone
+ *
+ * Pool-backed equivalent of native_handle_clone(): allocates from the pool
+ * and duplicates all fds through native_handle_pool_dup_array(). On any dup
+ * failure the partially built handle is returned to the pool with no fds
+ * leaked, errno is left set by the failing dup, and NULL is returned. Must
+ * be destroyed with native_handle_pool_delete() on the same pool.
+ */
+static inline native_handle_t* native_handle_pool_clone(native_handle_pool_t* pool,
+                                                        const native_handle_t* handle) {
+    native_handle_t* clone = native_handle_pool_create(pool, handle->numFds, handle->numInts);
+    if (clone == NULL) {
+        return NULL;
+    }
+    int ret = native_handle_pool_dup_array(handle->data, clone->data, handle->numFds);
+    if (ret != 0) {
+        atomic_fetch_add_explicit(&pool->dup_failures, 1, memory_order_relaxed);
+        native_handle_pool_delete(pool, clone);
+        errno = -ret;
+        return NULL;
+    }
+    memcpy(clone->data + handle->numFds, handle->data + handle->numFds,
+           sizeof(int) * handle->numInts);
+    return clone;
+}
+
+/*
+ * native_handle_pool_drain
+ *
+ * Frees every cached allocation. Call when the pipeline that owned the pool
+ * shuts down; the pool remains usable afterwards.
+ */
+static inline void native_handle_pool_drain(native_handle_pool_t* pool) {
+    for (size_t i = 0; i < NATIVE_HANDLE_POOL_SLOTS; i++) {
+        native_handle_t* h = atomic_exchange_explicit(&pool->slots[i], NULL, memory_order_acquire);
+        free(h);
+    }
+}
+
+static inline void native_handle_pool_get_stats(const native_handle_pool_t* pool,
+                                                native_handle_pool_stats_t* stats) {
+    stats->creates = atomic_load_explicit(&pool->creates, memory_order_relaxed);
+    stats->recycles = atomic_load_explicit(&pool->recycles, memory_order_relaxed);
+    stats->returns = atomic_load_explicit(&pool->returns, memory_order_relaxed);
+    stats->dup_failures = atomic_load_explicit(&pool->dup_failures, memory_order_relaxed);
+}
+
+__END_DECLS
+
+#endif /* NATIVE_HANDLE_POOL_H_ */
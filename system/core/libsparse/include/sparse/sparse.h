@@ -165,6 +165,28 @@ int sparse_file_add_fd(struct sparse_file* s, int fd, int64_t file_offset, uint6
 int sparse_file_write(struct sparse_file *s, int fd, bool gz, bool sparse,
 		bool crc);
 
+/**
+ * sparse_file_write_pipelined - write a sparse file using worker threads
+ *
+ * @s - sparse file cookie
+ * @fd - file descriptor to write to
+ * @gz - write a gzipped file
+ * @sparse - write in the Android sparse file format
+ * @crc - append a crc chunk
+ * @depth - chunks in flight per pipeline stage, 0 for a default
+ *
+ * Same output as sparse_file_write(), but chunk CRC computation,
+ * compression and the output write run as separate pipeline stages on
+ * worker threads, bounded to 'depth' chunks in flight per stage.  Chunks
+ * are written in order.  Worthwhile when gz or crc is set, or when the
+ * output fd is slow; with neither set it degenerates to an extra copy
+ * handoff and sparse_file_write() should be used instead.
+ *
+ * Returns 0 on success, negative errno on error.
+ */
+int sparse_file_write_pipelined(struct sparse_file *s, int fd, bool gz, bool sparse,
+		bool crc, unsigned int depth);
+
 /**
  * sparse_file_len - return the length of a sparse file if written to disk
  *
@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "sparse_pipeline.h"
+
+struct pipeline_queue {
+	void **jobs;
+	unsigned int capacity;
+	unsigned int head;
+	unsigned int count;
+	bool closed;
+	pthread_mutex_t lock;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+};
+
+struct pipeline_stage {
+	struct sparse_pipeline *pipeline;
+	sparse_pipeline_work_fn work;
+	void *work_priv;
+	struct pipeline_queue in;
+	pthread_t thread;
+};
+
+struct sparse_pipeline {
+	unsigned int num_stages;
+	struct pipeline_stage *stages;
+	sparse_pipeline_done_fn done;
+	void *done_priv;
+
+	/* First error any stage reported; later jobs are passed through. */
+	int error;
+	pthread_mutex_t error_lock;
+};
+
+static int queue_init(struct pipeline_queue *queue, unsigned int capacity)
+{
+	queue->jobs = calloc(capacity, sizeof(void *));
+	if (!queue->jobs) {
+		return -ENOMEM;
+	}
+	queue->capacity = capacity;
+	queue->head = 0;
+	queue->count = 0;
+	queue->closed = false;
+	pthread_mutex_init(&queue->lock, NULL);
+	pthread_cond_init(&queue->not_empty, NULL);
+	pthread_cond_init(&queue->not_full, NULL);
+	return 0;
+}
+
+static void queue_destroy(struct pipeline_queue *queue)
+{
+	free(queue->jobs);
+	pthread_mutex_destroy(&queue->lock);
+	pthread_cond_destroy(&queue->not_empty);
+	pthread_cond_destroy(&queue->not_full);
+}
+
+static void queue_push(struct pipeline_queue *queue, void *job)
+{
+	pthread_mutex_lock(&queue->lock);
+	while (queue->count == queue->capacity) {
+		pthread_cond_wait(&queue->not_full, &queue->lock);
+	}
+	queue->jobs[(queue->head + queue->count) % queue->capacity] = job;
+	queue->count++;
+	pthread_cond_signal(&queue->not_empty);
+	pthread_mutex_unlock(&queue->lock);
+}
+
+static void queue_close(struct pipeline_queue *queue)
+{
+	pthread_mutex_lock(&queue->lock);
+	queue->closed = true;
+	pthread_cond_signal(&queue->not_empty);
+	pthread_mutex_unlock(&queue->lock);
+}
+
+/* Returns false when the queue is closed and drained. */
+static bool queue_pop(struct pipeline_queue *queue, void **job)
+{
+	pthread_mutex_lock(&queue->lock);
+	while (queue->count == 0 && !queue->closed) {
+		pthread_cond_wait(&queue->not_empty, &queue->lock);
+	}
+	if (queue->count == 0) {
+		pthread_mutex_unlock(&queue->lock);
+		return false;
+	}
+	*job = queue->jobs[queue->head];
+	queue->head = (queue->head + 1) % queue->capacity;
+	queue->count--;
+	pthread_cond_signal(&queue->not_full);
+	pthread_mutex_unlock(&queue->lock);
+	return true;
+}
+
+static int pipeline_error(struct sparse_pipeline *pipeline)
+{
+	int error;
+
+	pthread_mutex_lock(&pipeline->error_lock);
+	error = pipeline->error;
+	pthread_mutex_unlock(&pipeline->error_lock);
+	return error;
+}
+
+static void pipeline_set_error(struct sparse_pipeline *pipeline, int error)
+{
+	pthread_mutex_lock(&pipeline->error_lock);
+	if (!pipeline->error) {
+		pipeline->error = error;
+	}
+	pthread_mutex_unlock(&pipeline->error_lock);
+}
+
+static void *stage_thread(void *cookie)
+{
+	struct pipeline_stage *stage = cookie;
+	struct sparse_pipeline *pipeline = stage->pipeline;
+	struct pipeline_stage *last = &pipeline->stages[pipeline->num_stages - 1];
+	void *job;
+
+	while (queue_pop(&stage->in, &job)) {
+		int error = pipeline_error(pipeline);
+
+		if (!error) {
+			error = stage->work(stage->work_priv, job);
+			if (error) {
+				pipeline_set_error(pipeline, error);
+			}
+		}
+
+		if (stage != last) {
+			queue_push(&(stage + 1)->in, job);
+		} else if (pipeline->done) {
+			pipeline->done(pipeline->done_priv, job, pipeline_error(pipeline));
+		}
+	}
+
+	if (stage != last) {
+		queue_close(&(stage + 1)->in);
+	}
+	return NULL;
+}
+
+struct sparse_pipeline *sparse_pipeline_new(unsigned int depth, unsigned int num_stages,
+					    const sparse_pipeline_work_fn *work,
+					    void *const *work_priv, sparse_pipeline_done_fn done,
+					    void *done_priv)
+{
+	struct sparse_pipeline *pipeline;
+	unsigned int i;
+
+	if (depth == 0 || num_stages == 0) {
+		return NULL;
+	}
+
+	pipeline = calloc(1, sizeof(*pipeline));
+	if (!pipeline) {
+		return NULL;
+	}
+	pipeline->stages = calloc(num_stages, sizeof(*pipeline->stages));
+	if (!pipeline->stages) {
+		free(pipeline);
+		return NULL;
+	}
+	pipeline->num_stages = num_stages;
+	pipeline->done = done;
+	pipeline->done_priv = done_priv;
+	pthread_mutex_init(&pipeline->error_lock, NULL);
+
+	for (i = 0; i < num_stages; i++) {
+		struct pipeline_stage *stage = &pipeline->stages[i];
+
+		stage->pipeline = pipeline;
+		stage->work = work[i];
+		stage->work_priv = work_priv[i];
+		if (queue_init(&stage->in, depth)) {
+			goto err_queues;
+		}
+	}
+
+	for (i = 0; i < num_stages; i++) {
+		if (pthread_create(&pipeline->stages[i].thread, NULL, stage_thread,
+				   &pipeline->stages[i])) {
+			unsigned int started = i;
+
+			/* Unwind: close the first queue and join what started. */
+			queue_close(&pipeline->stages[0].in);
+			for (i = 0; i < started; i++) {
+				pthread_join(pipeline->stages[i].thread, NULL);
+			}
+			i = num_stages;
+			goto err_queues;
+		}
+	}
+
+	return pipeline;
+
+err_queues:
+	while (i-- > 0) {
+		queue_destroy(&pipeline->stages[i].in);
+	}
+	pthread_mutex_destroy(&pipeline->error_lock);
+	free(pipeline->stages);
+	free(pipeline);
+	return NULL;
+}
+
+int sparse_pipeline_submit(struct sparse_pipeline *pipeline, void *job)
+{
+	queue_push(&pipeline->stages[0].in, job);
+	return pipeline_error(pipeline);
+}
+
+int sparse_pipeline_finish(struct sparse_pipeline *pipeline)
+{
+	unsigned int i;
+	int error;
+
+	queue_close(&pipeline->stages[0].in);
+	for (i = 0; i < pipeline->num_stages; i++) {
+		pthread_join(pipeline->stages[i].thread, NULL);
+	}
+	error = pipeline->error;
+	for (i = 0; i < pipeline->num_stages; i++) {
+		queue_destroy(&pipeline->stages[i].in);
+	}
+	pthread_mutex_destroy(&pipeline->error_lock);
+	free(pipeline->stages);
+	free(pipeline);
+	return error;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _LIBSPARSE_SPARSE_PIPELINE_H_
+#define _LIBSPARSE_SPARSE_PIPELINE_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A fixed pipeline of worker threads connected by bounded queues, used by
+ * sparse_file_write_pipelined() to overlap chunk CRC computation,
+ * compression and output writes on separate cores.
+ *
+ * Each stage runs on its own thread and processes jobs strictly in
+ * submission order, so the output stage sees chunks in file order without
+ * any reordering logic.  The queues are bounded, which caps the number of
+ * chunk buffers in flight; when they are full, submit blocks, which is the
+ * backpressure that keeps memory use constant for multi-GB images.
+ *
+ * Once any stage fails, its error sticks: later jobs are passed through
+ * without being processed and their done callback receives the sticky
+ * error, so every submitted job is released exactly once.
+ */
+
+struct sparse_pipeline;
+
+/*
+ * Processes one job in a stage.  Returns 0 on success, negative errno on
+ * error.
+ */
+typedef int (*sparse_pipeline_work_fn)(void *priv, void *job);
+
+/*
+ * Called once per submitted job after it has left the last stage, in
+ * submission order, with 0 or the sticky error.  Runs on the last stage's
+ * thread; this is where chunk buffers are released.
+ */
+typedef void (*sparse_pipeline_done_fn)(void *priv, void *job, int status);
+
+/*
+ * sparse_pipeline_new - create a pipeline
+ *
+ * @depth - capacity of each inter-stage queue (jobs in flight per stage)
+ * @num_stages - number of worker stages
+ * @work - array of num_stages stage functions
+ * @work_priv - array of num_stages private pointers, one per stage
+ * @done - completion callback, may be NULL
+ * @done_priv - private pointer for done
+ *
+ * Returns the pipeline, or NULL on error.
+ */
+struct sparse_pipeline *sparse_pipeline_new(unsigned int depth, unsigned int num_stages,
+					    const sparse_pipeline_work_fn *work,
+					    void *const *work_priv, sparse_pipeline_done_fn done,
+					    void *done_priv);
+
+/*
+ * sparse_pipeline_submit - feed one job into the first stage
+ *
+ * Blocks while the first queue is full.  Returns 0, or the pipeline's
+ * sticky error; on error the job is still carried through to done.
+ */
+int sparse_pipeline_submit(struct sparse_pipeline *pipeline, void *job);
+
+/*
+ * sparse_pipeline_finish - drain, join and destroy the pipeline
+ *
+ * Waits until every submitted job has completed, joins the stage threads
+ * and frees the pipeline.  Returns 0, or the first error any stage
+ * reported.
+ */
+int sparse_pipeline_finish(struct sparse_pipeline *pipeline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_UTILS_BIASED_REF_BASE_H
+#define ANDROID_UTILS_BIASED_REF_BASE_H
+
+#include <atomic>
+#include <stdint.h>
+
+#include "utils/LightRefBase.h"  // LightRefBase_reportIncStrongRequireStrongFailed
+
+namespace android {
+
+/*
+ * A reference-counted base class for sp<> with per-thread biased counting,
+ * for objects whose sp<>s churn heavily on a few known threads — e.g. a
+ * buffer handed along a multi-stage pipeline, where every stage copies and
+ * drops sp<>s and the refcount cache line ping-pongs between cores.
+ *
+ * Like LightRefBase this supports strong references only; classes that need
+ * weak references (wp<>, OBJECT_LIFETIME_WEAK) keep using RefBase. The
+ * difference is the Bias scope: while a thread holds a Bias on an object,
+ * that thread's incStrong/decStrong pairs are absorbed into a thread-local
+ * delta with no atomic operation at all, and the delta is reconciled with the
+ * shared count in one atomic when the scope exits. A stage that processes an
+ * object under a Bias therefore touches the shared count twice per scope
+ * instead of twice per sp<> copy:
+ *
+ *     void processFrame(const sp<Frame>& frame) {
+ *         Frame::Bias bias(frame.get());
+ *         // sp<Frame> copies and drops on this thread are now free.
+ *         ...
+ *     }
+ *
+ * The Bias holds one real reference, so the object cannot be destroyed while
+ * any Bias on it is live even if the shared count transiently drains (an
+ * sp<> copied under the bias may legally be released on another thread; the
+ * shared count then under-reports until the bias flushes). Destruction
+ * happens on the one release that observes both the count and the number of
+ * live Bias scopes at zero; the two are packed into a single atomic word so
+ * that check is race-free.
+ *
+ * A Bias must be destroyed on the thread that created it, and must be
+ * created while the caller already holds a strong reference. Each thread can
+ * hold a small fixed number of Bias scopes at once; beyond that a Bias
+ * silently degrades to a no-op and sp<> ops take the normal atomic path.
+ */
+template <class T>
+class BiasedRefBase {
+    struct BiasEntry;
+
+  public:
+    inline BiasedRefBase() : mState(0) {}
+
+    inline void incStrong(__attribute__((unused)) const void* id) const {
+        BiasEntry* const entry = findEntry(this);
+        if (entry != nullptr) {
+            entry->delta++;
+            return;
+        }
+        mState.fetch_add(kCountOne, std::memory_order_relaxed);
+    }
+
+    inline void incStrongRequireStrong(__attribute__((unused)) const void* id) const {
+        BiasEntry* const entry = findEntry(this);
+        if (entry != nullptr) {
+            // The bias pins one real reference, so the object is provably
+            // alive here.
+            entry->delta++;
+            return;
+        }
+        const uint64_t prior = mState.fetch_add(kCountOne, std::memory_order_relaxed);
+        // A drained count still proves liveness while a Bias scope pins the
+        // object on some other thread.
+        if (countOf(prior) <= 0 && biasesOf(prior) == 0) {
+            LightRefBase_reportIncStrongRequireStrongFailed(this);
+        }
+    }
+
+    inline void decStrong(__attribute__((unused)) const void* id) const {
+        BiasEntry* const entry = findEntry(this);
+        if (entry != nullptr && entry->delta > 0) {
+            entry->delta--;
+            return;
+        }
+        adjustAndMaybeDestroy(-kCountOne);
+    }
+
+    //! DEBUGGING ONLY: the shared count, which under-reports by the deltas
+    //! of any live Bias scopes.
+    inline int32_t getStrongCount() const {
+        return countOf(mState.load(std::memory_order_relaxed));
+    }
+
+    /*
+     * Marks this thread as a high-churn user of one object for the lifetime
+     * of the scope; see the class comment. Create on the stack only.
+     */
+    class Bias {
+      public:
+        explicit Bias(const T* object)
+            : mObject(object), mEntry(claimEntry(object)) {
+            if (mEntry != nullptr) {
+                // One increment for the Bias scope itself and one pinned
+                // reference, in a single atomic.
+                object->mState.fetch_add(kBiasOne + kCountOne, std::memory_order_relaxed);
+            }
+        }
+
+        ~Bias() {
+            if (mEntry == nullptr) {
+                return;
+            }
+            const uint64_t delta = mEntry->delta;
+            mEntry->object = nullptr;
+            mEntry->delta = 0;
+            // Flush the withheld increments, drop the pin and retire the
+            // Bias scope in one atomic, so a concurrent release on another
+            // thread either sees the scope still live (and defers to it) or
+            // sees the fully reconciled count.
+            mObject->adjustAndMaybeDestroy(delta - kCountOne - kBiasOne);
+        }
+
+      private:
+        const BiasedRefBase<T>* const mObject;
+        BiasEntry* const mEntry;
+
+        Bias(const Bias&) = delete;
+        Bias& operator=(const Bias&) = delete;
+    };
+
+  protected:
+    inline ~BiasedRefBase() {}
+
+  private:
+    struct BiasEntry {
+        const void* object;
+        uint32_t delta;  // increments withheld from the shared count
+    };
+
+    friend class ReferenceMover;
+    inline static void renameRefs(size_t /*n*/, const ReferenceRenamer& /*renamer*/) {}
+    inline static void renameRefId(T* /*ref*/, const void* /*old_id*/, const void* /*new_id*/) {}
+
+    /*
+     * mState packs the count of live Bias scopes (high 32 bits) above the
+     * shared strong count (low 32 bits, signed: it can dip below zero while
+     * a reference counted in a bias delta is released on another thread).
+     * A borrow out of a negative count is undone when the flush carries back
+     * in, so the fields are decoded together below.
+     */
+    static constexpr uint64_t kCountOne = 1;
+    static constexpr uint64_t kBiasOne = 1ULL << 32;
+
+    static int32_t countOf(uint64_t state) {
+        return static_cast<int32_t>(state & 0xffffffffu);
+    }
+
+    static int32_t biasesOf(uint64_t state) {
+        int32_t biases = static_cast<int32_t>(state >> 32);
+        if (countOf(state) < 0) {
+            biases++;  // a negative count borrowed from the bias field
+        }
+        return biases;
+    }
+
+    /*
+     * Applies a signed adjustment (in two's complement) to mState and
+     * destroys the object on the one transition that leaves no references
+     * and no live Bias scopes.
+     */
+    void adjustAndMaybeDestroy(uint64_t adjust) const {
+        const uint64_t state = mState.fetch_add(adjust, std::memory_order_release) + adjust;
+        if (countOf(state) == 0 && biasesOf(state) == 0) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            delete static_cast<const T*>(this);
+        }
+    }
+
+    static constexpr size_t kMaxBiasesPerThread = 8;
+
+    static BiasEntry* tlsEntries() {
+        static thread_local BiasEntry entries[kMaxBiasesPerThread] = {};
+        return entries;
+    }
+
+    static BiasEntry* findEntry(const void* object) {
+        BiasEntry* const entries = tlsEntries();
+        for (size_t i = 0; i < kMaxBiasesPerThread; i++) {
+            if (entries[i].object == object) {
+                return &entries[i];
+            }
+        }
+        return nullptr;
+    }
+
+    static BiasEntry* claimEntry(const void* object) {
+        BiasEntry* const entries = tlsEntries();
+        for (size_t i = 0; i < kMaxBiasesPerThread; i++) {
+            if (entries[i].object == nullptr) {
+                entries[i].object = object;
+                entries[i].delta = 0;
+                return &entries[i];
+            }
+        }
+        return nullptr;  // table full: the Bias degrades to a no-op
+    }
+
+    mutable std::atomic<uint64_t> mState;
+};
+
+}  // namespace android
+
+#endif  // ANDROID_UTILS_BIASED_REF_BASE_H
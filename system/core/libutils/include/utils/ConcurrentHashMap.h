@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_UTILS_CONCURRENT_HASH_MAP_H
+#define ANDROID_UTILS_CONCURRENT_HASH_MAP_H
+
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "utils/Mutex.h"
+#include "utils/TypeHelpers.h"  // hash_t
+
+namespace android {
+
+/*
+ * A hash map for registries that are read and written from several threads,
+ * as an alternative to guarding a KeyedVector with one big lock. The table is
+ * split into a fixed number of stripes, each with its own lock and its own
+ * open-addressing (linear probing) table, so operations on different keys
+ * mostly proceed in parallel and insertion never memmoves the whole map the
+ * way the sorted KeyedVector does.
+ *
+ * Consistency model: each operation is atomic with respect to its key.
+ * size() and snapshot() lock one stripe at a time, so they observe every
+ * entry that was present for the whole call but are not a point-in-time view
+ * of the map as a whole; iterate over the snapshot() copy rather than holding
+ * any lock.
+ *
+ * TKey and TValue must be default constructible and copyable, and a hash_type
+ * overload must exist for TKey (see TypeHelpers.h).
+ */
+template <typename TKey, typename TValue>
+class ConcurrentHashMap {
+  public:
+    ConcurrentHashMap() {}
+
+    size_t size() const {
+        size_t total = 0;
+        for (size_t s = 0; s < kStripeCount; s++) {
+            AutoMutex _l(mStripes[s].lock);
+            total += mStripes[s].count;
+        }
+        return total;
+    }
+
+    bool isEmpty() const { return size() == 0; }
+
+    /* Returns true and copies the value to *outValue if the key is present. */
+    bool get(const TKey& key, TValue* outValue) const {
+        const hash_t hash = mix(hash_type(key));
+        const Stripe& stripe = stripeFor(hash);
+        AutoMutex _l(stripe.lock);
+        const ssize_t slot = find(stripe, hash, key);
+        if (slot < 0) {
+            return false;
+        }
+        *outValue = stripe.slots[slot].value;
+        return true;
+    }
+
+    /* Returns the value for the key, or a default constructed value. */
+    TValue valueFor(const TKey& key) const {
+        TValue value{};
+        get(key, &value);
+        return value;
+    }
+
+    /* Adds or replaces the entry. Returns true if the key was not present. */
+    bool put(const TKey& key, const TValue& value) {
+        const hash_t hash = mix(hash_type(key));
+        Stripe& stripe = stripeFor(hash);
+        AutoMutex _l(stripe.lock);
+        const ssize_t slot = find(stripe, hash, key);
+        if (slot >= 0) {
+            stripe.slots[slot].value = value;
+            return false;
+        }
+        insert(stripe, hash, key, value);
+        return true;
+    }
+
+    /* Adds the entry only if the key is not present. Returns true if added. */
+    bool putIfAbsent(const TKey& key, const TValue& value) {
+        const hash_t hash = mix(hash_type(key));
+        Stripe& stripe = stripeFor(hash);
+        AutoMutex _l(stripe.lock);
+        if (find(stripe, hash, key) >= 0) {
+            return false;
+        }
+        insert(stripe, hash, key, value);
+        return true;
+    }
+
+    /*
+     * Returns the value for the key, calling creator() and inserting its
+     * result first if the key is not present. The creator runs under the
+     * stripe lock and must not reenter the map.
+     */
+    template <typename Creator>
+    TValue getOrCreate(const TKey& key, const Creator& creator) {
+        const hash_t hash = mix(hash_type(key));
+        Stripe& stripe = stripeFor(hash);
+        AutoMutex _l(stripe.lock);
+        const ssize_t slot = find(stripe, hash, key);
+        if (slot >= 0) {
+            return stripe.slots[slot].value;
+        }
+        TValue value = creator();
+        insert(stripe, hash, key, value);
+        return value;
+    }
+
+    /* Removes the entry if present. Returns true if it was removed. */
+    bool remove(const TKey& key) {
+        return removeIf(key, [](const TValue&) { return true; });
+    }
+
+    /*
+     * Removes the entry only if the predicate accepts the stored value, e.g.
+     * to remove an entry only when it still refers to the caller. The
+     * predicate runs under the stripe lock and must not reenter the map.
+     */
+    template <typename Predicate>
+    bool removeIf(const TKey& key, const Predicate& predicate) {
+        const hash_t hash = mix(hash_type(key));
+        Stripe& stripe = stripeFor(hash);
+        AutoMutex _l(stripe.lock);
+        const ssize_t slot = find(stripe, hash, key);
+        if (slot < 0 || !predicate(stripe.slots[slot].value)) {
+            return false;
+        }
+        stripe.slots[slot].state = kTombstone;
+        stripe.slots[slot].value = TValue{};
+        stripe.count--;
+        return true;
+    }
+
+    void clear() {
+        for (size_t s = 0; s < kStripeCount; s++) {
+            AutoMutex _l(mStripes[s].lock);
+            mStripes[s].slots.clear();
+            mStripes[s].count = 0;
+            mStripes[s].used = 0;
+        }
+    }
+
+    /*
+     * Copies the entries into a vector that can be iterated without holding
+     * any lock. See the class comment for the consistency this provides.
+     */
+    std::vector<std::pair<TKey, TValue>> snapshot() const {
+        std::vector<std::pair<TKey, TValue>> entries;
+        entries.reserve(size());
+        for (size_t s = 0; s < kStripeCount; s++) {
+            const Stripe& stripe = mStripes[s];
+            AutoMutex _l(stripe.lock);
+            for (const Slot& slot : stripe.slots) {
+                if (slot.state == kOccupied) {
+                    entries.emplace_back(slot.key, slot.value);
+                }
+            }
+        }
+        return entries;
+    }
+
+  private:
+    static constexpr size_t kStripeCount = 16;
+    static constexpr size_t kInitialStripeCapacity = 8;
+
+    enum State : uint8_t {
+        kEmpty = 0,
+        kOccupied,
+        kTombstone,
+    };
+
+    struct Slot {
+        TKey key{};
+        TValue value{};
+        State state = kEmpty;
+    };
+
+    struct Stripe {
+        mutable Mutex lock;
+        std::vector<Slot> slots;
+        size_t count = 0;  // occupied slots
+        size_t used = 0;   // occupied slots plus tombstones
+    };
+
+    /*
+     * hash_type() is the identity for integral keys, so scramble it before
+     * splitting it between the stripe choice and the table index.
+     */
+    static hash_t mix(hash_t h) {
+        h ^= h >> 16;
+        h *= 0x85ebca6b;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35;
+        h ^= h >> 16;
+        return h;
+    }
+
+    const Stripe& stripeFor(hash_t hash) const {
+        // The table index below uses the low bits; pick the stripe from the
+        // high ones so the two don't correlate.
+        return mStripes[(hash >> 27) % kStripeCount];
+    }
+
+    Stripe& stripeFor(hash_t hash) {
+        return mStripes[(hash >> 27) % kStripeCount];
+    }
+
+    /* Returns the slot holding the key, or -1. Caller holds the stripe lock. */
+    static ssize_t find(const Stripe& stripe, hash_t hash, const TKey& key) {
+        if (stripe.slots.empty()) {
+            return -1;
+        }
+        const size_t mask = stripe.slots.size() - 1;
+        for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+            const Slot& slot = stripe.slots[i];
+            if (slot.state == kEmpty) {
+                return -1;
+            }
+            if (slot.state == kOccupied && slot.key == key) {
+                return i;
+            }
+        }
+    }
+
+    /* Inserts a key known to be absent. Caller holds the stripe lock. */
+    static void insert(Stripe& stripe, hash_t hash, const TKey& key, const TValue& value) {
+        // Grow at 3/4 load (counting tombstones) to keep probe runs short;
+        // rehashing also drops the tombstones.
+        if (stripe.slots.empty()) {
+            stripe.slots.resize(kInitialStripeCapacity);
+        } else if (stripe.used * 4 >= stripe.slots.size() * 3) {
+            std::vector<Slot> old;
+            old.swap(stripe.slots);
+            stripe.slots.resize(old.size() * 2);
+            stripe.used = stripe.count;
+            for (Slot& slot : old) {
+                if (slot.state == kOccupied) {
+                    place(stripe, mix(hash_type(slot.key)), std::move(slot));
+                }
+            }
+        }
+        Slot slot;
+        slot.key = key;
+        slot.value = value;
+        slot.state = kOccupied;
+        const bool reusedTombstone = place(stripe, hash, std::move(slot));
+        stripe.count++;
+        if (!reusedTombstone) {
+            // Reusing a tombstone leaves occupied-plus-tombstones unchanged,
+            // so only a genuinely fresh slot counts toward the load factor.
+            stripe.used++;
+        }
+    }
+
+    /*
+     * Puts the slot into the first free position of its probe sequence.
+     * Returns true if that position was a tombstone rather than empty.
+     */
+    static bool place(Stripe& stripe, hash_t hash, Slot&& slot) {
+        const size_t mask = stripe.slots.size() - 1;
+        size_t i = hash & mask;
+        while (stripe.slots[i].state == kOccupied) {
+            i = (i + 1) & mask;
+        }
+        const bool reusedTombstone = (stripe.slots[i].state == kTombstone);
+        stripe.slots[i] = std::move(slot);
+        return reusedTombstone;
+    }
+
+    Stripe mStripes[kStripeCount];
+
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+};
+
+}  // namespace android
+
+#endif  // ANDROID_UTILS_CONCURRENT_HASH_MAP_H
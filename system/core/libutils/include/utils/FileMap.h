@@ -30,6 +30,12 @@
 #include <winsock2.h>
 #endif
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <thread>
 #endif
 
 namespace android {
@@ -103,6 +109,35 @@ public:
      */
     int advise(MapAdvice advice);
 
+#if !defined(__MINGW32__)
+    /*
+     * Tell both the VM and the page cache that the map will be read
+     * sequentially and soon: madvise() makes faults read ahead aggressively
+     * and fadvise() on the originating fd (pass -1 if it is already closed)
+     * starts populating the page cache before the first fault.
+     *
+     * Returns 0 on success, -1 if any of the hints failed.
+     */
+    int readahead(int fd) const;
+
+    /*
+     * Ask the kernel to back the map with transparent huge pages, cutting
+     * the fault count ~512x on maps over 2MB. Only a hint: it has an effect
+     * only where the kernel supports THP for this mapping, and the benefit
+     * requires the map to span at least one aligned 2MB region.
+     *
+     * Returns 0 on success, -1 if unsupported or the hint failed.
+     */
+    int adviseHugePage() const;
+
+    /*
+     * Fault every page of the map in by touching it. Blocks until done, so
+     * call it from a background thread (see FileMapPrefaulter) when the
+     * point is to hide first-read latency.
+     */
+    void prefault() const;
+#endif
+
 protected:
 
 private:
@@ -124,6 +159,62 @@ private:
     static long mPageSize;
 };
 
+#if !defined(__MINGW32__)
+inline int FileMap::readahead(int fd) const {
+    int result = madvise(mBasePtr, mBaseLength, MADV_SEQUENTIAL);
+    result |= madvise(mBasePtr, mBaseLength, MADV_WILLNEED);
+    if (fd >= 0) {
+        // posix_fadvise() returns the error instead of setting errno.
+        if (posix_fadvise(fd, mDataOffset, mDataLength, POSIX_FADV_SEQUENTIAL) != 0) result = -1;
+        if (posix_fadvise(fd, mDataOffset, mDataLength, POSIX_FADV_WILLNEED) != 0) result = -1;
+    }
+    return result != 0 ? -1 : 0;
+}
+
+inline int FileMap::adviseHugePage() const {
+#if defined(MADV_HUGEPAGE)
+    return madvise(mBasePtr, mBaseLength, MADV_HUGEPAGE);
+#else
+    return -1;
+#endif
+}
+
+inline void FileMap::prefault() const {
+    const size_t pageSize = static_cast<size_t>(getpagesize());
+    const volatile char* data = static_cast<const volatile char*>(mDataPtr);
+    for (size_t offset = 0; offset < mDataLength; offset += pageSize) {
+        (void)data[offset];
+    }
+}
+
+/*
+ * Prefaults a FileMap on a background thread, so the map is (mostly) warm by
+ * the time the caller gets around to reading it. The destructor joins the
+ * thread; keep the prefaulter inside the lifetime of the map, e.g. declare
+ * it after the map on the stack.
+ */
+class FileMapPrefaulter {
+public:
+    explicit FileMapPrefaulter(const FileMap& map)
+        : mThread([&map]() { map.prefault(); }) {}
+
+    ~FileMapPrefaulter() { wait(); }
+
+    /* Blocks until the prefault pass is done. */
+    void wait() {
+        if (mThread.joinable()) {
+            mThread.join();
+        }
+    }
+
+private:
+    std::thread mThread;
+
+    FileMapPrefaulter(const FileMapPrefaulter&) = delete;
+    FileMapPrefaulter& operator=(const FileMapPrefaulter&) = delete;
+};
+#endif  // !defined(__MINGW32__)
+
 }  // namespace android
 
 #endif // __LIBS_FILE_MAP_H
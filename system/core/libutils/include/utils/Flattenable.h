@@ -141,6 +141,60 @@ inline status_t Flattenable<T>::unflatten(
     return static_cast<T*>(this)->T::unflatten(buffer, size, fds, count);
 }
 
+// DO NOT USE: please use parcelable instead
+// This code is deprecated and will not be supported via AIDL code gen. For data
+// to be sent over binder, please use parcelables.
+/*
+ * TriviallyFlattenable is an implementation of the Flattenable protocol for
+ * types whose in-memory representation is already the wire format: the whole
+ * object flattens with one memcpy instead of a per-field
+ * FlattenableUtils::write() chain. Derive from TriviallyFlattenable<Foo>
+ * instead of Flattenable<Foo> and implement nothing.
+ *
+ * The layout is validated at compile time: Foo must be trivially copyable
+ * and must have unique object representations, i.e. contain no padding —
+ * padding bytes would flatten uninitialized stack memory across the IPC
+ * boundary and break bytewise comparison of flattened images. Order or pad
+ * the fields explicitly to satisfy the assert. Types carrying file
+ * descriptors cannot use this (fds are not trivially copyable state); they
+ * implement Flattenable directly.
+ */
+template <typename T>
+class TriviallyFlattenable : public Flattenable<T> {
+public:
+    inline size_t getFlattenedSize() const {
+        validateLayout();
+        return sizeof(T);
+    }
+    inline size_t getFdCount() const {
+        return 0;
+    }
+    inline status_t flatten(void*& buffer, size_t& size, int*& /*fds*/, size_t& /*count*/) const {
+        validateLayout();
+        if (size < sizeof(T)) return NO_MEMORY;
+        memcpy(buffer, static_cast<T const*>(this), sizeof(T));
+        FlattenableUtils::advance(buffer, size, sizeof(T));
+        return OK;
+    }
+    inline status_t unflatten(void const*& buffer, size_t& size, int const*& /*fds*/,
+                              size_t& /*count*/) {
+        validateLayout();
+        if (size < sizeof(T)) return NO_MEMORY;
+        memcpy(static_cast<T*>(this), buffer, sizeof(T));
+        FlattenableUtils::advance(buffer, size, sizeof(T));
+        return OK;
+    }
+
+private:
+    static constexpr void validateLayout() {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "TriviallyFlattenable requires a trivially copyable type");
+        static_assert(std::has_unique_object_representations<T>::value,
+                      "TriviallyFlattenable requires a padding-free layout; "
+                      "order or pad the fields explicitly");
+    }
+};
+
 // DO NOT USE: please use parcelable instead
 // This code is deprecated and will not be supported via AIDL code gen. For data
 // to be sent over binder, please use parcelables.
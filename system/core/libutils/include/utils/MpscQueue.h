@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_UTILS_MPSC_QUEUE_H
+#define ANDROID_UTILS_MPSC_QUEUE_H
+
+#include <atomic>
+
+namespace android {
+
+/*
+ * An intrusive multi-producer single-consumer queue: any thread may push, one
+ * thread pops. push() is wait-free (one exchange), so producers never contend
+ * on a lock with each other or with the consumer — for e.g. binder threads
+ * posting messages to a loop that drains them.
+ *
+ * Embed a Node in the queued object; the object must stay alive until it is
+ * popped. pop() returns nodes in push order. It may transiently return null
+ * while a push on another thread is between its exchange and its store ("the
+ * queue is never observed empty unless it is"; a consumer that saw pushes
+ * happen-before the pop will receive them, possibly after a retry). Consumers
+ * pairing the queue with a wakeup (eventfd, pipe) get the usual semantics:
+ * drain until pop() returns null after the wakeup was consumed.
+ *
+ * This is the classic two-pointer MPSC design: producers swing mHead with an
+ * atomic exchange and then link the old head; the consumer follows next
+ * pointers from mTail through a stub node.
+ */
+class MpscQueue {
+  public:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+    };
+
+    MpscQueue() : mHead(&mStub), mTail(&mStub) {}
+
+    /* Enqueues the node. Safe from any thread. */
+    void push(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = mHead.exchange(node, std::memory_order_acq_rel);
+        // Between the exchange and this store the node is unreachable from
+        // the consumer; pop() reports that window as transiently empty.
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /*
+     * Dequeues the oldest node, or returns null if the queue is empty (or a
+     * producer is mid-push, see above). Must be called from one thread only.
+     */
+    Node* pop() {
+        Node* tail = mTail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &mStub) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            // Skip the stub to the first real node.
+            mTail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            mTail = next;
+            return tail;
+        }
+        if (mHead.load(std::memory_order_acquire) != tail) {
+            // A producer is between its exchange and its link store.
+            return nullptr;
+        }
+        // tail is the last node: push the stub back so tail's removal does
+        // not race a concurrent push appending behind it.
+        push(&mStub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            mTail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+  private:
+    std::atomic<Node*> mHead;
+    Node* mTail;  // consumer-owned
+    Node mStub;
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+};
+
+}  // namespace android
+
+#endif  // ANDROID_UTILS_MPSC_QUEUE_H
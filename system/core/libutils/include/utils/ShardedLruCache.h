@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_UTILS_SHARDED_LRU_CACHE_H
+#define ANDROID_UTILS_SHARDED_LRU_CACHE_H
+
+#include "utils/LruCache.h"
+#include "utils/Mutex.h"
+#include "utils/TypeHelpers.h"  // hash_t
+
+namespace android {
+
+/*
+ * A thread-safe LRU cache built from per-shard LruCaches, for the common case
+ * where a multi-threaded consumer would otherwise wrap one LruCache in one
+ * big mutex. Keys are distributed over the shards by hash; each shard has its
+ * own lock and its own LRU list, so lookups from different threads only
+ * contend when their keys land in the same shard. Eviction is per shard,
+ * which approximates global LRU order: each shard holds capacity/shards
+ * entries and evicts its own oldest.
+ *
+ * Unlike LruCache::get(), get() copies the value out, because a reference
+ * into a shard must not escape the shard lock. The removal listener is shared
+ * by all shards and is invoked with the shard lock held, so it must not call
+ * back into the cache.
+ *
+ * TValue must be copyable and constructible from 0 (the LruCache null value
+ * requirement); a hash_type overload must exist for TKey.
+ */
+template <typename TKey, typename TValue>
+class ShardedLruCache {
+  public:
+    /*
+     * Creates a cache holding at most maxCapacity entries in total,
+     * distributed over the shards. The capacity of each shard is rounded up,
+     * so up to kShardCount - 1 extra entries may be retained.
+     */
+    explicit ShardedLruCache(uint32_t maxCapacity) {
+        const uint32_t shardCapacity =
+                maxCapacity == LruCache<TKey, TValue>::kUnlimitedCapacity
+                        ? LruCache<TKey, TValue>::kUnlimitedCapacity
+                        : (maxCapacity + kShardCount - 1) / kShardCount;
+        for (size_t s = 0; s < kShardCount; s++) {
+            mShards[s].cache.reset(new LruCache<TKey, TValue>(shardCapacity));
+        }
+    }
+
+    void setOnEntryRemovedListener(OnEntryRemoved<TKey, TValue>* listener) {
+        for (size_t s = 0; s < kShardCount; s++) {
+            AutoMutex _l(mShards[s].lock);
+            mShards[s].cache->setOnEntryRemovedListener(listener);
+        }
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (size_t s = 0; s < kShardCount; s++) {
+            AutoMutex _l(mShards[s].lock);
+            total += mShards[s].cache->size();
+        }
+        return total;
+    }
+
+    /*
+     * Looks the key up, promotes the entry to most recently used and returns
+     * a copy of its value. Returns a copy of the null value (TValue(0)) on a
+     * miss, with the same miss/stored-null ambiguity LruCache::get() has.
+     */
+    TValue get(const TKey& key) {
+        Shard& shard = shardFor(key);
+        AutoMutex _l(shard.lock);
+        return shard.cache->get(key);
+    }
+
+    /*
+     * Adds the entry if the key is not already present. Returns true if
+     * added. The shard may evict its own oldest entry to make room.
+     */
+    bool put(const TKey& key, const TValue& value) {
+        Shard& shard = shardFor(key);
+        AutoMutex _l(shard.lock);
+        return shard.cache->put(key, value);
+    }
+
+    /* Removes the entry if present. Returns true if it was removed. */
+    bool remove(const TKey& key) {
+        Shard& shard = shardFor(key);
+        AutoMutex _l(shard.lock);
+        return shard.cache->remove(key);
+    }
+
+    void clear() {
+        for (size_t s = 0; s < kShardCount; s++) {
+            AutoMutex _l(mShards[s].lock);
+            mShards[s].cache->clear();
+        }
+    }
+
+  private:
+    static constexpr size_t kShardCount = 16;
+
+    struct Shard {
+        mutable Mutex lock;
+        std::unique_ptr<LruCache<TKey, TValue>> cache;
+    };
+
+    /*
+     * hash_type() is the identity for integral keys; scramble it so that
+     * sequential keys spread over the shards.
+     */
+    static hash_t mix(hash_t h) {
+        h ^= h >> 16;
+        h *= 0x85ebca6b;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35;
+        h ^= h >> 16;
+        return h;
+    }
+
+    Shard& shardFor(const TKey& key) {
+        return mShards[mix(hash_type(key)) % kShardCount];
+    }
+
+    Shard mShards[kShardCount];
+
+    ShardedLruCache(const ShardedLruCache&) = delete;
+    ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+};
+
+}  // namespace android
+
+#endif  // ANDROID_UTILS_SHARDED_LRU_CACHE_H
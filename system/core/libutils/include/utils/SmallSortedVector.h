@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SMALL_SORTED_VECTOR_H
+#define ANDROID_SMALL_SORTED_VECTOR_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <new>
+#include <utility>
+
+#include <utils/Errors.h>
+#include <utils/TypeHelpers.h>
+
+namespace android {
+
+/*
+ * A sorted set with inline storage for the first N items. Unlike
+ * SortedVector there is no SharedBuffer and no allocation at all until the
+ * set outgrows N, which makes it suitable for the many small, short-lived
+ * sorted sets built during font-table and codec-capability parsing where the
+ * heap traffic of SortedVector dominates.
+ *
+ * The API follows the SortedVector subset those call sites use; a
+ * compare_type overload must exist for TYPE (see TypeHelpers.h). Items are
+ * copied and moved directly, so TYPE must be copy constructible and
+ * assignable. Not thread safe.
+ */
+template <typename TYPE, size_t N = 8>
+class SmallSortedVector {
+  public:
+    typedef TYPE value_type;
+
+    SmallSortedVector() : mItems(inlineItems()), mCount(0), mCapacity(N) {}
+
+    SmallSortedVector(const SmallSortedVector<TYPE, N>& rhs)
+        : mItems(inlineItems()), mCount(0), mCapacity(N) {
+        copyFrom(rhs);
+    }
+
+    ~SmallSortedVector() {
+        clear();
+        if (mItems != inlineItems()) {
+            ::operator delete(mItems);
+        }
+    }
+
+    SmallSortedVector<TYPE, N>& operator=(const SmallSortedVector<TYPE, N>& rhs) {
+        if (this != &rhs) {
+            clear();
+            copyFrom(rhs);
+        }
+        return *this;
+    }
+
+    inline size_t size() const { return mCount; }
+    inline bool isEmpty() const { return mCount == 0; }
+    inline size_t capacity() const { return mCapacity; }
+
+    //! read-only C-style access
+    inline const TYPE* array() const { return mItems; }
+
+    inline const TYPE& operator[](size_t index) const { return mItems[index]; }
+    inline const TYPE& itemAt(size_t index) const { return mItems[index]; }
+    inline const TYPE& top() const { return mItems[mCount - 1]; }
+
+    //! finds the index of an item
+    ssize_t indexOf(const TYPE& item) const { return indexOrderOf(item, nullptr); }
+
+    //! finds where this item should be inserted
+    size_t orderOf(const TYPE& item) const {
+        size_t order;
+        indexOrderOf(item, &order);
+        return order;
+    }
+
+    //! add an item in the right place (and replace the one that is there)
+    ssize_t add(const TYPE& item) {
+        size_t order;
+        const ssize_t index = indexOrderOf(item, &order);
+        if (index >= 0) {
+            mItems[index] = item;
+            return index;
+        }
+        if (mCount == mCapacity) {
+            grow(mCapacity * 2);
+        }
+        if (order < mCount) {
+            // shift the tail up one slot; the last item moves into raw storage
+            new (mItems + mCount) TYPE(std::move(mItems[mCount - 1]));
+            for (size_t i = mCount - 1; i > order; i--) {
+                mItems[i] = std::move(mItems[i - 1]);
+            }
+            mItems[order] = item;
+        } else {
+            new (mItems + mCount) TYPE(item);
+        }
+        mCount++;
+        return ssize_t(order);
+    }
+
+    //! removes an item, returning its former index or NAME_NOT_FOUND
+    ssize_t remove(const TYPE& item) {
+        const ssize_t index = indexOf(item);
+        if (index >= 0) {
+            removeAt(size_t(index));
+        }
+        return index;
+    }
+
+    void removeAt(size_t index) {
+        for (size_t i = index; i + 1 < mCount; i++) {
+            mItems[i] = std::move(mItems[i + 1]);
+        }
+        mItems[--mCount].~TYPE();
+    }
+
+    void clear() {
+        for (size_t i = 0; i < mCount; i++) {
+            mItems[i].~TYPE();
+        }
+        mCount = 0;
+    }
+
+    typedef TYPE const* const_iterator;
+    inline const_iterator begin() const { return mItems; }
+    inline const_iterator end() const { return mItems + mCount; }
+
+  private:
+    TYPE* inlineItems() { return reinterpret_cast<TYPE*>(mInline); }
+    const TYPE* inlineItems() const { return reinterpret_cast<const TYPE*>(mInline); }
+
+    ssize_t indexOrderOf(const TYPE& item, size_t* order) const {
+        size_t lo = 0;
+        size_t hi = mCount;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            const int cmp = compare_type(mItems[mid], item);
+            if (cmp == 0) {
+                if (order != nullptr) *order = mid;
+                return ssize_t(mid);
+            }
+            if (cmp < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (order != nullptr) *order = lo;
+        return NAME_NOT_FOUND;
+    }
+
+    void grow(size_t newCapacity) {
+        TYPE* const newItems = static_cast<TYPE*>(::operator new(newCapacity * sizeof(TYPE)));
+        for (size_t i = 0; i < mCount; i++) {
+            new (newItems + i) TYPE(std::move(mItems[i]));
+            mItems[i].~TYPE();
+        }
+        if (mItems != inlineItems()) {
+            ::operator delete(mItems);
+        }
+        mItems = newItems;
+        mCapacity = newCapacity;
+    }
+
+    void copyFrom(const SmallSortedVector<TYPE, N>& rhs) {
+        if (rhs.mCount > mCapacity) {
+            grow(rhs.mCount);
+        }
+        for (size_t i = 0; i < rhs.mCount; i++) {
+            new (mItems + i) TYPE(rhs.mItems[i]);
+        }
+        mCount = rhs.mCount;
+    }
+
+    TYPE* mItems;       // inlineItems() until the set outgrows N
+    size_t mCount;
+    size_t mCapacity;
+    alignas(TYPE) char mInline[N * sizeof(TYPE)];
+};
+
+}  // namespace android
+
+// ---------------------------------------------------------------------------
+
+#endif  // ANDROID_SMALL_SORTED_VECTOR_H
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SNAPSHOT_VECTOR_H
+#define ANDROID_SNAPSHOT_VECTOR_H
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include <utils/LightRefBase.h>
+#include <utils/Mutex.h>
+#include <utils/StrongPointer.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+/*
+ * A generation-counted publish/subscribe wrapper around Vector<TYPE> for the
+ * one-writer / many-reader broadcast pattern. Sharing a plain Vector puts
+ * every reader through a SharedBuffer ref-count bump per access and makes the
+ * writer pay a copy-on-write of the whole buffer on the first edit after any
+ * reader grabbed a reference.
+ *
+ * Here the writer mutates a private working copy (batching any number of
+ * changes) and publish() turns it into an immutable ref-counted Snapshot,
+ * bumping a generation counter. The working copy pays exactly one
+ * copy-on-write per publish cycle, regardless of reader count. Readers cache
+ * an sp<Snapshot> and refresh it with fetchIfNewer(): when the generation is
+ * unchanged that is a single relaxed-ish atomic load with no ref-count
+ * traffic at all, so per-frame polling stays cheap between (rare) updates.
+ *
+ * Thread safety: any number of reader threads; writer-side calls (edit(),
+ * publish()) must come from a single thread at a time.
+ */
+template <typename TYPE>
+class SnapshotVector {
+  public:
+    class Snapshot : public LightRefBase<Snapshot> {
+      public:
+        uint32_t generation() const { return mGeneration; }
+        const Vector<TYPE>& items() const { return mItems; }
+
+        size_t size() const { return mItems.size(); }
+        bool isEmpty() const { return mItems.isEmpty(); }
+        const TYPE& operator[](size_t index) const { return mItems[index]; }
+        const TYPE& itemAt(size_t index) const { return mItems.itemAt(index); }
+        const TYPE* begin() const { return mItems.begin(); }
+        const TYPE* end() const { return mItems.end(); }
+
+      private:
+        friend class SnapshotVector<TYPE>;
+        Snapshot(const Vector<TYPE>& items, uint32_t generation)
+            : mItems(items), mGeneration(generation) {}
+
+        // shares the writer's SharedBuffer; never modified after construction
+        const Vector<TYPE> mItems;
+        const uint32_t mGeneration;
+    };
+
+    SnapshotVector() : mGeneration(0) {}
+
+    /*
+     * Writer side.
+     */
+
+    /* The private working copy; changes are invisible to readers until
+     * publish(). The first mutation after a publish() copies the buffer. */
+    Vector<TYPE>& edit() { return mWork; }
+
+    /* Publishes the working copy as a new immutable snapshot and returns the
+     * new generation. */
+    uint32_t publish() {
+        const uint32_t generation = mGeneration.load(std::memory_order_relaxed) + 1;
+        sp<Snapshot> snapshot = new Snapshot(mWork, generation);
+        {
+            AutoMutex _l(mLock);
+            mPublished = snapshot;
+        }
+        // bumped after the snapshot is visible, so a reader that observes the
+        // new generation always finds the matching snapshot under mLock
+        mGeneration.store(generation, std::memory_order_release);
+        return generation;
+    }
+
+    /*
+     * Reader side.
+     */
+
+    /* Generation of the latest published snapshot; 0 before the first
+     * publish(). Wraps at 2^32 publishes. */
+    uint32_t generation() const { return mGeneration.load(std::memory_order_acquire); }
+
+    /* Latest snapshot, or nullptr before the first publish(). */
+    sp<Snapshot> snapshot() const {
+        AutoMutex _l(mLock);
+        return mPublished;
+    }
+
+    /* Hot-path refresh: if *snapshot is already the current generation this
+     * returns false after one atomic load, with no ref-count traffic;
+     * otherwise it replaces *snapshot and returns true. */
+    bool fetchIfNewer(sp<Snapshot>* snapshot) const {
+        const uint32_t generation = mGeneration.load(std::memory_order_acquire);
+        if (*snapshot != nullptr && (*snapshot)->generation() == generation) {
+            return false;
+        }
+        AutoMutex _l(mLock);
+        *snapshot = mPublished;
+        return true;
+    }
+
+  private:
+    Vector<TYPE> mWork;            // writer's working copy
+    mutable Mutex mLock;           // guards mPublished
+    sp<Snapshot> mPublished;
+    std::atomic<uint32_t> mGeneration;
+};
+
+}  // namespace android
+
+// ---------------------------------------------------------------------------
+
+#endif  // ANDROID_SNAPSHOT_VECTOR_H
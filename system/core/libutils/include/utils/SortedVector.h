@@ -21,6 +21,9 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <utility>
+
 #include <log/log.h>
 #include <utils/TypeHelpers.h>
 #include <utils/Vector.h>
@@ -116,6 +119,19 @@ public:
             ssize_t         merge(const Vector<TYPE>& vector);
             ssize_t         merge(const SortedVector<TYPE>& vector);
 
+            //! replaces the contents with an unsorted array: one sort and one
+            //! bulk copy instead of a binary-search insertion (and memmove) per
+            //! item. The input array is reordered in place; among equal items
+            //! the last occurrence wins, as with repeated add().
+            //! Returns NO_ERROR or a negative error code.
+            ssize_t         setFromUnsorted(TYPE* array, size_t count);
+
+            //! merges an already sorted vector in one linear pass instead of a
+            //! binary-search insertion per item; equal items are replaced by
+            //! the incoming ones, as with add().
+            //! Returns NO_ERROR or a negative error code.
+            ssize_t         mergeSorted(const SortedVector<TYPE>& vector);
+
             //! removes an item
             ssize_t         remove(const TYPE&);
 
@@ -241,6 +257,87 @@ ssize_t SortedVector<TYPE>::merge(const SortedVector<TYPE>& vector) {
     return SortedVectorImpl::merge(reinterpret_cast<const SortedVectorImpl&>(vector));
 }
 
+template<class TYPE>
+ssize_t SortedVector<TYPE>::setFromUnsorted(TYPE* array, size_t count) {
+    // stable_sort keeps equal items in input order so that keeping the last
+    // of each run below matches the replace semantics of repeated add()
+    std::stable_sort(array, array + count,
+            [](const TYPE& lhs, const TYPE& rhs) { return compare_type(lhs, rhs) < 0; });
+    size_t unique = 0;
+    for (size_t i = 0; i < count; ) {
+        size_t j = i + 1;
+        while (j < count && compare_type(array[i], array[j]) == 0) {
+            j++;
+        }
+        if (unique != j - 1) {
+            array[unique] = std::move(array[j - 1]);
+        }
+        unique++;
+        i = j;
+    }
+    clear();
+    const ssize_t err = VectorImpl::appendArray(array, unique);
+    return err < 0 ? err : ssize_t(NO_ERROR);
+}
+
+template<class TYPE>
+ssize_t SortedVector<TYPE>::mergeSorted(const SortedVector<TYPE>& vector) {
+    if (vector.isEmpty()) {
+        return NO_ERROR;
+    }
+    if (isEmpty()) {
+        *this = vector;
+        return NO_ERROR;
+    }
+    // merge into a scratch vector appending maximal runs, then adopt its
+    // storage; assignment only shares the underlying buffer
+    SortedVector<TYPE> result;
+    ssize_t err = result.setCapacity(size() + vector.size());
+    if (err < 0) {
+        return err;
+    }
+    const TYPE* const a = array();
+    const TYPE* const b = vector.array();
+    const size_t na = size();
+    const size_t nb = vector.size();
+    size_t i = 0;
+    size_t j = 0;
+    while (i < na && j < nb) {
+        const int cmp = compare_type(a[i], b[j]);
+        if (cmp < 0) {
+            const size_t run = i++;
+            while (i < na && compare_type(a[i], b[j]) < 0) {
+                i++;
+            }
+            err = result.VectorImpl::appendArray(a + run, i - run);
+        } else if (cmp > 0) {
+            const size_t run = j++;
+            while (j < nb && compare_type(a[i], b[j]) > 0) {
+                j++;
+            }
+            err = result.VectorImpl::appendArray(b + run, j - run);
+        } else {
+            // equal: the incoming item replaces ours, as with add()
+            err = result.VectorImpl::appendArray(b + j, 1);
+            i++;
+            j++;
+        }
+        if (err < 0) {
+            return err;
+        }
+    }
+    if (i < na) {
+        err = result.VectorImpl::appendArray(a + i, na - i);
+    } else if (j < nb) {
+        err = result.VectorImpl::appendArray(b + j, nb - j);
+    }
+    if (err < 0) {
+        return err;
+    }
+    *this = result;
+    return NO_ERROR;
+}
+
 template<class TYPE> inline
 ssize_t SortedVector<TYPE>::remove(const TYPE& item) {
     return SortedVectorImpl::remove(&item);
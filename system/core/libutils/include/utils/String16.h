@@ -234,6 +234,13 @@ inline int strictly_order_type(const String16& lhs, const String16& rhs)
     return compare_type(lhs, rhs) < 0;
 }
 
+// See the String8 overload; hashes the raw UTF-16 code units.
+inline hash_t hash_type(const String16& value)
+{
+    return JenkinsHashBuffer(reinterpret_cast<const uint8_t*>(value.string()),
+                             value.size() * sizeof(char16_t));
+}
+
 inline const char16_t* String16::string() const
 {
     return mString;
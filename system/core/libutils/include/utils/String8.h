@@ -21,6 +21,7 @@
 #include <string>
 
 #include <utils/Errors.h>
+#include <utils/JenkinsHash.h>
 #include <utils/Unicode.h>
 #include <utils/TypeHelpers.h>
 
@@ -240,6 +241,13 @@ inline int strictly_order_type(const String8& lhs, const String8& rhs)
     return compare_type(lhs, rhs) < 0;
 }
 
+// Enables String8 keys in the libutils hash containers (LruCache,
+// ConcurrentHashMap, ...) without a per-call-site hasher.
+inline hash_t hash_type(const String8& value)
+{
+    return JenkinsHashBuffer(reinterpret_cast<const uint8_t*>(value.c_str()), value.size());
+}
+
 inline const String8 String8::empty() {
     return String8();
 }
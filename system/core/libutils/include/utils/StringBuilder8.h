@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_STRING_BUILDER8_H
+#define ANDROID_STRING_BUILDER8_H
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include <utils/Errors.h>
+#include <utils/String16.h>
+#include <utils/String8.h>
+#include <utils/Unicode.h>
+
+// ---------------------------------------------------------------------------
+
+namespace android {
+
+/*
+ * An append-only builder for String8, for code that assembles a large string
+ * from many small pieces — dump() implementations and the like. Each
+ * String8::append() reallocates and copies the whole accumulated string, so a
+ * chain of n appends costs O(n^2) bytes copied; the builder instead stores
+ * the pieces in a list of geometrically growing chunks and copies everything
+ * exactly once, into the final String8, when toString8() is called.
+ *
+ * UTF-16 input is converted straight into the chunk storage, so bridging a
+ * String16 into an accumulating String8 does not materialize an intermediate
+ * String8 per piece.
+ *
+ * The builder is not thread-safe and is intended to be short-lived:
+ *
+ *     StringBuilder8 out;
+ *     for (...) out.appendFormat("  client %d: %s\n", pid, state);
+ *     return out.toString8();
+ */
+class StringBuilder8 {
+  public:
+    StringBuilder8() : mSize(0) {}
+
+    /* Total length in bytes of what has been appended so far. */
+    size_t size() const { return mSize; }
+    bool isEmpty() const { return mSize == 0; }
+
+    void clear() {
+        mChunks.clear();
+        mSize = 0;
+    }
+
+    status_t append(const String8& other) { return append(other.string(), other.size()); }
+
+    status_t append(const char* other) { return append(other, strlen(other)); }
+
+    /* Appends the bytes, splitting across chunks as needed. */
+    status_t append(const char* other, size_t numChars) {
+        mSize += numChars;
+        while (numChars != 0) {
+            if (mChunks.empty() || mChunks.back().full()) {
+                addChunk(numChars);
+            }
+            Chunk& chunk = mChunks.back();
+            const size_t n = numChars < chunk.capacity - chunk.used
+                    ? numChars : chunk.capacity - chunk.used;
+            memcpy(chunk.data.get() + chunk.used, other, n);
+            chunk.used += n;
+            other += n;
+            numChars -= n;
+        }
+        return OK;
+    }
+
+    status_t append(const String16& other) { return append(other.string(), other.size()); }
+
+    /* Appends UTF-16 input, converting directly into the chunk storage. */
+    status_t append(const char16_t* chars, size_t numChars) {
+        const ssize_t len = utf16_to_utf8_length(chars, numChars);
+        if (len <= 0) {
+            return len == 0 ? OK : BAD_VALUE;
+        }
+        // utf16_to_utf8() needs a contiguous run and writes a NUL; the NUL
+        // lands in the reserved tail but is not counted.
+        char* dst = reserve(len + 1);
+        utf16_to_utf8(chars, numChars, dst, len + 1);
+        mChunks.back().used += len;
+        mSize += len;
+        return OK;
+    }
+
+    status_t appendFormat(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, fmt);
+        status_t result = appendFormatV(fmt, args);
+        va_end(args);
+        return result;
+    }
+
+    status_t appendFormatV(const char* fmt, va_list args) {
+        va_list tmp_args;
+        va_copy(tmp_args, args);
+        const int len = vsnprintf(nullptr, 0, fmt, tmp_args);
+        va_end(tmp_args);
+        if (len < 0) {
+            return BAD_VALUE;
+        }
+        if (len == 0) {
+            return OK;
+        }
+        char* dst = reserve(len + 1);
+        vsnprintf(dst, len + 1, fmt, args);
+        mChunks.back().used += len;
+        mSize += len;
+        return OK;
+    }
+
+    /* Flattens the chunks into a String8 with a single copy. */
+    String8 toString8() const {
+        String8 result;
+        if (mSize == 0) {
+            return result;
+        }
+        char* dst = result.lockBuffer(mSize);
+        if (dst == nullptr) {
+            return result;
+        }
+        for (const Chunk& chunk : mChunks) {
+            memcpy(dst, chunk.data.get(), chunk.used);
+            dst += chunk.used;
+        }
+        result.unlockBuffer(mSize);
+        return result;
+    }
+
+  private:
+    // Chunks double from the first size up to the cap; past pieces are never
+    // copied again, so growth only determines allocation count.
+    static constexpr size_t kFirstChunkSize = 256;
+    static constexpr size_t kMaxChunkSize = 64 * 1024;
+
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t used = 0;
+        size_t capacity = 0;
+
+        bool full() const { return used == capacity; }
+    };
+
+    /* Appends a chunk able to hold at least minSize more bytes. */
+    void addChunk(size_t minSize) {
+        size_t capacity = mChunks.empty() ? kFirstChunkSize : mChunks.back().capacity * 2;
+        if (capacity > kMaxChunkSize) {
+            capacity = kMaxChunkSize;
+        }
+        if (capacity < minSize) {
+            capacity = minSize;
+        }
+        Chunk chunk;
+        chunk.data.reset(new char[capacity]);
+        chunk.capacity = capacity;
+        mChunks.push_back(std::move(chunk));
+    }
+
+    /*
+     * Returns a contiguous run of numChars writable bytes at the tail; the
+     * caller advances used by what it actually wrote. Skips the remainder of
+     * the current chunk when it is too small (a bounded waste, since chunks
+     * grow geometrically).
+     */
+    char* reserve(size_t numChars) {
+        if (mChunks.empty() || mChunks.back().capacity - mChunks.back().used < numChars) {
+            addChunk(numChars);
+        }
+        Chunk& chunk = mChunks.back();
+        return chunk.data.get() + chunk.used;
+    }
+
+    std::vector<Chunk> mChunks;
+    size_t mSize;
+
+    StringBuilder8(const StringBuilder8&) = delete;
+    StringBuilder8& operator=(const StringBuilder8&) = delete;
+};
+
+}  // namespace android
+
+// ---------------------------------------------------------------------------
+
+#endif  // ANDROID_STRING_BUILDER8_H
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_UTILS_TIMER_WHEEL_H
+#define ANDROID_UTILS_TIMER_WHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace android {
+
+/*
+ * A hierarchical timer wheel with millisecond ticks, for timer sets where a
+ * sorted container would make insertion O(n) — e.g. a message loop with many
+ * pending delayed messages. schedule() and cancel() are O(1); advance() does
+ * work proportional to the elapsed ticks plus the timers that become due.
+ *
+ * Four levels of 64 slots cover deadlines up to ~64^4 ms (about 4.6 hours)
+ * exactly; farther deadlines are hashed into the top level and re-placed as
+ * the wheel reaches their slot, so they fire on time at the cost of a few
+ * extra O(1) re-placements. Timers are intrusive: embed a Timer in the owning
+ * object, which must outlive its scheduling.
+ *
+ * The wheel is not synchronized; the caller provides its own locking, as the
+ * typical use replaces a sorted vector that was already behind a lock.
+ */
+class TimerWheel {
+  public:
+    struct Timer {
+        Timer() : next(nullptr), pprev(nullptr), deadlineMs(0) {}
+
+        bool scheduled() const { return pprev != nullptr; }
+
+      private:
+        friend class TimerWheel;
+        Timer* next;
+        Timer** pprev;  // &previous->next, or &slot head; null when unlinked
+        uint64_t deadlineMs;
+    };
+
+    /* |nowMs| The current time; deadlines are on the same timebase. */
+    explicit TimerWheel(uint64_t nowMs) : mCurrentMs(nowMs), mCount(0) {
+        for (size_t level = 0; level < kLevels; level++) {
+            for (size_t slot = 0; slot < kSlots; slot++) {
+                mWheel[level][slot] = nullptr;
+            }
+        }
+    }
+
+    size_t count() const { return mCount; }
+
+    /*
+     * Schedules the timer to become due at deadlineMs, no earlier than the
+     * next tick. The timer must not already be scheduled.
+     */
+    void schedule(Timer* timer, uint64_t deadlineMs) {
+        timer->deadlineMs = deadlineMs > mCurrentMs ? deadlineMs : mCurrentMs + 1;
+        place(timer);
+        mCount++;
+    }
+
+    /* Unlinks the timer if it is scheduled. */
+    void cancel(Timer* timer) {
+        if (timer->scheduled()) {
+            unlink(timer);
+            mCount--;
+        }
+    }
+
+    /*
+     * Advances the wheel to nowMs and returns the timers that became due, in
+     * deadline order, as a singly linked list chained through Timer::next
+     * (all returned timers are unlinked from the wheel).
+     */
+    Timer* advance(uint64_t nowMs) {
+        Timer* dueHead = nullptr;
+        Timer** dueTail = &dueHead;
+        while (mCurrentMs < nowMs && mCount != 0) {
+            mCurrentMs++;
+            collect(0, mCurrentMs & kMask, &dueTail);
+            // When a level wraps, spill the next slot of the level above;
+            // its timers re-place into lower levels or become due.
+            for (size_t level = 1; level < kLevels; level++) {
+                if ((mCurrentMs & ((1ULL << (kBits * level)) - 1)) != 0) {
+                    break;
+                }
+                collect(level, (mCurrentMs >> (kBits * level)) & kMask, &dueTail);
+            }
+        }
+        if (mCurrentMs < nowMs) {
+            mCurrentMs = nowMs;  // empty wheel, just catch up
+        }
+        *dueTail = nullptr;
+        return dueHead;
+    }
+
+    /*
+     * A lower bound on the next due time, for computing a poll timeout:
+     * nothing becomes due before the returned time, but the caller may wake,
+     * advance and find nothing due yet. Returns UINT64_MAX when empty.
+     */
+    uint64_t nextWakeupMs() const {
+        if (mCount == 0) {
+            return UINT64_MAX;
+        }
+        for (uint64_t ms = mCurrentMs + 1; ms <= mCurrentMs + kSlots; ms++) {
+            if (mWheel[0][ms & kMask] != nullptr) {
+                return ms;
+            }
+        }
+        // Next spill of the first non-empty upper level.
+        for (size_t level = 1; level < kLevels; level++) {
+            const uint64_t span = 1ULL << (kBits * level);
+            for (uint64_t boundary = (mCurrentMs & ~(span - 1)) + span;
+                    boundary <= mCurrentMs + (span << kBits); boundary += span) {
+                if (mWheel[level][(boundary >> (kBits * level)) & kMask] != nullptr) {
+                    return boundary;
+                }
+            }
+        }
+        return mCurrentMs + (1ULL << (kBits * kLevels));  // hashed far timers
+    }
+
+  private:
+    static constexpr size_t kBits = 6;
+    static constexpr size_t kSlots = 1 << kBits;
+    static constexpr size_t kMask = kSlots - 1;
+    static constexpr size_t kLevels = 4;
+
+    /* Links the timer into the level matching its distance. */
+    void place(Timer* timer) {
+        const uint64_t diff = timer->deadlineMs - mCurrentMs;
+        size_t level = 0;
+        while (level < kLevels - 1 && diff >= (1ULL << (kBits * (level + 1)))) {
+            level++;
+        }
+        Timer** head = &mWheel[level][(timer->deadlineMs >> (kBits * level)) & kMask];
+        timer->next = *head;
+        timer->pprev = head;
+        if (timer->next != nullptr) {
+            timer->next->pprev = &timer->next;
+        }
+        *head = timer;
+    }
+
+    void unlink(Timer* timer) {
+        *timer->pprev = timer->next;
+        if (timer->next != nullptr) {
+            timer->next->pprev = timer->pprev;
+        }
+        timer->next = nullptr;
+        timer->pprev = nullptr;
+    }
+
+    /*
+     * Empties the slot: due timers are appended to the due list in deadline
+     * order, the rest re-place into lower levels.
+     */
+    void collect(size_t level, size_t slot, Timer*** dueTail) {
+        Timer* timer = mWheel[level][slot];
+        mWheel[level][slot] = nullptr;
+        while (timer != nullptr) {
+            Timer* const next = timer->next;
+            timer->next = nullptr;
+            timer->pprev = nullptr;
+            if (timer->deadlineMs <= mCurrentMs) {
+                appendDue(timer, dueTail);
+                mCount--;
+            } else {
+                place(timer);
+            }
+            timer = next;
+        }
+    }
+
+    /*
+     * Appends to the due list. A timer only becomes due on the tick matching
+     * its deadline, and ticks are processed in order, so appending keeps the
+     * list deadline ordered.
+     */
+    void appendDue(Timer* timer, Timer*** dueTail) {
+        **dueTail = timer;
+        *dueTail = &timer->next;
+    }
+
+    Timer* mWheel[kLevels][kSlots];
+    uint64_t mCurrentMs;
+    size_t mCount;
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+};
+
+}  // namespace android
+
+#endif  // ANDROID_UTILS_TIMER_WHEEL_H
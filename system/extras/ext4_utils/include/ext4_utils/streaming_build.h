@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _STREAMING_BUILD_H_
+#define _STREAMING_BUILD_H_
+
+#include "ext4_kernel_headers.h"
+#include "ext4_utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Streaming image build mode.
+ *
+ * The classic build path materializes every bitmap, inode table and extent
+ * tree for the whole filesystem before writing anything, so peak RSS scales
+ * with image size. The streaming builder walks block groups in on-disk
+ * order and keeps only a small window of per-group metadata arenas alive: a
+ * producer callback fills one group's bitmaps and inode table chunk, worker
+ * threads compute the group's metadata_csum checksums, and the emitter
+ * callback receives the finished group. Memory is bounded by
+ * window_groups * (2 bitmaps + inode table chunk) regardless of image size.
+ *
+ * Group descriptors are accumulated (64 bytes per group, the one structure
+ * that is cheap to retain) and emitted through the same callback after the
+ * last group, since their checksums depend on the finished group contents.
+ */
+
+struct stream_build_info {
+    u32 block_size;       /* bytes per block */
+    u32 blocks_per_group; /* blocks per block group */
+    u32 inodes_per_group; /* inodes per block group */
+    u32 inode_size;       /* bytes per on-disk inode */
+    u32 group_count;      /* number of block groups */
+    u64 gdt_offset;       /* byte offset of the primary descriptor table */
+    u8 uuid[16];          /* s_uuid, seeds all metadata_csum values */
+};
+
+struct stream_build_group_layout {
+    u64 block_bitmap_block; /* absolute block of the block bitmap */
+    u64 inode_bitmap_block; /* absolute block of the inode bitmap */
+    u64 inode_table_block;  /* absolute first block of the inode table */
+    u16 free_blocks_count;
+    u16 free_inodes_count;
+    u16 used_dirs_count;
+    u16 flags; /* EXT4_BG_* */
+};
+
+struct stream_build_ops {
+    /*
+     * Populates one group's metadata into the provided arenas.
+     * block_bitmap and inode_bitmap are block_size bytes; inode_table is
+     * inode_table_len bytes (inodes_per_group * inode_size). Fills *layout
+     * with the group's block locations and counts. Called in ascending
+     * group order from the build thread. Returns 0 on success.
+     */
+    int (*fill_group)(void* priv, u32 group, u8* block_bitmap, u8* inode_bitmap, u8* inode_table,
+                      u32 inode_table_len, struct stream_build_group_layout* layout);
+
+    /*
+     * Receives finished output. Called from the build thread, in ascending
+     * offset order for all group payloads; the descriptor table is emitted
+     * last, at info->gdt_offset. Returns 0 on success.
+     */
+    int (*emit)(void* priv, u64 offset, const void* data, size_t len);
+};
+
+struct stream_build;
+
+/*
+ * Creates a streaming build context. csum_threads worker threads compute
+ * per-group checksums (1 disables the pool and checksums inline);
+ * window_groups bounds how many groups may be in flight and must be at
+ * least csum_threads. Returns NULL on allocation failure or bad arguments.
+ */
+struct stream_build* stream_build_open(const struct stream_build_info* info,
+                                       const struct stream_build_ops* ops, void* priv,
+                                       unsigned int csum_threads, unsigned int window_groups);
+
+/*
+ * Runs the whole build: fills, checksums and emits every group, then emits
+ * the descriptor table. Returns 0 on success or the first nonzero value
+ * returned by a callback.
+ */
+int stream_build_run(struct stream_build* sb);
+
+void stream_build_close(struct stream_build* sb);
+
+/* crc32c (Castagnoli), the checksum metadata_csum is built on. */
+u32 ext4_crc32c(u32 crc, const void* data, size_t len);
+
+/*
+ * Descriptor checksum for metadata_csum filesystems: low 16 bits of
+ * crc32c over the uuid-derived seed, the little-endian group number and
+ * the descriptor with its bg_checksum field zeroed.
+ */
+u16 stream_build_group_desc_csum(const u8 uuid[16], u32 group, const struct ext4_group_desc* desc);
+
+/*
+ * Bitmap checksum as stored (split across *_csum_lo/hi by callers whose
+ * descriptor layout carries those fields).
+ */
+u32 stream_build_bitmap_csum(const u8 uuid[16], const u8* bitmap, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ext4_utils/streaming_build.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Slot states for the in-flight group window. */
+enum slot_state {
+    SLOT_FREE = 0,   /* available for the producer */
+    SLOT_FILLED,     /* contents ready, awaiting checksum */
+    SLOT_CLAIMED,    /* a worker is computing the checksum */
+    SLOT_CHECKSUMMED /* checksum done, awaiting in-order emission */
+};
+
+struct group_slot {
+    u32 group;
+    enum slot_state state;
+    struct stream_build_group_layout layout;
+    struct ext4_group_desc desc;
+    u8* block_bitmap;
+    u8* inode_bitmap;
+    u8* inode_table;
+};
+
+struct stream_build {
+    struct stream_build_info info;
+    struct stream_build_ops ops;
+    void* priv;
+
+    u32 inode_table_len;
+    unsigned int csum_threads;
+    unsigned int window_groups;
+    struct group_slot* slots;
+    struct ext4_group_desc* descs; /* all groups; emitted last */
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_avail;  /* signaled when a slot becomes FILLED */
+    pthread_cond_t work_done;   /* signaled when a slot becomes CHECKSUMMED */
+    pthread_t* threads;
+    int threads_started;
+    int stopping;
+    int error;
+};
+
+/* crc32c, slice-by-one with a lazily built table. The builder is fed a few
+ * MB of metadata per group; table lookup is plenty and keeps this
+ * dependency-free. */
+static u32 crc32c_table[256];
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+
+static void crc32c_build_table(void) {
+    for (u32 i = 0; i < 256; i++) {
+        u32 crc = i;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78 : 0);
+        }
+        crc32c_table[i] = crc;
+    }
+}
+
+u32 ext4_crc32c(u32 crc, const void* data, size_t len) {
+    const u8* p = data;
+
+    pthread_once(&crc32c_once, crc32c_build_table);
+    while (len--) {
+        crc = crc32c_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static u32 csum_seed(const u8 uuid[16]) {
+    return ext4_crc32c(~0U, uuid, 16);
+}
+
+u16 stream_build_group_desc_csum(const u8 uuid[16], u32 group,
+                                 const struct ext4_group_desc* desc) {
+    struct ext4_group_desc copy = *desc;
+    u32 le_group = cpu_to_le32(group);
+    u32 crc;
+
+    copy.bg_checksum = 0;
+    crc = csum_seed(uuid);
+    crc = ext4_crc32c(crc, &le_group, sizeof(le_group));
+    crc = ext4_crc32c(crc, &copy, sizeof(copy));
+    return crc & 0xFFFF;
+}
+
+u32 stream_build_bitmap_csum(const u8 uuid[16], const u8* bitmap, size_t len) {
+    return ext4_crc32c(csum_seed(uuid), bitmap, len);
+}
+
+static void slot_fill_desc(struct stream_build* sb, struct group_slot* slot) {
+    struct ext4_group_desc* desc = &slot->desc;
+
+    memset(desc, 0, sizeof(*desc));
+    desc->bg_block_bitmap_lo = cpu_to_le32((u32)slot->layout.block_bitmap_block);
+    desc->bg_block_bitmap_hi = cpu_to_le32((u32)(slot->layout.block_bitmap_block >> 32));
+    desc->bg_inode_bitmap_lo = cpu_to_le32((u32)slot->layout.inode_bitmap_block);
+    desc->bg_inode_bitmap_hi = cpu_to_le32((u32)(slot->layout.inode_bitmap_block >> 32));
+    desc->bg_inode_table_lo = cpu_to_le32((u32)slot->layout.inode_table_block);
+    desc->bg_inode_table_hi = cpu_to_le32((u32)(slot->layout.inode_table_block >> 32));
+    desc->bg_free_blocks_count_lo = cpu_to_le16(slot->layout.free_blocks_count);
+    desc->bg_free_inodes_count_lo = cpu_to_le16(slot->layout.free_inodes_count);
+    desc->bg_used_dirs_count_lo = cpu_to_le16(slot->layout.used_dirs_count);
+    desc->bg_flags = cpu_to_le16(slot->layout.flags);
+}
+
+/* Checksum work for one slot; runs on a worker thread (or inline when the
+ * pool is disabled). Touches only the slot's own arenas, so no locking. */
+static void slot_checksum(struct stream_build* sb, struct group_slot* slot) {
+    slot_fill_desc(sb, slot);
+    slot->desc.bg_checksum =
+        cpu_to_le16(stream_build_group_desc_csum(sb->info.uuid, slot->group, &slot->desc));
+}
+
+static void* csum_worker(void* arg) {
+    struct stream_build* sb = arg;
+
+    pthread_mutex_lock(&sb->lock);
+    for (;;) {
+        struct group_slot* slot = NULL;
+        unsigned int i;
+
+        while (!sb->stopping) {
+            for (i = 0; i < sb->window_groups; i++) {
+                if (sb->slots[i].state == SLOT_FILLED) {
+                    slot = &sb->slots[i];
+                    break;
+                }
+            }
+            if (slot) break;
+            pthread_cond_wait(&sb->work_avail, &sb->lock);
+        }
+        if (!slot) break;
+
+        /* Claim the slot before dropping the lock. */
+        slot->state = SLOT_CLAIMED;
+        pthread_mutex_unlock(&sb->lock);
+        slot_checksum(sb, slot);
+        pthread_mutex_lock(&sb->lock);
+        slot->state = SLOT_CHECKSUMMED;
+        pthread_cond_broadcast(&sb->work_done);
+    }
+    pthread_mutex_unlock(&sb->lock);
+    return NULL;
+}
+
+struct stream_build* stream_build_open(const struct stream_build_info* info,
+                                       const struct stream_build_ops* ops, void* priv,
+                                       unsigned int csum_threads, unsigned int window_groups) {
+    struct stream_build* sb;
+    unsigned int i;
+
+    if (!info || !ops || !ops->fill_group || !ops->emit) return NULL;
+    if (csum_threads < 1 || window_groups < csum_threads) return NULL;
+    if (!info->block_size || !info->group_count || !info->inode_size) return NULL;
+    if (window_groups > info->group_count) window_groups = info->group_count;
+
+    sb = calloc(1, sizeof(*sb));
+    if (!sb) return NULL;
+    sb->info = *info;
+    sb->ops = *ops;
+    sb->priv = priv;
+    sb->csum_threads = csum_threads;
+    sb->window_groups = window_groups;
+    sb->inode_table_len = info->inodes_per_group * info->inode_size;
+
+    sb->slots = calloc(window_groups, sizeof(*sb->slots));
+    sb->descs = calloc(info->group_count, sizeof(*sb->descs));
+    sb->threads = calloc(csum_threads, sizeof(*sb->threads));
+    if (!sb->slots || !sb->descs || !sb->threads) goto fail;
+
+    for (i = 0; i < window_groups; i++) {
+        sb->slots[i].block_bitmap = malloc(info->block_size);
+        sb->slots[i].inode_bitmap = malloc(info->block_size);
+        sb->slots[i].inode_table = malloc(sb->inode_table_len);
+        if (!sb->slots[i].block_bitmap || !sb->slots[i].inode_bitmap ||
+            !sb->slots[i].inode_table) {
+            goto fail;
+        }
+    }
+
+    pthread_mutex_init(&sb->lock, NULL);
+    pthread_cond_init(&sb->work_avail, NULL);
+    pthread_cond_init(&sb->work_done, NULL);
+    return sb;
+
+fail:
+    stream_build_close(sb);
+    return NULL;
+}
+
+static int emit_group(struct stream_build* sb, struct group_slot* slot) {
+    const struct stream_build_info* info = &sb->info;
+    int ret;
+
+    ret = sb->ops.emit(sb->priv, slot->layout.block_bitmap_block * info->block_size,
+                       slot->block_bitmap, info->block_size);
+    if (ret) return ret;
+    ret = sb->ops.emit(sb->priv, slot->layout.inode_bitmap_block * info->block_size,
+                       slot->inode_bitmap, info->block_size);
+    if (ret) return ret;
+    ret = sb->ops.emit(sb->priv, slot->layout.inode_table_block * info->block_size,
+                       slot->inode_table, sb->inode_table_len);
+    if (ret) return ret;
+    sb->descs[slot->group] = slot->desc;
+    return 0;
+}
+
+int stream_build_run(struct stream_build* sb) {
+    const u32 group_count = sb->info.group_count;
+    u32 next_fill = 0; /* next group to hand to fill_group */
+    u32 next_emit = 0; /* next group to emit, in order */
+    int use_pool = sb->csum_threads > 1;
+    int ret = 0;
+    unsigned int i;
+
+    if (use_pool) {
+        for (i = 0; i < sb->csum_threads; i++) {
+            if (pthread_create(&sb->threads[i], NULL, csum_worker, sb)) {
+                /* Fall back to inline checksums with whatever started. */
+                break;
+            }
+            sb->threads_started++;
+        }
+        use_pool = sb->threads_started > 0;
+    }
+
+    while (next_emit < group_count && !ret) {
+        /* Fill free slots as long as the window allows. */
+        while (next_fill < group_count && next_fill - next_emit < sb->window_groups) {
+            struct group_slot* slot = &sb->slots[next_fill % sb->window_groups];
+
+            slot->group = next_fill;
+            ret = sb->ops.fill_group(sb->priv, next_fill, slot->block_bitmap, slot->inode_bitmap,
+                                     slot->inode_table, sb->inode_table_len, &slot->layout);
+            if (ret) goto out;
+            if (use_pool) {
+                pthread_mutex_lock(&sb->lock);
+                slot->state = SLOT_FILLED;
+                pthread_cond_signal(&sb->work_avail);
+                pthread_mutex_unlock(&sb->lock);
+            } else {
+                slot_checksum(sb, slot);
+                slot->state = SLOT_CHECKSUMMED;
+            }
+            next_fill++;
+        }
+
+        /* Emit the next group in order once its checksum is done. */
+        {
+            struct group_slot* slot = &sb->slots[next_emit % sb->window_groups];
+
+            if (use_pool) {
+                pthread_mutex_lock(&sb->lock);
+                while (slot->state != SLOT_CHECKSUMMED) {
+                    pthread_cond_wait(&sb->work_done, &sb->lock);
+                }
+                pthread_mutex_unlock(&sb->lock);
+            }
+            ret = emit_group(sb, slot);
+            if (use_pool) {
+                /* Workers scan slot states under the lock. */
+                pthread_mutex_lock(&sb->lock);
+                slot->state = SLOT_FREE;
+                pthread_mutex_unlock(&sb->lock);
+            } else {
+                slot->state = SLOT_FREE;
+            }
+            next_emit++;
+        }
+    }
+
+out:
+    if (sb->threads_started) {
+        pthread_mutex_lock(&sb->lock);
+        sb->stopping = 1;
+        pthread_cond_broadcast(&sb->work_avail);
+        pthread_mutex_unlock(&sb->lock);
+        for (i = 0; i < (unsigned int)sb->threads_started; i++) {
+            pthread_join(sb->threads[i], NULL);
+        }
+        sb->threads_started = 0;
+        sb->stopping = 0;
+    }
+    if (!ret) {
+        ret = sb->ops.emit(sb->priv, sb->info.gdt_offset, sb->descs,
+                           (size_t)group_count * sizeof(struct ext4_group_desc));
+    }
+    return ret;
+}
+
+void stream_build_close(struct stream_build* sb) {
+    unsigned int i;
+
+    if (!sb) return;
+    if (sb->slots) {
+        for (i = 0; i < sb->window_groups; i++) {
+            free(sb->slots[i].block_bitmap);
+            free(sb->slots[i].inode_bitmap);
+            free(sb->slots[i].inode_table);
+        }
+    }
+    free(sb->slots);
+    free(sb->descs);
+    free(sb->threads);
+    free(sb);
+}
@@ -31,6 +31,7 @@
 #include "file_paths.h"
 #include "gsi_service.h"
 #include "libgsi_private.h"
+#include "pipelined_writer.h"
 
 namespace android {
 namespace gsi {
@@ -193,28 +194,54 @@ bool PartitionInstaller::CommitGsiChunk(int stream_fd, int64_t bytes) {
         LOG(ERROR) << "chunk size " << bytes << " is negative";
         return false;
     }
+    if (static_cast<uint64_t>(bytes) > size_ - gsi_bytes_written_) {
+        LOG(ERROR) << "chunk size " << bytes << " exceeds remaining image size (" << size_
+                   << " expected, " << gsi_bytes_written_ << " written)";
+        return false;
+    }
 
-    static const size_t kBlockSize = 4096;
-    auto buffer = std::make_unique<char[]>(kBlockSize);
+    // Pipeline the stream reads against device writes: we fill one buffer
+    // while the writer thread flushes the previous one. The backing image was
+    // just created zero-filled, so all-zero blocks can be skipped.
+    PipelinedWriter writer(system_device_->fd(), gsi_bytes_written_,
+                           /*skip_zero_blocks=*/true);
+    if (!writer.Init()) {
+        return false;
+    }
 
     int progress = -1;
     uint64_t remaining = bytes;
     while (remaining) {
-        size_t max_to_read = std::min(static_cast<uint64_t>(kBlockSize), remaining);
-        ssize_t rv = TEMP_FAILURE_RETRY(read(stream_fd, buffer.get(), max_to_read));
-        if (rv < 0) {
-            PLOG(ERROR) << "read gsi chunk";
+        if (service_->should_abort()) {
+            writer.Finish();
             return false;
         }
-        if (rv == 0) {
-            LOG(ERROR) << "no bytes left in stream";
-            return false;
+        size_t capacity;
+        char* buffer = writer.GetBuffer(&capacity);
+        // Fill the whole buffer if the stream allows; short reads just mean
+        // a retry, not failure.
+        size_t target = std::min(static_cast<uint64_t>(capacity), remaining);
+        size_t filled = 0;
+        while (filled < target) {
+            ssize_t rv = TEMP_FAILURE_RETRY(read(stream_fd, buffer + filled, target - filled));
+            if (rv < 0) {
+                PLOG(ERROR) << "read gsi chunk";
+                writer.Finish();
+                return false;
+            }
+            if (rv == 0) {
+                LOG(ERROR) << "no bytes left in stream";
+                writer.Finish();
+                return false;
+            }
+            filled += rv;
         }
-        if (!CommitGsiChunk(buffer.get(), rv)) {
+        if (!writer.SubmitBuffer(filled)) {
+            writer.Finish();
             return false;
         }
-        CHECK(static_cast<uint64_t>(rv) <= remaining);
-        remaining -= rv;
+        CHECK(filled <= remaining);
+        remaining -= filled;
 
         // Only update the progress when the % (or permille, in this case)
         // significantly changes.
@@ -224,6 +251,11 @@ bool PartitionInstaller::CommitGsiChunk(int stream_fd, int64_t bytes) {
         }
     }
 
+    if (!writer.Finish()) {
+        return false;
+    }
+    gsi_bytes_written_ += bytes;
+
     service_->UpdateProgress(IGsiService::STATUS_COMPLETE, size_);
     return true;
 }
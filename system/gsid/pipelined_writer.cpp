@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pipelined_writer.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <android-base/logging.h>
+
+namespace android {
+namespace gsi {
+
+PipelinedWriter::PipelinedWriter(int fd, uint64_t offset, bool skip_zero_blocks)
+    : fd_(fd), start_offset_(offset), skip_zero_blocks_(skip_zero_blocks) {}
+
+PipelinedWriter::~PipelinedWriter() {
+    if (started_) {
+        Finish();
+    }
+    for (auto& buffer : buffers_) {
+        free(buffer);
+        buffer = nullptr;
+    }
+}
+
+bool PipelinedWriter::Init() {
+    for (auto& buffer : buffers_) {
+        void* memory;
+        // O_DIRECT requires buffers aligned to the logical block size.
+        if (posix_memalign(&memory, kBlockSize, kBufferSize)) {
+            LOG(ERROR) << "could not allocate aligned write buffer";
+            return false;
+        }
+        buffer = static_cast<char*>(memory);
+    }
+
+    // O_DIRECT writes bypass the page cache, which is what we want for a
+    // multi-gigabyte one-shot stream, but it's best effort: stacked devices
+    // or file-backed destinations may refuse it, and we fall back to
+    // buffered writes with the same batched syncs. It also requires the
+    // file offset to be block aligned, which isn't guaranteed when this
+    // stream chunk follows an unaligned ashmem chunk; stay buffered then.
+    if ((start_offset_ % kBlockSize) != 0) {
+        LOG(INFO) << "unaligned start offset " << start_offset_ << "; using buffered writes";
+    } else {
+        int flags = fcntl(fd_, F_GETFL);
+        if (flags >= 0 && fcntl(fd_, F_SETFL, flags | O_DIRECT) == 0) {
+            use_o_direct_ = true;
+        } else {
+            PLOG(WARNING) << "O_DIRECT not supported; using buffered writes";
+        }
+    }
+
+    started_ = true;
+    writer_thread_ = std::thread(&PipelinedWriter::WriteLoop, this);
+    return true;
+}
+
+char* PipelinedWriter::GetBuffer(size_t* capacity) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Wait until the buffer we're about to hand out isn't queued for writing.
+    cond_.wait(lock, [this] { return submit_index_ - write_index_ < kNumBuffers; });
+    *capacity = kBufferSize;
+    return buffers_[submit_index_ % kNumBuffers];
+}
+
+bool PipelinedWriter::SubmitBuffer(size_t bytes) {
+    CHECK(bytes <= kBufferSize);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (failed_) {
+        return false;
+    }
+    pending_bytes_[submit_index_ % kNumBuffers] = bytes;
+    submit_index_++;
+    bytes_submitted_ += bytes;
+    cond_.notify_all();
+    return true;
+}
+
+bool PipelinedWriter::Finish() {
+    if (!started_) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        cond_.notify_all();
+    }
+    writer_thread_.join();
+    started_ = false;
+
+    if (use_o_direct_) {
+        // Restore the original descriptor flags for any subsequent caller.
+        int flags = fcntl(fd_, F_GETFL);
+        if (flags >= 0) {
+            fcntl(fd_, F_SETFL, flags & ~O_DIRECT);
+        }
+    }
+    if (failed_) {
+        return false;
+    }
+    if (fdatasync(fd_)) {
+        PLOG(ERROR) << "final fdatasync failed";
+        return false;
+    }
+    // Leave the file position where sequential write() calls would have,
+    // so callers mixing in non-pipelined writes keep working.
+    if (lseek(fd_, start_offset_ + bytes_submitted_, SEEK_SET) < 0) {
+        PLOG(ERROR) << "lseek past written image failed";
+        return false;
+    }
+    return true;
+}
+
+void PipelinedWriter::WriteLoop() {
+    uint64_t offset = start_offset_;
+    while (true) {
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this] { return write_index_ < submit_index_ || stopping_; });
+            if (write_index_ == submit_index_) {
+                return;  // stopping and drained
+            }
+            index = write_index_ % kNumBuffers;
+        }
+        size_t bytes = pending_bytes_[index];
+        bool ok = WriteBuffer(buffers_[index], bytes, offset);
+        offset += bytes;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!ok) {
+                failed_ = true;
+            }
+            write_index_++;
+            cond_.notify_all();
+        }
+        if (ok && offset - bytes_synced_ >= kBytesPerSync) {
+            // Batched sync: bounds the dirty page backlog so progress
+            // reported to the caller tracks durable bytes.
+            if (fdatasync(fd_)) {
+                PLOG(ERROR) << "batched fdatasync failed";
+                std::lock_guard<std::mutex> lock(mutex_);
+                failed_ = true;
+            }
+            bytes_synced_ = offset;
+        }
+    }
+}
+
+// Returns true if |block| is kBlockSize bytes of zeroes.
+static bool IsZeroBlock(const char* block) {
+    return block[0] == 0 && memcmp(block, block + 1, PipelinedWriter::kBlockSize - 1) == 0;
+}
+
+bool PipelinedWriter::WriteBuffer(const char* data, size_t bytes, uint64_t offset) {
+    size_t position = 0;
+    while (position < bytes) {
+        size_t length = bytes - position;
+        if (skip_zero_blocks_) {
+            // Skip whole all-zero blocks: the freshly created backing image
+            // is already zero-filled, so leaving a hole writes nothing and
+            // costs no bandwidth. GSI images carry long zero runs.
+            while (position + kBlockSize <= bytes && IsZeroBlock(data + position)) {
+                position += kBlockSize;
+            }
+            if (position >= bytes) {
+                break;
+            }
+            // Coalesce the following non-zero blocks into one write. A
+            // sub-block tail rides along with the run that precedes it.
+            size_t end = position + kBlockSize;
+            while (end + kBlockSize <= bytes && !IsZeroBlock(data + end)) {
+                end += kBlockSize;
+            }
+            if (end + kBlockSize > bytes) {
+                end = bytes;
+            }
+            length = end - position;
+        }
+        if (use_o_direct_ &&
+            ((length % kBlockSize) != 0 || ((offset + position) % kBlockSize) != 0)) {
+            // O_DIRECT can't express an unaligned length or offset; flip to
+            // buffered writes for the remainder. The length case is the final
+            // partial block, the offset case a ragged submit mid-stream.
+            int flags = fcntl(fd_, F_GETFL);
+            if (flags < 0 || fcntl(fd_, F_SETFL, flags & ~O_DIRECT) != 0) {
+                PLOG(ERROR) << "could not clear O_DIRECT for unaligned tail";
+                return false;
+            }
+            use_o_direct_ = false;
+        }
+        ssize_t rv = TEMP_FAILURE_RETRY(pwrite(fd_, data + position, length, offset + position));
+        if (rv < 0) {
+            PLOG(ERROR) << "pwrite of " << length << " bytes at offset " << offset + position
+                        << " failed";
+            return false;
+        }
+        position += rv;
+    }
+    return true;
+}
+
+}  // namespace gsi
+}  // namespace android
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace android {
+namespace gsi {
+
+// Double-buffered pipelined writer for streaming partition images.
+//
+// The caller (the read/decompress stage) fills one buffer while a dedicated
+// thread writes the previous one, so stream reads and device writes overlap
+// instead of alternating. The writer issues block-aligned writes (O_DIRECT
+// when the descriptor supports it), skips buffer-sized runs that are entirely
+// zero when the destination is known to be zero-filled, and batches
+// fdatasync() every kBytesPerSync so dirty pages never pile up into one large
+// writeback stall at the end of the installation.
+//
+// Usage, from a single producer thread:
+//
+//   PipelinedWriter writer(fd, offset, /*skip_zero_blocks=*/true);
+//   if (!writer.Init()) ...
+//   while (more input) {
+//       size_t capacity;
+//       char* buffer = writer.GetBuffer(&capacity);  // blocks, never fails
+//       size_t filled = ... read into buffer ...
+//       if (!writer.SubmitBuffer(filled)) ...       // asynchronous write
+//   }
+//   if (!writer.Finish()) ...                        // drain + final fsync
+class PipelinedWriter final {
+  public:
+    // Writes start at |offset| on |fd|, which must remain valid until
+    // Finish() returns. If |skip_zero_blocks| is set, all-zero blocks are
+    // skipped instead of written; only pass it when the destination range is
+    // already zero-filled (freshly created backing images are).
+    PipelinedWriter(int fd, uint64_t offset, bool skip_zero_blocks);
+    ~PipelinedWriter();
+
+    PipelinedWriter(const PipelinedWriter&) = delete;
+    PipelinedWriter& operator=(const PipelinedWriter&) = delete;
+
+    // Allocates aligned buffers and starts the write thread.
+    bool Init();
+
+    // Returns the next free buffer for the caller to fill, blocking until the
+    // write stage has released one. |*capacity| is set to the buffer size.
+    char* GetBuffer(size_t* capacity);
+
+    // Queues the first |bytes| of the buffer last returned by GetBuffer() for
+    // writing. Returns false if a previous write already failed.
+    bool SubmitBuffer(size_t bytes);
+
+    // Waits for all queued writes to land, issues the final fdatasync(), and
+    // stops the write thread. Returns false if any write or sync failed.
+    // After Finish() the fd's file position is |offset| plus the submitted
+    // byte count, matching what sequential write() calls would have left.
+    bool Finish();
+
+    // Total bytes accepted via SubmitBuffer(), including skipped zero blocks.
+    uint64_t bytes_submitted() const { return bytes_submitted_; }
+
+    // 1 MiB buffers amortize syscall and wakeup cost; 4K matches the logical
+    // block size every eMMC/UFS device and O_DIRECT constraint we care about.
+    static constexpr size_t kBufferSize = 1024 * 1024;
+    static constexpr size_t kBlockSize = 4096;
+
+  private:
+    static constexpr size_t kNumBuffers = 2;
+    // Sync cadence: frequent enough to keep writeback smooth and progress
+    // honest, rare enough not to throttle eMMC sequential bandwidth.
+    static constexpr uint64_t kBytesPerSync = 32 * 1024 * 1024;
+
+    void WriteLoop();
+    bool WriteBuffer(const char* data, size_t bytes, uint64_t offset);
+
+    int fd_;
+    uint64_t start_offset_;
+    bool skip_zero_blocks_;
+    bool use_o_direct_ = false;
+    bool started_ = false;
+
+    char* buffers_[kNumBuffers] = {};
+    size_t pending_bytes_[kNumBuffers] = {};
+    uint64_t bytes_submitted_ = 0;
+    uint64_t bytes_synced_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    // Buffers in [write_index_, submit_index_) are owned by the write thread.
+    size_t submit_index_ = 0;
+    size_t write_index_ = 0;
+    bool failed_ = false;
+    bool stopping_ = false;
+
+    std::thread writer_thread_;
+};
+
+}  // namespace gsi
+}  // namespace android
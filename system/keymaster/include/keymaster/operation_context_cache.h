@@ -0,0 +1,243 @@
+/*
+ * Copyright 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <openssl/sha.h>
+
+#include <hardware/keymaster_defs.h>
+#include <keymaster/UniquePtr.h>
+#include <keymaster/android_keymaster_utils.h>
+#include <keymaster/authorization_set.h>
+#include <keymaster/operation.h>
+#include <keymaster/serializable.h>
+
+#include <vector>
+
+namespace keymaster {
+
+/**
+ * The products of KeymasterContext::ParseKeyBlob() for one key blob: the decrypted key material
+ * and the authorization lists recovered from the blob.  Workloads that run many short operations
+ * against the same key (e.g. DRM doing thousands of small AES cipher operations per minute) pay
+ * for blob decryption and deserialization on every begin(); retaining these products between
+ * operations removes that cost.
+ */
+struct OperationContext {
+    KeymasterKeyBlob key_material;
+    AuthorizationSet hw_enforced;
+    AuthorizationSet sw_enforced;
+
+    OperationContext() {}
+    OperationContext(KeymasterKeyBlob&& key_material_, AuthorizationSet&& hw_enforced_,
+                     AuthorizationSet&& sw_enforced_)
+        : key_material(move(key_material_)), hw_enforced(move(hw_enforced_)),
+          sw_enforced(move(sw_enforced_)) {}
+    OperationContext(OperationContext&&) = default;
+    OperationContext& operator=(OperationContext&&) = default;
+    OperationContext(const OperationContext&) = delete;
+    OperationContext& operator=(const OperationContext&) = delete;
+};
+
+/**
+ * Fixed-capacity LRU cache of OperationContexts, keyed by a digest of the key blob and the
+ * client-bound parameters that affect blob parsing.  Intended usage in BeginOperation():
+ *
+ *     ContextId id;
+ *     OperationContextCache::ComputeContextId(key_blob, additional_params, &id);
+ *     const OperationContext* ctx = cache.Find(id);
+ *     if (!ctx) {
+ *         // ParseKeyBlob as today, then cache.Add(id, ...) the products.
+ *     }
+ *     // Build the Key for CreateOperation from ctx by copy; the cache retains its entry.
+ *
+ * The digest covers KM_TAG_APPLICATION_ID and KM_TAG_APPLICATION_DATA in addition to the blob
+ * bytes, because ParseKeyBlob derives the blob encryption key from them: the same blob presented
+ * with different client data must miss.
+ *
+ * Entries hold plaintext key material, so the cache must be scoped to the same trust boundary as
+ * the operation table, entries are wiped on eviction (KeymasterKeyBlob zeroes its contents on
+ * destruction), and RemoveAllForKeyBlob() must be called when a key is deleted or upgraded.
+ *
+ * Like OperationTable, this class is not internally synchronized; AndroidKeymaster processes
+ * messages on a single thread.
+ */
+class OperationContextCache {
+  public:
+    struct ContextId {
+        uint8_t digest[SHA256_DIGEST_LENGTH];
+
+        bool operator==(const ContextId& rhs) const {
+            return memcmp_s(digest, rhs.digest, sizeof(digest)) == 0;
+        }
+    };
+
+    explicit OperationContextCache(size_t cache_size) : entries_(cache_size) {}
+
+    OperationContextCache(const OperationContextCache&) = delete;
+    OperationContextCache& operator=(const OperationContextCache&) = delete;
+
+    /**
+     * Computes the cache key for a key blob and the begin() params.  Only the client-bound tags
+     * are folded into the digest; other begin() params don't affect blob parsing.
+     */
+    static void ComputeContextId(const keymaster_key_blob_t& key_blob,
+                                 const AuthorizationSet& additional_params, ContextId* id) {
+        SHA256_CTX ctx;
+        SHA256_Init(&ctx);
+        SHA256_Update(&ctx, key_blob.key_material, key_blob.key_material_size);
+        keymaster_blob_t client_id;
+        if (additional_params.GetTagValue(TAG_APPLICATION_ID, &client_id)) {
+            SHA256_Update(&ctx, client_id.data, client_id.data_length);
+        }
+        keymaster_blob_t app_data;
+        if (additional_params.GetTagValue(TAG_APPLICATION_DATA, &app_data)) {
+            SHA256_Update(&ctx, app_data.data, app_data.data_length);
+        }
+        SHA256_Final(id->digest, &ctx);
+    }
+
+    /**
+     * Returns the cached context for \p id, or nullptr on a miss.  A hit refreshes the entry's
+     * LRU position.  The returned pointer is valid until the next Add() or Remove*() call.
+     */
+    const OperationContext* Find(const ContextId& id) {
+        for (auto& entry : entries_) {
+            if (entry.in_use && entry.id == id) {
+                entry.last_use = ++use_counter_;
+                return &entry.context;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Inserts a context, evicting the least recently used entry if the cache is full.  If \p id
+     * is already present its context is replaced.
+     */
+    keymaster_error_t Add(const ContextId& id, OperationContext&& context) {
+        if (entries_.empty()) return KM_ERROR_UNKNOWN_ERROR;
+        Entry* victim = &entries_[0];
+        for (auto& entry : entries_) {
+            if (entry.in_use && entry.id == id) {
+                victim = &entry;
+                break;
+            }
+            if (!entry.in_use) {
+                if (victim->in_use) victim = &entry;
+            } else if (victim->in_use && entry.last_use < victim->last_use) {
+                victim = &entry;
+            }
+        }
+        victim->id = id;
+        victim->context = move(context);
+        victim->in_use = true;
+        victim->last_use = ++use_counter_;
+        return KM_ERROR_OK;
+    }
+
+    /**
+     * Wipes every cached context derived from \p key_blob, regardless of the client data it was
+     * parsed with.  Must be called on DeleteKey and UpgradeKey.
+     */
+    void RemoveAllForKeyBlob(const keymaster_key_blob_t& key_blob) {
+        uint8_t blob_digest[SHA256_DIGEST_LENGTH];
+        SHA256(key_blob.key_material, key_blob.key_material_size, blob_digest);
+        for (auto& entry : entries_) {
+            if (entry.in_use && memcmp_s(entry.blob_digest, blob_digest, sizeof(blob_digest)) == 0)
+                WipeEntry(&entry);
+        }
+    }
+
+    /** Wipes the single entry for \p id, if present. */
+    void Remove(const ContextId& id) {
+        for (auto& entry : entries_) {
+            if (entry.in_use && entry.id == id) WipeEntry(&entry);
+        }
+    }
+
+    /** Wipes all entries, e.g. on DeleteAllKeys or device lock. */
+    void Clear() {
+        for (auto& entry : entries_)
+            WipeEntry(&entry);
+    }
+
+    size_t size() const {
+        size_t count = 0;
+        for (const auto& entry : entries_)
+            count += entry.in_use ? 1 : 0;
+        return count;
+    }
+
+    /**
+     * Records the blob digest for eviction by blob; call right after Add() when the entry was
+     * created from a blob (Add() alone suffices when RemoveAllForKeyBlob() isn't needed).
+     */
+    void SetKeyBlobForId(const ContextId& id, const keymaster_key_blob_t& key_blob) {
+        for (auto& entry : entries_) {
+            if (entry.in_use && entry.id == id)
+                SHA256(key_blob.key_material, key_blob.key_material_size, entry.blob_digest);
+        }
+    }
+
+  private:
+    struct Entry {
+        ContextId id = {};
+        uint8_t blob_digest[SHA256_DIGEST_LENGTH] = {};
+        OperationContext context;
+        uint64_t last_use = 0;
+        bool in_use = false;
+    };
+
+    void WipeEntry(Entry* entry) {
+        entry->context = OperationContext();  // KeymasterKeyBlob zeroes on destruction.
+        memset_s(entry->id.digest, 0, sizeof(entry->id.digest));
+        memset_s(entry->blob_digest, 0, sizeof(entry->blob_digest));
+        entry->in_use = false;
+        entry->last_use = 0;
+    }
+
+    std::vector<Entry> entries_;
+    uint64_t use_counter_ = 0;
+};
+
+/**
+ * Drives one in-progress Operation over a scatter-gather list of input chunks with a single call,
+ * so a client batching many small buffers pays one binder round trip instead of one per chunk.
+ * Output from all chunks is gathered into \p output and the total bytes consumed is reported in
+ * \p input_consumed.  Stops at the first chunk the operation fails on or does not fully consume
+ * (block-aligned ciphers may leave a partial block; the caller resubmits the tail, exactly as
+ * with a short update() today).
+ */
+inline keymaster_error_t UpdateOperationBatched(Operation* operation,
+                                               const AuthorizationSet& input_params,
+                                               const std::vector<keymaster_blob_t>& input_chunks,
+                                               AuthorizationSet* output_params, Buffer* output,
+                                               size_t* input_consumed) {
+    *input_consumed = 0;
+    for (const keymaster_blob_t& chunk : input_chunks) {
+        Buffer input(chunk.data, chunk.data_length);
+        size_t chunk_consumed = 0;
+        keymaster_error_t error =
+            operation->Update(input_params, input, output_params, output, &chunk_consumed);
+        if (error != KM_ERROR_OK) return error;
+        *input_consumed += chunk_consumed;
+        if (chunk_consumed < chunk.data_length) break;
+    }
+    return KM_ERROR_OK;
+}
+
+}  // namespace keymaster
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <android-base/logging.h>
+
+namespace android {
+namespace base {
+
+// A logger wrapper that makes LOG() asynchronous: the calling thread copies
+// the already-formatted message into a slot of a bounded lock-free ring and
+// returns, and a background thread hands the messages to the wrapped logger
+// in order. Use it when synchronous writes to logd perturb latency-sensitive
+// paths:
+//
+//   SetLogger(AsyncLogger(LogdLogger()));
+//
+// The hot-path cost is one atomic ticket claim plus the memcpy of the
+// message. When the ring is full the message is dropped rather than blocking
+// the caller; drops are counted and the flusher reports "dropped N messages"
+// to the wrapped logger once the ring drains, so overflow is visible in the
+// log itself. Messages longer than a slot are truncated.
+//
+// FATAL messages bypass the ring: the pending backlog is flushed and the
+// message is written through synchronously, since the process aborts before
+// the flusher would run. Copies of an AsyncLogger (including the one
+// SetLogger takes) share the same ring and flusher thread; the thread exits
+// with the last copy.
+class AsyncLogger {
+ public:
+  // capacity is rounded up to a power of two slots; each slot holds one
+  // message of up to kMessageSize bytes.
+  explicit AsyncLogger(LogFunction&& wrapped, size_t capacity = 1024)
+      : state_(std::make_shared<State>(std::move(wrapped), capacity)) {}
+
+  void operator()(LogId id, LogSeverity severity, const char* tag, const char* file,
+                  unsigned int line, const char* message) {
+    if (severity == FATAL) {
+      // The abort in ~LogMessage preempts the flusher; keep ordering by
+      // draining first, then write through.
+      Flush();
+      state_->wrapped(id, severity, tag, file, line, message);
+      return;
+    }
+    if (!state_->Enqueue(id, severity, tag, file, line, message)) {
+      state_->dropped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      state_->Wake();
+    }
+  }
+
+  // Blocks until everything enqueued before the call has been handed to the
+  // wrapped logger.
+  void Flush() { state_->Flush(); }
+
+  // Total messages dropped on ring overflow so far.
+  uint64_t DroppedMessageCount() const {
+    return state_->dropped.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr size_t kTagSize = 64;
+  static constexpr size_t kFileSize = 128;
+  static constexpr size_t kMessageSize = 512;
+
+  struct Slot {
+    std::atomic<size_t> sequence;
+    LogId id;
+    LogSeverity severity;
+    unsigned int line;
+    char tag[kTagSize];
+    char file[kFileSize];
+    char message[kMessageSize];
+  };
+
+  struct State {
+    State(LogFunction&& logger, size_t capacity) : wrapped(std::move(logger)) {
+      size_t size = 1;
+      while (size < capacity) size <<= 1;
+      slot_count = size;
+      slots.reset(new Slot[size]);
+      for (size_t i = 0; i < size; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+      }
+      flusher = std::thread([this]() { Run(); });
+    }
+
+    ~State() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+      }
+      wakeup.notify_one();
+      flusher.join();
+    }
+
+    // Claims a slot with one CAS loop and copies the message in. Returns
+    // false when the ring is full. Safe from any thread.
+    bool Enqueue(LogId id, LogSeverity severity, const char* tag, const char* file,
+                 unsigned int line, const char* message) {
+      const size_t mask = slot_count - 1;
+      size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+      Slot* slot;
+      for (;;) {
+        slot = &slots[pos & mask];
+        const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+          if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            break;
+          }
+        } else if (diff < 0) {
+          return false;  // the slot a full ring ago has not been drained
+        } else {
+          pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+      }
+      slot->id = id;
+      slot->severity = severity;
+      slot->line = line;
+      CopyString(slot->tag, sizeof(slot->tag), tag);
+      CopyString(slot->file, sizeof(slot->file), file);
+      CopyString(slot->message, sizeof(slot->message), message);
+      slot->sequence.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    void Wake() {
+      if (sleeping.load(std::memory_order_acquire)) {
+        wakeup.notify_one();
+      }
+    }
+
+    void Flush() {
+      const size_t target = enqueue_pos.load(std::memory_order_acquire);
+      wakeup.notify_one();
+      while (dequeue_pos.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+
+    void Run() {
+      uint64_t reported_dropped = 0;
+      for (;;) {
+        while (Drain()) {
+        }
+        const uint64_t lost = dropped.load(std::memory_order_relaxed);
+        if (lost != reported_dropped) {
+          char note[64];
+          snprintf(note, sizeof(note), "async logger dropped %llu messages",
+                   static_cast<unsigned long long>(lost - reported_dropped));
+          reported_dropped = lost;
+          wrapped(DEFAULT, WARNING, "AsyncLogger", __FILE__, __LINE__, note);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        if (exiting && !Pending()) {
+          return;
+        }
+        sleeping.store(true, std::memory_order_release);
+        wakeup.wait_for(lock, std::chrono::milliseconds(100),
+                        [this]() { return exiting || Pending(); });
+        sleeping.store(false, std::memory_order_release);
+      }
+    }
+
+    // Hands one message to the wrapped logger. Single consumer.
+    bool Drain() {
+      const size_t mask = slot_count - 1;
+      const size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+      Slot* slot = &slots[pos & mask];
+      const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) < 0) {
+        return false;  // empty, or a producer is mid-copy
+      }
+      wrapped(slot->id, slot->severity, slot->tag, slot->file, slot->line, slot->message);
+      // Release the slot for the producer one lap ahead, then publish the
+      // new dequeue position for Flush().
+      slot->sequence.store(pos + slot_count, std::memory_order_release);
+      dequeue_pos.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool Pending() const {
+      return dequeue_pos.load(std::memory_order_acquire) !=
+             enqueue_pos.load(std::memory_order_acquire);
+    }
+
+    static void CopyString(char* dst, size_t dst_size, const char* src) {
+      strncpy(dst, src != nullptr ? src : "", dst_size - 1);
+      dst[dst_size - 1] = '\0';
+    }
+
+    LogFunction wrapped;
+    std::unique_ptr<Slot[]> slots;
+    size_t slot_count = 0;
+    std::atomic<size_t> enqueue_pos{0};
+    std::atomic<size_t> dequeue_pos{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> sleeping{false};
+    bool exiting = false;  // guarded by mutex
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::thread flusher;
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace base
+}  // namespace android
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#if !defined(_WIN32)
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "android-base/file.h"
+#include "android-base/mapped_file.h"
+#include "android-base/unique_fd.h"
+
+namespace android {
+namespace base {
+
+/**
+ * The contents of a file as a borrowed std::string_view over a read-only
+ * mapping. The view is valid for the lifetime of the FileView; the bytes are
+ * never copied, so multi-MB files cost page faults instead of a read loop
+ * plus string reallocation churn. The mapping is MAP_SHARED: a concurrent
+ * writer to the file is visible through the view, like any mmap.
+ */
+class FileView {
+ public:
+  FileView() = default;
+
+  std::string_view view() const {
+    return map_ != nullptr ? std::string_view(map_->data(), map_->size()) : std::string_view();
+  }
+
+  size_t size() const { return map_ != nullptr ? map_->size() : 0; }
+
+ private:
+  friend bool ReadFileMapped(const std::string&, FileView*);
+
+  std::unique_ptr<MappedFile> map_;
+};
+
+/**
+ * Maps the file read-only and hands out its contents through `contents`
+ * without copying. Returns false (leaving `contents` empty) if the file
+ * cannot be opened, is not a regular file, or cannot be mapped; procfs-style
+ * zero-size pseudo-files need ReadFileToString. An empty regular file
+ * succeeds with an empty view.
+ */
+inline bool ReadFileMapped(const std::string& path, FileView* contents) {
+  contents->map_.reset();
+  android::base::unique_fd fd(
+      TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW)));
+  if (fd == -1) return false;
+  struct stat sb;
+  if (fstat(fd.get(), &sb) == -1 || !S_ISREG(sb.st_mode)) return false;
+  if (sb.st_size == 0) return true;
+  contents->map_ = MappedFile::FromFd(fd, 0, sb.st_size, PROT_READ);
+  return contents->map_ != nullptr;
+}
+
+/**
+ * ReadFileToString with a size probe: for a regular file the string is
+ * resized once to the fstat size and filled with pread, instead of doubling
+ * through a read loop. Non-regular files (procfs reports size 0) fall back
+ * to ReadFdToString. A file that grows or shrinks between the probe and the
+ * reads is still read to EOF correctly.
+ */
+inline bool ReadFileToStringPresized(const std::string& path, std::string* content) {
+  content->clear();
+  android::base::unique_fd fd(
+      TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW)));
+  if (fd == -1) return false;
+  struct stat sb;
+  if (fstat(fd.get(), &sb) == -1) return false;
+  if (!S_ISREG(sb.st_mode) || sb.st_size == 0) {
+    return ReadFdToString(fd, content);
+  }
+  content->resize(sb.st_size);
+  size_t filled = 0;
+  while (filled < content->size()) {
+    const ssize_t n =
+        TEMP_FAILURE_RETRY(pread(fd.get(), &(*content)[filled], content->size() - filled, filled));
+    if (n == -1) {
+      content->clear();
+      return false;
+    }
+    if (n == 0) break;  // shrank since the probe
+    filled += n;
+  }
+  content->resize(filled);
+  // Pick up anything appended since the probe.
+  char extra[4096];
+  ssize_t n;
+  while ((n = TEMP_FAILURE_RETRY(pread(fd.get(), extra, sizeof(extra), filled))) > 0) {
+    content->append(extra, n);
+    filled += n;
+  }
+  if (n == -1) {
+    content->clear();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace base
+}  // namespace android
+
+#endif  // !defined(_WIN32)
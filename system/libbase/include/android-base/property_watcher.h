@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#if defined(__BIONIC__)
+
+#include <sys/system_properties.h>
+#include <time.h>
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace android {
+namespace base {
+
+// Watches many system properties from one thread. Each WaitForProperty()
+// call parks its own thread on a per-property futex, so a daemon watching
+// ~50 keys burns ~50 blocked threads; PropertyWatcher instead parks a single
+// thread on the global property-area serial (__system_property_wait with a
+// null prop_info), and on every bump re-reads the registered keys' own
+// serials and dispatches callbacks for the ones whose value changed:
+//
+//   PropertyWatcher watcher;
+//   watcher.Watch("init.svc.zygote", [](const std::string& key, const std::string& value) {...});
+//   ...
+//   watcher.Start();
+//
+// Callbacks run on the watcher thread, in registration order, and must not
+// block it for long. A property's creation counts as a change; system
+// properties are never deleted. Writes in quick succession may coalesce
+// into one callback carrying the latest value - the watcher samples state,
+// it does not replay every intermediate write (WaitForProperty has the same
+// property). Every global-serial bump wakes the thread
+// once and costs one serial read per registered key (a couple of loads from
+// the property area), which is the trade against the per-key futex waits.
+//
+// Register all keys before Start(); Watch() is not synchronized against the
+// running thread. Stop() (or destruction) joins the thread; the wait is
+// bounded, so stopping takes at most one timeout tick.
+class PropertyWatcher {
+ public:
+  using Callback = std::function<void(const std::string& key, const std::string& value)>;
+
+  PropertyWatcher() {}
+
+  ~PropertyWatcher() { Stop(); }
+
+  // Registers a key; the callback fires for every value change observed
+  // after Start(). Current values at Start() are the baseline and do not
+  // fire.
+  void Watch(std::string key, Callback callback) {
+    Entry entry;
+    entry.key = std::move(key);
+    entry.callback = std::move(callback);
+    entries_.push_back(std::move(entry));
+  }
+
+  void Start() {
+    if (thread_.joinable()) return;
+    Scan(/* notify = */ false);  // prime the baseline values
+    stop_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread([this]() { Run(); });
+  }
+
+  void Stop() {
+    if (!thread_.joinable()) return;
+    stop_.store(true, std::memory_order_relaxed);
+    thread_.join();
+  }
+
+ private:
+  struct Entry {
+    std::string key;
+    Callback callback;
+    const prop_info* pi = nullptr;
+    uint32_t serial = 0;
+    bool exists = false;
+    std::string value;
+  };
+
+  struct ReadResult {
+    std::string value;
+    uint32_t serial = 0;
+  };
+
+  static void ReadThunk(void* cookie, const char* /*name*/, const char* value, uint32_t serial) {
+    ReadResult* result = static_cast<ReadResult*>(cookie);
+    result->value = value;
+    result->serial = serial;
+  }
+
+  void Run() {
+    // Waiting from serial 0 returns immediately the first time, which
+    // covers any change between the baseline scan and this wait.
+    uint32_t serial = 0;
+    const timespec tick = {0, 250 * 1000 * 1000};
+    while (!stop_.load(std::memory_order_relaxed)) {
+      if (__system_property_wait(nullptr, serial, &serial, &tick)) {
+        Scan(/* notify = */ true);
+      }
+    }
+  }
+
+  // Re-reads every registered key and fires callbacks for changed values.
+  void Scan(bool notify) {
+    for (Entry& entry : entries_) {
+      if (entry.pi == nullptr) {
+        entry.pi = __system_property_find(entry.key.c_str());
+        if (entry.pi == nullptr) continue;
+      }
+      ReadResult current;
+      __system_property_read_callback(entry.pi, ReadThunk, &current);
+      if (entry.exists && current.serial == entry.serial) continue;
+      const bool changed = !entry.exists || current.value != entry.value;
+      entry.serial = current.serial;
+      entry.exists = true;
+      if (changed) {
+        entry.value = std::move(current.value);
+        if (notify) entry.callback(entry.key, entry.value);
+      }
+    }
+  }
+
+  std::vector<Entry> entries_;
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+
+  PropertyWatcher(const PropertyWatcher&) = delete;
+  PropertyWatcher& operator=(const PropertyWatcher&) = delete;
+};
+
+}  // namespace base
+}  // namespace android
+
+#endif  // defined(__BIONIC__)
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace android {
+namespace base {
+
+// A compile-time-parsed fast path for the printf subset that dominates
+// StringPrintf use: plain %s/%c/%d/%i/%u/%x/%X/%p (with h/l/ll/z length
+// modifiers) and %%. The format string is parsed at compile time - argument
+// count and types are checked with static_asserts, in the spirit of
+// fmtlib's FMT_COMPILE - and formatting is a single pass appending straight
+// into the result string, with integers converted by std::to_chars. There is
+// no vsnprintf size probe and no second formatting pass:
+//
+//   std::string s =
+//       StringPrintfCompiled(COMPILED_FORMAT("pid %d (%s): %zu bytes"), pid, name, count);
+//   StringAppendFCompiled(&out, COMPILED_FORMAT("  line %d\n"), n);
+//
+// The append form writes into the destination's existing spare capacity, so
+// dump loops that reuse one reserved std::string do not reallocate per call.
+// Formats using width, precision, flags or floating point fail the
+// static_assert; keep using StringPrintf for those.
+
+// Wraps a string literal in a type carrying it to compile time.
+#define COMPILED_FORMAT(s)                             \
+  ([] {                                                \
+    struct CompiledFormat_ {                           \
+      static constexpr const char* str() { return s; } \
+    };                                                 \
+    return CompiledFormat_{};                          \
+  }())
+
+namespace compiled_format_internal {
+
+constexpr bool IsSupportedConversion(char c) {
+  return c == 's' || c == 'c' || c == 'd' || c == 'i' || c == 'u' || c == 'x' || c == 'X' ||
+         c == 'p';
+}
+
+constexpr bool IsLengthModifier(char c) {
+  return c == 'h' || c == 'l' || c == 'z';
+}
+
+// Returns the number of conversions, or -1 if the format uses anything
+// outside the supported subset.
+constexpr int CountConversions(const char* fmt) {
+  int count = 0;
+  while (*fmt != '\0') {
+    if (*fmt++ != '%') continue;
+    if (*fmt == '%') {
+      fmt++;
+      continue;
+    }
+    while (IsLengthModifier(*fmt)) fmt++;
+    if (!IsSupportedConversion(*fmt)) return -1;
+    count++;
+    fmt++;
+  }
+  return count;
+}
+
+// Returns the conversion character of the index'th conversion.
+constexpr char ConversionAt(const char* fmt, int index) {
+  while (true) {
+    if (*fmt++ != '%') continue;
+    if (*fmt == '%') {
+      fmt++;
+      continue;
+    }
+    while (IsLengthModifier(*fmt)) fmt++;
+    if (index-- == 0) return *fmt;
+    fmt++;
+  }
+}
+
+template <typename T>
+constexpr bool MatchesConversion(char conversion) {
+  using Arg = std::remove_cv_t<std::remove_reference_t<T>>;
+  switch (conversion) {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'c':
+      return std::is_integral_v<Arg>;
+    case 's':
+      return std::is_convertible_v<Arg, std::string_view>;
+    case 'p':
+      return std::is_pointer_v<Arg>;
+    default:
+      return false;
+  }
+}
+
+inline void AppendHex(std::string* dst, uint64_t value, bool upper) {
+  char buf[16];
+  const auto result = std::to_chars(buf, buf + sizeof(buf), value, 16);
+  if (upper) {
+    for (char* p = buf; p != result.ptr; p++) {
+      if (*p >= 'a') *p -= 'a' - 'A';
+    }
+  }
+  dst->append(buf, result.ptr - buf);
+}
+
+inline void AppendPointer(std::string* dst, const void* value) {
+  if (value == nullptr) {
+    dst->append("(nil)");
+  } else {
+    dst->append("0x");
+    AppendHex(dst, reinterpret_cast<uintptr_t>(value), false);
+  }
+}
+
+template <typename T>
+void AppendArg(std::string* dst, char conversion, const T& value) {
+  if constexpr (std::is_pointer_v<T>) {
+    // Checked before %s so that a char* formatted with %p prints its
+    // address, not its contents.
+    if (conversion == 'p') {
+      AppendPointer(dst, reinterpret_cast<const void*>(value));
+      return;
+    }
+  }
+  if constexpr (std::is_integral_v<T>) {
+    if (conversion == 'c') {
+      dst->push_back(static_cast<char>(value));
+    } else if (conversion == 'x' || conversion == 'X') {
+      AppendHex(dst, static_cast<uint64_t>(static_cast<std::make_unsigned_t<T>>(value)),
+                conversion == 'X');
+    } else if (conversion == 'u') {
+      // Wrap negative values the way printf does.
+      char buf[24];
+      const auto result =
+          std::to_chars(buf, buf + sizeof(buf), static_cast<std::make_unsigned_t<T>>(value));
+      dst->append(buf, result.ptr - buf);
+    } else {
+      char buf[24];
+      const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+      dst->append(buf, result.ptr - buf);
+    }
+  } else if constexpr (std::is_convertible_v<T, std::string_view>) {
+    // %s: anything viewable as a string, without a strlen for sized inputs.
+    const std::string_view view(value);
+    dst->append(view.data(), view.size());
+  }
+}
+
+// Appends the literal run before the next conversion, then that conversion's
+// argument, advancing fmt past both.
+template <typename T>
+void EmitOne(std::string* dst, const char*& fmt, const T& value) {
+  const char* start = fmt;
+  while (true) {
+    if (*fmt != '%') {
+      fmt++;
+      continue;
+    }
+    if (fmt[1] == '%') {
+      dst->append(start, ++fmt - start);
+      start = ++fmt;
+      continue;
+    }
+    break;
+  }
+  dst->append(start, fmt - start);
+  fmt++;  // '%'
+  while (IsLengthModifier(*fmt)) fmt++;
+  AppendArg(dst, *fmt++, value);
+}
+
+// Appends the trailing literal after the last conversion.
+inline void EmitTail(std::string* dst, const char* fmt) {
+  const char* start = fmt;
+  while (*fmt != '\0') {
+    if (fmt[0] == '%' && fmt[1] == '%') {
+      dst->append(start, ++fmt - start);
+      start = ++fmt;
+      continue;
+    }
+    fmt++;
+  }
+  dst->append(start, fmt - start);
+}
+
+template <typename Format, typename... Args, size_t... I>
+constexpr void CheckArgs(std::index_sequence<I...>) {
+  static_assert(
+      ((MatchesConversion<Args>(ConversionAt(Format::str(), I))) && ...),
+      "argument type does not match its conversion; see the supported subset above");
+}
+
+}  // namespace compiled_format_internal
+
+template <typename Format, typename... Args>
+void StringAppendFCompiled(std::string* dst, Format, const Args&... args) {
+  namespace internal = compiled_format_internal;
+  constexpr const char* fmt = Format::str();
+  static_assert(internal::CountConversions(fmt) >= 0,
+                "format uses a conversion outside the compiled subset "
+                "(%s %c %d %i %u %x %X %p with h/l/z modifiers); use StringPrintf");
+  static_assert(internal::CountConversions(fmt) == sizeof...(Args),
+                "wrong number of arguments for format string");
+  internal::CheckArgs<Format, Args...>(std::index_sequence_for<Args...>{});
+  const char* cursor = fmt;
+  (internal::EmitOne(dst, cursor, args), ...);
+  internal::EmitTail(dst, cursor);
+}
+
+template <typename Format, typename... Args>
+std::string StringPrintfCompiled(Format format, const Args&... args) {
+  std::string result;
+  StringAppendFCompiled(&result, format, args...);
+  return result;
+}
+
+}  // namespace base
+}  // namespace android
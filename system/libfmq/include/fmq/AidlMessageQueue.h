@@ -106,6 +106,40 @@ struct AidlMessageQueue final
 
     MQDescriptor<T, U> dupeDesc();
 
+    /**
+     * Reads 'nMessages' items in place, without copying them out of the ring.
+     * 'consumer' is invoked with the two contiguous spans covering the items
+     * (the second span is empty unless the region wraps around the end of the
+     * ring):
+     *
+     *     bool consumer(const T* first, size_t firstCount,
+     *                   const T* second, size_t secondCount);
+     *
+     * The read is committed only if 'consumer' returns true; returning false
+     * leaves the items in the queue. With the UnsynchronizedWrite flavor a
+     * writer may overwrite the spans while 'consumer' is running; this method
+     * then returns false and anything 'consumer' produced from them must be
+     * discarded.
+     *
+     * read() remains the copy-out fallback; it moves both spans with a single
+     * memcpy() each.
+     *
+     * @return Whether 'nMessages' items were read and committed.
+     */
+    template <typename Consumer>
+    bool readInPlace(size_t nMessages, Consumer&& consumer);
+
+    /**
+     * Writes 'nMessages' items in place: 'filler' is invoked with the two
+     * contiguous spans to be filled, with the same signature and wrap-around
+     * semantics as readInPlace(). The write is committed, and becomes visible
+     * to the reader, only if 'filler' returns true.
+     *
+     * @return Whether 'nMessages' items were written and committed.
+     */
+    template <typename Filler>
+    bool writeInPlace(size_t nMessages, Filler&& filler);
+
   private:
     AidlMessageQueue(const AidlMessageQueue& other) = delete;
     AidlMessageQueue& operator=(const AidlMessageQueue& other) = delete;
@@ -154,4 +188,41 @@ MQDescriptor<T, U> AidlMessageQueue<T, U>::dupeDesc() {
     }
 }
 
+template <typename T, typename U>
+template <typename Consumer>
+bool AidlMessageQueue<T, U>::readInPlace(size_t nMessages, Consumer&& consumer) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "in-place transactions alias the shared ring; T must be trivially copyable");
+    typename MessageQueueBase<AidlMQDescriptorShim, T, FlavorTypeToValue<U>::value>::MemTransaction
+            tx;
+    if (!this->beginRead(nMessages, &tx)) {
+        return false;
+    }
+    const auto& first = tx.getFirstRegion();
+    const auto& second = tx.getSecondRegion();
+    if (!consumer(static_cast<const T*>(first.getAddress()), first.getLength(),
+                  static_cast<const T*>(second.getAddress()), second.getLength())) {
+        return false;
+    }
+    return this->commitRead(nMessages);
+}
+
+template <typename T, typename U>
+template <typename Filler>
+bool AidlMessageQueue<T, U>::writeInPlace(size_t nMessages, Filler&& filler) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "in-place transactions alias the shared ring; T must be trivially copyable");
+    typename MessageQueueBase<AidlMQDescriptorShim, T, FlavorTypeToValue<U>::value>::MemTransaction
+            tx;
+    if (!this->beginWrite(nMessages, &tx)) {
+        return false;
+    }
+    const auto& first = tx.getFirstRegion();
+    const auto& second = tx.getSecondRegion();
+    if (!filler(first.getAddress(), first.getLength(), second.getAddress(), second.getLength())) {
+        return false;
+    }
+    return this->commitWrite(nMessages);
+}
+
 }  // namespace android
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <fmq/EventFlag.h>
+#include <fmq/MessageQueue.h>
+
+#include <memory>
+
+namespace android {
+namespace hardware {
+
+/**
+ * Single-writer multi-reader fan-out over one shared ring, so N consumers of
+ * the same stream (e.g. sensor events) share one buffer instead of copying
+ * through N queues. Built on the 'kUnsynchronizedWrite' flavor: the writer
+ * never inspects reader state, so its progress is wait-free regardless of
+ * how slow any reader is, and every reader owns a private read cursor over
+ * the shared ring. A reader that falls more than one ring behind is overrun:
+ * its next operation resynchronizes it to the freshest data and the loss is
+ * recorded in droppedMessageCount(), instead of stalling the writer.
+ *
+ * Wakeups reuse the FMQ EventFlag word: the writer raises
+ * kEventDataAvailable after each write and readBlocking() waits on it.
+ *
+ *   BroadcastMessageQueue<Event> queue(1024);
+ *   auto reader = queue.createReader();   // hand one to each consumer thread
+ *   ...
+ *   queue.write(&event);                  // writer
+ *   reader->readBlocking(&event, 1);      // each consumer
+ *
+ * Each Reader must only be used from one thread at a time, like any FMQ
+ * reader. Readers can also be created in another process by sending
+ * getDesc() across and constructing a Reader from it there.
+ */
+template <typename T>
+class BroadcastMessageQueue {
+  public:
+    using Queue = MessageQueue<T, kUnsynchronizedWrite>;
+    using Descriptor = typename Queue::Descriptor;
+
+    /** EventFlag bit the writer raises after each successful write. */
+    static constexpr uint32_t kEventDataAvailable = 1 << 0;
+
+    explicit BroadcastMessageQueue(size_t numElementsInQueue)
+        : mQueue(numElementsInQueue, /* configureEventFlagWord = */ true) {
+        if (mQueue.isValid() && mQueue.getEventFlagWord() != nullptr) {
+            EventFlag::createEventFlag(mQueue.getEventFlagWord(), &mEventFlag);
+        }
+    }
+
+    ~BroadcastMessageQueue() {
+        if (mEventFlag != nullptr) {
+            EventFlag::deleteEventFlag(&mEventFlag);
+        }
+    }
+
+    bool isValid() const { return mQueue.isValid() && mEventFlag != nullptr; }
+
+    const Descriptor* getDesc() const { return mQueue.getDesc(); }
+
+    size_t getQuantumCount() const { return mQueue.getQuantumCount(); }
+
+    /**
+     * Wait-free write of 'count' items: succeeds whenever count fits in the
+     * ring at all, overwriting the oldest data if some reader has not kept
+     * up, and wakes blocked readers.
+     */
+    bool write(const T* data, size_t count) {
+        if (!mQueue.write(data, count)) {
+            return false;
+        }
+        mEventFlag->wake(kEventDataAvailable);
+        return true;
+    }
+
+    bool write(const T* data) { return write(data, 1); }
+
+    class Reader {
+      public:
+        /**
+         * Creates a reader over the ring described by 'desc' (from
+         * getDesc(), possibly received from another process). The reader
+         * starts at the writer's current position; it sees data written
+         * after this point.
+         */
+        explicit Reader(const Descriptor& desc) : mQueue(desc, /* resetPointers = */ false) {
+            if (mQueue.isValid()) {
+                mQueue.discardUnread();  // late join: start at the writer
+                if (mQueue.getEventFlagWord() != nullptr) {
+                    EventFlag::createEventFlag(mQueue.getEventFlagWord(), &mEventFlag);
+                }
+            }
+        }
+
+        ~Reader() {
+            if (mEventFlag != nullptr) {
+                EventFlag::deleteEventFlag(&mEventFlag);
+            }
+        }
+
+        bool isValid() const { return mQueue.isValid() && mEventFlag != nullptr; }
+
+        /**
+         * Non-blocking read of 'count' items. Returns false if fewer than
+         * 'count' items are available. After an overrun the reader is
+         * resynchronized to the freshest data and the loss is added to
+         * droppedMessageCount().
+         */
+        bool read(T* data, size_t count) {
+            recoverFromOverrun();
+            return mQueue.read(data, count);
+        }
+
+        bool read(T* data) { return read(data, 1); }
+
+        /**
+         * Blocking read: waits on the writer's kEventDataAvailable wake.
+         * timeOutNanos == 0 waits without a timeout. Returns false on
+         * timeout.
+         */
+        bool readBlocking(T* data, size_t count, int64_t timeOutNanos = 0) {
+            while (true) {
+                if (read(data, count)) {
+                    return true;
+                }
+                uint32_t efState = 0;
+                const status_t status = mEventFlag->wait(kEventDataAvailable, &efState,
+                                                         timeOutNanos, /* retry = */ true);
+                if (status != NO_ERROR) {
+                    return read(data, count);
+                }
+            }
+        }
+
+        /** Items ready to read, after accounting for any overrun. */
+        size_t availableToRead() {
+            recoverFromOverrun();
+            return mQueue.availableToRead();
+        }
+
+        /** Total items lost to overruns since this reader was created. */
+        uint64_t droppedMessageCount() const { return mDropped; }
+
+      private:
+        /*
+         * An unread distance of more than one ring means the writer lapped
+         * us and the unread bytes are no longer intact; snap to the writer
+         * and account for the loss. (beginRead() would snap too, but
+         * silently.)
+         */
+        void recoverFromOverrun() {
+            if (mQueue.availableToRead() > mQueue.getQuantumCount()) {
+                mDropped += mQueue.discardUnread();
+            }
+        }
+
+        Queue mQueue;
+        EventFlag* mEventFlag = nullptr;
+        uint64_t mDropped = 0;
+
+        Reader(const Reader& other) = delete;
+        Reader& operator=(const Reader& other) = delete;
+    };
+
+    /** Creates an in-process reader starting at the writer's current position. */
+    std::unique_ptr<Reader> createReader() const {
+        return std::make_unique<Reader>(*mQueue.getDesc());
+    }
+
+  private:
+    Queue mQueue;
+    EventFlag* mEventFlag = nullptr;
+
+    BroadcastMessageQueue(const BroadcastMessageQueue& other) = delete;
+    BroadcastMessageQueue& operator=(const BroadcastMessageQueue& other) = delete;
+};
+
+}  // namespace hardware
+}  // namespace android
@@ -79,6 +79,19 @@ struct MessageQueueBase {
      */
     size_t availableToRead() const;
 
+    /**
+     * Moves this reader's read pointer to the writer's current position,
+     * discarding everything unread. Intended for the 'kUnsynchronizedWrite'
+     * flavor, where every reader owns its read pointer: a late-joining
+     * reader uses it to start from fresh data instead of replaying the ring,
+     * and an overrun reader uses the return value to account for what it
+     * lost. With the 'kSynchronizedReadWrite' flavor this frees the
+     * discarded space to the writer.
+     *
+     * @return Number of items of type T that were discarded.
+     */
+    uint64_t discardUnread();
+
     /**
      * Returns the size of type T in bytes.
      *
@@ -1228,6 +1241,19 @@ MessageQueueBase<MQDescriptorType, T, flavor>::commitRead(size_t nMessages) {
     return true;
 }
 
+template <template <typename, MQFlavor> typename MQDescriptorType, typename T, MQFlavor flavor>
+/*
+ * Disable integer sanitization since integer overflow here is allowed
+ * and legal.
+ */
+__attribute__((no_sanitize("integer"))) uint64_t
+MessageQueueBase<MQDescriptorType, T, flavor>::discardUnread() {
+    auto readPtr = mReadPtr->load(std::memory_order_relaxed);
+    auto writePtr = mWritePtr->load(std::memory_order_acquire);
+    mReadPtr->store(writePtr, std::memory_order_release);
+    return (writePtr - readPtr) / sizeof(T);
+}
+
 template <template <typename, MQFlavor> typename MQDescriptorType, typename T, MQFlavor flavor>
 size_t MessageQueueBase<MQDescriptorType, T, flavor>::getQuantumSize() const {
     return mDesc->getQuantum();
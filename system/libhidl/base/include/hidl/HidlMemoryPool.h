@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ANDROID_HIDL_MEMORY_POOL_H
+#define ANDROID_HIDL_MEMORY_POOL_H
+
+#include <hidl/HidlSupport.h>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace android {
+namespace hardware {
+
+/**
+ * A sub-range lease on a HidlMemoryPool region.
+ *
+ * This is plain data, cheap to embed in a HAL method's argument struct: it
+ * names a range of a pooled region both sides have already mapped, so
+ * passing one buffer costs no binder object, no mmap and no IMemory lookup.
+ * The generation counter makes leases single-use: once the lease is
+ * released, handles naming the old occupancy of the slot fail validation
+ * instead of aliasing recycled memory.
+ */
+struct MemoryLease {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint32_t slot = 0;
+    uint32_t generation = 0;
+
+    bool valid() const { return size != 0; }
+};
+
+/**
+ * Sub-allocates small buffers out of one large hidl_memory region.
+ *
+ * The usual pattern for streaming HALs - one hidl_memory per buffer - costs
+ * a binder object, an IMemory resolution and an mmap/munmap per buffer,
+ * which dominates at a few hundred small buffers per second. A pool is set
+ * up once instead: the producer allocates one large region, both processes
+ * map it once, and individual buffers become MemoryLease ranges handed out
+ * and returned with a mutex-guarded free-list operation, no kernel or
+ * binder involvement.
+ *
+ * The pool does not itself perform the mapping; construct it from the
+ * mapped base the process already obtained (e.g. via IMemory::getPointer()
+ * on the importing side or the allocator on the exporting side), and
+ * optionally hand it the HidlMemory to keep the region's handle alive for
+ * the pool's lifetime.
+ *
+ * Leases are validated by slot generation, so a stale or double-released
+ * lease is rejected rather than handing out another lease's bytes. All
+ * methods are thread-safe.
+ */
+class HidlMemoryPool : public virtual ::android::RefBase {
+  public:
+    /**
+     * @param base process-local mapping of the region; must stay mapped for
+     *             the pool's lifetime
+     * @param size region size in bytes
+     * @param memory optional; retained so the backing handle outlives the pool
+     * @param alignment every lease offset is rounded up to this; must be a
+     *             power of two (default suits cache-line sharing)
+     */
+    HidlMemoryPool(void* base, uint64_t size, sp<HidlMemory> memory = nullptr,
+                   uint64_t alignment = 64)
+        : mBase(static_cast<uint8_t*>(base)),
+          mSize(size),
+          mAlignment(alignment == 0 ? 1 : alignment),
+          mMemory(memory) {
+        mFreeRanges.push_back(Range{0, size});
+    }
+
+    HidlMemoryPool(const HidlMemoryPool&) = delete;
+    HidlMemoryPool& operator=(const HidlMemoryPool&) = delete;
+
+    /**
+     * Leases a sub-range of at least |size| bytes. Returns an invalid lease
+     * (lease.valid() == false) when the pool cannot satisfy the request;
+     * streaming callers typically treat that as backpressure and retry
+     * after releasing a buffer.
+     */
+    MemoryLease lease(uint64_t size) {
+        MemoryLease out;
+        if (size == 0 || size > mSize) {
+            return out;
+        }
+        const uint64_t rounded = (size + mAlignment - 1) & ~(mAlignment - 1);
+        std::lock_guard<std::mutex> lock(mLock);
+        for (size_t i = 0; i < mFreeRanges.size(); i++) {
+            Range& range = mFreeRanges[i];
+            if (range.size < rounded) {
+                continue;
+            }
+            out.offset = range.offset;
+            out.size = size;
+            range.offset += rounded;
+            range.size -= rounded;
+            if (range.size == 0) {
+                mFreeRanges.erase(mFreeRanges.begin() + i);
+            }
+            bindSlotLocked(&out, rounded);
+            return out;
+        }
+        return out;  // no free range large enough
+    }
+
+    /**
+     * Returns a leased range to the pool. Returns false if the lease is
+     * stale (already released) or malformed; the pool is unchanged then.
+     */
+    bool release(const MemoryLease& lease) {
+        std::lock_guard<std::mutex> lock(mLock);
+        Slot* slot = validateLocked(lease);
+        if (slot == nullptr) {
+            return false;
+        }
+        slot->generation++;  // invalidates outstanding copies of the handle
+        slot->active = false;
+        insertFreeRangeLocked(Range{slot->offset, slot->rounded});
+        return true;
+    }
+
+    /**
+     * Resolves a lease to its mapped address, or nullptr if the lease is
+     * stale or malformed. The pointer stays valid until release().
+     */
+    void* at(const MemoryLease& lease) {
+        std::lock_guard<std::mutex> lock(mLock);
+        return validateLocked(lease) == nullptr ? nullptr : mBase + lease.offset;
+    }
+
+    /** Bytes currently leasable (sum of free ranges, before alignment). */
+    uint64_t freeBytes() const {
+        std::lock_guard<std::mutex> lock(mLock);
+        uint64_t total = 0;
+        for (const Range& range : mFreeRanges) {
+            total += range.size;
+        }
+        return total;
+    }
+
+    uint64_t size() const { return mSize; }
+    const sp<HidlMemory>& memory() const { return mMemory; }
+
+  private:
+    struct Range {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct Slot {
+        uint64_t offset = 0;
+        uint64_t rounded = 0;  // leased extent including alignment padding
+        uint32_t generation = 0;
+        bool active = false;
+    };
+
+    void bindSlotLocked(MemoryLease* lease, uint64_t rounded) {
+        for (size_t i = 0; i < mSlots.size(); i++) {
+            if (!mSlots[i].active) {
+                mSlots[i].offset = lease->offset;
+                mSlots[i].rounded = rounded;
+                mSlots[i].active = true;
+                lease->slot = static_cast<uint32_t>(i);
+                lease->generation = mSlots[i].generation;
+                return;
+            }
+        }
+        mSlots.push_back(Slot{lease->offset, rounded, 0, true});
+        lease->slot = static_cast<uint32_t>(mSlots.size() - 1);
+        lease->generation = 0;
+    }
+
+    Slot* validateLocked(const MemoryLease& lease) {
+        if (!lease.valid() || lease.slot >= mSlots.size()) {
+            return nullptr;
+        }
+        Slot& slot = mSlots[lease.slot];
+        if (!slot.active || slot.generation != lease.generation ||
+            slot.offset != lease.offset) {
+            return nullptr;
+        }
+        return &slot;
+    }
+
+    // Keeps mFreeRanges sorted by offset and coalesces with both neighbors,
+    // so long-running streams don't fragment the region.
+    void insertFreeRangeLocked(Range range) {
+        size_t i = 0;
+        while (i < mFreeRanges.size() && mFreeRanges[i].offset < range.offset) {
+            i++;
+        }
+        if (i > 0 && mFreeRanges[i - 1].offset + mFreeRanges[i - 1].size == range.offset) {
+            mFreeRanges[i - 1].size += range.size;
+            if (i < mFreeRanges.size() &&
+                mFreeRanges[i - 1].offset + mFreeRanges[i - 1].size == mFreeRanges[i].offset) {
+                mFreeRanges[i - 1].size += mFreeRanges[i].size;
+                mFreeRanges.erase(mFreeRanges.begin() + i);
+            }
+            return;
+        }
+        if (i < mFreeRanges.size() && range.offset + range.size == mFreeRanges[i].offset) {
+            mFreeRanges[i].offset = range.offset;
+            mFreeRanges[i].size += range.size;
+            return;
+        }
+        mFreeRanges.insert(mFreeRanges.begin() + i, range);
+    }
+
+    uint8_t* mBase;
+    const uint64_t mSize;
+    const uint64_t mAlignment;
+    sp<HidlMemory> mMemory;
+
+    mutable std::mutex mLock;
+    std::vector<Range> mFreeRanges;
+    std::vector<Slot> mSlots;
+};
+
+}  // namespace hardware
+}  // namespace android
+
+#endif  // ANDROID_HIDL_MEMORY_POOL_H
@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_VINTF_MANIFEST_SNAPSHOT_H
+#define ANDROID_VINTF_MANIFEST_SNAPSHOT_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include <utils/Errors.h>
+
+#include "FileSystem.h"
+#include "HalFormat.h"
+#include "HalManifest.h"
+#include "Level.h"
+#include "SchemaType.h"
+#include "TransportArch.h"
+#include "Version.h"
+
+namespace android {
+namespace vintf {
+
+// A binary snapshot of a HalManifest's instance table.
+//
+// Service-manager-driven compatibility checks re-read the same manifest XML
+// on every boot even though it only changes on an OTA. A snapshot is built
+// once from the parsed manifest, stamped with a fingerprint of the source
+// files, and stored next to the cacheable data; later boots validate the
+// fingerprint and answer instance queries by walking a flat image (fixed-size
+// records plus a string table) instead of parsing XML.
+//
+// The image is position-independent - all references are offsets - so it can
+// be consulted directly from a read-only mapping. ManifestSnapshot borrows
+// the image; the caller keeps the bytes alive.
+//
+// The snapshot intentionally covers only what instance lookups touch:
+// (format, package, version, interface, instance, transport, arch) plus the
+// manifest type and level. Anything else (sepolicy, kernel configs, xmlfiles)
+// still requires the parsed HalManifest, so a fingerprint mismatch or an
+// unparseable image must fall back to the XML path.
+
+namespace details {
+
+constexpr uint32_t kManifestSnapshotMagic = 0x50534e56;  // "VNSP", little endian
+constexpr uint32_t kManifestSnapshotVersion = 1u;
+
+// Fixed-size image layout. All offsets are in bytes from the start of the
+// image; strings are NUL-terminated and live in [stringsOffset,
+// stringsOffset + stringsSize).
+struct ManifestSnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t fingerprint;
+    uint32_t schemaType;
+    uint32_t level;
+    uint32_t instanceCount;
+    uint32_t instancesOffset;
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+};
+
+struct ManifestSnapshotInstance {
+    uint32_t package;    // string table offset
+    uint32_t interface;  // string table offset
+    uint32_t instance;   // string table offset
+    uint32_t majorVer;
+    uint32_t minorVer;
+    uint8_t format;     // HalFormat
+    uint8_t transport;  // Transport
+    uint8_t arch;       // Arch
+    uint8_t reserved;
+};
+
+static_assert(sizeof(ManifestSnapshotHeader) == 40, "padding crept into the image layout");
+static_assert(sizeof(ManifestSnapshotInstance) == 24, "padding crept into the image layout");
+
+constexpr uint64_t kFingerprintBasis = 0xcbf29ce484222325ull;
+
+}  // namespace details
+
+// FNV-1a over a chunk of bytes, chainable so multiple source files fold into
+// one fingerprint: fp = snapshotFingerprint(b, snapshotFingerprint(a)).
+// Include each file's path as well as its content so renames invalidate.
+inline uint64_t snapshotFingerprint(std::string_view bytes,
+                                    uint64_t seed = details::kFingerprintBasis) {
+    uint64_t hash = seed;
+    for (unsigned char c : bytes) {
+        hash = (hash ^ c) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Builds a snapshot image from a parsed manifest. 'fingerprint' identifies
+// the source files the manifest was built from.
+inline std::string buildManifestSnapshot(const HalManifest& manifest, uint64_t fingerprint) {
+    std::string strings;
+    std::map<std::string, uint32_t> internTable;
+    auto intern = [&](const std::string& s) -> uint32_t {
+        auto [it, inserted] = internTable.emplace(s, static_cast<uint32_t>(strings.size()));
+        if (inserted) {
+            strings.append(s);
+            strings.push_back('\0');
+        }
+        return it->second;
+    };
+
+    std::string records;
+    uint32_t instanceCount = 0;
+    manifest.forEachInstance([&](const ManifestInstance& mi) {
+        details::ManifestSnapshotInstance record{};
+        record.package = intern(mi.package());
+        record.interface = intern(mi.interface());
+        record.instance = intern(mi.instance());
+        record.majorVer = static_cast<uint32_t>(mi.version().majorVer);
+        record.minorVer = static_cast<uint32_t>(mi.version().minorVer);
+        record.format = static_cast<uint8_t>(mi.format());
+        record.transport = static_cast<uint8_t>(mi.transport());
+        record.arch = static_cast<uint8_t>(mi.arch());
+        records.append(reinterpret_cast<const char*>(&record), sizeof(record));
+        instanceCount++;
+        return true;  // continue
+    });
+
+    details::ManifestSnapshotHeader header{};
+    header.magic = details::kManifestSnapshotMagic;
+    header.version = details::kManifestSnapshotVersion;
+    header.fingerprint = fingerprint;
+    header.schemaType = static_cast<uint32_t>(manifest.type());
+    header.level = static_cast<uint32_t>(manifest.level());
+    header.instanceCount = instanceCount;
+    header.instancesOffset = static_cast<uint32_t>(sizeof(header));
+    header.stringsOffset = static_cast<uint32_t>(sizeof(header) + records.size());
+    header.stringsSize = static_cast<uint32_t>(strings.size());
+
+    std::string image;
+    image.reserve(sizeof(header) + records.size() + strings.size());
+    image.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    image.append(records);
+    image.append(strings);
+    return image;
+}
+
+// A validated, borrowed view of a snapshot image. Queries are pointer
+// chasing over the image; nothing is allocated after parse().
+class ManifestSnapshot {
+   public:
+    struct Instance {
+        std::string_view package;
+        std::string_view interface;
+        std::string_view instance;
+        Version version;
+        HalFormat format;
+        Transport transport;
+        Arch arch;
+    };
+
+    ManifestSnapshot() = default;
+
+    // Validates the image exhaustively - magic, version, bounds of every
+    // record and string offset - so queries can trust it without further
+    // checks. Returns BAD_VALUE (and leaves *out invalid) for images from
+    // a different libvintf version or with any out-of-bounds reference;
+    // the caller falls back to XML parsing.
+    static status_t parse(const void* data, size_t size, ManifestSnapshot* out) {
+        using namespace details;
+        out->mHeader = nullptr;
+        if (data == nullptr || size < sizeof(ManifestSnapshotHeader)) return BAD_VALUE;
+        const auto* base = static_cast<const uint8_t*>(data);
+        ManifestSnapshotHeader header;
+        memcpy(&header, base, sizeof(header));
+        if (header.magic != kManifestSnapshotMagic || header.version != kManifestSnapshotVersion) {
+            return BAD_VALUE;
+        }
+        const uint64_t recordsEnd = static_cast<uint64_t>(header.instancesOffset) +
+                                    static_cast<uint64_t>(header.instanceCount) *
+                                            sizeof(ManifestSnapshotInstance);
+        const uint64_t stringsEnd =
+                static_cast<uint64_t>(header.stringsOffset) + header.stringsSize;
+        if (header.instancesOffset < sizeof(header) || recordsEnd > size ||
+            header.stringsOffset < recordsEnd || stringsEnd > size) {
+            return BAD_VALUE;
+        }
+        // Every string must be NUL-terminated within the table.
+        if (header.stringsSize != 0 && base[stringsEnd - 1] != '\0') return BAD_VALUE;
+        const auto* instances = reinterpret_cast<const ManifestSnapshotInstance*>(
+                base + header.instancesOffset);
+        for (uint32_t i = 0; i < header.instanceCount; i++) {
+            if (instances[i].package >= header.stringsSize ||
+                instances[i].interface >= header.stringsSize ||
+                instances[i].instance >= header.stringsSize) {
+                return BAD_VALUE;
+            }
+        }
+        out->mBase = base;
+        out->mHeader = reinterpret_cast<const ManifestSnapshotHeader*>(base);
+        out->mInstances = instances;
+        return OK;
+    }
+
+    bool valid() const { return mHeader != nullptr; }
+    uint64_t fingerprint() const { return mHeader->fingerprint; }
+    SchemaType type() const { return static_cast<SchemaType>(mHeader->schemaType); }
+    Level level() const { return static_cast<Level>(mHeader->level); }
+    size_t instanceCount() const { return mHeader->instanceCount; }
+
+    // Apply func to all instances; stops early if func returns false.
+    // Returns false iff func returned false.
+    bool forEachInstance(const std::function<bool(const Instance&)>& func) const {
+        for (uint32_t i = 0; i < mHeader->instanceCount; i++) {
+            if (!func(instanceAt(i))) return false;
+        }
+        return true;
+    }
+
+    // Whether the manifest provides package@version::interface/instance.
+    // Matches with the manifest semantics: an instance at version v serves a
+    // request for version r iff v.minorAtLeast(r). Pass versions in the
+    // manifest's own convention (AIDL uses the fake AIDL major version).
+    bool hasInstance(HalFormat format, std::string_view package, const Version& version,
+                     std::string_view interface, std::string_view instance) const {
+        for (uint32_t i = 0; i < mHeader->instanceCount; i++) {
+            const Instance e = instanceAt(i);
+            if (e.format == format && e.package == package && e.version.minorAtLeast(version) &&
+                e.interface == interface && e.instance == instance) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+   private:
+    std::string_view stringAt(uint32_t offset) const {
+        // parse() checked offset < stringsSize and that the table ends in NUL.
+        return std::string_view(
+                reinterpret_cast<const char*>(mBase + mHeader->stringsOffset + offset));
+    }
+
+    Instance instanceAt(uint32_t i) const {
+        const details::ManifestSnapshotInstance& record = mInstances[i];
+        Instance e;
+        e.package = stringAt(record.package);
+        e.interface = stringAt(record.interface);
+        e.instance = stringAt(record.instance);
+        e.version = Version{record.majorVer, record.minorVer};
+        e.format = static_cast<HalFormat>(record.format);
+        e.transport = static_cast<Transport>(record.transport);
+        e.arch = static_cast<Arch>(record.arch);
+        return e;
+    }
+
+    const uint8_t* mBase = nullptr;
+    const details::ManifestSnapshotHeader* mHeader = nullptr;
+    const details::ManifestSnapshotInstance* mInstances = nullptr;
+};
+
+// Fingerprint-validated storage for one snapshot image. The cache owns the
+// image bytes; snapshots handed out stay valid as long as the cache does and
+// until the next load()/store().
+class ManifestSnapshotCache {
+   public:
+    ManifestSnapshotCache(const WritableFileSystem* fileSystem, std::string path)
+        : mFileSystem(fileSystem), mPath(std::move(path)) {}
+
+    // Loads the cached snapshot if it exists, parses, and carries
+    // 'fingerprint'. Returns NAME_NOT_FOUND or BAD_VALUE when the caller
+    // should re-parse the XML and store() the result.
+    status_t load(uint64_t fingerprint, ManifestSnapshot* out, std::string* error = nullptr) {
+        status_t status = mFileSystem->fetch(mPath, &mImage, error);
+        if (status != OK) return status;
+        status = ManifestSnapshot::parse(mImage.data(), mImage.size(), out);
+        if (status != OK) return status;
+        if (out->fingerprint() != fingerprint) {
+            *out = ManifestSnapshot();
+            return BAD_VALUE;
+        }
+        return OK;
+    }
+
+    // Builds the image from a freshly parsed manifest, writes it back for
+    // the next boot, and hands out a snapshot over it. A write failure is
+    // returned but *out is still usable for this process.
+    status_t store(const HalManifest& manifest, uint64_t fingerprint, ManifestSnapshot* out,
+                   std::string* error = nullptr) {
+        mImage = buildManifestSnapshot(manifest, fingerprint);
+        status_t status = ManifestSnapshot::parse(mImage.data(), mImage.size(), out);
+        if (status != OK) return status;
+        return mFileSystem->write(mPath, mImage, error);
+    }
+
+   private:
+    const WritableFileSystem* mFileSystem;
+    std::string mPath;
+    std::string mImage;
+};
+
+}  // namespace vintf
+}  // namespace android
+
+#endif  // ANDROID_VINTF_MANIFEST_SNAPSHOT_H
@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Shared-memory log transport between a logging process and logd.
+ *
+ * The socket transport costs one sendmsg() per message; a process emitting
+ * thousands of logs per second spends measurable CPU in those syscalls. A
+ * process may instead negotiate a per-process ring in shared memory: writes
+ * become a claim + memcpy with no syscall (except a wakeup when logd's
+ * reader has gone idle), and logd drains whole batches per wakeup, which is
+ * the burst coalescing on the reader side of the fence.
+ *
+ * Negotiation: the client creates a memfd of ANDROID_LOG_SHM_DEFAULT_SIZE +
+ * header, initializes it with android_log_shm_init(), and sends the command
+ * "shmRing <version>" with the fd attached via SCM_RIGHTS over the logd
+ * control socket. logd maps it and answers "success <version>" or fails,
+ * in which case the client keeps the socket transport. A full ring also
+ * falls back to the socket per message, so messages are never dropped by
+ * this layer and ordering per thread is preserved (both transports deliver
+ * to the same logd buffers, stamped with the same header timestamps).
+ *
+ * Ring protocol (multi-writer, single reader):
+ *  - Writers claim space with a CAS on 'head', copy the record, then
+ *    commit in claim order through 'committed' (ticket release: each
+ *    writer waits until 'committed' reaches its claim start, then
+ *    publishes its end). The reader only consults 'committed', so it
+ *    never sees a partially copied record and needs no per-record flags.
+ *  - A record is a 4-byte word (payload length, or the wrap flag when the
+ *    record would straddle the end of the ring) followed by the payload:
+ *    android_log_header_t plus the message, exactly the bytes the socket
+ *    transport sends.
+ *  - The commit spin is bounded by the copy time of records claimed
+ *    earlier (payloads are at most ANDROID_LOG_SHM_MAX_PAYLOAD bytes).
+ *
+ * This header is the protocol contract and is included by both liblog
+ * (writer) and logd (reader). It requires C11 atomics.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if !defined(__cplusplus)
+#include <stdatomic.h>
+#define ANDROID_LOG_SHM_ATOMIC(type) _Atomic(type)
+#else
+#include <atomic>
+#define ANDROID_LOG_SHM_ATOMIC(type) std::atomic<type>
+#endif
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define ANDROID_LOG_SHM_MAGIC 0x676f6c73 /* "slog" */
+#define ANDROID_LOG_SHM_VERSION 1
+
+/* Control-socket command carrying the ring memfd via SCM_RIGHTS. */
+#define ANDROID_LOG_SHM_NEGOTIATE_CMD "shmRing"
+
+/* Data area size; must be a power of two. */
+#define ANDROID_LOG_SHM_DEFAULT_SIZE (256 * 1024)
+#define ANDROID_LOG_SHM_MIN_SIZE (16 * 1024)
+
+/* android_log_header_t plus LOGGER_ENTRY_MAX_PAYLOAD fits well within. */
+#define ANDROID_LOG_SHM_MAX_PAYLOAD 4096
+
+#define ANDROID_LOG_SHM_HEADER_SIZE 128
+#define ANDROID_LOG_SHM_WRAP 0x80000000u
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size; /* data area bytes, power of two */
+  uint32_t reserved;
+
+  /* Next byte to claim; advanced by writers with CAS. */
+  ANDROID_LOG_SHM_ATOMIC(uint64_t) head;
+  /* Claims below this are fully copied; advanced by writers in claim order. */
+  ANDROID_LOG_SHM_ATOMIC(uint64_t) committed;
+  /* Next byte to consume; advanced only by the reader. */
+  ANDROID_LOG_SHM_ATOMIC(uint64_t) tail;
+
+  /* Nonzero while the reader is parked in android_log_shm_reader_wait(). */
+  ANDROID_LOG_SHM_ATOMIC(uint32_t) reader_sleeping;
+  /* Futex word bumped by writers to wake the reader. */
+  ANDROID_LOG_SHM_ATOMIC(uint32_t) wakeup;
+} android_log_shm_header_t;
+
+static inline uint8_t* android_log_shm_data(android_log_shm_header_t* ring) {
+  return (uint8_t*)ring + ANDROID_LOG_SHM_HEADER_SIZE;
+}
+
+/*
+ * Initializes 'mem' (of 'mem_size' bytes) as an empty ring. Returns 0, or
+ * -1 if the size is too small or the data area is not a power of two.
+ */
+static inline int android_log_shm_init(void* mem, size_t mem_size) {
+  android_log_shm_header_t* ring = (android_log_shm_header_t*)mem;
+  size_t size;
+
+  if (mem_size < ANDROID_LOG_SHM_HEADER_SIZE + ANDROID_LOG_SHM_MIN_SIZE) return -1;
+  size = mem_size - ANDROID_LOG_SHM_HEADER_SIZE;
+  if (size & (size - 1)) return -1;
+
+  memset(mem, 0, ANDROID_LOG_SHM_HEADER_SIZE);
+  ring->magic = ANDROID_LOG_SHM_MAGIC;
+  ring->version = ANDROID_LOG_SHM_VERSION;
+  ring->size = (uint32_t)size;
+  return 0;
+}
+
+/* Validates a mapping received from another process before using it. */
+static inline int android_log_shm_valid(const android_log_shm_header_t* ring, size_t mem_size) {
+  return ring->magic == ANDROID_LOG_SHM_MAGIC && ring->version == ANDROID_LOG_SHM_VERSION &&
+         ring->size >= ANDROID_LOG_SHM_MIN_SIZE && !(ring->size & (ring->size - 1)) &&
+         mem_size >= ANDROID_LOG_SHM_HEADER_SIZE + ring->size;
+}
+
+#if defined(__linux__)
+static inline void android_log_shm_cpu_relax(void) {
+  sched_yield();
+}
+#else
+static inline void android_log_shm_cpu_relax(void) {}
+#endif
+
+/*
+ * Writes one message (header + payload already marshalled by the caller,
+ * same bytes as the socket transport sends). Returns 0, or -1 when the
+ * message does not fit right now and the caller must fall back to the
+ * socket. Safe from multiple threads.
+ */
+static inline int android_log_shm_write(android_log_shm_header_t* ring, const void* msg,
+                                        size_t len) {
+  uint8_t* data = android_log_shm_data(ring);
+  const uint32_t size = ring->size;
+  uint32_t need, total, off, to_end, rec_off;
+  uint64_t head, tail;
+  int wrap;
+
+  if (len == 0 || len > ANDROID_LOG_SHM_MAX_PAYLOAD) return -1;
+  need = 4 + (((uint32_t)len + 3) & ~3u);
+
+  for (;;) {
+#if !defined(__cplusplus)
+    head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+#else
+    head = ring->head.load(std::memory_order_relaxed);
+    tail = ring->tail.load(std::memory_order_acquire);
+#endif
+    off = (uint32_t)head & (size - 1);
+    to_end = size - off;
+    wrap = to_end < need;
+    total = wrap ? to_end + need : need;
+    if (head - tail + total > size) return -1; /* full: socket fallback */
+#if !defined(__cplusplus)
+    if (atomic_compare_exchange_weak_explicit(&ring->head, &head, head + total,
+                                              memory_order_relaxed, memory_order_relaxed)) {
+      break;
+    }
+#else
+    if (ring->head.compare_exchange_weak(head, head + total, std::memory_order_relaxed)) {
+      break;
+    }
+#endif
+  }
+
+  rec_off = wrap ? 0 : off;
+  if (wrap) {
+    uint32_t wrap_word = ANDROID_LOG_SHM_WRAP;
+    memcpy(data + off, &wrap_word, 4);
+  }
+  {
+    uint32_t len_word = (uint32_t)len;
+    memcpy(data + rec_off, &len_word, 4);
+  }
+  memcpy(data + rec_off + 4, msg, len);
+
+  /* Commit in claim order so the reader sees a dense, fully-copied prefix. */
+#if !defined(__cplusplus)
+  while (atomic_load_explicit(&ring->committed, memory_order_acquire) != head) {
+    android_log_shm_cpu_relax();
+  }
+  atomic_store_explicit(&ring->committed, head + total, memory_order_release);
+  atomic_fetch_add_explicit(&ring->wakeup, 1, memory_order_release);
+  if (atomic_load_explicit(&ring->reader_sleeping, memory_order_acquire)) {
+#else
+  while (ring->committed.load(std::memory_order_acquire) != head) {
+    android_log_shm_cpu_relax();
+  }
+  ring->committed.store(head + total, std::memory_order_release);
+  ring->wakeup.fetch_add(1, std::memory_order_release);
+  if (ring->reader_sleeping.load(std::memory_order_acquire)) {
+#endif
+#if defined(__linux__)
+    syscall(SYS_futex, &ring->wakeup, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+  }
+  return 0;
+}
+
+/* android_log_shm_read_batch() result when the ring contents are malformed. */
+#define ANDROID_LOG_SHM_POISONED ((size_t)-1)
+
+/*
+ * Reads as many whole records as fit into 'buf' (logd side; single reader
+ * only). Each record is written as a 4-byte length followed by the message
+ * bytes, 4-byte aligned. Space is released to writers once per batch.
+ * Returns the number of bytes placed in 'buf' and the record count in
+ * '*num_records'; 0 means the ring is empty.
+ *
+ * The mapping is writable by the untrusted client, so nothing read from it
+ * is trusted: every cursor and length is bounds-checked before use, one call
+ * consumes at most one ring's worth of bytes, and the length word placed in
+ * 'buf' is the validated local copy, not a re-read of the shared word. Any
+ * violation returns ANDROID_LOG_SHM_POISONED without consuming; the caller
+ * must stop reading and detach the ring.
+ */
+static inline size_t android_log_shm_read_batch(android_log_shm_header_t* ring, void* buf,
+                                                size_t buf_len, size_t* num_records) {
+  uint8_t* data = android_log_shm_data(ring);
+  const uint32_t size = ring->size;
+  uint64_t tail, committed;
+  size_t used = 0;
+  uint8_t* out = (uint8_t*)buf;
+
+  *num_records = 0;
+#if !defined(__cplusplus)
+  tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  committed = atomic_load_explicit(&ring->committed, memory_order_acquire);
+#else
+  tail = ring->tail.load(std::memory_order_relaxed);
+  committed = ring->committed.load(std::memory_order_acquire);
+#endif
+
+  /* A well-formed ring never has more than one ring of unconsumed bytes;
+     this also bounds the loop below, since tail only advances. */
+  if (committed - tail > size) return ANDROID_LOG_SHM_POISONED;
+
+  while (tail != committed) {
+    uint32_t off = (uint32_t)tail & (size - 1);
+    uint32_t word, len, rec;
+
+    memcpy(&word, data + off, 4);
+    if (word & ANDROID_LOG_SHM_WRAP) {
+      uint32_t skip = size - off;
+      if (committed - tail < skip) return ANDROID_LOG_SHM_POISONED;
+      tail += skip;
+      continue;
+    }
+    len = word;
+    rec = 4 + ((len + 3) & ~3u);
+    if (len == 0 || len > ANDROID_LOG_SHM_MAX_PAYLOAD || rec > size - off ||
+        rec > committed - tail) {
+      return ANDROID_LOG_SHM_POISONED;
+    }
+    if (used + rec > buf_len) break;
+    memcpy(out + used, &len, 4);
+    memcpy(out + used + 4, data + off + 4, len);
+    memset(out + used + 4 + len, 0, rec - 4 - len);
+    used += rec;
+    (*num_records)++;
+    tail += rec;
+  }
+
+#if !defined(__cplusplus)
+  atomic_store_explicit(&ring->tail, tail, memory_order_release);
+#else
+  ring->tail.store(tail, std::memory_order_release);
+#endif
+  return used;
+}
+
+/*
+ * Parks the reader until a writer commits or 'timeout_ms' elapses
+ * (negative waits indefinitely). Call with the last observed wakeup value;
+ * returns the value to pass next time. Spurious returns are fine - the
+ * caller re-polls the ring.
+ */
+static inline uint32_t android_log_shm_reader_wait(android_log_shm_header_t* ring,
+                                                   uint32_t last_wakeup, int timeout_ms) {
+#if defined(__linux__)
+  struct timespec ts, *tsp = NULL;
+
+  if (timeout_ms >= 0) {
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    tsp = &ts;
+  }
+#if !defined(__cplusplus)
+  atomic_store_explicit(&ring->reader_sleeping, 1, memory_order_seq_cst);
+  if (atomic_load_explicit(&ring->wakeup, memory_order_acquire) == last_wakeup) {
+    syscall(SYS_futex, &ring->wakeup, FUTEX_WAIT, last_wakeup, tsp, NULL, 0);
+  }
+  atomic_store_explicit(&ring->reader_sleeping, 0, memory_order_release);
+  return atomic_load_explicit(&ring->wakeup, memory_order_acquire);
+#else
+  ring->reader_sleeping.store(1, std::memory_order_seq_cst);
+  if (ring->wakeup.load(std::memory_order_acquire) == last_wakeup) {
+    syscall(SYS_futex, &ring->wakeup, FUTEX_WAIT, last_wakeup, tsp, NULL, 0);
+  }
+  ring->reader_sleeping.store(0, std::memory_order_release);
+  return ring->wakeup.load(std::memory_order_acquire);
+#endif
+#else
+  (void)ring;
+  (void)timeout_ms;
+  return last_wakeup;
+#endif
+}
+
+#if defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+
+#include <audio_utils/BiquadFilter.h>
+#include <audio_utils/BiquadFilterCascade.h>
+#include <benchmark/benchmark.h>
+
+/*
+  Benchmarks the fused Biquad cascade against the equivalent chain of
+  BiquadFilter passes, at the speaker protection configuration (6 stages,
+  8 channels) and nearby points. The argument is the number of stages.
+*/
+
+static constexpr size_t kChannels = 8;
+static constexpr size_t kFrames = 960;
+
+static std::array<float, 5> stableBiquad(std::minstd_rand& gen) {
+    std::uniform_real_distribution<float> dis(-0.4f, 0.4f);
+    return { 1.f + dis(gen), dis(gen), dis(gen), dis(gen), dis(gen) };
+}
+
+static std::vector<float> makeBuffer(size_t samples) {
+    std::minstd_rand gen(samples);
+    std::uniform_real_distribution<float> dis(-1.f, 1.f);
+    std::vector<float> buf(samples);
+    for (auto& v : buf) v = dis(gen);
+    return buf;
+}
+
+static void BM_biquad_cascade_fused(benchmark::State& state) {
+    const size_t stages = state.range(0);
+    std::minstd_rand gen(stages);
+    android::audio_utils::BiquadFilterCascade<float> cascade(kChannels, stages);
+    for (size_t s = 0; s < stages; ++s) {
+        cascade.setCoefficients(s, stableBiquad(gen));
+    }
+    std::vector<float> in = makeBuffer(kFrames * kChannels);
+    std::vector<float> out(kFrames * kChannels);
+    for (auto _ : state) {
+        cascade.process(out.data(), in.data(), kFrames);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kFrames);
+}
+BENCHMARK(BM_biquad_cascade_fused)->Arg(2)->Arg(4)->Arg(6)->Arg(8);
+
+static void BM_biquad_cascade_serial(benchmark::State& state) {
+    const size_t stages = state.range(0);
+    std::minstd_rand gen(stages);
+    std::vector<android::audio_utils::BiquadFilter<float>> chain;
+    chain.reserve(stages);
+    for (size_t s = 0; s < stages; ++s) {
+        chain.emplace_back(kChannels, stableBiquad(gen));
+    }
+    std::vector<float> in = makeBuffer(kFrames * kChannels);
+    std::vector<float> out(kFrames * kChannels);
+    for (auto _ : state) {
+        chain[0].process(out.data(), in.data(), kFrames);
+        for (size_t s = 1; s < stages; ++s) {
+            chain[s].process(out.data(), out.data(), kFrames);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kFrames);
+}
+BENCHMARK(BM_biquad_cascade_serial)->Arg(2)->Arg(4)->Arg(6)->Arg(8);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+
+#include <audio_utils/mix_kernels.h>
+#include <benchmark/benchmark.h>
+
+/*
+  Benchmarks the mix/ramp/clamp kernels at mixer-thread buffer sizes.
+  96 frames is the FastMixer period on our current configuration; 960
+  frames is the normal mixer period at 48kHz. The track-count benchmarks
+  approximate a mixer pass over N active stereo float tracks.
+*/
+
+static constexpr size_t kStereo = 2;
+
+static std::vector<float> makeBuffer(size_t samples) {
+    std::minstd_rand gen(samples);
+    std::uniform_real_distribution<float> dis(-1.f, 1.f);
+    std::vector<float> buf(samples);
+    for (auto& v : buf) v = dis(gen);
+    return buf;
+}
+
+static void BM_mix_accumulate(benchmark::State& state) {
+    const size_t frames = state.range(0);
+    std::vector<float> in = makeBuffer(frames * kStereo);
+    std::vector<float> out = makeBuffer(frames * kStereo);
+    for (auto _ : state) {
+        android::audio_utils::intrinsics::mix_accumulate(
+                out.data(), in.data(), frames * kStereo, 0.7f);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * frames);
+}
+BENCHMARK(BM_mix_accumulate)->Arg(96)->Arg(960);
+
+static void BM_mix_accumulate_ramp(benchmark::State& state) {
+    const size_t frames = state.range(0);
+    std::vector<float> in = makeBuffer(frames * kStereo);
+    std::vector<float> out = makeBuffer(frames * kStereo);
+    for (auto _ : state) {
+        android::audio_utils::intrinsics::mix_accumulate_ramp(
+                out.data(), in.data(), frames, kStereo, 0.f, 1.f / frames);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * frames);
+}
+BENCHMARK(BM_mix_accumulate_ramp)->Arg(96)->Arg(960);
+
+static void BM_copy_with_clamp(benchmark::State& state) {
+    const size_t frames = state.range(0);
+    std::vector<float> in = makeBuffer(frames * kStereo);
+    std::vector<float> out(frames * kStereo);
+    for (auto _ : state) {
+        android::audio_utils::intrinsics::copy_with_clamp(
+                out.data(), in.data(), frames * kStereo, 2.f);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * frames);
+}
+BENCHMARK(BM_copy_with_clamp)->Arg(96)->Arg(960);
+
+// One mixer pass: ramp-mix `tracks` stereo tracks into an accumulator,
+// then clamp-copy to the sink, at the 96-frame FastMixer period.
+static void BM_mixer_pass_tracks(benchmark::State& state) {
+    const size_t tracks = state.range(0);
+    static constexpr size_t kFrames = 96;
+    std::vector<std::vector<float>> ins;
+    for (size_t t = 0; t < tracks; ++t) {
+        ins.push_back(makeBuffer(kFrames * kStereo));
+    }
+    std::vector<float> mix(kFrames * kStereo);
+    std::vector<float> sink(kFrames * kStereo);
+    for (auto _ : state) {
+        std::fill(mix.begin(), mix.end(), 0.f);
+        for (size_t t = 0; t < tracks; ++t) {
+            android::audio_utils::intrinsics::mix_accumulate_ramp(
+                    mix.data(), ins[t].data(), kFrames, kStereo, 0.5f, 0.001f);
+        }
+        android::audio_utils::intrinsics::copy_with_clamp(
+                sink.data(), mix.data(), kFrames * kStereo, 2.f);
+        benchmark::DoNotOptimize(sink.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kFrames * tracks);
+}
+BENCHMARK(BM_mixer_pass_tracks)->Arg(1)->Arg(8)->Arg(24);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "BiquadFilter.h"  // kernels, details::reduceCoefficients, intrinsic_utils
+
+// We conditionally include neon optimizations for ARM devices
+#pragma push_macro("USE_NEON")
+#undef USE_NEON
+
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#define USE_NEON
+#endif
+
+// Use dither to prevent subnormals for CPUs that raise an exception.
+#pragma push_macro("USE_DITHER")
+#undef USE_DITHER
+
+#if defined(__i386__) || defined(__x86_x64__)
+#define USE_DITHER
+#endif
+
+namespace android::audio_utils {
+
+/**
+ * Maximum number of cascade stages dispatched to the fused kernel.
+ *
+ * The limit is set by register pressure: with 4 channels per SIMD lane
+ * block, each stage keeps 2 state vectors resident, so 8 stages use 16
+ * vector registers plus the working sample - comfortable on ARM64 (32) and
+ * acceptable on x86-64 (16, some state spills beyond ~6 stages).
+ */
+static constexpr size_t kBiquadCascadeMaxStages = 8;
+
+namespace details {
+
+/**
+ * BiquadCascadeKernel applies STAGES Biquads in series to multichannel data,
+ * one channel per SIMD lane, with the whole cascade fused per frame.
+ *
+ * Compared with running BiquadStateSpace STAGES times over the buffer, the
+ * intermediate signal between stages never leaves registers, so the memory
+ * traffic is one load and one store per frame regardless of cascade depth.
+ * Each stage uses the same state space update as BiquadStateSpace (the
+ * coefficients here are already state-space converted), and the per-frame
+ * stage loop is unrolled at compile time via the STAGES template parameter.
+ *
+ * T is the data type (scalar or vector) - one channel per element.
+ * F is the filter coefficient type, scalar (coefficients shared across
+ * channels, broadcast by the intrinsics) in the current use.
+ */
+template <size_t STAGES, typename T, typename F>
+struct BiquadCascadeKernel {
+    F coef_[STAGES][kBiquadNumCoefs]; // state-space converted, a's negated.
+    T s_[STAGES][kBiquadNumDelays];   // delay states per stage.
+
+    // D is the data type.  It must be the same element type of T or F.
+    template <typename D>
+    __attribute__((always_inline))
+    void process(D* output, const D* input, size_t frames, size_t stride) {
+        using namespace intrinsics;
+        T s[STAGES][2];
+        #pragma unroll
+        for (size_t k = 0; k < STAGES; ++k) {
+            s[k][0] = s_[k][0];
+            s[k][1] = s_[k][1];
+        }
+        T x, y, new_s0;
+#ifdef USE_DITHER
+        constexpr D DITHER_VALUE = std::numeric_limits<float>::min() * (1 << 24); // use FLOAT
+        T dither = vdupn<T>(DITHER_VALUE); // NEON does not have vector + scalar acceleration.
+#endif
+        while (frames > 0) {
+            x = vld1<T>(input);
+            input += stride;
+#ifdef USE_DITHER
+            x = vadd(x, dither);
+            dither = vneg(dither);
+#endif
+            #pragma unroll
+            for (size_t k = 0; k < STAGES; ++k) {
+                // y = s0 + b0 * x
+                // s0' = s1 + b1ss * x - a1 * s0
+                // s1' = b2ss * x - a2 * s0
+                y = vmla(s[k][0], coef_[k][0], x);
+                new_s0 = vmla(vmla(s[k][1], coef_[k][1], x), coef_[k][3], s[k][0]);
+                s[k][1] = vmla(vmul(x, coef_[k][2]), coef_[k][4], s[k][0]);
+                s[k][0] = new_s0;
+                x = y; // feed the next stage without touching memory.
+            }
+            vst1(output, x);
+            output += stride;
+            frames--;
+        }
+        #pragma unroll
+        for (size_t k = 0; k < STAGES; ++k) {
+            s_[k][0] = s[k][0];
+            s_[k][1] = s[k][1];
+        }
+    }
+};
+
+// T is the SIMD block type covering sizeof(T) / sizeof(D) channels.
+// Coefficients are stage-major: coefs[stage * kBiquadNumCoefs + i].
+// Delays are stage-major and channel interleaved within a stage:
+// delays[(stage * kBiquadNumDelays + j) * delayStride + channel].
+template <size_t STAGES, typename T, typename D>
+void biquad_cascade_func_impl(D* out, const D* in, size_t frames, size_t stride,
+        size_t channelCount, D* delays, const D* coefs, size_t delayStride) {
+    using namespace intrinsics;
+    constexpr size_t elements = sizeof(T) / sizeof(D);
+
+    for (size_t offset = 0; offset < channelCount; offset += elements) {
+        BiquadCascadeKernel<STAGES, T, D> kernel;
+        for (size_t k = 0; k < STAGES; ++k) {
+            for (size_t i = 0; i < kBiquadNumCoefs; ++i) {
+                kernel.coef_[k][i] = coefs[k * kBiquadNumCoefs + i];
+            }
+            for (size_t j = 0; j < kBiquadNumDelays; ++j) {
+                kernel.s_[k][j] = vld1<T>(
+                        &delays[(k * kBiquadNumDelays + j) * delayStride + offset]);
+            }
+        }
+        kernel.process(&out[offset], &in[offset], frames, stride);
+        for (size_t k = 0; k < STAGES; ++k) {
+            for (size_t j = 0; j < kBiquadNumDelays; ++j) {
+                vst1(&delays[(k * kBiquadNumDelays + j) * delayStride + offset],
+                        kernel.s_[k][j]);
+            }
+        }
+    }
+}
+
+// Splits the channels into SIMD lane blocks and runs the fused kernel on
+// each.  4-lane blocks are primary: they keep the full 8-stage state
+// resident in registers; the remainder runs 2-wide then scalar.
+template <size_t STAGES, typename D>
+void biquad_cascade_func(D* out, const D* in, size_t frames, size_t stride,
+        size_t channelCount, D* delays, const D* coefs, size_t delayStride) {
+#ifdef USE_NEON
+    using alt_4_t = float32x4_t;
+#else
+    using alt_4_t = intrinsics::internal_array_t<float, 4>;
+#endif
+    size_t offset = 0;
+    if constexpr (std::is_same_v<D, float>) {
+        const size_t blocked4 = (channelCount - offset) & ~3;
+        if (blocked4 > 0) {
+            biquad_cascade_func_impl<STAGES, alt_4_t>(out + offset, in + offset,
+                    frames, stride, blocked4, delays + offset, coefs, delayStride);
+            offset += blocked4;
+        }
+        if (channelCount - offset >= 2) {
+            biquad_cascade_func_impl<STAGES, intrinsics::internal_array_t<float, 2>>(
+                    out + offset, in + offset, frames, stride, 2,
+                    delays + offset, coefs, delayStride);
+            offset += 2;
+        }
+    }
+    if (channelCount - offset > 0) {
+        biquad_cascade_func_impl<STAGES, D>(out + offset, in + offset,
+                frames, stride, channelCount - offset, delays + offset, coefs,
+                delayStride);
+    }
+}
+
+} // namespace details
+
+/**
+ * BiquadFilterCascade
+ *
+ * A multichannel cascade of up to kBiquadCascadeMaxStages Biquad sections
+ * applied in series, with the same coefficients for every channel of a
+ * stage.  This is the speaker protection / crossover configuration: a small
+ * fixed chain of sections over many channels.
+ *
+ * The channels are laid out one per SIMD lane (structure-of-arrays state)
+ * and all stages of the cascade are fused into a single pass over the
+ * buffer, so the inter-stage signal stays in registers instead of making
+ * one buffer round trip per section as N separate BiquadFilter::process()
+ * calls would.  Numerically each stage is the BiquadStateSpace update, so
+ * results match an equivalent chain of BiquadFilter instances using the
+ * default options.
+ *
+ * Like BiquadFilter, compile with -ffast-math for best code generation.
+ *
+ * \param D type variable representing the data type, one of float or double.
+ *          The default is float.  SIMD lane blocking currently engages for
+ *          float; double runs the same fused update scalar-wise.
+ */
+template <typename D = float>
+class BiquadFilterCascade {
+public:
+    /**
+     * Constructs a cascade.
+     *
+     * \param channelCount number of channels processed in parallel.
+     * \param numStages number of Biquad sections in series,
+     *                  1 to kBiquadCascadeMaxStages.
+     */
+    BiquadFilterCascade(size_t channelCount, size_t numStages)
+            : mChannelCount(channelCount)
+            , mNumStages(numStages)
+            , mCoefs(numStages * kBiquadNumCoefs)
+            , mDelays(numStages * kBiquadNumDelays * channelCount) {
+        assert(numStages >= 1 && numStages <= kBiquadCascadeMaxStages);
+    }
+
+    /**
+     * \brief Sets the coefficients of one cascade stage.
+     *
+     * Accepts the same 5 (normalized) or 6 (general) coefficient containers
+     * as BiquadFilter::setCoefficients().  The coefficients are stored
+     * state-space converted, once, at set time.
+     *
+     * \param stage zero based stage index, 0 to numStages-1.
+     * \param coefs the coefficient container.
+     * \return true if this stage is stable, otherwise false.
+     */
+    template <typename T = std::array<D, kBiquadNumCoefs>>
+    bool setCoefficients(size_t stage, const T& coefs) {
+        assert(stage < mNumStages);
+        const auto lcoef = details::reduceCoefficients<D, T>(coefs);
+        D* c = &mCoefs[stage * kBiquadNumCoefs];
+        // state space conversion, denominator negated (see BiquadStateSpace).
+        c[0] = lcoef[0];                       // b0
+        c[1] = lcoef[1] - lcoef[0] * lcoef[3]; // b1 - b0 * a1
+        c[2] = lcoef[2] - lcoef[0] * lcoef[4]; // b2 - b0 * a2
+        c[3] = -lcoef[3];                      // -a1
+        c[4] = -lcoef[4];                      // -a2
+        return details::isStable(lcoef[3], lcoef[4]);
+    }
+
+    /**
+     * Returns true if the given stage is stable.
+     *
+     * \param stage zero based stage index, asserts if stage >= numStages.
+     */
+    bool isStable(size_t stage) const {
+        assert(stage < mNumStages);
+        const D* c = &mCoefs[stage * kBiquadNumCoefs];
+        return details::isStable(-c[3], -c[4]);
+    }
+
+    /**
+     * \return number of cascade stages.
+     */
+    size_t getNumStages() const {
+        return mNumStages;
+    }
+
+    /**
+     * \brief Filters the input data through the whole cascade.
+     *
+     * \param out     pointer to the output data
+     * \param in      pointer to the input data
+     * \param frames  number of audio frames to be processed
+     */
+    void process(D* out, const D* in, size_t frames) {
+        process(out, in, frames, mChannelCount);
+    }
+
+    /**
+     * \brief Filters the input data through the whole cascade, with stride.
+     *
+     * \param out     pointer to the output data
+     * \param in      pointer to the input data
+     * \param frames  number of audio frames to be processed
+     * \param stride  the total number of samples associated with a frame,
+     *                if not channelCount.
+     */
+    void process(D* out, const D* in, size_t frames, size_t stride) {
+        assert(stride >= mChannelCount);
+        // Dispatch the runtime stage count to the compile-time unrolled kernel.
+        switch (mNumStages) {
+        case 1: processStages<1>(out, in, frames, stride); break;
+        case 2: processStages<2>(out, in, frames, stride); break;
+        case 3: processStages<3>(out, in, frames, stride); break;
+        case 4: processStages<4>(out, in, frames, stride); break;
+        case 5: processStages<5>(out, in, frames, stride); break;
+        case 6: processStages<6>(out, in, frames, stride); break;
+        case 7: processStages<7>(out, in, frames, stride); break;
+        case 8: processStages<8>(out, in, frames, stride); break;
+        default: assert(false);
+        }
+    }
+
+    /**
+     * \brief Clears the delay elements of every stage.
+     */
+    void clear() {
+        std::fill(mDelays.begin(), mDelays.end(), D(0));
+    }
+
+private:
+    template <size_t STAGES>
+    void processStages(D* out, const D* in, size_t frames, size_t stride) {
+        details::biquad_cascade_func<STAGES>(out, in, frames, stride,
+                mChannelCount, mDelays.data(), mCoefs.data(), mChannelCount);
+    }
+
+    const size_t mChannelCount;
+    const size_t mNumStages;
+
+    /**
+     * Stage-major coefficient storage, 5 state-space converted coefficients
+     * per stage (shared by all channels of the stage).
+     */
+    std::vector<D> mCoefs;
+
+    /**
+     * Delay state, stage-major, channel interleaved within a stage:
+     * mDelays[(stage * 2 + j) * channelCount + channel] is s_{j+1} of the
+     * given stage and channel.
+     */
+    std::vector<D> mDelays;
+};
+
+} // namespace android::audio_utils
+
+#pragma pop_macro("USE_DITHER")
+#pragma pop_macro("USE_NEON")
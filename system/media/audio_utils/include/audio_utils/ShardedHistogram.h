@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AUDIO_UTILS_SHARDED_HISTOGRAM_H
+#define AUDIO_UTILS_SHARDED_HISTOGRAM_H
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace android::audio_utils {
+
+/**
+ * A multi-writer variant of Histogram for recording from real-time threads.
+ *
+ * The bin layout and value-to-bin mapping match Histogram, but add() may be
+ * called concurrently from any number of threads. Each recording thread
+ * increments a bin in a per-CPU shard with a relaxed atomic add, so the
+ * record path has no locks, no stores shared with threads on other CPUs
+ * (absent migration), and no ordering cost; it is safe from threads running
+ * at SCHED_FIFO priority.
+ *
+ * The reader side merges the shards on demand. Because increments are
+ * relaxed, a merge is not an instantaneous snapshot: counts recorded
+ * concurrently with the merge may or may not be included, but every count
+ * is eventually visible and none is ever lost. That is the right trade for
+ * a latency telemetry surface.
+ *
+ * Unlike Histogram there is no last-item-number tracking; maintaining a
+ * global item sequence would reintroduce a contended counter in the record
+ * path.
+ */
+class ShardedHistogram {
+public:
+    /**
+     * Construct a sharded histogram.
+     * @param numBinsInRange number of bins to create
+     * @param binWidth width of each bin. Must be positive.
+     * @param numShards number of shards, rounded up to a power of two.
+     *                  Defaults to the number of CPUs.
+     */
+    ShardedHistogram(int32_t numBinsInRange, int32_t binWidth, size_t numShards = 0)
+    : mBinWidth(binWidth)
+    , mNumBins(numBinsInRange + kExtraBins)
+    , mShardMask(roundUpToPowerOfTwo(numShards != 0
+            ? numShards : std::thread::hardware_concurrency()) - 1)
+    , mShards(std::make_unique<Shard[]>(mShardMask + 1))
+    {
+        assert(binWidth > 0);
+        for (size_t s = 0; s <= mShardMask; ++s) {
+            mShards[s].bins = std::make_unique<std::atomic<uint64_t>[]>(mNumBins);
+            for (size_t i = 0; i < mNumBins; ++i) {
+                mShards[s].bins[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Add another item to the histogram.
+     * The value will be divided by the binWidth to determine the bin index.
+     * Lock-free and safe to call from any thread, including real-time threads.
+     * @param value
+     */
+    void add(int32_t value) {
+        int32_t binIndex = (value + mBinWidth) / mBinWidth;
+        binIndex = std::max(binIndex, 0); // put values below range in bottom bin
+        binIndex = std::min(binIndex, (int32_t)mNumBins - 1);
+                                          // put values above range in top bin
+        mShards[currentShard()].bins[binIndex].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Reset all counters to zero.
+     * May run concurrently with add(); increments racing with the reset may
+     * land on either side of it.
+     */
+    void clear() {
+        for (size_t s = 0; s <= mShardMask; ++s) {
+            for (size_t i = 0; i < mNumBins; ++i) {
+                mShards[s].bins[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @return original number of bins passed to the constructor
+     */
+    int32_t getNumBinsInRange() const {
+        return mNumBins - kExtraBins;
+    }
+
+    /**
+     * @return number of shards (always a power of two)
+     */
+    size_t getNumShards() const {
+        return mShardMask + 1;
+    }
+
+    /**
+     * @return number of items below the lowest bin
+     */
+    uint64_t getCountBelowRange() const {
+        return mergedBin(0);
+    }
+
+    /**
+     * @param binIndex between 0 and numBins-1
+     * @return number of items for the given bin index, merged across shards
+     */
+    uint64_t getCount(int32_t binIndex) const {
+        if (binIndex < 0 || binIndex >= getNumBinsInRange()) {
+            return 0;
+        }
+        return mergedBin(binIndex + 1);
+    }
+
+    /**
+     * @return total number of items added, merged across shards
+     */
+    uint64_t getCount() const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < mNumBins; ++i) {
+            total += mergedBin(i);
+        }
+        return total;
+    }
+
+    /**
+     * @return number of items above the highest bin
+     */
+    uint64_t getCountAboveRange() const {
+        return mergedBin(mNumBins - 1);
+    }
+
+    /**
+     * Merge the shards into a plain bin vector, indexed like getCount().
+     * One pass over the shards, so cheaper than repeated getCount() calls
+     * when reporting the whole histogram.
+     * @return counts for bins 0..numBinsInRange-1
+     */
+    std::vector<uint64_t> merge() const {
+        std::vector<uint64_t> bins(getNumBinsInRange());
+        for (size_t i = 0; i < bins.size(); ++i) {
+            bins[i] = mergedBin(i + 1);
+        }
+        return bins;
+    }
+
+    /**
+     * Dump the merged bins in CSV format, which can be easily imported into
+     * a spreadsheet.
+     * @return string bins in CSV format
+     */
+    std::string dump() const {
+        std::stringstream result;
+        uint64_t count = getCountBelowRange();
+        if (count > 0) {
+            result << "below range = " << count << std::endl;
+        }
+        result << "index, start, count" << std::endl;
+        for (size_t i = 1; i < mNumBins - 1; i++) {
+            const uint64_t binCount = mergedBin(i);
+            if (binCount > 0) {
+                size_t properIndex = i - 1;
+                result << properIndex;
+                result << ", " << (properIndex * mBinWidth);
+                result << ", " << binCount;
+                result << std::endl;
+            }
+        }
+        count = getCountAboveRange();
+        if (count > 0) {
+            result << "above range = " << count << std::endl;
+        }
+        return result.str();
+    }
+
+private:
+    static constexpr int kExtraBins = 2; // for out of range values
+    static constexpr size_t kCacheLineSize = 64;
+
+    // Each shard owns its bin array; the shard descriptors are padded so
+    // that pointer loads from different CPUs do not share a cache line.
+    // The bin arrays themselves come from separate allocations.
+    struct alignas(kCacheLineSize) Shard {
+        std::unique_ptr<std::atomic<uint64_t>[]> bins;
+    };
+
+    static size_t roundUpToPowerOfTwo(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    size_t currentShard() const {
+#ifdef __linux__
+        const int cpu = sched_getcpu();
+        if (cpu >= 0) {
+            return (size_t)cpu & mShardMask;
+        }
+#endif
+        // Fallback: spread threads across shards by thread identity.
+        return std::hash<std::thread::id>{}(std::this_thread::get_id()) & mShardMask;
+    }
+
+    uint64_t mergedBin(size_t binIndex) const {
+        uint64_t total = 0;
+        for (size_t s = 0; s <= mShardMask; ++s) {
+            total += mShards[s].bins[binIndex].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    const int32_t mBinWidth;
+    const size_t mNumBins;
+    const size_t mShardMask;
+    std::unique_ptr<Shard[]> mShards;
+};
+
+} // namespace
+#endif //AUDIO_UTILS_SHARDED_HISTOGRAM_H
@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_FORMAT_KERNELS_H
+#define ANDROID_AUDIO_FORMAT_KERNELS_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(USE_NEON) || defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define AUDIO_FORMAT_KERNELS_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#define AUDIO_FORMAT_KERNELS_SSE 1
+#endif
+
+/*
+  Vectorized sample-format conversion kernels for the hot
+  memcpy_by_audio_format() cases (int16 <-> float, 24-bit packed -> float),
+  plus fused convert+volume and convert+interleave variants so a conversion
+  stage makes one pass over the data instead of converting and then scaling
+  or interleaving separately.
+
+  Volume is folded into the conversion's scale factor, so the fused volume
+  variants cost the same as the plain conversions. Like the rest of
+  audio_utils, the SIMD paths are selected at compile time: NEON is part of
+  the Android ARM baseline and SSE2/SSSE3 of the x86 baseline, so there is
+  no runtime dispatch to pay for on either.
+
+  Conversion semantics match primitives.h: float is scaled so int16 32768.0
+  maps to 1.0, int16-from-float rounds to nearest and saturates (NaN lands
+  on a rail rather than wrapping), and 24-bit packed is little-endian with
+  q23 normalization.
+*/
+
+namespace android::audio_utils::format {
+
+inline constexpr float kFloatFromI16 = 1.f / (1 << 15);
+inline constexpr float kFloatFromQ31 = 1.f / (1u << 31);
+
+/**
+ * dst[i] = src[i] * volume / 32768, for count samples.
+ */
+inline void convert_to_float_from_i16_volume(float* dst, const int16_t* src, size_t count,
+                                             float volume) {
+    const float gain = volume * kFloatFromI16;
+    size_t i = 0;
+#if defined(AUDIO_FORMAT_KERNELS_NEON)
+    const float32x4_t vgain = vdupq_n_f32(gain);
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t in = vld1q_s16(src + i);
+        const float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(in)));
+        const float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(in)));
+        vst1q_f32(dst + i, vmulq_f32(lo, vgain));
+        vst1q_f32(dst + i + 4, vmulq_f32(hi, vgain));
+    }
+#elif defined(AUDIO_FORMAT_KERNELS_SSE)
+    const __m128 vgain = _mm_set1_ps(gain);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // Sign extend by moving each int16 to the top half of an int32
+        // lane and shifting back down arithmetically.
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), vgain));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vgain));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = src[i] * gain;
+    }
+}
+
+inline void convert_to_float_from_i16(float* dst, const int16_t* src, size_t count) {
+    convert_to_float_from_i16_volume(dst, src, count, 1.f);
+}
+
+/**
+ * dst[i] = clamp16(round(src[i] * volume * 32768)), for count samples.
+ * NaN saturates to a rail instead of passing through.
+ */
+inline void convert_to_i16_from_float_volume(int16_t* dst, const float* src, size_t count,
+                                             float volume) {
+    const float gain = volume * (1 << 15);
+    size_t i = 0;
+#if defined(AUDIO_FORMAT_KERNELS_NEON) && defined(__aarch64__)
+    const float32x4_t vgain = vdupq_n_f32(gain);
+    for (; i + 8 <= count; i += 8) {
+        // Round to nearest, then saturating narrow.
+        const int32x4_t lo = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(src + i), vgain));
+        const int32x4_t hi = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(src + i + 4), vgain));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+#elif defined(AUDIO_FORMAT_KERNELS_SSE)
+    const __m128 vgain = _mm_set1_ps(gain);
+    for (; i + 8 <= count; i += 8) {
+        // cvtps rounds to nearest; packs saturates to int16. NaN converts
+        // to INT_MIN and therefore saturates to -32768.
+        const __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), vgain));
+        const __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), vgain));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < count; ++i) {
+        // nearbyintf rounds to nearest even, matching the vector paths.
+        const float v = nearbyintf(src[i] * gain);
+        dst[i] = !(v >= -32768.f) ? -32768 : !(v <= 32767.f) ? 32767 : static_cast<int16_t>(v);
+    }
+}
+
+inline void convert_to_i16_from_float(int16_t* dst, const float* src, size_t count) {
+    convert_to_i16_from_float_volume(dst, src, count, 1.f);
+}
+
+/**
+ * dst[i] = q23(src 3-byte little-endian) * volume / 2^23, for count samples.
+ */
+inline void convert_to_float_from_p24_volume(float* dst, const uint8_t* src, size_t count,
+                                             float volume) {
+    // Place the 24 payload bits in the top of an int32 and normalize by
+    // 2^31; this equals (q23 >> 8 semantics) / 2^23 and needs no extra
+    // shift instruction.
+    const float gain = volume * kFloatFromQ31;
+    size_t i = 0;
+#if defined(AUDIO_FORMAT_KERNELS_NEON)
+    const float32x4_t vgain = vdupq_n_f32(gain);
+    for (; i + 8 <= count; i += 8, src += 24) {
+        const uint8x8x3_t bytes = vld3_u8(src);  // bytes.val[k] = byte k of 8 samples
+        // The int32 is b2<<24 | b1<<16 | b0<<8: its low u16 half is b0<<8
+        // and its high u16 half is b2<<8 | b1.
+        const uint16x8_t lo16 = vshll_n_u8(bytes.val[0], 8);
+        const uint16x8_t hi16 =
+                vorrq_u16(vshlq_n_u16(vmovl_u8(bytes.val[2]), 8), vmovl_u8(bytes.val[1]));
+        const uint32x4_t lo = vorrq_u32(vshll_n_u16(vget_low_u16(hi16), 16),
+                                        vmovl_u16(vget_low_u16(lo16)));
+        const uint32x4_t hi = vorrq_u32(vshll_n_u16(vget_high_u16(hi16), 16),
+                                        vmovl_u16(vget_high_u16(lo16)));
+        vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(lo)), vgain));
+        vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(hi)), vgain));
+    }
+#elif defined(AUDIO_FORMAT_KERNELS_SSE) && defined(__SSSE3__)
+    const __m128 vgain = _mm_set1_ps(gain);
+    // Expand 12 packed bytes to 4 dwords with the sample bytes in lanes
+    // [1..3] and lane 0 zeroed (0x80 selects zero).
+    const __m128i shuffle = _mm_set_epi8(11, 10, 9, -128, 8, 7, 6, -128,
+                                         5, 4, 3, -128, 2, 1, 0, -128);
+    // Each step consumes 12 bytes but loads 16, so stop while at least 6
+    // samples (18 bytes) remain readable.
+    for (; i + 6 <= count; i += 4, src += 12) {
+        const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i q31 = _mm_shuffle_epi8(raw, shuffle);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(q31), vgain));
+    }
+#endif
+    for (; i < count; ++i, src += 3) {
+        const uint32_t q31 = (static_cast<uint32_t>(src[0]) << 8) |
+                             (static_cast<uint32_t>(src[1]) << 16) |
+                             (static_cast<uint32_t>(src[2]) << 24);
+        dst[i] = static_cast<int32_t>(q31) * gain;
+    }
+}
+
+inline void convert_to_float_from_p24(float* dst, const uint8_t* src, size_t count) {
+    convert_to_float_from_p24_volume(dst, src, count, 1.f);
+}
+
+/**
+ * Fused convert + interleave: planar int16 left/right to interleaved float
+ * stereo with per-channel gain, one pass.
+ * dst[2*f] = left[f] * leftVolume / 32768, dst[2*f+1] likewise from right.
+ */
+inline void interleave_stereo_to_float_from_i16(float* dst, const int16_t* left,
+                                                const int16_t* right, size_t frames,
+                                                float leftVolume = 1.f, float rightVolume = 1.f) {
+    const float lgain = leftVolume * kFloatFromI16;
+    const float rgain = rightVolume * kFloatFromI16;
+    size_t f = 0;
+#if defined(AUDIO_FORMAT_KERNELS_NEON)
+    const float32x4_t vl = vdupq_n_f32(lgain);
+    const float32x4_t vr = vdupq_n_f32(rgain);
+    for (; f + 4 <= frames; f += 4) {
+        const float32x4_t l =
+                vmulq_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16(left + f))), vl);
+        const float32x4_t r =
+                vmulq_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16(right + f))), vr);
+        float32x4x2_t out = {{l, r}};
+        vst2q_f32(dst + 2 * f, out);  // interleaving store
+    }
+#elif defined(AUDIO_FORMAT_KERNELS_SSE)
+    const __m128 vl = _mm_set1_ps(lgain);
+    const __m128 vr = _mm_set1_ps(rgain);
+    for (; f + 4 <= frames; f += 4) {
+        const __m128i li = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(left + f));
+        const __m128i ri = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(right + f));
+        const __m128 l = _mm_mul_ps(
+                _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(li, li), 16)), vl);
+        const __m128 r = _mm_mul_ps(
+                _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(ri, ri), 16)), vr);
+        _mm_storeu_ps(dst + 2 * f, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(dst + 2 * f + 4, _mm_unpackhi_ps(l, r));
+    }
+#endif
+    for (; f < frames; ++f) {
+        dst[2 * f] = left[f] * lgain;
+        dst[2 * f + 1] = right[f] * rgain;
+    }
+}
+
+/**
+ * Fused convert + interleave for arbitrary channel counts (scalar; the
+ * stereo case above covers the layout AudioFlinger's conversion stages
+ * actually hit).
+ * dst[f * channels + ch] = src[ch][f] * volume / 32768.
+ */
+inline void interleave_to_float_from_i16(float* dst, const int16_t* const* src, size_t channels,
+                                         size_t frames, float volume = 1.f) {
+    if (channels == 2) {
+        interleave_stereo_to_float_from_i16(dst, src[0], src[1], frames, volume, volume);
+        return;
+    }
+    const float gain = volume * kFloatFromI16;
+    for (size_t f = 0; f < frames; ++f) {
+        for (size_t ch = 0; ch < channels; ++ch) {
+            *dst++ = src[ch][f] * gain;
+        }
+    }
+}
+
+}  // namespace android::audio_utils::format
+
+#endif  // !ANDROID_AUDIO_FORMAT_KERNELS_H
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_MIX_KERNELS_H
+#define ANDROID_AUDIO_MIX_KERNELS_H
+
+#include <stddef.h>
+
+#include <audio_utils/intrinsic_utils.h>
+
+/*
+  Wide-width mix, volume-ramp, and clamp kernels for float audio, built on
+  the intrinsic_utils vector templates so they compile to NEON/ASIMD on ARM
+  and to equivalent scalar code elsewhere. These are the inner loops that
+  dominate a mixer thread at typical 96-frame buffer sizes; keeping them
+  here (rather than inside a mixer implementation) lets AudioMixer,
+  FastMixer, and the AudioFlinger sink path share one set of kernels.
+
+  Volume ramps are per-frame: all channels of a frame get the same gain.
+  The vector paths specialize the common mono and stereo interleaved
+  layouts; other channel counts fall back to scalar code.
+*/
+
+namespace android::audio_utils::intrinsics {
+
+// Eight floats per iteration is the sweet spot on the cores we target:
+// two q-register mul-accumulates per loop hide the load latency.
+#ifdef USE_NEON
+using mix_vector_t = internal_array_t<float32x4_t, 2>;
+#else
+using mix_vector_t = internal_array_t<float, 8>;
+#endif
+inline constexpr size_t kMixVectorFloats = sizeof(mix_vector_t) / sizeof(float);
+
+/**
+ * out[i] += in[i] * volume, for count samples (any interleaving).
+ */
+inline void mix_accumulate(float* out, const float* in, size_t count, float volume) {
+    size_t i = 0;
+    for (; i + kMixVectorFloats <= count; i += kMixVectorFloats) {
+        mix_vector_t acc = vld1<mix_vector_t>(out + i);
+        acc = vmla(acc, vld1<mix_vector_t>(in + i), volume);
+        vst1(out + i, acc);
+    }
+    for (; i < count; ++i) {
+        out[i] += in[i] * volume;
+    }
+}
+
+/**
+ * out[frame * channels + ch] += in[...] * (volume + frame * volumeInc),
+ * for `frames` frames of `channels` interleaved channels.
+ *
+ * The caller is responsible for choosing volumeInc so the ramp lands on the
+ * target volume at the end of the buffer (as AudioMixer does).
+ */
+inline void mix_accumulate_ramp(float* out, const float* in, size_t frames, size_t channels,
+                                float volume, float volumeInc) {
+    if (channels == 1 || channels == 2) {
+        // Build a per-lane gain vector whose lanes hold the gains of the
+        // frames in one vector-width chunk, then step the whole vector by
+        // the per-chunk increment.
+        float lane_gain[kMixVectorFloats];
+        const size_t frames_per_chunk = kMixVectorFloats / channels;
+        for (size_t lane = 0; lane < kMixVectorFloats; ++lane) {
+            lane_gain[lane] = volume + volumeInc * (lane / channels);
+        }
+        mix_vector_t vgain = vld1<mix_vector_t>(lane_gain);
+        const mix_vector_t vstep = vdupn<mix_vector_t>(volumeInc * frames_per_chunk);
+
+        size_t frame = 0;
+        const size_t total = frames * channels;
+        size_t i = 0;
+        for (; i + kMixVectorFloats <= total; i += kMixVectorFloats) {
+            mix_vector_t acc = vld1<mix_vector_t>(out + i);
+            acc = vmla(acc, vld1<mix_vector_t>(in + i), vgain);
+            vst1(out + i, acc);
+            vgain = vadd(vgain, vstep);
+            frame += frames_per_chunk;
+        }
+        volume += volumeInc * frame;
+        for (; frame < frames; ++frame, volume += volumeInc) {
+            for (size_t ch = 0; ch < channels; ++ch, ++i) {
+                out[i] += in[i] * volume;
+            }
+        }
+        return;
+    }
+
+    // Uncommon interleavings: scalar ramp.
+    for (size_t frame = 0, i = 0; frame < frames; ++frame, volume += volumeInc) {
+        for (size_t ch = 0; ch < channels; ++ch, ++i) {
+            out[i] += in[i] * volume;
+        }
+    }
+}
+
+/**
+ * out[i] = clamp(in[i], -absMax, absMax), for count samples. NaN is mapped
+ * to a limit, insulating HALs that mishandle it. in == out is allowed.
+ */
+inline void copy_with_clamp(float* out, const float* in, size_t count, float absMax) {
+    size_t i = 0;
+#if defined(__aarch64__)
+    // vmaxnm/vminnm treat NaN as a missing operand, so a NaN input clamps
+    // to a limit instead of propagating. (Plain vmax/vmin would pass the
+    // NaN through, which is the one thing this function must not do.)
+    const float32x4_t vmax_limit = vdupq_n_f32(absMax);
+    const float32x4_t vmin_limit = vdupq_n_f32(-absMax);
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t v0 = vld1q_f32(in + i);
+        float32x4_t v1 = vld1q_f32(in + i + 4);
+        v0 = vminnmq_f32(vmaxnmq_f32(v0, vmin_limit), vmax_limit);
+        v1 = vminnmq_f32(vmaxnmq_f32(v1, vmin_limit), vmax_limit);
+        vst1q_f32(out + i, v0);
+        vst1q_f32(out + i + 4, v1);
+    }
+#endif
+    for (; i < count; ++i) {
+        const float v = in[i];
+        // The comparisons are written so NaN fails them and clamps.
+        out[i] = !(v >= -absMax) ? -absMax : !(v <= absMax) ? absMax : v;
+    }
+}
+
+}  // namespace android::audio_utils::intrinsics
+
+#endif  // !ANDROID_AUDIO_MIX_KERNELS_H
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "intrinsic_utils.h"
+#include "power.h"  // audio_utils_power_from_energy
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+/**
+ * Batched multichannel power / peak computation.
+ *
+ * audio_utils_compute_power_mono() walks the buffer sample by sample and
+ * folds all channels together.  The capture metering path wants per-channel
+ * energy and peak over interleaved float blocks, every block, which makes
+ * that an extra full pass per channel.  The kernels here compute energy and
+ * peak for all channels in one vectorized pass over the interleaved data
+ * (one channel per SIMD lane, so a 4 mic frame is exactly one float32x4),
+ * and PowerMeter maintains running totals so levels accumulate as blocks
+ * stream through instead of being recomputed.
+ *
+ * Float samples only; convert other formats first (see format_kernels.h).
+ */
+
+namespace android::audio_utils::power {
+
+/** Channel counts above this fall back to the scalar loop. */
+static constexpr size_t kPowerKernelMaxChannels = 8;
+
+namespace details {
+
+// V is the per-frame vector type spanning the channels (one per lane).
+template <typename V>
+void energy_peak_impl(const float* in, size_t frames, size_t channels,
+        float* energy, float* peak) {
+    using namespace intrinsics;
+    V venergy = vdupn<V>(0.f);
+    V vpeak = vdupn<V>(0.f);
+    V x;
+    while (frames > 0) {
+        x = vld1<V>(in);
+        in += channels;
+        venergy = vmla(venergy, x, x);
+        vpeak = vmax(vmax(vpeak, x), vneg(x));
+        frames--;
+    }
+    vst1(energy, venergy);
+    vst1(peak, vpeak);
+}
+
+// Mono: 4 frames per vector, horizontal reduction at the end.
+inline void energy_peak_mono(const float* in, size_t frames,
+        float* energy, float* peak) {
+    using namespace intrinsics;
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+    using V = float32x4_t;
+#else
+    using V = internal_array_t<float, 4>;
+#endif
+    float e = 0.f;
+    float p = 0.f;
+    if (frames >= 4) {
+        V venergy = vdupn<V>(0.f);
+        V vpeak = vdupn<V>(0.f);
+        V x;
+        for (; frames >= 4; frames -= 4) {
+            x = vld1<V>(in);
+            in += 4;
+            venergy = vmla(venergy, x, x);
+            vpeak = vmax(vmax(vpeak, x), vneg(x));
+        }
+        float lanes[4];
+        vst1(lanes, venergy);
+        e = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        vst1(lanes, vpeak);
+        p = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    }
+    for (; frames > 0; --frames) {
+        const float v = *in++;
+        e += v * v;
+        p = std::max(p, std::fabs(v));
+    }
+    *energy = e;
+    *peak = p;
+}
+
+} // namespace details
+
+/**
+ * \brief Computes per-channel energy and peak over an interleaved block.
+ *
+ * One pass over the data; channels within a frame occupy SIMD lanes.
+ *
+ * \param in       interleaved float samples, frames x channels.
+ * \param frames   number of audio frames.
+ * \param channels number of interleaved channels, at least 1.
+ * \param energy   out array [channels]: sum of squared amplitudes per channel.
+ * \param peak     out array [channels]: maximum absolute amplitude per channel.
+ */
+inline void compute_energy_peak(const float* in, size_t frames, size_t channels,
+        float* energy, float* peak) {
+    using namespace intrinsics;
+    assert(channels >= 1);
+    switch (channels) {
+    case 1:
+        details::energy_peak_mono(in, frames, energy, peak);
+        return;
+    case 2:
+        details::energy_peak_impl<internal_array_t<float, 2>>(
+                in, frames, channels, energy, peak);
+        return;
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+    case 4:
+        details::energy_peak_impl<float32x4_t>(in, frames, channels, energy, peak);
+        return;
+    case 8:
+        details::energy_peak_impl<float32x4x2_t>(in, frames, channels, energy, peak);
+        return;
+#else
+    case 4:
+        details::energy_peak_impl<internal_array_t<float, 4>>(
+                in, frames, channels, energy, peak);
+        return;
+    case 8:
+        details::energy_peak_impl<internal_array_t<float, 8>>(
+                in, frames, channels, energy, peak);
+        return;
+#endif
+    case 3:
+        details::energy_peak_impl<internal_array_t<float, 3>>(
+                in, frames, channels, energy, peak);
+        return;
+    case 5:
+        details::energy_peak_impl<internal_array_t<float, 5>>(
+                in, frames, channels, energy, peak);
+        return;
+    case 6:
+        details::energy_peak_impl<internal_array_t<float, 6>>(
+                in, frames, channels, energy, peak);
+        return;
+    case 7:
+        details::energy_peak_impl<internal_array_t<float, 7>>(
+                in, frames, channels, energy, peak);
+        return;
+    default:
+        break;
+    }
+    // Scalar fallback for wide layouts.
+    for (size_t c = 0; c < channels; ++c) {
+        energy[c] = 0.f;
+        peak[c] = 0.f;
+    }
+    for (size_t i = 0; i < frames; ++i, in += channels) {
+        for (size_t c = 0; c < channels; ++c) {
+            energy[c] += in[c] * in[c];
+            peak[c] = std::max(peak[c], std::fabs(in[c]));
+        }
+    }
+}
+
+/**
+ * PowerMeter
+ *
+ * Incremental per-channel level metering over a stream of interleaved
+ * float blocks.  Each process() call makes one vectorized pass over the
+ * block and folds the result into running totals; energy, mean power and
+ * peak hold can then be read at any block boundary without another pass
+ * over the data.
+ *
+ * Not thread safe; use one PowerMeter per stream.
+ */
+class PowerMeter {
+public:
+    /**
+     * \param channelCount number of interleaved channels, at least 1.
+     */
+    explicit PowerMeter(size_t channelCount)
+            : mChannelCount(channelCount) {
+        assert(channelCount >= 1 && channelCount <= kMaxChannels);
+        reset();
+    }
+
+    /**
+     * \brief Accumulates one interleaved block into the running totals.
+     *
+     * \param in     interleaved float samples, frames x channelCount.
+     * \param frames number of audio frames in the block.
+     */
+    void process(const float* in, size_t frames) {
+        float energy[kMaxChannels];
+        float peak[kMaxChannels];
+        compute_energy_peak(in, frames, mChannelCount, energy, peak);
+        for (size_t c = 0; c < mChannelCount; ++c) {
+            mEnergy[c] += energy[c];
+            mPeak[c] = std::max(mPeak[c], peak[c]);
+        }
+        mFrames += frames;
+    }
+
+    /** \brief Clears the running totals. */
+    void reset() {
+        mEnergy.fill(0.f);
+        mPeak.fill(0.f);
+        mFrames = 0;
+    }
+
+    /** \return accumulated energy (sum of squares) of the given channel. */
+    float energy(size_t channel) const {
+        assert(channel < mChannelCount);
+        return mEnergy[channel];
+    }
+
+    /** \return peak absolute amplitude of the given channel since reset(). */
+    float peak(size_t channel) const {
+        assert(channel < mChannelCount);
+        return mPeak[channel];
+    }
+
+    /**
+     * \return mean signal power of the given channel in dB on a 0 dBFS
+     *         scale, or negative infinity if no signal was accumulated.
+     */
+    float power(size_t channel) const {
+        assert(channel < mChannelCount);
+        if (mFrames == 0) return -std::numeric_limits<float>::infinity();
+        return audio_utils_power_from_energy(mEnergy[channel] / mFrames);
+    }
+
+    /** \return number of frames accumulated since reset(). */
+    size_t framesProcessed() const {
+        return mFrames;
+    }
+
+private:
+    // Generous fixed bound so process() can use stack scratch; wide layouts
+    // past the SIMD dispatch still meter correctly through the scalar path.
+    static constexpr size_t kMaxChannels = 32;
+
+    const size_t mChannelCount;
+    std::array<float, kMaxChannels> mEnergy;
+    std::array<float, kMaxChannels> mPeak;
+    size_t mFrames = 0;
+};
+
+} // namespace android::audio_utils::power